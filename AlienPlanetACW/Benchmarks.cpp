@@ -0,0 +1,3443 @@
+#include "pch.h"
+#include "Benchmarks.h"
+
+#include "ParametricSurface.h"
+#include "ParametricTorus.h"
+#include "ParametricEllipsoid.h"
+#include "BezierPatchSet.h"
+#include "TubeInstanceBuilder.h"
+#include "SnakeCrowdSimulation.h"
+#include "ImplicitRayMarcher.h"
+#include "ImplicitRayTracer.h"
+#include "ImplicitWavefrontRayTracer.h"
+#include "ImplicitBilateralUpsampler.h"
+#include "ImplicitResolutionController.h"
+#include "ImplicitDepthPyramid.h"
+#include "ImplicitSceneTileBins.h"
+#include "ImplicitSceneBricks.h"
+#include "SdfSceneGraph.h"
+#include "ImplicitSceneExpression.h"
+#include "ImplicitSceneMesher.h"
+#include "ImplicitMeshedObjects.h"
+#include "SdfMath.h"
+
+#include <cassert>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <ppl.h>
+
+using namespace AlienPlanetACW;
+
+unsigned int Benchmarks::RunAll()
+{
+	PerformanceReport report("AlienPlanetACW CPU benchmarks");
+
+	RunParametricSurfaces(report);
+	RunBezierPatches(report);
+	RunSnakeTubes(report);
+	RunSnakeCrowd(report);
+	RunImplicitRayMarcher(report);
+	RunImplicitSceneHierarchy(report);
+	RunImplicitSceneBytecode(report);
+	RunImplicitSceneExpression(report);
+	RunImplicitSceneBricks(report);
+	RunImplicitSceneConeMarching(report);
+	RunImplicitSceneMarchingVariants(report);
+	RunImplicitSceneNormals(report);
+	RunImplicitSceneTemporalCache(report);
+	RunImplicitSceneFractals(report);
+	RunImplicitSceneConeWidth(report);
+	RunImplicitSceneAnimation(report);
+	RunImplicitSceneIntervalPruning(report);
+	RunImplicitSceneMeshing(report);
+	RunImplicitSceneDepthLimits(report);
+	RunImplicitSceneTileBinning(report);
+	RunImplicitSceneAdaptiveSubdivision(report);
+	RunImplicitSceneCheckerboard(report);
+	RunImplicitSceneDynamicResolution(report);
+	RunImplicitRayTracedBvh(report);
+	RunImplicitRayTracedCheckerboard(report);
+	RunImplicitRayTracedAdaptiveSubdivision(report);
+	RunImplicitRayWavefront(report);
+
+	report.AddFailureSummary();
+	report.Write(L"Benchmarks.txt");
+
+	return report.GetFailureCount();
+}
+
+namespace
+{
+	template <typename Surface>
+	void ReportSurfaceLods(PerformanceReport& report, const std::string& name, const std::vector<DirectX::XMUINT2>& resolutions)
+	{
+		const ParametricSurfaceEvaluator<Surface> evaluator;
+
+		const auto serialLods = evaluator.GenerateLods(resolutions, false);
+		const auto parallelLods = evaluator.GenerateLods(resolutions, true);
+
+		std::vector<std::vector<std::string>> rows;
+
+		auto serialTotal = 0.0;
+		auto parallelTotal = 0.0;
+
+		for (auto i = 0u; i < parallelLods.size(); i++)
+		{
+			const auto& lod = parallelLods[i];
+
+			rows.push_back({
+				std::to_string(i),
+				std::to_string(lod.resolutionU) + "x" + std::to_string(lod.resolutionV),
+				std::to_string(lod.vertices.size()),
+				std::to_string(lod.indices.size() / 3),
+				PerformanceReport::Format(lod.maxError, 6),
+				PerformanceReport::Format(serialLods[i].generationMilliseconds, 3),
+				PerformanceReport::Format(lod.generationMilliseconds, 3)
+			});
+
+			serialTotal += serialLods[i].generationMilliseconds;
+			parallelTotal += lod.generationMilliseconds;
+		}
+
+		report.AddSection(name);
+		report.AddTable({ "LOD", "Quads", "Vertices", "Triangles", "Max error", "Serial ms", "Parallel ms" }, rows);
+		report.AddLine("Total generation: " + PerformanceReport::Format(serialTotal, 3) + " ms serial, " + PerformanceReport::Format(parallelTotal, 3) + " ms parallel");
+	}
+}
+
+void Benchmarks::RunParametricSurfaces(PerformanceReport& report)
+{
+	ReportSurfaceLods<TorusSurface>(report, "Baked parametric torus", ParametricTorus::GetLodResolutions());
+	ReportSurfaceLods<EllipsoidSurface>(report, "Baked parametric ellipsoid", ParametricEllipsoid::GetLodResolutions());
+}
+
+namespace
+{
+	//A rolling landscape of patches sharing their edges, a bigger and more varied load than the four patch strip
+	BezierPatchSet CreateHeightfieldPatches(const unsigned int patchesPerSide)
+	{
+		const auto pointsPerSide = patchesPerSide * 3 + 1;
+
+		std::vector<DirectX::XMFLOAT3> grid(pointsPerSide * pointsPerSide);
+
+		for (auto z = 0u; z < pointsPerSide; z++)
+		{
+			for (auto x = 0u; x < pointsPerSide; x++)
+			{
+				const auto fx = static_cast<float>(x) * 0.25f;
+				const auto fz = static_cast<float>(z) * 0.25f;
+
+				grid[z * pointsPerSide + x] = DirectX::XMFLOAT3(fx, std::sin(fx * 0.7f) * std::cos(fz * 0.3f) + 0.2f * std::sin(fx * fz * 0.05f), fz);
+			}
+		}
+
+		BezierPatchSet patches;
+
+		for (auto patchZ = 0u; patchZ < patchesPerSide; patchZ++)
+		{
+			for (auto patchX = 0u; patchX < patchesPerSide; patchX++)
+			{
+				BezierPatch patch;
+
+				for (auto row = 0u; row < 4; row++)
+				{
+					for (auto column = 0u; column < 4; column++)
+					{
+						patch.controlPoints[row * 4 + column] = grid[(patchZ * 3 + row) * pointsPerSide + patchX * 3 + column];
+					}
+				}
+
+				patches.AddPatch(patch);
+			}
+		}
+
+		return patches;
+	}
+
+	std::vector<std::string> BezierMeshRow(const std::string& name, const BezierPatchSet& patches, const BezierPatchMesh& mesh, const double serialMilliseconds)
+	{
+		return {
+			name,
+			std::to_string(mesh.vertices.size()),
+			std::to_string(mesh.indices.size() / 3),
+			PerformanceReport::Format(patches.MeasureMaxError(mesh), 6),
+			PerformanceReport::Format(serialMilliseconds, 3),
+			PerformanceReport::Format(mesh.generationMilliseconds, 3),
+			PerformanceReport::Format(static_cast<double>(mesh.indices.size() / 3) / (mesh.generationMilliseconds * 1000.0), 2)
+		};
+	}
+
+	void ReportBezierTessellation(PerformanceReport& report, const std::string& name, const BezierPatchSet& patches, const std::vector<unsigned int>& uniformLevels, const std::vector<float>& tolerances)
+	{
+		std::vector<std::vector<std::string>> rows;
+
+		for (const auto level : uniformLevels)
+		{
+			const auto serial = patches.TessellateUniform(level, false);
+			rows.push_back(BezierMeshRow("Uniform " + std::to_string(level), patches, patches.TessellateUniform(level, true), serial.generationMilliseconds));
+		}
+
+		for (const auto tolerance : tolerances)
+		{
+			BezierTessellationSettings settings;
+			settings.tolerance = tolerance;
+
+			const auto serial = patches.Tessellate(settings, false);
+			rows.push_back(BezierMeshRow("Adaptive " + PerformanceReport::Format(tolerance, 4), patches, patches.Tessellate(settings, true), serial.generationMilliseconds));
+		}
+
+		report.AddSection(name);
+		report.AddLine(std::to_string(patches.GetPatchCount()) + " patches");
+		report.AddTable({ "Tessellation", "Vertices", "Triangles", "Max error", "Serial ms", "Parallel ms", "Mtris/s" }, rows);
+	}
+}
+
+void Benchmarks::RunBezierPatches(PerformanceReport& report)
+{
+	const auto mobiusStrip = BezierPatchSet::CreateMobiusStrip();
+	const auto landscape = CreateHeightfieldPatches(32);
+
+	//Raw evaluation of positions and both tangents, one point at a time against four at a time
+	{
+		const auto sampleCount = 1u << 20;
+		const auto& patch = mobiusStrip.GetPatch(0);
+
+		auto checksum = 0.0f;
+
+		const auto scalarStart = std::chrono::high_resolution_clock::now();
+
+		for (auto i = 0u; i < sampleCount; i++)
+		{
+			DirectX::XMFLOAT3 position, tangentU, tangentV;
+			BezierPatchSet::Evaluate(patch, static_cast<float>(i & 1023) / 1023.0f, static_cast<float>(i >> 10) / 1023.0f, position, tangentU, tangentV);
+
+			checksum += position.x + tangentU.y + tangentV.z;
+		}
+
+		const auto scalarMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - scalarStart).count();
+
+		const auto simdStart = std::chrono::high_resolution_clock::now();
+
+		SurfaceSamples samples;
+		auto simdChecksum = DirectX::XMVectorZero();
+
+		for (auto i = 0u; i < sampleCount; i += 4)
+		{
+			const auto u = DirectX::XMVectorScale(DirectX::XMVectorSet(static_cast<float>(i & 1023), static_cast<float>((i + 1) & 1023), static_cast<float>((i + 2) & 1023), static_cast<float>((i + 3) & 1023)), 1.0f / 1023.0f);
+			const auto v = DirectX::XMVectorReplicate(static_cast<float>(i >> 10) / 1023.0f);
+
+			BezierPatchSet::Evaluate(patch, u, v, samples);
+
+			simdChecksum = DirectX::XMVectorAdd(simdChecksum, DirectX::XMVectorAdd(samples.x, DirectX::XMVectorAdd(samples.duy, samples.dvz)));
+		}
+
+		const auto simdMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - simdStart).count();
+
+		DirectX::XMFLOAT4 simdSums;
+		DirectX::XMStoreFloat4(&simdSums, simdChecksum);
+
+		report.AddSection("Bezier patch evaluation");
+		report.AddTable({ "Path", "Samples", "ms", "Msamples/s" }, {
+			{ "Scalar", std::to_string(sampleCount), PerformanceReport::Format(scalarMilliseconds, 3), PerformanceReport::Format(sampleCount / (scalarMilliseconds * 1000.0)) },
+			{ "4-wide", std::to_string(sampleCount), PerformanceReport::Format(simdMilliseconds, 3), PerformanceReport::Format(sampleCount / (simdMilliseconds * 1000.0)) }
+		});
+		report.AddLine("Checksums " + PerformanceReport::Format(checksum) + " / " + PerformanceReport::Format(simdSums.x + simdSums.y + simdSums.z + simdSums.w));
+	}
+
+	ReportBezierTessellation(report, "Bezier Mobius strip", mobiusStrip, { 8, 16, 32, 64 }, { 0.01f, 0.001f, 0.0001f });
+	ReportBezierTessellation(report, "Bezier heightfield", landscape, { 4, 8, 16, 32 }, { 0.01f, 0.001f, 0.0001f });
+
+	//Screen space levels with the camera moving away from the strip, as BezierCurve uses them
+	std::vector<std::vector<std::string>> rows;
+
+	for (const auto distance : { 2.0f, 5.0f, 10.0f, 20.0f, 40.0f })
+	{
+		BezierTessellationSettings settings;
+		settings.screenSpace = true;
+		settings.tolerance = 0.5f;
+		settings.pixelsPerUnit = 0.5f * 1080.0f / std::tan(35.0f * DirectX::XM_PI / 180.0f);
+		settings.viewPosition = DirectX::XMFLOAT3(0.0f, 0.0f, distance);
+
+		const auto mesh = mobiusStrip.Tessellate(settings);
+
+		rows.push_back({
+			PerformanceReport::Format(distance, 1),
+			std::to_string(mesh.indices.size() / 3),
+			PerformanceReport::Format(mobiusStrip.MeasureMaxError(mesh) * settings.pixelsPerUnit / distance, 3),
+			PerformanceReport::Format(mesh.generationMilliseconds, 3)
+		});
+	}
+
+	report.AddSection("Bezier Mobius strip, 0.5 pixel tolerance at 1080p");
+	report.AddTable({ "Distance", "Triangles", "Approx. error px", "ms" }, rows);
+	report.AddLine("Uniform factor 32 draws " + std::to_string(mobiusStrip.GetPatchCount() * 32 * 32 * 2) + " triangles at every distance");
+}
+
+void Benchmarks::RunSnakeTubes(PerformanceReport& report)
+{
+	//Same shape as the snakes in the scene: fifteen spine points over one unit
+	const auto pointCount = 15u;
+	const auto segmentCount = pointCount - 1;
+
+	std::vector<std::vector<std::string>> lodRows;
+
+	for (auto lod = 0u; lod < TubeInstanceBuilder::LodCount; lod++)
+	{
+		std::vector<VertexPositionTexcoordNormalTangentBinormal> vertices;
+		std::vector<unsigned long> indices;
+
+		TubeInstanceBuilder::BuildRingMesh(TubeInstanceBuilder::GetRingSides(lod), vertices, indices);
+
+		lodRows.push_back({ std::to_string(lod), std::to_string(TubeInstanceBuilder::GetRingSides(lod)), std::to_string(vertices.size()), std::to_string(indices.size() / 3) });
+	}
+
+	report.AddSection("Snake tube ring meshes");
+	report.AddTable({ "LOD", "Sides", "Vertices", "Triangles per segment" }, lodRows);
+	report.AddLine("The geometry shader emitted 20 triangles per segment at every distance");
+
+	std::vector<std::vector<std::string>> rows;
+
+	for (const auto snakeCount : { 1u, 100u, 10000u })
+	{
+		std::vector<float> x(snakeCount * pointCount), y(snakeCount * pointCount), z(snakeCount * pointCount);
+		std::vector<TubeSegmentInstance> instances(snakeCount * segmentCount);
+
+		const auto buildSnake = [&](const unsigned int snake, const float time)
+		{
+			const auto origin = DirectX::XMFLOAT3(static_cast<float>(snake % 100) * 0.1f - 5.0f, 0.0f, static_cast<float>(snake / 100) * 0.1f - 5.0f);
+			const auto first = snake * pointCount;
+
+			TubeInstanceBuilder::BuildSpine(origin, snake % 2 == 0, 1.0f, pointCount, 0.02f, time, &x[first], &y[first], &z[first]);
+			TubeInstanceBuilder::BuildSegments(&x[first], &y[first], &z[first], pointCount, 0.02f, &instances[snake * segmentCount]);
+		};
+
+		//Enough frames that even the single snake case takes measurable time
+		const auto frameCount = snakeCount >= 10000 ? 20u : (snakeCount >= 100 ? 200u : 20000u);
+
+		const auto serialStart = std::chrono::high_resolution_clock::now();
+
+		for (auto frame = 0u; frame < frameCount; frame++)
+		{
+			for (auto snake = 0u; snake < snakeCount; snake++)
+			{
+				buildSnake(snake, static_cast<float>(frame) / 60.0f);
+			}
+		}
+
+		const auto serialMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - serialStart).count() / frameCount;
+
+		const auto parallelStart = std::chrono::high_resolution_clock::now();
+
+		for (auto frame = 0u; frame < frameCount; frame++)
+		{
+			concurrency::parallel_for(0u, snakeCount, [&](const unsigned int snake) { buildSnake(snake, static_cast<float>(frame) / 60.0f); });
+		}
+
+		const auto parallelMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - parallelStart).count() / frameCount;
+
+		rows.push_back({
+			std::to_string(snakeCount),
+			std::to_string(instances.size()),
+			PerformanceReport::Format(instances.size() * sizeof(TubeSegmentInstance) / 1024.0, 1),
+			PerformanceReport::Format(serialMilliseconds, 4),
+			PerformanceReport::Format(parallelMilliseconds, 4),
+			PerformanceReport::Format(instances.size() / (std::min(serialMilliseconds, parallelMilliseconds) * 1000.0))
+		});
+	}
+
+	report.AddSection("Snake tube instance building, spine and segments per frame");
+	report.AddTable({ "Snakes", "Segments", "Instance KB", "Serial ms", "Parallel ms", "Msegments/s" }, rows);
+}
+
+void Benchmarks::RunSnakeCrowd(PerformanceReport& report)
+{
+	const auto hardwareThreads = std::thread::hardware_concurrency();
+
+	//0 leaves the split and the workers to parallel_for, the rest are that many equal chunks on a scheduler capped at
+	//that many workers
+	std::vector<unsigned int> threadCounts = { 1, 2, 4, 8 };
+
+	if (hardwareThreads > 8)
+	{
+		threadCounts.push_back(hardwareThreads);
+	}
+
+	threadCounts.push_back(0);
+
+	std::vector<std::vector<std::string>> rows;
+
+	for (const auto snakeCount : { 10000u, 100000u })
+	{
+		SnakeCrowdSimulation crowd(15, 50.0f);
+		crowd.Reserve(snakeCount);
+
+		//Spread over a 100 by 100 field in every direction, with the scene's spread of sizes and speeds
+		auto seed = 12345u;
+		const auto random = [&seed]()
+		{
+			seed = seed * 1664525u + 1013904223u;
+			return static_cast<float>(seed >> 8) / 16777216.0f;
+		};
+
+		for (auto snake = 0u; snake < snakeCount; snake++)
+		{
+			const auto angle = random() * DirectX::XM_2PI;
+
+			crowd.AddSnake(DirectX::XMFLOAT3(random() * 100.0f - 50.0f, 0.0f, random() * 100.0f - 50.0f), DirectX::XMFLOAT2(std::cos(angle), std::sin(angle)), 0.01f + random() * 0.04f, 1.0f + random(), 0.25f + random() * 0.5f);
+		}
+
+		const auto frameCount = snakeCount >= 100000 ? 5u : 20u;
+
+		std::vector<std::string> row = { std::to_string(snakeCount), std::to_string(crowd.GetSegmentCount()) };
+
+		for (const auto threadCount : threadCounts)
+		{
+			//parallel_for runs on this thread's current scheduler, so while it's attached no more than threadCount workers
+			//take chunks, whatever the default scheduler would have used
+			if (threadCount > 1)
+			{
+				concurrency::CurrentScheduler::Create(concurrency::SchedulerPolicy(2, concurrency::MinConcurrency, 1, concurrency::MaxConcurrency, threadCount));
+			}
+
+			//One untimed frame so every thread count starts from warm caches
+			crowd.Update(1.0f / 60.0f, 0.0f, threadCount);
+
+			const auto start = std::chrono::high_resolution_clock::now();
+
+			for (auto frame = 0u; frame < frameCount; frame++)
+			{
+				crowd.Update(1.0f / 60.0f, static_cast<float>(frame + 1) / 60.0f, threadCount);
+			}
+
+			row.push_back(PerformanceReport::Format(std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / frameCount));
+
+			if (threadCount > 1)
+			{
+				concurrency::CurrentScheduler::Detach();
+			}
+		}
+
+		//Grouping by LOD is what Render does on top of the update, into a plain array here instead of a mapped buffer
+		std::vector<TubeSegmentInstance> grouped(crowd.GetSegmentCount());
+		unsigned int lodInstanceCounts[TubeInstanceBuilder::LodCount];
+
+		const auto groupStart = std::chrono::high_resolution_clock::now();
+
+		crowd.WriteInstancesByLod(DirectX::XMFLOAT3(0.0f, 1.0f, 0.0f), grouped.data(), lodInstanceCounts);
+
+		row.push_back(PerformanceReport::Format(std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - groupStart).count()));
+
+		rows.push_back(row);
+	}
+
+	std::vector<std::string> headers = { "Snakes", "Segments" };
+
+	for (const auto threadCount : threadCounts)
+	{
+		headers.push_back(threadCount == 0 ? "Auto ms" : std::to_string(threadCount) + (threadCount == 1 ? " thread ms" : " threads ms"));
+	}
+
+	headers.push_back("LOD grouping ms");
+
+	report.AddSection("Snake crowd update per frame");
+	report.AddLine(std::to_string(hardwareThreads) + " hardware threads, 15 spine points per snake. Each thread count is a scheduler with MaxConcurrency set to it, and the crowd is split into that many chunks");
+	report.AddTable(headers, rows);
+}
+
+void Benchmarks::RunImplicitRayMarcher(PerformanceReport& report)
+{
+	const auto width = 320u;
+	const auto height = 180u;
+
+	//Looking over the primitive gallery towards the alien and the drip, with the ship and the fractals in the distance
+	const auto view = ImplicitRayMarcher::LookAt(DirectX::XMFLOAT3(2.5f, 1.6f, 2.5f), DirectX::XMFLOAT3(0.0f, 0.6f, 0.0f));
+	const auto time = 1.3f;
+
+	struct Mode
+	{
+		const char* name;
+		bool usePackets;
+		bool parallel;
+		bool mortonOrder;
+	};
+
+	const Mode modes[] =
+	{
+		{ "Scalar, 1 thread", false, false, true },
+		{ "Packets, 1 thread", true, false, true },
+		{ "Scalar, parallel", false, true, true },
+		{ "Packets, parallel, row order", true, true, false },
+		{ "Packets, parallel, Morton order", true, true, true }
+	};
+
+	std::vector<std::vector<std::string>> rows;
+
+	for (const auto& mode : modes)
+	{
+		ImplicitRayMarcherSettings settings;
+		settings.usePackets = mode.usePackets;
+		settings.parallel = mode.parallel;
+		settings.mortonOrder = mode.mortonOrder;
+
+		HeadlessImage image(width, height);
+		const auto stats = ImplicitRayMarcher(settings).Render(view, time, image);
+
+		rows.push_back({
+			mode.name,
+			PerformanceReport::Format(stats.milliseconds, 1),
+			PerformanceReport::Format(stats.GetMegaRaysPerSecond(), 3),
+			PerformanceReport::Format(stats.GetAverageSteps()),
+			PerformanceReport::Format(100.0 * stats.hits / stats.rays, 1)
+		});
+	}
+
+	report.AddSection("Implicit scene CPU ray marcher");
+	report.AddLine(std::to_string(width) + "x" + std::to_string(height) + ", time " + PerformanceReport::Format(time, 1) + ", 16x16 tiles, " + (Sdf::IsFloat8Supported() ? "8 ray AVX2 packets" : "no AVX2 so packets fall back to single rays"));
+	report.AddTable({ "Mode", "ms", "Mrays/s", "Steps per ray", "Hit %" }, rows);
+
+	//A few views of the scene at different times, full speed
+	struct Shot
+	{
+		const wchar_t* fileName;
+		DirectX::XMFLOAT3 eye;
+		DirectX::XMFLOAT3 target;
+		float time;
+	};
+
+	const Shot shots[] =
+	{
+		{ L"ImplicitSceneStart.bmp", DirectX::XMFLOAT3(0.0f, 0.5f, -0.5f), DirectX::XMFLOAT3(0.0f, 0.5f, 0.5f), 0.0f },
+		{ L"ImplicitSceneGallery.bmp", DirectX::XMFLOAT3(2.5f, 1.6f, 2.5f), DirectX::XMFLOAT3(0.0f, 0.6f, 0.0f), 1.3f },
+		{ L"ImplicitSceneShip.bmp", DirectX::XMFLOAT3(0.0f, 2.2f, 3.0f), DirectX::XMFLOAT3(0.0f, 2.1f, 0.0f), 2.0f },
+		{ L"ImplicitSceneMandelbulb.bmp", DirectX::XMFLOAT3(-2.5f, 2.2f, -2.5f), DirectX::XMFLOAT3(-4.0f, 2.0f, -4.0f), 10.0f }
+	};
+
+	const ImplicitRayMarcher marcher;
+
+	for (const auto& shot : shots)
+	{
+		HeadlessImage image(640, 360);
+		marcher.Render(ImplicitRayMarcher::LookAt(shot.eye, shot.target), shot.time, image);
+		image.WriteBmp(shot.fileName);
+	}
+
+	report.AddLine("Images written to the local folder: ImplicitSceneStart.bmp, ImplicitSceneGallery.bmp, ImplicitSceneShip.bmp, ImplicitSceneMandelbulb.bmp");
+}
+
+void Benchmarks::RunImplicitSceneHierarchy(PerformanceReport& report)
+{
+	const auto width = 320u;
+	const auto height = 180u;
+
+	struct View
+	{
+		const char* name;
+		DirectX::XMFLOAT3 eye;
+		DirectX::XMFLOAT3 target;
+		float time;
+	};
+
+	const View views[] =
+	{
+		{ "Gallery", DirectX::XMFLOAT3(2.5f, 1.6f, 2.5f), DirectX::XMFLOAT3(0.0f, 0.6f, 0.0f), 1.3f },
+		{ "Ship", DirectX::XMFLOAT3(0.0f, 2.2f, 3.0f), DirectX::XMFLOAT3(0.0f, 2.1f, 0.0f), 2.0f },
+		{ "Mandelbulb", DirectX::XMFLOAT3(-2.5f, 2.2f, -2.5f), DirectX::XMFLOAT3(-4.0f, 2.0f, -4.0f), 10.0f }
+	};
+
+	struct Mode
+	{
+		const char* name;
+		bool useHierarchy;
+		float standInDistance;
+	};
+
+	const Mode modes[] =
+	{
+		{ "Every object", false, 1e10f },
+		{ "Hierarchy", true, 1e10f },
+		{ "Hierarchy, stand-ins past 0.5", true, 0.5f }
+	};
+
+	std::vector<std::vector<std::string>> rows;
+
+	for (const auto& view : views)
+	{
+		HeadlessImage reference(width, height);
+
+		for (const auto& mode : modes)
+		{
+			ImplicitRayMarcherSettings settings;
+			settings.useHierarchy = mode.useHierarchy;
+			settings.standInDistance = mode.standInDistance;
+
+			HeadlessImage image(width, height);
+			const auto stats = ImplicitRayMarcher(settings).Render(ImplicitRayMarcher::LookAt(view.eye, view.target), view.time, image);
+
+			if (!mode.useHierarchy)
+			{
+				reference = image;
+			}
+
+			//Pixels more than a shade away from evaluating every object
+			auto differing = 0u;
+
+			for (auto y = 0u; y < height; y++)
+			{
+				for (auto x = 0u; x < width; x++)
+				{
+					const auto& a = image.GetPixel(x, y);
+					const auto& b = reference.GetPixel(x, y);
+
+					if (std::abs(a.x - b.x) > 1.0f / 255.0f || std::abs(a.y - b.y) > 1.0f / 255.0f || std::abs(a.z - b.z) > 1.0f / 255.0f)
+					{
+						differing++;
+					}
+				}
+			}
+
+			rows.push_back({
+				view.name,
+				mode.name,
+				PerformanceReport::Format(stats.milliseconds, 1),
+				PerformanceReport::Format(stats.GetObjectsPerRay(), 1),
+				PerformanceReport::Format(stats.GetPrimitivesPerRay(), 1),
+				PerformanceReport::Format(stats.GetBoundTestsPerRay(), 1),
+				PerformanceReport::Format(stats.GetAverageSteps()),
+				std::to_string(differing)
+			});
+		}
+	}
+
+	const ImplicitSceneHierarchy shaderHierarchy(ImplicitSceneHierarchy::GetObjectBoundsForAllTime());
+	shaderHierarchy.WriteHlsl(L"ImplicitSceneHierarchy.hlsli");
+
+	report.AddSection("Implicit scene bounding volume hierarchy");
+	report.AddLine(std::to_string(width) + "x" + std::to_string(height) + ", " + std::to_string(ImplicitSceneSdf::ObjectCount) + " objects, evaluations per pixel including the normals");
+	report.AddTable({ "View", "Mode", "ms", "Objects", "Primitives", "Bound tests", "Steps per ray", "Pixels differing" }, rows);
+	report.AddLine("Shader tree: " + std::to_string(shaderHierarchy.GetNodeCount()) + " nodes, depth " + std::to_string(shaderHierarchy.GetDepth()) + ", written to ImplicitSceneHierarchy.hlsli in the local folder");
+}
+
+namespace
+{
+	//Points spread over the gallery and the space around it, where the marcher spends its samples, with the hand written
+	//scene's distances to compare against
+	struct ScenePoints
+	{
+		static const unsigned int Count = 1u << 16;
+
+		std::vector<Sdf::Vec3<float>> points;
+		std::vector<float> xs, ys, zs;
+		std::vector<float> reference;
+
+		explicit ScenePoints(const ImplicitSceneParameters& parameters) : points(Count), xs(Count), ys(Count), zs(Count), reference(Count)
+		{
+			auto seed = 12345u;
+			const auto random = [&seed]()
+			{
+				seed = seed * 1664525u + 1013904223u;
+				return static_cast<float>(seed >> 8) / 16777216.0f;
+			};
+
+			for (auto i = 0u; i < Count; i++)
+			{
+				points[i] = Sdf::Vec3<float>(random() * 6.0f - 3.0f, random() * 4.0f - 0.5f, random() * 6.0f - 3.0f);
+				xs[i] = points[i].x;
+				ys[i] = points[i].y;
+				zs[i] = points[i].z;
+				reference[i] = ImplicitSceneSdf::Evaluate(parameters, points[i]).distance;
+			}
+		}
+	};
+
+	//Distances summed so the work can't be optimised away, and the largest difference from the reference distances
+	struct SampleRun
+	{
+		double milliseconds;
+		float checksum;
+		float maxDifference;
+	};
+
+	template <typename Evaluator>
+	SampleRun RunScalarSamples(const ScenePoints& points, const Evaluator& evaluate)
+	{
+		SampleRun run = { 0.0, 0.0f, 0.0f };
+
+		const auto start = std::chrono::high_resolution_clock::now();
+
+		for (auto i = 0u; i < ScenePoints::Count; i++)
+		{
+			const auto distance = evaluate(points.points[i]).distance;
+
+			run.checksum += distance;
+			run.maxDifference = std::max(run.maxDifference, std::abs(distance - points.reference[i]));
+		}
+
+		run.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+		return run;
+	}
+
+	template <typename Evaluator>
+	SampleRun RunPacketSamples(const ScenePoints& points, const Evaluator& evaluate)
+	{
+		using namespace Sdf;
+
+		SampleRun run = { 0.0, 0.0f, 0.0f };
+
+		const auto start = std::chrono::high_resolution_clock::now();
+
+		for (auto i = 0u; i < ScenePoints::Count; i += 8)
+		{
+			float distances[8];
+			evaluate(Vec3<Float8>(Float8::Load(&points.xs[i]), Float8::Load(&points.ys[i]), Float8::Load(&points.zs[i]))).distance.Store(distances);
+
+			for (auto lane = 0u; lane < 8; lane++)
+			{
+				run.checksum += distances[lane];
+				run.maxDifference = std::max(run.maxDifference, std::abs(distances[lane] - points.reference[i + lane]));
+			}
+		}
+
+		run.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+		return run;
+	}
+
+	void ReportSampleRuns(PerformanceReport& report, const float time, const std::vector<std::pair<std::string, SampleRun>>& runs)
+	{
+		std::vector<std::vector<std::string>> rows;
+
+		for (const auto& run : runs)
+		{
+			rows.push_back({
+				run.first,
+				PerformanceReport::Format(run.second.milliseconds, 3),
+				PerformanceReport::Format(ScenePoints::Count / (run.second.milliseconds * 1000.0)),
+				PerformanceReport::Format(run.second.maxDifference, 7),
+				PerformanceReport::Format(run.second.checksum)
+			});
+		}
+
+		report.AddLine(std::to_string(ScenePoints::Count) + " samples of the whole scene at time " + PerformanceReport::Format(time, 1) + ", max difference from the hand written scalar distances");
+		report.AddTable({ "Path", "ms", "Msamples/s", "Max difference", "Checksum" }, rows);
+	}
+}
+
+void Benchmarks::RunImplicitSceneBytecode(PerformanceReport& report)
+{
+	using namespace Sdf;
+
+	const auto time = 1.3f;
+	const auto parameters = ImplicitSceneParameters::FromTime(time);
+
+	const auto compileStart = std::chrono::high_resolution_clock::now();
+
+	SdfSceneGraph graph;
+	const auto scene = ImplicitSceneSdf::BuildSceneGraph(parameters, graph);
+
+	SdfProgram program;
+	const auto compiled = graph.Compile(scene, program);
+
+	const auto compileMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - compileStart).count();
+
+	report.AddSection("Implicit scene bytecode interpreter");
+
+	if (!compiled)
+	{
+		report.AddLine("The scene graph needs more than " + std::to_string(SdfProgram::MaxRegisters) + " registers");
+		return;
+	}
+
+	const ScenePoints points(parameters);
+
+	std::vector<std::pair<std::string, SampleRun>> runs;
+
+	runs.push_back({ "Hand written, scalar", RunScalarSamples(points, [&parameters](const Vec3<float>& p) { return ImplicitSceneSdf::Evaluate(parameters, p); }) });
+	runs.push_back({ "Bytecode, scalar", RunScalarSamples(points, [&program](const Vec3<float>& p) { return program.Execute(p); }) });
+
+	if (IsFloat8Supported())
+	{
+		runs.push_back({ "Hand written, 8-wide", RunPacketSamples(points, [&parameters](const Vec3<Float8>& p) { return ImplicitSceneSdf::Evaluate(parameters, p); }) });
+		runs.push_back({ "Bytecode, 8-wide", RunPacketSamples(points, [&program](const Vec3<Float8>& p) { return program.Execute(p); }) });
+	}
+
+	ReportSampleRuns(report, time, runs);
+	report.AddLine("Graph: " + std::to_string(graph.GetNodeCount()) + " nodes, compiled in " + PerformanceReport::Format(compileMilliseconds, 3) + " ms to " + std::to_string(program.GetInstructions().size()) + " instructions ("
+		+ std::to_string(program.GetInstructions().size() * sizeof(SdfInstruction)) + " bytes), " + std::to_string(program.GetPointRegisters()) + " point and " + std::to_string(program.GetShapeRegisters()) + " shape registers");
+}
+
+void Benchmarks::RunImplicitSceneExpression(PerformanceReport& report)
+{
+	using namespace Sdf;
+
+	const auto time = 1.3f;
+	const auto parameters = ImplicitSceneParameters::FromTime(time);
+	const ScenePoints points(parameters);
+	const auto scene = ImplicitSceneExpression::Create(parameters);
+
+	std::vector<std::pair<std::string, SampleRun>> runs;
+
+	runs.push_back({ "Hand written, scalar", RunScalarSamples(points, [&parameters](const Vec3<float>& p) { return ImplicitSceneSdf::Evaluate(parameters, p); }) });
+	runs.push_back({ "Expression templates, scalar", RunScalarSamples(points, [&scene](const Vec3<float>& p) { return scene(p); }) });
+
+	if (IsFloat8Supported())
+	{
+		runs.push_back({ "Hand written, 8-wide", RunPacketSamples(points, [&parameters](const Vec3<Float8>& p) { return ImplicitSceneSdf::Evaluate(parameters, p); }) });
+		runs.push_back({ "Expression templates, 8-wide", RunPacketSamples(points, [&scene](const Vec3<Float8>& p) { return scene(p); }) });
+	}
+
+	report.AddSection("Implicit scene expression templates");
+	ReportSampleRuns(report, time, runs);
+	report.AddLine("Scene expression: " + std::to_string(sizeof(scene)) + " bytes of constants, built once per frame");
+}
+
+namespace
+{
+	//Pixels more than a shade apart
+	unsigned int CountDifferingPixels(const HeadlessImage& a, const HeadlessImage& b)
+	{
+		auto differing = 0u;
+
+		for (auto y = 0u; y < a.GetHeight(); y++)
+		{
+			for (auto x = 0u; x < a.GetWidth(); x++)
+			{
+				const auto& pa = a.GetPixel(x, y);
+				const auto& pb = b.GetPixel(x, y);
+
+				if (std::abs(pa.x - pb.x) > 1.0f / 255.0f || std::abs(pa.y - pb.y) > 1.0f / 255.0f || std::abs(pa.z - pb.z) > 1.0f / 255.0f)
+				{
+					differing++;
+				}
+			}
+		}
+
+		return differing;
+	}
+
+	//Pixels where one image's ray hit and the other's missed, going by the misses being exactly the background
+	unsigned int CountChangedHits(const HeadlessImage& a, const HeadlessImage& b, const DirectX::XMFLOAT3& background)
+	{
+		const auto isBackground = [&background](const DirectX::XMFLOAT3& pixel) { return pixel.x == background.x && pixel.y == background.y && pixel.z == background.z; };
+
+		auto changed = 0u;
+
+		for (auto y = 0u; y < a.GetHeight(); y++)
+		{
+			for (auto x = 0u; x < a.GetWidth(); x++)
+			{
+				if (isBackground(a.GetPixel(x, y)) != isBackground(b.GetPixel(x, y)))
+				{
+					changed++;
+				}
+			}
+		}
+
+		return changed;
+	}
+
+	//A camera moving at 60 frames a second, the same on every run so temporal techniques can be compared on it
+	struct CameraPath
+	{
+		const char* name;
+		//Where the camera is on the path's frame, and the time it's at
+		std::function<void(unsigned int frame, DirectX::XMFLOAT3& eye, DirectX::XMFLOAT3& target, float& time)> camera;
+	};
+
+	std::vector<CameraPath> GetCameraPaths()
+	{
+		const auto frameTime = 1.0f / 60.0f;
+
+		return
+		{
+			{ "Gallery orbit", [frameTime](const unsigned int frame, DirectX::XMFLOAT3& eye, DirectX::XMFLOAT3& target, float& time)
+				{
+					//Half a degree a frame around the gallery
+					const auto angle = 0.7854f + frame * 0.00873f;
+					eye = DirectX::XMFLOAT3(3.54f * std::sin(angle), 1.6f, 3.54f * std::cos(angle));
+					target = DirectX::XMFLOAT3(0.0f, 0.6f, 0.0f);
+					time = 1.3f + frame * frameTime;
+				} },
+			{ "Gallery dolly", [frameTime](const unsigned int frame, DirectX::XMFLOAT3& eye, DirectX::XMFLOAT3& target, float& time)
+				{
+					//Walking towards the pieces at a metre a second
+					eye = DirectX::XMFLOAT3(0.0f, 0.5f, -0.9f + frame * frameTime);
+					target = DirectX::XMFLOAT3(0.0f, 0.5f, 0.5f);
+					time = frame * frameTime;
+				} },
+			{ "Ship pan", [frameTime](const unsigned int frame, DirectX::XMFLOAT3& eye, DirectX::XMFLOAT3& target, float& time)
+				{
+					//Following the ship, which animates along with the beam and the alien under it
+					eye = DirectX::XMFLOAT3(frame * 0.01f, 2.2f, 3.0f);
+					target = DirectX::XMFLOAT3(frame * 0.005f, 2.1f, 0.0f);
+					time = 2.0f + frame * frameTime;
+				} },
+			{ "Mandelbulb strafe", [frameTime](const unsigned int frame, DirectX::XMFLOAT3& eye, DirectX::XMFLOAT3& target, float& time)
+				{
+					eye = DirectX::XMFLOAT3(-2.5f + frame * 0.005f, 2.2f, -2.5f - frame * 0.005f);
+					target = DirectX::XMFLOAT3(-4.0f + frame * 0.005f, 2.0f, -4.0f - frame * 0.005f);
+					time = 10.0f + frame * frameTime;
+				} }
+		};
+	}
+}
+
+void Benchmarks::RunImplicitSceneBricks(PerformanceReport& report)
+{
+	const auto width = 320u;
+	const auto height = 180u;
+
+	const ImplicitSceneBricks serialBricks(1.0f / 256.0f, 4.0f / 256.0f, false);
+	const ImplicitSceneBricks bricks;
+
+	struct View
+	{
+		const char* name;
+		DirectX::XMFLOAT3 eye;
+		DirectX::XMFLOAT3 target;
+		float time;
+	};
+
+	const View views[] =
+	{
+		{ "Gallery", DirectX::XMFLOAT3(2.5f, 1.6f, 2.5f), DirectX::XMFLOAT3(0.0f, 0.6f, 0.0f), 1.3f },
+		{ "Gallery close up", DirectX::XMFLOAT3(0.0f, 0.5f, -0.5f), DirectX::XMFLOAT3(0.0f, 0.5f, 0.5f), 0.0f },
+		{ "Sierpinski", DirectX::XMFLOAT3(3.2f, 2.6f, 3.4f), DirectX::XMFLOAT3(2.0f, 2.0f, 2.0f), 1.3f }
+	};
+
+	std::vector<std::vector<std::string>> rows;
+
+	for (const auto& view : views)
+	{
+		const auto viewMatrix = ImplicitRayMarcher::LookAt(view.eye, view.target);
+
+		ImplicitRayMarcherSettings settings;
+		HeadlessImage analytic(width, height);
+		const auto analyticStats = ImplicitRayMarcher(settings).Render(viewMatrix, view.time, analytic);
+
+		settings.bricks = &bricks;
+		HeadlessImage baked(width, height);
+		const auto bakedStats = ImplicitRayMarcher(settings).Render(viewMatrix, view.time, baked);
+
+		rows.push_back({ view.name, "Analytic", PerformanceReport::Format(analyticStats.milliseconds, 1), PerformanceReport::Format(analyticStats.GetAverageSteps()), "", "" });
+		rows.push_back({
+			view.name,
+			"Bricks",
+			PerformanceReport::Format(bakedStats.milliseconds, 1),
+			PerformanceReport::Format(bakedStats.GetAverageSteps()),
+			PerformanceReport::Format(analyticStats.milliseconds / bakedStats.milliseconds) + "x",
+			std::to_string(CountDifferingPixels(analytic, baked))
+		});
+	}
+
+	//The same samples as dense floats
+	const auto denseBytes = static_cast<double>(bricks.GetGridBrickCount()) * ImplicitSceneBricks::BrickSize * ImplicitSceneBricks::BrickSize * ImplicitSceneBricks::BrickSize * sizeof(float);
+
+	report.AddSection("Implicit scene narrow band bricks");
+	report.AddLine("Sierpinski tetrahedron and gallery baked at 1/256 voxels with a 4 voxel band, 8x8x8 bricks of 16 bit distances");
+	report.AddLine("Bake: " + PerformanceReport::Format(bricks.GetBakeMilliseconds(), 1) + " ms parallel, " + PerformanceReport::Format(serialBricks.GetBakeMilliseconds(), 1) + " ms on one thread");
+	report.AddLine("Bricks: " + std::to_string(bricks.GetBrickCount()) + " of " + std::to_string(bricks.GetGridBrickCount()) + " kept, " + PerformanceReport::Format(bricks.GetMemoryBytes() / 1048576.0) + " MB against " + PerformanceReport::Format(denseBytes / 1048576.0) + " MB dense");
+	report.AddTable({ "View", "Mode", "ms", "Steps per ray", "Speedup", "Pixels differing" }, rows);
+	report.AddLine("Hits and normals use the objects' own SDFs, the pixels differ where the bricks' shorter steps end a ray at a slightly different depth");
+}
+
+void Benchmarks::RunImplicitSceneConeMarching(PerformanceReport& report)
+{
+	const auto width = 320u;
+	const auto height = 180u;
+
+	struct View
+	{
+		const char* name;
+		DirectX::XMFLOAT3 eye;
+		DirectX::XMFLOAT3 target;
+		float time;
+	};
+
+	const View views[] =
+	{
+		{ "Gallery", DirectX::XMFLOAT3(2.5f, 1.6f, 2.5f), DirectX::XMFLOAT3(0.0f, 0.6f, 0.0f), 1.3f },
+		{ "Ship", DirectX::XMFLOAT3(0.0f, 2.2f, 3.0f), DirectX::XMFLOAT3(0.0f, 2.1f, 0.0f), 2.0f },
+		{ "Mandelbulb", DirectX::XMFLOAT3(-2.5f, 2.2f, -2.5f), DirectX::XMFLOAT3(-4.0f, 2.0f, -4.0f), 10.0f }
+	};
+
+	//16 pixel tiles, so the finest cones are 16, 8, 4 and 2 pixels across
+	const unsigned int levels[] = { 0, 1, 2, 3, 4 };
+
+	std::vector<std::vector<std::string>> rows;
+
+	for (const auto& view : views)
+	{
+		HeadlessImage reference(width, height);
+		auto referenceSteps = 0.0;
+
+		for (const auto coneLevels : levels)
+		{
+			ImplicitRayMarcherSettings settings;
+			settings.coneLevels = coneLevels;
+
+			HeadlessImage image(width, height);
+			const auto stats = ImplicitRayMarcher(settings).Render(ImplicitRayMarcher::LookAt(view.eye, view.target), view.time, image);
+
+			if (coneLevels == 0)
+			{
+				reference = image;
+				referenceSteps = stats.GetAverageSteps();
+			}
+
+			rows.push_back({
+				view.name,
+				coneLevels == 0 ? "Off" : std::to_string(16u >> (coneLevels - 1)) + " px",
+				PerformanceReport::Format(stats.milliseconds, 1),
+				PerformanceReport::Format(stats.GetAverageSteps()),
+				PerformanceReport::Format(stats.GetAverageConeSteps()),
+				PerformanceReport::Format(referenceSteps - stats.GetAverageSteps() - stats.GetAverageConeSteps()),
+				std::to_string(CountDifferingPixels(reference, image))
+			});
+		}
+	}
+
+	report.AddSection("Implicit scene cone marching");
+	report.AddLine(std::to_string(width) + "x" + std::to_string(height) + ", 16x16 tiles, each cone level splitting the last into four. Steps are per pixel, the cones' shared between their pixels");
+	report.AddTable({ "View", "Finest cone", "ms", "Ray steps", "Cone steps", "Steps saved", "Pixels differing" }, rows);
+}
+
+void Benchmarks::RunImplicitSceneMarchingVariants(PerformanceReport& report)
+{
+	const auto width = 320u;
+	const auto height = 180u;
+
+	struct View
+	{
+		const char* name;
+		const wchar_t* heatmapFileName;
+		DirectX::XMFLOAT3 eye;
+		DirectX::XMFLOAT3 target;
+		float time;
+	};
+
+	const View views[] =
+	{
+		{ "Gallery", L"ImplicitSceneStepsGallery.bmp", DirectX::XMFLOAT3(2.5f, 1.6f, 2.5f), DirectX::XMFLOAT3(0.0f, 0.6f, 0.0f), 1.3f },
+		{ "Gallery close up", L"ImplicitSceneStepsStart.bmp", DirectX::XMFLOAT3(0.0f, 0.5f, -0.5f), DirectX::XMFLOAT3(0.0f, 0.5f, 0.5f), 0.0f },
+		{ "Ship", L"ImplicitSceneStepsShip.bmp", DirectX::XMFLOAT3(0.0f, 2.2f, 3.0f), DirectX::XMFLOAT3(0.0f, 2.1f, 0.0f), 2.0f },
+		{ "Mandelbulb", L"ImplicitSceneStepsMandelbulb.bmp", DirectX::XMFLOAT3(-2.5f, 2.2f, -2.5f), DirectX::XMFLOAT3(-4.0f, 2.0f, -4.0f), 10.0f }
+	};
+
+	struct Variant
+	{
+		const char* name;
+		float overRelaxation;
+		bool lipschitzScaling;
+	};
+
+	const Variant variants[] =
+	{
+		{ "Baseline", 1.0f, false },
+		{ "Over-relaxed 1.2", 1.2f, false },
+		{ "Over-relaxed 1.5", 1.5f, false },
+		{ "Over-relaxed 1.8", 1.8f, false },
+		{ "Lipschitz scaled", 1.0f, true },
+		{ "Lipschitz scaled, over-relaxed 1.5", 1.5f, true }
+	};
+
+	const auto variantCount = sizeof(variants) / sizeof(variants[0]);
+
+	std::vector<std::vector<std::string>> rows;
+	//Every view's evaluations added up, per variant
+	std::vector<SdfEvaluationCount> evaluations(variantCount);
+	std::vector<unsigned long long> rays(variantCount, 0);
+
+	for (const auto& view : views)
+	{
+		HeadlessImage reference(width, height);
+		auto referenceSteps = 0.0;
+
+		for (auto i = 0u; i < variantCount; i++)
+		{
+			ImplicitRayMarcherSettings settings;
+			settings.overRelaxation = variants[i].overRelaxation;
+			settings.lipschitzScaling = variants[i].lipschitzScaling;
+
+			HeadlessImage image(width, height);
+			ImplicitRayMarcherTrace trace;
+			const auto stats = ImplicitRayMarcher(settings).Render(ImplicitRayMarcher::LookAt(view.eye, view.target), view.time, image, &trace);
+
+			if (i == 0)
+			{
+				reference = image;
+				referenceSteps = stats.GetAverageSteps();
+
+				HeadlessImage heatmap(width, height);
+				trace.WriteHeatmap(heatmap);
+				heatmap.WriteBmp(view.heatmapFileName);
+			}
+
+			evaluations[i] += stats.evaluations;
+			rays[i] += stats.rays;
+
+			rows.push_back({
+				view.name,
+				variants[i].name,
+				PerformanceReport::Format(stats.milliseconds, 1),
+				PerformanceReport::Format(stats.GetAverageSteps()),
+				PerformanceReport::Format(100.0 * (stats.GetAverageSteps() / referenceSteps - 1.0), 1),
+				std::to_string(trace.GetOutOfStepsCount()),
+				std::to_string(CountDifferingPixels(reference, image)),
+				std::to_string(CountChangedHits(reference, image, settings.background))
+			});
+		}
+	}
+
+	report.AddSection("Implicit scene marching variants");
+	report.AddLine(std::to_string(width) + "x" + std::to_string(height) + ", ray steps per pixel against plain sphere tracing, and the pixels that come out different from it. Most differences are hits landing elsewhere within epsilon of the surface, which moves the normal, the hits changed are rays that hit one way and missed the other");
+	report.AddTable({ "View", "Variant", "ms", "Steps per ray", "Steps change %", "Out of steps", "Pixels differing", "Hits changed" }, rows);
+
+	//Where the evaluations went, over all the views
+	std::vector<std::vector<std::string>> histogram;
+
+	for (auto object = 0u; object < ImplicitSceneSdf::ObjectCount; object++)
+	{
+		std::vector<std::string> row = { ImplicitSceneSdf::GetObjectName(object) };
+
+		for (auto i = 0u; i < variantCount; i++)
+		{
+			row.push_back(PerformanceReport::Format(static_cast<double>(evaluations[i].objectEvaluations[object]) / rays[i]));
+		}
+
+		histogram.push_back(row);
+	}
+
+	std::vector<std::string> columns = { "Object" };
+
+	for (const auto& variant : variants)
+	{
+		columns.push_back(variant.name);
+	}
+
+	report.AddLine("Evaluations of each object per ray over all the views, normals included");
+	report.AddTable(columns, histogram);
+	report.AddLine("Plain sphere tracing's step counts written to the local folder: ImplicitSceneStepsGallery.bmp, ImplicitSceneStepsStart.bmp, ImplicitSceneStepsShip.bmp, ImplicitSceneStepsMandelbulb.bmp");
+}
+
+namespace
+{
+	template <typename T, typename Evaluator>
+	Sdf::Vec3<T> FindNormal(const ImplicitRayMarcherNormals normals, const Evaluator& evaluate, const Sdf::Vec3<T>& p)
+	{
+		switch (normals)
+		{
+		case ImplicitRayMarcherNormals::Tetrahedron:
+			return ImplicitSceneSdf::EstimateNormalTetrahedron(evaluate, p);
+		case ImplicitRayMarcherNormals::Dual:
+			return ImplicitSceneSdf::GradientNormal(evaluate, p);
+		default:
+			return ImplicitSceneSdf::EstimateNormal(evaluate, p);
+		}
+	}
+
+	//Normals at every point, eight at a time when the CPU can. The points are padded to a whole number of packets
+	template <typename Evaluator>
+	double FindNormals(const ImplicitRayMarcherNormals normals, const Evaluator& evaluate, const std::vector<float>* const points, std::vector<float>* const result)
+	{
+		using namespace Sdf;
+
+		const auto start = std::chrono::high_resolution_clock::now();
+
+		if (IsFloat8Supported())
+		{
+			for (auto i = 0u; i < points[0].size(); i += 8)
+			{
+				const auto normal = FindNormal(normals, evaluate, Vec3<Float8>(Float8::Load(&points[0][i]), Float8::Load(&points[1][i]), Float8::Load(&points[2][i])));
+
+				normal.x.Store(&result[0][i]);
+				normal.y.Store(&result[1][i]);
+				normal.z.Store(&result[2][i]);
+			}
+		}
+		else
+		{
+			for (auto i = 0u; i < points[0].size(); i++)
+			{
+				const auto normal = FindNormal(normals, evaluate, Vec3<float>(points[0][i], points[1][i], points[2][i]));
+
+				result[0][i] = normal.x;
+				result[1][i] = normal.y;
+				result[2][i] = normal.z;
+			}
+		}
+
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+}
+
+void Benchmarks::RunImplicitSceneNormals(PerformanceReport& report)
+{
+	using namespace Sdf;
+
+	const auto width = 320u;
+	const auto height = 180u;
+
+	struct View
+	{
+		const char* name;
+		DirectX::XMFLOAT3 eye;
+		DirectX::XMFLOAT3 target;
+		float time;
+	};
+
+	const View views[] =
+	{
+		{ "Gallery", DirectX::XMFLOAT3(2.5f, 1.6f, 2.5f), DirectX::XMFLOAT3(0.0f, 0.6f, 0.0f), 1.3f },
+		{ "Gallery close up", DirectX::XMFLOAT3(0.0f, 0.5f, -0.5f), DirectX::XMFLOAT3(0.0f, 0.5f, 0.5f), 0.0f },
+		{ "Ship", DirectX::XMFLOAT3(0.0f, 2.2f, 3.0f), DirectX::XMFLOAT3(0.0f, 2.1f, 0.0f), 2.0f },
+		{ "Mandelbulb", DirectX::XMFLOAT3(-2.5f, 2.2f, -2.5f), DirectX::XMFLOAT3(-4.0f, 2.0f, -4.0f), 10.0f }
+	};
+
+	struct Mode
+	{
+		const char* name;
+		ImplicitRayMarcherNormals normals;
+	};
+
+	const Mode modes[] =
+	{
+		{ "Six tap central differences", ImplicitRayMarcherNormals::CentralDifferences },
+		{ "Four tap tetrahedron", ImplicitRayMarcherNormals::Tetrahedron },
+		{ "Dual numbers", ImplicitRayMarcherNormals::Dual }
+	};
+
+	std::vector<std::vector<std::string>> rows;
+
+	for (const auto& view : views)
+	{
+		const auto viewMatrix = ImplicitRayMarcher::LookAt(view.eye, view.target);
+
+		HeadlessImage reference(width, height);
+		ImplicitRayMarcherTrace trace;
+		ImplicitRayMarcher().Render(viewMatrix, view.time, reference, &trace);
+
+		//The hits, from the ray through each pixel's centre the way the marcher makes them
+		DirectX::XMFLOAT4X4 inverseView;
+		DirectX::XMStoreFloat4x4(&inverseView, DirectX::XMMatrixInverse(nullptr, viewMatrix));
+
+		const auto aspectRatio = static_cast<float>(height) / width;
+
+		std::vector<float> points[3];
+
+		for (auto y = 0u; y < height; y++)
+		{
+			for (auto x = 0u; x < width; x++)
+			{
+				const auto depth = trace.depths[y * width + x];
+
+				if (depth >= ImplicitSceneSdf::MaxDistance)
+				{
+					continue;
+				}
+
+				const auto canvasX = (x + 0.5f) / width * 2.0f - 1.0f;
+				const auto canvasY = (1.0f - (y + 0.5f) / height * 2.0f) * aspectRatio;
+				const auto direction = Normalize(Vec3<float>(
+					inverseView._11 * canvasX + inverseView._21 * canvasY - inverseView._31,
+					inverseView._12 * canvasX + inverseView._22 * canvasY - inverseView._32,
+					inverseView._13 * canvasX + inverseView._23 * canvasY - inverseView._33));
+
+				points[0].push_back(inverseView._41 + direction.x * depth);
+				points[1].push_back(inverseView._42 + direction.y * depth);
+				points[2].push_back(inverseView._43 + direction.z * depth);
+			}
+		}
+
+		const auto hits = points[0].size();
+
+		while (points[0].size() % 8 != 0)
+		{
+			for (auto& axis : points)
+			{
+				axis.push_back(axis.back());
+			}
+		}
+
+		const auto parameters = ImplicitSceneParameters::FromTime(view.time);
+		const ImplicitSceneHierarchy hierarchy(ImplicitSceneHierarchy::GetObjectBounds(parameters));
+
+		std::vector<float> centralNormals[3];
+
+		for (const auto& mode : modes)
+		{
+			SdfEvaluationCount count;
+			const auto evaluate = [&](const auto& q) { return hierarchy.Evaluate(parameters, q, 0xFF, count); };
+
+			std::vector<float> normals[3];
+
+			for (auto& axis : normals)
+			{
+				axis.resize(points[0].size());
+			}
+
+			const auto milliseconds = FindNormals(mode.normals, evaluate, points, normals);
+
+			if (mode.normals == ImplicitRayMarcherNormals::CentralDifferences)
+			{
+				for (auto axis = 0u; axis < 3; axis++)
+				{
+					centralNormals[axis] = normals[axis];
+				}
+			}
+
+			//Angle to the six tap normal, in degrees
+			auto totalError = 0.0;
+			auto maxError = 0.0;
+
+			for (auto i = 0u; i < hits; i++)
+			{
+				const auto a = Vec3<float>(normals[0][i], normals[1][i], normals[2][i]);
+				const auto b = Vec3<float>(centralNormals[0][i], centralNormals[1][i], centralNormals[2][i]);
+				const auto cross = Vec3<float>(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+
+				//atan2 rather than acos, which can't resolve small angles in float
+				const auto error = std::atan2(Length(cross), Dot(a, b)) * 180.0 / 3.14159265358979;
+
+				totalError += error;
+				maxError = std::max(maxError, error);
+			}
+
+			ImplicitRayMarcherSettings settings;
+			settings.normals = mode.normals;
+
+			HeadlessImage image(width, height);
+			const auto stats = ImplicitRayMarcher(settings).Render(viewMatrix, view.time, image);
+
+			rows.push_back({
+				view.name,
+				mode.name,
+				std::to_string(hits),
+				PerformanceReport::Format(static_cast<double>(count.objects) / points[0].size(), 1),
+				PerformanceReport::Format(milliseconds, 1),
+				PerformanceReport::Format(milliseconds * 1e6 / points[0].size(), 0),
+				PerformanceReport::Format(hits > 0 ? totalError / hits : 0.0, 3),
+				PerformanceReport::Format(maxError, 2),
+				PerformanceReport::Format(stats.milliseconds, 1),
+				std::to_string(CountDifferingPixels(reference, image))
+			});
+		}
+	}
+
+	report.AddSection("Implicit scene normals");
+	report.AddLine(std::to_string(width) + "x" + std::to_string(height) + ", the normal at every hit through the hierarchy, " + (IsFloat8Supported() ? "eight at a time" : "one at a time") + ", then whole frames with each. Errors are the angle to the six tap normal in degrees");
+	report.AddTable({ "View", "Normals", "Hits", "Objects per normal", "Normals ms", "ns per normal", "Mean error", "Max error", "Frame ms", "Pixels differing" }, rows);
+}
+
+void Benchmarks::RunImplicitSceneTemporalCache(PerformanceReport& report)
+{
+	const auto width = 320u;
+	const auto height = 180u;
+	const auto frames = 24u;
+
+	std::vector<std::vector<std::string>> rows;
+
+	for (const auto& path : GetCameraPaths())
+	{
+		const ImplicitRayMarcher marcher;
+		ImplicitRayMarcherCache cache;
+
+		auto fullMilliseconds = 0.0;
+		auto cachedMilliseconds = 0.0;
+		auto fullSteps = 0ull;
+		auto cachedSteps = 0ull;
+		auto rays = 0ull;
+		auto reprojectedRays = 0ull;
+		auto rejectedRays = 0ull;
+		//Over the reprojected rays, their steps both ways and how far short of the full march's hit they started
+		auto reprojectedFullSteps = 0ull;
+		auto reprojectedCachedSteps = 0ull;
+		auto reprojectedHits = 0u;
+		auto slack = 0.0;
+		auto startsPastHit = 0u;
+		auto changedHits = 0u;
+		auto differingPixels = 0u;
+
+		for (auto frame = 0u; frame < frames; frame++)
+		{
+			DirectX::XMFLOAT3 eye, target;
+			auto time = 0.0f;
+			path.camera(frame, eye, target, time);
+
+			const auto view = ImplicitRayMarcher::LookAt(eye, target);
+
+			HeadlessImage full(width, height);
+			ImplicitRayMarcherTrace fullTrace;
+			const auto fullStats = marcher.Render(view, time, full, &fullTrace);
+
+			HeadlessImage cached(width, height);
+			ImplicitRayMarcherTrace cachedTrace;
+			const auto cachedStats = marcher.Render(view, time, cached, &cachedTrace, &cache);
+
+			//The first frame has nothing to reproject, so it's only there to fill the cache
+			if (frame == 0)
+			{
+				continue;
+			}
+
+			fullMilliseconds += fullStats.milliseconds;
+			cachedMilliseconds += cachedStats.milliseconds;
+			fullSteps += fullStats.steps;
+			cachedSteps += cachedStats.steps;
+			rays += cachedStats.rays;
+			reprojectedRays += cachedStats.reprojectedRays;
+			rejectedRays += cachedStats.rejectedRays;
+			changedHits += CountChangedHits(full, cached, marcher.GetSettings().background);
+			differingPixels += CountDifferingPixels(full, cached);
+
+			for (auto i = 0u; i < width * height; i++)
+			{
+				if (cachedTrace.startDepths[i] <= fullTrace.startDepths[i])
+				{
+					continue;
+				}
+
+				reprojectedFullSteps += fullTrace.steps[i];
+				reprojectedCachedSteps += cachedTrace.steps[i];
+
+				if (fullTrace.depths[i] < ImplicitSceneSdf::MaxDistance)
+				{
+					reprojectedHits++;
+					slack += 1.0 - cachedTrace.startDepths[i] / fullTrace.depths[i];
+				}
+
+				//Past the surface, so the ray either found it was inside and went back or missed it
+				if (cachedTrace.startDepths[i] > fullTrace.depths[i])
+				{
+					startsPastHit++;
+				}
+			}
+		}
+
+		const auto measuredFrames = frames - 1;
+
+		rows.push_back({
+			path.name,
+			PerformanceReport::Format(fullMilliseconds / measuredFrames, 1),
+			PerformanceReport::Format(cachedMilliseconds / measuredFrames, 1),
+			PerformanceReport::Format(static_cast<double>(fullSteps) / rays),
+			PerformanceReport::Format(static_cast<double>(cachedSteps) / rays),
+			PerformanceReport::Format(100.0 * (1.0 - static_cast<double>(cachedSteps) / fullSteps), 1),
+			PerformanceReport::Format(100.0 * reprojectedRays / rays, 1),
+			PerformanceReport::Format(reprojectedRays > 0 ? static_cast<double>(reprojectedFullSteps) / reprojectedRays : 0.0),
+			PerformanceReport::Format(reprojectedRays > 0 ? static_cast<double>(reprojectedCachedSteps) / reprojectedRays : 0.0),
+			PerformanceReport::Format(reprojectedHits > 0 ? 100.0 * slack / reprojectedHits : 0.0, 2),
+			PerformanceReport::Format(static_cast<double>(startsPastHit) / measuredFrames, 1),
+			PerformanceReport::Format(static_cast<double>(rejectedRays) / measuredFrames, 1),
+			PerformanceReport::Format(static_cast<double>(changedHits) / measuredFrames, 1),
+			PerformanceReport::Format(static_cast<double>(differingPixels) / measuredFrames, 1)
+		});
+	}
+
+	report.AddSection("Implicit scene temporal cache");
+	report.AddLine(std::to_string(width) + "x" + std::to_string(height) + ", " + std::to_string(frames) + " frames along each path at 60 frames a second, every frame marched in full and again starting from last frame's reprojected hits. The reprojected rays' steps are taken both ways, and the slack is how far short of the full march's hit they started as a percentage of its depth. Starts past the hit are the reprojection's errors, and the rejected ones found they'd started inside a surface. The counts are per frame");
+	report.AddTable({ "Path", "Full ms", "Cached ms", "Full steps per ray", "Cached steps per ray", "Steps saved %", "Reprojected %", "Reprojected full steps", "Reprojected cached steps", "Slack %", "Starts past hit", "Rejected", "Hits changed", "Pixels differing" }, rows);
+}
+
+namespace
+{
+	//mandelBulb from ImplicitRayModelsPS.hlsl line for line, the rotations built from time and acos, atan2, two pows,
+	//two sins and two coss every iteration
+	Sdf::Sample<float> HlslMandelbulb(const Sdf::Vec3<float>& pos, const float time, const float power)
+	{
+		using namespace Sdf;
+
+		const auto c = std::cos(time * 0.2f);
+		const auto s = std::sin(time * 0.2f);
+
+		const auto rotate = [](const float (&m)[3][3], const Vec3<float>& v)
+		{
+			return Vec3<float>(m[0][0] * v.x + m[0][1] * v.y + m[0][2] * v.z, m[1][0] * v.x + m[1][1] * v.y + m[1][2] * v.z, m[2][0] * v.x + m[2][1] * v.y + m[2][2] * v.z);
+		};
+
+		const float rotMatrix[3][3] = { { c, -s, 0.0f }, { s, c, 0.0f }, { 0.0f, 0.0f, 1.0f } };
+		const float rotMatrix2[3][3] = { { c, 0.0f, -s }, { 0.0f, 1.0f, 0.0f }, { s, 0.0f, c } };
+		const float rotMatrix3[3][3] = { { 1.0f, 0.0f, 0.0f }, { 0.0f, c, -s }, { 0.0f, s, c } };
+
+		auto z = rotate(rotMatrix, rotate(rotMatrix2, rotate(rotMatrix3, pos + Vec3<float>(0.0f, 0.0f, -0.5f))));
+
+		auto dr = 1.0f;
+		auto r = 0.0f;
+
+		for (auto i = 0; i < 8; i++)
+		{
+			r = Length(z);
+
+			if (r > 1.5f)
+			{
+				break;
+			}
+
+			auto theta = std::acos(z.z / r);
+			auto phi = std::atan2(z.x, z.y);
+
+			dr = std::pow(r, power - 1.0f) * power * dr + 1.0f;
+
+			const auto zr = std::pow(r, power);
+			theta = theta * power;
+			phi = phi * power;
+
+			z = Vec3<float>(std::sin(theta) * std::cos(phi), std::sin(phi) * std::sin(theta), std::cos(theta)) * zr + pos;
+		}
+
+		const auto colour = Saturate(Vec3<float>(Lerp(0.0f, 1.0f, std::sin(time)), Lerp(0.0f, 1.0f, -std::sin(time)), Lerp(0.0f, 1.0f, std::cos(time))));
+
+		return Sample<float>(0.5f * std::log(r) * r / dr, colour);
+	}
+
+	//SierpinskiTetrahedron from ImplicitRayModelsPS.hlsl, all 8 folds with a branch per vertex
+	Sdf::Sample<float> HlslSierpinskiTetrahedron(Sdf::Vec3<float> pos)
+	{
+		using namespace Sdf;
+
+		const Vec3<float> va(0.0f, 0.57735f, 0.0f);
+		const Vec3<float> vb(0.0f, -1.0f, 1.15470f);
+		const Vec3<float> vc(1.0f, -1.0f, -0.57735f);
+		const Vec3<float> vd(-1.0f, -1.0f, -0.57735f);
+
+		auto r = 1.0f;
+		auto dm = 0.0f;
+
+		for (auto i = 0; i < 8; i++)
+		{
+			auto v = va;
+			dm = Dot(pos - va, pos - va);
+
+			auto d = Dot(pos - vb, pos - vb);
+
+			if (d < dm)
+			{
+				v = vb;
+				dm = d;
+			}
+
+			d = Dot(pos - vc, pos - vc);
+
+			if (d < dm)
+			{
+				v = vc;
+				dm = d;
+			}
+
+			d = Dot(pos - vd, pos - vd);
+
+			if (d < dm)
+			{
+				v = vd;
+				dm = d;
+			}
+
+			pos = v + (pos - v) * 2.0f;
+			r *= 2.0f;
+		}
+
+		return Sample<float>((std::sqrt(dm) - 1.0f) / r, Saturate(pos));
+	}
+
+	//Points in a fractal's own space, where its function is called with them, and the straight port's distances there
+	struct FractalPoints
+	{
+		static const unsigned int Count = 1u << 15;
+
+		std::vector<Sdf::Vec3<float>> points;
+		std::vector<float> xs, ys, zs;
+		std::vector<float> reference;
+
+		template <typename Reference>
+		FractalPoints(const Sdf::Vec3<float>& minimum, const Sdf::Vec3<float>& maximum, const Reference& evaluateReference) : points(Count), xs(Count), ys(Count), zs(Count), reference(Count)
+		{
+			auto seed = 54321u;
+			const auto random = [&seed]()
+			{
+				seed = seed * 1664525u + 1013904223u;
+				return static_cast<float>(seed >> 8) / 16777216.0f;
+			};
+
+			for (auto i = 0u; i < Count; i++)
+			{
+				points[i] = Sdf::Vec3<float>(Sdf::Lerp(minimum.x, maximum.x, random()), Sdf::Lerp(minimum.y, maximum.y, random()), Sdf::Lerp(minimum.z, maximum.z, random()));
+				xs[i] = points[i].x;
+				ys[i] = points[i].y;
+				zs[i] = points[i].z;
+				reference[i] = evaluateReference(points[i]).distance;
+			}
+		}
+	};
+
+	//Over is how far a distance went past the reference, which a ray could step through a surface by
+	struct FractalRun
+	{
+		double milliseconds;
+		double meanDifference;
+		float maxDifference;
+		float maxOver;
+	};
+
+	void AddFractalDistance(FractalRun& run, const float distance, const float reference)
+	{
+		run.meanDifference += std::abs(distance - reference);
+		run.maxDifference = std::max(run.maxDifference, std::abs(distance - reference));
+		run.maxOver = std::max(run.maxOver, distance - reference);
+	}
+
+	template <typename Evaluator>
+	FractalRun RunScalarFractal(const FractalPoints& points, const Evaluator& evaluate)
+	{
+		std::vector<float> distances(FractalPoints::Count);
+
+		const auto start = std::chrono::high_resolution_clock::now();
+
+		for (auto i = 0u; i < FractalPoints::Count; i++)
+		{
+			distances[i] = evaluate(points.points[i]).distance;
+		}
+
+		FractalRun run = { std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count(), 0.0, 0.0f, 0.0f };
+
+		for (auto i = 0u; i < FractalPoints::Count; i++)
+		{
+			AddFractalDistance(run, distances[i], points.reference[i]);
+		}
+
+		run.meanDifference /= FractalPoints::Count;
+
+		return run;
+	}
+
+	template <typename Evaluator>
+	FractalRun RunPacketFractal(const FractalPoints& points, const Evaluator& evaluate)
+	{
+		using namespace Sdf;
+
+		std::vector<float> distances(FractalPoints::Count);
+
+		const auto start = std::chrono::high_resolution_clock::now();
+
+		for (auto i = 0u; i < FractalPoints::Count; i += 8)
+		{
+			evaluate(Vec3<Float8>(Float8::Load(&points.xs[i]), Float8::Load(&points.ys[i]), Float8::Load(&points.zs[i]))).distance.Store(&distances[i]);
+		}
+
+		FractalRun run = { std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count(), 0.0, 0.0f, 0.0f };
+
+		for (auto i = 0u; i < FractalPoints::Count; i++)
+		{
+			AddFractalDistance(run, distances[i], points.reference[i]);
+		}
+
+		run.meanDifference /= FractalPoints::Count;
+
+		return run;
+	}
+
+	void ReportFractalRuns(PerformanceReport& report, const std::string& description, const std::vector<std::pair<std::string, FractalRun>>& runs)
+	{
+		std::vector<std::vector<std::string>> rows;
+
+		for (const auto& run : runs)
+		{
+			rows.push_back({
+				run.first,
+				PerformanceReport::Format(run.second.milliseconds, 3),
+				PerformanceReport::Format(FractalPoints::Count / (run.second.milliseconds * 1000.0)),
+				PerformanceReport::Format(runs.front().second.milliseconds / run.second.milliseconds),
+				PerformanceReport::Format(run.second.meanDifference, 7),
+				PerformanceReport::Format(run.second.maxDifference, 7),
+				PerformanceReport::Format(run.second.maxOver, 7)
+			});
+		}
+
+		report.AddLine(description);
+		report.AddTable({ "Kernel", "ms", "Msamples/s", "Speedup", "Mean difference", "Max difference", "Max over" }, rows);
+	}
+}
+
+void Benchmarks::RunImplicitSceneFractals(PerformanceReport& report)
+{
+	using namespace Sdf;
+
+	const auto time = 1.3f;
+	const auto parameters = ImplicitSceneParameters::FromTime(time);
+
+	report.AddSection("Implicit scene fractal kernels");
+	report.AddLine(std::to_string(FractalPoints::Count) + " samples in each fractal's own space at time " + PerformanceReport::Format(time, 1) + ", against the straight scalar port of the shader's function. Over is the furthest a distance went past the port's, which a ray could step through the surface by");
+
+	for (const auto power : { 8.0f, parameters.mandelbulbPower })
+	{
+		const auto& rotation = parameters.mandelbulbRotation;
+		const auto& colour = parameters.mandelbulbColour;
+
+		const FractalPoints points(Vec3<float>(-1.6f, -1.6f, -1.1f), Vec3<float>(1.6f, 1.6f, 2.1f), [time, power](const Vec3<float>& p) { return HlslMandelbulb(p, time, power); });
+
+		std::vector<std::pair<std::string, FractalRun>> runs;
+
+		runs.push_back({ "Shader port, scalar", RunScalarFractal(points, [time, power](const Vec3<float>& p) { return HlslMandelbulb(p, time, power); }) });
+		runs.push_back({ "MandelbulbSdf, scalar", RunScalarFractal(points, [power, &rotation, &colour](const Vec3<float>& p) { return MandelbulbSdf(p, power, rotation, colour); }) });
+
+		if (IsFloat8Supported())
+		{
+			for (const auto iterations : { 8u, 6u, 4u })
+			{
+				runs.push_back({ "MandelbulbSdf, 8-wide, " + std::to_string(iterations) + " iterations", RunPacketFractal(points, [power, &rotation, &colour, iterations](const Vec3<Float8>& p) { return MandelbulbSdf(p, power, rotation, colour, iterations); }) });
+			}
+		}
+
+		const auto integral = power == std::floor(power);
+
+		ReportFractalRuns(report, "Mandelbulb, power " + PerformanceReport::Format(power, 3) + (integral ? ", whole so without trig, which the scene's animated power only takes at whole values" : ", the scene's power at this time, one pow rather than two") + ", in a 3.2 unit box around it", runs);
+	}
+
+	const FractalPoints points(Vec3<float>(-4.0f, -4.0f, -4.0f), Vec3<float>(4.0f, 4.0f, 4.0f), [](const Vec3<float>& p) { return HlslSierpinskiTetrahedron(p); });
+
+	std::vector<std::pair<std::string, FractalRun>> runs;
+
+	runs.push_back({ "Shader port, scalar", RunScalarFractal(points, [](const Vec3<float>& p) { return HlslSierpinskiTetrahedron(p); }) });
+	runs.push_back({ "SierpinskiTetrahedronSdf, scalar", RunScalarFractal(points, [](const Vec3<float>& p) { return SierpinskiTetrahedronSdf(p); }) });
+
+	if (IsFloat8Supported())
+	{
+		runs.push_back({ "SierpinskiTetrahedronSdf, 8-wide, no bailout", RunPacketFractal(points, [](const Vec3<Float8>& p) { return SierpinskiTetrahedronSdf(p); }) });
+
+		for (const auto bailout : { 16.0f, SierpinskiBailout, 4.0f, 2.0f })
+		{
+			runs.push_back({ "SierpinskiTetrahedronSdf, 8-wide, bailout " + PerformanceReport::Format(bailout, 0), RunPacketFractal(points, [bailout](const Vec3<Float8>& p) { return SierpinskiTetrahedronSdf(p, 8, bailout); }) });
+		}
+
+		runs.push_back({ "SierpinskiTetrahedronSdf, 8-wide, bailout 8, 6 iterations", RunPacketFractal(points, [](const Vec3<Float8>& p) { return SierpinskiTetrahedronSdf(p, 6, SierpinskiBailout); }) });
+	}
+
+	ReportFractalRuns(report, "Sierpinski tetrahedron, in an 8 unit box around it, 4 in the scene", runs);
+}
+
+namespace
+{
+	//Mean difference over every pixel's channels, in steps of 1 / 255, from supersampled's pixels averaged down to the
+	//image's size
+	double MeanPixelDifference(const HeadlessImage& image, const HeadlessImage& supersampled)
+	{
+		const auto factor = supersampled.GetWidth() / image.GetWidth();
+		const auto samples = static_cast<float>(factor * factor);
+
+		auto total = 0.0;
+
+		for (auto y = 0u; y < image.GetHeight(); y++)
+		{
+			for (auto x = 0u; x < image.GetWidth(); x++)
+			{
+				auto average = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);
+
+				for (auto j = 0u; j < factor; j++)
+				{
+					for (auto i = 0u; i < factor; i++)
+					{
+						const auto& sample = supersampled.GetPixel(x * factor + i, y * factor + j);
+
+						average.x += sample.x / samples;
+						average.y += sample.y / samples;
+						average.z += sample.z / samples;
+					}
+				}
+
+				const auto& pixel = image.GetPixel(x, y);
+
+				total += std::abs(pixel.x - average.x) + std::abs(pixel.y - average.y) + std::abs(pixel.z - average.z);
+			}
+		}
+
+		return total * 255.0 / (3.0 * image.GetWidth() * image.GetHeight());
+	}
+}
+
+void Benchmarks::RunImplicitSceneConeWidth(PerformanceReport& report)
+{
+	const auto width = 320u;
+	const auto height = 180u;
+	const auto supersampling = 4u;
+
+	struct View
+	{
+		const char* name;
+		DirectX::XMFLOAT3 eye;
+		DirectX::XMFLOAT3 target;
+		float time;
+	};
+
+	//Far enough back that the fractals and the wobbles are a few pixels across
+	const View views[] =
+	{
+		{ "Mandelbulb far", DirectX::XMFLOAT3(-4.0f, 2.5f, 6.0f), DirectX::XMFLOAT3(-4.0f, 2.0f, -4.0f), 10.0f },
+		{ "Sierpinski far", DirectX::XMFLOAT3(9.0f, 3.0f, 10.0f), DirectX::XMFLOAT3(2.0f, 2.0f, 2.0f), 1.3f },
+		{ "Wobbly sphere far", DirectX::XMFLOAT3(6.0f, 2.0f, 4.0f), DirectX::XMFLOAT3(1.0f, 0.5f, -1.0f), 1.3f },
+		{ "Everything", DirectX::XMFLOAT3(9.0f, 3.0f, 9.0f), DirectX::XMFLOAT3(-0.5f, 1.5f, -0.5f), 1.3f }
+	};
+
+	const float coneWidths[] = { 0.0f, 0.5f, 1.0f, 2.0f };
+
+	std::vector<std::vector<std::string>> rows;
+
+	for (const auto& view : views)
+	{
+		const auto viewMatrix = ImplicitRayMarcher::LookAt(view.eye, view.target);
+
+		HeadlessImage supersampled(width * supersampling, height * supersampling);
+		ImplicitRayMarcher().Render(viewMatrix, view.time, supersampled);
+
+		HeadlessImage reference(width, height);
+		auto referenceMilliseconds = 0.0;
+
+		for (const auto coneWidth : coneWidths)
+		{
+			ImplicitRayMarcherSettings settings;
+			settings.coneWidthPixels = coneWidth;
+
+			HeadlessImage image(width, height);
+			const auto stats = ImplicitRayMarcher(settings).Render(viewMatrix, view.time, image);
+
+			if (coneWidth == 0.0f)
+			{
+				reference = image;
+				referenceMilliseconds = stats.milliseconds;
+			}
+
+			rows.push_back({
+				view.name,
+				coneWidth == 0.0f ? "Off" : PerformanceReport::Format(coneWidth, 1) + " px",
+				PerformanceReport::Format(stats.milliseconds, 1),
+				PerformanceReport::Format(referenceMilliseconds / stats.milliseconds) + "x",
+				PerformanceReport::Format(stats.GetAverageSteps()),
+				std::to_string(CountChangedHits(reference, image, settings.background)),
+				std::to_string(CountDifferingPixels(reference, image)),
+				PerformanceReport::Format(MeanPixelDifference(image, supersampled), 3)
+			});
+		}
+	}
+
+	report.AddSection("Implicit scene cone width");
+	report.AddLine(std::to_string(width) + "x" + std::to_string(height) + ", each sample's cone as wide as that many pixels at its depth, the fractals' iterations and the wobbles narrower than it left out. Hits changed and pixels differing are against the image without the cone. The error is the mean difference over every channel of every pixel, in steps of 1 / 255, from the image without the cone rendered at " + std::to_string(supersampling) + "x" + std::to_string(supersampling) + " samples per pixel and averaged down");
+	report.AddTable({ "View", "Cone", "ms", "Speedup", "Steps per ray", "Hits changed", "Pixels differing", "Error against supersampled" }, rows);
+}
+
+namespace
+{
+	//The time-only expressions ImplicitRayModelsPS.hlsl's object functions worked out at every sample before they came
+	//from timeConstantBuffer, ported as they were written and in the same numbers, with the sins, coss and lerps counted
+	struct InlineTimeExpressions
+	{
+		unsigned int trigonometry;
+		unsigned int lerps;
+
+		float Sin(const float x) { trigonometry++; return std::sin(x); }
+		float Cos(const float x) { trigonometry++; return std::cos(x); }
+		float Lerp(const float a, const float b, const float s) { lerps++; return Sdf::Lerp(a, b, s); }
+
+		//morphingShapesSDF's two abs(sin(time * 0.7f))
+		float Morph(const float time)
+		{
+			const auto first = std::abs(Sin(time * 0.7f));
+			const auto second = std::abs(Sin(time * 0.7f));
+			return (first + second) * 0.5f;
+		}
+
+		Sdf::Vec3<float> ShipPosition(const float time)
+		{
+			return Sdf::Vec3<float>(Lerp(-2.0f, 2.0f, Sin(time / 2)), Lerp(2.0f, 2.15f, std::abs(Sin(time))), 0.0f);
+		}
+
+		//alienShipBeamSDF's beamScale.x and beamPos, with its own alienShipPosition
+		Sdf::Vec3<float> BeamPosition(const float time, float& beamLength)
+		{
+			const auto alienShipPos = ShipPosition(time);
+			beamLength = Lerp(0.0f, 1.0f, std::abs(Sin(time)));
+
+			return Sdf::Vec3<float>(alienShipPos.x, alienShipPos.y - (beamLength / 3) - (beamLength / 2), alienShipPos.z);
+		}
+
+		//alienSDF's eye height, worked out once per eye, mouthLerp and armMovement
+		void Alien(const float time, float& eyeHeight, float& mouth, float& arm)
+		{
+			eyeHeight = Lerp(0.02f, 0.045f, std::abs(Sin(time)));
+			eyeHeight = Lerp(0.02f, 0.045f, std::abs(Sin(time)));
+			mouth = Lerp(0.005f, 0.02f, std::abs(Sin(time)));
+			arm = Lerp(-0.05f, 0.05f, std::abs(Cos(time)));
+		}
+
+		void Drips(const float time, float (&heights)[3])
+		{
+			heights[0] = Lerp(0.0f, 0.6f, std::abs(Cos(time / 2)));
+			heights[1] = Lerp(0.0f, 0.6f, std::abs(Cos(time / 4)));
+			heights[2] = Lerp(0.0f, 0.6f, std::abs(Cos(time / 3)));
+		}
+
+		//mandelBulb's Power, its three rotation matrices applied to v one after another, and the colour
+		Sdf::Vec3<float> Mandelbulb(const float time, const Sdf::Vec3<float>& v, float& power, Sdf::Vec3<float>& colour)
+		{
+			power = 3.0f + 4.0f * (Sin(time / 30.0f) + 1.0f);
+
+			const float rotMatrix[3][3] = { { Cos(time * 0.2f), -Sin(time * 0.2f), 0.0f }, { Sin(time * 0.2f), Cos(time * 0.2f), 0.0f }, { 0.0f, 0.0f, 1.0f } };
+			const float rotMatrix2[3][3] = { { Cos(time * 0.2f), 0.0f, -Sin(time * 0.2f) }, { 0.0f, 1.0f, 0.0f }, { Sin(time * 0.2f), 0.0f, Cos(time * 0.2f) } };
+			const float rotMatrix3[3][3] = { { 1.0f, 0.0f, 0.0f }, { 0.0f, Cos(time * 0.2f), -Sin(time * 0.2f) }, { 0.0f, Sin(time * 0.2f), Cos(time * 0.2f) } };
+
+			const auto rotate = [](const float (&m)[3][3], const Sdf::Vec3<float>& p)
+			{
+				return Sdf::Vec3<float>(m[0][0] * p.x + m[0][1] * p.y + m[0][2] * p.z, m[1][0] * p.x + m[1][1] * p.y + m[1][2] * p.z, m[2][0] * p.x + m[2][1] * p.y + m[2][2] * p.z);
+			};
+
+			colour = Sdf::Saturate(Sdf::Vec3<float>(Lerp(0.0f, 1.0f, Sin(time)), Lerp(0.0f, 1.0f, -Sin(time)), Lerp(0.0f, 1.0f, Cos(time))));
+
+			return rotate(rotMatrix, rotate(rotMatrix2, rotate(rotMatrix3, v)));
+		}
+
+		float Wobble(const float time) { return Sin(time); }
+	};
+
+	//Everything one sceneSDF call used to work out from time, summed so none of it can be optimised away
+	float EvaluateInlineTimeExpressions(InlineTimeExpressions& expressions, const float time)
+	{
+		float beamLength, eyeHeight, mouth, arm, heights[3], power;
+		Sdf::Vec3<float> colour;
+
+		auto sum = expressions.Morph(time);
+		sum += expressions.ShipPosition(time).x;
+		sum += expressions.BeamPosition(time, beamLength).y + beamLength;
+		expressions.Alien(time, eyeHeight, mouth, arm);
+		sum += eyeHeight + mouth + arm;
+		expressions.Drips(time, heights);
+		sum += heights[0] + heights[1] + heights[2];
+		sum += expressions.Mandelbulb(time, Sdf::Vec3<float>(0.1f, 0.2f, 0.3f), power, colour).z + power + colour.x;
+		sum += expressions.Wobble(time);
+
+		return sum;
+	}
+}
+
+void Benchmarks::RunImplicitSceneAnimation(PerformanceReport& report)
+{
+	using namespace Sdf;
+
+	//Parity between ImplicitSceneParameters::FromTime, which fills timeConstantBuffer, and the expressions the shader
+	//used to have, over ten minutes of frames at 60 a second
+	const auto frames = 36000u;
+
+	struct Parity
+	{
+		const char* name;
+		float maxDifference;
+	};
+
+	Parity parity[] =
+	{
+		{ "morph", 0.0f }, { "shipPosition", 0.0f }, { "beamLength", 0.0f }, { "beamPosition", 0.0f }, { "alienEyeHeight", 0.0f }, { "alienMouth", 0.0f },
+		{ "alienArm", 0.0f }, { "dripHeights", 0.0f }, { "mandelbulbPower", 0.0f }, { "mandelbulbRotation", 0.0f }, { "mandelbulbColour", 0.0f }, { "wobble", 0.0f }
+	};
+
+	const auto compare = [](Parity& entry, const float a, const float b) { entry.maxDifference = std::max(entry.maxDifference, std::abs(a - b)); };
+	const auto compareVectors = [&compare](Parity& entry, const Vec3<float>& a, const Vec3<float>& b) { compare(entry, a.x, b.x); compare(entry, a.y, b.y); compare(entry, a.z, b.z); };
+
+	InlineTimeExpressions expressions = { 0, 0 };
+
+	for (auto frame = 0u; frame < frames; frame++)
+	{
+		const auto time = frame / 60.0f;
+		const auto parameters = ImplicitSceneParameters::FromTime(time);
+
+		float beamLength, eyeHeight, mouth, arm, heights[3], power;
+		Vec3<float> colour;
+
+		compare(parity[0], parameters.morph, expressions.Morph(time));
+		compareVectors(parity[1], parameters.shipPosition, expressions.ShipPosition(time));
+		compareVectors(parity[3], parameters.beamPosition, expressions.BeamPosition(time, beamLength));
+		compare(parity[2], parameters.beamLength, beamLength);
+		expressions.Alien(time, eyeHeight, mouth, arm);
+		compare(parity[4], parameters.alienEyeHeight, eyeHeight);
+		compare(parity[5], parameters.alienMouth, mouth);
+		compare(parity[6], parameters.alienArm, arm);
+		expressions.Drips(time, heights);
+
+		for (auto i = 0; i < 3; i++)
+		{
+			compare(parity[7], parameters.dripHeights[i], heights[i]);
+		}
+
+		//The matrix's columns are where it takes the axes
+		const Vec3<float> axes[] = { Vec3<float>(1.0f, 0.0f, 0.0f), Vec3<float>(0.0f, 1.0f, 0.0f), Vec3<float>(0.0f, 0.0f, 1.0f) };
+
+		for (auto column = 0; column < 3; column++)
+		{
+			const auto rotated = expressions.Mandelbulb(time, axes[column], power, colour);
+			compareVectors(parity[9], Vec3<float>(parameters.mandelbulbRotation[0][column], parameters.mandelbulbRotation[1][column], parameters.mandelbulbRotation[2][column]), rotated);
+		}
+
+		compare(parity[8], parameters.mandelbulbPower, power);
+		compareVectors(parity[10], parameters.mandelbulbColour, colour);
+		compare(parity[11], parameters.wobble, expressions.Wobble(time));
+	}
+
+	//More than float rounding between the two, so the buffer has drifted from what the shader drew
+	const auto tolerance = 1e-6f;
+
+	std::vector<std::vector<std::string>> parityRows;
+	std::string failures;
+
+	for (const auto& entry : parity)
+	{
+		const auto passed = entry.maxDifference <= tolerance;
+
+		parityRows.push_back({ entry.name, PerformanceReport::Format(entry.maxDifference, 7), passed ? "OK" : "FAIL" });
+
+		if (!passed)
+		{
+			failures += failures.empty() ? entry.name : std::string(", ") + entry.name;
+		}
+	}
+
+	report.AddSection("Implicit scene animation");
+	report.AddLine("ImplicitSceneParameters::FromTime, uploaded as timeConstantBuffer, against the expressions ImplicitRayModelsPS.hlsl worked out at every sample before, for " + std::to_string(frames) + " frames at 60 a second, within "
+		+ PerformanceReport::Format(tolerance, 7));
+	report.AddTable({ "Value", "Max difference", "Parity" }, parityRows);
+
+	if (!failures.empty())
+	{
+		report.AddFailure("Implicit scene animation, FromTime differs from the shader's expressions by more than " + PerformanceReport::Format(tolerance, 7) + " in " + failures);
+	}
+
+	assert(failures.empty());
+
+	//What one sceneSDF call did with them, counted and timed on the CPU, next to the whole call with the parameters
+	const auto calls = 1u << 16;
+
+	InlineTimeExpressions counted = { 0, 0 };
+	EvaluateInlineTimeExpressions(counted, 1.3f);
+
+	auto checksum = 0.0f;
+	auto start = std::chrono::high_resolution_clock::now();
+
+	for (auto call = 0u; call < calls; call++)
+	{
+		checksum += EvaluateInlineTimeExpressions(expressions, 1.3f + call * 1e-5f);
+	}
+
+	const auto inlineNanoseconds = std::chrono::duration<double, std::nano>(std::chrono::high_resolution_clock::now() - start).count() / calls;
+
+	const auto parameters = ImplicitSceneParameters::FromTime(1.3f);
+	const ScenePoints points(parameters);
+
+	start = std::chrono::high_resolution_clock::now();
+
+	for (auto i = 0u; i < ScenePoints::Count; i++)
+	{
+		checksum += ImplicitSceneSdf::Evaluate(parameters, points.points[i]).distance;
+	}
+
+	const auto sceneNanoseconds = std::chrono::duration<double, std::nano>(std::chrono::high_resolution_clock::now() - start).count() / ScenePoints::Count;
+
+	start = std::chrono::high_resolution_clock::now();
+
+	for (auto frame = 0u; frame < calls; frame++)
+	{
+		checksum += ImplicitSceneParameters::FromTime(1.3f + frame * 1e-5f).morph;
+	}
+
+	const auto perFrameNanoseconds = std::chrono::duration<double, std::nano>(std::chrono::high_resolution_clock::now() - start).count() / calls;
+
+	report.AddLine("Per sceneSDF call the shader worked out " + std::to_string(counted.trigonometry) + " sins and coss and " + std::to_string(counted.lerps) + " lerps from time, 16 of the sins and coss in mandelBulb's rotations, power and colour, and now reads them from timeConstantBuffer "
+		+ "(counted as if every object were evaluated, the hierarchy skips some of them and their share). On the CPU those expressions take " + PerformanceReport::Format(inlineNanoseconds, 1) + " ns a call against " + PerformanceReport::Format(sceneNanoseconds, 1) + " ns for a whole scalar sceneSDF evaluation with the parameters, and FromTime takes "
+		+ PerformanceReport::Format(perFrameNanoseconds, 1) + " ns once a frame (checksum " + PerformanceReport::Format(checksum) + ")");
+}
+
+void Benchmarks::RunImplicitSceneIntervalPruning(PerformanceReport& report)
+{
+	const auto width = 640u;
+	const auto height = 360u;
+
+	struct View
+	{
+		const char* name;
+		DirectX::XMFLOAT3 eye;
+		DirectX::XMFLOAT3 target;
+		float time;
+	};
+
+	const View views[] =
+	{
+		{ "Gallery", DirectX::XMFLOAT3(2.5f, 1.6f, 2.5f), DirectX::XMFLOAT3(0.0f, 0.6f, 0.0f), 1.3f },
+		{ "Ship", DirectX::XMFLOAT3(0.0f, 2.2f, 3.0f), DirectX::XMFLOAT3(0.0f, 2.1f, 0.0f), 2.0f },
+		{ "Mandelbulb", DirectX::XMFLOAT3(-2.5f, 2.2f, -2.5f), DirectX::XMFLOAT3(-4.0f, 2.0f, -4.0f), 10.0f },
+		{ "Everything", DirectX::XMFLOAT3(9.0f, 3.0f, 9.0f), DirectX::XMFLOAT3(-0.5f, 1.5f, -0.5f), 1.3f }
+	};
+
+	struct Mode
+	{
+		const char* name;
+		bool useHierarchy;
+		bool intervalPruning;
+		unsigned int tileSize;
+	};
+
+	const Mode modes[] =
+	{
+		{ "Every object", false, false, 16 },
+		{ "Hierarchy", true, false, 16 },
+		{ "Interval pruning", true, true, 16 },
+		{ "Interval pruning, 8 pixel tiles", true, true, 8 },
+		{ "Interval pruning, 32 pixel tiles", true, true, 32 }
+	};
+
+	auto scenePrimitives = 0u;
+
+	for (auto object = 0u; object < ImplicitSceneSdf::ObjectCount; object++)
+	{
+		scenePrimitives += ImplicitSceneSdf::GetObjectCost(object);
+	}
+
+	std::vector<std::vector<std::string>> rows;
+
+	for (const auto& view : views)
+	{
+		HeadlessImage reference(width, height);
+		auto referenceMilliseconds = 0.0;
+
+		for (const auto& mode : modes)
+		{
+			ImplicitRayMarcherSettings settings;
+			settings.useHierarchy = mode.useHierarchy;
+			settings.intervalPruning = mode.intervalPruning;
+			settings.tileSize = mode.tileSize;
+
+			HeadlessImage image(width, height);
+			const auto stats = ImplicitRayMarcher(settings).Render(ImplicitRayMarcher::LookAt(view.eye, view.target), view.time, image);
+
+			if (mode.useHierarchy && !mode.intervalPruning)
+			{
+				reference = image;
+				referenceMilliseconds = stats.milliseconds;
+			}
+
+			const auto& pruning = stats.pruning;
+			const auto tiles = ((width + mode.tileSize - 1) / mode.tileSize) * ((height + mode.tileSize - 1) / mode.tileSize);
+
+			rows.push_back({
+				view.name,
+				mode.name,
+				PerformanceReport::Format(stats.milliseconds, 1),
+				referenceMilliseconds > 0.0 ? PerformanceReport::Format(referenceMilliseconds / stats.milliseconds) + "x" : "-",
+				PerformanceReport::Format(stats.GetObjectsPerRay(), 1),
+				PerformanceReport::Format(stats.GetBoundTestsPerRay(), 1),
+				mode.intervalPruning ? PerformanceReport::Format(static_cast<double>(pruning.regions) / tiles, 1) : "-",
+				mode.intervalPruning ? PerformanceReport::Format(pruning.GetObjectsPerRegion()) + " / " + std::to_string(pruning.maxKeptObjects) : "-",
+				mode.intervalPruning ? PerformanceReport::Format(pruning.GetPrimitivesPerRegion(), 1) : "-",
+				mode.intervalPruning ? PerformanceReport::Format(pruning.GetEvaluationsPerRegion(), 1) : "-",
+				mode.intervalPruning ? PerformanceReport::Format(pruning.milliseconds, 1) : "-",
+				referenceMilliseconds > 0.0 ? std::to_string(CountDifferingPixels(image, reference)) : "-"
+			});
+		}
+	}
+
+	report.AddSection("Implicit scene interval pruning");
+	report.AddLine(std::to_string(width) + "x" + std::to_string(height) + ", each tile's frustum cut into " + std::to_string(ImplicitSceneIntervals::SlabCount) + " depth slabs pruned the first time the tile samples in them. The whole scene is "
+		+ std::to_string(ImplicitSceneSdf::ObjectCount) + " objects and " + std::to_string(scenePrimitives) + " primitives. Objects and bound tests are per pixel including the normals, slabs are per tile, and the slabs' objects are the mean and most "
+		+ "kept, their primitives the mean, and their evaluations the objects evaluated at slab centres to bound them. Pruning ms is CPU time over all the threads, and speedup and pixels differing are against the hierarchy");
+	report.AddTable({ "View", "Mode", "ms", "Speedup", "Objects", "Bound tests", "Slabs", "Slab objects", "Slab primitives", "Slab evaluations", "Pruning ms", "Pixels differing" }, rows);
+}
+
+namespace
+{
+	//Like ImplicitRayMarcher's, through a canvas one unit in front of the camera that is two units wide, so a pixel at
+	//the centre is two over the width radians across
+	struct CoverageCamera
+	{
+		Sdf::Vec3<float> eye;
+		Sdf::Vec3<float> forward;
+		Sdf::Vec3<float> right;
+		Sdf::Vec3<float> up;
+		unsigned int width;
+		unsigned int height;
+
+		CoverageCamera(const Sdf::Vec3<float>& eyeIn, const Sdf::Vec3<float>& target, const unsigned int widthIn, const unsigned int heightIn) : eye(eyeIn), width(widthIn), height(heightIn)
+		{
+			forward = Sdf::Normalize(target - eye);
+			right = Sdf::Normalize(Sdf::Vec3<float>(-forward.z, 0.0f, forward.x));
+			up = Sdf::Vec3<float>(right.y * forward.z - right.z * forward.y, right.z * forward.x - right.x * forward.z, right.x * forward.y - right.y * forward.x);
+		}
+
+		float GetAspectRatio() const { return static_cast<float>(height) / width; }
+
+		Sdf::Vec3<float> GetRayDirection(const float x, const float y) const
+		{
+			const auto canvasX = x / width * 2.0f - 1.0f;
+			const auto canvasY = (1.0f - y / height * 2.0f) * GetAspectRatio();
+
+			return Sdf::Normalize(right * canvasX + up * canvasY + forward);
+		}
+
+		//Into pixels, false behind the camera
+		bool Project(const Sdf::Vec3<float>& p, float& x, float& y) const
+		{
+			const auto offset = p - eye;
+			const auto depth = Sdf::Dot(offset, forward);
+
+			if (depth <= 0.0f)
+			{
+				return false;
+			}
+
+			x = (Sdf::Dot(offset, right) / depth + 1.0f) * 0.5f * width;
+			y = (1.0f - Sdf::Dot(offset, up) / depth / GetAspectRatio()) * 0.5f * height;
+
+			return true;
+		}
+	};
+
+	//How far p is from the nearest point of the box
+	float DistanceToBox(const ImplicitSceneBounds& bounds, const Sdf::Vec3<float>& p)
+	{
+		const auto outside = Sdf::Vec3<float>(
+			std::max(std::max(bounds.minimum.x - p.x, p.x - bounds.maximum.x), 0.0f),
+			std::max(std::max(bounds.minimum.y - p.y, p.y - bounds.maximum.y), 0.0f),
+			std::max(std::max(bounds.minimum.z - p.z, p.z - bounds.maximum.z), 0.0f));
+
+		return Sdf::Length(outside);
+	}
+
+	//The pixels the object covers marched on its own, stopping at ImplicitSceneSdf::Epsilon like the shader. Outside its
+	//box the steps are the box's distance, as the Mandelbulb's estimate overshoots from far away where in the scene the
+	//hierarchy's box or another object's distance holds it back
+	std::vector<unsigned char> MarchObjectCoverage(const ImplicitSceneParameters& parameters, const unsigned int object, const ImplicitSceneBounds& bounds, const CoverageCamera& camera)
+	{
+		std::vector<unsigned char> coverage(camera.width * camera.height, 0);
+
+		concurrency::parallel_for(0u, camera.height, [&](const unsigned int y)
+		{
+			for (auto x = 0u; x < camera.width; x++)
+			{
+				const auto direction = camera.GetRayDirection(x + 0.5f, y + 0.5f);
+				auto depth = 0.0f;
+
+				for (auto step = 0; step < ImplicitSceneSdf::MaxMarchingSteps && depth < ImplicitSceneSdf::MaxDistance; step++)
+				{
+					const auto p = camera.eye + direction * depth;
+					const auto boxDistance = DistanceToBox(bounds, p);
+
+					if (boxDistance > 0.0f)
+					{
+						depth += std::max(boxDistance * bounds.distanceScale, ImplicitSceneSdf::Epsilon);
+						continue;
+					}
+
+					const auto distance = ImplicitSceneSdf::EvaluateObject(parameters, object, p).distance;
+
+					if (distance < ImplicitSceneSdf::Epsilon)
+					{
+						coverage[y * camera.width + x] = 1;
+						break;
+					}
+
+					depth += distance;
+				}
+			}
+		});
+
+		return coverage;
+	}
+
+	//The pixels whose centres the mesh's triangles cover
+	std::vector<unsigned char> RasteriseCoverage(const ImplicitMeshLod& lod, const CoverageCamera& camera)
+	{
+		std::vector<unsigned char> coverage(camera.width * camera.height, 0);
+
+		for (auto triangle = 0u; triangle < lod.GetTriangleCount(); triangle++)
+		{
+			float x[3], y[3];
+			auto visible = true;
+
+			for (auto corner = 0; corner < 3; corner++)
+			{
+				const auto& position = lod.vertices[lod.indices[triangle * 3 + corner]].position;
+				visible = visible && camera.Project(Sdf::Vec3<float>(position.x, position.y, position.z), x[corner], y[corner]);
+			}
+
+			const auto area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+
+			if (!visible || area == 0.0f)
+			{
+				continue;
+			}
+
+			const auto left = static_cast<int>(std::max(std::floor(std::min(x[0], std::min(x[1], x[2]))), 0.0f));
+			const auto right = static_cast<int>(std::min(std::ceil(std::max(x[0], std::max(x[1], x[2]))), static_cast<float>(camera.width)));
+			const auto top = static_cast<int>(std::max(std::floor(std::min(y[0], std::min(y[1], y[2]))), 0.0f));
+			const auto bottom = static_cast<int>(std::min(std::ceil(std::max(y[0], std::max(y[1], y[2]))), static_cast<float>(camera.height)));
+
+			//Either winding, the meshes are drawn without culling
+			const auto sign = area > 0.0f ? 1.0f : -1.0f;
+
+			for (auto py = top; py < bottom; py++)
+			{
+				for (auto px = left; px < right; px++)
+				{
+					const auto cx = px + 0.5f;
+					const auto cy = py + 0.5f;
+					auto inside = true;
+
+					for (auto edge = 0; edge < 3 && inside; edge++)
+					{
+						const auto next = (edge + 1) % 3;
+						inside = sign * ((x[next] - x[edge]) * (cy - y[edge]) - (cx - x[edge]) * (y[next] - y[edge])) >= 0.0f;
+					}
+
+					if (inside)
+					{
+						coverage[py * camera.width + px] = 1;
+					}
+				}
+			}
+		}
+
+		return coverage;
+	}
+}
+
+void Benchmarks::RunImplicitSceneMeshing(PerformanceReport& report)
+{
+	const auto width = 320u;
+	const auto height = 180u;
+	const auto tolerance = 1.0f;
+
+	struct MeshedObject
+	{
+		const char* name;
+		unsigned int object;
+	};
+
+	//The Mandelbulb animates, so its mesh is for this one time and only shows what extracting it costs
+	const MeshedObject objects[] =
+	{
+		{ "Sierpinski", 6 },
+		{ "Mandelbulb", 5 }
+	};
+
+	const auto resolutions = ImplicitMeshedObjects::GetLodResolutions();
+	const float distances[] = { 1.0f, 2.0f, 4.0f, 8.0f, 16.0f };
+
+	const auto parameters = ImplicitSceneParameters::FromTime(0.0f);
+
+	std::vector<std::vector<std::string>> meshRows;
+	std::vector<std::vector<std::string>> silhouetteRows;
+
+	for (const auto& meshed : objects)
+	{
+		const ImplicitSceneMesher mesher(parameters, meshed.object);
+		const auto lods = mesher.GenerateLods(resolutions);
+		const auto serialMilliseconds = ImplicitSceneMesher(parameters, meshed.object, false).Generate(resolutions[1]).generationMilliseconds;
+
+		for (auto i = 0u; i < lods.size(); i++)
+		{
+			const auto& lod = lods[i];
+
+			meshRows.push_back({
+				meshed.name,
+				std::to_string(lod.resolution),
+				PerformanceReport::Format(lod.cellSize, 4),
+				std::to_string(lod.vertices.size()),
+				std::to_string(lod.GetTriangleCount()),
+				PerformanceReport::Format(lod.generationMilliseconds, 1),
+				i == 1 ? PerformanceReport::Format(serialMilliseconds, 1) : "-",
+				PerformanceReport::Format(lod.maxError, 4)
+			});
+		}
+
+		const auto& bounds = mesher.GetBounds();
+		const auto centre = (bounds.minimum + bounds.maximum) * 0.5f;
+		const auto viewDirection = Sdf::Normalize(Sdf::Vec3<float>(1.0f, 0.5f, 1.3f));
+		const auto radius = Sdf::Length(bounds.maximum - bounds.minimum) * 0.5f;
+
+		for (const auto distance : distances)
+		{
+			const CoverageCamera camera(centre + viewDirection * (radius + distance), centre, width, height);
+			const auto marched = MarchObjectCoverage(parameters, meshed.object, bounds, camera);
+			const auto objectPixels = std::count(marched.begin(), marched.end(), 1);
+
+			std::vector<std::string> row = { meshed.name, PerformanceReport::Format(DistanceToBox(bounds, camera.eye), 1), std::to_string(objectPixels) };
+
+			for (const auto& lod : lods)
+			{
+				const auto rasterised = RasteriseCoverage(lod, camera);
+				auto differing = 0;
+
+				for (auto pixel = 0u; pixel < marched.size(); pixel++)
+				{
+					differing += marched[pixel] != rasterised[pixel] ? 1 : 0;
+				}
+
+				row.push_back(std::to_string(differing));
+			}
+
+			const auto selected = ImplicitSceneMesher::SelectLod(lods, DistanceToBox(bounds, camera.eye), 2.0f / width, tolerance);
+			row.push_back(selected == ImplicitSceneMesher::RayMarched ? "Ray marched" : std::to_string(lods[selected].resolution));
+
+			silhouetteRows.push_back(row);
+		}
+	}
+
+	std::vector<std::string> silhouetteHeaders = { "Object", "Distance", "Object pixels" };
+
+	for (const auto resolution : resolutions)
+	{
+		silhouetteHeaders.push_back(std::to_string(resolution) + " differing");
+	}
+
+	silhouetteHeaders.push_back("Selected");
+
+	report.AddSection("Implicit scene meshing");
+	report.AddLine("Dual contouring of the objects' SDFs at time 0 over their boxes, resolution is cells along the longest side. Max error is the furthest the SDF puts a vertex or triangle centre from the surface, "
+		+ std::string("and serial ms is the same mesh on one thread"));
+	report.AddTable({ "Object", "Resolution", "Cell", "Vertices", "Triangles", "ms", "Serial ms", "Max error" }, meshRows);
+	report.AddLine("Silhouettes at " + std::to_string(width) + "x" + std::to_string(height) + ", the object ray marched on its own against each mesh's coverage of the pixel centres, from the distance to the object's box. "
+		+ "Selected is ImplicitSceneMesher::SelectLod's pick for a " + PerformanceReport::Format(tolerance, 1) + " pixel tolerance");
+	report.AddTable(silhouetteHeaders, silhouetteRows);
+}
+
+namespace
+{
+	//What a rasterized ground plane at groundHeight and a sphere would leave in the depth buffer, through the middle of
+	//each pixel of the ray marcher's canvas and projected the way the renderer's projection would. Either can be left
+	//out, a negative radius for the sphere
+	std::vector<float> MakeSyntheticDepths(const DirectX::XMMATRIX& view, const DirectX::XMMATRIX& projection, const unsigned int width, const unsigned int height, const bool ground, const float groundHeight, const Sdf::Vec3<float>& sphereCentre, const float sphereRadius)
+	{
+		DirectX::XMFLOAT4X4 inverseView;
+		DirectX::XMStoreFloat4x4(&inverseView, DirectX::XMMatrixInverse(nullptr, view));
+
+		const auto right = Sdf::Vec3<float>(inverseView._11, inverseView._12, inverseView._13);
+		const auto up = Sdf::Vec3<float>(inverseView._21, inverseView._22, inverseView._23);
+		const auto back = Sdf::Vec3<float>(inverseView._31, inverseView._32, inverseView._33);
+		const auto eye = Sdf::Vec3<float>(inverseView._41, inverseView._42, inverseView._43);
+		const auto aspectRatio = static_cast<float>(height) / width;
+		const auto viewProjection = view * projection;
+
+		std::vector<float> depths(width * height, 1.0f);
+
+		for (auto y = 0u; y < height; y++)
+		{
+			for (auto x = 0u; x < width; x++)
+			{
+				const auto canvasX = (x + 0.5f) / width * 2.0f - 1.0f;
+				const auto canvasY = (1.0f - (y + 0.5f) / height * 2.0f) * aspectRatio;
+				const auto direction = Sdf::Normalize(right * canvasX + up * canvasY - back);
+
+				auto nearest = 1e30f;
+
+				if (ground && std::abs(direction.y) > 1e-6f)
+				{
+					const auto t = (groundHeight - eye.y) / direction.y;
+
+					if (t > 0.0f)
+					{
+						nearest = t;
+					}
+				}
+
+				if (sphereRadius > 0.0f)
+				{
+					const auto offset = eye - sphereCentre;
+					const auto b = Sdf::Dot(offset, direction);
+					const auto discriminant = b * b - (Sdf::Dot(offset, offset) - sphereRadius * sphereRadius);
+
+					if (discriminant >= 0.0f && -b - std::sqrt(discriminant) > 0.0f)
+					{
+						nearest = std::min(nearest, -b - std::sqrt(discriminant));
+					}
+				}
+
+				if (nearest >= 1e30f)
+				{
+					continue;
+				}
+
+				const auto point = eye + direction * nearest;
+				const auto projected = DirectX::XMVector3TransformCoord(DirectX::XMVectorSet(point.x, point.y, point.z, 1.0f), viewProjection);
+
+				depths[y * width + x] = std::min(DirectX::XMVectorGetZ(projected), 1.0f);
+			}
+		}
+
+		return depths;
+	}
+}
+
+void Benchmarks::RunImplicitSceneDepthLimits(PerformanceReport& report)
+{
+	const auto width = 320u;
+	const auto height = 180u;
+
+	struct View
+	{
+		const char* name;
+		DirectX::XMFLOAT3 eye;
+		DirectX::XMFLOAT3 target;
+		float time;
+	};
+
+	const View views[] =
+	{
+		{ "Gallery", DirectX::XMFLOAT3(2.5f, 1.6f, 2.5f), DirectX::XMFLOAT3(0.0f, 0.6f, 0.0f), 1.3f },
+		{ "Ship", DirectX::XMFLOAT3(0.0f, 2.2f, 3.0f), DirectX::XMFLOAT3(0.0f, 2.1f, 0.0f), 2.0f },
+		{ "Mandelbulb", DirectX::XMFLOAT3(-2.5f, 2.2f, -2.5f), DirectX::XMFLOAT3(-4.0f, 2.0f, -4.0f), 10.0f }
+	};
+
+	struct Raster
+	{
+		const char* name;
+		bool ground;
+		//Along the way from the eye to the target, 0 for no sphere
+		float sphereAlong;
+	};
+
+	//The ground stands in for the terrain and the sea, cutting off the bottom of the objects and everything past the
+	//horizon's height, and the sphere for one of the tessellated spheres in front of the objects
+	const Raster rasters[] =
+	{
+		{ "None", false, 0.0f },
+		{ "Ground", true, 0.0f },
+		{ "Sphere", false, 0.45f },
+		{ "Ground and sphere", true, 0.45f }
+	};
+
+	const auto groundHeight = 0.45f;
+	const auto sphereRadius = 0.3f;
+	const unsigned int coneLevels[] = { 0, 3 };
+
+	//The renderer's projection, before the screen's orientation turns it
+	const auto projection = DirectX::XMMatrixPerspectiveFovRH(70.0f * DirectX::XM_PI / 180.0f, static_cast<float>(width) / height, 0.01f, 100.0f);
+
+	std::vector<std::vector<std::string>> rows;
+
+	for (const auto& view : views)
+	{
+		const auto viewMatrix = ImplicitRayMarcher::LookAt(view.eye, view.target);
+
+		for (const auto levels : coneLevels)
+		{
+			ImplicitRayMarcherSettings settings;
+			settings.coneLevels = levels;
+
+			const ImplicitRayMarcher marcher(settings);
+
+			HeadlessImage reference(width, height);
+			ImplicitRayMarcherTrace referenceTrace;
+			const auto referenceStats = marcher.Render(viewMatrix, view.time, reference, &referenceTrace);
+			const auto referenceEvaluations = referenceStats.GetAverageSteps() + referenceStats.GetAverageConeSteps();
+
+			for (const auto& raster : rasters)
+			{
+				const auto eye = Sdf::Vec3<float>(view.eye.x, view.eye.y, view.eye.z);
+				const auto target = Sdf::Vec3<float>(view.target.x, view.target.y, view.target.z);
+				const auto depths = MakeSyntheticDepths(viewMatrix, projection, width, height, raster.ground, groundHeight, eye + (target - eye) * raster.sphereAlong, raster.sphereAlong > 0.0f ? sphereRadius : -1.0f);
+
+				const auto pyramidStart = std::chrono::high_resolution_clock::now();
+				const ImplicitDepthPyramid depthLimits(depths, width, height, projection);
+				const auto pyramidMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - pyramidStart).count();
+
+				HeadlessImage image(width, height);
+				const auto stats = marcher.Render(viewMatrix, view.time, image, nullptr, nullptr, &depthLimits);
+
+				//What the depth test would have left of the full march, the hits in front of the raster and the
+				//background everywhere else
+				HeadlessImage expected = reference;
+
+				for (auto y = 0u; y < height; y++)
+				{
+					for (auto x = 0u; x < width; x++)
+					{
+						if (referenceTrace.depths[y * width + x] > depthLimits.GetLimit(x, y) - ImplicitSceneSdf::Epsilon)
+						{
+							expected.SetPixel(x, y, settings.background);
+						}
+					}
+				}
+
+				const auto evaluations = stats.GetAverageSteps() + stats.GetAverageConeSteps();
+
+				rows.push_back({
+					view.name,
+					levels == 0 ? "Off" : std::to_string(16u >> (levels - 1)) + " px",
+					raster.name,
+					PerformanceReport::Format(depthLimits.GetCoverage() * 100.0f, 1),
+					PerformanceReport::Format(pyramidMilliseconds, 2),
+					PerformanceReport::Format(referenceStats.milliseconds, 1),
+					PerformanceReport::Format(stats.milliseconds, 1),
+					PerformanceReport::Format(stats.GetAverageSteps()),
+					PerformanceReport::Format(stats.GetAverageConeSteps()),
+					PerformanceReport::Format(referenceEvaluations > 0.0 ? (1.0 - evaluations / referenceEvaluations) * 100.0 : 0.0, 1),
+					PerformanceReport::Format(stats.rays > 0 ? 100.0 * stats.occludedRays / stats.rays : 0.0, 1),
+					std::to_string(CountDifferingPixels(expected, image))
+				});
+			}
+		}
+	}
+
+	report.AddSection("Implicit scene depth limits");
+	report.AddLine(std::to_string(width) + "x" + std::to_string(height) + ", synthetic depth buffers from a ground plane at y = " + PerformanceReport::Format(groundHeight, 2) + " and a sphere of radius "
+		+ PerformanceReport::Format(sphereRadius, 2) + " part way to the target. Steps saved are ray and cone steps against the same cones without limits, and pixels differing are against the full march with the depth test applied");
+	report.AddTable({ "View", "Finest cone", "Raster", "Covered %", "Pyramid ms", "Full ms", "ms", "Ray steps", "Cone steps", "Steps saved %", "Occluded %", "Pixels differing" }, rows);
+}
+
+void Benchmarks::RunImplicitSceneTileBinning(PerformanceReport& report)
+{
+	const auto width = 640u;
+	const auto height = 360u;
+
+	struct View
+	{
+		const char* name;
+		DirectX::XMFLOAT3 eye;
+		DirectX::XMFLOAT3 target;
+		float time;
+	};
+
+	//Looking down at the gallery keeps the infinite shapes above the screen, so the tiles around it have nothing in them
+	const View views[] =
+	{
+		{ "Gallery", DirectX::XMFLOAT3(2.5f, 1.6f, 2.5f), DirectX::XMFLOAT3(0.0f, 0.6f, 0.0f), 1.3f },
+		{ "Gallery from above", DirectX::XMFLOAT3(0.8f, 2.2f, 0.8f), DirectX::XMFLOAT3(0.0f, 0.5f, 0.0f), 1.3f },
+		{ "Ship", DirectX::XMFLOAT3(0.0f, 2.2f, 3.0f), DirectX::XMFLOAT3(0.0f, 2.1f, 0.0f), 2.0f },
+		{ "Mandelbulb", DirectX::XMFLOAT3(-2.5f, 2.2f, -2.5f), DirectX::XMFLOAT3(-4.0f, 2.0f, -4.0f), 10.0f },
+		{ "Everything", DirectX::XMFLOAT3(9.0f, 3.0f, 9.0f), DirectX::XMFLOAT3(-0.5f, 1.5f, -0.5f), 1.3f }
+	};
+
+	struct Mode
+	{
+		const char* name;
+		bool intervalPruning;
+		bool tileBinning;
+	};
+
+	const Mode modes[] =
+	{
+		{ "Hierarchy", false, false },
+		{ "Hierarchy, binned", false, true },
+		{ "Interval pruning", true, false },
+		{ "Interval pruning, binned", true, true }
+	};
+
+	std::vector<std::vector<std::string>> occupancyRows;
+	std::vector<std::vector<std::string>> rows;
+
+	for (const auto& view : views)
+	{
+		const auto viewMatrix = ImplicitRayMarcher::LookAt(view.eye, view.target);
+
+		const ImplicitSceneTileBins bins(ImplicitSceneHierarchy::GetObjectBounds(ImplicitSceneParameters::FromTime(view.time)), viewMatrix, width, height);
+		const auto tiles = bins.GetColumns() * bins.GetRows();
+
+		occupancyRows.push_back({
+			view.name,
+			std::to_string(tiles),
+			PerformanceReport::Format(100.0 * bins.GetEmptyTileCount() / tiles, 1),
+			PerformanceReport::Format(bins.GetAverageObjectsPerTile(), 1),
+			std::to_string(bins.GetMaxObjectsPerTile()),
+			PerformanceReport::Format(bins.GetMilliseconds(), 3)
+		});
+
+		HeadlessImage reference(width, height);
+		auto referenceMilliseconds = 0.0;
+
+		for (const auto& mode : modes)
+		{
+			ImplicitRayMarcherSettings settings;
+			settings.intervalPruning = mode.intervalPruning;
+			settings.tileBinning = mode.tileBinning;
+
+			HeadlessImage image(width, height);
+			const auto stats = ImplicitRayMarcher(settings).Render(viewMatrix, view.time, image);
+
+			if (!mode.intervalPruning && !mode.tileBinning)
+			{
+				reference = image;
+				referenceMilliseconds = stats.milliseconds;
+			}
+
+			rows.push_back({
+				view.name,
+				mode.name,
+				PerformanceReport::Format(stats.milliseconds, 1),
+				PerformanceReport::Format(referenceMilliseconds / stats.milliseconds) + "x",
+				PerformanceReport::Format(stats.GetAverageSteps()),
+				PerformanceReport::Format(stats.GetObjectsPerRay(), 1),
+				PerformanceReport::Format(stats.GetBoundTestsPerRay(), 1),
+				PerformanceReport::Format(stats.rays > 0 ? 100.0 * stats.skippedRays / stats.rays : 0.0, 1),
+				std::to_string(CountDifferingPixels(image, reference))
+			});
+		}
+	}
+
+	report.AddSection("Implicit scene tile binning");
+	report.AddLine(std::to_string(width) + "x" + std::to_string(height) + ", each object's box projected onto the screen and binned into 16 pixel tiles. Empty tiles are skipped, and the objects are the mean and most in a tile's list");
+	report.AddTable({ "View", "Tiles", "Empty %", "Objects", "Most objects", "Binning ms" }, occupancyRows);
+	report.AddLine("Marching the same views with and without the bins. Objects and bound tests are per pixel including the normals, skipped is the rays in empty tiles, and speedup and pixels differing are against the hierarchy. "
+		"The tiles with the fractals, the wobbly sphere, the twisted torus or the ellipsoids evaluate every object, as where a ray lands on them depends on how far the others let it step. "
+		"Any pixels left differing are on the edges of the other objects, where a ray stopping a fraction of Epsilon further along gets a different normal");
+	report.AddTable({ "View", "Mode", "ms", "Speedup", "Steps", "Objects", "Bound tests", "Skipped %", "Pixels differing" }, rows);
+}
+
+void Benchmarks::RunImplicitSceneAdaptiveSubdivision(PerformanceReport& report)
+{
+	const auto width = 640u;
+	const auto height = 360u;
+
+	struct View
+	{
+		const char* name;
+		DirectX::XMFLOAT3 eye;
+		DirectX::XMFLOAT3 target;
+		float time;
+	};
+
+	const View views[] =
+	{
+		{ "Gallery", DirectX::XMFLOAT3(2.5f, 1.6f, 2.5f), DirectX::XMFLOAT3(0.0f, 0.6f, 0.0f), 1.3f },
+		{ "Ship", DirectX::XMFLOAT3(0.0f, 2.2f, 3.0f), DirectX::XMFLOAT3(0.0f, 2.1f, 0.0f), 2.0f },
+		{ "Mandelbulb", DirectX::XMFLOAT3(-2.5f, 2.2f, -2.5f), DirectX::XMFLOAT3(-4.0f, 2.0f, -4.0f), 10.0f },
+		{ "Everything", DirectX::XMFLOAT3(9.0f, 3.0f, 9.0f), DirectX::XMFLOAT3(-0.5f, 1.5f, -0.5f), 1.3f }
+	};
+
+	struct Mode
+	{
+		unsigned int blockSize;
+		float depthRatio;
+	};
+
+	const Mode modes[] =
+	{
+		{ 4, 0.05f },
+		{ 8, 0.05f },
+		{ 16, 0.05f },
+		{ 8, 0.01f },
+		{ 8, 0.2f }
+	};
+
+	std::vector<std::vector<std::string>> rows;
+
+	for (const auto& view : views)
+	{
+		const auto viewMatrix = ImplicitRayMarcher::LookAt(view.eye, view.target);
+
+		HeadlessImage reference(width, height);
+		const auto referenceStats = ImplicitRayMarcher().Render(viewMatrix, view.time, reference);
+
+		rows.push_back({ view.name, "Off", "-", std::to_string(referenceStats.rays), "100.0", PerformanceReport::Format(referenceStats.milliseconds, 1), "1.00x", "-", "-" });
+
+		for (const auto& mode : modes)
+		{
+			ImplicitRayMarcherSettings settings;
+			settings.adaptiveBlockSize = mode.blockSize;
+			settings.adaptiveDepthRatio = mode.depthRatio;
+
+			HeadlessImage image(width, height);
+			const auto stats = ImplicitRayMarcher(settings).Render(viewMatrix, view.time, image);
+
+			rows.push_back({
+				view.name,
+				std::to_string(mode.blockSize) + " px",
+				PerformanceReport::Format(mode.depthRatio),
+				std::to_string(stats.rays),
+				PerformanceReport::Format(100.0 * stats.rays / (width * height), 1),
+				PerformanceReport::Format(stats.milliseconds, 1),
+				PerformanceReport::Format(referenceStats.milliseconds / stats.milliseconds) + "x",
+				PerformanceReport::Format(MeanPixelDifference(image, reference), 3),
+				std::to_string(CountDifferingPixels(image, reference))
+			});
+		}
+	}
+
+	report.AddSection("Implicit scene adaptive subdivision");
+	report.AddLine(std::to_string(width) + "x" + std::to_string(height) + ", blocks marched at their corners and split where the corners hit different objects or depths further apart than the ratio, the rest of their pixels interpolated. "
+		"Rays are the ones marched in the frame. Mean error is the mean difference from marching every pixel out of 255 per channel, and pixels differing are the ones more than 1 out");
+	report.AddTable({ "View", "Block", "Depth ratio", "Rays", "Rays %", "ms", "Speedup", "Mean error", "Pixels differing" }, rows);
+}
+
+void Benchmarks::RunImplicitSceneCheckerboard(PerformanceReport& report)
+{
+	const auto width = 320u;
+	const auto height = 180u;
+	const auto frames = 24u;
+
+	std::vector<std::vector<std::string>> rows;
+
+	for (const auto& path : GetCameraPaths())
+	{
+		ImplicitRayMarcherSettings settings;
+		settings.checkerboard = true;
+
+		const ImplicitRayMarcher marcher;
+		const ImplicitRayMarcher checkerboardMarcher(settings);
+
+		//The spatial run's history is forgotten before every frame, so the pattern still alternates
+		ImplicitCheckerboardHistory history;
+		ImplicitCheckerboardHistory spatialHistory;
+
+		struct Totals
+		{
+			double milliseconds;
+			double reconstructionMilliseconds;
+			unsigned long long rays;
+			unsigned long long reconstructedPixels;
+			unsigned long long historyPixels;
+			double meanError;
+			unsigned int differingPixels;
+		};
+
+		Totals full = {};
+		Totals temporal = {};
+		Totals spatial = {};
+
+		const auto add = [](Totals& totals, const ImplicitRayMarcherStats& stats)
+		{
+			totals.milliseconds += stats.milliseconds;
+			totals.reconstructionMilliseconds += stats.checkerboard.milliseconds;
+			totals.rays += stats.rays;
+			totals.reconstructedPixels += stats.checkerboard.reconstructedPixels;
+			totals.historyPixels += stats.checkerboard.historyPixels;
+		};
+
+		for (auto frame = 0u; frame < frames; frame++)
+		{
+			DirectX::XMFLOAT3 eye, target;
+			auto time = 0.0f;
+			path.camera(frame, eye, target, time);
+
+			const auto view = ImplicitRayMarcher::LookAt(eye, target);
+
+			HeadlessImage reference(width, height);
+			const auto fullStats = marcher.Render(view, time, reference);
+
+			HeadlessImage image(width, height);
+			const auto stats = checkerboardMarcher.Render(view, time, image, nullptr, nullptr, nullptr, &history);
+
+			spatialHistory.Reset();
+
+			HeadlessImage spatialImage(width, height);
+			const auto spatialStats = checkerboardMarcher.Render(view, time, spatialImage, nullptr, nullptr, nullptr, &spatialHistory);
+
+			//The first frame has no history, so it's only there to fill it
+			if (frame == 0)
+			{
+				continue;
+			}
+
+			add(full, fullStats);
+			add(temporal, stats);
+			add(spatial, spatialStats);
+
+			temporal.meanError += MeanPixelDifference(image, reference);
+			temporal.differingPixels += CountDifferingPixels(image, reference);
+			spatial.meanError += MeanPixelDifference(spatialImage, reference);
+			spatial.differingPixels += CountDifferingPixels(spatialImage, reference);
+		}
+
+		const auto measuredFrames = frames - 1;
+
+		for (const auto& mode : { std::make_pair("Full", &full), std::make_pair("Checkerboard", &temporal), std::make_pair("Spatial only", &spatial) })
+		{
+			const auto& totals = *mode.second;
+			const auto reconstructed = totals.reconstructedPixels > 0;
+
+			rows.push_back({
+				path.name,
+				mode.first,
+				PerformanceReport::Format(totals.milliseconds / measuredFrames, 1),
+				PerformanceReport::Format(full.milliseconds / totals.milliseconds) + "x",
+				PerformanceReport::Format(100.0 * totals.rays / (static_cast<double>(width) * height * measuredFrames), 1),
+				reconstructed ? PerformanceReport::Format(100.0 * totals.historyPixels / totals.reconstructedPixels, 1) : "-",
+				reconstructed ? PerformanceReport::Format(totals.reconstructionMilliseconds / measuredFrames, 2) : "-",
+				reconstructed ? PerformanceReport::Format(totals.meanError / measuredFrames, 3) : "-",
+				reconstructed ? PerformanceReport::Format(static_cast<double>(totals.differingPixels) / measuredFrames, 1) : "-"
+			});
+		}
+	}
+
+	report.AddSection("Implicit scene checkerboard");
+	report.AddLine(std::to_string(width) + "x" + std::to_string(height) + ", " + std::to_string(frames) + " frames along the temporal cache's paths, every frame marched in full, then with checkerboard reconstructing the half it didn't march from last frame's image, and again from the marched half alone. "
+		"History is the reconstructed pixels taken from last frame, and the rest were interpolated. Mean error is the mean difference from the full march out of 255 per channel and pixels differing are the ones more than 1 out, both per frame after the first");
+	report.AddTable({ "Path", "Mode", "ms", "Speedup", "Rays %", "History %", "Reconstruct ms", "Mean error", "Pixels differing" }, rows);
+}
+
+namespace
+{
+	//A synthetic frame time trace for the resolution controller. The implicit passes' time goes with the fraction of the
+	//screen's pixels marched and the rest of the frame's doesn't
+	struct FrameTimeTrace
+	{
+		const char* name;
+		std::function<float(unsigned int frame, float scale, const std::function<float()>& random)> frameMilliseconds;
+	};
+
+	std::vector<FrameTimeTrace> GetFrameTimeTraces()
+	{
+		return
+		{
+			{ "Heavy scene", [](const unsigned int, const float scale, const std::function<float()>& random)
+				{
+					return 4.0f + 22.0f * scale * scale + random() - 0.5f;
+				} },
+			{ "Load step", [](const unsigned int frame, const float scale, const std::function<float()>& random)
+				{
+					//The camera turns to the fractals and back
+					const auto implicit = frame >= 200 && frame < 400 ? 28.0f : 8.0f;
+					return 4.0f + implicit * scale * scale + random() - 0.5f;
+				} },
+			{ "Hitches", [](const unsigned int frame, const float scale, const std::function<float()>& random)
+				{
+					//A single slow frame every one and a half seconds that has nothing to do with the implicit passes
+					const auto hitch = frame % 90 == 45 ? 30.0f : 0.0f;
+					return 4.0f + 10.0f * scale * scale + hitch + random() - 0.5f;
+				} },
+			{ "Noisy", [](const unsigned int, const float scale, const std::function<float()>& random)
+				{
+					//Up to 4 ms either way on every frame
+					return 4.0f + 16.0f * scale * scale + 8.0f * (random() - 0.5f);
+				} }
+		};
+	}
+}
+
+void Benchmarks::RunImplicitSceneDynamicResolution(PerformanceReport& report)
+{
+	const auto frames = 600u;
+	const auto budget = 1000.0f / 60.0f;
+
+	ImplicitResolutionSettings noHysteresis;
+	noHysteresis.deadband = 0.0f;
+	noHysteresis.scaleStep = 0.0f;
+	noHysteresis.holdFrames = 0;
+
+	std::vector<std::vector<std::string>> controllerRows;
+
+	for (const auto& trace : GetFrameTimeTraces())
+	{
+		for (const auto mode : { 0, 1, 2 })
+		{
+			ImplicitResolutionController controller(mode == 2 ? noHysteresis : ImplicitResolutionSettings());
+
+			//The same noise for every mode
+			auto seed = 12345u;
+			const std::function<float()> random = [&seed]()
+			{
+				seed = seed * 1664525u + 1013904223u;
+				return static_cast<float>(seed >> 8) / 16777216.0f;
+			};
+
+			auto scale = 1.0f;
+			auto overBudget = 0u;
+			auto changes = 0u;
+			auto scaleTotal = 0.0;
+			auto worstMilliseconds = 0.0f;
+
+			for (auto frame = 0u; frame < frames; frame++)
+			{
+				const auto milliseconds = trace.frameMilliseconds(frame, scale, random);
+
+				overBudget += milliseconds > budget ? 1 : 0;
+				scaleTotal += scale;
+				worstMilliseconds = std::max(worstMilliseconds, milliseconds);
+
+				if (mode != 0)
+				{
+					const auto next = controller.Update(milliseconds);
+
+					changes += next != scale ? 1 : 0;
+					scale = next;
+				}
+			}
+
+			controllerRows.push_back({
+				trace.name,
+				mode == 0 ? "Full resolution" : (mode == 1 ? "PID with hysteresis" : "PID without"),
+				PerformanceReport::Format(100.0 * overBudget / frames, 1),
+				PerformanceReport::Format(scaleTotal / frames, 3),
+				std::to_string(changes),
+				PerformanceReport::Format(worstMilliseconds, 1)
+			});
+		}
+	}
+
+	report.AddSection("Implicit scene dynamic resolution controller");
+	report.AddLine(std::to_string(frames) + " frames of synthetic frame times against a " + PerformanceReport::Format(budget, 2) + " ms budget, the implicit passes' share going with the square of the scale. The controller aims for "
+		+ PerformanceReport::Format(ImplicitResolutionSettings().targetMilliseconds, 1) + " ms. Without hysteresis has no deadband, steps or hold, so the scale follows the PID's output exactly");
+	report.AddTable({ "Trace", "Mode", "Over budget %", "Mean scale", "Scale changes", "Worst ms" }, controllerRows);
+
+	const auto width = 320u;
+	const auto height = 180u;
+	const auto background = ImplicitRayMarcherSettings().background;
+
+	std::vector<std::vector<std::string>> upsampleRows;
+
+	for (const auto& path : GetCameraPaths())
+	{
+		DirectX::XMFLOAT3 eye, target;
+		auto time = 0.0f;
+		path.camera(0, eye, target, time);
+
+		const auto view = ImplicitRayMarcher::LookAt(eye, target);
+		const ImplicitRayMarcher marcher;
+
+		HeadlessImage reference(width, height);
+		const auto fullStats = marcher.Render(view, time, reference);
+
+		for (const auto scale : { 0.75f, 0.5f })
+		{
+			HeadlessImage source(ImplicitBilateralUpsampler::GetScaledSize(width, scale), ImplicitBilateralUpsampler::GetScaledSize(height, scale));
+			ImplicitRayMarcherTrace sourceTrace;
+			const auto stats = marcher.Render(view, time, source, &sourceTrace);
+
+			for (const auto filter : { ImplicitUpsampleFilter::Nearest, ImplicitUpsampleFilter::Bilinear, ImplicitUpsampleFilter::Bilateral })
+			{
+				HeadlessImage image(width, height);
+				std::vector<float> depths;
+
+				const auto start = std::chrono::high_resolution_clock::now();
+				ImplicitBilateralUpsampler::Upsample(source, sourceTrace.depths, image, depths, nullptr, background, filter, true);
+				const auto upsampleMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+				upsampleRows.push_back({
+					path.name,
+					PerformanceReport::Format(scale * 100.0, 0) + "%",
+					filter == ImplicitUpsampleFilter::Nearest ? "Nearest" : (filter == ImplicitUpsampleFilter::Bilinear ? "Bilinear" : "Bilateral"),
+					PerformanceReport::Format(stats.milliseconds, 1),
+					PerformanceReport::Format(upsampleMilliseconds, 2),
+					PerformanceReport::Format(fullStats.milliseconds / (stats.milliseconds + upsampleMilliseconds)) + "x",
+					PerformanceReport::Format(MeanPixelDifference(image, reference), 3),
+					std::to_string(CountDifferingPixels(image, reference)),
+					std::to_string(CountChangedHits(image, reference, background))
+				});
+			}
+		}
+	}
+
+	report.AddSection("Implicit scene dynamic resolution upsampling");
+	report.AddLine(std::to_string(width) + "x" + std::to_string(height) + " from the first frame of each of the temporal cache's paths, marched at a scale of the width and height and upsampled to full size. "
+		"Speedup counts the upsampling. Mean error is the mean difference from the full resolution march out of 255 per channel, and hits changed are the pixels that hit in one and missed in the other");
+	report.AddTable({ "View", "Scale", "Filter", "March ms", "Upsample ms", "Speedup", "Mean error", "Pixels differing", "Hits changed" }, upsampleRows);
+}
+
+namespace
+{
+	//Spheres scattered through a cube 20 across, sized so they fill a twentieth of it whatever the count, with random
+	//materials
+	std::vector<ImplicitRayTracedPrimitive> GetRandomSpheres(const unsigned int count)
+	{
+		auto seed = 2024u;
+		const auto random = [&seed]()
+		{
+			seed = seed * 1664525u + 1013904223u;
+			return static_cast<float>(seed >> 8) / 16777216.0f;
+		};
+
+		const auto radius = std::cbrt(0.05f * 8000.0f * 3.0f / (4.0f * 3.14159265f * count));
+
+		std::vector<ImplicitRayTracedPrimitive> spheres(count);
+
+		for (auto& sphere : spheres)
+		{
+			sphere = {};
+			sphere.centre = DirectX::XMFLOAT3(random() * 20.0f - 10.0f, random() * 20.0f - 10.0f, random() * 20.0f - 10.0f);
+			sphere.type = static_cast<unsigned int>(ImplicitRayTracedPrimitiveType::Sphere);
+			sphere.size = DirectX::XMFLOAT3(radius, radius, radius);
+			sphere.shininess = 40.0f;
+			sphere.colour = DirectX::XMFLOAT4(random(), random(), random(), 1.0f);
+			sphere.Kd = 0.3f + 0.4f * random();
+			sphere.Ks = 0.5f * random();
+			sphere.Kr = 0.5f * random();
+		}
+
+		return spheres;
+	}
+}
+
+void Benchmarks::RunImplicitRayTracedBvh(PerformanceReport& report)
+{
+	const auto width = 320u;
+	const auto height = 180u;
+
+	//The models' spheres, which the tree has to draw the same as the loop over them
+	{
+		const ImplicitRayTracedBvh bvh(ImplicitRayTracer::GetScenePrimitives());
+		const auto view = ImplicitRayMarcher::LookAt(DirectX::XMFLOAT3(-1.6f, 1.45f, 0.3f), DirectX::XMFLOAT3(-1.6f, 1.4f, 1.1f));
+
+		ImplicitRayTracerSettings linearSettings;
+		linearSettings.useBvh = false;
+
+		HeadlessImage treeImage(width, height);
+		HeadlessImage linearImage(width, height);
+		const auto treeStats = ImplicitRayTracer(bvh).Render(view, treeImage);
+		const auto linearStats = ImplicitRayTracer(bvh, linearSettings).Render(view, linearImage);
+
+		report.AddSection("Implicit ray traced models");
+		report.AddLine(std::to_string(width) + "x" + std::to_string(height) + " of the models' three spheres with shadows and three reflections, " + std::to_string(treeStats.hits) + " primary hits. Through the BVH "
+			+ PerformanceReport::Format(treeStats.GetMegaRaysPerSecond(), 2) + " Mrays/s, looping over them " + PerformanceReport::Format(linearStats.GetMegaRaysPerSecond(), 2) + " Mrays/s, " + std::to_string(CountDifferingPixels(treeImage, linearImage)) + " pixels differing");
+	}
+
+	const auto view = ImplicitRayMarcher::LookAt(DirectX::XMFLOAT3(0.0f, 4.0f, -24.0f), DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f));
+
+	std::vector<std::vector<std::string>> buildRows;
+	std::vector<std::vector<std::string>> traceRows;
+
+	for (const auto count : { 10000u, 100000u, 1000000u })
+	{
+		const auto spheres = GetRandomSpheres(count);
+
+		const ImplicitRayTracedBvh serialBvh(spheres, false);
+		const ImplicitRayTracedBvh bvh(spheres, true);
+
+		buildRows.push_back({
+			std::to_string(count),
+			PerformanceReport::Format(serialBvh.GetMilliseconds(), 1),
+			PerformanceReport::Format(bvh.GetMilliseconds(), 1),
+			std::to_string(bvh.GetNodes().size()),
+			std::to_string(bvh.GetLeafCount()),
+			PerformanceReport::Format(static_cast<double>(count) / bvh.GetLeafCount(), 2),
+			std::to_string(bvh.GetDepth()),
+			PerformanceReport::Format(bvh.GetSahCost(), 1)
+		});
+
+		const auto addTraceRow = [&](const char* const mode, const ImplicitRayTracedBvh& tree, const ImplicitRayTracerSettings& settings, const unsigned int traceWidth, const unsigned int traceHeight, const std::string& differing)
+		{
+			HeadlessImage image(traceWidth, traceHeight);
+			const auto stats = ImplicitRayTracer(tree, settings).Render(view, image);
+
+			traceRows.push_back({
+				std::to_string(count),
+				mode,
+				std::to_string(traceWidth) + "x" + std::to_string(traceHeight),
+				std::to_string(stats.GetRays()),
+				PerformanceReport::Format(stats.milliseconds, 1),
+				PerformanceReport::Format(stats.GetMegaRaysPerSecond(), 2),
+				PerformanceReport::Format(stats.GetNodesPerRay(), 1),
+				PerformanceReport::Format(stats.GetPrimitivesPerRay(), 1),
+				differing
+			});
+		};
+
+		ImplicitRayTracerSettings primary;
+		primary.reflections = 0;
+		primary.shadows = false;
+
+		addTraceRow("Primary", bvh, primary, width, height, "-");
+		addTraceRow("Whitted", bvh, ImplicitRayTracerSettings(), width, height, "-");
+
+		//Every sphere for every ray only at the smallest count and a sixteenth of the pixels, against the tree's image
+		if (count == 10000u)
+		{
+			ImplicitRayTracerSettings linear;
+			linear.useBvh = false;
+
+			HeadlessImage treeImage(width / 4, height / 4);
+			HeadlessImage linearImage(width / 4, height / 4);
+			ImplicitRayTracer(bvh).Render(view, treeImage);
+			ImplicitRayTracer(bvh, linear).Render(view, linearImage);
+
+			addTraceRow("Whitted", bvh, ImplicitRayTracerSettings(), width / 4, height / 4, "-");
+			addTraceRow("Whitted, linear", bvh, linear, width / 4, height / 4, std::to_string(CountDifferingPixels(treeImage, linearImage)));
+		}
+	}
+
+	report.AddSection("Implicit ray traced BVH build");
+	report.AddLine("Random spheres filling a twentieth of a cube 20 across. Binned SAH over 16 bins per axis, collapsed to four wide nodes. Parallel builds subtrees of 4096 or more spheres as tasks, on "
+		+ std::to_string(std::thread::hardware_concurrency()) + " hardware threads. SAH cost is the expected tests per ray with a node test costing the same as a sphere");
+	report.AddTable({ "Spheres", "Serial ms", "Parallel ms", "Nodes", "Leaves", "Spheres per leaf", "Depth", "SAH cost" }, buildRows);
+
+	report.AddSection("Implicit ray traced BVH tracing");
+	report.AddLine("The same spheres from 24 away, rows in parallel. Primary is one ray a pixel, Whitted adds a shadow ray for each hit and up to three reflections. Rays counts them all. Linear tests every sphere for every ray, "
+		"and differing is against the tree's image at its size");
+	report.AddTable({ "Spheres", "Mode", "Size", "Rays", "ms", "Mrays/s", "Nodes per ray", "Spheres per ray", "Pixels differing" }, traceRows);
+}
+
+void Benchmarks::RunImplicitRayTracedCheckerboard(PerformanceReport& report)
+{
+	const auto width = 320u;
+	const auto height = 180u;
+	const auto frames = 24u;
+
+	//Five shaded hits a pixel, like the shader
+	ImplicitRayTracerSettings settings;
+	settings.reflections = 4;
+
+	ImplicitRayTracerSettings checkerboardSettings = settings;
+	checkerboardSettings.checkerboard = true;
+
+	std::vector<std::vector<std::string>> rows;
+
+	for (const auto count : { 10000u, 100000u })
+	{
+		const ImplicitRayTracedBvh bvh(GetRandomSpheres(count));
+		const ImplicitRayTracer tracer(bvh, settings);
+		const ImplicitRayTracer checkerboardTracer(bvh, checkerboardSettings);
+
+		//The spatial run's history is forgotten before every frame, so the pattern still alternates
+		ImplicitCheckerboardHistory history;
+		ImplicitCheckerboardHistory spatialHistory;
+
+		struct Totals
+		{
+			double milliseconds;
+			double reconstructionMilliseconds;
+			unsigned long long rays;
+			unsigned long long reconstructedPixels;
+			unsigned long long historyPixels;
+			double meanError;
+			unsigned int differingPixels;
+		};
+
+		Totals full = {};
+		Totals temporal = {};
+		Totals spatial = {};
+
+		const auto add = [](Totals& totals, const ImplicitRayTracerStats& stats)
+		{
+			totals.milliseconds += stats.milliseconds;
+			totals.reconstructionMilliseconds += stats.checkerboard.milliseconds;
+			totals.rays += stats.GetRays();
+			totals.reconstructedPixels += stats.checkerboard.reconstructedPixels;
+			totals.historyPixels += stats.checkerboard.historyPixels;
+		};
+
+		for (auto frame = 0u; frame < frames; frame++)
+		{
+			//A slow orbit around the cube, a quarter of a degree a frame
+			const auto angle = frame * 0.004f;
+			const auto view = ImplicitRayMarcher::LookAt(DirectX::XMFLOAT3(24.0f * std::sin(angle), 4.0f, -24.0f * std::cos(angle)), DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f));
+
+			HeadlessImage reference(width, height);
+			const auto fullStats = tracer.Render(view, reference);
+
+			HeadlessImage image(width, height);
+			const auto stats = checkerboardTracer.Render(view, image, nullptr, &history);
+
+			spatialHistory.Reset();
+
+			HeadlessImage spatialImage(width, height);
+			const auto spatialStats = checkerboardTracer.Render(view, spatialImage, nullptr, &spatialHistory);
+
+			//The first frame has no history, so it's only there to fill it
+			if (frame == 0)
+			{
+				continue;
+			}
+
+			add(full, fullStats);
+			add(temporal, stats);
+			add(spatial, spatialStats);
+
+			temporal.meanError += MeanPixelDifference(image, reference);
+			temporal.differingPixels += CountDifferingPixels(image, reference);
+			spatial.meanError += MeanPixelDifference(spatialImage, reference);
+			spatial.differingPixels += CountDifferingPixels(spatialImage, reference);
+		}
+
+		const auto measuredFrames = frames - 1;
+
+		for (const auto& mode : { std::make_pair("Full", &full), std::make_pair("Checkerboard", &temporal), std::make_pair("Spatial only", &spatial) })
+		{
+			const auto& totals = *mode.second;
+			const auto reconstructed = totals.reconstructedPixels > 0;
+
+			rows.push_back({
+				std::to_string(count),
+				mode.first,
+				PerformanceReport::Format(totals.milliseconds / measuredFrames, 1),
+				PerformanceReport::Format(full.milliseconds / totals.milliseconds) + "x",
+				PerformanceReport::Format(100.0 * totals.rays / full.rays, 1),
+				reconstructed ? PerformanceReport::Format(100.0 * totals.historyPixels / totals.reconstructedPixels, 1) : "-",
+				reconstructed ? PerformanceReport::Format(totals.reconstructionMilliseconds / measuredFrames, 2) : "-",
+				reconstructed ? PerformanceReport::Format(totals.meanError / measuredFrames, 3) : "-",
+				reconstructed ? PerformanceReport::Format(static_cast<double>(totals.differingPixels) / measuredFrames, 1) : "-"
+			});
+		}
+	}
+
+	report.AddSection("Implicit ray traced checkerboard");
+	report.AddLine(std::to_string(width) + "x" + std::to_string(height) + ", " + std::to_string(frames) + " frames orbiting the BVH benchmark's spheres from 24 away with shadows and four reflections, every frame traced in full, then with checkerboard "
+		"reconstructing the half it didn't trace from last frame's image, and again from the traced half alone. Rays is all of them, bounces and shadows included, against the full trace. The other columns are the same as the implicit scene's checkerboard");
+	report.AddTable({ "Spheres", "Mode", "ms", "Speedup", "Rays %", "History %", "Reconstruct ms", "Mean error", "Pixels differing" }, rows);
+}
+
+void Benchmarks::RunImplicitRayTracedAdaptiveSubdivision(PerformanceReport& report)
+{
+	const auto width = 640u;
+	const auto height = 360u;
+
+	//The models' spheres close up, the way the traced pass draws them, then the BVH benchmark's from outside the cube
+	//and inside it
+	const auto randomSpheres = GetRandomSpheres(10000);
+	const auto moreRandomSpheres = GetRandomSpheres(100000);
+	const auto centre = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);
+
+	const ImplicitRayTracedBvh models(ImplicitRayTracer::GetScenePrimitives());
+	const ImplicitRayTracedBvh spheres(randomSpheres);
+	const ImplicitRayTracedBvh moreSpheres(moreRandomSpheres);
+
+	const struct
+	{
+		const char* name;
+		const ImplicitRayTracedBvh& bvh;
+		DirectX::XMFLOAT3 eye;
+		DirectX::XMFLOAT3 target;
+	} views[] =
+	{
+		{ "Models", models, DirectX::XMFLOAT3(-1.6f, 1.45f, 0.3f), DirectX::XMFLOAT3(-1.6f, 1.4f, 1.1f) },
+		{ "10000 spheres, outside", spheres, DirectX::XMFLOAT3(0.0f, 4.0f, -24.0f), centre },
+		{ "10000 spheres, inside", spheres, DirectX::XMFLOAT3(0.0f, 1.0f, -6.0f), centre },
+		{ "100000 spheres, outside", moreSpheres, DirectX::XMFLOAT3(0.0f, 4.0f, -24.0f), centre },
+		{ "100000 spheres, inside", moreSpheres, DirectX::XMFLOAT3(0.0f, 1.0f, -6.0f), centre }
+	};
+
+	struct Mode
+	{
+		unsigned int blockSize;
+		float depthRatio;
+	};
+
+	const Mode modes[] =
+	{
+		{ 4, 0.05f },
+		{ 8, 0.05f },
+		{ 16, 0.05f },
+		{ 8, 0.01f },
+		{ 8, 0.2f }
+	};
+
+	//Five shaded hits a pixel, like the shader
+	ImplicitRayTracerSettings settings;
+	settings.reflections = 4;
+
+	std::vector<std::vector<std::string>> rows;
+
+	for (const auto& view : views)
+	{
+		const auto viewMatrix = ImplicitRayMarcher::LookAt(view.eye, view.target);
+
+		HeadlessImage reference(width, height);
+		const auto referenceStats = ImplicitRayTracer(view.bvh, settings).Render(viewMatrix, reference);
+
+		rows.push_back({ view.name, "Off", "-", std::to_string(referenceStats.GetRays()), "100.0", PerformanceReport::Format(referenceStats.milliseconds, 1), "1.00x", "-", "-" });
+
+		for (const auto& mode : modes)
+		{
+			auto adaptiveSettings = settings;
+			adaptiveSettings.adaptiveBlockSize = mode.blockSize;
+			adaptiveSettings.adaptiveDepthRatio = mode.depthRatio;
+
+			HeadlessImage image(width, height);
+			const auto stats = ImplicitRayTracer(view.bvh, adaptiveSettings).Render(viewMatrix, image);
+
+			rows.push_back({
+				view.name,
+				std::to_string(mode.blockSize) + " px",
+				PerformanceReport::Format(mode.depthRatio),
+				std::to_string(stats.GetRays()),
+				PerformanceReport::Format(100.0 * stats.GetRays() / referenceStats.GetRays(), 1),
+				PerformanceReport::Format(stats.milliseconds, 1),
+				PerformanceReport::Format(referenceStats.milliseconds / stats.milliseconds) + "x",
+				PerformanceReport::Format(MeanPixelDifference(image, reference), 3),
+				std::to_string(CountDifferingPixels(image, reference))
+			});
+		}
+	}
+
+	report.AddSection("Implicit ray traced adaptive subdivision");
+	report.AddLine(std::to_string(width) + "x" + std::to_string(height) + " with shadows and four reflections, blocks traced at their corners and split where the corners hit, shadowed or reflected off different primitives "
+		"or hit depths further apart than the ratio, the rest of their pixels interpolated. Rays is all of them, bounces and shadows included, against tracing every pixel. The other columns are the same as the implicit scene's adaptive subdivision");
+	report.AddTable({ "View", "Block", "Depth ratio", "Rays", "Rays %", "ms", "Speedup", "Mean error", "Pixels differing" }, rows);
+}
+
+void Benchmarks::RunImplicitRayWavefront(PerformanceReport& report)
+{
+	const auto width = 320u;
+	const auto height = 180u;
+
+	//Five shaded hits a pixel, like the shader's old loop over depth < 5
+	ImplicitRayTracerSettings settings;
+	settings.reflections = 4;
+
+	const struct
+	{
+		const char* name;
+		DirectX::XMFLOAT3 eye;
+	} views[] =
+	{
+		{ "Outside", DirectX::XMFLOAT3(0.0f, 4.0f, -24.0f) },
+		{ "Inside", DirectX::XMFLOAT3(0.0f, 1.0f, -6.0f) }
+	};
+
+	std::vector<std::vector<std::string>> rows;
+
+	for (const auto count : { 10000u, 100000u, 1000000u })
+	{
+		//The same spheres as the BVH's benchmark, all of them mirrors, so most rays bounce every time
+		auto spheres = GetRandomSpheres(count);
+
+		for (auto i = 0u; i < count; i++)
+		{
+			spheres[i].Kr = 0.6f + 0.1f * (i % 4);
+		}
+
+		const ImplicitRayTracedBvh bvh(spheres);
+
+		for (const auto& view : views)
+		{
+			const auto viewMatrix = ImplicitRayMarcher::LookAt(view.eye, DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f));
+
+			HeadlessImage depthFirstImage(width, height);
+			const auto depthFirstStats = ImplicitRayTracer(bvh, settings).Render(viewMatrix, depthFirstImage);
+
+			const auto addRow = [&](const char* const mode, const ImplicitRayTracerStats& stats, const std::string& sortMilliseconds, const std::string& differing)
+			{
+				rows.push_back({
+					std::to_string(count),
+					view.name,
+					mode,
+					std::to_string(stats.GetRays()),
+					PerformanceReport::Format(stats.milliseconds, 1),
+					sortMilliseconds,
+					PerformanceReport::Format(stats.GetMegaRaysPerSecond(), 2),
+					PerformanceReport::Format(stats.GetNodesPerRay(), 1),
+					differing
+				});
+			};
+
+			addRow("Depth first", depthFirstStats, "-", "-");
+
+			const struct
+			{
+				const char* name;
+				bool sortRays;
+				bool usePackets;
+			} modes[] =
+			{
+				{ "Wavefront", false, false },
+				{ "Wavefront, sorted", true, false },
+				{ "Wavefront, packets", false, true },
+				{ "Wavefront, sorted packets", true, true }
+			};
+
+			for (const auto& mode : modes)
+			{
+				HeadlessImage image(width, height);
+				const auto stats = ImplicitWavefrontRayTracer(bvh, settings, mode.sortRays, mode.usePackets).Render(viewMatrix, image);
+
+				addRow(mode.name, stats.rays, PerformanceReport::Format(stats.sortMilliseconds, 1), std::to_string(CountDifferingPixels(depthFirstImage, image)));
+			}
+		}
+	}
+
+	report.AddSection("Implicit ray wavefront");
+	report.AddLine(std::to_string(width) + "x" + std::to_string(height) + " of the BVH benchmark's spheres with Kr from 0.6 to 0.9, shadows and four reflections, from outside the cube and from inside it, on "
+		+ std::to_string(std::thread::hardware_concurrency()) + " hardware threads. Depth first traces each pixel's rays in turn with rows in parallel. Wavefront traces each bounce as a batch in chunks of "
+		+ std::to_string(ImplicitWavefrontRayTracer::ChunkSize) + " rays, sorted by direction octant and origin Morton code before each bounce or left in pixel order, and each ray through the tree on its own or in packets of "
+		+ std::to_string(ImplicitWavefrontRayTracer::PacketSize) + " with the shadow rays likewise. Sort ms is part of ms, and differing is against the depth first image");
+	report.AddTable({ "Spheres", "View", "Mode", "Rays", "ms", "Sort ms", "Mrays/s", "Nodes per ray", "Pixels differing" }, rows);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "PerformanceReport.h"
+
+namespace AlienPlanetACW
+{
+	//Headless CPU benchmarks, none of these touch the D3D device so they can run on a background thread
+	class Benchmarks
+	{
+	public:
+		//Returns how many of the benchmarks' checks failed, each also a FAIL line in Benchmarks.txt, 0 when they all passed
+		static unsigned int RunAll();
+
+		static void RunParametricSurfaces(PerformanceReport& report);
+		static void RunBezierPatches(PerformanceReport& report);
+		static void RunSnakeTubes(PerformanceReport& report);
+		static void RunSnakeCrowd(PerformanceReport& report);
+		static void RunImplicitRayMarcher(PerformanceReport& report);
+		static void RunImplicitSceneHierarchy(PerformanceReport& report);
+		static void RunImplicitSceneBytecode(PerformanceReport& report);
+		static void RunImplicitSceneExpression(PerformanceReport& report);
+		static void RunImplicitSceneBricks(PerformanceReport& report);
+		static void RunImplicitSceneConeMarching(PerformanceReport& report);
+		static void RunImplicitSceneMarchingVariants(PerformanceReport& report);
+		static void RunImplicitSceneNormals(PerformanceReport& report);
+		static void RunImplicitSceneTemporalCache(PerformanceReport& report);
+		static void RunImplicitSceneFractals(PerformanceReport& report);
+		static void RunImplicitSceneConeWidth(PerformanceReport& report);
+		static void RunImplicitSceneAnimation(PerformanceReport& report);
+		static void RunImplicitSceneIntervalPruning(PerformanceReport& report);
+		static void RunImplicitSceneMeshing(PerformanceReport& report);
+		static void RunImplicitSceneDepthLimits(PerformanceReport& report);
+		static void RunImplicitSceneTileBinning(PerformanceReport& report);
+		static void RunImplicitSceneAdaptiveSubdivision(PerformanceReport& report);
+		static void RunImplicitSceneCheckerboard(PerformanceReport& report);
+		static void RunImplicitSceneDynamicResolution(PerformanceReport& report);
+		static void RunImplicitRayTracedBvh(PerformanceReport& report);
+		static void RunImplicitRayTracedCheckerboard(PerformanceReport& report);
+		static void RunImplicitRayTracedAdaptiveSubdivision(PerformanceReport& report);
+		static void RunImplicitRayWavefront(PerformanceReport& report);
+	};
+}
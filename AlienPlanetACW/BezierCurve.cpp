@@ -4,7 +4,8 @@
 using namespace AlienPlanetACW;
 
 BezierCurve::BezierCurve(const std::shared_ptr<DX::DeviceResources>& deviceResources) :
-	m_deviceResources(deviceResources), m_position(2.0f, 2.0f, -1.0f), m_rotation(0.0f, 0.0f, 0.0f), m_scale(0.3f, 0.3f, 0.3f), m_loadingComplete(false), m_indexCount(0)
+	m_deviceResources(deviceResources), m_position(2.0f, 2.0f, -1.0f), m_rotation(0.0f, 0.0f, 0.0f), m_scale(0.3f, 0.3f, 0.3f), m_loadingComplete(false), m_indexCount(0),
+	m_patches(BezierPatchSet::CreateMobiusStrip()), m_meshIndexCount(0), m_tessellationDirty(true), m_useCpuTessellation(true)
 {
 	CreateDeviceDependentResources();
 }
@@ -16,6 +17,7 @@ void BezierCurve::CreateDeviceDependentResources()
 	auto loadHSTask = DX::ReadDataAsync(L"BezierCurveHS.cso");
 	auto loadDSTask = DX::ReadDataAsync(L"BezierCurveDS.cso");
 	auto loadPSTask = DX::ReadDataAsync(L"BezierCurvePS.cso");
+	auto loadMeshVSTask = DX::ReadDataAsync(L"BezierPatchMeshVS.cso");
 
 	// After the vertex shader file is loaded, create the shader and input layout.
 	auto createVSTask = loadVSTask.then([this](const std::vector<byte>& fileData) {
@@ -54,6 +56,22 @@ void BezierCurve::CreateDeviceDependentResources()
 		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateDomainShader(&fileData[0], fileData.size(), nullptr, &m_domainShader));
 	});
 
+	auto createMeshVSTask = loadMeshVSTask.then([this](const std::vector<byte>& fileData)
+	{
+		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateVertexShader(&fileData[0], fileData.size(), nullptr, &m_meshVertexShader));
+
+		static const D3D11_INPUT_ELEMENT_DESC vertexDesc[] =
+		{
+			{"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0},
+			{"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
+			{"NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
+			{"TANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
+			{"BINORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0}
+		};
+
+		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateInputLayout(vertexDesc, ARRAYSIZE(vertexDesc), &fileData[0], fileData.size(), &m_meshInputLayout));
+	});
+
 	// After the pixel shader file is loaded, create the shader and constant buffer.
 	auto createPSTask = loadPSTask.then([this](const std::vector<byte>& fileData) {
 		DX::ThrowIfFailed(
@@ -79,101 +97,58 @@ void BezierCurve::CreateDeviceDependentResources()
 	});
 
 	// Once both shaders are loaded, create the mesh.
-	auto createPlaneTask = (createPSTask && createHSTask && createDSTask && createVSTask).then([this]() {
-
-		static VertexPosition pointVertices[64] = {
-			{ DirectX::XMFLOAT3(1.0f, -0.5f, 0.0f)},
-			{ DirectX::XMFLOAT3(1.0f, -0.5f, 0.5f)},
-			{ DirectX::XMFLOAT3(0.5f, -0.3536f, 1.354f)},
-			{ DirectX::XMFLOAT3(0.0f, -0.3536f, 1.354f)},
-			{ DirectX::XMFLOAT3(1.0f, -0.1667f, 0.0f) },
-			{ DirectX::XMFLOAT3(1.0f, -0.1667f, 0.5f) },
-			{ DirectX::XMFLOAT3(0.5f, -0.1179f, 1.118f)},
-			{ DirectX::XMFLOAT3(0.0f, -0.1179f, 1.118f) },
-			{ DirectX::XMFLOAT3(1.0f, 0.1667f, 0.0f) },
-			{ DirectX::XMFLOAT3(1.0f, 0.1667f, 0.5f) },
-			{ DirectX::XMFLOAT3(0.5f, 0.1179f, 0.8821f) },
-			{ DirectX::XMFLOAT3(0.0f, 0.1179f, 0.8821f)},
-			{ DirectX::XMFLOAT3(1.0f, 0.5f, 0.0f) },
-			{ DirectX::XMFLOAT3(1.0f, 0.5f, 0.5f) },
-			{ DirectX::XMFLOAT3(0.5f, 0.3536f, 0.6464f) },
-			{ DirectX::XMFLOAT3(0.0f, 0.3536f, 0.6464f) },
-			{ DirectX::XMFLOAT3(0.0f, -0.3536f, 1.354f) },
-			{ DirectX::XMFLOAT3(-0.5f, -0.3536f, 1.354f) },
-			{ DirectX::XMFLOAT3(-1.5f, 0.0f, 0.5f) },
-			{ DirectX::XMFLOAT3(-1.5f, 0.0f, 0.0f) },
-			{ DirectX::XMFLOAT3(0.0f, -0.1179f, 1.118f) },
-			{ DirectX::XMFLOAT3(-0.5f, -0.1179f, 1.118f) },
-			{ DirectX::XMFLOAT3(-1.167f, 0.0f, 0.5f) },
-			{ DirectX::XMFLOAT3(-1.167f, 0.0f, 0.0f) },
-			{ DirectX::XMFLOAT3(0.0f, 0.1179f, 0.8821f) },
-			{ DirectX::XMFLOAT3(-0.5f, 0.1179f, 0.8821f) },
-			{ DirectX::XMFLOAT3(-0.8333f, 0.0f, 0.5f) },
-			{ DirectX::XMFLOAT3(-0.8333f, 0.0f, 0.0f) },
-			{ DirectX::XMFLOAT3(0.0f, 0.3536f, 0.6464f) },
-			{ DirectX::XMFLOAT3(-0.5f, 0.3536f, 0.6464f) },
-			{ DirectX::XMFLOAT3(-0.5f, 0.0f, 0.5f) },
-			{ DirectX::XMFLOAT3(-0.5f, 0.0f, 0.0f) },
-			{ DirectX::XMFLOAT3(-1.5f, 0.0f, 0.0f) },
-			{ DirectX::XMFLOAT3(-1.5f, 0.0f, -0.5f) },
-			{ DirectX::XMFLOAT3(-0.5f, 0.3536f, -1.354f) },
-			{ DirectX::XMFLOAT3(0.0f, 0.3536f, -1.354f) },
-			{ DirectX::XMFLOAT3(-1.167f, 0.0f, 0.0f) },
-			{ DirectX::XMFLOAT3(-1.167f, 0.0f, -0.5f) },
-			{ DirectX::XMFLOAT3(-0.5f, 0.1179f, -1.118f) },
-			{ DirectX::XMFLOAT3(0.0f, 0.1179f, -1.118f) },
-			{ DirectX::XMFLOAT3(-0.8333f, 0.0f, 0.0f) },
-			{ DirectX::XMFLOAT3(-0.8333f, 0.0f, -0.5f) },
-			{ DirectX::XMFLOAT3(-0.5f, -0.1179f, -0.8821f) },
-			{ DirectX::XMFLOAT3(0.0f, -0.1179f, -0.8821f) },
-			{ DirectX::XMFLOAT3(-0.5f, 0.0f, 0.0f) },
-			{ DirectX::XMFLOAT3(-0.5f, 0.0f, -0.5f) },
-		    { DirectX::XMFLOAT3(-0.5f, -0.3536f, -0.6464f) },
-			{ DirectX::XMFLOAT3(0.0f, -0.3536f, -0.6464f) },
-			{ DirectX::XMFLOAT3(0.0f, 0.3536f, -1.354f) },
-			{ DirectX::XMFLOAT3(0.5f, 0.3536f, -1.354f) },
-			{ DirectX::XMFLOAT3(1.0f, 0.5f, -0.5f) },
-			{ DirectX::XMFLOAT3(1.0f, 0.5f, 0.0f) },
-			{ DirectX::XMFLOAT3(0.0f, 0.1179f, -1.118f) },
-			{ DirectX::XMFLOAT3(0.5f, 0.1179f, -1.118f) },
-			{ DirectX::XMFLOAT3(1.0f, 0.1667f, -0.5f) },
-			{ DirectX::XMFLOAT3(1.0f, 0.1667f, 0.0f) },
-			{ DirectX::XMFLOAT3(0.0f, -0.1179f, -0.8821f) },
-			{ DirectX::XMFLOAT3(0.5f, -0.1179f, -0.8821f) },
-			{ DirectX::XMFLOAT3(1.0f, -0.1667f, -0.5f) },
-			{ DirectX::XMFLOAT3(1.0f, -0.1667f, 0.0f) },
-			{ DirectX::XMFLOAT3(0.0f, -0.3536f, -0.6464f) },
-			{ DirectX::XMFLOAT3(0.5f, -0.3536f, -0.6464f) },
-			{ DirectX::XMFLOAT3(1.0f, -0.5f, -0.5f) },
-			{ DirectX::XMFLOAT3(1.0f, -0.5f, 0.0f) },
-		};
+	auto createPlaneTask = (createPSTask && createHSTask && createDSTask && createVSTask && createMeshVSTask).then([this]() {
+
+		//Control points for the hardware tessellated path, one 16 point patch after another
+		std::vector<VertexPosition> pointVertices;
+
+		for (const auto& patch : m_patches.GetPatches())
+		{
+			for (const auto& controlPoint : patch.controlPoints)
+			{
+				pointVertices.push_back({ controlPoint });
+			}
+		}
 
 		D3D11_SUBRESOURCE_DATA vertexBufferData = { 0 };
-		vertexBufferData.pSysMem = pointVertices;
+		vertexBufferData.pSysMem = pointVertices.data();
 		vertexBufferData.SysMemPitch = 0;
 		vertexBufferData.SysMemSlicePitch = 0;
 
-		CD3D11_BUFFER_DESC vertexBufferDescription(sizeof(pointVertices), D3D11_BIND_VERTEX_BUFFER);
+		CD3D11_BUFFER_DESC vertexBufferDescription(static_cast<UINT>(pointVertices.size() * sizeof(VertexPosition)), D3D11_BIND_VERTEX_BUFFER);
 
 		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateBuffer(&vertexBufferDescription, &vertexBufferData, &m_vertexBuffer));
 
-		static unsigned int pointIndices[64] = {};
+		std::vector<unsigned int> pointIndices(pointVertices.size());
 
-		for (auto i = 0; i < 64; i++)
+		for (auto i = 0u; i < pointIndices.size(); i++)
 		{
 			pointIndices[i] = i;
 		}
 
-		m_indexCount = ARRAYSIZE(pointIndices);
+		m_indexCount = static_cast<uint32>(pointIndices.size());
 
 		D3D11_SUBRESOURCE_DATA indexBufferData = { 0 };
-		indexBufferData.pSysMem = pointIndices;
+		indexBufferData.pSysMem = pointIndices.data();
 		indexBufferData.SysMemPitch = 0;
 		indexBufferData.SysMemSlicePitch = 0;
 
-		CD3D11_BUFFER_DESC indexBufferDescription(sizeof(pointIndices), D3D11_BIND_INDEX_BUFFER);
+		CD3D11_BUFFER_DESC indexBufferDescription(static_cast<UINT>(pointIndices.size() * sizeof(unsigned int)), D3D11_BIND_INDEX_BUFFER);
 
 		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateBuffer(&indexBufferDescription, &indexBufferData, &m_indexBuffer));
+
+		//Sized for every patch at the maximum level so retessellating never has to reallocate
+		const auto patchCount = m_patches.GetPatchCount();
+
+		CD3D11_BUFFER_DESC meshVertexBufferDescription(static_cast<UINT>(BezierPatchSet::GetMaxVertexCount(patchCount, MaxTessellationLevel) * sizeof(VertexPositionTexcoordNormalTangentBinormal)), D3D11_BIND_VERTEX_BUFFER, D3D11_USAGE_DYNAMIC, D3D11_CPU_ACCESS_WRITE);
+
+		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateBuffer(&meshVertexBufferDescription, nullptr, &m_meshVertexBuffer));
+
+		CD3D11_BUFFER_DESC meshIndexBufferDescription(static_cast<UINT>(BezierPatchSet::GetMaxIndexCount(patchCount, MaxTessellationLevel) * sizeof(unsigned long)), D3D11_BIND_INDEX_BUFFER, D3D11_USAGE_DYNAMIC, D3D11_CPU_ACCESS_WRITE);
+
+		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateBuffer(&meshIndexBufferDescription, nullptr, &m_meshIndexBuffer));
+
+		m_tessellationDirty = true;
 	});
 
 	createPlaneTask.then([this]() {
@@ -207,6 +182,53 @@ void BezierCurve::Update(DX::StepTimer const& timer)
 
 	//DirectX::XMStoreFloat4x4(&m_MVPBufferData.model, DirectX::XMMatrixTranspose(DirectX::XMMatrixInverse(nullptr, worldMatrix)));
 	DirectX::XMStoreFloat4x4(&m_MVPBufferData.model, DirectX::XMMatrixTranspose(worldMatrix));
+	DirectX::XMStoreFloat4x4(&m_inverseWorldMatrix, DirectX::XMMatrixInverse(nullptr, worldMatrix));
+}
+
+void BezierCurve::SetUseCpuTessellation(bool useCpuTessellation)
+{
+	m_useCpuTessellation = useCpuTessellation;
+	m_tessellationDirty = true;
+}
+
+void BezierCurve::UpdateTessellation()
+{
+	//Levels are picked in patch space, so bring the camera into it
+	const auto viewPosition = DirectX::XMVector3TransformCoord(DirectX::XMLoadFloat3(&m_cameraBufferData.position), DirectX::XMLoadFloat4x4(&m_inverseWorldMatrix));
+
+	//Only retessellate once the camera has moved a few percent of its distance from the strip
+	const auto moved = DirectX::XMVectorGetX(DirectX::XMVector3Length(DirectX::XMVectorSubtract(viewPosition, DirectX::XMLoadFloat3(&m_tessellatedViewPosition))));
+
+	if (!m_tessellationDirty && moved < 0.05f * DirectX::XMVectorGetX(DirectX::XMVector3Length(viewPosition)))
+	{
+		return;
+	}
+
+	BezierTessellationSettings settings;
+	settings.screenSpace = true;
+	settings.tolerance = 0.5f;
+	settings.pixelsPerUnit = 0.5f * m_deviceResources->GetOutputSize().Height / std::tan(35.0f * DirectX::XM_PI / 180.0f) * m_scale.y;
+	settings.maxLevel = MaxTessellationLevel;
+	DirectX::XMStoreFloat3(&settings.viewPosition, viewPosition);
+
+	const auto mesh = m_patches.Tessellate(settings);
+
+	auto context = m_deviceResources->GetD3DDeviceContext();
+
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+
+	DX::ThrowIfFailed(context->Map(m_meshVertexBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource));
+	memcpy(mappedResource.pData, mesh.vertices.data(), mesh.vertices.size() * sizeof(VertexPositionTexcoordNormalTangentBinormal));
+	context->Unmap(m_meshVertexBuffer.Get(), 0);
+
+	DX::ThrowIfFailed(context->Map(m_meshIndexBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource));
+	memcpy(mappedResource.pData, mesh.indices.data(), mesh.indices.size() * sizeof(unsigned long));
+	context->Unmap(m_meshIndexBuffer.Get(), 0);
+
+	m_meshIndexCount = static_cast<uint32>(mesh.indices.size());
+
+	DirectX::XMStoreFloat3(&m_tessellatedViewPosition, viewPosition);
+	m_tessellationDirty = false;
 }
 
 void BezierCurve::Render()
@@ -240,38 +262,77 @@ void BezierCurve::Render()
 		0
 	);
 
-	// Each vertex is one instance of the VertexPositionColor struct.
-	UINT stride = sizeof(AlienPlanetACW::VertexPosition);
 	UINT offset = 0;
-	context->IASetVertexBuffers(
-		0,
-		1,
-		m_vertexBuffer.GetAddressOf(),
-		&stride,
-		&offset
-	);
 
-	context->IASetIndexBuffer(m_indexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
+	if (m_useCpuTessellation)
+	{
+		UpdateTessellation();
+
+		UINT stride = sizeof(AlienPlanetACW::VertexPositionTexcoordNormalTangentBinormal);
+		context->IASetVertexBuffers(
+			0,
+			1,
+			m_meshVertexBuffer.GetAddressOf(),
+			&stride,
+			&offset
+		);
+
+		context->IASetIndexBuffer(m_meshIndexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
+
+		context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+		context->IASetInputLayout(m_meshInputLayout.Get());
+	}
+	else
+	{
+		// Each vertex is one instance of the VertexPositionColor struct.
+		UINT stride = sizeof(AlienPlanetACW::VertexPosition);
+		context->IASetVertexBuffers(
+			0,
+			1,
+			m_vertexBuffer.GetAddressOf(),
+			&stride,
+			&offset
+		);
 
-	context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_16_CONTROL_POINT_PATCHLIST);
+		context->IASetIndexBuffer(m_indexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
 
-	context->IASetInputLayout(m_inputLayout.Get());
+		context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_16_CONTROL_POINT_PATCHLIST);
+
+		context->IASetInputLayout(m_inputLayout.Get());
+	}
 
 	// Attach our vertex shader.
 	context->VSSetShader(
-		m_vertexShader.Get(),
+		m_useCpuTessellation ? m_meshVertexShader.Get() : m_vertexShader.Get(),
 		nullptr,
 		0
 	);
 
+	context->VSSetConstantBuffers1(
+		0,
+		1,
+		m_MVPBuffer.GetAddressOf(),
+		nullptr,
+		nullptr
+	);
+
+	context->VSSetConstantBuffers1(
+		1,
+		1,
+		m_cameraBuffer.GetAddressOf(),
+		nullptr,
+		nullptr
+	);
+
 	context->HSSetShader(
-		m_hullShader.Get(),
+		m_useCpuTessellation ? nullptr : m_hullShader.Get(),
 		nullptr,
 		0
 	);
 
 	context->DSSetShader(
-		m_domainShader.Get(),
+		m_useCpuTessellation ? nullptr : m_domainShader.Get(),
 		nullptr,
 		0
 	);
@@ -315,7 +376,7 @@ void BezierCurve::Render()
 
 	// Draw the objects.
 	context->DrawIndexed(
-		m_indexCount,
+		m_useCpuTessellation ? m_meshIndexCount : m_indexCount,
 		0,
 		0
 	);
@@ -334,4 +395,8 @@ void BezierCurve::ReleaseDeviceDependentResources()
 	m_cameraBuffer.Reset();
 	m_vertexBuffer.Reset();
 	m_indexBuffer.Reset();
+	m_meshVertexShader.Reset();
+	m_meshInputLayout.Reset();
+	m_meshVertexBuffer.Reset();
+	m_meshIndexBuffer.Reset();
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include "..\Common\StepTimer.h"
 
 #include "ResourceManager.h"
+#include "BezierPatchSet.h"
 #include <vector>
 #include <DirectXMath.h>
 
@@ -23,7 +24,12 @@ namespace AlienPlanetACW
 		void Update(DX::StepTimer const& timer);
 		void Render();
 
+		void SetUseCpuTessellation(bool useCpuTessellation);
+
+		static const unsigned int MaxTessellationLevel = 64;
+
 	private:
+		void UpdateTessellation();
 
 		std::shared_ptr<DX::DeviceResources> m_deviceResources;
 
@@ -40,6 +46,16 @@ namespace AlienPlanetACW
 		Microsoft::WRL::ComPtr<ID3D11DomainShader>	m_domainShader;
 		Microsoft::WRL::ComPtr<ID3D11PixelShader>	m_pixelShader;
 
+		//CPU tessellated mesh, rewritten whenever the camera has moved far enough to change the levels
+		BezierPatchSet								m_patches;
+		Microsoft::WRL::ComPtr<ID3D11InputLayout>	m_meshInputLayout;
+		Microsoft::WRL::ComPtr<ID3D11VertexShader>	m_meshVertexShader;
+		Microsoft::WRL::ComPtr<ID3D11Buffer>		m_meshVertexBuffer;
+		Microsoft::WRL::ComPtr<ID3D11Buffer>		m_meshIndexBuffer;
+		DirectX::XMFLOAT4X4							m_inverseWorldMatrix;
+		DirectX::XMFLOAT3							m_tessellatedViewPosition;
+		uint32										m_meshIndexCount;
+
 		Microsoft::WRL::ComPtr<ID3D11RasterizerState> m_rasterizerState;
 
 		Microsoft::WRL::ComPtr<ID3D11Buffer>		m_MVPBuffer;
@@ -53,6 +69,8 @@ namespace AlienPlanetACW
 		uint32	m_indexCount;
 
 		bool	m_loadingComplete;
+		bool	m_tessellationDirty;
+		bool	m_useCpuTessellation;
 	};
 }
 
@@ -0,0 +1,53 @@
+// A constant buffer that stores the three basic column-major matrices for composing geometry.
+cbuffer ModelViewProjectionConstantBuffer : register(b0)
+{
+	matrix model;
+	matrix view;
+	matrix projection;
+};
+
+cbuffer CameraBuffer : register(b1)
+{
+	float3 cameraPosition;
+	float cameraPadding;
+};
+
+// Per-vertex data used as input to the vertex shader.
+struct VertexShaderInput
+{
+	float3 position : POSITION;
+	float2 tex : TEXCOORD0;
+	float3 normal : NORMAL;
+	float3 tangent : TANGENT;
+	float3 binormal : BINORMAL;
+};
+
+//Matches the domain shader output of the tessellated path so BezierCurvePS can be used unchanged
+struct PixelShaderInput
+{
+	float4 positionH : SV_POSITION;
+	float3 positionW : POSITION;
+	float3 normal : NORMAL;
+	float3 tangent : TANGENT;
+	float3 binormal : BINORMAL;
+	float3 viewDirection : TEXCOORD0;
+};
+
+//Pass through for patches tessellated on the CPU by BezierPatchSet
+PixelShaderInput main(VertexShaderInput input)
+{
+	PixelShaderInput output;
+
+	output.positionW = mul(float4(input.position, 1.0f), model).xyz;
+
+	output.normal = normalize(mul(input.normal, (float3x3)model));
+	output.tangent = normalize(mul(input.tangent, (float3x3)model));
+	output.binormal = normalize(mul(input.binormal, (float3x3)model));
+
+	output.viewDirection = normalize(cameraPosition.xyz - output.positionW);
+
+	output.positionH = mul(float4(output.positionW, 1.0f), view);
+	output.positionH = mul(output.positionH, projection);
+
+	return output;
+}
@@ -0,0 +1,865 @@
+#include "pch.h"
+#include "BezierPatchSet.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ppl.h>
+
+using namespace AlienPlanetACW;
+using namespace DirectX;
+
+namespace
+{
+	//Control point indices of each edge, walking anticlockwise around the patch
+	const unsigned int EdgeControlPoints[4][4] =
+	{
+		{ 0, 1, 2, 3 },
+		{ 3, 7, 11, 15 },
+		{ 15, 14, 13, 12 },
+		{ 12, 8, 4, 0 }
+	};
+
+	//Stops the screen space tolerance collapsing to zero when the viewer is inside a patch's bounds
+	const float MinimumViewDistance = 0.01f;
+
+	struct EdgeCurve
+	{
+		XMFLOAT3 points[4];
+		bool reversed;
+	};
+
+	struct PatchMesh
+	{
+		std::vector<VertexPositionTexcoordNormalTangentBinormal> vertices;
+		std::vector<unsigned long> indices;
+	};
+
+	bool LessThan(const XMFLOAT3& a, const XMFLOAT3& b)
+	{
+		if (a.x != b.x)
+		{
+			return a.x < b.x;
+		}
+
+		if (a.y != b.y)
+		{
+			return a.y < b.y;
+		}
+
+		return a.z < b.z;
+	}
+
+	//Both patches sharing an edge see the same four points, ordered so the smaller end point comes first
+	EdgeCurve GetCanonicalEdge(const BezierPatch& patch, const unsigned int edge)
+	{
+		const auto* const indices = EdgeControlPoints[edge];
+
+		EdgeCurve curve;
+		curve.reversed = LessThan(patch.controlPoints[indices[3]], patch.controlPoints[indices[0]]);
+
+		for (auto i = 0; i < 4; i++)
+		{
+			curve.points[i] = patch.controlPoints[indices[curve.reversed ? 3 - i : i]];
+		}
+
+		return curve;
+	}
+
+	XMFLOAT3 EvaluateCurve(const XMFLOAT3* const points, const float t)
+	{
+		const auto invT = 1.0f - t;
+		const float basis[4] = { invT * invT * invT, 3.0f * t * invT * invT, 3.0f * t * t * invT, t * t * t };
+
+		auto result = XMFLOAT3(0.0f, 0.0f, 0.0f);
+
+		for (auto i = 0; i < 4; i++)
+		{
+			result.x += basis[i] * points[i].x;
+			result.y += basis[i] * points[i].y;
+			result.z += basis[i] * points[i].z;
+		}
+
+		return result;
+	}
+
+	//Largest second difference of the control polygon, |C''| of a cubic is at most six times this
+	float CurveFlatness(const XMFLOAT3& p0, const XMFLOAT3& p1, const XMFLOAT3& p2, const XMFLOAT3& p3)
+	{
+		const auto secondDifference = [](const XMFLOAT3& a, const XMFLOAT3& b, const XMFLOAT3& c)
+		{
+			const auto x = a.x - 2.0f * b.x + c.x;
+			const auto y = a.y - 2.0f * b.y + c.y;
+			const auto z = a.z - 2.0f * b.z + c.z;
+
+			return std::sqrt(x * x + y * y + z * z);
+		};
+
+		return std::max(secondDifference(p0, p1, p2), secondDifference(p1, p2, p3));
+	}
+
+	//Distance from the viewer to a bounding sphere around the points, zero when inside it
+	float DistanceToPoints(const XMFLOAT3& viewPosition, const XMFLOAT3* const points, const unsigned int count)
+	{
+		auto centre = XMFLOAT3(0.0f, 0.0f, 0.0f);
+
+		for (auto i = 0u; i < count; i++)
+		{
+			const auto& point = points[i];
+
+			centre.x += point.x;
+			centre.y += point.y;
+			centre.z += point.z;
+		}
+
+		centre.x /= static_cast<float>(count);
+		centre.y /= static_cast<float>(count);
+		centre.z /= static_cast<float>(count);
+
+		auto radiusSq = 0.0f;
+
+		for (auto i = 0u; i < count; i++)
+		{
+			const auto& point = points[i];
+			const auto x = point.x - centre.x;
+			const auto y = point.y - centre.y;
+			const auto z = point.z - centre.z;
+
+			radiusSq = std::max(radiusSq, x * x + y * y + z * z);
+		}
+
+		const auto x = viewPosition.x - centre.x;
+		const auto y = viewPosition.y - centre.y;
+		const auto z = viewPosition.z - centre.z;
+
+		return std::max(std::sqrt(x * x + y * y + z * z) - std::sqrt(radiusSq), 0.0f);
+	}
+
+	float ToleranceAt(const BezierTessellationSettings& settings, const float distance)
+	{
+		return settings.screenSpace ? settings.tolerance * std::max(distance, MinimumViewDistance) / settings.pixelsPerUnit : settings.tolerance;
+	}
+
+	//Splitting a cubic into n equal parameter steps leaves a chord error of at most 6 * flatness / (8 * n * n)
+	unsigned int LevelFor(const float flatness, const float tolerance, const unsigned int maxLevel)
+	{
+		const auto level = std::ceil(std::sqrt(0.75f * flatness / tolerance));
+
+		return level < 1.0f ? 1u : (level > static_cast<float>(maxLevel) ? maxLevel : static_cast<unsigned int>(level));
+	}
+
+	//Inside a patch the error is bounded by u / (nu * nu) + uv / (nu * nv) + v / (nv * nv), with the three terms
+	//coming from the row, twist and column differences. Picks the pair of levels with the fewest quads that meets it
+	void InsideLevels(const float u, const float uv, const float v, const float tolerance, const unsigned int maxLevel, unsigned int& levelU, unsigned int& levelV)
+	{
+		levelU = levelV = maxLevel;
+
+		auto bestQuads = maxLevel * maxLevel;
+
+		for (auto nu = 1u; nu <= maxLevel; nu++)
+		{
+			const auto remaining = tolerance - u / static_cast<float>(nu * nu);
+
+			if (remaining <= 0.0f)
+			{
+				continue;
+			}
+
+			//Solve v * x^2 + (uv / nu) * x = remaining for x = 1 / nv
+			const auto linear = uv / static_cast<float>(nu);
+			const auto x = v > 0.0f ? (std::sqrt(linear * linear + 4.0f * v * remaining) - linear) / (2.0f * v) : (linear > 0.0f ? remaining / linear : 1.0f);
+			const auto nv = std::max(static_cast<unsigned int>(std::ceil(1.0f / x)), 1u);
+
+			if (nv <= maxLevel && nu * nv < bestQuads)
+			{
+				bestQuads = nu * nv;
+				levelU = nu;
+				levelV = nv;
+			}
+		}
+	}
+
+	void BernsteinBasis(FXMVECTOR t, XMVECTOR* basis, XMVECTOR* derivative)
+	{
+		const auto three = XMVectorReplicate(3.0f);
+		const auto six = XMVectorReplicate(6.0f);
+		const auto invT = XMVectorSubtract(XMVectorReplicate(1.0f), t);
+		const auto invTSq = XMVectorMultiply(invT, invT);
+		const auto tSq = XMVectorMultiply(t, t);
+		const auto tInvT = XMVectorMultiply(t, invT);
+
+		basis[0] = XMVectorMultiply(invTSq, invT);
+		basis[1] = XMVectorMultiply(three, XMVectorMultiply(t, invTSq));
+		basis[2] = XMVectorMultiply(three, XMVectorMultiply(tSq, invT));
+		basis[3] = XMVectorMultiply(tSq, t);
+
+		derivative[0] = XMVectorNegate(XMVectorMultiply(three, invTSq));
+		derivative[1] = XMVectorSubtract(XMVectorMultiply(three, invTSq), XMVectorMultiply(six, tInvT));
+		derivative[2] = XMVectorSubtract(XMVectorMultiply(six, tInvT), XMVectorMultiply(three, tSq));
+		derivative[3] = XMVectorMultiply(three, tSq);
+	}
+
+	//Evaluates every (u, v) in texcoords four at a time, the tail batch repeats its last point
+	void EvaluateVertices(const BezierPatch& patch, std::vector<VertexPositionTexcoordNormalTangentBinormal>& vertices)
+	{
+		alignas(16) float us[4], vs[4];
+		alignas(16) float px[4], py[4], pz[4], nx[4], ny[4], nz[4], tx[4], ty[4], tz[4], bx[4], by[4], bz[4];
+
+		SurfaceSamples samples;
+
+		const auto count = vertices.size();
+		const auto epsilon = XMVectorReplicate(1e-12f);
+
+		for (size_t first = 0; first < count; first += 4)
+		{
+			for (auto lane = 0u; lane < 4; lane++)
+			{
+				const auto& texcoord = vertices[std::min(first + lane, count - 1)].texcoord;
+
+				us[lane] = texcoord.x;
+				vs[lane] = texcoord.y;
+			}
+
+			BezierPatchSet::Evaluate(patch, XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(us)), XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(vs)), samples);
+
+			const auto normalX = XMVectorSubtract(XMVectorMultiply(samples.duy, samples.dvz), XMVectorMultiply(samples.duz, samples.dvy));
+			const auto normalY = XMVectorSubtract(XMVectorMultiply(samples.duz, samples.dvx), XMVectorMultiply(samples.dux, samples.dvz));
+			const auto normalZ = XMVectorSubtract(XMVectorMultiply(samples.dux, samples.dvy), XMVectorMultiply(samples.duy, samples.dvx));
+
+			const auto normalScale = XMVectorReciprocalSqrt(XMVectorMax(XMVectorMultiplyAdd(normalX, normalX, XMVectorMultiplyAdd(normalY, normalY, XMVectorMultiply(normalZ, normalZ))), epsilon));
+			const auto tangentScale = XMVectorReciprocalSqrt(XMVectorMax(XMVectorMultiplyAdd(samples.dux, samples.dux, XMVectorMultiplyAdd(samples.duy, samples.duy, XMVectorMultiply(samples.duz, samples.duz))), epsilon));
+			const auto binormalScale = XMVectorReciprocalSqrt(XMVectorMax(XMVectorMultiplyAdd(samples.dvx, samples.dvx, XMVectorMultiplyAdd(samples.dvy, samples.dvy, XMVectorMultiply(samples.dvz, samples.dvz))), epsilon));
+
+			XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(px), samples.x);
+			XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(py), samples.y);
+			XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(pz), samples.z);
+			XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(nx), XMVectorMultiply(normalX, normalScale));
+			XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(ny), XMVectorMultiply(normalY, normalScale));
+			XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(nz), XMVectorMultiply(normalZ, normalScale));
+			XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(tx), XMVectorMultiply(samples.dux, tangentScale));
+			XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(ty), XMVectorMultiply(samples.duy, tangentScale));
+			XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(tz), XMVectorMultiply(samples.duz, tangentScale));
+			XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(bx), XMVectorMultiply(samples.dvx, binormalScale));
+			XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(by), XMVectorMultiply(samples.dvy, binormalScale));
+			XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(bz), XMVectorMultiply(samples.dvz, binormalScale));
+
+			for (auto lane = 0u; lane < 4 && first + lane < count; lane++)
+			{
+				auto& vertex = vertices[first + lane];
+
+				vertex.position = XMFLOAT3(px[lane], py[lane], pz[lane]);
+				vertex.normal = XMFLOAT3(nx[lane], ny[lane], nz[lane]);
+				vertex.tangent = XMFLOAT3(tx[lane], ty[lane], tz[lane]);
+				vertex.binormal = XMFLOAT3(bx[lane], by[lane], bz[lane]);
+			}
+		}
+	}
+
+	//Joins an outer polyline to an inner one running the same way, always advancing whichever has the nearer next point
+	void Zip(const std::vector<std::pair<unsigned long, float>>& outer, const std::vector<std::pair<unsigned long, float>>& inner, std::vector<unsigned long>& indices)
+	{
+		size_t o = 0;
+		size_t i = 0;
+
+		while (o + 1 < outer.size() || i + 1 < inner.size())
+		{
+			const auto advanceOuter = i + 1 == inner.size() || (o + 1 < outer.size() && outer[o + 1].second <= inner[i + 1].second);
+
+			if (advanceOuter)
+			{
+				indices.push_back(outer[o].first);
+				indices.push_back(outer[o + 1].first);
+				indices.push_back(inner[i].first);
+				o++;
+			}
+			else
+			{
+				indices.push_back(outer[o].first);
+				indices.push_back(inner[i + 1].first);
+				indices.push_back(inner[i].first);
+				i++;
+			}
+		}
+	}
+
+	void TessellatePatch(const BezierPatch& patch, const BezierPatchLevels& levels, PatchMesh& mesh)
+	{
+		EdgeCurve edgeCurves[4];
+
+		for (auto edge = 0u; edge < 4; edge++)
+		{
+			edgeCurves[edge] = GetCanonicalEdge(patch, edge);
+		}
+
+		//Vertex k of n along an edge, counted anticlockwise, evaluated on the canonical curve so neighbours agree bit for bit
+		const auto edgePosition = [&](const unsigned int edge, const unsigned int k)
+		{
+			const auto n = levels.edges[edge];
+			const auto canonicalK = edgeCurves[edge].reversed ? n - k : k;
+
+			return EvaluateCurve(edgeCurves[edge].points, static_cast<float>(canonicalK) / static_cast<float>(n));
+		};
+
+		auto& vertices = mesh.vertices;
+		auto& indices = mesh.indices;
+
+		const auto uniform = levels.edges[0] == levels.insideU && levels.edges[2] == levels.insideU && levels.edges[1] == levels.insideV && levels.edges[3] == levels.insideV;
+
+		if (uniform)
+		{
+			const auto nu = levels.insideU;
+			const auto nv = levels.insideV;
+			const auto rowLength = nu + 1;
+
+			vertices.resize(rowLength * (nv + 1));
+
+			for (auto j = 0u; j <= nv; j++)
+			{
+				for (auto i = 0u; i <= nu; i++)
+				{
+					vertices[j * rowLength + i].texcoord = XMFLOAT2(static_cast<float>(i) / static_cast<float>(nu), static_cast<float>(j) / static_cast<float>(nv));
+				}
+			}
+
+			EvaluateVertices(patch, vertices);
+
+			for (auto i = 0u; i <= nu; i++)
+			{
+				vertices[i].position = edgePosition(0, i);
+				vertices[nv * rowLength + i].position = edgePosition(2, nu - i);
+			}
+
+			for (auto j = 0u; j <= nv; j++)
+			{
+				vertices[j * rowLength + nu].position = edgePosition(1, j);
+				vertices[j * rowLength].position = edgePosition(3, nv - j);
+			}
+
+			indices.reserve(nu * nv * 6);
+
+			for (auto j = 0u; j < nv; j++)
+			{
+				for (auto i = 0u; i < nu; i++)
+				{
+					const auto bottomLeft = j * rowLength + i;
+					const auto topLeft = bottomLeft + rowLength;
+
+					indices.push_back(bottomLeft);
+					indices.push_back(bottomLeft + 1);
+					indices.push_back(topLeft + 1);
+					indices.push_back(bottomLeft);
+					indices.push_back(topLeft + 1);
+					indices.push_back(topLeft);
+				}
+			}
+
+			return;
+		}
+
+		//Mismatched levels: a ring of edge vertices at their own spacing, an inner grid at the inside levels and
+		//a strip of triangles stitching each edge to the nearest side of the inner grid
+		const auto nu = std::max(levels.insideU, 2u);
+		const auto nv = std::max(levels.insideV, 2u);
+
+		unsigned int edgeOffsets[5] = { 0 };
+
+		for (auto edge = 0u; edge < 4; edge++)
+		{
+			edgeOffsets[edge + 1] = edgeOffsets[edge] + levels.edges[edge];
+		}
+
+		const auto boundaryCount = edgeOffsets[4];
+		const auto innerRowLength = nu - 1;
+
+		vertices.resize(boundaryCount + innerRowLength * (nv - 1));
+
+		for (auto edge = 0u; edge < 4; edge++)
+		{
+			const auto n = levels.edges[edge];
+
+			for (auto k = 0u; k < n; k++)
+			{
+				const auto t = static_cast<float>(k) / static_cast<float>(n);
+				const XMFLOAT2 texcoords[4] = { XMFLOAT2(t, 0.0f), XMFLOAT2(1.0f, t), XMFLOAT2(1.0f - t, 1.0f), XMFLOAT2(0.0f, 1.0f - t) };
+
+				vertices[edgeOffsets[edge] + k].texcoord = texcoords[edge];
+			}
+		}
+
+		const auto innerIndex = [&](const unsigned int i, const unsigned int j)
+		{
+			return static_cast<unsigned long>(boundaryCount + (j - 1) * innerRowLength + (i - 1));
+		};
+
+		for (auto j = 1u; j < nv; j++)
+		{
+			for (auto i = 1u; i < nu; i++)
+			{
+				vertices[innerIndex(i, j)].texcoord = XMFLOAT2(static_cast<float>(i) / static_cast<float>(nu), static_cast<float>(j) / static_cast<float>(nv));
+			}
+		}
+
+		EvaluateVertices(patch, vertices);
+
+		for (auto edge = 0u; edge < 4; edge++)
+		{
+			for (auto k = 0u; k < levels.edges[edge]; k++)
+			{
+				vertices[edgeOffsets[edge] + k].position = edgePosition(edge, k);
+			}
+		}
+
+		for (auto j = 1u; j + 1 < nv; j++)
+		{
+			for (auto i = 1u; i + 1 < nu; i++)
+			{
+				indices.push_back(innerIndex(i, j));
+				indices.push_back(innerIndex(i + 1, j));
+				indices.push_back(innerIndex(i + 1, j + 1));
+				indices.push_back(innerIndex(i, j));
+				indices.push_back(innerIndex(i + 1, j + 1));
+				indices.push_back(innerIndex(i, j + 1));
+			}
+		}
+
+		std::vector<std::pair<unsigned long, float>> outer;
+		std::vector<std::pair<unsigned long, float>> inner;
+
+		for (auto edge = 0u; edge < 4; edge++)
+		{
+			const auto n = levels.edges[edge];
+
+			outer.clear();
+			inner.clear();
+
+			for (auto k = 0u; k <= n; k++)
+			{
+				outer.emplace_back((edgeOffsets[edge] + k) % boundaryCount, static_cast<float>(k) / static_cast<float>(n));
+			}
+
+			//The matching side of the inner grid, walked in the same direction as the edge
+			const auto sideLength = edge % 2 == 0 ? nu - 1 : nv - 1;
+			const auto sideLevel = static_cast<float>(edge % 2 == 0 ? nu : nv);
+
+			for (auto s = 1u; s <= sideLength; s++)
+			{
+				unsigned long index = 0;
+
+				switch (edge)
+				{
+				case 0: index = innerIndex(s, 1); break;
+				case 1: index = innerIndex(nu - 1, s); break;
+				case 2: index = innerIndex(nu - s, nv - 1); break;
+				case 3: index = innerIndex(1, nv - s); break;
+				}
+
+				inner.emplace_back(index, static_cast<float>(s) / sideLevel);
+			}
+
+			Zip(outer, inner, indices);
+		}
+	}
+}
+
+void BezierPatchSet::AddPatch(const BezierPatch& patch)
+{
+	std::array<unsigned int, 4> edgeIds;
+
+	for (auto edge = 0u; edge < 4; edge++)
+	{
+		const auto curve = GetCanonicalEdge(patch, edge);
+
+		std::array<float, 12> key;
+
+		for (auto i = 0; i < 4; i++)
+		{
+			key[i * 3] = curve.points[i].x;
+			key[i * 3 + 1] = curve.points[i].y;
+			key[i * 3 + 2] = curve.points[i].z;
+		}
+
+		edgeIds[edge] = m_edgeLookup.emplace(key, static_cast<unsigned int>(m_edgeLookup.size())).first->second;
+	}
+
+	m_patches.push_back(patch);
+	m_edgeIds.push_back(edgeIds);
+}
+
+void BezierPatchSet::AddPatches(const XMFLOAT3* const controlPoints, const size_t controlPointCount)
+{
+	for (size_t first = 0; first + 16 <= controlPointCount; first += 16)
+	{
+		BezierPatch patch;
+		std::copy(controlPoints + first, controlPoints + first + 16, patch.controlPoints);
+
+		AddPatch(patch);
+	}
+}
+
+void BezierPatchSet::Clear()
+{
+	m_patches.clear();
+	m_edgeIds.clear();
+	m_edgeLookup.clear();
+}
+
+BezierPatchSet BezierPatchSet::CreateMobiusStrip()
+{
+	static const XMFLOAT3 controlPoints[64] = {
+		XMFLOAT3(1.0f, -0.5f, 0.0f),
+		XMFLOAT3(1.0f, -0.5f, 0.5f),
+		XMFLOAT3(0.5f, -0.3536f, 1.354f),
+		XMFLOAT3(0.0f, -0.3536f, 1.354f),
+		XMFLOAT3(1.0f, -0.1667f, 0.0f),
+		XMFLOAT3(1.0f, -0.1667f, 0.5f),
+		XMFLOAT3(0.5f, -0.1179f, 1.118f),
+		XMFLOAT3(0.0f, -0.1179f, 1.118f),
+		XMFLOAT3(1.0f, 0.1667f, 0.0f),
+		XMFLOAT3(1.0f, 0.1667f, 0.5f),
+		XMFLOAT3(0.5f, 0.1179f, 0.8821f),
+		XMFLOAT3(0.0f, 0.1179f, 0.8821f),
+		XMFLOAT3(1.0f, 0.5f, 0.0f),
+		XMFLOAT3(1.0f, 0.5f, 0.5f),
+		XMFLOAT3(0.5f, 0.3536f, 0.6464f),
+		XMFLOAT3(0.0f, 0.3536f, 0.6464f),
+		XMFLOAT3(0.0f, -0.3536f, 1.354f),
+		XMFLOAT3(-0.5f, -0.3536f, 1.354f),
+		XMFLOAT3(-1.5f, 0.0f, 0.5f),
+		XMFLOAT3(-1.5f, 0.0f, 0.0f),
+		XMFLOAT3(0.0f, -0.1179f, 1.118f),
+		XMFLOAT3(-0.5f, -0.1179f, 1.118f),
+		XMFLOAT3(-1.167f, 0.0f, 0.5f),
+		XMFLOAT3(-1.167f, 0.0f, 0.0f),
+		XMFLOAT3(0.0f, 0.1179f, 0.8821f),
+		XMFLOAT3(-0.5f, 0.1179f, 0.8821f),
+		XMFLOAT3(-0.8333f, 0.0f, 0.5f),
+		XMFLOAT3(-0.8333f, 0.0f, 0.0f),
+		XMFLOAT3(0.0f, 0.3536f, 0.6464f),
+		XMFLOAT3(-0.5f, 0.3536f, 0.6464f),
+		XMFLOAT3(-0.5f, 0.0f, 0.5f),
+		XMFLOAT3(-0.5f, 0.0f, 0.0f),
+		XMFLOAT3(-1.5f, 0.0f, 0.0f),
+		XMFLOAT3(-1.5f, 0.0f, -0.5f),
+		XMFLOAT3(-0.5f, 0.3536f, -1.354f),
+		XMFLOAT3(0.0f, 0.3536f, -1.354f),
+		XMFLOAT3(-1.167f, 0.0f, 0.0f),
+		XMFLOAT3(-1.167f, 0.0f, -0.5f),
+		XMFLOAT3(-0.5f, 0.1179f, -1.118f),
+		XMFLOAT3(0.0f, 0.1179f, -1.118f),
+		XMFLOAT3(-0.8333f, 0.0f, 0.0f),
+		XMFLOAT3(-0.8333f, 0.0f, -0.5f),
+		XMFLOAT3(-0.5f, -0.1179f, -0.8821f),
+		XMFLOAT3(0.0f, -0.1179f, -0.8821f),
+		XMFLOAT3(-0.5f, 0.0f, 0.0f),
+		XMFLOAT3(-0.5f, 0.0f, -0.5f),
+		XMFLOAT3(-0.5f, -0.3536f, -0.6464f),
+		XMFLOAT3(0.0f, -0.3536f, -0.6464f),
+		XMFLOAT3(0.0f, 0.3536f, -1.354f),
+		XMFLOAT3(0.5f, 0.3536f, -1.354f),
+		XMFLOAT3(1.0f, 0.5f, -0.5f),
+		XMFLOAT3(1.0f, 0.5f, 0.0f),
+		XMFLOAT3(0.0f, 0.1179f, -1.118f),
+		XMFLOAT3(0.5f, 0.1179f, -1.118f),
+		XMFLOAT3(1.0f, 0.1667f, -0.5f),
+		XMFLOAT3(1.0f, 0.1667f, 0.0f),
+		XMFLOAT3(0.0f, -0.1179f, -0.8821f),
+		XMFLOAT3(0.5f, -0.1179f, -0.8821f),
+		XMFLOAT3(1.0f, -0.1667f, -0.5f),
+		XMFLOAT3(1.0f, -0.1667f, 0.0f),
+		XMFLOAT3(0.0f, -0.3536f, -0.6464f),
+		XMFLOAT3(0.5f, -0.3536f, -0.6464f),
+		XMFLOAT3(1.0f, -0.5f, -0.5f),
+		XMFLOAT3(1.0f, -0.5f, 0.0f)
+	};
+
+	BezierPatchSet patches;
+	patches.AddPatches(controlPoints, ARRAYSIZE(controlPoints));
+
+	return patches;
+}
+
+void BezierPatchSet::Evaluate(const BezierPatch& patch, FXMVECTOR u, FXMVECTOR v, SurfaceSamples& samples)
+{
+	XMVECTOR basisU[4], derivativeU[4], basisV[4], derivativeV[4];
+
+	BernsteinBasis(u, basisU, derivativeU);
+	BernsteinBasis(v, basisV, derivativeV);
+
+	samples.x = samples.y = samples.z = XMVectorZero();
+	samples.dux = samples.duy = samples.duz = XMVectorZero();
+	samples.dvx = samples.dvy = samples.dvz = XMVectorZero();
+
+	//Each row collapses to a point and a u derivative, then the rows are blended along v
+	for (auto row = 0; row < 4; row++)
+	{
+		auto rowX = XMVectorZero(), rowY = XMVectorZero(), rowZ = XMVectorZero();
+		auto rowDuX = XMVectorZero(), rowDuY = XMVectorZero(), rowDuZ = XMVectorZero();
+
+		for (auto column = 0; column < 4; column++)
+		{
+			const auto& point = patch.controlPoints[row * 4 + column];
+			const auto pointX = XMVectorReplicate(point.x);
+			const auto pointY = XMVectorReplicate(point.y);
+			const auto pointZ = XMVectorReplicate(point.z);
+
+			rowX = XMVectorMultiplyAdd(basisU[column], pointX, rowX);
+			rowY = XMVectorMultiplyAdd(basisU[column], pointY, rowY);
+			rowZ = XMVectorMultiplyAdd(basisU[column], pointZ, rowZ);
+
+			rowDuX = XMVectorMultiplyAdd(derivativeU[column], pointX, rowDuX);
+			rowDuY = XMVectorMultiplyAdd(derivativeU[column], pointY, rowDuY);
+			rowDuZ = XMVectorMultiplyAdd(derivativeU[column], pointZ, rowDuZ);
+		}
+
+		samples.x = XMVectorMultiplyAdd(basisV[row], rowX, samples.x);
+		samples.y = XMVectorMultiplyAdd(basisV[row], rowY, samples.y);
+		samples.z = XMVectorMultiplyAdd(basisV[row], rowZ, samples.z);
+
+		samples.dux = XMVectorMultiplyAdd(basisV[row], rowDuX, samples.dux);
+		samples.duy = XMVectorMultiplyAdd(basisV[row], rowDuY, samples.duy);
+		samples.duz = XMVectorMultiplyAdd(basisV[row], rowDuZ, samples.duz);
+
+		samples.dvx = XMVectorMultiplyAdd(derivativeV[row], rowX, samples.dvx);
+		samples.dvy = XMVectorMultiplyAdd(derivativeV[row], rowY, samples.dvy);
+		samples.dvz = XMVectorMultiplyAdd(derivativeV[row], rowZ, samples.dvz);
+	}
+}
+
+void BezierPatchSet::Evaluate(const BezierPatch& patch, const float u, const float v, XMFLOAT3& position, XMFLOAT3& tangentU, XMFLOAT3& tangentV)
+{
+	const auto invU = 1.0f - u;
+	const auto invV = 1.0f - v;
+
+	const float basisU[4] = { invU * invU * invU, 3.0f * u * invU * invU, 3.0f * u * u * invU, u * u * u };
+	const float basisV[4] = { invV * invV * invV, 3.0f * v * invV * invV, 3.0f * v * v * invV, v * v * v };
+	const float derivativeU[4] = { -3.0f * invU * invU, 3.0f * invU * invU - 6.0f * u * invU, 6.0f * u * invU - 3.0f * u * u, 3.0f * u * u };
+	const float derivativeV[4] = { -3.0f * invV * invV, 3.0f * invV * invV - 6.0f * v * invV, 6.0f * v * invV - 3.0f * v * v, 3.0f * v * v };
+
+	position = tangentU = tangentV = XMFLOAT3(0.0f, 0.0f, 0.0f);
+
+	for (auto row = 0; row < 4; row++)
+	{
+		for (auto column = 0; column < 4; column++)
+		{
+			const auto& point = patch.controlPoints[row * 4 + column];
+			const auto weight = basisU[column] * basisV[row];
+			const auto weightU = derivativeU[column] * basisV[row];
+			const auto weightV = basisU[column] * derivativeV[row];
+
+			position.x += weight * point.x;
+			position.y += weight * point.y;
+			position.z += weight * point.z;
+
+			tangentU.x += weightU * point.x;
+			tangentU.y += weightU * point.y;
+			tangentU.z += weightU * point.z;
+
+			tangentV.x += weightV * point.x;
+			tangentV.y += weightV * point.y;
+			tangentV.z += weightV * point.z;
+		}
+	}
+}
+
+BezierPatchLevels BezierPatchSet::ComputeLevels(const size_t patchIndex, const BezierTessellationSettings& settings) const
+{
+	const auto& patch = m_patches[patchIndex];
+	const auto* const points = patch.controlPoints;
+
+	BezierPatchLevels levels;
+
+	const auto tolerance = ToleranceAt(settings, DistanceToPoints(settings.viewPosition, points, 16));
+
+	auto flatnessU = 0.0f;
+	auto flatnessV = 0.0f;
+	auto twist = 0.0f;
+
+	for (auto i = 0; i < 4; i++)
+	{
+		flatnessU = std::max(flatnessU, CurveFlatness(points[i * 4], points[i * 4 + 1], points[i * 4 + 2], points[i * 4 + 3]));
+		flatnessV = std::max(flatnessV, CurveFlatness(points[i], points[i + 4], points[i + 8], points[i + 12]));
+	}
+
+	for (auto row = 0; row < 3; row++)
+	{
+		for (auto column = 0; column < 3; column++)
+		{
+			const auto& p00 = points[row * 4 + column];
+			const auto& p01 = points[row * 4 + column + 1];
+			const auto& p10 = points[(row + 1) * 4 + column];
+			const auto& p11 = points[(row + 1) * 4 + column + 1];
+
+			const auto x = p11.x - p10.x - p01.x + p00.x;
+			const auto y = p11.y - p10.y - p01.y + p00.y;
+			const auto z = p11.z - p10.z - p01.z + p00.z;
+
+			twist = std::max(twist, std::sqrt(x * x + y * y + z * z));
+		}
+	}
+
+	//|d2P/du2| is at most six times the row flatness, |d2P/dudv| nine times the twist, and a triangle spanning
+	//(hu, hv) deviates by at most an eighth of the second derivative along its longest edge
+	InsideLevels(0.75f * flatnessU, 2.25f * twist, 0.75f * flatnessV, tolerance, settings.maxLevel, levels.insideU, levels.insideV);
+
+	//An edge is never coarser than the inside next to it, otherwise the stitching triangles would be too long
+	for (auto edge = 0u; edge < 4; edge++)
+	{
+		const auto curve = GetCanonicalEdge(patch, edge);
+		const auto edgeTolerance = ToleranceAt(settings, DistanceToPoints(settings.viewPosition, curve.points, 4));
+		const auto edgeLevel = LevelFor(CurveFlatness(curve.points[0], curve.points[1], curve.points[2], curve.points[3]), edgeTolerance, settings.maxLevel);
+
+		levels.edges[edge] = std::max(edgeLevel, edge % 2 == 0 ? levels.insideU : levels.insideV);
+	}
+
+	return levels;
+}
+
+BezierPatchMesh BezierPatchSet::Tessellate(const BezierTessellationSettings& settings, const bool parallel) const
+{
+	const auto start = std::chrono::high_resolution_clock::now();
+
+	std::vector<BezierPatchLevels> levels(m_patches.size());
+
+	for (size_t i = 0; i < m_patches.size(); i++)
+	{
+		levels[i] = ComputeLevels(i, settings);
+	}
+
+	//Shared edges take the finer of the two levels wanted either side
+	std::vector<unsigned int> sharedLevels(m_edgeLookup.size(), 0);
+
+	for (size_t i = 0; i < m_patches.size(); i++)
+	{
+		for (auto edge = 0; edge < 4; edge++)
+		{
+			auto& sharedLevel = sharedLevels[m_edgeIds[i][edge]];
+			sharedLevel = std::max(sharedLevel, levels[i].edges[edge]);
+		}
+	}
+
+	for (size_t i = 0; i < m_patches.size(); i++)
+	{
+		for (auto edge = 0; edge < 4; edge++)
+		{
+			levels[i].edges[edge] = sharedLevels[m_edgeIds[i][edge]];
+		}
+	}
+
+	auto mesh = Tessellate(levels, parallel);
+
+	mesh.generationMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	return mesh;
+}
+
+BezierPatchMesh BezierPatchSet::TessellateUniform(const unsigned int level, const bool parallel) const
+{
+	const auto start = std::chrono::high_resolution_clock::now();
+
+	const BezierPatchLevels uniformLevels = { { level, level, level, level }, level, level };
+
+	auto mesh = Tessellate(std::vector<BezierPatchLevels>(m_patches.size(), uniformLevels), parallel);
+
+	mesh.generationMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	return mesh;
+}
+
+BezierPatchMesh BezierPatchSet::Tessellate(const std::vector<BezierPatchLevels>& levels, const bool parallel) const
+{
+	const auto patchCount = m_patches.size();
+
+	std::vector<PatchMesh> patchMeshes(patchCount);
+
+	const auto tessellatePatch = [&](const size_t patchIndex)
+	{
+		TessellatePatch(m_patches[patchIndex], levels[patchIndex], patchMeshes[patchIndex]);
+	};
+
+	if (parallel)
+	{
+		concurrency::parallel_for(static_cast<size_t>(0), patchCount, tessellatePatch);
+	}
+	else
+	{
+		for (size_t i = 0; i < patchCount; i++)
+		{
+			tessellatePatch(i);
+		}
+	}
+
+	BezierPatchMesh mesh;
+	mesh.levels = levels;
+	mesh.patchIndexStarts.reserve(patchCount + 1);
+
+	size_t vertexCount = 0;
+	size_t indexCount = 0;
+
+	for (const auto& patchMesh : patchMeshes)
+	{
+		vertexCount += patchMesh.vertices.size();
+		indexCount += patchMesh.indices.size();
+	}
+
+	mesh.vertices.reserve(vertexCount);
+	mesh.indices.reserve(indexCount);
+
+	for (const auto& patchMesh : patchMeshes)
+	{
+		const auto baseVertex = static_cast<unsigned long>(mesh.vertices.size());
+
+		mesh.patchIndexStarts.push_back(static_cast<unsigned int>(mesh.indices.size()));
+		mesh.vertices.insert(mesh.vertices.end(), patchMesh.vertices.begin(), patchMesh.vertices.end());
+
+		for (const auto index : patchMesh.indices)
+		{
+			mesh.indices.push_back(baseVertex + index);
+		}
+	}
+
+	mesh.patchIndexStarts.push_back(static_cast<unsigned int>(mesh.indices.size()));
+	mesh.generationMilliseconds = 0.0;
+
+	return mesh;
+}
+
+float BezierPatchSet::MeasureMaxError(const BezierPatchMesh& mesh) const
+{
+	std::vector<float> patchErrors(m_patches.size(), 0.0f);
+
+	concurrency::parallel_for(static_cast<size_t>(0), m_patches.size(), [&](const size_t patchIndex)
+	{
+		auto maxError = 0.0f;
+
+		for (auto index = mesh.patchIndexStarts[patchIndex]; index < mesh.patchIndexStarts[patchIndex + 1]; index += 3)
+		{
+			const auto& a = mesh.vertices[mesh.indices[index]];
+			const auto& b = mesh.vertices[mesh.indices[index + 1]];
+			const auto& c = mesh.vertices[mesh.indices[index + 2]];
+
+			XMFLOAT3 surface, tangentU, tangentV;
+			Evaluate(m_patches[patchIndex], (a.texcoord.x + b.texcoord.x + c.texcoord.x) / 3.0f, (a.texcoord.y + b.texcoord.y + c.texcoord.y) / 3.0f, surface, tangentU, tangentV);
+
+			const auto x = surface.x - (a.position.x + b.position.x + c.position.x) / 3.0f;
+			const auto y = surface.y - (a.position.y + b.position.y + c.position.y) / 3.0f;
+			const auto z = surface.z - (a.position.z + b.position.z + c.position.z) / 3.0f;
+
+			maxError = std::max(maxError, std::sqrt(x * x + y * y + z * z));
+		}
+
+		patchErrors[patchIndex] = maxError;
+	});
+
+	return patchErrors.empty() ? 0.0f : *std::max_element(patchErrors.begin(), patchErrors.end());
+}
+
+size_t BezierPatchSet::GetMaxVertexCount(const size_t patchCount, const unsigned int maxLevel)
+{
+	//A uniform grid is the worst case, the stitched layout has at most 4L edge vertices plus (L - 1)^2 inside
+	return patchCount * (maxLevel + 1) * (maxLevel + 1);
+}
+
+size_t BezierPatchSet::GetMaxIndexCount(const size_t patchCount, const unsigned int maxLevel)
+{
+	return patchCount * 6 * maxLevel * maxLevel;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <map>
+#include <vector>
+#include <DirectXMath.h>
+
+#include "..\Content\ShaderStructures.h"
+#include "ParametricSurface.h"
+
+namespace AlienPlanetACW
+{
+	//Sixteen control points, row major with rows along v and columns along u, same order as BezierCurveDS.hlsl
+	struct BezierPatch
+	{
+		DirectX::XMFLOAT3 controlPoints[16];
+	};
+
+	//Edges run anticlockwise around the patch: 0 is v = 0, 1 is u = 1, 2 is v = 1 and 3 is u = 0
+	struct BezierPatchLevels
+	{
+		unsigned int edges[4];
+		unsigned int insideU;
+		unsigned int insideV;
+	};
+
+	struct BezierTessellationSettings
+	{
+		//Largest allowed distance between the surface and its triangles, in patch units or in pixels when screenSpace is set
+		float tolerance = 0.01f;
+		bool screenSpace = false;
+
+		//Viewer position in patch space, and how many pixels one patch unit covers at a distance of one unit
+		DirectX::XMFLOAT3 viewPosition = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);
+		float pixelsPerUnit = 1.0f;
+
+		unsigned int maxLevel = 64;
+	};
+
+	struct BezierPatchMesh
+	{
+		std::vector<VertexPositionTexcoordNormalTangentBinormal> vertices;
+		std::vector<unsigned long> indices;
+
+		//Per patch levels, and the first index of each patch's triangles with one extra entry for the end
+		std::vector<BezierPatchLevels> levels;
+		std::vector<unsigned int> patchIndexStarts;
+
+		double generationMilliseconds;
+	};
+
+	//Any number of bicubic Bezier patches tessellated on the CPU. Patches sharing an edge (the same four control
+	//points either way round) agree on its level, and edge vertices are evaluated on the edge curve in a canonical
+	//order, so neighbours produce identical vertices along it and the mesh has no cracks whatever each interior picks
+	class BezierPatchSet
+	{
+	public:
+		void AddPatch(const BezierPatch& patch);
+		void AddPatches(const DirectX::XMFLOAT3* const controlPoints, const size_t controlPointCount);
+		void Clear();
+
+		size_t GetPatchCount() const { return m_patches.size(); }
+		const BezierPatch& GetPatch(const size_t patchIndex) const { return m_patches[patchIndex]; }
+		const std::vector<BezierPatch>& GetPatches() const { return m_patches; }
+
+		//The four patch Mobius strip that BezierCurve used to send to the tessellator
+		static BezierPatchSet CreateMobiusStrip();
+
+		//Four (u, v) pairs at once, positions and both tangents
+		static void Evaluate(const BezierPatch& patch, DirectX::FXMVECTOR u, DirectX::FXMVECTOR v, SurfaceSamples& samples);
+
+		//Scalar reference of the above
+		static void Evaluate(const BezierPatch& patch, const float u, const float v, DirectX::XMFLOAT3& position, DirectX::XMFLOAT3& tangentU, DirectX::XMFLOAT3& tangentV);
+
+		//Levels wanted by one patch on its own, Tessellate then raises shared edges to what both sides want
+		BezierPatchLevels ComputeLevels(const size_t patchIndex, const BezierTessellationSettings& settings) const;
+
+		BezierPatchMesh Tessellate(const BezierTessellationSettings& settings, const bool parallel = true) const;
+		BezierPatchMesh TessellateUniform(const unsigned int level, const bool parallel = true) const;
+
+		//Largest distance between the surface and the mesh, sampled at every triangle centroid
+		float MeasureMaxError(const BezierPatchMesh& mesh) const;
+
+		//Upper bounds on mesh size for any set of levels up to maxLevel, used to size dynamic buffers
+		static size_t GetMaxVertexCount(const size_t patchCount, const unsigned int maxLevel);
+		static size_t GetMaxIndexCount(const size_t patchCount, const unsigned int maxLevel);
+
+	private:
+		BezierPatchMesh Tessellate(const std::vector<BezierPatchLevels>& levels, const bool parallel) const;
+
+		std::vector<BezierPatch> m_patches;
+
+		//Shared edge id for each patch edge, looked up by the edge's canonical control points
+		std::vector<std::array<unsigned int, 4>> m_edgeIds;
+		std::map<std::array<float, 12>, unsigned int> m_edgeLookup;
+	};
+}
@@ -11,6 +11,7 @@ Sample3DSceneRenderer::Sample3DSceneRenderer(const std::shared_ptr<DX::DeviceRes
 	m_displacementPower(0.4f),
 	m_degreesPerSecond(45),
 	m_tracking(false),
+	m_benchmarksRunning(false),
 	m_deviceResources(deviceResources)
 {
 	m_resourceManager = std::make_shared<ResourceManager>();
@@ -81,11 +82,13 @@ Sample3DSceneRenderer::Sample3DSceneRenderer(const std::shared_ptr<DX::DeviceRes
 	m_tessellatedSphere = std::make_unique<TessellatedSphere>(deviceResources, m_resourceManager);
 	m_cameraTessellatedSphere = std::make_unique<CameraTessellatedSphere>(deviceResources, m_resourceManager);
 	m_mobiusStrip = std::make_unique<BezierCurve>(deviceResources);
-	m_snake.emplace_back(std::make_unique<Snake>(deviceResources, m_resourceManager, DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), 0.05f, 1, 15, true));
-	m_snake.emplace_back(std::make_unique<Snake>(deviceResources, m_resourceManager, DirectX::XMFLOAT3(-0.5f, 0.0f, 0.5f), 0.02f, 1, 15, true));
-	m_snake.emplace_back(std::make_unique<Snake>(deviceResources, m_resourceManager, DirectX::XMFLOAT3(0.5f, 0.0f, 0.0f), 0.01f, 2, 30, false));
+	m_snakeCrowd = std::make_unique<SnakeCrowd>(deviceResources, m_resourceManager, 15, 5.0f);
+	m_snakeCrowd->AddSnake(DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), DirectX::XMFLOAT2(0.0f, 1.0f), 0.05f, 1.0f, 0.5f);
+	m_snakeCrowd->AddSnake(DirectX::XMFLOAT3(-0.5f, 0.0f, 0.5f), DirectX::XMFLOAT2(0.0f, 1.0f), 0.02f, 1.0f, 0.5f);
+	m_snakeCrowd->AddSnake(DirectX::XMFLOAT3(0.5f, 0.0f, 0.0f), DirectX::XMFLOAT2(1.0f, 0.0f), 0.01f, 2.0f, 0.5f);
 	m_planetSea = std::make_unique<PlanetSea>(deviceResources, m_resourceManager);
 	m_implicitRayModels = std::make_unique<ImplicitRayModels>(deviceResources);
+	m_implicitMeshedObjects = std::make_unique<ImplicitMeshedObjects>(deviceResources, m_resourceManager);
 	m_implicitRayTracedModels = std::make_unique<ImplicitRayTracedModels>(deviceResources);
 
 	
@@ -161,14 +164,12 @@ void Sample3DSceneRenderer::Update(DX::StepTimer const& timer)
 	m_cameraTessellatedSphere->Update(timer);
 	m_mobiusStrip->Update(timer);
 
-	for (auto& snake : m_snake)
-	{
-		snake->Update(timer);
-	}
+	m_snakeCrowd->Update(timer);
 
 	m_planetSea->Update(timer);
 
 	m_implicitRayModels->Update(timer);
+	m_implicitMeshedObjects->Update(timer);
 	m_implicitRayTracedModels->Update(timer);
 }
 
@@ -251,6 +252,16 @@ void Sample3DSceneRenderer::CheckInputCameraMovement(DX::StepTimer const& timer)
 	{
 		m_displacementPower += 0.01f;
 	}
+
+	if (QueryKeyPressed(VirtualKey::F5) && !m_benchmarksRunning.exchange(true))
+	{
+		//CPU only benchmarks, run off the render thread and written to Benchmarks.txt in the local folder
+		concurrency::create_task([this]()
+		{
+			Benchmarks::RunAll();
+			m_benchmarksRunning = false;
+		});
+	}
 }
 
 bool Sample3DSceneRenderer::QueryKeyPressed(VirtualKey key)
@@ -297,12 +308,9 @@ void Sample3DSceneRenderer::Render()
 	m_mobiusStrip->SetCameraPositionConstantBuffer(m_camera->GetPosition());
 	m_mobiusStrip->Render();
 
-	for (auto& snake : m_snake)
-	{
-		snake->SetViewProjectionMatrixConstantBuffer(viewMatrix, DirectX::XMLoadFloat4x4(&m_projectionMatrix));
-		snake->SetCameraPositionConstantBuffer(m_camera->GetPosition());
-		snake->Render();
-	}
+	m_snakeCrowd->SetViewProjectionMatrixConstantBuffer(viewMatrix, DirectX::XMLoadFloat4x4(&m_projectionMatrix));
+	m_snakeCrowd->SetCameraPositionConstantBuffer(m_camera->GetPosition());
+	m_snakeCrowd->Render();
 
 	m_planetSea->SetViewProjectionMatrixConstantBuffer(viewMatrix, DirectX::XMLoadFloat4x4(&m_projectionMatrix));
 	m_planetSea->SetCameraPositionConstantBuffer(m_camera->GetPosition());
@@ -313,9 +321,15 @@ void Sample3DSceneRenderer::Render()
 
 	m_deviceResources->GetD3DDeviceContext()->OMSetBlendState(m_alphaDisableBlendState, nullptr, 0xffffffff);
 
+	//The objects far enough away for their meshes are drawn first, and left out of the marching
+	m_implicitMeshedObjects->SetViewProjectionMatrixConstantBuffer(viewMatrix, DirectX::XMLoadFloat4x4(&m_projectionMatrix));
+	m_implicitMeshedObjects->SetCameraPositionConstantBuffer(m_camera->GetPosition());
+	m_implicitMeshedObjects->Render();
+
 	m_implicitRayModels->SetViewProjectionMatrixConstantBuffer(viewMatrix, DirectX::XMLoadFloat4x4(&m_projectionMatrix));
 	m_implicitRayModels->SetInverseViewMatrixConstantBuffer(DirectX::XMMatrixInverse(nullptr, viewMatrix));
 	m_implicitRayModels->SetCameraPositionConstantBuffer(m_camera->GetPosition());
+	m_implicitRayModels->SetMeshedObjects(m_implicitMeshedObjects->GetMeshedObjects());
 	m_implicitRayModels->Render();
 
 	m_implicitRayTracedModels->SetViewProjectionMatrixConstantBuffer(viewMatrix, DirectX::XMLoadFloat4x4(&m_projectionMatrix));
@@ -370,14 +384,12 @@ void Sample3DSceneRenderer::CreateDeviceDependentResources()
 	m_cameraTessellatedSphere->CreateDeviceDependentResources();
 	m_mobiusStrip->CreateDeviceDependentResources();
 
-	for (auto& snake : m_snake)
-	{
-		snake->CreateDeviceDependentResources();
-	}
+	m_snakeCrowd->CreateDeviceDependentResources();
 
 	m_planetSea->CreateDeviceDependentResources();
 
 	m_implicitRayModels->CreateDeviceDependentResources();
+	m_implicitMeshedObjects->CreateDeviceDependentResources();
 	m_implicitRayTracedModels->CreateDeviceDependentResources();
 }
 
@@ -393,13 +405,11 @@ void Sample3DSceneRenderer::ReleaseDeviceDependentResources()
 	m_cameraTessellatedSphere->ReleaseDeviceDependentResources();
 	m_mobiusStrip->ReleaseDeviceDependentResources();
 
-	for (auto& snake : m_snake)
-	{
-		snake->ReleaseDeviceDependentResources();
-	}
+	m_snakeCrowd->ReleaseDeviceDependentResources();
 
 	m_planetSea->ReleaseDeviceDependentResources();
 
 	m_implicitRayModels->ReleaseDeviceDependentResources();
+	m_implicitMeshedObjects->ReleaseDeviceDependentResources();
 	m_implicitRayTracedModels->ReleaseDeviceDependentResources();
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "..\Common\StepTimer.h"
 #include <vector>
 #include <string>
+#include <atomic>
 
 #include "ResourceManager.h"
 
@@ -16,10 +17,12 @@
 #include "TessellatedSphere.h"
 #include "CameraTessellatedSphere.h"
 #include "BezierCurve.h"
-#include "Snake.h"
+#include "SnakeCrowd.h"
 #include "PlanetSea.h"
 #include "ImplicitRayModels.h"
+#include "ImplicitMeshedObjects.h"
 #include "ImplicitRayTracedModels.h"
+#include "Benchmarks.h"
 
 namespace AlienPlanetACW
 {
@@ -67,9 +70,10 @@ namespace AlienPlanetACW
 		std::unique_ptr<TessellatedSphere> m_tessellatedSphere;
 		std::unique_ptr<CameraTessellatedSphere> m_cameraTessellatedSphere;
 		std::unique_ptr<BezierCurve> m_mobiusStrip;
-		std::vector<std::unique_ptr<Snake>> m_snake;
+		std::unique_ptr<SnakeCrowd> m_snakeCrowd;
 		std::unique_ptr<PlanetSea> m_planetSea;
 		std::unique_ptr<ImplicitRayModels> m_implicitRayModels;
+		std::unique_ptr<ImplicitMeshedObjects> m_implicitMeshedObjects;
 		std::unique_ptr<ImplicitRayTracedModels> m_implicitRayTracedModels;
 
 		DirectX::XMFLOAT4X4 m_projectionMatrix;
@@ -81,6 +85,8 @@ namespace AlienPlanetACW
 
 		float	m_degreesPerSecond;
 		bool	m_tracking;
+
+		std::atomic<bool>	m_benchmarksRunning;
 	};
 }
 
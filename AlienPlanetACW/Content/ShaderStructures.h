@@ -27,6 +27,51 @@ namespace AlienPlanetACW
 		DirectX::XMFLOAT3 padding;
 	};
 
+	//timeConstantBuffer in ImplicitRayModelsPS.hlsl, the time with everything in the scene that only depends on it from
+	//ImplicitSceneParameters, so the shader doesn't work it out again at every sample. Packed into 16 byte registers
+	//like the shader's
+	struct ImplicitSceneTimeConstantBuffer
+	{
+		float time;
+		float morph;
+		float beamLength;
+		float wobble;
+		DirectX::XMFLOAT3 shipPosition;
+		float alienEyeHeight;
+		DirectX::XMFLOAT3 beamPosition;
+		float alienMouth;
+		DirectX::XMFLOAT3 dripHeights;
+		float alienArm;
+		DirectX::XMFLOAT3 mandelbulbColour;
+		float mandelbulbPower;
+		//Rows, w is unused
+		DirectX::XMFLOAT4 mandelbulbRotation[3];
+		//Bit n set for each object n ImplicitMeshedObjects draws this frame, which the marching leaves out
+		unsigned int meshedObjects;
+		//ImplicitSceneTileBins::GetColumns, for finding a pixel's list in tileBins
+		unsigned int tileColumns;
+		DirectX::XMFLOAT2 padding;
+	};
+
+	//Checkerboard rendering's passes in ImplicitRayModels, checkerboardConstantBuffer in ImplicitCheckerboard.hlsli
+	struct ImplicitCheckerboardConstantBuffer
+	{
+		//Last frame's view, transposed like ModelViewProjectionConstantBuffer's
+		DirectX::XMFLOAT4X4 previousView;
+		DirectX::XMFLOAT2 screenSize;
+		unsigned int checkerboardFrame;
+		//0 when there's no last frame's image to reproject into
+		unsigned int historyValid;
+	};
+
+	//Dynamic resolution's passes in ImplicitRayModels, dynamicResolutionConstantBuffer in ImplicitDynamicResolution.hlsli
+	struct ImplicitDynamicResolutionConstantBuffer
+	{
+		//The part of the scaled textures the main pass draws, in pixels
+		DirectX::XMFLOAT2 renderSize;
+		DirectX::XMFLOAT2 screenSize;
+	};
+
 	struct DeltaTimeConstantBuffer
 	{
 		float dt;
@@ -0,0 +1,82 @@
+#include "pch.h"
+#include "HeadlessImage.h"
+
+#include <fstream>
+
+using namespace AlienPlanetACW;
+
+HeadlessImage::HeadlessImage(const unsigned int width, const unsigned int height) : m_width(width), m_height(height), m_pixels(width * height, DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f))
+{
+}
+
+std::vector<unsigned char> HeadlessImage::EncodeBmp() const
+{
+	//Rows are padded to four bytes and stored bottom up
+	const auto rowSize = (m_width * 3 + 3) & ~3u;
+	const auto pixelDataSize = rowSize * m_height;
+	const auto fileSize = 54 + pixelDataSize;
+
+	std::vector<unsigned char> bmp(fileSize, 0);
+
+	const auto write16 = [&bmp](const unsigned int offset, const unsigned int value)
+	{
+		bmp[offset] = static_cast<unsigned char>(value);
+		bmp[offset + 1] = static_cast<unsigned char>(value >> 8);
+	};
+
+	const auto write32 = [&bmp](const unsigned int offset, const unsigned int value)
+	{
+		for (auto i = 0u; i < 4; i++)
+		{
+			bmp[offset + i] = static_cast<unsigned char>(value >> (i * 8));
+		}
+	};
+
+	bmp[0] = 'B';
+	bmp[1] = 'M';
+	write32(2, fileSize);
+	write32(10, 54);
+
+	write32(14, 40);
+	write32(18, m_width);
+	write32(22, m_height);
+	write16(26, 1);
+	write16(28, 24);
+	write32(34, pixelDataSize);
+
+	const auto toByte = [](const float value)
+	{
+		const auto clamped = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+		return static_cast<unsigned char>(clamped * 255.0f + 0.5f);
+	};
+
+	for (auto y = 0u; y < m_height; y++)
+	{
+		auto* row = &bmp[54 + (m_height - 1 - y) * rowSize];
+
+		for (auto x = 0u; x < m_width; x++)
+		{
+			const auto& pixel = GetPixel(x, y);
+
+			row[x * 3] = toByte(pixel.z);
+			row[x * 3 + 1] = toByte(pixel.y);
+			row[x * 3 + 2] = toByte(pixel.x);
+		}
+	}
+
+	return bmp;
+}
+
+void HeadlessImage::WriteBmp(const std::wstring& fileName) const
+{
+	const auto bmp = EncodeBmp();
+
+	auto localFolder = Windows::Storage::ApplicationData::Current->LocalFolder->Path;
+
+	std::ofstream file(std::wstring(localFolder->Data()) + L"\\" + fileName, std::ios::binary);
+
+	if (!file.fail())
+	{
+		file.write(reinterpret_cast<const char*>(bmp.data()), bmp.size());
+	}
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <string>
+#include <vector>
+
+namespace AlienPlanetACW
+{
+	//RGB image rendered on the CPU, saved as a 24 bit BMP in the app's local folder
+	class HeadlessImage
+	{
+	public:
+		HeadlessImage(unsigned int width, unsigned int height);
+
+		unsigned int GetWidth() const { return m_width; }
+		unsigned int GetHeight() const { return m_height; }
+
+		void SetPixel(unsigned int x, unsigned int y, const DirectX::XMFLOAT3& colour) { m_pixels[y * m_width + x] = colour; }
+		const DirectX::XMFLOAT3& GetPixel(unsigned int x, unsigned int y) const { return m_pixels[y * m_width + x]; }
+
+		//Colours are clamped to 0 to 1, no gamma, the same as the swap chain gets them
+		std::vector<unsigned char> EncodeBmp() const;
+		void WriteBmp(const std::wstring& fileName) const;
+
+	private:
+		unsigned int m_width;
+		unsigned int m_height;
+		std::vector<DirectX::XMFLOAT3> m_pixels;
+	};
+}
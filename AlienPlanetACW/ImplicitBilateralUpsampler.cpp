@@ -0,0 +1,164 @@
+#include "pch.h"
+#include "ImplicitBilateralUpsampler.h"
+#include "ImplicitSceneSdf.h"
+
+#include <algorithm>
+#include <cmath>
+#include <ppl.h>
+
+using namespace AlienPlanetACW;
+using namespace DirectX;
+
+const float ImplicitBilateralUpsampler::DepthSigma = 0.05f;
+
+void ImplicitBilateralUpsampler::Upsample(const HeadlessImage& source, const std::vector<float>& sourceDepths, HeadlessImage& image, std::vector<float>& depths, const ImplicitDepthPyramid* const depthLimits, const XMFLOAT3& background, const ImplicitUpsampleFilter filter, const bool parallel)
+{
+	const auto width = image.GetWidth();
+	const auto height = image.GetHeight();
+	const auto sourceWidth = source.GetWidth();
+	const auto sourceHeight = source.GetHeight();
+
+	const auto useLimits = depthLimits != nullptr && depthLimits->GetWidth() == width && depthLimits->GetHeight() == height;
+
+	depths.assign(width * height, ImplicitSceneSdf::MaxDistance);
+
+	const auto upsampleRow = [&](const size_t row)
+	{
+		const auto y = static_cast<unsigned int>(row);
+
+		//Pixel centres line up, the same as a viewport scaled down over the same canvas
+		const auto sourceY = (y + 0.5f) * sourceHeight / height - 0.5f;
+		const auto top = static_cast<int>(std::floor(sourceY));
+		const auto fractionY = sourceY - top;
+
+		for (auto x = 0u; x < width; x++)
+		{
+			const auto sourceX = (x + 0.5f) * sourceWidth / width - 0.5f;
+			const auto left = static_cast<int>(std::floor(sourceX));
+			const auto fractionX = sourceX - left;
+
+			const auto limit = useLimits ? depthLimits->GetLimit(x, y) - ImplicitSceneSdf::Epsilon : ImplicitSceneSdf::MaxDistance;
+
+			XMFLOAT3 colours[4];
+			float tapDepths[4];
+			float weights[4];
+			bool hits[4];
+
+			for (auto tap = 0; tap < 4; tap++)
+			{
+				const auto tapX = static_cast<unsigned int>(std::min(std::max(left + (tap & 1), 0), static_cast<int>(sourceWidth) - 1));
+				const auto tapY = static_cast<unsigned int>(std::min(std::max(top + (tap >> 1), 0), static_cast<int>(sourceHeight) - 1));
+
+				colours[tap] = source.GetPixel(tapX, tapY);
+				tapDepths[tap] = sourceDepths[tapY * sourceWidth + tapX];
+				weights[tap] = ((tap & 1) != 0 ? fractionX : 1.0f - fractionX) * ((tap >> 1) != 0 ? fractionY : 1.0f - fractionY);
+				//Hidden behind the rasterized scene at this pixel, as the marched ray would have been
+				hits[tap] = tapDepths[tap] < ImplicitSceneSdf::MaxDistance && tapDepths[tap] <= limit;
+			}
+
+			auto colour = background;
+			auto depth = ImplicitSceneSdf::MaxDistance;
+
+			if (filter == ImplicitUpsampleFilter::Nearest)
+			{
+				const auto tap = (fractionX >= 0.5f ? 1 : 0) + (fractionY >= 0.5f ? 2 : 0);
+
+				if (hits[tap])
+				{
+					colour = colours[tap];
+					depth = tapDepths[tap];
+				}
+			}
+			else if (filter == ImplicitUpsampleFilter::Bilinear)
+			{
+				colour = XMFLOAT3(0.0f, 0.0f, 0.0f);
+
+				auto hitWeight = 0.0f;
+				auto hitDepth = 0.0f;
+
+				for (auto tap = 0; tap < 4; tap++)
+				{
+					const auto& tapColour = hits[tap] ? colours[tap] : background;
+
+					colour = XMFLOAT3(colour.x + weights[tap] * tapColour.x, colour.y + weights[tap] * tapColour.y, colour.z + weights[tap] * tapColour.z);
+
+					if (hits[tap])
+					{
+						hitWeight += weights[tap];
+						hitDepth += weights[tap] * tapDepths[tap];
+					}
+				}
+
+				if (hitWeight >= 0.5f)
+				{
+					depth = hitDepth / hitWeight;
+				}
+			}
+			else
+			{
+				auto hitWeight = 0.0f;
+				auto reference = -1;
+
+				for (auto tap = 0; tap < 4; tap++)
+				{
+					if (hits[tap])
+					{
+						hitWeight += weights[tap];
+
+						if (reference < 0 || weights[tap] > weights[reference])
+						{
+							reference = tap;
+						}
+					}
+				}
+
+				//Mostly misses, so the edge of whatever was hit is further over
+				if (hitWeight >= 0.5f)
+				{
+					colour = XMFLOAT3(0.0f, 0.0f, 0.0f);
+					depth = 0.0f;
+
+					auto total = 0.0f;
+
+					for (auto tap = 0; tap < 4; tap++)
+					{
+						if (!hits[tap])
+						{
+							continue;
+						}
+
+						const auto difference = (tapDepths[tap] - tapDepths[reference]) / (DepthSigma * tapDepths[reference]);
+						const auto weight = weights[tap] * std::exp(-difference * difference);
+
+						colour = XMFLOAT3(colour.x + weight * colours[tap].x, colour.y + weight * colours[tap].y, colour.z + weight * colours[tap].z);
+						depth += weight * tapDepths[tap];
+						total += weight;
+					}
+
+					colour = XMFLOAT3(colour.x / total, colour.y / total, colour.z / total);
+					depth /= total;
+				}
+			}
+
+			image.SetPixel(x, y, colour);
+			depths[y * width + x] = depth;
+		}
+	};
+
+	if (parallel)
+	{
+		concurrency::parallel_for(static_cast<size_t>(0), static_cast<size_t>(height), upsampleRow);
+	}
+	else
+	{
+		for (auto row = 0u; row < height; row++)
+		{
+			upsampleRow(row);
+		}
+	}
+}
+
+unsigned int ImplicitBilateralUpsampler::GetScaledSize(const unsigned int size, const float scale)
+{
+	return std::max(static_cast<unsigned int>(size * scale + 0.5f), 1u);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "HeadlessImage.h"
+#include "ImplicitDepthPyramid.h"
+
+#include <DirectXMath.h>
+#include <vector>
+
+namespace AlienPlanetACW
+{
+	//How ImplicitBilateralUpsampler fills in the screen's pixels between the ones marched
+	enum class ImplicitUpsampleFilter
+	{
+		//The marched pixel the screen's pixel is in
+		Nearest,
+		//The four marched pixels around it, hits and misses blended alike
+		Bilinear,
+		//The four around it, weighted by their depths as well, see ImplicitBilateralUpsampler
+		Bilateral
+	};
+
+	//Scales the implicit passes' image up to the screen when they're drawn at less than its resolution. The bilateral
+	//filter first decides whether the pixel is a hit from how much of the bilinear weight is on the hits, so the edges of
+	//the objects stay where they were rather than growing or shrinking. A hit then takes the bilinear weights of the hits
+	//times how close their depths are to the one with the most weight, so nothing blurs across from a surface behind.
+	//ImplicitUpsamplePS.hlsl does the same
+	class ImplicitBilateralUpsampler
+	{
+	public:
+		//Fills image and depths, the image's size, from source and sourceDepths, which are ImplicitRayMarcher's image and
+		//depths at a smaller size with the same view. A hit behind depthLimits, when there are some at the image's size,
+		//doesn't count as one, so nothing bleeds out from behind the rasterized scene
+		static void Upsample(const HeadlessImage& source, const std::vector<float>& sourceDepths, HeadlessImage& image, std::vector<float>& depths, const ImplicitDepthPyramid* depthLimits, const DirectX::XMFLOAT3& background, ImplicitUpsampleFilter filter, bool parallel);
+
+		//The source's size for a scale of the image's, never less than a pixel
+		static unsigned int GetScaledSize(unsigned int size, float scale);
+
+	private:
+		//How far a hit's depth can be from the reference one before its weight falls to e^-1, as a fraction of it
+		static const float DepthSigma;
+	};
+}
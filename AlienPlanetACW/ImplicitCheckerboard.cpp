@@ -0,0 +1,279 @@
+#include "pch.h"
+#include "ImplicitCheckerboard.h"
+#include "ImplicitRayMarcher.h"
+#include "SdfMath.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ppl.h>
+
+using namespace AlienPlanetACW;
+using namespace AlienPlanetACW::Sdf;
+using namespace DirectX;
+
+const float ImplicitCheckerboard::DepthTolerance = 0.05f;
+
+namespace
+{
+	//The ray marcher's camera, rays from the eye through a canvas one unit in front of it that is two units wide
+	struct Camera
+	{
+		Camera(const XMMATRIX& view, const unsigned int imageWidth, const unsigned int imageHeight) : width(imageWidth), height(imageHeight), aspectRatio(static_cast<float>(imageHeight) / imageWidth)
+		{
+			XMFLOAT4X4 inverseView;
+			XMStoreFloat4x4(&inverseView, XMMatrixInverse(nullptr, view));
+
+			right = Vec3<float>(inverseView._11, inverseView._12, inverseView._13);
+			up = Vec3<float>(inverseView._21, inverseView._22, inverseView._23);
+			back = Vec3<float>(inverseView._31, inverseView._32, inverseView._33);
+			eye = Vec3<float>(inverseView._41, inverseView._42, inverseView._43);
+		}
+
+		//Through the pixel's centre
+		Vec3<float> GetRayDirection(const unsigned int x, const unsigned int y) const
+		{
+			const auto canvasX = (x + 0.5f) / width * 2.0f - 1.0f;
+			const auto canvasY = (1.0f - (y + 0.5f) / height * 2.0f) * aspectRatio;
+
+			return Normalize(right * canvasX + up * canvasY - back);
+		}
+
+		//The pixel the point is in, false behind the camera or off the screen
+		bool Project(const Vec3<float>& point, unsigned int& x, unsigned int& y) const
+		{
+			const auto offset = point - eye;
+			const auto forward = -Dot(offset, back);
+
+			if (forward <= 0.0f)
+			{
+				return false;
+			}
+
+			const auto pixelX = (Dot(offset, right) / forward + 1.0f) * 0.5f * width;
+			const auto pixelY = (1.0f - Dot(offset, up) / forward / aspectRatio) * 0.5f * height;
+
+			if (!(pixelX >= 0.0f && pixelX < width && pixelY >= 0.0f && pixelY < height))
+			{
+				return false;
+			}
+
+			x = static_cast<unsigned int>(pixelX);
+			y = static_cast<unsigned int>(pixelY);
+
+			return true;
+		}
+
+		unsigned int width;
+		unsigned int height;
+		float aspectRatio;
+		Vec3<float> eye;
+		Vec3<float> right;
+		Vec3<float> up;
+		Vec3<float> back;
+	};
+
+	//A marched pixel beside the one being reconstructed
+	struct Neighbour
+	{
+		XMFLOAT3 colour;
+		float depth;
+		unsigned char object;
+	};
+}
+
+ImplicitCheckerboardStats ImplicitCheckerboard::Reconstruct(const XMMATRIX& view, const unsigned int frame, HeadlessImage& image, std::vector<float>& depths, std::vector<unsigned char>& objects, const ImplicitCheckerboardHistory* const history, const ImplicitDepthPyramid* const depthLimits, const XMFLOAT3& background, const bool parallel)
+{
+	const auto start = std::chrono::high_resolution_clock::now();
+
+	const auto width = image.GetWidth();
+	const auto height = image.GetHeight();
+
+	const Camera camera(view, width, height);
+
+	const auto useHistory = history != nullptr && history->IsValid() && history->width == width && history->height == height;
+	const Camera previous(useHistory ? XMLoadFloat4x4(&history->view) : view, width, height);
+
+	const auto useLimits = depthLimits != nullptr && depthLimits->GetWidth() == width && depthLimits->GetHeight() == height;
+
+	std::vector<ImplicitCheckerboardStats> rowStats(height);
+
+	//Only the pixels that weren't marched are written, and they're never read, so the rows can go in any order
+	const auto reconstructRow = [&](const size_t row)
+	{
+		const auto y = static_cast<unsigned int>(row);
+		auto& stats = rowStats[row];
+
+		for (auto x = 0u; x < width; x++)
+		{
+			if (IsMarched(x, y, frame))
+			{
+				continue;
+			}
+
+			Neighbour neighbours[4];
+			auto count = 0u;
+
+			const int offsets[4][2] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
+
+			for (const auto& offset : offsets)
+			{
+				const auto neighbourX = static_cast<int>(x) + offset[0];
+				const auto neighbourY = static_cast<int>(y) + offset[1];
+
+				if (neighbourX < 0 || neighbourY < 0 || neighbourX >= static_cast<int>(width) || neighbourY >= static_cast<int>(height))
+				{
+					continue;
+				}
+
+				const auto index = neighbourY * width + neighbourX;
+				neighbours[count++] = { image.GetPixel(neighbourX, neighbourY), depths[index], objects[index] };
+			}
+
+			//Nearest first, so a surface in front is tried before the one behind it. Misses are at the far distance
+			std::sort(neighbours, neighbours + count, [](const Neighbour& a, const Neighbour& b) { return a.depth < b.depth; });
+
+			auto colour = background;
+			auto depth = ImplicitSceneSdf::MaxDistance;
+			auto object = ImplicitRayMarcherCache::NoObject;
+			auto found = false;
+
+			const auto direction = camera.GetRayDirection(x, y);
+
+			for (auto i = 0u; i < count && useHistory && !found; i++)
+			{
+				const auto& neighbour = neighbours[i];
+				const auto point = camera.eye + direction * neighbour.depth;
+
+				unsigned int previousX, previousY;
+
+				if (!previous.Project(point, previousX, previousY))
+				{
+					continue;
+				}
+
+				const auto index = previousY * width + previousX;
+
+				//Only the pixels last frame marched, so no pixel's error is carried on into another frame
+				if (IsMarched(previousX, previousY, frame) || history->objects[index] != neighbour.object)
+				{
+					continue;
+				}
+
+				//A miss is a miss at any depth
+				if (neighbour.object != ImplicitRayMarcherCache::NoObject && std::abs(Length(point - previous.eye) - history->depths[index]) > DepthTolerance * history->depths[index])
+				{
+					continue;
+				}
+
+				auto minimum = XMFLOAT3(1e30f, 1e30f, 1e30f);
+				auto maximum = XMFLOAT3(-1e30f, -1e30f, -1e30f);
+
+				for (auto j = 0u; j < count; j++)
+				{
+					if (neighbours[j].object == neighbour.object)
+					{
+						minimum = XMFLOAT3(std::min(minimum.x, neighbours[j].colour.x), std::min(minimum.y, neighbours[j].colour.y), std::min(minimum.z, neighbours[j].colour.z));
+						maximum = XMFLOAT3(std::max(maximum.x, neighbours[j].colour.x), std::max(maximum.y, neighbours[j].colour.y), std::max(maximum.z, neighbours[j].colour.z));
+					}
+				}
+
+				const auto& previousColour = history->colours[index];
+
+				colour = XMFLOAT3(Clamp(previousColour.x, minimum.x, maximum.x), Clamp(previousColour.y, minimum.y, maximum.y), Clamp(previousColour.z, minimum.z, maximum.z));
+				depth = neighbour.depth;
+				object = neighbour.object;
+				found = true;
+
+				stats.historyPixels++;
+			}
+
+			if (!found && count > 0)
+			{
+				//The object most of the neighbours hit, the nearest of those tied
+				auto bestCount = 0u;
+
+				for (auto i = 0u; i < count; i++)
+				{
+					const auto hits = static_cast<unsigned int>(std::count_if(neighbours, neighbours + count, [&](const Neighbour& n) { return n.object == neighbours[i].object; }));
+
+					if (hits > bestCount)
+					{
+						bestCount = hits;
+						object = neighbours[i].object;
+					}
+				}
+
+				colour = XMFLOAT3(0.0f, 0.0f, 0.0f);
+				depth = 0.0f;
+
+				for (auto i = 0u; i < count; i++)
+				{
+					if (neighbours[i].object == object)
+					{
+						colour = XMFLOAT3(colour.x + neighbours[i].colour.x / bestCount, colour.y + neighbours[i].colour.y / bestCount, colour.z + neighbours[i].colour.z / bestCount);
+						depth += neighbours[i].depth / bestCount;
+					}
+				}
+			}
+
+			//Behind the rasterized scene, which the marched rays would have stopped at
+			if (object != ImplicitRayMarcherCache::NoObject && useLimits && depth > depthLimits->GetLimit(x, y) - ImplicitSceneSdf::Epsilon)
+			{
+				colour = background;
+				depth = ImplicitSceneSdf::MaxDistance;
+				object = ImplicitRayMarcherCache::NoObject;
+			}
+
+			image.SetPixel(x, y, colour);
+			depths[y * width + x] = depth;
+			objects[y * width + x] = object;
+
+			stats.reconstructedPixels++;
+		}
+	};
+
+	if (parallel)
+	{
+		concurrency::parallel_for(static_cast<size_t>(0), static_cast<size_t>(height), reconstructRow);
+	}
+	else
+	{
+		for (auto row = 0u; row < height; row++)
+		{
+			reconstructRow(row);
+		}
+	}
+
+	ImplicitCheckerboardStats stats;
+
+	for (const auto& row : rowStats)
+	{
+		stats.reconstructedPixels += row.reconstructedPixels;
+		stats.historyPixels += row.historyPixels;
+	}
+
+	stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	return stats;
+}
+
+void ImplicitCheckerboard::StoreHistory(const XMMATRIX& view, const HeadlessImage& image, const std::vector<float>& depths, const std::vector<unsigned char>& objects, ImplicitCheckerboardHistory& history)
+{
+	XMStoreFloat4x4(&history.view, view);
+	history.width = image.GetWidth();
+	history.height = image.GetHeight();
+	history.colours.resize(history.width * history.height);
+	history.depths = depths;
+	history.objects = objects;
+
+	for (auto y = 0u; y < history.height; y++)
+	{
+		for (auto x = 0u; x < history.width; x++)
+		{
+			history.colours[y * history.width + x] = image.GetPixel(x, y);
+		}
+	}
+
+	history.frame++;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "HeadlessImage.h"
+#include "ImplicitDepthPyramid.h"
+
+#include <DirectXMath.h>
+#include <vector>
+
+namespace AlienPlanetACW
+{
+	//Last frame's finished image for checkerboard rendering, which the pixels that weren't marched this frame are
+	//reprojected from. Render fills it in at the end of each frame, one entry per pixel row by row
+	struct ImplicitCheckerboardHistory
+	{
+		ImplicitCheckerboardHistory() : frame(0), width(0), height(0) {}
+
+		//Forgets the image, so the next frame is reconstructed from its own pixels. The pattern carries on alternating
+		void Reset() { colours.clear(); depths.clear(); objects.clear(); width = 0; height = 0; }
+		bool IsValid() const { return width > 0 && height > 0 && colours.size() == width * height; }
+
+		//Frames rendered so far, which picks the half of the pixels the next one marches
+		unsigned int frame;
+
+		//The view the image was rendered from
+		DirectX::XMFLOAT4X4 view;
+		unsigned int width;
+		unsigned int height;
+		std::vector<DirectX::XMFLOAT3> colours;
+		//How far along the ray the hit was, ImplicitSceneSdf::MaxDistance for a miss
+		std::vector<float> depths;
+		//ImplicitSceneSdf's object the ray hit, ImplicitRayMarcherCache::NoObject for a miss
+		std::vector<unsigned char> objects;
+	};
+
+	struct ImplicitCheckerboardStats
+	{
+		ImplicitCheckerboardStats() : reconstructedPixels(0), historyPixels(0), milliseconds(0.0) {}
+
+		//Pixels filled in rather than marched
+		unsigned long long reconstructedPixels;
+		//The ones of those taken from last frame's image, the rest were interpolated from the pixels around them
+		unsigned long long historyPixels;
+		double milliseconds;
+	};
+
+	//Checkerboard rendering, where each frame marches the pixels of one colour of a checkerboard and the two colours take
+	//turns. A pixel that isn't marched is reprojected into last frame's image at the depth of each of the four marched
+	//pixels beside it in turn, nearest first, and takes the first pixel it lands in that last frame marched on the same
+	//object at the same depth. Its colour is clamped to the range of the pixels beside it on that object, so nothing
+	//smears in from another object or lingers after the shading has changed. Without one, it's the average of the pixels
+	//beside it on whichever object most of them hit. ImplicitCheckerboardResolvePS.hlsl follows the same rules
+	class ImplicitCheckerboard
+	{
+	public:
+		//The pixels marched on the frame, where x + y + frame is even
+		static bool IsMarched(unsigned int x, unsigned int y, unsigned int frame) { return ((x + y + frame) & 1) == 0; }
+
+		//Fills in the pixels of image, depths and objects that weren't marched on the frame from the ones that were.
+		//view is the frame's, the same as ImplicitRayMarcher::Render's. history, when it's valid and the same size, is
+		//last frame's image. Reconstructed hits behind depthLimits, when there are some, are misses like the marched ones
+		static ImplicitCheckerboardStats Reconstruct(const DirectX::XMMATRIX& view, unsigned int frame, HeadlessImage& image, std::vector<float>& depths, std::vector<unsigned char>& objects, const ImplicitCheckerboardHistory* history, const ImplicitDepthPyramid* depthLimits, const DirectX::XMFLOAT3& background, bool parallel);
+
+		//Keeps the finished frame for the next one and moves the pattern on
+		static void StoreHistory(const DirectX::XMMATRIX& view, const HeadlessImage& image, const std::vector<float>& depths, const std::vector<unsigned char>& objects, ImplicitCheckerboardHistory& history);
+
+	private:
+		//How far the point reprojected at a neighbour's depth can be from last frame's hit, as a fraction of its depth
+		static const float DepthTolerance;
+	};
+}
@@ -0,0 +1,42 @@
+//Checkerboard rendering for ImplicitRayModels and ImplicitRayTracedModels, ImplicitCheckerboard on the CPU. The main
+//pass marches or traces the pixels where x + y + frame is even into textures half the screen's width, one texel per
+//marched pixel, and ImplicitCheckerboardResolvePS.hlsl fills in the rest. ImplicitCheckerboardConstantBuffer in ShaderStructures.h
+cbuffer checkerboardConstantBuffer : register(b4)
+{
+	//Last frame's, for reprojecting into its image
+	matrix previousView;
+	float2 screenSize;
+	//Frames drawn so far, which picks the half of the pixels marched
+	uint checkerboardFrame;
+	//0 on the first frame and after the screen changes size, when there's no image to reproject into
+	uint historyValid;
+}
+
+//What an object index in the hits is for a miss, ImplicitRayMarcherCache::NoObject
+#define NO_OBJECT 255.0f
+
+//ImplicitCheckerboard::IsMarched
+bool isMarched(int2 pixel)
+{
+	return ((pixel.x + pixel.y + checkerboardFrame) & 1) == 0;
+}
+
+//The marched pixel in texel's column of the half width textures
+int2 marchedPixel(int2 texel)
+{
+	return int2(texel.x * 2 + ((texel.y + checkerboardFrame) & 1), texel.y);
+}
+
+//The half width textures' texel a marched pixel is in
+int2 marchedTexel(int2 pixel)
+{
+	return int2(pixel.x / 2, pixel.y);
+}
+
+//Through the pixel's centre on the canvas a unit in front of the camera, which is 2 wide and aspectRatio times that high
+float2 pixelCanvas(int2 pixel, float aspectRatio)
+{
+	float2 uv = (pixel + 0.5f) / screenSize;
+
+	return float2(uv.x * 2.0f - 1.0f, (1.0f - uv.y * 2.0f) * aspectRatio);
+}
@@ -0,0 +1,54 @@
+//Composite pass for checkerboard rendering in ImplicitRayModels. Draws the image ImplicitCheckerboardResolvePS.hlsl
+//finished over the rest of the scene, with each hit's depth written the same as ImplicitRayModelsPS.hlsl would have
+cbuffer ModelViewProjectionConstantBuffer : register(b0)
+{
+	matrix model;
+	matrix view;
+	matrix projection;
+};
+
+cbuffer InverseViewConstantBuffer : register(b1)
+{
+	matrix inverseView;
+}
+
+struct PixelShaderInput
+{
+	float4 position : SV_POSITION;
+	float2 canvasXY : TEXCOORD0;
+};
+
+struct outputPS
+{
+	float4 colour : SV_TARGET;
+	float depth : SV_DEPTH;
+};
+
+//ImplicitCheckerboard.hlsli's NO_OBJECT
+#define NO_OBJECT 255.0f
+
+Texture2D<float4> colours : register(t0);
+Texture2D<float2> hits : register(t1);
+
+outputPS main(PixelShaderInput input)
+{
+	outputPS output;
+
+	float2 hit = hits.Load(int3(input.position.xy, 0));
+
+	if (hit.y == NO_OBJECT)
+	{
+		discard;
+	}
+
+	float3 eye = mul(float4(0.0f, 0.0f, 0.0f, 1.0f), inverseView).xyz;
+	float3 direction = normalize(mul(float4(input.canvasXY, -1.0f, 0.0f), inverseView).xyz);
+
+	float4 pv = mul(float4(eye + hit.x * direction, 1.0f), view);
+	pv = mul(pv, projection);
+	output.depth = pv.z / pv.w;
+
+	output.colour = colours.Load(int3(input.position.xy, 0));
+
+	return output;
+}
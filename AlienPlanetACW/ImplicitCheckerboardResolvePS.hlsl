@@ -0,0 +1,207 @@
+//Resolve pass for checkerboard rendering in ImplicitRayModels and ImplicitRayTracedModels, ImplicitCheckerboard::Reconstruct
+//on the CPU with the same rules. Copies the pixels ImplicitRayModelsPS.hlsl marched or ImplicitRayTracedModelsPS.hlsl
+//traced this frame out of their half width textures and fills in the rest from last frame's image, which this pass
+//wrote, or from the marched pixels beside them
+cbuffer ModelViewProjectionConstantBuffer : register(b0)
+{
+	matrix model;
+	matrix view;
+	matrix projection;
+};
+
+cbuffer InverseViewConstantBuffer : register(b1)
+{
+	matrix inverseView;
+}
+
+#include "ImplicitCheckerboard.hlsli"
+
+struct PixelShaderInput
+{
+	float4 position : SV_POSITION;
+	float2 canvasXY : TEXCOORD0;
+};
+
+struct outputPS
+{
+	float4 colour : SV_TARGET0;
+	//How far along the ray the hit was and the object's index, MAX_DIST and NO_OBJECT for a miss
+	float2 hit : SV_TARGET1;
+};
+
+//1 when ImplicitRayModelsPS.hlsl's DEPTH_LIMITS is, so reconstructed hits stop at the rasterized scene like marched ones
+#define DEPTH_LIMITS 0
+
+static float MAX_DIST = 50.0;
+static float EPSILON = 0.0001;
+//How far the point reprojected at a neighbour's depth can be from last frame's hit, as a fraction of its depth
+static float DEPTH_TOLERANCE = 0.05;
+
+Texture2D<float4> marchedColours : register(t0);
+Texture2D<float2> marchedHits : register(t1);
+Texture2D<float4> previousColours : register(t2);
+Texture2D<float2> previousHits : register(t3);
+
+#if DEPTH_LIMITS
+Texture2D<float> depthLimits : register(t4);
+#endif
+
+struct Neighbour
+{
+	float4 colour;
+	float depth;
+	float object;
+};
+
+outputPS main(PixelShaderInput input)
+{
+	outputPS output;
+
+	int2 pixel = int2(input.position.xy);
+
+	if (isMarched(pixel))
+	{
+		output.colour = marchedColours.Load(int3(marchedTexel(pixel), 0));
+		output.hit = marchedHits.Load(int3(marchedTexel(pixel), 0));
+		return output;
+	}
+
+	Neighbour neighbours[4];
+	uint count = 0;
+
+	const int2 offsets[4] = { int2(-1, 0), int2(1, 0), int2(0, -1), int2(0, 1) };
+
+	[unroll]
+	for (int i = 0; i < 4; i++)
+	{
+		int2 neighbourPixel = pixel + offsets[i];
+
+		if (all(neighbourPixel >= 0) && all(neighbourPixel < int2(screenSize)))
+		{
+			float2 hit = marchedHits.Load(int3(marchedTexel(neighbourPixel), 0));
+
+			neighbours[count].colour = marchedColours.Load(int3(marchedTexel(neighbourPixel), 0));
+			neighbours[count].depth = hit.x;
+			neighbours[count].object = hit.y;
+			count++;
+		}
+	}
+
+	//Nearest first, so a surface in front is tried before the one behind it. Misses are at the far distance
+	for (uint j = 1; j < count; j++)
+	{
+		for (uint k = j; k > 0 && neighbours[k].depth < neighbours[k - 1].depth; k--)
+		{
+			Neighbour swap = neighbours[k];
+			neighbours[k] = neighbours[k - 1];
+			neighbours[k - 1] = swap;
+		}
+	}
+
+	output.colour = float4(0.0f, 0.0f, 0.0f, 0.0f);
+	output.hit = float2(MAX_DIST, NO_OBJECT);
+	bool found = false;
+
+	float3 eye = mul(float4(0.0f, 0.0f, 0.0f, 1.0f), inverseView).xyz;
+	float3 direction = normalize(mul(float4(input.canvasXY, -1.0f, 0.0f), inverseView).xyz);
+
+	for (uint n = 0; n < count && historyValid != 0 && !found; n++)
+	{
+		//Last frame's view space, where the camera looks down -z through a canvas a unit in front of it
+		float4 previousPoint = mul(float4(eye + direction * neighbours[n].depth, 1.0f), previousView);
+		float forward = -previousPoint.z;
+
+		if (forward <= 0.0f)
+		{
+			continue;
+		}
+
+		float2 canvas = previousPoint.xy / forward;
+		float2 previousPosition = float2(canvas.x + 1.0f, 1.0f - canvas.y * projection._m11 / projection._m00) * 0.5f * screenSize;
+
+		if (any(previousPosition < 0.0f) || any(previousPosition >= screenSize))
+		{
+			continue;
+		}
+
+		int2 previousPixel = int2(previousPosition);
+		float2 previousHit = previousHits.Load(int3(previousPixel, 0));
+
+		//Only the pixels last frame marched, so no pixel's error is carried on into another frame
+		if (isMarched(previousPixel) || previousHit.y != neighbours[n].object)
+		{
+			continue;
+		}
+
+		//A miss is a miss at any depth
+		if (neighbours[n].object != NO_OBJECT && abs(length(previousPoint.xyz) - previousHit.x) > DEPTH_TOLERANCE * previousHit.x)
+		{
+			continue;
+		}
+
+		float4 minimum = float4(1e30f, 1e30f, 1e30f, 1e30f);
+		float4 maximum = float4(-1e30f, -1e30f, -1e30f, -1e30f);
+
+		for (uint m = 0; m < count; m++)
+		{
+			if (neighbours[m].object == neighbours[n].object)
+			{
+				minimum = min(minimum, neighbours[m].colour);
+				maximum = max(maximum, neighbours[m].colour);
+			}
+		}
+
+		output.colour = clamp(previousColours.Load(int3(previousPixel, 0)), minimum, maximum);
+		output.hit = float2(neighbours[n].depth, neighbours[n].object);
+		found = true;
+	}
+
+	if (!found && count > 0)
+	{
+		//The object most of the neighbours hit, the nearest of those tied
+		uint bestCount = 0;
+		float object = NO_OBJECT;
+
+		for (uint a = 0; a < count; a++)
+		{
+			uint hits = 0;
+
+			for (uint b = 0; b < count; b++)
+			{
+				hits += neighbours[b].object == neighbours[a].object ? 1 : 0;
+			}
+
+			if (hits > bestCount)
+			{
+				bestCount = hits;
+				object = neighbours[a].object;
+			}
+		}
+
+		float4 colour = float4(0.0f, 0.0f, 0.0f, 0.0f);
+		float depth = 0.0f;
+
+		for (uint c = 0; c < count; c++)
+		{
+			if (neighbours[c].object == object)
+			{
+				colour += neighbours[c].colour / bestCount;
+				depth += neighbours[c].depth / bestCount;
+			}
+		}
+
+		output.colour = colour;
+		output.hit = float2(depth, object);
+	}
+
+#if DEPTH_LIMITS
+	//Behind the rasterized scene, which the marched rays would have stopped at
+	if (output.hit.y != NO_OBJECT && output.hit.x > depthLimits.Load(int3(pixel, 0)) - EPSILON)
+	{
+		output.colour = float4(0.0f, 0.0f, 0.0f, 0.0f);
+		output.hit = float2(MAX_DIST, NO_OBJECT);
+	}
+#endif
+
+	return output;
+}
@@ -0,0 +1,17 @@
+//The rasterized scene's depth buffer as distances along the ray marched and ray traced models' rays, ImplicitDepthPyramid
+//on the CPU. Needs ModelViewProjectionConstantBuffer's projection, the one the depth buffer was drawn with
+
+//The distance along the ray through canvasXY, on the canvas a unit in front of the camera, to where depth is in the
+//depth buffer, farDistance where nothing was drawn. A surface further along would fail the depth test
+float depthLimit(float depth, float2 canvasXY, float farDistance)
+{
+	if (depth >= 1.0f)
+	{
+		return farDistance;
+	}
+
+	//The projection's z and w columns back to the distance in front of the camera
+	float viewZ = (projection._m32 - depth * projection._m33) / (depth * projection._m23 - projection._m22);
+
+	return clamp(-viewZ * length(float3(canvasXY, 1.0f)), 0.0f, farDistance);
+}
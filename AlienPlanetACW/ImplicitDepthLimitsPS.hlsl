@@ -0,0 +1,25 @@
+//First depth limits pass for ImplicitRayModels. Turns each pixel of a copy of the depth buffer into how far the pixel's
+//ray can go before it's behind what the terrain, the sea and the other models drew there
+cbuffer ModelViewProjectionConstantBuffer : register(b0)
+{
+	matrix model;
+	matrix view;
+	matrix projection;
+};
+
+struct PixelShaderInput
+{
+	float4 position : SV_POSITION;
+	float2 canvasXY : TEXCOORD0;
+};
+
+#include "ImplicitDepthLimits.hlsli"
+
+static float MAX_DIST = 50.0;
+
+Texture2D<float> rasterDepth : register(t0);
+
+float main(PixelShaderInput input) : SV_TARGET
+{
+	return depthLimit(rasterDepth.Load(int3(input.position.xy, 0)), input.canvasXY, MAX_DIST);
+}
@@ -0,0 +1,139 @@
+#include "pch.h"
+#include "ImplicitDepthPyramid.h"
+#include "ImplicitSceneSdf.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace AlienPlanetACW;
+using namespace DirectX;
+
+ImplicitDepthPyramid::ImplicitDepthPyramid(const std::vector<float>& depths, const unsigned int width, const unsigned int height, const XMMATRIX& projection)
+	: m_width(width), m_height(height)
+{
+	XMFLOAT4X4 projectionMatrix;
+	XMStoreFloat4x4(&projectionMatrix, projection);
+
+	const auto aspectRatio = static_cast<float>(height) / width;
+
+	std::vector<float> limits(width * height);
+
+	for (auto y = 0u; y < height; y++)
+	{
+		for (auto x = 0u; x < width; x++)
+		{
+			//The middle of the pixel, the way ImplicitRayMarcher's rays go through it
+			const auto canvasX = (x + 0.5f) / width * 2.0f - 1.0f;
+			const auto canvasY = (1.0f - (y + 0.5f) / height * 2.0f) * aspectRatio;
+
+			limits[y * width + x] = ToRayDistance(depths[y * width + x], canvasX, canvasY, projectionMatrix);
+		}
+	}
+
+	m_minimums.push_back(limits);
+	m_maximums.push_back(limits);
+
+	auto levelWidth = width;
+	auto levelHeight = height;
+
+	while (levelWidth > 1 || levelHeight > 1)
+	{
+		const auto& minimums = m_minimums.back();
+		const auto& maximums = m_maximums.back();
+
+		//A square on the edge that's only partly over the screen takes what it does cover
+		const auto nextWidth = (levelWidth + 1) / 2;
+		const auto nextHeight = (levelHeight + 1) / 2;
+
+		std::vector<float> nextMinimums(nextWidth * nextHeight, ImplicitSceneSdf::MaxDistance);
+		std::vector<float> nextMaximums(nextWidth * nextHeight, 0.0f);
+
+		for (auto y = 0u; y < levelHeight; y++)
+		{
+			for (auto x = 0u; x < levelWidth; x++)
+			{
+				const auto index = (y / 2) * nextWidth + x / 2;
+
+				nextMinimums[index] = std::min(nextMinimums[index], minimums[y * levelWidth + x]);
+				nextMaximums[index] = std::max(nextMaximums[index], maximums[y * levelWidth + x]);
+			}
+		}
+
+		m_minimums.push_back(std::move(nextMinimums));
+		m_maximums.push_back(std::move(nextMaximums));
+
+		levelWidth = nextWidth;
+		levelHeight = nextHeight;
+	}
+}
+
+float ImplicitDepthPyramid::GetMinimum(const unsigned int left, const unsigned int top, const unsigned int right, const unsigned int bottom) const
+{
+	const auto level = GetLevel(std::max(right - left, bottom - top));
+	const auto levelWidth = (m_width + (1u << level) - 1) >> level;
+
+	auto minimum = ImplicitSceneSdf::MaxDistance;
+
+	for (auto y = top >> level; y <= (bottom - 1) >> level; y++)
+	{
+		for (auto x = left >> level; x <= (right - 1) >> level; x++)
+		{
+			minimum = std::min(minimum, m_minimums[level][y * levelWidth + x]);
+		}
+	}
+
+	return minimum;
+}
+
+float ImplicitDepthPyramid::GetMaximum(const unsigned int left, const unsigned int top, const unsigned int right, const unsigned int bottom) const
+{
+	const auto level = GetLevel(std::max(right - left, bottom - top));
+	const auto levelWidth = (m_width + (1u << level) - 1) >> level;
+
+	auto maximum = 0.0f;
+
+	for (auto y = top >> level; y <= (bottom - 1) >> level; y++)
+	{
+		for (auto x = left >> level; x <= (right - 1) >> level; x++)
+		{
+			maximum = std::max(maximum, m_maximums[level][y * levelWidth + x]);
+		}
+	}
+
+	return maximum;
+}
+
+float ImplicitDepthPyramid::GetCoverage() const
+{
+	const auto& limits = m_minimums[0];
+	const auto covered = std::count_if(limits.begin(), limits.end(), [](const float limit) { return limit < ImplicitSceneSdf::MaxDistance; });
+
+	return limits.empty() ? 0.0f : static_cast<float>(covered) / limits.size();
+}
+
+float ImplicitDepthPyramid::ToRayDistance(const float depth, const float canvasX, const float canvasY, const XMFLOAT4X4& projection)
+{
+	if (depth >= 1.0f)
+	{
+		return ImplicitSceneSdf::MaxDistance;
+	}
+
+	//The projection's z and w columns back to the distance in front of the camera, which the canvas being a unit in
+	//front of it turns into a distance along the ray
+	const auto viewZ = (projection._43 - depth * projection._44) / (depth * projection._34 - projection._33);
+	const auto distance = -viewZ * std::sqrt(canvasX * canvasX + canvasY * canvasY + 1.0f);
+
+	return std::min(std::max(distance, 0.0f), ImplicitSceneSdf::MaxDistance);
+}
+
+unsigned int ImplicitDepthPyramid::GetLevel(const unsigned int size) const
+{
+	auto level = 0u;
+
+	while ((1u << level) < size && level + 1 < GetLevelCount())
+	{
+		level++;
+	}
+
+	return level;
+}
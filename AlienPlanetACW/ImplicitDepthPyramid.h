@@ -0,0 +1,49 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <vector>
+
+namespace AlienPlanetACW
+{
+	//How far each ImplicitRayMarcher ray can go before it's behind what the terrain, the sea and the other rasterized
+	//models drew in its pixel, worked out from their depth buffer, with the nearest and furthest of those distances over
+	//squares of 2, 4, 8 and more pixels. A ray that gets past its pixel's distance would only fail the depth test, so it
+	//can stop there. ImplicitDepthPyramidPS.hlsl builds the furthest distances on the GPU
+	class ImplicitDepthPyramid
+	{
+	public:
+		//depths are the depth buffer row by row, 1 where nothing was drawn, and projection is what drew them. width and
+		//height are the ray marcher's image's, its canvas's rays go through the middle of each pixel
+		ImplicitDepthPyramid(const std::vector<float>& depths, unsigned int width, unsigned int height, const DirectX::XMMATRIX& projection);
+
+		unsigned int GetWidth() const { return m_width; }
+		unsigned int GetHeight() const { return m_height; }
+		//Level 0 is the pixels, each one after has squares twice as wide, down to a single square
+		unsigned int GetLevelCount() const { return static_cast<unsigned int>(m_minimums.size()); }
+
+		//Distance along the pixel's ray to what was drawn there, ImplicitSceneSdf::MaxDistance where nothing was
+		float GetLimit(unsigned int x, unsigned int y) const { return m_minimums[0][y * m_width + x]; }
+		//The nearest and furthest limits of any pixel in the rectangle, right and bottom not included. From the level
+		//whose squares are at least as wide as the rectangle, so no more than four of them are read for a square of
+		//the screen that's aligned to its size, and a little beyond the rectangle can be included
+		float GetMinimum(unsigned int left, unsigned int top, unsigned int right, unsigned int bottom) const;
+		float GetMaximum(unsigned int left, unsigned int top, unsigned int right, unsigned int bottom) const;
+
+		//Fraction of the pixels something was drawn in
+		float GetCoverage() const;
+
+		//The distance along a ray through canvasX and canvasY, on the canvas one unit in front of the camera, to where
+		//the depth buffer's value is. The same as depthLimit in ImplicitDepthLimits.hlsli
+		static float ToRayDistance(float depth, float canvasX, float canvasY, const DirectX::XMFLOAT4X4& projection);
+
+	private:
+		//Smallest level whose squares are at least size pixels across
+		unsigned int GetLevel(unsigned int size) const;
+
+		unsigned int m_width;
+		unsigned int m_height;
+		//Each level's squares row by row
+		std::vector<std::vector<float>> m_minimums;
+		std::vector<std::vector<float>> m_maximums;
+	};
+}
@@ -0,0 +1,20 @@
+//Depth pyramid pass for ImplicitRayModels. Each pixel is a square of the screen twice as wide as the level before's, and
+//gets the furthest of the four depth limits under it, which is as far as a cone over the square has to march
+Texture2D<float> finerLimits : register(t0);
+
+float main(float4 position : SV_POSITION) : SV_TARGET
+{
+	uint width, height;
+	finerLimits.GetDimensions(width, height);
+
+	//The squares over the edge of an odd sized level only take the part that's on the screen
+	int2 finer = int2(position.xy) * 2;
+	int2 last = int2(width, height) - 1;
+
+	float furthest = finerLimits.Load(int3(min(finer, last), 0));
+	furthest = max(furthest, finerLimits.Load(int3(min(finer + int2(1, 0), last), 0)));
+	furthest = max(furthest, finerLimits.Load(int3(min(finer + int2(0, 1), last), 0)));
+	furthest = max(furthest, finerLimits.Load(int3(min(finer + int2(1, 1), last), 0)));
+
+	return furthest;
+}
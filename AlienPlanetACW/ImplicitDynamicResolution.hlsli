@@ -0,0 +1,9 @@
+//Dynamic resolution for ImplicitRayModels. The main pass is drawn into the top left of textures the screen's size, scaled
+//down by ImplicitResolutionController's scale, and ImplicitUpsamplePS.hlsl scales it up to the screen.
+//ImplicitDynamicResolutionConstantBuffer in ShaderStructures.h
+cbuffer dynamicResolutionConstantBuffer : register(b5)
+{
+	//The part of the textures the main pass drew, in pixels
+	float2 renderSize;
+	float2 screenSize;
+}
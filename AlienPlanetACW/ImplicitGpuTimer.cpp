@@ -0,0 +1,112 @@
+#include "pch.h"
+#include "ImplicitGpuTimer.h"
+
+using namespace AlienPlanetACW;
+
+ImplicitGpuTimer::ImplicitGpuTimer(const std::shared_ptr<DX::DeviceResources>& deviceResources) : m_deviceResources(deviceResources), m_frame(0), m_oldestFrame(0)
+{
+	for (auto frame = 0u; frame < Latency; frame++)
+	{
+		m_pending[frame] = false;
+	}
+}
+
+void ImplicitGpuTimer::CreateDeviceDependentResources()
+{
+	const auto device = m_deviceResources->GetD3DDevice();
+
+	const CD3D11_QUERY_DESC disjointDescription(D3D11_QUERY_TIMESTAMP_DISJOINT);
+	const CD3D11_QUERY_DESC timestampDescription(D3D11_QUERY_TIMESTAMP);
+
+	for (auto frame = 0u; frame < Latency; frame++)
+	{
+		DX::ThrowIfFailed(device->CreateQuery(&disjointDescription, &m_disjointQueries[frame]));
+		DX::ThrowIfFailed(device->CreateQuery(&timestampDescription, &m_beginQueries[frame]));
+		DX::ThrowIfFailed(device->CreateQuery(&timestampDescription, &m_endQueries[frame]));
+		m_pending[frame] = false;
+	}
+
+	m_frame = 0;
+	m_oldestFrame = 0;
+}
+
+void ImplicitGpuTimer::ReleaseDeviceDependentResources()
+{
+	for (auto frame = 0u; frame < Latency; frame++)
+	{
+		m_disjointQueries[frame].Reset();
+		m_beginQueries[frame].Reset();
+		m_endQueries[frame].Reset();
+		m_pending[frame] = false;
+	}
+}
+
+void ImplicitGpuTimer::Begin()
+{
+	if (!m_disjointQueries[m_frame])
+	{
+		return;
+	}
+
+	const auto context = m_deviceResources->GetD3DDeviceContext();
+
+	//The GPU is more than Latency frames behind, so this one is given up on rather than waited for
+	if (m_pending[m_frame])
+	{
+		m_pending[m_frame] = false;
+		m_oldestFrame = (m_frame + 1) % Latency;
+	}
+
+	context->Begin(m_disjointQueries[m_frame].Get());
+	context->End(m_beginQueries[m_frame].Get());
+}
+
+void ImplicitGpuTimer::End()
+{
+	if (!m_disjointQueries[m_frame])
+	{
+		return;
+	}
+
+	const auto context = m_deviceResources->GetD3DDeviceContext();
+
+	context->End(m_endQueries[m_frame].Get());
+	context->End(m_disjointQueries[m_frame].Get());
+
+	m_pending[m_frame] = true;
+	m_frame = (m_frame + 1) % Latency;
+}
+
+bool ImplicitGpuTimer::GetMilliseconds(float& milliseconds)
+{
+	const auto context = m_deviceResources->GetD3DDeviceContext();
+	auto found = false;
+
+	//The GPU finishes the frames in order, so the first one that isn't ready means none after it are either
+	while (m_pending[m_oldestFrame])
+	{
+		D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjoint;
+
+		if (context->GetData(m_disjointQueries[m_oldestFrame].Get(), &disjoint, sizeof(disjoint), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+		{
+			break;
+		}
+
+		UINT64 begin;
+		UINT64 end;
+
+		//Done with the disjoint query, the timestamps inside it are too
+		if (!disjoint.Disjoint &&
+			context->GetData(m_beginQueries[m_oldestFrame].Get(), &begin, sizeof(begin), D3D11_ASYNC_GETDATA_DONOTFLUSH) == S_OK &&
+			context->GetData(m_endQueries[m_oldestFrame].Get(), &end, sizeof(end), D3D11_ASYNC_GETDATA_DONOTFLUSH) == S_OK)
+		{
+			milliseconds = static_cast<float>(static_cast<double>(end - begin) * 1000.0 / disjoint.Frequency);
+			found = true;
+		}
+
+		m_pending[m_oldestFrame] = false;
+		m_oldestFrame = (m_oldestFrame + 1) % Latency;
+	}
+
+	return found;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "..\Common\DeviceResources.h"
+
+namespace AlienPlanetACW
+{
+	//How long the GPU spends on a pass, from timestamp queries around it. Each frame's queries are read back Latency
+	//frames later, once the GPU has got to them, so waiting on them never stalls the CPU
+	class ImplicitGpuTimer
+	{
+	public:
+		//Frames of queries in flight. A frame still not finished when its queries come round again is dropped
+		static const unsigned int Latency = 4;
+
+		ImplicitGpuTimer(const std::shared_ptr<DX::DeviceResources>& deviceResources);
+		void CreateDeviceDependentResources();
+		void ReleaseDeviceDependentResources();
+
+		//Around the pass's draws, once a frame
+		void Begin();
+		void End();
+
+		//The newest frame the GPU has finished since the last call, oldest first up to it. False when none has, or when
+		//the clock was disjoint over all of them, as when the GPU changed its frequency or the device was reset
+		bool GetMilliseconds(float& milliseconds);
+
+	private:
+		std::shared_ptr<DX::DeviceResources> m_deviceResources;
+
+		Microsoft::WRL::ComPtr<ID3D11Query>	m_disjointQueries[Latency];
+		Microsoft::WRL::ComPtr<ID3D11Query>	m_beginQueries[Latency];
+		Microsoft::WRL::ComPtr<ID3D11Query>	m_endQueries[Latency];
+		//Which frames' queries have been issued and not read back
+		bool								m_pending[Latency];
+		//The queries the next Begin issues, and the oldest ones GetMilliseconds hasn't read
+		unsigned int						m_frame;
+		unsigned int						m_oldestFrame;
+	};
+}
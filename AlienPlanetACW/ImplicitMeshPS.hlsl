@@ -0,0 +1,68 @@
+cbuffer CameraConstantBuffer : register(b1)
+{
+	float3 cameraPosition;
+	float padding;
+}
+
+struct PixelShaderInput
+{
+	float4 positionH : SV_POSITION;
+	float3 positionW : POSITION;
+	float3 normal : NORMAL;
+	float3 colour : COLOR0;
+};
+
+#define NUMBER_OF_LIGHTS 1
+
+struct Light
+{
+	float4 ambientColour;
+	float4 diffuseColour;
+	float4 specularColour;
+	float3 lightPosition;
+	float specularPower;
+};
+
+//The light, lighting and fog are ImplicitRayModelsPS.hlsl's, so an object looks the same drawn from its mesh as marched
+static Light lights[NUMBER_OF_LIGHTS] = {
+	//LightOne
+	{0.2, 0.2, 0.2, 1.0, 0.4, 0.4, 0.4, 1.0, 0.4, 0.4, 0.4, 1.0, 0.0, 3.0, 0.0, 20}
+};
+
+float4 PhongIllumination(float surfacePoint, float3 normal, float shininess, float3 rayDirection, float4 diffuseColour)
+{
+	float4 totalAmbient = float4(0.0f, 0.0f, 0.0f, 0.0f);
+	float4 totalDiffuse = float4(0.0f, 0.0f, 0.0f, 0.0f);
+	float4 totalSpecular = float4(0.0f, 0.0f, 0.0f, 0.0f);
+
+	for (int i = 0; i < NUMBER_OF_LIGHTS; i++)
+	{
+		totalAmbient += lights[i].ambientColour * diffuseColour;
+
+		float3 lightDirection = normalize(lights[i].lightPosition - surfacePoint);
+		float nDotL = dot(normal, lightDirection);
+		float3 reflection = normalize(reflect(-lightDirection, normal));
+		float rDotV = max(0.0f, dot(reflection, -rayDirection));
+
+		totalDiffuse += saturate(lights[i].diffuseColour * nDotL * diffuseColour);
+
+		if (nDotL > 0.0f)
+		{
+			float4 specularIntensity = float4(1.0, 1.0, 1.0, 1.0);
+			totalSpecular += lights[i].specularColour * pow(pow(rDotV, lights[i].specularPower), shininess) * specularIntensity;
+		}
+	}
+
+	return totalAmbient + totalDiffuse + totalSpecular;
+}
+
+float4 main(PixelShaderInput input) : SV_TARGET
+{
+	float3 toSurface = input.positionW - cameraPosition;
+	float distance = length(toSurface);
+	float3 rayDirection = toSurface / distance;
+
+	float4 colour = PhongIllumination(input.positionW, normalize(input.normal), 40.0f, rayDirection, float4(input.colour, 1.0f));
+
+	return float4(lerp(colour.xyz, float3(1.0f, 0.97255f, 0.86275f), 1.0 - exp(-0.0005*distance*distance*distance)), 1.0f);
+}
@@ -0,0 +1,40 @@
+// A constant buffer that stores the three basic column-major matrices for composing geometry.
+cbuffer ModelViewProjectionConstantBuffer : register(b0)
+{
+	matrix model;
+	matrix view;
+	matrix projection;
+};
+
+// Per-vertex data used as input to the vertex shader.
+struct VertexShaderInput
+{
+	float3 position : POSITION;
+	float2 tex : TEXCOORD0;
+	float3 normal : NORMAL;
+	float3 tangent : TANGENT;
+	float3 binormal : BINORMAL;
+};
+
+struct PixelShaderInput
+{
+	float4 positionH : SV_POSITION;
+	float3 positionW : POSITION;
+	float3 normal : NORMAL;
+	float3 colour : COLOR0;
+};
+
+//Meshes of the implicit objects from ImplicitSceneMesher, which keeps the object's colour in the tangent
+PixelShaderInput main(VertexShaderInput input)
+{
+	PixelShaderInput output;
+
+	output.positionW = mul(float4(input.position, 1.0f), model).xyz;
+	output.normal = normalize(mul(input.normal, (float3x3)model));
+	output.colour = input.tangent;
+
+	output.positionH = mul(float4(output.positionW, 1.0f), view);
+	output.positionH = mul(output.positionH, projection);
+
+	return output;
+}
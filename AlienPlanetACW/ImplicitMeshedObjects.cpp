@@ -0,0 +1,323 @@
+#include "pch.h"
+#include "ImplicitMeshedObjects.h"
+
+using namespace AlienPlanetACW;
+
+const unsigned int ImplicitMeshedObjects::Objects[ObjectCount] = { 6 };
+const float ImplicitMeshedObjects::PixelTolerance = 1.0f;
+
+ImplicitMeshedObjects::ImplicitMeshedObjects(const std::shared_ptr<DX::DeviceResources>& deviceResources, const std::shared_ptr<ResourceManager>& resourceManager)
+	: m_deviceResources(deviceResources), m_resourceManager(resourceManager), m_pixelAngle(0.0f), m_loadingComplete(false)
+{
+	for (auto object = 0; object < ObjectCount; object++)
+	{
+		m_currentLods[object] = ImplicitSceneMesher::RayMarched;
+	}
+
+	CreateDeviceDependentResources();
+}
+
+void ImplicitMeshedObjects::CreateDeviceDependentResources()
+{
+	// Load shaders asynchronously.
+	auto loadVSTask = DX::ReadDataAsync(L"ImplicitMeshVS.cso");
+	auto loadPSTask = DX::ReadDataAsync(L"ImplicitMeshPS.cso");
+
+	auto createVSTask = loadVSTask.then([this](const std::vector<byte>& fileData) {
+		DX::ThrowIfFailed(
+			m_deviceResources->GetD3DDevice()->CreateVertexShader(
+				&fileData[0],
+				fileData.size(),
+				nullptr,
+				&m_vertexShader
+			)
+		);
+
+		static const D3D11_INPUT_ELEMENT_DESC vertexDesc[] =
+		{
+			{"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0},
+			{"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
+			{"NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
+			{"TANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
+			{"BINORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0}
+		};
+
+		DX::ThrowIfFailed(
+			m_deviceResources->GetD3DDevice()->CreateInputLayout(
+				vertexDesc,
+				ARRAYSIZE(vertexDesc),
+				&fileData[0],
+				fileData.size(),
+				&m_inputLayout
+			)
+		);
+	});
+
+	auto createPSTask = loadPSTask.then([this](const std::vector<byte>& fileData) {
+		DX::ThrowIfFailed(
+			m_deviceResources->GetD3DDevice()->CreatePixelShader(
+				&fileData[0],
+				fileData.size(),
+				nullptr,
+				&m_pixelShader
+			)
+		);
+
+		CD3D11_BUFFER_DESC MVPBufferDescription(sizeof(ModelViewProjectionConstantBuffer), D3D11_BIND_CONSTANT_BUFFER);
+
+		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateBuffer(&MVPBufferDescription, nullptr, &m_MVPBuffer));
+
+		CD3D11_BUFFER_DESC cameraBufferDescription(sizeof(CameraPositionConstantBuffer), D3D11_BIND_CONSTANT_BUFFER);
+
+		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateBuffer(&cameraBufferDescription, nullptr, &m_cameraBuffer));
+	});
+
+	auto createMeshesTask = (createPSTask && createVSTask).then([this]() {
+
+		//The objects don't move, so they're meshed once at every LOD
+		static const char* const lodNames[ObjectCount][LodCount] = { { "SierpinskiTetrahedronLOD0", "SierpinskiTetrahedronLOD1", "SierpinskiTetrahedronLOD2", "SierpinskiTetrahedronLOD3" } };
+
+		const auto parameters = ImplicitSceneParameters::FromTime(0.0f);
+
+		for (auto object = 0; object < ObjectCount; object++)
+		{
+			const ImplicitSceneMesher mesher(parameters, Objects[object]);
+
+			m_lods[object] = mesher.GenerateLods(GetLodResolutions());
+			m_bounds[object] = mesher.GetBounds();
+
+			for (auto i = 0; i < LodCount; i++)
+			{
+				auto& lod = m_lods[object][i];
+
+				m_resourceManager->CreateModel(m_deviceResources->GetD3DDevice(), lodNames[object][i], lod.vertices, lod.indices);
+				m_resourceManager->GetModel(m_deviceResources->GetD3DDevice(), lodNames[object][i], m_lodVertexBuffers[object][i], m_lodIndexBuffers[object][i]);
+				m_lodIndexCounts[object][i] = m_resourceManager->GetIndexCount(lodNames[object][i]);
+
+				std::vector<VertexPositionTexcoordNormalTangentBinormal>().swap(lod.vertices);
+				std::vector<unsigned long>().swap(lod.indices);
+			}
+		}
+	});
+
+	createMeshesTask.then([this]() {
+		m_loadingComplete = true;
+	});
+}
+
+void ImplicitMeshedObjects::SetViewProjectionMatrixConstantBuffer(DirectX::XMMATRIX& view, DirectX::XMMATRIX& projection)
+{
+	DirectX::XMStoreFloat4x4(&m_MVPBufferData.view, DirectX::XMMatrixTranspose(view));
+
+	DirectX::XMStoreFloat4x4(&m_MVPBufferData.projection, DirectX::XMMatrixTranspose(projection));
+
+	//The projection's y scale is one over the tangent of half the vertical field of view, wherever the screen's
+	//orientation has rotated it to
+	DirectX::XMFLOAT4X4 projectionMatrix;
+	DirectX::XMStoreFloat4x4(&projectionMatrix, projection);
+
+	const auto yScale = sqrt(projectionMatrix._21 * projectionMatrix._21 + projectionMatrix._22 * projectionMatrix._22);
+	const auto viewportHeight = m_deviceResources->GetScreenViewport().Height;
+
+	m_pixelAngle = yScale > 0.0f && viewportHeight > 0.0f ? 2.0f / (yScale * viewportHeight) : 0.0f;
+}
+
+void ImplicitMeshedObjects::SetCameraPositionConstantBuffer(DirectX::XMFLOAT3& cameraPosition)
+{
+	m_cameraBufferData.position = cameraPosition;
+
+	if (!m_loadingComplete)
+	{
+		return;
+	}
+
+	//Pick each object's LOD from how far the camera is from its box, so no part of the mesh is nearer than that
+	for (auto object = 0; object < ObjectCount; object++)
+	{
+		const auto& bounds = m_bounds[object];
+
+		const auto dx = std::max(std::max(bounds.minimum.x - cameraPosition.x, cameraPosition.x - bounds.maximum.x), 0.0f);
+		const auto dy = std::max(std::max(bounds.minimum.y - cameraPosition.y, cameraPosition.y - bounds.maximum.y), 0.0f);
+		const auto dz = std::max(std::max(bounds.minimum.z - cameraPosition.z, cameraPosition.z - bounds.maximum.z), 0.0f);
+		const auto distance = sqrt(dx * dx + dy * dy + dz * dz);
+
+		m_currentLods[object] = ImplicitSceneMesher::SelectLod(m_lods[object], distance, m_pixelAngle, PixelTolerance);
+	}
+}
+
+unsigned int ImplicitMeshedObjects::GetMeshedObjects() const
+{
+	auto meshedObjects = 0u;
+
+	if (!m_loadingComplete)
+	{
+		return meshedObjects;
+	}
+
+	for (auto object = 0; object < ObjectCount; object++)
+	{
+		if (m_currentLods[object] != ImplicitSceneMesher::RayMarched)
+		{
+			meshedObjects |= 1u << Objects[object];
+		}
+	}
+
+	return meshedObjects;
+}
+
+std::vector<unsigned int> ImplicitMeshedObjects::GetLodResolutions()
+{
+	return { 256, 128, 64, 32 };
+}
+
+void ImplicitMeshedObjects::Update(DX::StepTimer const& timer)
+{
+	//The meshes are in the scene's space already
+	DirectX::XMStoreFloat4x4(&m_MVPBufferData.model, DirectX::XMMatrixTranspose(DirectX::XMMatrixIdentity()));
+}
+
+void ImplicitMeshedObjects::Render()
+{
+	// Loading is asynchronous. Only draw geometry after it's loaded.
+	if (!m_loadingComplete || GetMeshedObjects() == 0)
+	{
+		return;
+	}
+
+	auto context = m_deviceResources->GetD3DDeviceContext();
+
+	// Prepare constant buffers to send it to the graphics device.
+	context->UpdateSubresource1(
+		m_MVPBuffer.Get(),
+		0,
+		NULL,
+		&m_MVPBufferData,
+		0,
+		0,
+		0
+	);
+
+	context->UpdateSubresource1(
+		m_cameraBuffer.Get(),
+		0,
+		NULL,
+		&m_cameraBufferData,
+		0,
+		0,
+		0
+	);
+
+	context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+	context->IASetInputLayout(m_inputLayout.Get());
+
+	// Attach our vertex shader.
+	context->VSSetShader(
+		m_vertexShader.Get(),
+		nullptr,
+		0
+	);
+
+	// Send the constant buffer to the graphics device.
+	context->VSSetConstantBuffers1(
+		0,
+		1,
+		m_MVPBuffer.GetAddressOf(),
+		nullptr,
+		nullptr
+	);
+
+	context->HSSetShader(
+		nullptr,
+		nullptr,
+		0
+	);
+
+	context->DSSetShader(
+		nullptr,
+		nullptr,
+		0
+	);
+
+	context->GSSetShader(
+		nullptr,
+		nullptr,
+		0
+	);
+
+	//The fractals' meshes have sheets a cell thick, seen from both sides
+	D3D11_RASTERIZER_DESC rasterizerDesc = CD3D11_RASTERIZER_DESC(D3D11_DEFAULT);
+
+	rasterizerDesc.CullMode = D3D11_CULL_NONE;
+
+	m_deviceResources->GetD3DDevice()->CreateRasterizerState(&rasterizerDesc, m_rasterizerState.GetAddressOf());
+	context->RSSetState(m_rasterizerState.Get());
+
+	context->PSSetConstantBuffers1(
+		1,
+		1,
+		m_cameraBuffer.GetAddressOf(),
+		nullptr,
+		nullptr
+	);
+
+	// Attach our pixel shader.
+	context->PSSetShader(
+		m_pixelShader.Get(),
+		nullptr,
+		0
+	);
+
+	// Each vertex is one instance of the VertexPositionTexcoordNormalTangentBinormal struct.
+	UINT stride = sizeof(AlienPlanetACW::VertexPositionTexcoordNormalTangentBinormal);
+	UINT offset = 0;
+
+	for (auto object = 0; object < ObjectCount; object++)
+	{
+		const auto lod = m_currentLods[object];
+
+		if (lod == ImplicitSceneMesher::RayMarched)
+		{
+			continue;
+		}
+
+		context->IASetVertexBuffers(
+			0,
+			1,
+			m_lodVertexBuffers[object][lod].GetAddressOf(),
+			&stride,
+			&offset
+		);
+
+		context->IASetIndexBuffer(m_lodIndexBuffers[object][lod].Get(), DXGI_FORMAT_R32_UINT, 0);
+
+		// Draw the objects.
+		context->DrawIndexed(
+			m_lodIndexCounts[object][lod],
+			0,
+			0
+		);
+	}
+}
+
+void ImplicitMeshedObjects::ReleaseDeviceDependentResources()
+{
+	m_loadingComplete = false;
+	m_vertexShader.Reset();
+	m_inputLayout.Reset();
+	m_pixelShader.Reset();
+	m_MVPBuffer.Reset();
+	m_cameraBuffer.Reset();
+	m_rasterizerState.Reset();
+
+	for (auto object = 0; object < ObjectCount; object++)
+	{
+		m_currentLods[object] = ImplicitSceneMesher::RayMarched;
+
+		for (auto i = 0; i < LodCount; i++)
+		{
+			m_lodVertexBuffers[object][i].Reset();
+			m_lodIndexBuffers[object][i].Reset();
+		}
+	}
+}
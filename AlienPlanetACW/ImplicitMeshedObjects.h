@@ -0,0 +1,75 @@
+#pragma once
+
+#include "..\Common\DeviceResources.h"
+#include "..\Common\DirectXHelper.h"
+#include "..\Content\ShaderStructures.h"
+#include "..\Common\StepTimer.h"
+
+#include "ResourceManager.h"
+#include "ImplicitSceneMesher.h"
+#include <DirectXMath.h>
+
+namespace AlienPlanetACW
+{
+	//The static implicit objects far enough away to be drawn from ImplicitSceneMesher's meshes rather than marched.
+	//Each frame an object gets the coarsest mesh that's out by less than a pixel from where the camera is, or is left to
+	//ImplicitRayModels when it's too close for any of them
+	class ImplicitMeshedObjects
+	{
+	public:
+		ImplicitMeshedObjects(const std::shared_ptr<DX::DeviceResources>& deviceResources, const std::shared_ptr<ResourceManager>& resourceManager);
+		void CreateDeviceDependentResources();
+		void SetViewProjectionMatrixConstantBuffer(DirectX::XMMATRIX& view, DirectX::XMMATRIX& projection);
+		void SetCameraPositionConstantBuffer(DirectX::XMFLOAT3& cameraPosition);
+		void ReleaseDeviceDependentResources();
+
+		void Update(DX::StepTimer const& timer);
+		void Render();
+
+		//Bit n set for each object n drawn from a mesh this frame, for ImplicitRayModels::SetMeshedObjects
+		unsigned int GetMeshedObjects() const;
+
+		//Cells along the longest side of the meshes, finest first
+		static std::vector<unsigned int> GetLodResolutions();
+
+	private:
+		//The Sierpinski tetrahedron. The Mandelbulb is animated and the gallery's objects are too small to be worth it. The
+		//object functions in ImplicitRayModelsPS.hlsl have to check meshedObjects for each of these
+		static const int ObjectCount = 1;
+		static const unsigned int Objects[ObjectCount];
+		static const int LodCount = 4;
+
+		//How many pixels a mesh can be out by
+		static const float PixelTolerance;
+
+		std::shared_ptr<DX::DeviceResources> m_deviceResources;
+		std::shared_ptr<ResourceManager> m_resourceManager;
+
+		Microsoft::WRL::ComPtr<ID3D11InputLayout>	m_inputLayout;
+
+		Microsoft::WRL::ComPtr<ID3D11VertexShader>	m_vertexShader;
+		Microsoft::WRL::ComPtr<ID3D11PixelShader>	m_pixelShader;
+
+		Microsoft::WRL::ComPtr<ID3D11Buffer>		m_lodVertexBuffers[ObjectCount][LodCount];
+		Microsoft::WRL::ComPtr<ID3D11Buffer>		m_lodIndexBuffers[ObjectCount][LodCount];
+		uint32										m_lodIndexCounts[ObjectCount][LodCount];
+
+		//What SelectLod needs of the meshes, their vertices and indices are let go once they're uploaded
+		std::vector<ImplicitMeshLod>				m_lods[ObjectCount];
+		ImplicitSceneBounds							m_bounds[ObjectCount];
+
+		Microsoft::WRL::ComPtr<ID3D11RasterizerState> m_rasterizerState;
+
+		Microsoft::WRL::ComPtr<ID3D11Buffer>		m_MVPBuffer;
+		Microsoft::WRL::ComPtr<ID3D11Buffer>		m_cameraBuffer;
+
+		ModelViewProjectionConstantBuffer			m_MVPBufferData;
+		CameraPositionConstantBuffer				m_cameraBufferData;
+
+		//Radians a pixel is across at the middle of the screen
+		float	m_pixelAngle;
+		//ImplicitSceneMesher::RayMarched for the objects left to ImplicitRayModels
+		int		m_currentLods[ObjectCount];
+		bool	m_loadingComplete;
+	};
+}
@@ -0,0 +1,61 @@
+//Cone pass for ImplicitRayModels, MarchCone in ImplicitRayMarcher.cpp on the GPU. Each pixel of the pass is a square of
+//the screen, and marches the cone around the rays through it from where its parent square's cone stopped. What it
+//writes is how far all those rays can go before one could hit anything
+#define CONE_PASS
+#include "ImplicitRayModelsPS.hlsl"
+
+//The level before at half this one's resolution, unbound for the first level so it reads zero
+Texture2D<float> parentSeeds : register(t1);
+
+#if DEPTH_LIMITS
+//The furthest any ray through each of this level's squares has to go, from ImplicitDepthPyramidPS.hlsl
+Texture2D<float> squareLimits : register(t4);
+#endif
+
+float main(PixelShaderInput input) : SV_TARGET
+{
+	//The viewport is the screen in squares, so canvasXY moves a square from one pixel to the next
+	float2 squareSize = float2(ddx(input.canvasXY.x), ddy(input.canvasXY.y));
+
+	float3 origin = mul(float4(0.0f, 0.0f, 0.0f, 1.0f), inverseView).xyz;
+	float3 axis = normalize(mul(float4(input.canvasXY, -MIN_DIST, 0.0f), inverseView).xyz);
+
+	//A ray in direction d is no further than depth * length(d - axis) from the same depth down the axis, and that's
+	//widest at the corners
+	float spread = 0.0f;
+
+	[unroll]
+	for (int corner = 0; corner < 4; corner++)
+	{
+		float2 cornerXY = input.canvasXY + squareSize * (float2(corner & 1, corner >> 1) - 0.5f);
+		spread = max(spread, length(normalize(mul(float4(cornerXY, -MIN_DIST, 0.0f), inverseView).xyz) - axis));
+	}
+
+	float start = max(parentSeeds.Load(int3(input.position.xy / 2, 0)), EPSILON);
+	float depth = start;
+	float end = MAX_DIST;
+
+#if DEPTH_LIMITS
+	//Past here every ray under the cone is behind the rasterized scene, and none of them are marched
+	end = min(squareLimits.Load(int3(input.position.xy, 0)), MAX_DIST);
+#endif
+
+	for (int i = 0; i < MAX_MARCHING_STEPS && depth < end; i++)
+	{
+		float sceneDistance = SCENE_SDF(origin + depth * axis).x;
+		float radius = depth * spread;
+
+		//Everything passed stays EPSILON clear of the surfaces. Once the cone is within its own width of something the
+		//steps get short, and the next level or the rays take over
+		float advance = sceneDistance - radius - EPSILON;
+
+		if (advance < radius)
+		{
+			return max(depth + max(advance, 0.0f), start);
+		}
+
+		depth += advance;
+	}
+
+	return min(depth, end);
+}
@@ -0,0 +1,1327 @@
+#include "pch.h"
+#include "ImplicitRayMarcher.h"
+
+#include <algorithm>
+#include <bitset>
+#include <chrono>
+#include <cmath>
+#include <ppl.h>
+#include <type_traits>
+
+using namespace AlienPlanetACW;
+using namespace AlienPlanetACW::Sdf;
+using namespace DirectX;
+
+namespace
+{
+	//What the pixel shader gets from its constant buffers and the vertex shader
+	struct Frame
+	{
+		ImplicitSceneParameters parameters;
+		//Every object's box at this time
+		const std::vector<ImplicitSceneBounds>* objectBounds;
+		//Null to evaluate every object
+		const ImplicitSceneHierarchy* hierarchy;
+		//Null to evaluate the static objects too
+		const ImplicitSceneBricks* bricks;
+		//Null to evaluate every object in every tile
+		const ImplicitSceneIntervals* intervals;
+		//Null to give every tile every object
+		const ImplicitSceneTileBins* bins;
+		float standInDistance;
+		//Each object's distance is multiplied by its scale, one over ImplicitSceneSdf::GetObjectLipschitz, and otherwise one
+		bool lipschitzScaling;
+		float objectScales[ImplicitSceneSdf::ObjectCount];
+		float overRelaxation;
+		//How wide a pixel is one unit along a ray, so a sample's cone is this times its depth. 0 when coneWidthPixels is
+		float pixelCone;
+		ImplicitRayMarcherNormals normals;
+		//Null when nobody asked for the step counts
+		ImplicitRayMarcherTrace* trace;
+		//Null without a temporal cache. The cache gets this frame's hits, and the depths reprojected from it, also null
+		//when there was nothing to reproject, are where the rays can start from
+		ImplicitRayMarcherCache* cache;
+		const float* reprojectedDepths;
+		//Null to march every ray to MaxDistance
+		const ImplicitDepthPyramid* depthLimits;
+		//0 to march every pixel
+		unsigned int adaptiveBlockSize;
+		float adaptiveDepthRatio;
+		//Only march ImplicitCheckerboard::IsMarched's pixels for checkerboardFrame
+		bool checkerboard;
+		unsigned int checkerboardFrame;
+		Vec3<float> eye;
+		//Rows of the inverse view, a direction in view space goes to world space as x * right + y * up + z * back
+		Vec3<float> right;
+		Vec3<float> up;
+		Vec3<float> back;
+		//projection._m00 / projection._m11 in the vertex shader, height over width
+		float aspectRatio;
+		unsigned int width;
+		unsigned int height;
+		Vec3<float> background;
+	};
+
+	//How a packet of rays covers the screen, one pixel for float and four by two for Float8
+	template <typename T> struct Packet;
+
+	template <>
+	struct Packet<float>
+	{
+		static const unsigned int Columns = 1;
+		static const unsigned int Rows = 1;
+
+		static float Load(const float* const values) { return values[0]; }
+		static void Store(const float value, float* const values) { values[0] = value; }
+		static bool FromBits(const unsigned int bits) { return (bits & 1) != 0; }
+	};
+
+	template <>
+	struct Packet<Float8>
+	{
+		static const unsigned int Columns = 4;
+		static const unsigned int Rows = 2;
+
+		static Float8 Load(const float* const values) { return Float8::Load(values); }
+		static void Store(const Float8& value, float* const values) { value.Store(values); }
+		static Mask8 FromBits(const unsigned int bits) { return MaskFromBits(bits); }
+	};
+
+	struct TileStats
+	{
+		unsigned long long rays;
+		unsigned long long steps;
+		unsigned long long coneSteps;
+		unsigned long long hits;
+		unsigned long long reprojectedRays;
+		unsigned long long rejectedRays;
+		unsigned long long occludedRays;
+		unsigned long long skippedRays;
+		unsigned long long interpolatedPixels;
+		SdfEvaluationCount evaluations;
+		SdfPruningCount pruning;
+	};
+
+	//The pixels a packet's lanes march, validBits set for the lanes that have one
+	struct PacketPixels
+	{
+		unsigned int x[8];
+		unsigned int y[8];
+		unsigned int validBits;
+	};
+
+	//What a lane's ray found, for adaptive subdivision to compare and interpolate
+	struct RayResult
+	{
+		bool hit;
+		float depth;
+		unsigned char object;
+		XMFLOAT3 colour;
+	};
+
+	//Where the cone passes left each ray of a tile, one depth per square of cellSize pixels
+	struct TileSeeds
+	{
+		//Null to start every ray at the camera
+		const float* depths;
+		unsigned int left;
+		unsigned int top;
+		unsigned int cellSize;
+		unsigned int cells;
+
+		float Get(const unsigned int x, const unsigned int y) const
+		{
+			return depths != nullptr ? depths[(y - top) / cellSize * cells + (x - left) / cellSize] : ImplicitSceneSdf::Epsilon;
+		}
+	};
+
+	//One object, from the bricks when it's baked in them. The bricks are baked at full detail, so they ignore the cone
+	template <typename T>
+	Sample<T> EvaluateFrameObject(const Frame& frame, const unsigned int object, const Vec3<T>& p, const T& coneWidth)
+	{
+		return frame.bricks != nullptr && frame.bricks->IsBaked(object) ? frame.bricks->EvaluateObject(object, p) : ImplicitSceneSdf::EvaluateObject(frame.parameters, object, p, coneWidth);
+	}
+
+	//The bricks only hold distances, and at a hit they'd hand over to the object anyway
+	template <typename T>
+	Sample<Dual<T>> EvaluateFrameObject(const Frame& frame, const unsigned int object, const Vec3<Dual<T>>& p, const Dual<T>& coneWidth)
+	{
+		return ImplicitSceneSdf::EvaluateObject(frame.parameters, object, p, coneWidth);
+	}
+
+	//sceneSDF as the settings ask for it, the hierarchy or every object, with or without the bricks, the Lipschitz
+	//scaling and the cone. coneWidth is the depth times frame.pixelCone. objectMask is the objects that can be nearest
+	//where p is, from TilePrograms, and the others are left out
+	template <typename T>
+	Sample<T> EvaluateScene(const Frame& frame, const Vec3<T>& p, const T& coneWidth, const unsigned int countBits, SdfEvaluationCount& count, const unsigned int objectMask)
+	{
+		if (objectMask == ImplicitSceneIntervals::AllObjects && frame.bricks == nullptr && !frame.lipschitzScaling && frame.pixelCone <= 0.0f)
+		{
+			return frame.hierarchy == nullptr
+				? ImplicitSceneHierarchy::EvaluateFlat(frame.parameters, p, countBits, count)
+				: frame.hierarchy->Evaluate(frame.parameters, p, countBits, count, frame.standInDistance);
+		}
+
+		const auto evaluateObject = [&frame, &coneWidth](const unsigned int object, const Vec3<T>& samplePoint)
+		{
+			auto sample = EvaluateFrameObject(frame, object, samplePoint, coneWidth);
+
+			if (frame.lipschitzScaling)
+			{
+				sample.distance = sample.distance * T(frame.objectScales[object]);
+			}
+
+			return sample;
+		};
+
+		return frame.hierarchy == nullptr
+			? ImplicitSceneHierarchy::EvaluateFlatWith(evaluateObject, p, countBits, count, objectMask)
+			: frame.hierarchy->EvaluateWith(evaluateObject, p, countBits, count, frame.standInDistance, objectMask);
+	}
+
+	//The cone is the hit's, so the normal is the same shape's the ray stopped on
+	template <typename T>
+	Vec3<T> FindNormal(const Frame& frame, const Vec3<T>& p, const T& coneWidth, const unsigned int countBits, SdfEvaluationCount& count, const unsigned int objectMask)
+	{
+		const auto evaluate = [&](const auto& q)
+		{
+			typedef typename std::decay<decltype(q.x)>::type U;
+			return EvaluateScene(frame, q, U(coneWidth), countBits, count, objectMask);
+		};
+
+		switch (frame.normals)
+		{
+		case ImplicitRayMarcherNormals::Tetrahedron:
+			return ImplicitSceneSdf::EstimateNormalTetrahedron(evaluate, p);
+		case ImplicitRayMarcherNormals::Dual:
+			return ImplicitSceneSdf::GradientNormal(evaluate, p);
+		default:
+			return ImplicitSceneSdf::EstimateNormal(evaluate, p);
+		}
+	}
+
+	//The object whose surface p is on, the one sceneSDF's union takes the colour from, as a float per lane. The
+	//hierarchy only evaluates the objects whose boxes are closer than the closest surface so far, and the ones it skips
+	//for a lane are further away anyway
+	template <typename T>
+	T FindClosestObject(const Frame& frame, const Vec3<T>& p, const T& coneWidth, const unsigned int countBits, SdfEvaluationCount& count)
+	{
+		auto closestDistance = T(1e10f);
+		auto closestObject = T(static_cast<float>(ImplicitRayMarcherCache::NoObject));
+
+		const auto evaluateObject = [&](const unsigned int object, const Vec3<T>& samplePoint)
+		{
+			const auto sample = EvaluateFrameObject(frame, object, samplePoint, coneWidth);
+			const auto closer = sample.distance < closestDistance;
+
+			closestDistance = Select(closer, sample.distance, closestDistance);
+			closestObject = Select(closer, T(static_cast<float>(object)), closestObject);
+
+			return sample;
+		};
+
+		if (frame.hierarchy == nullptr)
+		{
+			ImplicitSceneHierarchy::EvaluateFlatWith(evaluateObject, p, countBits, count);
+		}
+		else
+		{
+			frame.hierarchy->EvaluateWith(evaluateObject, p, countBits, count);
+		}
+
+		return closestObject;
+	}
+
+	//Through a point on the screen in pixels, where pixel centres are at a half. The quad spans the canvas from -1 to 1
+	//in x
+	Vec3<float> GetRayDirection(const Frame& frame, const float x, const float y)
+	{
+		const auto canvasX = x / frame.width * 2.0f - 1.0f;
+		const auto canvasY = (1.0f - y / frame.height * 2.0f) * frame.aspectRatio;
+
+		return Normalize(frame.right * canvasX + frame.up * canvasY - frame.back);
+	}
+
+	//The objects that can be nearest in each of ImplicitSceneIntervals' depth slabs through a tile, the tile's per slab
+	//scenes. A slab is pruned the first time the tile samples in it, so the ones behind the surfaces never are, and the
+	//tiles prune in parallel as they march. A slab's region is a ball around the middle of the tile's axis in it, out to
+	//the widest corner at its far end the way MarchCone's cone is, and a little further for the normals' samples. Only
+	//tileObjects, the tile's objects from its bin, are ever kept
+	class TilePrograms
+	{
+	public:
+		TilePrograms(const Frame& frame, const unsigned int left, const unsigned int top, const unsigned int right, const unsigned int bottom, const unsigned int tileObjects)
+			: m_frame(frame), m_spread(0.0f), m_tileObjects(tileObjects), m_masks(frame.intervals != nullptr ? ImplicitSceneIntervals::SlabCount : 0, Unpruned), m_lastFirst(1), m_lastLast(0), m_lastMask(0)
+		{
+			m_axis = GetRayDirection(frame, (left + right) * 0.5f, (top + bottom) * 0.5f);
+
+			for (const auto x : { left, right })
+			{
+				for (const auto y : { top, bottom })
+				{
+					m_spread = std::max(m_spread, Length(GetRayDirection(frame, static_cast<float>(x), static_cast<float>(y)) - m_axis));
+				}
+			}
+		}
+
+		//The objects that can be nearest at depth along any of the tile's rays
+		unsigned int GetMask(const float depth, SdfPruningCount& count)
+		{
+			return m_frame.intervals != nullptr ? GetSlabMask(ImplicitSceneIntervals::GetSlab(depth), count) : m_tileObjects;
+		}
+
+		//Every object any of the counted lanes can be nearest to, from the slabs between the nearest lane and the furthest.
+		//The lanes of a packet are mostly in the same slab or the next, and asking again for the same slabs is free
+		template <typename T>
+		unsigned int GetMask(const T& depth, const unsigned int countBits, SdfPruningCount& count)
+		{
+			if (m_frame.intervals == nullptr)
+			{
+				return m_tileObjects;
+			}
+
+			float depths[8];
+			Packet<T>::Store(depth, depths);
+
+			auto nearest = 1e30f;
+			auto furthest = 0.0f;
+
+			for (auto lane = 0u; lane < Packet<T>::Columns * Packet<T>::Rows; lane++)
+			{
+				if ((countBits & (1u << lane)) != 0)
+				{
+					nearest = std::min(nearest, depths[lane]);
+					furthest = std::max(furthest, depths[lane]);
+				}
+			}
+
+			if (nearest > furthest)
+			{
+				return m_tileObjects;
+			}
+
+			const auto first = ImplicitSceneIntervals::GetSlab(nearest);
+			const auto last = ImplicitSceneIntervals::GetSlab(furthest);
+
+			if (first != m_lastFirst || last != m_lastLast)
+			{
+				m_lastMask = 0;
+
+				for (auto slab = first; slab <= last; slab++)
+				{
+					m_lastMask |= GetSlabMask(slab, count);
+				}
+
+				m_lastFirst = first;
+				m_lastLast = last;
+			}
+
+			return m_lastMask;
+		}
+
+	private:
+		static const unsigned int Unpruned = ~0u;
+
+		unsigned int GetSlabMask(const unsigned int slab, SdfPruningCount& count)
+		{
+			auto& mask = m_masks[slab];
+
+			if (mask == Unpruned)
+			{
+				const auto start = std::chrono::high_resolution_clock::now();
+
+				const auto nearDepth = ImplicitSceneIntervals::GetSlabStart(slab);
+				const auto farDepth = ImplicitSceneIntervals::GetSlabEnd(slab);
+				const auto radius = farDepth * m_spread + (farDepth - nearDepth) * 0.5f + 4.0f * ImplicitSceneSdf::Epsilon;
+
+				mask = m_frame.intervals->Prune(m_frame.eye + m_axis * ((nearDepth + farDepth) * 0.5f), radius, m_tileObjects, count);
+
+				count.milliseconds += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+			}
+
+			return mask;
+		}
+
+		const Frame& m_frame;
+		Vec3<float> m_axis;
+		float m_spread;
+		unsigned int m_tileObjects;
+		std::vector<unsigned int> m_masks;
+		//The last packet's slabs and their objects
+		unsigned int m_lastFirst;
+		unsigned int m_lastLast;
+		unsigned int m_lastMask;
+	};
+
+	//Where the ray goes into the box, zero from inside it and MaxDistance when it misses
+	float RayBoxEntry(const Vec3<float>& origin, const Vec3<float>& direction, const ImplicitSceneBounds& bounds)
+	{
+		const float origins[] = { origin.x, origin.y, origin.z };
+		const float directions[] = { direction.x, direction.y, direction.z };
+		const float minimums[] = { bounds.minimum.x, bounds.minimum.y, bounds.minimum.z };
+		const float maximums[] = { bounds.maximum.x, bounds.maximum.y, bounds.maximum.z };
+
+		auto entry = 0.0f;
+		auto exit = ImplicitSceneSdf::MaxDistance;
+
+		for (auto axis = 0; axis < 3; axis++)
+		{
+			//Parallel to the slab, so either always between its planes or never
+			if (std::abs(directions[axis]) < 1e-8f)
+			{
+				if (origins[axis] < minimums[axis] || origins[axis] > maximums[axis])
+				{
+					return ImplicitSceneSdf::MaxDistance;
+				}
+
+				continue;
+			}
+
+			const auto near = (minimums[axis] - origins[axis]) / directions[axis];
+			const auto far = (maximums[axis] - origins[axis]) / directions[axis];
+
+			entry = std::max(entry, std::min(near, far));
+			exit = std::min(exit, std::max(near, far));
+		}
+
+		return entry <= exit ? entry : ImplicitSceneSdf::MaxDistance;
+	}
+
+	//Last frame's hits on the static objects moved to where they are on the screen now, and for each pixel the nearest
+	//of them in the pixel and its eight neighbours, less the cache's margin. The hits land a little unevenly, so the
+	//neighbours fill the gaps between them and cover the edges of the surfaces that moved by under a pixel. A pixel with
+	//nothing around it was a miss, an animated object or off the screen, and gets zero, a full march. The animated
+	//objects could be anywhere in front of the static ones, so no ray starts past where it goes into one of their boxes
+	void ReprojectCache(const Frame& frame, const ImplicitRayMarcherCache& cache, std::vector<float>& startDepths)
+	{
+		XMFLOAT4X4 previousInverseView;
+		XMStoreFloat4x4(&previousInverseView, XMMatrixInverse(nullptr, XMLoadFloat4x4(&cache.view)));
+
+		auto previous = frame;
+		previous.right = Vec3<float>(previousInverseView._11, previousInverseView._12, previousInverseView._13);
+		previous.up = Vec3<float>(previousInverseView._21, previousInverseView._22, previousInverseView._23);
+		previous.back = Vec3<float>(previousInverseView._31, previousInverseView._32, previousInverseView._33);
+		previous.eye = Vec3<float>(previousInverseView._41, previousInverseView._42, previousInverseView._43);
+
+		const auto end = ImplicitSceneSdf::MaxDistance;
+
+		std::vector<float> reprojected(frame.width * frame.height, end);
+
+		for (auto y = 0u; y < frame.height; y++)
+		{
+			for (auto x = 0u; x < frame.width; x++)
+			{
+				const auto index = y * frame.width + x;
+				const auto object = cache.objects[index];
+
+				if (object == ImplicitRayMarcherCache::NoObject || !ImplicitSceneSdf::IsStaticObject(object))
+				{
+					continue;
+				}
+
+				const auto hitPoint = previous.eye + GetRayDirection(previous, static_cast<float>(x) + 0.5f, static_cast<float>(y) + 0.5f) * cache.depths[index];
+
+				//Onto this frame's canvas, one unit in front of the camera, then into pixels the way GetRayDirection
+				//goes the other way
+				const auto offset = hitPoint - frame.eye;
+				const auto forward = -Dot(offset, frame.back);
+
+				if (forward <= ImplicitSceneSdf::Epsilon)
+				{
+					continue;
+				}
+
+				const auto canvasX = Dot(offset, frame.right) / forward;
+				const auto canvasY = Dot(offset, frame.up) / forward;
+				const auto pixelX = (canvasX + 1.0f) * 0.5f * frame.width;
+				const auto pixelY = (1.0f - canvasY / frame.aspectRatio) * 0.5f * frame.height;
+
+				if (pixelX < 0.0f || pixelY < 0.0f || pixelX >= frame.width || pixelY >= frame.height)
+				{
+					continue;
+				}
+
+				auto& depth = reprojected[static_cast<unsigned int>(pixelY) * frame.width + static_cast<unsigned int>(pixelX)];
+				depth = std::min(depth, Length(offset));
+			}
+		}
+
+		std::vector<const ImplicitSceneBounds*> animatedBounds;
+
+		for (auto object = 0u; object < ImplicitSceneSdf::ObjectCount; object++)
+		{
+			if (!ImplicitSceneSdf::IsStaticObject(object))
+			{
+				animatedBounds.push_back(&(*frame.objectBounds)[object]);
+			}
+		}
+
+		startDepths.assign(frame.width * frame.height, 0.0f);
+
+		for (auto y = 0u; y < frame.height; y++)
+		{
+			for (auto x = 0u; x < frame.width; x++)
+			{
+				auto nearest = end;
+
+				for (auto j = y > 0 ? y - 1 : 0; j <= std::min(y + 1, frame.height - 1); j++)
+				{
+					for (auto i = x > 0 ? x - 1 : 0; i <= std::min(x + 1, frame.width - 1); i++)
+					{
+						nearest = std::min(nearest, reprojected[j * frame.width + i]);
+					}
+				}
+
+				if (nearest >= end)
+				{
+					continue;
+				}
+
+				auto start = nearest * (1.0f - cache.margin);
+				const auto direction = GetRayDirection(frame, static_cast<float>(x) + 0.5f, static_cast<float>(y) + 0.5f);
+
+				for (const auto bounds : animatedBounds)
+				{
+					start = std::min(start, RayBoxEntry(frame.eye, direction, *bounds));
+				}
+
+				startDepths[y * frame.width + x] = start;
+			}
+		}
+	}
+
+	//Marches the cone around every ray through a rectangle of pixels from start, and returns how far they can all go
+	//before one of them could reach a surface. A ray a step along in direction u is no further than depth * |u - axis|
+	//from the same distance down the axis, so the cone's radius grows with the widest corner. Past end, the furthest
+	//any of the rays needs to go, the cone stops and none of them are marched
+	float MarchCone(const Frame& frame, const unsigned int left, const unsigned int top, const unsigned int right, const unsigned int bottom, const float start, const float end, TilePrograms& programs, TileStats& stats)
+	{
+		const auto axis = GetRayDirection(frame, (left + right) * 0.5f, (top + bottom) * 0.5f);
+		const Vec3<float> corners[] =
+		{
+			GetRayDirection(frame, static_cast<float>(left), static_cast<float>(top)),
+			GetRayDirection(frame, static_cast<float>(right), static_cast<float>(top)),
+			GetRayDirection(frame, static_cast<float>(left), static_cast<float>(bottom)),
+			GetRayDirection(frame, static_cast<float>(right), static_cast<float>(bottom))
+		};
+
+		auto spread = 0.0f;
+
+		for (const auto& corner : corners)
+		{
+			spread = std::max(spread, Length(corner - axis));
+		}
+
+		const auto epsilon = ImplicitSceneSdf::Epsilon;
+
+		auto depth = start;
+
+		for (auto step = 0; step < ImplicitSceneSdf::MaxMarchingSteps && depth < end; step++)
+		{
+			const auto distance = EvaluateScene(frame, frame.eye + axis * depth, depth * frame.pixelCone, 1, stats.evaluations, programs.GetMask(depth, stats.pruning)).distance;
+			const auto radius = depth * spread;
+
+			stats.coneSteps++;
+
+			//Everything up to here stays epsilon clear of the surfaces, which the rays would have hit on. Once the cone's
+			//within its own width of something the steps get short, and the narrower cones or the rays take over
+			const auto advance = distance - radius - epsilon;
+
+			if (advance < radius)
+			{
+				return std::max(depth + std::max(advance, 0.0f), start);
+			}
+
+			depth += advance;
+		}
+
+		return std::min(depth, end);
+	}
+
+	//rayMarching from the shader for every ray in the packet, then the shading for the ones that hit. Over-relaxed, the
+	//lanes step the way Keinert et al.'s Enhanced Sphere Tracing does, except that a lane that overshoots goes back to
+	//relaxed steps straight after rather than giving them up, which saves more steps in this scene. results, when there
+	//are some, get what each valid lane found
+	template <typename T>
+	void MarchPacket(const Frame& frame, const PacketPixels& pixels, const TileSeeds& seeds, TilePrograms& programs, HeadlessImage& image, TileStats& stats, RayResult* const results = nullptr)
+	{
+		const auto lanes = Packet<T>::Columns * Packet<T>::Rows;
+
+		float directionX[8], directionY[8], directionZ[8], startDepths[8], fallbackDepths[8], endDepths[8];
+		const auto validBits = pixels.validBits;
+		auto reprojectedBits = 0u;
+
+		for (auto lane = 0u; lane < lanes; lane++)
+		{
+			const auto x = pixels.x[lane];
+			const auto y = pixels.y[lane];
+
+			//The lanes without a pixel go straight ahead, and whatever they find is left out
+			const auto valid = (validBits & (1u << lane)) != 0;
+			const auto direction = valid ? GetRayDirection(frame, static_cast<float>(x) + 0.5f, static_cast<float>(y) + 0.5f) : -frame.back;
+
+			directionX[lane] = direction.x;
+			directionY[lane] = direction.y;
+			directionZ[lane] = direction.z;
+			startDepths[lane] = ImplicitSceneSdf::Epsilon;
+			fallbackDepths[lane] = ImplicitSceneSdf::Epsilon;
+			endDepths[lane] = ImplicitSceneSdf::MaxDistance;
+
+			if (valid)
+			{
+				startDepths[lane] = seeds.Get(x, y);
+
+				if (frame.depthLimits != nullptr)
+				{
+					endDepths[lane] = frame.depthLimits->GetLimit(x, y);
+				}
+				fallbackDepths[lane] = startDepths[lane];
+
+				if (frame.reprojectedDepths != nullptr && frame.reprojectedDepths[y * frame.width + x] > startDepths[lane])
+				{
+					startDepths[lane] = frame.reprojectedDepths[y * frame.width + x];
+					reprojectedBits |= 1u << lane;
+				}
+			}
+		}
+
+		const auto rayDirection = Vec3<T>(Packet<T>::Load(directionX), Packet<T>::Load(directionY), Packet<T>::Load(directionZ));
+		const auto eye = Vec3<T>(frame.eye);
+
+		const auto epsilon = ImplicitSceneSdf::Epsilon;
+		const auto farDistance = ImplicitSceneSdf::MaxDistance;
+		//Each lane's far distance, nearer where the rasterized scene would hide anything behind it
+		const auto end = Packet<T>::Load(endDepths);
+
+		auto hit = Packet<T>::FromBits(0);
+		auto depth = Packet<T>::Load(startDepths);
+		const auto fallbackDepth = Packet<T>::Load(fallbackDepths);
+		//Rays whose cone got past the far distance have already missed
+		auto active = AndNot(Packet<T>::FromBits(validBits), depth >= end);
+		auto colour = Vec3<T>(T(0.0f), T(0.0f), T(0.0f));
+
+		const auto relaxation = T(frame.overRelaxation);
+		auto previousDistance = T(0.0f);
+		auto stepLength = T(0.0f);
+		auto laneSteps = T(0.0f);
+
+		//Lanes that count towards the stats, the ones still marching and later the ones being shaded
+		auto countBits = validBits;
+
+		const auto pixelCone = T(frame.pixelCone);
+
+		for (auto step = 0; step < ImplicitSceneSdf::MaxMarchingSteps && Any(active); step++)
+		{
+			countBits = Bits(active);
+
+			const auto sample = EvaluateScene(frame, eye + rayDirection * depth, depth * pixelCone, countBits, stats.evaluations, programs.GetMask(depth, countBits, stats.pruning));
+
+			stats.steps += std::bitset<8>(Bits(active)).count();
+			laneSteps = Select(active, laneSteps + T(1.0f), laneSteps);
+
+			//The sphere here doesn't reach back to the one the last step came from, so there could be a surface in
+			//between. Stepping by the distance the spheres always overlap, so this only happens over-relaxed
+			const auto radius = Abs(sample.distance);
+			const auto overshot = And(active, radius + previousDistance < stepLength);
+
+			//Starting inside a surface means something the cache didn't know about is in front of last frame's hit, so
+			//the lane goes back to where it would have started without it
+			auto rejected = Packet<T>::FromBits(0);
+
+			if (step == 0 && reprojectedBits != 0)
+			{
+				rejected = And(Packet<T>::FromBits(reprojectedBits), sample.distance < T(0.0f));
+				stats.rejectedRays += std::bitset<8>(Bits(rejected)).count();
+			}
+
+			const auto surface = AndNot(AndNot(And(active, sample.distance < T(epsilon)), overshot), rejected);
+
+			hit = Or(hit, surface);
+			colour = Select(surface, sample.colour, colour);
+			active = AndNot(active, surface);
+
+			//Back to where the last step would have gone unrelaxed, which the last sphere says is safe
+			const auto advance = Select(overshot, previousDistance - stepLength, sample.distance * relaxation);
+
+			const auto restart = Or(overshot, rejected);
+
+			stepLength = Select(restart, T(0.0f), advance);
+			previousDistance = Select(restart, T(0.0f), radius);
+
+			depth = Select(rejected, fallbackDepth, Select(active, depth + advance, depth));
+
+			//Past the far distance counts as a miss, as does running out of steps
+			active = AndNot(active, depth >= end);
+		}
+
+		//Whatever's still marching ran out of steps
+		const auto outOfStepsBits = Bits(active);
+
+		hit = And(hit, depth <= end - T(epsilon));
+
+		const auto hitBits = Bits(hit);
+
+		stats.rays += std::bitset<8>(validBits).count();
+		stats.hits += std::bitset<8>(hitBits).count();
+		stats.reprojectedRays += std::bitset<8>(reprojectedBits).count();
+
+		if (frame.depthLimits != nullptr)
+		{
+			//Stopped short of the far distance by what was rasterized, whether they got there by marching or their cone
+			//did
+			stats.occludedRays += std::bitset<8>(Bits(AndNot(And(depth >= end - T(epsilon), end < T(farDistance)), hit)) & validBits & ~outOfStepsBits).count();
+		}
+
+		float red[8], green[8], blue[8], steps[8], depths[8], objects[8];
+
+		Packet<T>::Store(laneSteps, steps);
+		Packet<T>::Store(depth, depths);
+
+		if (hitBits != 0)
+		{
+			//The shader moves the surface point to cameraPosition, which is the same as the ray origin here
+			const auto surfacePoint = eye + rayDirection * depth;
+			countBits = hitBits;
+
+			const auto normal = FindNormal(frame, surfacePoint, depth * pixelCone, countBits, stats.evaluations, programs.GetMask(depth, countBits, stats.pruning));
+			const auto shaded = ImplicitSceneSdf::Shade(surfacePoint, normal, rayDirection, colour, depth);
+
+			Packet<T>::Store(shaded.x, red);
+			Packet<T>::Store(shaded.y, green);
+			Packet<T>::Store(shaded.z, blue);
+
+			if (frame.cache != nullptr || results != nullptr)
+			{
+				Packet<T>::Store(FindClosestObject(frame, surfacePoint, depth * pixelCone, countBits, stats.evaluations), objects);
+			}
+		}
+
+		for (auto lane = 0u; lane < lanes; lane++)
+		{
+			if ((validBits & (1u << lane)) == 0)
+			{
+				continue;
+			}
+
+			const auto x = pixels.x[lane];
+			const auto y = pixels.y[lane];
+
+			if (frame.trace != nullptr)
+			{
+				frame.trace->steps[y * frame.width + x] = static_cast<unsigned short>(steps[lane]);
+				frame.trace->outOfSteps[y * frame.width + x] = (outOfStepsBits & (1u << lane)) != 0 ? 1 : 0;
+				frame.trace->depths[y * frame.width + x] = (hitBits & (1u << lane)) != 0 ? depths[lane] : farDistance;
+				frame.trace->startDepths[y * frame.width + x] = startDepths[lane];
+			}
+
+			if (frame.cache != nullptr)
+			{
+				const auto laneHit = (hitBits & (1u << lane)) != 0;
+
+				frame.cache->depths[y * frame.width + x] = laneHit ? depths[lane] : farDistance;
+				frame.cache->objects[y * frame.width + x] = laneHit ? static_cast<unsigned char>(objects[lane]) : ImplicitRayMarcherCache::NoObject;
+				frame.cache->steps[y * frame.width + x] = static_cast<unsigned short>(steps[lane]);
+			}
+
+			const auto laneColour = (hitBits & (1u << lane)) != 0 ? XMFLOAT3(red[lane], green[lane], blue[lane]) : XMFLOAT3(frame.background.x, frame.background.y, frame.background.z);
+
+			image.SetPixel(x, y, laneColour);
+
+			if (results != nullptr)
+			{
+				const auto laneHit = (hitBits & (1u << lane)) != 0;
+
+				results[lane] = { laneHit, laneHit ? depths[lane] : farDistance, laneHit ? static_cast<unsigned char>(objects[lane]) : ImplicitRayMarcherCache::NoObject, laneColour };
+			}
+		}
+	}
+
+	//The bilinear blend of a block's corners at fx and fy across it, top left, top right, bottom left, bottom right
+	float Bilinear(const float* const corners, const float fx, const float fy)
+	{
+		const auto upper = corners[0] + (corners[1] - corners[0]) * fx;
+		const auto lower = corners[2] + (corners[3] - corners[2]) * fx;
+
+		return upper + (lower - upper) * fy;
+	}
+
+	//adaptiveBlockSize's subdivision of a tile. Each block's corner pixels are marched, and a block whose corners all hit
+	//the same object, with the furthest no more than adaptiveDepthRatio further than the nearest, or all miss, has the
+	//pixels inside interpolated from them. The others are split into quarters, which share the corners they have in
+	//common, down to blocks with no pixels inside. Anything smaller than a block that falls between its corners is lost
+	template <typename T>
+	void RenderAdaptiveTile(const Frame& frame, const unsigned int left, const unsigned int top, const unsigned int right, const unsigned int bottom, const TileSeeds& seeds, TilePrograms& programs, HeadlessImage& image, TileStats& stats)
+	{
+		const auto lanes = Packet<T>::Columns * Packet<T>::Rows;
+		const auto width = right - left;
+		const auto height = bottom - top;
+
+		//Corner pixels, each block's first and last in both directions and so shared with the blocks around it
+		struct Block
+		{
+			unsigned int left;
+			unsigned int top;
+			unsigned int right;
+			unsigned int bottom;
+		};
+
+		enum PixelState : unsigned char { Unknown, Interpolated, Marched };
+
+		std::vector<PixelState> states(width * height, Unknown);
+		std::vector<RayResult> results(width * height);
+		std::vector<Block> blocks;
+		std::vector<Block> splits;
+
+		for (auto y = top; ; y += frame.adaptiveBlockSize)
+		{
+			const auto blockBottom = std::min(y + frame.adaptiveBlockSize, bottom - 1);
+
+			for (auto x = left; ; x += frame.adaptiveBlockSize)
+			{
+				const auto blockRight = std::min(x + frame.adaptiveBlockSize, right - 1);
+
+				blocks.push_back({ x, y, blockRight, blockBottom });
+
+				if (blockRight == right - 1)
+				{
+					break;
+				}
+			}
+
+			if (blockBottom == bottom - 1)
+			{
+				break;
+			}
+		}
+
+		std::vector<XMUINT2> pending;
+
+		while (!blocks.empty())
+		{
+			//Every corner not marched yet, a packet of them at a time
+			pending.clear();
+
+			for (const auto& block : blocks)
+			{
+				const XMUINT2 corners[] = { XMUINT2(block.left, block.top), XMUINT2(block.right, block.top), XMUINT2(block.left, block.bottom), XMUINT2(block.right, block.bottom) };
+
+				for (const auto& corner : corners)
+				{
+					auto& state = states[(corner.y - top) * width + corner.x - left];
+
+					if (state != Marched)
+					{
+						state = Marched;
+						pending.push_back(corner);
+					}
+				}
+			}
+
+			for (auto first = 0u; first < pending.size(); first += lanes)
+			{
+				PacketPixels pixels = {};
+				RayResult packetResults[8];
+
+				for (auto lane = 0u; lane < lanes && first + lane < pending.size(); lane++)
+				{
+					pixels.x[lane] = pending[first + lane].x;
+					pixels.y[lane] = pending[first + lane].y;
+					pixels.validBits |= 1u << lane;
+				}
+
+				MarchPacket<T>(frame, pixels, seeds, programs, image, stats, packetResults);
+
+				for (auto lane = 0u; lane < lanes && first + lane < pending.size(); lane++)
+				{
+					results[(pixels.y[lane] - top) * width + pixels.x[lane] - left] = packetResults[lane];
+				}
+			}
+
+			splits.clear();
+
+			for (const auto& block : blocks)
+			{
+				//Nothing inside to interpolate or split
+				if (block.right - block.left <= 1 && block.bottom - block.top <= 1)
+				{
+					continue;
+				}
+
+				const RayResult* const corners[] =
+				{
+					&results[(block.top - top) * width + block.left - left],
+					&results[(block.top - top) * width + block.right - left],
+					&results[(block.bottom - top) * width + block.left - left],
+					&results[(block.bottom - top) * width + block.right - left]
+				};
+
+				auto smooth = true;
+				auto nearest = ImplicitSceneSdf::MaxDistance;
+				auto furthest = 0.0f;
+
+				for (const auto corner : corners)
+				{
+					smooth = smooth && corner->hit == corners[0]->hit && corner->object == corners[0]->object;
+					nearest = std::min(nearest, corner->depth);
+					furthest = std::max(furthest, corner->depth);
+				}
+
+				if (smooth && corners[0]->hit)
+				{
+					smooth = furthest <= nearest * (1.0f + frame.adaptiveDepthRatio);
+
+					//The rasterized scene could cover some of the pixels in between
+					if (frame.depthLimits != nullptr)
+					{
+						smooth = smooth && frame.depthLimits->GetMinimum(block.left, block.top, block.right + 1, block.bottom + 1) > furthest;
+					}
+				}
+
+				if (smooth)
+				{
+					const float depths[] = { corners[0]->depth, corners[1]->depth, corners[2]->depth, corners[3]->depth };
+					const float reds[] = { corners[0]->colour.x, corners[1]->colour.x, corners[2]->colour.x, corners[3]->colour.x };
+					const float greens[] = { corners[0]->colour.y, corners[1]->colour.y, corners[2]->colour.y, corners[3]->colour.y };
+					const float blues[] = { corners[0]->colour.z, corners[1]->colour.z, corners[2]->colour.z, corners[3]->colour.z };
+
+					for (auto y = block.top; y <= block.bottom; y++)
+					{
+						for (auto x = block.left; x <= block.right; x++)
+						{
+							const auto index = (y - top) * width + x - left;
+
+							if (states[index] == Marched)
+							{
+								continue;
+							}
+
+							const auto fx = block.right > block.left ? static_cast<float>(x - block.left) / (block.right - block.left) : 0.0f;
+							const auto fy = block.bottom > block.top ? static_cast<float>(y - block.top) / (block.bottom - block.top) : 0.0f;
+
+							states[index] = Interpolated;
+							results[index] = { corners[0]->hit, Bilinear(depths, fx, fy), corners[0]->object, XMFLOAT3(Bilinear(reds, fx, fy), Bilinear(greens, fx, fy), Bilinear(blues, fx, fy)) };
+						}
+					}
+
+					continue;
+				}
+
+				//Halved where there's anything in between, so a block one pixel wide is only split the other way
+				const auto middleX = (block.left + block.right) / 2;
+				const auto middleY = (block.top + block.bottom) / 2;
+				const auto splitX = block.right - block.left > 1;
+				const auto splitY = block.bottom - block.top > 1;
+
+				splits.push_back({ block.left, block.top, splitX ? middleX : block.right, splitY ? middleY : block.bottom });
+
+				if (splitX)
+				{
+					splits.push_back({ middleX, block.top, block.right, splitY ? middleY : block.bottom });
+				}
+
+				if (splitY)
+				{
+					splits.push_back({ block.left, middleY, splitX ? middleX : block.right, block.bottom });
+				}
+
+				if (splitX && splitY)
+				{
+					splits.push_back({ middleX, middleY, block.right, block.bottom });
+				}
+			}
+
+			blocks.swap(splits);
+		}
+
+		//The marched pixels are already in the image, the trace and the cache. The interpolated ones took no steps
+		for (auto y = top; y < bottom; y++)
+		{
+			for (auto x = left; x < right; x++)
+			{
+				const auto index = (y - top) * width + x - left;
+
+				if (states[index] != Interpolated)
+				{
+					continue;
+				}
+
+				const auto& result = results[index];
+
+				image.SetPixel(x, y, result.colour);
+				stats.interpolatedPixels++;
+
+				if (frame.trace != nullptr)
+				{
+					frame.trace->depths[y * frame.width + x] = result.depth;
+				}
+
+				if (frame.cache != nullptr)
+				{
+					frame.cache->depths[y * frame.width + x] = result.depth;
+					frame.cache->objects[y * frame.width + x] = result.object;
+				}
+			}
+		}
+	}
+
+	template <typename T>
+	TileStats RenderTile(const Frame& frame, const unsigned int tileX, const unsigned int tileY, const unsigned int tileSize, const unsigned int coneLevels, HeadlessImage& image)
+	{
+		TileStats stats = { 0, 0, 0, 0, 0, 0, 0, 0, 0, SdfEvaluationCount(), SdfPruningCount() };
+
+		const auto left = tileX * tileSize;
+		const auto top = tileY * tileSize;
+		const auto right = std::min(left + tileSize, frame.width);
+		const auto bottom = std::min(top + tileSize, frame.height);
+
+		const auto tileObjects = frame.bins != nullptr ? frame.bins->GetObjects(tileX, tileY) : ImplicitSceneIntervals::AllObjects;
+
+		//No ray here can reach anything. The trace and the cache already have every pixel as a miss
+		if (tileObjects == 0)
+		{
+			for (auto y = top; y < bottom; y++)
+			{
+				for (auto x = left; x < right; x++)
+				{
+					image.SetPixel(x, y, XMFLOAT3(frame.background.x, frame.background.y, frame.background.z));
+				}
+			}
+
+			for (auto y = top; y < bottom; y++)
+			{
+				for (auto x = left; x < right; x++)
+				{
+					if (!frame.checkerboard || ImplicitCheckerboard::IsMarched(x, y, frame.checkerboardFrame))
+					{
+						stats.rays++;
+					}
+				}
+			}
+
+			stats.skippedRays = stats.rays;
+
+			return stats;
+		}
+
+		TilePrograms programs(frame, left, top, right, bottom, tileObjects);
+
+		TileSeeds seeds = { nullptr, left, top, tileSize, 1 };
+
+		//The first cone covers the tile and each level splits the cones before into four, starting them where their
+		//parent stopped
+		std::vector<float> parentDepths(1, ImplicitSceneSdf::Epsilon);
+		std::vector<float> depths;
+
+		for (auto level = 0u; level < coneLevels && (tileSize >> level) > 0; level++)
+		{
+			const auto cellSize = tileSize >> level;
+			const auto cells = 1u << level;
+			const auto parentCells = std::max(cells / 2, 1u);
+
+			depths.assign(cells * cells, ImplicitSceneSdf::MaxDistance);
+
+			for (auto j = 0u; j < cells && top + j * cellSize < bottom; j++)
+			{
+				for (auto i = 0u; i < cells && left + i * cellSize < right; i++)
+				{
+					const auto parent = parentDepths[(j / 2) * parentCells + i / 2];
+					const auto cellLeft = left + i * cellSize;
+					const auto cellTop = top + j * cellSize;
+					const auto cellRight = std::min(cellLeft + cellSize, right);
+					const auto cellBottom = std::min(cellTop + cellSize, bottom);
+
+					//No ray under the cone needs to go further than the furthest of their limits
+					const auto end = frame.depthLimits != nullptr ? frame.depthLimits->GetMaximum(cellLeft, cellTop, cellRight, cellBottom) : ImplicitSceneSdf::MaxDistance;
+
+					depths[j * cells + i] = MarchCone(frame, cellLeft, cellTop, cellRight, cellBottom, parent, end, programs, stats);
+				}
+			}
+
+			parentDepths.swap(depths);
+			seeds = { parentDepths.data(), left, top, cellSize, cells };
+		}
+
+		if (frame.adaptiveBlockSize > 0)
+		{
+			RenderAdaptiveTile<T>(frame, left, top, right, bottom, seeds, programs, image, stats);
+
+			return stats;
+		}
+
+		//Every other pixel of each row with checkerboard, so a packet spans twice as many columns and its lanes are still
+		//all marched
+		const auto spacing = frame.checkerboard ? 2u : 1u;
+
+		for (auto y = top; y < bottom; y += Packet<T>::Rows)
+		{
+			for (auto x = left; x < right; x += Packet<T>::Columns * spacing)
+			{
+				PacketPixels pixels;
+				pixels.validBits = 0;
+
+				for (auto lane = 0u; lane < Packet<T>::Columns * Packet<T>::Rows; lane++)
+				{
+					pixels.y[lane] = y + lane / Packet<T>::Columns;
+					pixels.x[lane] = x + lane % Packet<T>::Columns * spacing;
+
+					if (frame.checkerboard && !ImplicitCheckerboard::IsMarched(pixels.x[lane], pixels.y[lane], frame.checkerboardFrame))
+					{
+						pixels.x[lane]++;
+					}
+
+					if (pixels.x[lane] < right && pixels.y[lane] < bottom)
+					{
+						pixels.validBits |= 1u << lane;
+					}
+				}
+
+				MarchPacket<T>(frame, pixels, seeds, programs, image, stats);
+			}
+		}
+
+		return stats;
+	}
+
+	//Interleaves the bits of x and y
+	unsigned int MortonCode(const unsigned int x, const unsigned int y)
+	{
+		const auto spread = [](unsigned int value)
+		{
+			value &= 0x0000FFFF;
+			value = (value | (value << 8)) & 0x00FF00FF;
+			value = (value | (value << 4)) & 0x0F0F0F0F;
+			value = (value | (value << 2)) & 0x33333333;
+			value = (value | (value << 1)) & 0x55555555;
+			return value;
+		};
+
+		return spread(x) | (spread(y) << 1);
+	}
+}
+
+const unsigned char ImplicitRayMarcherCache::NoObject;
+
+ImplicitRayMarcher::ImplicitRayMarcher(const ImplicitRayMarcherSettings& settings) : m_settings(settings)
+{
+}
+
+unsigned int ImplicitRayMarcherTrace::GetOutOfStepsCount() const
+{
+	return static_cast<unsigned int>(std::count(outOfSteps.begin(), outOfSteps.end(), 1));
+}
+
+void ImplicitRayMarcherTrace::WriteHeatmap(HeadlessImage& image) const
+{
+	for (auto y = 0u; y < std::min(height, image.GetHeight()); y++)
+	{
+		for (auto x = 0u; x < std::min(width, image.GetWidth()); x++)
+		{
+			const auto index = y * width + x;
+
+			if (outOfSteps[index] != 0)
+			{
+				image.SetPixel(x, y, XMFLOAT3(1.0f, 0.0f, 1.0f));
+				continue;
+			}
+
+			//Square root so the few dozen steps most rays take aren't all the same blue
+			const auto t = std::sqrt(static_cast<float>(steps[index]) / ImplicitSceneSdf::MaxMarchingSteps);
+
+			image.SetPixel(x, y, XMFLOAT3(Saturate(2.0f * t - 1.0f), 1.0f - std::abs(2.0f * t - 1.0f), Saturate(1.0f - 2.0f * t)));
+		}
+	}
+}
+
+ImplicitRayMarcherStats ImplicitRayMarcher::Render(const XMMATRIX& view, const float time, HeadlessImage& image, ImplicitRayMarcherTrace* const trace, ImplicitRayMarcherCache* const cache, const ImplicitDepthPyramid* const depthLimits, ImplicitCheckerboardHistory* const history) const
+{
+	const auto start = std::chrono::high_resolution_clock::now();
+
+	XMFLOAT4X4 inverseView;
+	XMStoreFloat4x4(&inverseView, XMMatrixInverse(nullptr, view));
+
+	Frame frame;
+	frame.parameters = ImplicitSceneParameters::FromTime(time);
+
+	//Built every frame around where the animated objects are now, which is tighter than the shader's fixed tree
+	const auto objectBounds = ImplicitSceneHierarchy::GetObjectBounds(frame.parameters);
+	const ImplicitSceneHierarchy hierarchy(objectBounds);
+
+	frame.objectBounds = &objectBounds;
+	frame.hierarchy = m_settings.useHierarchy ? &hierarchy : nullptr;
+	frame.bricks = m_settings.bricks;
+	frame.intervals = nullptr;
+	frame.bins = nullptr;
+	frame.standInDistance = m_settings.standInDistance;
+	frame.lipschitzScaling = m_settings.lipschitzScaling;
+	frame.overRelaxation = m_settings.overRelaxation;
+	frame.pixelCone = m_settings.coneWidthPixels * 2.0f / image.GetWidth();
+	frame.normals = m_settings.normals;
+	frame.checkerboard = m_settings.checkerboard && m_settings.adaptiveBlockSize == 0;
+	frame.checkerboardFrame = history != nullptr ? history->frame : 0;
+	frame.trace = trace;
+
+	//Checkerboard reconstructs from the marched pixels' hits, which go in the cache. Without one they go in one that
+	//starts empty, so nothing is reprojected
+	ImplicitRayMarcherCache checkerboardHits;
+	const auto hits = cache == nullptr && frame.checkerboard ? &checkerboardHits : cache;
+
+	frame.cache = hits;
+	frame.reprojectedDepths = nullptr;
+	frame.depthLimits = depthLimits != nullptr && depthLimits->GetWidth() == image.GetWidth() && depthLimits->GetHeight() == image.GetHeight() ? depthLimits : nullptr;
+	frame.adaptiveBlockSize = m_settings.adaptiveBlockSize;
+	frame.adaptiveDepthRatio = m_settings.adaptiveDepthRatio;
+
+	for (auto object = 0u; object < ImplicitSceneSdf::ObjectCount; object++)
+	{
+		frame.objectScales[object] = frame.lipschitzScaling ? 1.0f / ImplicitSceneSdf::GetObjectLipschitz(frame.parameters, object) : 1.0f;
+	}
+
+	const ImplicitSceneIntervals intervals(frame.parameters, objectBounds, frame.objectScales);
+
+	if (m_settings.intervalPruning)
+	{
+		frame.intervals = &intervals;
+	}
+
+	frame.right = Vec3<float>(inverseView._11, inverseView._12, inverseView._13);
+	frame.up = Vec3<float>(inverseView._21, inverseView._22, inverseView._23);
+	frame.back = Vec3<float>(inverseView._31, inverseView._32, inverseView._33);
+	frame.eye = Vec3<float>(inverseView._41, inverseView._42, inverseView._43);
+	frame.width = image.GetWidth();
+	frame.height = image.GetHeight();
+	frame.aspectRatio = static_cast<float>(frame.height) / frame.width;
+	frame.background = Vec3<float>(m_settings.background.x, m_settings.background.y, m_settings.background.z);
+
+	if (trace != nullptr)
+	{
+		trace->width = frame.width;
+		trace->height = frame.height;
+		trace->steps.assign(frame.width * frame.height, 0);
+		trace->outOfSteps.assign(frame.width * frame.height, 0);
+		trace->depths.assign(frame.width * frame.height, ImplicitSceneSdf::MaxDistance);
+		trace->startDepths.assign(frame.width * frame.height, ImplicitSceneSdf::Epsilon);
+	}
+
+	//Reprojected before the rays overwrite the cache with this frame's hits. A cache from a different size of image
+	//doesn't line up, so it's started again
+	std::vector<float> reprojectedDepths;
+
+	if (hits != nullptr)
+	{
+		if (hits->IsValid() && hits->width == frame.width && hits->height == frame.height)
+		{
+			ReprojectCache(frame, *hits, reprojectedDepths);
+			frame.reprojectedDepths = reprojectedDepths.data();
+		}
+
+		XMStoreFloat4x4(&hits->view, view);
+		hits->width = frame.width;
+		hits->height = frame.height;
+		hits->depths.assign(frame.width * frame.height, ImplicitSceneSdf::MaxDistance);
+		hits->objects.assign(frame.width * frame.height, ImplicitRayMarcherCache::NoObject);
+		hits->steps.assign(frame.width * frame.height, 0);
+	}
+
+	//Tiles are a whole number of packets so none straddle two tiles
+	const auto tileSize = std::max((m_settings.tileSize + 3) & ~3u, 4u);
+	const auto tilesX = (frame.width + tileSize - 1) / tileSize;
+	const auto tilesY = (frame.height + tileSize - 1) / tileSize;
+
+	//Binned into the same tiles the rays are marched in
+	const auto bins = m_settings.tileBinning ? std::make_unique<ImplicitSceneTileBins>(objectBounds, view, frame.width, frame.height, tileSize) : nullptr;
+	frame.bins = bins.get();
+
+	std::vector<XMUINT2> tiles;
+	tiles.reserve(tilesX * tilesY);
+
+	for (auto y = 0u; y < tilesY; y++)
+	{
+		for (auto x = 0u; x < tilesX; x++)
+		{
+			tiles.emplace_back(x, y);
+		}
+	}
+
+	if (m_settings.mortonOrder)
+	{
+		std::sort(tiles.begin(), tiles.end(), [](const XMUINT2& a, const XMUINT2& b) { return MortonCode(a.x, a.y) < MortonCode(b.x, b.y); });
+	}
+
+	const auto usePackets = m_settings.usePackets && IsFloat8Supported();
+
+	std::vector<TileStats> tileStats(tiles.size());
+
+	const auto renderTile = [&](const size_t index)
+	{
+		const auto& tile = tiles[index];
+
+		tileStats[index] = usePackets
+			? RenderTile<Float8>(frame, tile.x, tile.y, tileSize, m_settings.coneLevels, image)
+			: RenderTile<float>(frame, tile.x, tile.y, tileSize, m_settings.coneLevels, image);
+	};
+
+	if (m_settings.parallel)
+	{
+		//Idle workers steal the back half of a busy worker's range, which keeps the expensive tiles around the fractals
+		//from holding up the frame
+		concurrency::parallel_for(static_cast<size_t>(0), tiles.size(), renderTile);
+	}
+	else
+	{
+		for (auto i = 0u; i < tiles.size(); i++)
+		{
+			renderTile(i);
+		}
+	}
+
+	ImplicitRayMarcherStats stats = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0, usePackets, SdfEvaluationCount(), SdfPruningCount(), ImplicitCheckerboardStats() };
+
+	for (const auto& tile : tileStats)
+	{
+		stats.rays += tile.rays;
+		stats.steps += tile.steps;
+		stats.coneSteps += tile.coneSteps;
+		stats.hits += tile.hits;
+		stats.reprojectedRays += tile.reprojectedRays;
+		stats.rejectedRays += tile.rejectedRays;
+		stats.occludedRays += tile.occludedRays;
+		stats.skippedRays += tile.skippedRays;
+		stats.interpolatedPixels += tile.interpolatedPixels;
+		stats.evaluations += tile.evaluations;
+		stats.pruning += tile.pruning;
+	}
+
+	if (frame.checkerboard)
+	{
+		stats.checkerboard = ImplicitCheckerboard::Reconstruct(view, frame.checkerboardFrame, image, hits->depths, hits->objects, history, frame.depthLimits, m_settings.background, m_settings.parallel);
+
+		//The reconstructed pixels took no steps
+		if (trace != nullptr)
+		{
+			for (auto y = 0u; y < frame.height; y++)
+			{
+				for (auto x = 0u; x < frame.width; x++)
+				{
+					if (!ImplicitCheckerboard::IsMarched(x, y, frame.checkerboardFrame))
+					{
+						trace->depths[y * frame.width + x] = hits->depths[y * frame.width + x];
+					}
+				}
+			}
+		}
+
+		if (history != nullptr)
+		{
+			ImplicitCheckerboard::StoreHistory(view, image, hits->depths, hits->objects, *history);
+		}
+	}
+
+	stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	return stats;
+}
+
+XMMATRIX ImplicitRayMarcher::LookAt(const XMFLOAT3& eye, const XMFLOAT3& target)
+{
+	return XMMatrixLookAtRH(XMLoadFloat3(&eye), XMLoadFloat3(&target), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+}
@@ -0,0 +1,191 @@
+#pragma once
+
+#include "HeadlessImage.h"
+#include "ImplicitCheckerboard.h"
+#include "ImplicitDepthPyramid.h"
+#include "ImplicitSceneBricks.h"
+#include "ImplicitSceneHierarchy.h"
+#include "ImplicitSceneIntervals.h"
+#include "ImplicitSceneTileBins.h"
+
+#include <DirectXMath.h>
+#include <vector>
+
+namespace AlienPlanetACW
+{
+	//How the normal at each hit is found
+	enum class ImplicitRayMarcherNormals
+	{
+		//estimateGradiantNormal's six samples, like the shader
+		CentralDifferences,
+		//Four samples around a tetrahedron, NORMAL_TETRAHEDRON in the shader
+		Tetrahedron,
+		//The exact gradient from one evaluation with Sdf::Dual
+		Dual
+	};
+
+	struct ImplicitRayMarcherSettings
+	{
+		ImplicitRayMarcherSettings() : tileSize(16), usePackets(true), parallel(true), mortonOrder(true), useHierarchy(true), standInDistance(1e10f), bricks(nullptr), coneLevels(0), overRelaxation(1.0f), lipschitzScaling(false), coneWidthPixels(0.0f), intervalPruning(false), tileBinning(false), adaptiveBlockSize(0), adaptiveDepthRatio(0.05f), checkerboard(false), normals(ImplicitRayMarcherNormals::CentralDifferences), background(1.0f, 0.97255f, 0.86275f) {}
+
+		//Square tiles, each one a task for the thread pool
+		unsigned int tileSize;
+		//Eight rays at a time with Float8 when the CPU has AVX2, otherwise one at a time
+		bool usePackets;
+		bool parallel;
+		//Tiles handed out along a Z curve rather than row by row, so neighbouring tasks share cache lines of the image
+		bool mortonOrder;
+		//Only evaluate the objects whose boxes are near the sample, which gives the same image as evaluating them all
+		bool useHierarchy;
+		//Boxes further than this stand in for their objects, see ImplicitSceneHierarchy::Evaluate. Off by default
+		float standInDistance;
+		//Baked distances for the objects that don't move, used at the hierarchy's leaves so only with useHierarchy. Null
+		//to evaluate them
+		const ImplicitSceneBricks* bricks;
+		//Cone passes before the rays, the first over each tile and each one after over quarters of the cones before.
+		//They find how far every ray under a cone can go before it could hit anything, which is where the rays start.
+		//0 starts every ray at the camera
+		unsigned int coneLevels;
+		//Steps are the distance times this, over-relaxed sphere tracing. When a step overshoots, so the sphere at the new
+		//point doesn't reach back to the last one, the ray goes back to where a plain step would have taken it. 1 marches
+		//like the shader does by default. About 1.5 saves the most steps here
+		float overRelaxation;
+		//Divide each object's distance by ImplicitSceneSdf::GetObjectLipschitz, so the deformed objects can't be stepped
+		//through
+		bool lipschitzScaling;
+		//Each sample's cone is this many pixels wide where it is, and the fractals' iterations and the wobbly sphere's
+		//wobbles narrower than it are left out, see ImplicitSceneSdf::EvaluateObject. 0 keeps all the detail like the
+		//shader
+		float coneWidthPixels;
+		//Each tile's frustum is cut into ImplicitSceneIntervals' depth slabs, and a sample only evaluates the objects that
+		//can be nearest in its slab, with no bound tests. A slab is pruned the first time the tile samples in it. The
+		//objects are bounded on their own distances, so with bricks or a cone the pruning is as close as those are
+		bool intervalPruning;
+		//Each tile only evaluates the objects whose boxes ImplicitSceneTileBins projects onto it, and a tile with none
+		//isn't marched at all
+		bool tileBinning;
+		//Each tile is cut into blocks this many pixels across and only their corners are marched at first. The blocks
+		//whose corners hit different objects, or depths more than adaptiveDepthRatio of the nearest apart, are split into
+		//quarters and their new corners marched, and the pixels inside the rest are interpolated from their corners. 0
+		//marches every pixel
+		unsigned int adaptiveBlockSize;
+		float adaptiveDepthRatio;
+		//Only the pixels of one colour of a checkerboard are marched, the two colours taking turns from frame to frame,
+		//and ImplicitCheckerboard reconstructs the rest from them and last frame's image. Not with adaptiveBlockSize
+		bool checkerboard;
+		ImplicitRayMarcherNormals normals;
+		//Where the shader discards, the fog colour by default
+		DirectX::XMFLOAT3 background;
+	};
+
+	struct ImplicitRayMarcherStats
+	{
+		unsigned long long rays;
+		//Scene evaluations while marching, the normals' six per hit aren't included
+		unsigned long long steps;
+		//Scene evaluations by the cone passes, one per cone per step
+		unsigned long long coneSteps;
+		unsigned long long hits;
+		//Rays that started from the temporal cache's depth, and the ones of those that found they'd started inside a
+		//surface and went back to the cone's depth or the camera
+		unsigned long long reprojectedRays;
+		unsigned long long rejectedRays;
+		//Rays that stopped where the rasterized scene was in front of them, with depth limits
+		unsigned long long occludedRays;
+		//Rays in the tiles tileBinning found no objects over, which were left as the background without marching
+		unsigned long long skippedRays;
+		//Pixels adaptiveBlockSize filled in from the corners around them rather than marching, which rays doesn't count
+		unsigned long long interpolatedPixels;
+		double milliseconds;
+		bool usedPackets;
+		//Everything evaluated, normals included
+		SdfEvaluationCount evaluations;
+		//The slabs the tiles pruned, with intervalPruning
+		SdfPruningCount pruning;
+		//The pixels checkerboard filled in, which rays doesn't count
+		ImplicitCheckerboardStats checkerboard;
+
+		double GetMegaRaysPerSecond() const { return milliseconds > 0.0 ? rays / (milliseconds * 1000.0) : 0.0; }
+		double GetAverageSteps() const { return rays > 0 ? static_cast<double>(steps) / rays : 0.0; }
+		double GetAverageConeSteps() const { return rays > 0 ? static_cast<double>(coneSteps) / rays : 0.0; }
+		double GetObjectsPerRay() const { return rays > 0 ? static_cast<double>(evaluations.objects) / rays : 0.0; }
+		double GetPrimitivesPerRay() const { return rays > 0 ? static_cast<double>(evaluations.primitives) / rays : 0.0; }
+		double GetBoundTestsPerRay() const { return rays > 0 ? static_cast<double>(evaluations.boundTests) / rays : 0.0; }
+	};
+
+	//Where the rays spent their steps, one entry per pixel row by row
+	struct ImplicitRayMarcherTrace
+	{
+		unsigned int width;
+		unsigned int height;
+		//Scene evaluations marching the pixel's ray, not counting the cone passes or the normal
+		std::vector<unsigned short> steps;
+		//1 where the ray used all of ImplicitSceneSdf::MaxMarchingSteps without hitting or passing the far distance
+		std::vector<unsigned char> outOfSteps;
+		//How far along the ray the hit was, ImplicitSceneSdf::MaxDistance for a miss
+		std::vector<float> depths;
+		//Where the ray started, from the cone passes or the temporal cache, before any rejected start went back
+		std::vector<float> startDepths;
+
+		unsigned int GetOutOfStepsCount() const;
+		//Blue through green to red for more steps, magenta where the ray ran out, the same as MARCH_INSTRUMENTATION in
+		//ImplicitRayModelsPS.hlsl
+		void WriteHeatmap(HeadlessImage& image) const;
+	};
+
+	//Last frame's hits, which the next frame's rays start just short of when the camera hasn't moved much. Render reads it
+	//before marching and fills it in as it goes, one entry per pixel row by row
+	struct ImplicitRayMarcherCache
+	{
+		//Where the pixel's ray didn't hit anything
+		static const unsigned char NoObject = 0xFF;
+
+		ImplicitRayMarcherCache() : margin(0.02f), width(0), height(0) {}
+
+		//Empties the cache, so the next frame marches every ray in full
+		void Reset() { depths.clear(); objects.clear(); steps.clear(); width = 0; height = 0; }
+		bool IsValid() const { return width > 0 && height > 0 && depths.size() == width * height; }
+
+		//Fraction of the reprojected depth the rays start short of it, for the surfaces between the old hits
+		float margin;
+
+		//The view the hits were found from
+		DirectX::XMFLOAT4X4 view;
+		unsigned int width;
+		unsigned int height;
+		//How far along the ray the hit was, ImplicitSceneSdf::MaxDistance for a miss
+		std::vector<float> depths;
+		//ImplicitSceneSdf's object the ray hit, NoObject for a miss. Only hits on static objects are reprojected
+		std::vector<unsigned char> objects;
+		//Scene evaluations marching the pixel's ray
+		std::vector<unsigned short> steps;
+	};
+
+	//Renders the ImplicitRayModels scene on the CPU the way ImplicitRayModelsPS.hlsl does on the GPU, one ray per pixel
+	//from the camera through a canvas one unit in front of it that is two units wide
+	class ImplicitRayMarcher
+	{
+	public:
+		explicit ImplicitRayMarcher(const ImplicitRayMarcherSettings& settings = ImplicitRayMarcherSettings());
+
+		const ImplicitRayMarcherSettings& GetSettings() const { return m_settings; }
+		void SetSettings(const ImplicitRayMarcherSettings& settings) { m_settings = settings; }
+
+		//view is the matrix the renderer gives the shader, so ImplicitRayModels and this see the same thing
+		//trace, when there is one, gets every ray's step count
+		//cache, when there is one, has last frame's hits reprojected into this frame to start the rays from, and gets
+		//this frame's hits for the next. The pixels of the animated objects are marched in full
+		//depthLimits, when there are some, are how far each ray can go before it's hidden by the rasterized scene. The
+		//rays stop there and leave the background, the way the shader's are discarded, and a cone that gets past the
+		//furthest limit under it leaves its rays nothing to march. They have to be the image's size
+		//history, when there is one, is last frame's image for checkerboard to reconstruct from, and gets this frame's.
+		//Its frame count alternates the pattern, without it the same half is marched every frame
+		ImplicitRayMarcherStats Render(const DirectX::XMMATRIX& view, float time, HeadlessImage& image, ImplicitRayMarcherTrace* trace = nullptr, ImplicitRayMarcherCache* cache = nullptr, const ImplicitDepthPyramid* depthLimits = nullptr, ImplicitCheckerboardHistory* history = nullptr) const;
+
+		//View matrix with the camera looking down -z at target, which is where the shader's rays go
+		static DirectX::XMMATRIX LookAt(const DirectX::XMFLOAT3& eye, const DirectX::XMFLOAT3& target);
+
+	private:
+		ImplicitRayMarcherSettings m_settings;
+	};
+}
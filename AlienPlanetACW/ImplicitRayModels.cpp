@@ -1,10 +1,19 @@
 #include "pch.h"
 #include "ImplicitRayModels.h"
+#include "ImplicitBilateralUpsampler.h"
+#include "ImplicitRayMarcher.h"
+#include "ImplicitSceneSdf.h"
+#include "ImplicitSceneTileBins.h"
 
 using namespace AlienPlanetACW;
 
-ImplicitRayModels::ImplicitRayModels(const std::shared_ptr<DX::DeviceResources>& deviceResources) : m_deviceResources(deviceResources), m_loadingComplete(false), m_indexCount(0)
+ImplicitRayModels::ImplicitRayModels(const std::shared_ptr<DX::DeviceResources>& deviceResources) : m_deviceResources(deviceResources), m_loadingComplete(false), m_indexCount(0), m_coneSeedsWidth(0), m_coneSeedsHeight(0), m_temporalCacheWidth(0), m_temporalCacheHeight(0), m_temporalFrame(0), m_temporalCacheValid(false), m_depthLimitsWidth(0), m_depthLimitsHeight(0), m_tileBinsCapacity(0), m_checkerboardWidth(0), m_checkerboardHeight(0), m_checkerboardHistory(0), m_scaledWidth(0), m_scaledHeight(0), m_mainPassTimer(deviceResources)
 {
+	m_timeBufferData.meshedObjects = 0;
+	m_timeBufferData.tileColumns = 0;
+	m_checkerboardBufferData.checkerboardFrame = 0;
+	m_checkerboardBufferData.historyValid = 0;
+
 	CreateDeviceDependentResources();
 }
 
@@ -64,13 +73,82 @@ void ImplicitRayModels::CreateDeviceDependentResources()
 
 		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateBuffer(&cameraBufferDescription, nullptr, &m_cameraBuffer));
 
-		CD3D11_BUFFER_DESC timeBufferDescription(sizeof(TotalTimeConstantBuffer), D3D11_BIND_CONSTANT_BUFFER);
+		CD3D11_BUFFER_DESC timeBufferDescription(sizeof(ImplicitSceneTimeConstantBuffer), D3D11_BIND_CONSTANT_BUFFER);
 
 		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateBuffer(&timeBufferDescription, nullptr, &m_timeBuffer));
+
+		if (UseSceneBytecode)
+		{
+			CD3D11_BUFFER_DESC sceneBytecodeBufferDescription(SceneBytecodeCapacity * sizeof(SdfInstruction), D3D11_BIND_SHADER_RESOURCE, D3D11_USAGE_DYNAMIC, D3D11_CPU_ACCESS_WRITE, D3D11_RESOURCE_MISC_BUFFER_STRUCTURED, sizeof(SdfInstruction));
+
+			DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateBuffer(&sceneBytecodeBufferDescription, nullptr, &m_sceneBytecodeBuffer));
+
+			CD3D11_SHADER_RESOURCE_VIEW_DESC sceneBytecodeViewDescription(m_sceneBytecodeBuffer.Get(), DXGI_FORMAT_UNKNOWN, 0, SceneBytecodeCapacity);
+
+			DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateShaderResourceView(m_sceneBytecodeBuffer.Get(), &sceneBytecodeViewDescription, &m_sceneBytecodeView));
+		}
 	});
 
+	//Only loaded when it's used, so the other shaders don't wait on it otherwise
+	auto createConePSTask = UseConeSeeds
+		? DX::ReadDataAsync(L"ImplicitRayConesPS.cso").then([this](const std::vector<byte>& fileData) {
+			DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreatePixelShader(&fileData[0], fileData.size(), nullptr, &m_conePixelShader));
+		})
+		: concurrency::create_task([]() {});
+
+	auto createReprojectTask = UseTemporalCache
+		? (DX::ReadDataAsync(L"ImplicitRayReprojectVS.cso").then([this](const std::vector<byte>& fileData) {
+			DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateVertexShader(&fileData[0], fileData.size(), nullptr, &m_reprojectVertexShader));
+		}) && DX::ReadDataAsync(L"ImplicitRayReprojectPS.cso").then([this](const std::vector<byte>& fileData) {
+			DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreatePixelShader(&fileData[0], fileData.size(), nullptr, &m_reprojectPixelShader));
+
+			D3D11_BLEND_DESC blendDescription = CD3D11_BLEND_DESC(D3D11_DEFAULT);
+			blendDescription.RenderTarget[0].BlendEnable = TRUE;
+			blendDescription.RenderTarget[0].SrcBlend = D3D11_BLEND_ONE;
+			blendDescription.RenderTarget[0].DestBlend = D3D11_BLEND_ONE;
+			blendDescription.RenderTarget[0].BlendOp = D3D11_BLEND_OP_MIN;
+			blendDescription.RenderTarget[0].SrcBlendAlpha = D3D11_BLEND_ONE;
+			blendDescription.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_ONE;
+			blendDescription.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_MIN;
+
+			DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateBlendState(&blendDescription, &m_minimumBlendState));
+		}))
+		: concurrency::create_task([]() {});
+
+	auto createDepthLimitsTask = UseDepthLimits
+		? (DX::ReadDataAsync(L"ImplicitDepthLimitsPS.cso").then([this](const std::vector<byte>& fileData) {
+			DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreatePixelShader(&fileData[0], fileData.size(), nullptr, &m_depthLimitsPixelShader));
+		}) && DX::ReadDataAsync(L"ImplicitDepthPyramidPS.cso").then([this](const std::vector<byte>& fileData) {
+			DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreatePixelShader(&fileData[0], fileData.size(), nullptr, &m_depthPyramidPixelShader));
+		}))
+		: concurrency::create_task([]() {});
+
+	auto createCheckerboardTask = UseCheckerboard
+		? (DX::ReadDataAsync(L"ImplicitCheckerboardResolvePS.cso").then([this](const std::vector<byte>& fileData) {
+			DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreatePixelShader(&fileData[0], fileData.size(), nullptr, &m_checkerboardResolvePixelShader));
+
+			CD3D11_BUFFER_DESC checkerboardBufferDescription(sizeof(ImplicitCheckerboardConstantBuffer), D3D11_BIND_CONSTANT_BUFFER);
+
+			DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateBuffer(&checkerboardBufferDescription, nullptr, &m_checkerboardBuffer));
+		}) && DX::ReadDataAsync(L"ImplicitCheckerboardCompositePS.cso").then([this](const std::vector<byte>& fileData) {
+			DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreatePixelShader(&fileData[0], fileData.size(), nullptr, &m_checkerboardCompositePixelShader));
+		}))
+		: concurrency::create_task([]() {});
+
+	auto createUpsampleTask = UseDynamicResolution
+		? DX::ReadDataAsync(L"ImplicitUpsamplePS.cso").then([this](const std::vector<byte>& fileData) {
+			DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreatePixelShader(&fileData[0], fileData.size(), nullptr, &m_upsamplePixelShader));
+
+			CD3D11_BUFFER_DESC dynamicResolutionBufferDescription(sizeof(ImplicitDynamicResolutionConstantBuffer), D3D11_BIND_CONSTANT_BUFFER);
+
+			DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateBuffer(&dynamicResolutionBufferDescription, nullptr, &m_dynamicResolutionBuffer));
+
+			m_mainPassTimer.CreateDeviceDependentResources();
+		})
+		: concurrency::create_task([]() {});
+
 	// Once both shaders are loaded, create the mesh.
-	auto createGrassPoints = (createPSTask && createVSTask).then([this]() {
+	auto createGrassPoints = (createPSTask && createVSTask && createConePSTask && createReprojectTask && createDepthLimitsTask && createCheckerboardTask && createUpsampleTask).then([this]() {
 
 		// Load mesh vertices. Each vertex has a position and a color.
 		static const VertexPosition quadVertices[] =
@@ -139,6 +217,11 @@ void ImplicitRayModels::SetCameraPositionConstantBuffer(DirectX::XMFLOAT3& camer
 	m_cameraBufferData.position = cameraPosition;
 }
 
+void ImplicitRayModels::SetMeshedObjects(unsigned int meshedObjects)
+{
+	m_timeBufferData.meshedObjects = meshedObjects;
+}
+
 void ImplicitRayModels::ReleaseDeviceDependentResources()
 {
 	m_loadingComplete = false;
@@ -148,6 +231,91 @@ void ImplicitRayModels::ReleaseDeviceDependentResources()
 	m_MVPBuffer.Reset();
 	m_inverseViewBuffer.Reset();
 	m_cameraBuffer.Reset();
+	m_sceneBytecodeView.Reset();
+	m_sceneBytecodeBuffer.Reset();
+	m_conePixelShader.Reset();
+
+	for (auto level = 0u; level < ConeLevels; level++)
+	{
+		m_coneSeedViews[level].Reset();
+		m_coneSeedTargets[level].Reset();
+		m_coneSeeds[level].Reset();
+	}
+
+	m_coneSeedsWidth = 0;
+	m_coneSeedsHeight = 0;
+	m_reprojectVertexShader.Reset();
+	m_reprojectPixelShader.Reset();
+	m_minimumBlendState.Reset();
+
+	for (auto frame = 0u; frame < 2; frame++)
+	{
+		m_temporalHitViews[frame].Reset();
+		m_temporalHitTargets[frame].Reset();
+		m_temporalHits[frame].Reset();
+	}
+
+	m_reprojectedDepthsView.Reset();
+	m_reprojectedDepthsTarget.Reset();
+	m_reprojectedDepths.Reset();
+	m_temporalCacheWidth = 0;
+	m_temporalCacheHeight = 0;
+	m_temporalCacheValid = false;
+	m_depthLimitsPixelShader.Reset();
+	m_depthPyramidPixelShader.Reset();
+	m_rasterDepthView.Reset();
+	m_rasterDepth.Reset();
+	m_depthLimitsView.Reset();
+	m_depthLimitsTarget.Reset();
+	m_depthLimits.Reset();
+
+	for (auto level = 0u; level < DepthPyramidLevels; level++)
+	{
+		m_depthPyramidViews[level].Reset();
+		m_depthPyramidTargets[level].Reset();
+		m_depthPyramid[level].Reset();
+	}
+
+	m_depthLimitsWidth = 0;
+	m_depthLimitsHeight = 0;
+	m_tileBinsView.Reset();
+	m_tileBinsBuffer.Reset();
+	m_tileBinsCapacity = 0;
+	m_checkerboardResolvePixelShader.Reset();
+	m_checkerboardCompositePixelShader.Reset();
+	m_checkerboardBuffer.Reset();
+	m_checkerboardColoursView.Reset();
+	m_checkerboardColoursTarget.Reset();
+	m_checkerboardColours.Reset();
+	m_checkerboardHitsView.Reset();
+	m_checkerboardHitsTarget.Reset();
+	m_checkerboardHits.Reset();
+
+	for (auto frame = 0u; frame < 2; frame++)
+	{
+		m_checkerboardHistoryColourViews[frame].Reset();
+		m_checkerboardHistoryColourTargets[frame].Reset();
+		m_checkerboardHistoryColours[frame].Reset();
+		m_checkerboardHistoryHitViews[frame].Reset();
+		m_checkerboardHistoryHitTargets[frame].Reset();
+		m_checkerboardHistoryHits[frame].Reset();
+	}
+
+	m_checkerboardWidth = 0;
+	m_checkerboardHeight = 0;
+	m_checkerboardBufferData.historyValid = 0;
+	m_upsamplePixelShader.Reset();
+	m_dynamicResolutionBuffer.Reset();
+	m_scaledColoursView.Reset();
+	m_scaledColoursTarget.Reset();
+	m_scaledColours.Reset();
+	m_scaledDistancesView.Reset();
+	m_scaledDistancesTarget.Reset();
+	m_scaledDistances.Reset();
+	m_scaledWidth = 0;
+	m_scaledHeight = 0;
+	m_resolutionController.Reset();
+	m_mainPassTimer.ReleaseDeviceDependentResources();
 	m_vertexBuffer.Reset();
 	m_indexBuffer.Reset();
 }
@@ -156,7 +324,57 @@ void ImplicitRayModels::Update(DX::StepTimer const& timer)
 {
 	DirectX::XMStoreFloat4x4(&m_MVPBufferData.model, DirectX::XMMatrixTranspose(DirectX::XMMatrixIdentity()));
 
-	m_timeBufferData.time = timer.GetTotalSeconds();
+	//Once a frame here rather than at every sample in the shader
+	const auto parameters = ImplicitSceneParameters::FromTime(static_cast<float>(timer.GetTotalSeconds()));
+
+	m_timeBufferData.time = parameters.time;
+	m_timeBufferData.morph = parameters.morph;
+	m_timeBufferData.beamLength = parameters.beamLength;
+	m_timeBufferData.wobble = parameters.wobble;
+	m_timeBufferData.shipPosition = DirectX::XMFLOAT3(parameters.shipPosition.x, parameters.shipPosition.y, parameters.shipPosition.z);
+	m_timeBufferData.alienEyeHeight = parameters.alienEyeHeight;
+	m_timeBufferData.beamPosition = DirectX::XMFLOAT3(parameters.beamPosition.x, parameters.beamPosition.y, parameters.beamPosition.z);
+	m_timeBufferData.alienMouth = parameters.alienMouth;
+	m_timeBufferData.dripHeights = DirectX::XMFLOAT3(parameters.dripHeights[0], parameters.dripHeights[1], parameters.dripHeights[2]);
+	m_timeBufferData.alienArm = parameters.alienArm;
+	m_timeBufferData.mandelbulbColour = DirectX::XMFLOAT3(parameters.mandelbulbColour.x, parameters.mandelbulbColour.y, parameters.mandelbulbColour.z);
+	m_timeBufferData.mandelbulbPower = parameters.mandelbulbPower;
+
+	for (auto row = 0; row < 3; row++)
+	{
+		m_timeBufferData.mandelbulbRotation[row] = DirectX::XMFLOAT4(parameters.mandelbulbRotation[row][0], parameters.mandelbulbRotation[row][1], parameters.mandelbulbRotation[row][2], 0.0f);
+	}
+
+	if (UseTileBinning)
+	{
+		m_objectBounds = ImplicitSceneHierarchy::GetObjectBounds(parameters);
+	}
+
+	//The newest main pass the GPU has finished picks this frame's scale. The frame time can't, with vsync it's the
+	//refresh interval however quick the pass gets, so the scale would never go back up
+	if (UseDynamicResolution)
+	{
+		auto milliseconds = 0.0f;
+
+		if (m_mainPassTimer.GetMilliseconds(milliseconds))
+		{
+			m_resolutionController.Update(milliseconds);
+		}
+	}
+
+	if (UseSceneBytecode)
+	{
+		SdfSceneGraph sceneGraph;
+		const auto scene = ImplicitSceneSdf::BuildSceneGraph(parameters, sceneGraph);
+
+		//Keeps last frame's program if this one doesn't compile or fit
+		SdfProgram program;
+
+		if (sceneGraph.Compile(scene, program) && program.GetInstructions().size() <= SceneBytecodeCapacity)
+		{
+			m_sceneProgram = program;
+		}
+	}
 }
 
 void ImplicitRayModels::Render()
@@ -169,6 +387,16 @@ void ImplicitRayModels::Render()
 
 	auto context = m_deviceResources->GetD3DDeviceContext();
 
+	//Before the time buffer goes up, which has the number of squares in a row
+	if (UseTileBinning)
+	{
+		auto viewportCount = 1u;
+		D3D11_VIEWPORT viewport;
+		context->RSGetViewports(&viewportCount, &viewport);
+
+		UploadTileBins(viewport);
+	}
+
 	// Prepare constant buffers to send it to the graphics device.
 	context->UpdateSubresource1(
 		m_MVPBuffer.Get(),
@@ -301,6 +529,80 @@ void ImplicitRayModels::Render()
 		nullptr
 	);
 
+	//Before the scene's bytecode is bound, the passes read what they're given from the same slot
+	if (UseDepthLimits)
+	{
+		auto viewportCount = 1u;
+		D3D11_VIEWPORT viewport;
+		context->RSGetViewports(&viewportCount, &viewport);
+
+		RenderDepthLimits(viewport);
+	}
+
+	//The rest of the buffer past Return is never read
+	if (UseSceneBytecode && !m_sceneProgram.GetInstructions().empty())
+	{
+		D3D11_MAPPED_SUBRESOURCE mappedResource;
+
+		DX::ThrowIfFailed(context->Map(m_sceneBytecodeBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource));
+		memcpy(mappedResource.pData, m_sceneProgram.GetInstructions().data(), m_sceneProgram.GetInstructions().size() * sizeof(SdfInstruction));
+		context->Unmap(m_sceneBytecodeBuffer.Get(), 0);
+
+		context->PSSetShaderResources(0, 1, m_sceneBytecodeView.GetAddressOf());
+	}
+
+	if (UseConeSeeds)
+	{
+		auto viewportCount = 1u;
+		D3D11_VIEWPORT viewport;
+		context->RSGetViewports(&viewportCount, &viewport);
+
+		RenderConePasses(viewport);
+	}
+
+	Microsoft::WRL::ComPtr<ID3D11RenderTargetView> renderTarget;
+	Microsoft::WRL::ComPtr<ID3D11DepthStencilView> depthStencil;
+
+	if (UseTemporalCache)
+	{
+		auto viewportCount = 1u;
+		D3D11_VIEWPORT viewport;
+		context->RSGetViewports(&viewportCount, &viewport);
+
+		RenderReprojection(viewport);
+
+		//The hits go to the second target alongside the colour
+		context->OMGetRenderTargets(1, &renderTarget, &depthStencil);
+
+		ID3D11RenderTargetView* const targets[] = { renderTarget.Get(), m_temporalHitTargets[m_temporalFrame].Get() };
+		context->OMSetRenderTargets(2, targets, depthStencil.Get());
+	}
+
+	//The full screen's, which checkerboard and dynamic resolution swap for a smaller one for the main pass
+	D3D11_VIEWPORT screenViewport = {};
+
+	if (UseCheckerboard)
+	{
+		auto viewportCount = 1u;
+		context->RSGetViewports(&viewportCount, &screenViewport);
+
+		//Put back once the finished image is drawn over the scene
+		context->OMGetRenderTargets(1, &renderTarget, &depthStencil);
+
+		BeginCheckerboard(screenViewport);
+	}
+
+	if (UseDynamicResolution)
+	{
+		auto viewportCount = 1u;
+		context->RSGetViewports(&viewportCount, &screenViewport);
+
+		//Put back to draw the upsampled image over the scene
+		context->OMGetRenderTargets(1, &renderTarget, &depthStencil);
+
+		BeginDynamicResolution(screenViewport);
+	}
+
 	// Attach our pixel shader.
 	context->PSSetShader(
 		m_pixelShader.Get(),
@@ -308,10 +610,511 @@ void ImplicitRayModels::Render()
 		0
 	);
 
+	if (UseDynamicResolution)
+	{
+		m_mainPassTimer.Begin();
+	}
+
 	// Draw the objects.
 	context->DrawIndexed(
 		m_indexCount,
 		0,
 		0
 	);
-}
\ No newline at end of file
+
+	if (UseDynamicResolution)
+	{
+		m_mainPassTimer.End();
+	}
+
+	//While the depth limits are still bound, the reconstructed hits stop at them too
+	if (UseCheckerboard)
+	{
+		ResolveCheckerboard(screenViewport, renderTarget.Get(), depthStencil.Get());
+	}
+
+	if (UseDynamicResolution)
+	{
+		RenderUpsampling(screenViewport, renderTarget.Get(), depthStencil.Get());
+	}
+
+	if (UseDepthLimits)
+	{
+		//Written again by the next frame's passes
+		ID3D11ShaderResourceView* const noLimits[] = { nullptr };
+
+		context->PSSetShaderResources(3, 1, noLimits);
+	}
+
+	if (UseTileBinning)
+	{
+		ID3D11ShaderResourceView* const noBins[] = { nullptr };
+
+		context->PSSetShaderResources(5, 1, noBins);
+	}
+
+	if (UseTemporalCache)
+	{
+		//This frame's hits are read by the next frame's reprojection, and its distances are written again then
+		ID3D11ShaderResourceView* const noDepths[] = { nullptr };
+
+		context->OMSetRenderTargets(1, renderTarget.GetAddressOf(), depthStencil.Get());
+		context->PSSetShaderResources(2, 1, noDepths);
+
+		m_temporalFrame = 1 - m_temporalFrame;
+		m_temporalCacheValid = true;
+	}
+}
+
+void ImplicitRayModels::CreateConeSeeds(const unsigned int width, const unsigned int height)
+{
+	for (auto level = 0u; level < ConeLevels; level++)
+	{
+		const auto squareSize = ConeTileSize >> level;
+
+		//A square that only partly covers the screen still gets a depth
+		CD3D11_TEXTURE2D_DESC seedsDescription(DXGI_FORMAT_R32_FLOAT, (width + squareSize - 1) / squareSize, (height + squareSize - 1) / squareSize, 1, 1, D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE);
+
+		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateTexture2D(&seedsDescription, nullptr, &m_coneSeeds[level]));
+		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateRenderTargetView(m_coneSeeds[level].Get(), nullptr, &m_coneSeedTargets[level]));
+		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateShaderResourceView(m_coneSeeds[level].Get(), nullptr, &m_coneSeedViews[level]));
+	}
+
+	m_coneSeedsWidth = width;
+	m_coneSeedsHeight = height;
+}
+
+void ImplicitRayModels::RenderConePasses(const D3D11_VIEWPORT& viewport)
+{
+	auto context = m_deviceResources->GetD3DDeviceContext();
+
+	const auto width = static_cast<unsigned int>(viewport.Width);
+	const auto height = static_cast<unsigned int>(viewport.Height);
+
+	if (width != m_coneSeedsWidth || height != m_coneSeedsHeight)
+	{
+		CreateConeSeeds(width, height);
+	}
+
+	Microsoft::WRL::ComPtr<ID3D11RenderTargetView> renderTarget;
+	Microsoft::WRL::ComPtr<ID3D11DepthStencilView> depthStencil;
+	context->OMGetRenderTargets(1, &renderTarget, &depthStencil);
+
+	context->PSSetShader(m_conePixelShader.Get(), nullptr, 0);
+
+	ID3D11ShaderResourceView* const noSeeds[] = { nullptr };
+	const float noDepth[] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+	for (auto level = 0u; level < ConeLevels; level++)
+	{
+		const auto squareSize = static_cast<float>(ConeTileSize >> level);
+
+		//Squares past the edge of the quad are never drawn and start their rays at the camera
+		context->ClearRenderTargetView(m_coneSeedTargets[level].Get(), noDepth);
+
+		//A viewport of the screen's size in squares, so the quad's canvas lines up with the full resolution pass and the
+		//derivatives in the shader are a square across
+		const auto coneViewport = CD3D11_VIEWPORT(0.0f, 0.0f, viewport.Width / squareSize, viewport.Height / squareSize);
+		context->RSSetViewports(1, &coneViewport);
+
+		//The first level has no parent, and an unbound texture reads as zero
+		context->PSSetShaderResources(1, 1, level > 0 ? m_coneSeedViews[level - 1].GetAddressOf() : noSeeds);
+		context->OMSetRenderTargets(1, m_coneSeedTargets[level].GetAddressOf(), nullptr);
+
+		if (UseDepthLimits)
+		{
+			//The pyramid's squares are 2 << level pixels across, the cones' start at ConeTileSize and halve
+			context->PSSetShaderResources(4, 1, m_depthPyramidViews[DepthPyramidLevels - 1 - level].GetAddressOf());
+		}
+
+		context->DrawIndexed(m_indexCount, 0, 0);
+
+		//Unbound before it's read by the next level
+		context->OMSetRenderTargets(0, nullptr, nullptr);
+	}
+
+	context->RSSetViewports(1, &viewport);
+	context->OMSetRenderTargets(1, renderTarget.GetAddressOf(), depthStencil.Get());
+	context->PSSetShaderResources(1, 1, m_coneSeedViews[ConeLevels - 1].GetAddressOf());
+	context->PSSetShaderResources(4, 1, noSeeds);
+}
+
+void ImplicitRayModels::CreateTemporalCache(const unsigned int width, const unsigned int height)
+{
+	CD3D11_TEXTURE2D_DESC hitsDescription(DXGI_FORMAT_R32G32B32A32_FLOAT, width, height, 1, 1, D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE);
+
+	for (auto frame = 0u; frame < 2; frame++)
+	{
+		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateTexture2D(&hitsDescription, nullptr, &m_temporalHits[frame]));
+		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateRenderTargetView(m_temporalHits[frame].Get(), nullptr, &m_temporalHitTargets[frame]));
+		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateShaderResourceView(m_temporalHits[frame].Get(), nullptr, &m_temporalHitViews[frame]));
+	}
+
+	CD3D11_TEXTURE2D_DESC depthsDescription(DXGI_FORMAT_R32_FLOAT, width, height, 1, 1, D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE);
+
+	DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateTexture2D(&depthsDescription, nullptr, &m_reprojectedDepths));
+	DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateRenderTargetView(m_reprojectedDepths.Get(), nullptr, &m_reprojectedDepthsTarget));
+	DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateShaderResourceView(m_reprojectedDepths.Get(), nullptr, &m_reprojectedDepthsView));
+
+	m_temporalCacheWidth = width;
+	m_temporalCacheHeight = height;
+	m_temporalFrame = 0;
+	m_temporalCacheValid = false;
+}
+
+void ImplicitRayModels::RenderReprojection(const D3D11_VIEWPORT& viewport)
+{
+	auto context = m_deviceResources->GetD3DDeviceContext();
+
+	const auto width = static_cast<unsigned int>(viewport.Width);
+	const auto height = static_cast<unsigned int>(viewport.Height);
+
+	if (width != m_temporalCacheWidth || height != m_temporalCacheHeight)
+	{
+		CreateTemporalCache(width, height);
+	}
+
+	//Pixels nothing lands in march from the start, and this frame's misses are discarded so they keep no hit
+	const float noDepth[] = { ImplicitSceneSdf::MaxDistance, ImplicitSceneSdf::MaxDistance, ImplicitSceneSdf::MaxDistance, ImplicitSceneSdf::MaxDistance };
+	const float noHit[] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+	context->ClearRenderTargetView(m_reprojectedDepthsTarget.Get(), noDepth);
+	context->ClearRenderTargetView(m_temporalHitTargets[m_temporalFrame].Get(), noHit);
+
+	if (m_temporalCacheValid)
+	{
+		Microsoft::WRL::ComPtr<ID3D11RenderTargetView> renderTarget;
+		Microsoft::WRL::ComPtr<ID3D11DepthStencilView> depthStencil;
+		context->OMGetRenderTargets(1, &renderTarget, &depthStencil);
+
+		Microsoft::WRL::ComPtr<ID3D11BlendState> blendState;
+		float blendFactor[4];
+		UINT sampleMask;
+		context->OMGetBlendState(&blendState, blendFactor, &sampleMask);
+
+		//One point per pixel of last frame's hits, placed from SV_VertexID so there's no vertex buffer
+		context->IASetInputLayout(nullptr);
+		context->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_POINTLIST);
+		context->VSSetShader(m_reprojectVertexShader.Get(), nullptr, 0);
+		context->VSSetConstantBuffers1(1, 1, m_inverseViewBuffer.GetAddressOf(), nullptr, nullptr);
+		context->VSSetShaderResources(0, 1, m_temporalHitViews[1 - m_temporalFrame].GetAddressOf());
+		context->PSSetShader(m_reprojectPixelShader.Get(), nullptr, 0);
+		context->OMSetBlendState(m_minimumBlendState.Get(), nullptr, 0xFFFFFFFF);
+		context->OMSetRenderTargets(1, m_reprojectedDepthsTarget.GetAddressOf(), nullptr);
+
+		context->Draw(width * height, 0);
+
+		ID3D11ShaderResourceView* const noHits[] = { nullptr };
+
+		context->VSSetShaderResources(0, 1, noHits);
+		context->OMSetBlendState(blendState.Get(), blendFactor, sampleMask);
+		context->OMSetRenderTargets(1, renderTarget.GetAddressOf(), depthStencil.Get());
+		context->IASetInputLayout(m_inputLayout.Get());
+		context->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+		context->VSSetShader(m_vertexShader.Get(), nullptr, 0);
+	}
+
+	context->PSSetShaderResources(2, 1, m_reprojectedDepthsView.GetAddressOf());
+}
+
+void ImplicitRayModels::CreateDepthLimits(const D3D11_TEXTURE2D_DESC& depthBufferDescription)
+{
+	const auto width = depthBufferDescription.Width;
+	const auto height = depthBufferDescription.Height;
+
+	//The same as the depth buffer so it can be copied, but typeless so the depth can be read as well
+	CD3D11_TEXTURE2D_DESC rasterDepthDescription(DXGI_FORMAT_R24G8_TYPELESS, width, height, 1, 1, D3D11_BIND_SHADER_RESOURCE);
+	CD3D11_SHADER_RESOURCE_VIEW_DESC rasterDepthViewDescription(D3D11_SRV_DIMENSION_TEXTURE2D, DXGI_FORMAT_R24_UNORM_X8_TYPELESS);
+
+	DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateTexture2D(&rasterDepthDescription, nullptr, &m_rasterDepth));
+	DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateShaderResourceView(m_rasterDepth.Get(), &rasterDepthViewDescription, &m_rasterDepthView));
+
+	CD3D11_TEXTURE2D_DESC limitsDescription(DXGI_FORMAT_R32_FLOAT, width, height, 1, 1, D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE);
+
+	DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateTexture2D(&limitsDescription, nullptr, &m_depthLimits));
+	DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateRenderTargetView(m_depthLimits.Get(), nullptr, &m_depthLimitsTarget));
+	DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateShaderResourceView(m_depthLimits.Get(), nullptr, &m_depthLimitsView));
+
+	for (auto level = 0u; level < DepthPyramidLevels; level++)
+	{
+		const auto squareSize = 2u << level;
+
+		//A square that only partly covers the screen takes the limits it does cover
+		CD3D11_TEXTURE2D_DESC pyramidDescription(DXGI_FORMAT_R32_FLOAT, (width + squareSize - 1) / squareSize, (height + squareSize - 1) / squareSize, 1, 1, D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE);
+
+		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateTexture2D(&pyramidDescription, nullptr, &m_depthPyramid[level]));
+		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateRenderTargetView(m_depthPyramid[level].Get(), nullptr, &m_depthPyramidTargets[level]));
+		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateShaderResourceView(m_depthPyramid[level].Get(), nullptr, &m_depthPyramidViews[level]));
+	}
+
+	m_depthLimitsWidth = width;
+	m_depthLimitsHeight = height;
+}
+
+void ImplicitRayModels::RenderDepthLimits(const D3D11_VIEWPORT& viewport)
+{
+	auto context = m_deviceResources->GetD3DDeviceContext();
+
+	Microsoft::WRL::ComPtr<ID3D11RenderTargetView> renderTarget;
+	Microsoft::WRL::ComPtr<ID3D11DepthStencilView> depthStencil;
+	context->OMGetRenderTargets(1, &renderTarget, &depthStencil);
+
+	Microsoft::WRL::ComPtr<ID3D11Resource> depthBuffer;
+	depthStencil->GetResource(&depthBuffer);
+
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> depthTexture;
+	DX::ThrowIfFailed(depthBuffer.As(&depthTexture));
+
+	D3D11_TEXTURE2D_DESC depthBufferDescription;
+	depthTexture->GetDesc(&depthBufferDescription);
+
+	if (depthBufferDescription.Width != m_depthLimitsWidth || depthBufferDescription.Height != m_depthLimitsHeight)
+	{
+		CreateDepthLimits(depthBufferDescription);
+	}
+
+	//Everything drawn before the rays, copied because the depth buffer can't be read while it's bound
+	context->CopyResource(m_rasterDepth.Get(), depthTexture.Get());
+
+	ID3D11ShaderResourceView* const noLimits[] = { nullptr };
+
+	context->PSSetShader(m_depthLimitsPixelShader.Get(), nullptr, 0);
+	context->OMSetRenderTargets(1, m_depthLimitsTarget.GetAddressOf(), nullptr);
+	context->PSSetShaderResources(0, 1, m_rasterDepthView.GetAddressOf());
+
+	context->DrawIndexed(m_indexCount, 0, 0);
+
+	context->PSSetShader(m_depthPyramidPixelShader.Get(), nullptr, 0);
+
+	for (auto level = 0u; level < DepthPyramidLevels; level++)
+	{
+		D3D11_TEXTURE2D_DESC pyramidDescription;
+		m_depthPyramid[level]->GetDesc(&pyramidDescription);
+
+		//One pixel per square, so the quad covers every square that's partly on the screen
+		const auto pyramidViewport = CD3D11_VIEWPORT(0.0f, 0.0f, static_cast<float>(pyramidDescription.Width), static_cast<float>(pyramidDescription.Height));
+		context->RSSetViewports(1, &pyramidViewport);
+
+		//The target is unbound from the level before before it's read
+		context->OMSetRenderTargets(1, m_depthPyramidTargets[level].GetAddressOf(), nullptr);
+		context->PSSetShaderResources(0, 1, level > 0 ? m_depthPyramidViews[level - 1].GetAddressOf() : m_depthLimitsView.GetAddressOf());
+
+		context->DrawIndexed(m_indexCount, 0, 0);
+	}
+
+	context->PSSetShaderResources(0, 1, noLimits);
+	context->RSSetViewports(1, &viewport);
+	context->OMSetRenderTargets(1, renderTarget.GetAddressOf(), depthStencil.Get());
+	context->PSSetShaderResources(3, 1, m_depthLimitsView.GetAddressOf());
+}
+
+void ImplicitRayModels::UploadTileBins(const D3D11_VIEWPORT& viewport)
+{
+	auto context = m_deviceResources->GetD3DDeviceContext();
+
+	//Binned from the same camera the rays are
+	const auto inverseView = DirectX::XMMatrixTranspose(DirectX::XMLoadFloat4x4(&m_inverseViewBufferData.inverseView));
+	const ImplicitSceneTileBins bins(m_objectBounds, DirectX::XMMatrixInverse(nullptr, inverseView), static_cast<unsigned int>(viewport.Width), static_cast<unsigned int>(viewport.Height), TileBinSize);
+
+	const auto& tileObjects = bins.GetTileObjects();
+
+	if (tileObjects.size() > m_tileBinsCapacity)
+	{
+		const auto capacity = static_cast<unsigned int>(tileObjects.size());
+
+		CD3D11_BUFFER_DESC tileBinsBufferDescription(capacity * sizeof(unsigned int), D3D11_BIND_SHADER_RESOURCE, D3D11_USAGE_DYNAMIC, D3D11_CPU_ACCESS_WRITE, D3D11_RESOURCE_MISC_BUFFER_STRUCTURED, sizeof(unsigned int));
+
+		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateBuffer(&tileBinsBufferDescription, nullptr, &m_tileBinsBuffer));
+
+		CD3D11_SHADER_RESOURCE_VIEW_DESC tileBinsViewDescription(m_tileBinsBuffer.Get(), DXGI_FORMAT_UNKNOWN, 0, capacity);
+
+		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateShaderResourceView(m_tileBinsBuffer.Get(), &tileBinsViewDescription, &m_tileBinsView));
+
+		m_tileBinsCapacity = capacity;
+	}
+
+	if (tileObjects.empty())
+	{
+		return;
+	}
+
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+
+	DX::ThrowIfFailed(context->Map(m_tileBinsBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource));
+	memcpy(mappedResource.pData, tileObjects.data(), tileObjects.size() * sizeof(unsigned int));
+	context->Unmap(m_tileBinsBuffer.Get(), 0);
+
+	m_timeBufferData.tileColumns = bins.GetColumns();
+
+	context->PSSetShaderResources(5, 1, m_tileBinsView.GetAddressOf());
+}
+
+void ImplicitRayModels::CreateCheckerboard(const unsigned int width, const unsigned int height)
+{
+	//A column of texels per two pixels, the odd one at the edge included
+	CD3D11_TEXTURE2D_DESC coloursDescription(DXGI_FORMAT_R16G16B16A16_FLOAT, (width + 1) / 2, height, 1, 1, D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE);
+	CD3D11_TEXTURE2D_DESC hitsDescription(DXGI_FORMAT_R32G32_FLOAT, (width + 1) / 2, height, 1, 1, D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE);
+
+	DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateTexture2D(&coloursDescription, nullptr, &m_checkerboardColours));
+	DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateRenderTargetView(m_checkerboardColours.Get(), nullptr, &m_checkerboardColoursTarget));
+	DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateShaderResourceView(m_checkerboardColours.Get(), nullptr, &m_checkerboardColoursView));
+	DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateTexture2D(&hitsDescription, nullptr, &m_checkerboardHits));
+	DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateRenderTargetView(m_checkerboardHits.Get(), nullptr, &m_checkerboardHitsTarget));
+	DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateShaderResourceView(m_checkerboardHits.Get(), nullptr, &m_checkerboardHitsView));
+
+	coloursDescription.Width = width;
+	hitsDescription.Width = width;
+
+	for (auto frame = 0u; frame < 2; frame++)
+	{
+		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateTexture2D(&coloursDescription, nullptr, &m_checkerboardHistoryColours[frame]));
+		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateRenderTargetView(m_checkerboardHistoryColours[frame].Get(), nullptr, &m_checkerboardHistoryColourTargets[frame]));
+		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateShaderResourceView(m_checkerboardHistoryColours[frame].Get(), nullptr, &m_checkerboardHistoryColourViews[frame]));
+		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateTexture2D(&hitsDescription, nullptr, &m_checkerboardHistoryHits[frame]));
+		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateRenderTargetView(m_checkerboardHistoryHits[frame].Get(), nullptr, &m_checkerboardHistoryHitTargets[frame]));
+		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateShaderResourceView(m_checkerboardHistoryHits[frame].Get(), nullptr, &m_checkerboardHistoryHitViews[frame]));
+	}
+
+	m_checkerboardWidth = width;
+	m_checkerboardHeight = height;
+	m_checkerboardHistory = 0;
+	m_checkerboardBufferData.historyValid = 0;
+}
+
+void ImplicitRayModels::BeginCheckerboard(const D3D11_VIEWPORT& viewport)
+{
+	auto context = m_deviceResources->GetD3DDeviceContext();
+
+	const auto width = static_cast<unsigned int>(viewport.Width);
+	const auto height = static_cast<unsigned int>(viewport.Height);
+
+	if (width != m_checkerboardWidth || height != m_checkerboardHeight)
+	{
+		CreateCheckerboard(width, height);
+	}
+
+	m_checkerboardBufferData.previousView = m_previousView;
+	m_checkerboardBufferData.screenSize = DirectX::XMFLOAT2(viewport.Width, viewport.Height);
+
+	context->UpdateSubresource1(m_checkerboardBuffer.Get(), 0, NULL, &m_checkerboardBufferData, 0, 0, 0);
+	context->PSSetConstantBuffers1(4, 1, m_checkerboardBuffer.GetAddressOf(), nullptr, nullptr);
+
+	//Misses are discarded, so they keep no hit
+	const float noColour[] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	const float noHit[] = { ImplicitSceneSdf::MaxDistance, static_cast<float>(ImplicitRayMarcherCache::NoObject), 0.0f, 0.0f };
+
+	context->ClearRenderTargetView(m_checkerboardColoursTarget.Get(), noColour);
+	context->ClearRenderTargetView(m_checkerboardHitsTarget.Get(), noHit);
+
+	//The hits are depth tested against the depth limits rather than the depth buffer, which is a different size
+	const auto marchedViewport = CD3D11_VIEWPORT(viewport.TopLeftX, viewport.TopLeftY, static_cast<float>((width + 1) / 2), viewport.Height);
+	ID3D11RenderTargetView* const targets[] = { m_checkerboardColoursTarget.Get(), m_checkerboardHitsTarget.Get() };
+
+	context->RSSetViewports(1, &marchedViewport);
+	context->OMSetRenderTargets(2, targets, nullptr);
+}
+
+void ImplicitRayModels::ResolveCheckerboard(const D3D11_VIEWPORT& viewport, ID3D11RenderTargetView* const renderTarget, ID3D11DepthStencilView* const depthStencil)
+{
+	auto context = m_deviceResources->GetD3DDeviceContext();
+
+	ID3D11ShaderResourceView* const noTextures[] = { nullptr, nullptr, nullptr, nullptr, nullptr };
+	ID3D11RenderTargetView* const historyTargets[] = { m_checkerboardHistoryColourTargets[m_checkerboardHistory].Get(), m_checkerboardHistoryHitTargets[m_checkerboardHistory].Get() };
+	ID3D11ShaderResourceView* const resolveTextures[] = { m_checkerboardColoursView.Get(), m_checkerboardHitsView.Get(), m_checkerboardHistoryColourViews[1 - m_checkerboardHistory].Get(), m_checkerboardHistoryHitViews[1 - m_checkerboardHistory].Get(), UseDepthLimits ? m_depthLimitsView.Get() : nullptr };
+
+	//Unbound as targets before they're read
+	context->OMSetRenderTargets(2, historyTargets, nullptr);
+	context->RSSetViewports(1, &viewport);
+	context->PSSetShader(m_checkerboardResolvePixelShader.Get(), nullptr, 0);
+	context->PSSetShaderResources(0, 5, resolveTextures);
+
+	context->DrawIndexed(m_indexCount, 0, 0);
+
+	ID3D11ShaderResourceView* const compositeTextures[] = { m_checkerboardHistoryColourViews[m_checkerboardHistory].Get(), m_checkerboardHistoryHitViews[m_checkerboardHistory].Get() };
+
+	context->PSSetShaderResources(0, 5, noTextures);
+	context->OMSetRenderTargets(1, &renderTarget, depthStencil);
+	context->PSSetShader(m_checkerboardCompositePixelShader.Get(), nullptr, 0);
+	context->PSSetShaderResources(0, 2, compositeTextures);
+
+	context->DrawIndexed(m_indexCount, 0, 0);
+
+	//This frame's image is read by the next frame's resolve
+	context->PSSetShaderResources(0, 2, noTextures);
+
+	m_previousView = m_MVPBufferData.view;
+	m_checkerboardHistory = 1 - m_checkerboardHistory;
+	m_checkerboardBufferData.checkerboardFrame++;
+	m_checkerboardBufferData.historyValid = 1;
+}
+
+void ImplicitRayModels::CreateScaledTargets(const unsigned int width, const unsigned int height)
+{
+	CD3D11_TEXTURE2D_DESC coloursDescription(DXGI_FORMAT_R16G16B16A16_FLOAT, width, height, 1, 1, D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE);
+	CD3D11_TEXTURE2D_DESC distancesDescription(DXGI_FORMAT_R32_FLOAT, width, height, 1, 1, D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE);
+
+	DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateTexture2D(&coloursDescription, nullptr, &m_scaledColours));
+	DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateRenderTargetView(m_scaledColours.Get(), nullptr, &m_scaledColoursTarget));
+	DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateShaderResourceView(m_scaledColours.Get(), nullptr, &m_scaledColoursView));
+	DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateTexture2D(&distancesDescription, nullptr, &m_scaledDistances));
+	DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateRenderTargetView(m_scaledDistances.Get(), nullptr, &m_scaledDistancesTarget));
+	DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateShaderResourceView(m_scaledDistances.Get(), nullptr, &m_scaledDistancesView));
+
+	m_scaledWidth = width;
+	m_scaledHeight = height;
+}
+
+void ImplicitRayModels::BeginDynamicResolution(const D3D11_VIEWPORT& viewport)
+{
+	auto context = m_deviceResources->GetD3DDeviceContext();
+
+	const auto width = static_cast<unsigned int>(viewport.Width);
+	const auto height = static_cast<unsigned int>(viewport.Height);
+
+	if (width != m_scaledWidth || height != m_scaledHeight)
+	{
+		CreateScaledTargets(width, height);
+	}
+
+	const auto scale = m_resolutionController.GetScale();
+
+	//Whole pixels, so the upsampling lines up with what was drawn
+	m_dynamicResolutionBufferData.renderSize = DirectX::XMFLOAT2(static_cast<float>(ImplicitBilateralUpsampler::GetScaledSize(width, scale)), static_cast<float>(ImplicitBilateralUpsampler::GetScaledSize(height, scale)));
+	m_dynamicResolutionBufferData.screenSize = DirectX::XMFLOAT2(viewport.Width, viewport.Height);
+
+	context->UpdateSubresource1(m_dynamicResolutionBuffer.Get(), 0, NULL, &m_dynamicResolutionBufferData, 0, 0, 0);
+	context->PSSetConstantBuffers1(5, 1, m_dynamicResolutionBuffer.GetAddressOf(), nullptr, nullptr);
+
+	//Misses are discarded, so they keep no hit
+	const float noColour[] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	const float noDistance[] = { ImplicitSceneSdf::MaxDistance, ImplicitSceneSdf::MaxDistance, ImplicitSceneSdf::MaxDistance, ImplicitSceneSdf::MaxDistance };
+
+	context->ClearRenderTargetView(m_scaledColoursTarget.Get(), noColour);
+	context->ClearRenderTargetView(m_scaledDistancesTarget.Get(), noDistance);
+
+	//The hits are depth tested against the depth limits rather than the depth buffer, which is the screen's size
+	const auto scaledViewport = CD3D11_VIEWPORT(0.0f, 0.0f, m_dynamicResolutionBufferData.renderSize.x, m_dynamicResolutionBufferData.renderSize.y);
+	ID3D11RenderTargetView* const targets[] = { m_scaledColoursTarget.Get(), m_scaledDistancesTarget.Get() };
+
+	context->RSSetViewports(1, &scaledViewport);
+	context->OMSetRenderTargets(2, targets, nullptr);
+}
+
+void ImplicitRayModels::RenderUpsampling(const D3D11_VIEWPORT& viewport, ID3D11RenderTargetView* const renderTarget, ID3D11DepthStencilView* const depthStencil)
+{
+	auto context = m_deviceResources->GetD3DDeviceContext();
+
+	ID3D11ShaderResourceView* const noTextures[] = { nullptr, nullptr, nullptr };
+	ID3D11ShaderResourceView* const upsampleTextures[] = { m_scaledColoursView.Get(), m_scaledDistancesView.Get(), UseDepthLimits ? m_depthLimitsView.Get() : nullptr };
+
+	//Unbound as targets before they're read
+	context->OMSetRenderTargets(1, &renderTarget, depthStencil);
+	context->RSSetViewports(1, &viewport);
+	context->PSSetShader(m_upsamplePixelShader.Get(), nullptr, 0);
+	context->PSSetShaderResources(0, 3, upsampleTextures);
+
+	context->DrawIndexed(m_indexCount, 0, 0);
+
+	//Written again by the next frame's main pass
+	context->PSSetShaderResources(0, 3, noTextures);
+}
@@ -4,6 +4,10 @@
 #include "..\Common\DirectXHelper.h"
 #include "..\Content\ShaderStructures.h"
 #include "..\Common\StepTimer.h"
+#include "SdfSceneGraph.h"
+#include "ImplicitSceneHierarchy.h"
+#include "ImplicitGpuTimer.h"
+#include "ImplicitResolutionController.h"
 
 #include <DirectXMath.h>
 
@@ -18,12 +22,71 @@ namespace AlienPlanetACW
 		void SetViewProjectionMatrixConstantBuffer(DirectX::XMMATRIX& view, DirectX::XMMATRIX& projection);
 		void SetInverseViewMatrixConstantBuffer(DirectX::XMMATRIX& inverseView);
 		void SetCameraPositionConstantBuffer(DirectX::XMFLOAT3& cameraPosition);
+		//Bit n set for each object n drawn from a mesh this frame, which the marching leaves out
+		void SetMeshedObjects(unsigned int meshedObjects);
 		void ReleaseDeviceDependentResources();
 
 		void Update(DX::StepTimer const& timer);
 		void Render();
 
 	private:
+		//Has to match SCENE_BYTECODE in ImplicitRayModelsPS.hlsl, the scene graph is compiled and uploaded every frame
+		static const bool UseSceneBytecode = false;
+		static const unsigned int SceneBytecodeCapacity = 512;
+
+		//Has to match CONE_SEEDS in ImplicitRayModelsPS.hlsl. ImplicitRayConesPS.hlsl marches cones over squares of the
+		//screen ConeTileSize across, then each level after over quarters of the last, and the rays start from the last
+		//level's depths, which are CONE_SEED_SIZE across
+		static const bool UseConeSeeds = false;
+		static const unsigned int ConeLevels = 3;
+		static const unsigned int ConeTileSize = 16;
+
+		//Has to match TEMPORAL_CACHE in ImplicitRayModelsPS.hlsl. The main pass writes each pixel's hit to one of two
+		//textures in turn, and before the next frame's rays start ImplicitRayReprojectVS.hlsl draws them as points where
+		//they are on the screen now
+		static const bool UseTemporalCache = false;
+
+		//Has to match DEPTH_LIMITS in ImplicitRayModelsPS.hlsl. The depth buffer is copied once the rest of the scene is
+		//drawn, ImplicitDepthLimitsPS.hlsl turns it into how far each pixel's ray can go, and ImplicitDepthPyramidPS.hlsl
+		//takes the furthest of those over squares of 2, 4, 8 and 16 pixels for the cone passes. Nothing a ray finds past
+		//its limit would pass the depth test, so the image is the same either way. Off until the shaders have been
+		//compiled and the image checked against the one without them
+		static const bool UseDepthLimits = false;
+		static const unsigned int DepthPyramidLevels = 4;
+
+		//Has to match TILE_BINNING in ImplicitRayModelsPS.hlsl. ImplicitSceneTileBins bins the objects into squares of
+		//the screen TileBinSize across every frame, TILE_BIN_SIZE in the shader, and each pixel only evaluates the
+		//objects in its square's list. The cone passes still evaluate every object. Off until the shader has been
+		//compiled and its image checked against the one without the bins
+		static const bool UseTileBinning = false;
+		static const unsigned int TileBinSize = 16;
+
+		//Has to match CHECKERBOARD in ImplicitRayModelsPS.hlsl, and not with UseTemporalCache. The main pass marches half
+		//the pixels into textures half the screen's width, ImplicitCheckerboardResolvePS.hlsl fills in the rest from last
+		//frame's image into one of two textures in turn, and ImplicitCheckerboardCompositePS.hlsl draws that to the screen
+		static const bool UseCheckerboard = false;
+
+		//Has to match DYNAMIC_RESOLUTION in ImplicitRayModelsPS.hlsl, and not with UseTemporalCache or UseCheckerboard.
+		//ImplicitResolutionController picks a scale from the main pass's GPU time, the main pass is drawn at that scale
+		//of the screen into textures of its own and ImplicitUpsamplePS.hlsl scales it up to the screen. ImplicitRayTracedModels'
+		//pass is neither timed nor scaled. It draws straight to the screen, and with the models' three spheres it's a
+		//handful of intersections a pixel, far under what the marched pass costs
+		static const bool UseDynamicResolution = false;
+
+		void CreateConeSeeds(unsigned int width, unsigned int height);
+		void RenderConePasses(const D3D11_VIEWPORT& viewport);
+		void CreateTemporalCache(unsigned int width, unsigned int height);
+		void RenderReprojection(const D3D11_VIEWPORT& viewport);
+		void CreateDepthLimits(const D3D11_TEXTURE2D_DESC& depthBufferDescription);
+		void RenderDepthLimits(const D3D11_VIEWPORT& viewport);
+		void UploadTileBins(const D3D11_VIEWPORT& viewport);
+		void CreateCheckerboard(unsigned int width, unsigned int height);
+		void BeginCheckerboard(const D3D11_VIEWPORT& viewport);
+		void ResolveCheckerboard(const D3D11_VIEWPORT& viewport, ID3D11RenderTargetView* renderTarget, ID3D11DepthStencilView* depthStencil);
+		void CreateScaledTargets(unsigned int width, unsigned int height);
+		void BeginDynamicResolution(const D3D11_VIEWPORT& viewport);
+		void RenderUpsampling(const D3D11_VIEWPORT& viewport, ID3D11RenderTargetView* renderTarget, ID3D11DepthStencilView* depthStencil);
+
 		std::shared_ptr<DX::DeviceResources> m_deviceResources;
 
 		Microsoft::WRL::ComPtr<ID3D11InputLayout>	m_inputLayout;
@@ -32,18 +95,113 @@ namespace AlienPlanetACW
 
 		Microsoft::WRL::ComPtr<ID3D11VertexShader>	m_vertexShader;
 		Microsoft::WRL::ComPtr<ID3D11PixelShader>	m_pixelShader;
+		Microsoft::WRL::ComPtr<ID3D11PixelShader>	m_conePixelShader;
+		Microsoft::WRL::ComPtr<ID3D11VertexShader>	m_reprojectVertexShader;
+		Microsoft::WRL::ComPtr<ID3D11PixelShader>	m_reprojectPixelShader;
+		Microsoft::WRL::ComPtr<ID3D11PixelShader>	m_depthLimitsPixelShader;
+		Microsoft::WRL::ComPtr<ID3D11PixelShader>	m_depthPyramidPixelShader;
+		Microsoft::WRL::ComPtr<ID3D11PixelShader>	m_checkerboardResolvePixelShader;
+		Microsoft::WRL::ComPtr<ID3D11PixelShader>	m_checkerboardCompositePixelShader;
+		Microsoft::WRL::ComPtr<ID3D11PixelShader>	m_upsamplePixelShader;
 
 		Microsoft::WRL::ComPtr<ID3D11RasterizerState> m_rasterizerState;
+		//Keeps the nearest of the reprojected hits that land in a pixel
+		Microsoft::WRL::ComPtr<ID3D11BlendState>	m_minimumBlendState;
 
 		Microsoft::WRL::ComPtr<ID3D11Buffer>		m_MVPBuffer;
 		Microsoft::WRL::ComPtr<ID3D11Buffer>		m_cameraBuffer;
 		Microsoft::WRL::ComPtr<ID3D11Buffer>		m_timeBuffer;
 		Microsoft::WRL::ComPtr<ID3D11Buffer>		m_inverseViewBuffer;
+		Microsoft::WRL::ComPtr<ID3D11Buffer>		m_checkerboardBuffer;
+		Microsoft::WRL::ComPtr<ID3D11Buffer>		m_dynamicResolutionBuffer;
+
+		Microsoft::WRL::ComPtr<ID3D11Buffer>		m_sceneBytecodeBuffer;
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_sceneBytecodeView;
+		SdfProgram									m_sceneProgram;
+
+		//One start depth per square of the screen at each cone level, remade when the viewport changes size
+		Microsoft::WRL::ComPtr<ID3D11Texture2D>				m_coneSeeds[ConeLevels];
+		Microsoft::WRL::ComPtr<ID3D11RenderTargetView>		m_coneSeedTargets[ConeLevels];
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>	m_coneSeedViews[ConeLevels];
+		unsigned int										m_coneSeedsWidth;
+		unsigned int										m_coneSeedsHeight;
+
+		//This frame's hits and last frame's, swapping every frame, and the distances reprojected from last frame's. All
+		//remade when the viewport changes size, which leaves nothing to reproject for a frame
+		Microsoft::WRL::ComPtr<ID3D11Texture2D>				m_temporalHits[2];
+		Microsoft::WRL::ComPtr<ID3D11RenderTargetView>		m_temporalHitTargets[2];
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>	m_temporalHitViews[2];
+		Microsoft::WRL::ComPtr<ID3D11Texture2D>				m_reprojectedDepths;
+		Microsoft::WRL::ComPtr<ID3D11RenderTargetView>		m_reprojectedDepthsTarget;
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>	m_reprojectedDepthsView;
+		unsigned int										m_temporalCacheWidth;
+		unsigned int										m_temporalCacheHeight;
+		//Which of m_temporalHits this frame writes
+		unsigned int										m_temporalFrame;
+		bool												m_temporalCacheValid;
+
+		//The depth buffer as it was before the rays, each pixel's ray's limit, and the furthest limits over squares
+		//twice as wide at each level. All remade when the depth buffer changes size
+		Microsoft::WRL::ComPtr<ID3D11Texture2D>				m_rasterDepth;
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>	m_rasterDepthView;
+		Microsoft::WRL::ComPtr<ID3D11Texture2D>				m_depthLimits;
+		Microsoft::WRL::ComPtr<ID3D11RenderTargetView>		m_depthLimitsTarget;
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>	m_depthLimitsView;
+		Microsoft::WRL::ComPtr<ID3D11Texture2D>				m_depthPyramid[DepthPyramidLevels];
+		Microsoft::WRL::ComPtr<ID3D11RenderTargetView>		m_depthPyramidTargets[DepthPyramidLevels];
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>	m_depthPyramidViews[DepthPyramidLevels];
+		unsigned int										m_depthLimitsWidth;
+		unsigned int										m_depthLimitsHeight;
+
+		//A list of objects for each square of the screen, remade when there are more squares than it holds, and the
+		//boxes they're binned from for this frame's time
+		Microsoft::WRL::ComPtr<ID3D11Buffer>				m_tileBinsBuffer;
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>	m_tileBinsView;
+		unsigned int										m_tileBinsCapacity;
+		std::vector<ImplicitSceneBounds>					m_objectBounds;
+
+		//This frame's marched colours and hits, half the screen's width, and the finished images with their hits, this
+		//frame's and last frame's swapping every frame. All remade when the viewport changes size, which leaves nothing
+		//to reproject for a frame
+		Microsoft::WRL::ComPtr<ID3D11Texture2D>				m_checkerboardColours;
+		Microsoft::WRL::ComPtr<ID3D11RenderTargetView>		m_checkerboardColoursTarget;
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>	m_checkerboardColoursView;
+		Microsoft::WRL::ComPtr<ID3D11Texture2D>				m_checkerboardHits;
+		Microsoft::WRL::ComPtr<ID3D11RenderTargetView>		m_checkerboardHitsTarget;
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>	m_checkerboardHitsView;
+		Microsoft::WRL::ComPtr<ID3D11Texture2D>				m_checkerboardHistoryColours[2];
+		Microsoft::WRL::ComPtr<ID3D11RenderTargetView>		m_checkerboardHistoryColourTargets[2];
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>	m_checkerboardHistoryColourViews[2];
+		Microsoft::WRL::ComPtr<ID3D11Texture2D>				m_checkerboardHistoryHits[2];
+		Microsoft::WRL::ComPtr<ID3D11RenderTargetView>		m_checkerboardHistoryHitTargets[2];
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>	m_checkerboardHistoryHitViews[2];
+		unsigned int										m_checkerboardWidth;
+		unsigned int										m_checkerboardHeight;
+		//Which of m_checkerboardHistoryColours and Hits this frame writes
+		unsigned int										m_checkerboardHistory;
+		//The view the last finished image was drawn from, transposed like m_MVPBufferData's
+		DirectX::XMFLOAT4X4									m_previousView;
+
+		//The main pass's colours and distances at the render scale, in the top left of textures the screen's size so the
+		//scale can change without them being remade. Remade when the viewport changes size
+		Microsoft::WRL::ComPtr<ID3D11Texture2D>				m_scaledColours;
+		Microsoft::WRL::ComPtr<ID3D11RenderTargetView>		m_scaledColoursTarget;
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>	m_scaledColoursView;
+		Microsoft::WRL::ComPtr<ID3D11Texture2D>				m_scaledDistances;
+		Microsoft::WRL::ComPtr<ID3D11RenderTargetView>		m_scaledDistancesTarget;
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>	m_scaledDistancesView;
+		unsigned int										m_scaledWidth;
+		unsigned int										m_scaledHeight;
+		ImplicitResolutionController						m_resolutionController;
+		//Around the main pass's draw, for the controller
+		ImplicitGpuTimer									m_mainPassTimer;
 
 		ModelViewProjectionConstantBuffer			m_MVPBufferData;
 		CameraPositionConstantBuffer				m_cameraBufferData;
-		TotalTimeConstantBuffer						m_timeBufferData;
+		ImplicitSceneTimeConstantBuffer				m_timeBufferData;
 		InverseViewConstantBuffer					m_inverseViewBufferData;
+		ImplicitCheckerboardConstantBuffer			m_checkerboardBufferData;
+		ImplicitDynamicResolutionConstantBuffer		m_dynamicResolutionBufferData;
 
 		uint32	m_indexCount;
 
@@ -16,10 +16,36 @@ cbuffer CameraConstantBuffer : register(b2)
 	float padding;
 }
 
+//time with everything in the scene that only depends on it, worked out once a frame by ImplicitSceneParameters::FromTime
+//rather than at every sample. ImplicitSceneTimeConstantBuffer in ShaderStructures.h
 cbuffer timeConstantBuffer : register(b3)
 {
 	float time;
-	float3 padding2;
+	//abs(sin(time * 0.7f)), the infinite shapes' morph
+	float morph;
+	//beamScale.x, lerp(0.0f, 1.0f, abs(sin(time)))
+	float beamLength;
+	//sin(time), the wobbly sphere's blend between its wobbles
+	float wobble;
+	float3 shipPosition;
+	//lerp(0.02f, 0.045f, abs(sin(time)))
+	float alienEyeHeight;
+	float3 beamPosition;
+	//mouthLerp
+	float alienMouth;
+	//sphereLerpYOne, Two and Three
+	float3 dripHeights;
+	//armMovement
+	float alienArm;
+	float3 mandelbulbColour;
+	float mandelbulbPower;
+	//Rows of rotMatrix, rotMatrix2 and rotMatrix3 multiplied together, w is unused
+	float4 mandelbulbRotation[3];
+	//Bit n set for each object n drawn from its mesh this frame, see ImplicitMeshedObjects
+	uint meshedObjects;
+	//Lists in a row of tileBins
+	uint tileColumns;
+	float2 timePadding;
 }
 
 // Per-pixel color data passed through the pixel shader.
@@ -348,34 +374,22 @@ float smoothIntersection(float d1, float d2, float k) {
 	return lerp(d2, d1, h) + k * h*(1.0 - h);
 }
 
+//Iterations of the fractals, mandelbulbIterations and sierpinskiIterations in ImplicitSceneParameters
+#define MANDELBULB_ITERATIONS 8
+#define SIERPINSKI_ITERATIONS 8
+
 float4 mandelBulb(float3 pos)
 {
-	float Power = 3.0 + 4.0*(sin(time / 30.0) + 1.0);
+	float Power = mandelbulbPower;
 	//float Power = 8.0f;
 
-	float3x3 rotMatrix = float3x3(
-		float3(cos(time * 0.2), -sin(time * 0.2), 0.0),
-		float3(sin(time * 0.2), cos(time * 0.2), 0.0),
-		float3(0.0, 0.0, 1.0)
-	);
-
-	float3x3 rotMatrix2 = float3x3(
-		float3(cos(time * 0.2), 0.0, -sin(time * 0.2)),
-		float3(0.0, 1.0, 0.0),
-		float3(sin(time * 0.2), 0.0, cos(time * 0.2))
-	);
-
-	float3x3 rotMatrix3 = float3x3(
-		float3(1.0, 0.0, 0.0),
-		float3(0.0, cos(time * 0.2), -sin(time * 0.2)),
-		float3(0.0, sin(time * 0.2), cos(time * 0.2))
-	);
+	float3x3 rotation = float3x3(mandelbulbRotation[0].xyz, mandelbulbRotation[1].xyz, mandelbulbRotation[2].xyz);
 
-	float3 z = mul(rotMatrix, mul(rotMatrix2, mul(rotMatrix3, pos + float3(0.0f, 0.0f, -0.5f))));
+	float3 z = mul(rotation, pos + float3(0.0f, 0.0f, -0.5f));
 
 	float dr = 1.0;
 	float r = 0.0;
-	for (int i = 0; i < 8; i++) {
+	for (int i = 0; i < MANDELBULB_ITERATIONS; i++) {
 		r = length(z);
 		if (r > 1.5f) break;
 
@@ -383,11 +397,10 @@ float4 mandelBulb(float3 pos)
 		float theta = acos(z.z / r);
 		float phi = atan2(z.x, z.y);
 
-		dr = pow(r, Power - 1.0)*Power*dr + 1.0;
-
-		// scale and rotate the point
-	
+		// scale and rotate the point, r^(Power - 1) from r^Power rather than a second pow
 		float zr = pow(r, Power);
+		dr = (r > 0.0 ? zr / r : 0.0)*Power*dr + 1.0;
+
 		theta = theta * Power;
 		phi = phi * Power;
 
@@ -396,7 +409,7 @@ float4 mandelBulb(float3 pos)
 		z += pos;
 	}
 
-	return float4(0.5*log(r)*r / dr, saturate(float3(lerp(0.0f, 1.0f, sin(time)), lerp(0.0f, 1.0f, -sin(time)), lerp(0.0f, 1.0f, cos(time)))));
+	return float4(0.5*log(r)*r / dr, mandelbulbColour);
 
 	//return float4(0.5*log(r)*r / dr, saturate((float3)lerp(Power, z, sin(time))));
 }
@@ -413,7 +426,7 @@ float4 SierpinskiTetrahedron(float3 pos)
 	float r = 1.0;
 	float dm;
 	float3 v;
-	for (int i = 0; i < 8; i++)
+	for (int i = 0; i < SIERPINSKI_ITERATIONS; i++)
 	{
 		float d;
 		d = dot(pos - va, pos - va);              
@@ -444,21 +457,26 @@ float4 SierpinskiTetrahedron(float3 pos)
 }
 
 
-//Signed Distance Function for the scene, function return value of called SDF 
-//Determines location of P relative to the surface of the function (sphere)
-float4 sceneSDF(float3 samplePoint)
-{
-	//Contains hit distance (x) and colour (yzw)
-	float4 closestHit = float4(1e10, 0.0f, 0.0f, 0.0f);
+//Scene objects, each returns hit distance (x) and colour (yzw)
 
-	//Effect 1 / 4 using lerp function to transition between a set of primitives
-	//Sphere to Cube to Torus
+//Effect 1 / 4 using lerp function to transition between a set of primitives
+//Sphere to Cube to Torus
+float4 morphingShapesSDF(float3 samplePoint)
+{
 	float3 infinPos = float3(abs(samplePoint.x), samplePoint.y - 4.0f, abs(samplePoint.z));
 	infinPos.xz = fmod(infinPos.xz / 2.0f + 0.5f, 1.0f) - 0.5f;
-	closestHit = unionSDF(closestHit, float4(lerp(lerp(torusSDF(infinPos, float2(0.3f, 0.1f)), cubeSDF(infinPos, float3(0.4f, 0.4f, 0.4f)), abs(sin(time * 0.7f))), sphereSDF(infinPos, 0.2f), abs(sin(time * 0.7f))), float3(0.4f, 0.8f, 0.8f)));
+	return float4(lerp(lerp(torusSDF(infinPos, float2(0.3f, 0.1f)), cubeSDF(infinPos, float3(0.4f, 0.4f, 0.4f)), morph), sphereSDF(infinPos, 0.2f), morph), float3(0.4f, 0.8f, 0.8f));
+}
+
+float3 alienShipPosition()
+{
+	return shipPosition;
+}
 
-	//AlienShip
-	float3 alienShipPos = float3(lerp(-2.0f, 2.0f, sin(time / 2)), lerp(2.0f, 2.15f, abs(sin(time))), 0.0f);
+//AlienShip
+float4 alienShipSDF(float3 samplePoint)
+{
+	float3 alienShipPos = alienShipPosition();
 
 	float result = smoothUnion(ellipsoidSDF(samplePoint - alienShipPos, float3(0.3f, 0.07f, 0.3f)), ellipsoidSDF(samplePoint - float3(alienShipPos.x, alienShipPos.y + 0.08f, alienShipPos.z), float3(0.15f, 0.05f, 0.15f)), 0.05f);
 	result = smoothSubtraction(torusSDF(samplePoint - alienShipPos, float2(0.3f, 0.05f)), result, 0.01f);
@@ -474,10 +492,18 @@ float4 sceneSDF(float3 samplePoint)
 		result = smoothUnion(result, sphereSDF(samplePoint - float3(alienShipPos.x - x * 0.21f, alienShipPos.y + -0.05f, alienShipPos.z - z * 0.21f), 0.02f), 0.02f);
 	}
 
+	return float4(result, 0.29f, 0.5649f, 0.107f);
+}
+
+//AlienShip beam, same colour as the ship
+float4 alienShipBeamSDF(float3 samplePoint)
+{
+	float3 alienShipPos = alienShipPosition();
+
 	//lerp(0.0f, 2.0f, abs(sin(time)))
 
-	float3 beamScale = float3(lerp(0.0f, 1.0f, abs(sin(time))), 0.2f, 0.05f);
-	float3 beamPos = float3(alienShipPos.x, alienShipPos.y - (beamScale.x / 3) - (beamScale.x / 2), alienShipPos.z);
+	float3 beamScale = float3(beamLength, 0.2f, 0.05f);
+	float3 beamPos = beamPosition;
 
 	float beamResult;
 
@@ -490,34 +516,37 @@ float4 sceneSDF(float3 samplePoint)
 		beamResult = smoothSubtraction(torusSDF(samplePoint - float3(alienShipPos.x, alienShipPos.y - torusPos, alienShipPos.z), float2(0.05f + 0.015f * i, 0.004f * beamScale.x)), beamResult, 0.05f);
 	}
 
+	return float4(beamResult, 0.29f, 0.5649f, 0.107f);
+}
 
-	result = unionSDF(result, beamResult);
-
-	closestHit = unionSDF(closestHit, float4(result, 0.29f, 0.5649f, 0.107f));
-
-	//Alien
+//Alien
+float4 alienSDF(float3 samplePoint)
+{
 	float3 alienPosition = float3(0.9f, 0.6f, 0.5f);
 	float resultAlien = smoothUnion(hexPrismSDF(samplePoint - float3(alienPosition.x, alienPosition.y + 0.01f, alienPosition.z), float2(0.01f, 0.05f)), sphereSDF(samplePoint - float3(alienPosition.x - 0.007f, alienPosition.y + 0.01f, alienPosition.z), 0.035f), 0.01f);
-	resultAlien = smoothUnion(resultAlien, sphereSDF(samplePoint - float3(alienPosition.x - 0.02f, alienPosition.y + lerp(0.02f, 0.045f, abs(sin(time))), alienPosition.z - 0.015f), 0.01f), 0.005f);
-	resultAlien = smoothUnion(resultAlien, sphereSDF(samplePoint - float3(alienPosition.x - 0.02f, alienPosition.y + lerp(0.02f, 0.045f, abs(sin(time))), alienPosition.z + 0.015f), 0.01f), 0.005f);
-	float mouthLerp = lerp(0.005f, 0.02f, abs(sin(time)));
+	resultAlien = smoothUnion(resultAlien, sphereSDF(samplePoint - float3(alienPosition.x - 0.02f, alienPosition.y + alienEyeHeight, alienPosition.z - 0.015f), 0.01f), 0.005f);
+	resultAlien = smoothUnion(resultAlien, sphereSDF(samplePoint - float3(alienPosition.x - 0.02f, alienPosition.y + alienEyeHeight, alienPosition.z + 0.015f), 0.01f), 0.005f);
+	float mouthLerp = alienMouth;
 	resultAlien = smoothSubtraction(ellipsoidSDF(samplePoint - float3(alienPosition.x - 0.025f, alienPosition.y - 0.006f, alienPosition.z), float3(mouthLerp, mouthLerp, 0.05)), resultAlien, 0.01f);
 	resultAlien = smoothUnion(resultAlien, roundConeSDF(samplePoint - float3(alienPosition.x + 0.04f, alienPosition.y - 0.035f, alienPosition.z), 0.025, 0.015, 0.04f), 0.01f);
 	resultAlien = smoothUnion(resultAlien, torusSDF(samplePoint - float3(alienPosition.x + 0.04f, alienPosition.y - 0.04f, alienPosition.z), float2(0.03f, 0.005f)), 0.01f);
 	resultAlien = smoothUnion(resultAlien, cylinderSDF(samplePoint - float3(alienPosition.x + 0.04f, alienPosition.y - 0.08f, alienPosition.z - 0.018f), float3(0.0f, 0.04f, 0.0f), float3(0.0f, -0.04f, 0.0f), 0.008), 0.01f);
 	resultAlien = smoothUnion(resultAlien, cylinderSDF(samplePoint - float3(alienPosition.x + 0.04f, alienPosition.y - 0.08f, alienPosition.z + 0.018f), float3(0.0f, 0.04f, 0.0f), float3(0.0f, -0.04f, 0.0f), 0.008), 0.01f);
-	float armMovement = lerp(-0.05f, 0.05f, abs(cos(time)));
+	float armMovement = alienArm;
 	resultAlien = smoothUnion(resultAlien, cylinderSDF(samplePoint - float3(alienPosition.x + 0.04f, alienPosition.y - 0.005f, alienPosition.z - 0.05f), float3(0.0f, 0.0f, 0.03f), float3(0.0f, armMovement, -0.025f), 0.008), 0.025f);
 	resultAlien = smoothUnion(resultAlien, cylinderSDF(samplePoint - float3(alienPosition.x + 0.04f, alienPosition.y - 0.005f, alienPosition.z + 0.05f), float3(0.0f, 0.0f, -0.03f), float3(0.0f, armMovement, 0.025f), 0.008), 0.025f);
 
-	closestHit = unionSDF(closestHit, float4(resultAlien, 0.987f, 0.28f, 0.45f));
+	return float4(resultAlien, 0.987f, 0.28f, 0.45f);
+}
 
-	//WaterDripEffect
+//WaterDripEffect
+float4 waterDripSDF(float3 samplePoint)
+{
 	float3 dripEffectPosition = float3(0.9f, 0.6f, 0.9f);
 	float resultDrip = smoothUnion(roundBoxSDF(samplePoint - float3(dripEffectPosition.x, dripEffectPosition.y - 0.2f, dripEffectPosition.z), float3(0.06f, 0.06f, 0.06f), 0.032), cappedConeSDF(samplePoint - float3(dripEffectPosition.x, dripEffectPosition.y + 0.3f, dripEffectPosition.z), 0.1, 0.06, 0.08), 0.01f);
-	float sphereLerpYOne = lerp(0.0f, 0.6f, abs(cos(time / 2)));
-	float sphereLerpYTwo = lerp(0.0f, 0.6f, abs(cos(time / 4)));
-	float sphereLerpYThree = lerp(0.0f, 0.6f, abs(cos(time / 3)));
+	float sphereLerpYOne = dripHeights.x;
+	float sphereLerpYTwo = dripHeights.y;
+	float sphereLerpYThree = dripHeights.z;
 	resultDrip = smoothUnion(resultDrip, sphereSDF(samplePoint - float3(dripEffectPosition.x - 0.015f, (dripEffectPosition.y - 0.3f) - sphereLerpYOne, dripEffectPosition.z), 0.02f), 0.02f);
 	resultDrip = smoothUnion(resultDrip, sphereSDF(samplePoint - float3(dripEffectPosition.x, (dripEffectPosition.y - 0.3f) - sphereLerpYTwo, dripEffectPosition.z), 0.02f), 0.05f);
 	resultDrip = smoothUnion(resultDrip, sphereSDF(samplePoint - float3(dripEffectPosition.x + 0.015f, (dripEffectPosition.y - 0.3f) - sphereLerpYThree, dripEffectPosition.z), 0.02f), 0.02f);
@@ -525,45 +554,326 @@ float4 sceneSDF(float3 samplePoint)
 	resultDrip = smoothUnion(resultDrip, sphereSDF(samplePoint - float3(dripEffectPosition.x, (dripEffectPosition.y - 0.3f) + sphereLerpYTwo, dripEffectPosition.z), 0.02f), 0.05f);
 	resultDrip = smoothUnion(resultDrip, sphereSDF(samplePoint - float3(dripEffectPosition.x + 0.015f, (dripEffectPosition.y - 0.3f) + sphereLerpYThree, dripEffectPosition.z), 0.02f), 0.02f);
 
+	return float4(resultDrip, 0.456f, 0.15f, 0.5564);
+}
 
-	closestHit = unionSDF(closestHit, float4(resultDrip, 0.456f, 0.15f, 0.5564));
+//MandelBulb
+float4 mandelBulbSDF(float3 samplePoint)
+{
+	return mandelBulb(samplePoint - float3(-4.0f, 2.0f, -4.0f));
+}
 
-	//MandelBulb
-	closestHit = unionSDF(closestHit, mandelBulb((samplePoint - float3(-4.0f, 2.0f, -4.0f))));
+//SierpinskiTetrahedron
+float4 sierpinskiTetrahedronSDF(float3 samplePoint)
+{
+	if ((meshedObjects & (1u << 6)) != 0)
+	{
+		return float4(1e10f, 0.0f, 0.0f, 0.0f);
+	}
 
-	//SierpinskiTetrahedron
-	closestHit = unionSDF(closestHit, SierpinskiTetrahedron(2.0f * (samplePoint - float3(2.0f, 2.0f, 2.0f))));
+	return SierpinskiTetrahedron(2.0f * (samplePoint - float3(2.0f, 2.0f, 2.0f)));
+}
 
-	//WobblySphere
-	closestHit = unionSDF(closestHit, float4((sphereSDF(samplePoint - wobblySphere.position, wobblySphere.scale) + lerp((0.04*sin(30.0*samplePoint.x)*sin(30.0*samplePoint.y)*sin(30.0*samplePoint.z)), (0.04*sin(60.0*samplePoint.x)*sin(60.0*samplePoint.y)*sin(60.0*samplePoint.z)), sin(time))), wobblySphere.colour));
+//1 to divide the distances of the objects deformed in ways that stretch space by how much they can stretch it, so the
+//rays can't step through them. lipschitzScaling in ImplicitRayMarcherSettings
+#define LIPSCHITZ_SCALING 0
 
-	//Ray Marched Implicit Geometric Primitives
-	closestHit = unionSDF(closestHit, float4(roundConeSDF(samplePoint - float3(0.3, 0.5f, 0.3), float3(0.02, 0.0, 0.0), float3(-0.02, 0.06, 0.02), 0.03, 0.01), 0.18f, 0.22f, 1.0f));
-	closestHit = unionSDF(closestHit, float4(coneSDF(samplePoint - float3(0.0, 0.53f, 0.0), float3(0.16, 0.12, 0.06)), 0.55f, 0.23f, 0.38f));
-	closestHit = unionSDF(closestHit, float4(cappedConeSDF(samplePoint - float3(0.3, 0.5f, 0.0f), 0.03, 0.04, 0.02), 0.80f, 0.78f, 0.45f));
-	closestHit = unionSDF(closestHit, float4(0.6*torusSDF(twistSDF(samplePoint - float3(0.0, 0.5f, 0.3), 60.0f), float2(0.04, 0.01)), 0.28f, 0.51f, 0.08f));
-	closestHit = unionSDF(closestHit, float4(torusSDF(samplePoint - float3(-0.3, 0.5f, -0.3), float2(0.04, 0.01)), 0.41f, 0.27f, 0.54f));
-	closestHit = unionSDF(closestHit, float4(torus82SDF(samplePoint - float3(0.0, 0.5f, -0.3), float2(0.04, 0.01)), 0.52f, 0.75f, 0.42f));
-	closestHit = unionSDF(closestHit, float4(boxSDF(samplePoint - float3(-0.3, 0.5f, 0.0), float3(0.05f, 0.05f, 0.05f)), 0.31f, 0.47f, 0.63f));
-	closestHit = unionSDF(closestHit, float4(roundBoxSDF(samplePoint - float3(-0.3, 0.5f, 0.3), float3(0.04f, 0.04f, 0.04f), 0.016), 1.0f, 0.27f, 0.0f));
-	closestHit = unionSDF(closestHit, float4(ellipsoidSDF(samplePoint - float3(0.3, 0.5f, -0.3), float3(0.05, 0.05, 0.02)), 0.8f, 0.41f, 0.79f));
-	closestHit = unionSDF(closestHit, float4(triPrismSDF(samplePoint - float3(-0.6, 0.5f, -0.3), float2(0.05, 0.02)), 0.92f, 0.68f, 0.92f));
-	closestHit = unionSDF(closestHit, float4(cylinderSDF(samplePoint - float3(-0.6, 0.5f, 0.0), float3(0.002, -0.002, 0.0), float3(-0.02, 0.06, 0.02), 0.016), 0.78f, 0.38f, 0.08f));
-	closestHit = unionSDF(closestHit, float4(cylinderSDF(samplePoint - float3(-0.6, 0.5f, 0.3), float2(0.02, 0.04)), 0.98f, 0.63f, 0.42f));
-	closestHit = unionSDF(closestHit, float4(cylinder6SDF(samplePoint - float3(0.3, 0.5f, 0.6), float2(0.02, 0.04)), 0.29f, 0.46f, 0.43f));
-	closestHit = unionSDF(closestHit, float4(octahedronSDF(samplePoint - float3(0.0, 0.5f, 0.6), 0.07), 0.46f, 0.61f, 0.52f));
-	closestHit = unionSDF(closestHit, float4(hexPrismSDF(samplePoint - float3(-0.3, 0.5f, 0.6), float2(0.05, 0.01)), 0.59f, 1.0f, 1.0f));
-	closestHit = unionSDF(closestHit, float4(roundConeSDF(samplePoint - float3(-0.6, 0.5f, 0.6), 0.04, 0.02, 0.06), 1.0f, 0.2f, 0.0f));
+//WobblySphere
+float4 wobblySphereSDF(float3 samplePoint)
+{
+	float4 distanceAndColour = float4((sphereSDF(samplePoint - wobblySphere.position, wobblySphere.scale) + lerp((0.04*sin(30.0*samplePoint.x)*sin(30.0*samplePoint.y)*sin(30.0*samplePoint.z)), (0.04*sin(60.0*samplePoint.x)*sin(60.0*samplePoint.y)*sin(60.0*samplePoint.z)), wobble)), wobblySphere.colour);
+
+#if LIPSCHITZ_SCALING
+	//The wobbles' gradients are at most 0.04 * 30 and 0.04 * 60, and the lerp can weight the first one by up to two
+	distanceAndColour.x /= 1.0 + 1.2 * abs(1.0 - wobble) + 2.4 * abs(wobble);
+#endif
+
+	return distanceAndColour;
+}
+
+//Ray Marched Implicit Geometric Primitives
+float4 galleryRoundConeSDF(float3 samplePoint) { return float4(roundConeSDF(samplePoint - float3(0.3, 0.5f, 0.3), float3(0.02, 0.0, 0.0), float3(-0.02, 0.06, 0.02), 0.03, 0.01), 0.18f, 0.22f, 1.0f); }
+float4 galleryConeSDF(float3 samplePoint) { return float4(coneSDF(samplePoint - float3(0.0, 0.53f, 0.0), float3(0.16, 0.12, 0.06)), 0.55f, 0.23f, 0.38f); }
+float4 galleryCappedConeSDF(float3 samplePoint) { return float4(cappedConeSDF(samplePoint - float3(0.3, 0.5f, 0.0f), 0.03, 0.04, 0.02), 0.80f, 0.78f, 0.45f); }
+#if LIPSCHITZ_SCALING
+//The twist stretches the torus's outer edge by sqrt(1 + 3^2), 0.6 only makes up for part of it
+float4 galleryTwistedTorusSDF(float3 samplePoint) { return float4((0.6 / 1.9)*torusSDF(twistSDF(samplePoint - float3(0.0, 0.5f, 0.3), 60.0f), float2(0.04, 0.01)), 0.28f, 0.51f, 0.08f); }
+#else
+float4 galleryTwistedTorusSDF(float3 samplePoint) { return float4(0.6*torusSDF(twistSDF(samplePoint - float3(0.0, 0.5f, 0.3), 60.0f), float2(0.04, 0.01)), 0.28f, 0.51f, 0.08f); }
+#endif
+float4 galleryTorusSDF(float3 samplePoint) { return float4(torusSDF(samplePoint - float3(-0.3, 0.5f, -0.3), float2(0.04, 0.01)), 0.41f, 0.27f, 0.54f); }
+float4 galleryTorus82SDF(float3 samplePoint) { return float4(torus82SDF(samplePoint - float3(0.0, 0.5f, -0.3), float2(0.04, 0.01)), 0.52f, 0.75f, 0.42f); }
+float4 galleryBoxSDF(float3 samplePoint) { return float4(boxSDF(samplePoint - float3(-0.3, 0.5f, 0.0), float3(0.05f, 0.05f, 0.05f)), 0.31f, 0.47f, 0.63f); }
+float4 galleryRoundBoxSDF(float3 samplePoint) { return float4(roundBoxSDF(samplePoint - float3(-0.3, 0.5f, 0.3), float3(0.04f, 0.04f, 0.04f), 0.016), 1.0f, 0.27f, 0.0f); }
+float4 galleryEllipsoidSDF(float3 samplePoint) { return float4(ellipsoidSDF(samplePoint - float3(0.3, 0.5f, -0.3), float3(0.05, 0.05, 0.02)), 0.8f, 0.41f, 0.79f); }
+float4 galleryTriPrismSDF(float3 samplePoint) { return float4(triPrismSDF(samplePoint - float3(-0.6, 0.5f, -0.3), float2(0.05, 0.02)), 0.92f, 0.68f, 0.92f); }
+float4 galleryLineCylinderSDF(float3 samplePoint) { return float4(cylinderSDF(samplePoint - float3(-0.6, 0.5f, 0.0), float3(0.002, -0.002, 0.0), float3(-0.02, 0.06, 0.02), 0.016), 0.78f, 0.38f, 0.08f); }
+float4 galleryCylinderSDF(float3 samplePoint) { return float4(cylinderSDF(samplePoint - float3(-0.6, 0.5f, 0.3), float2(0.02, 0.04)), 0.98f, 0.63f, 0.42f); }
+float4 galleryCylinder6SDF(float3 samplePoint) { return float4(cylinder6SDF(samplePoint - float3(0.3, 0.5f, 0.6), float2(0.02, 0.04)), 0.29f, 0.46f, 0.43f); }
+float4 galleryOctahedronSDF(float3 samplePoint) { return float4(octahedronSDF(samplePoint - float3(0.0, 0.5f, 0.6), 0.07), 0.46f, 0.61f, 0.52f); }
+float4 galleryHexPrismSDF(float3 samplePoint) { return float4(hexPrismSDF(samplePoint - float3(-0.3, 0.5f, 0.6), float2(0.05, 0.01)), 0.59f, 1.0f, 1.0f); }
+float4 galleryUprightRoundConeSDF(float3 samplePoint) { return float4(roundConeSDF(samplePoint - float3(-0.6, 0.5f, 0.6), 0.04, 0.02, 0.06), 1.0f, 0.2f, 0.0f); }
+
+//Signed Distance Function for the scene, function return value of called SDF 
+//Determines location of P relative to the surface of the function (sphere)
+float4 sceneSDF(float3 samplePoint)
+{
+	//Contains hit distance (x) and colour (yzw)
+	float4 closestHit = float4(1e10, 0.0f, 0.0f, 0.0f);
+
+	closestHit = unionSDF(closestHit, morphingShapesSDF(samplePoint));
+	closestHit = unionSDF(closestHit, alienShipSDF(samplePoint));
+	closestHit = unionSDF(closestHit, alienShipBeamSDF(samplePoint));
+	closestHit = unionSDF(closestHit, alienSDF(samplePoint));
+	closestHit = unionSDF(closestHit, waterDripSDF(samplePoint));
+	closestHit = unionSDF(closestHit, mandelBulbSDF(samplePoint));
+	closestHit = unionSDF(closestHit, sierpinskiTetrahedronSDF(samplePoint));
+	closestHit = unionSDF(closestHit, wobblySphereSDF(samplePoint));
+	closestHit = unionSDF(closestHit, galleryRoundConeSDF(samplePoint));
+	closestHit = unionSDF(closestHit, galleryConeSDF(samplePoint));
+	closestHit = unionSDF(closestHit, galleryCappedConeSDF(samplePoint));
+	closestHit = unionSDF(closestHit, galleryTwistedTorusSDF(samplePoint));
+	closestHit = unionSDF(closestHit, galleryTorusSDF(samplePoint));
+	closestHit = unionSDF(closestHit, galleryTorus82SDF(samplePoint));
+	closestHit = unionSDF(closestHit, galleryBoxSDF(samplePoint));
+	closestHit = unionSDF(closestHit, galleryRoundBoxSDF(samplePoint));
+	closestHit = unionSDF(closestHit, galleryEllipsoidSDF(samplePoint));
+	closestHit = unionSDF(closestHit, galleryTriPrismSDF(samplePoint));
+	closestHit = unionSDF(closestHit, galleryLineCylinderSDF(samplePoint));
+	closestHit = unionSDF(closestHit, galleryCylinderSDF(samplePoint));
+	closestHit = unionSDF(closestHit, galleryCylinder6SDF(samplePoint));
+	closestHit = unionSDF(closestHit, galleryOctahedronSDF(samplePoint));
+	closestHit = unionSDF(closestHit, galleryHexPrismSDF(samplePoint));
+	closestHit = unionSDF(closestHit, galleryUprightRoundConeSDF(samplePoint));
 
 	return closestHit;
 }
 
+//1 to only evaluate the objects whose boxes ImplicitSceneTileBins projects onto the pixel's TILE_BIN_SIZE square of the
+//screen, and not march the squares with none. UseTileBinning in ImplicitRayModels has to match
+#define TILE_BINNING 0
+#define TILE_BIN_SIZE 16
+
+//Bit n set for each object n sceneSDFHierarchy evaluates, every object unless main takes them from the pixel's square
+static uint tileObjects = 0xFFFFFFFFu;
+
+#if TILE_BINNING && !defined(CONE_PASS)
+//ImplicitSceneTileBins::GetTileObjects, one list per square a row at a time
+StructuredBuffer<uint> tileBins : register(t5);
+#endif
+
+//The same scene with the objects in a bounding volume hierarchy, so far away objects are skipped
+#include "ImplicitSceneHierarchy.hlsli"
+
+//1 to march the scene graph bytecode ImplicitRayModels uploads instead, UseSceneBytecode there has to match
+#define SCENE_BYTECODE 0
+
+#if SCENE_BYTECODE
+#include "SdfBytecodeInterpreter.hlsli"
+#define SCENE_SDF sceneSDFBytecode
+#else
+#define SCENE_SDF sceneSDFHierarchy
+#endif
+
+//1 to start the rays from the depths ImplicitRayConesPS.hlsl leaves in coneSeeds, UseConeSeeds in ImplicitRayModels
+//has to match
+#define CONE_SEEDS 0
+
+#if CONE_SEEDS && !defined(CONE_PASS)
+//The last cone level's depths, one for every CONE_SEED_SIZE pixels square
+Texture2D<float> coneSeeds : register(t1);
+#define CONE_SEED_SIZE 4
+#endif
+
+//1 to start the rays just short of last frame's hits, which ImplicitRayReprojectVS.hlsl draws where they are on the
+//screen now, UseTemporalCache in ImplicitRayModels has to match. ImplicitRayMarcherCache does the same on the CPU
+#define TEMPORAL_CACHE 0
+
+#if TEMPORAL_CACHE && !defined(CONE_PASS)
+//Distance along the ray to the nearest of last frame's hits that landed in each pixel, MAX_DIST where none did
+Texture2D<float> reprojectedDepths : register(t2);
+
+//Fraction of the reprojected depth the rays start short of it, for the surfaces between the old hits
+#define TEMPORAL_MARGIN 0.02f
+
+//Where the animated objects can be at any time, ImplicitSceneHierarchy::GetObjectBoundsForAllTime. Only the static
+//objects' hits are kept, so an animated object could be anywhere in front of them
+static const float3 animatedBoundsMin[7] =
+{
+	float3(-1e9f, 3.6f, -1e9f), float3(-6.35f, 1.88f, -0.35f), float3(-6.22f, 0.146667f, -0.22f), float3(0.81f, 0.44f, 0.37f),
+	float3(0.77f, -0.35f, 0.77f), float3(-5.5f, 0.5f, -5.0f), float3(0.67f, 0.17f, -1.33f)
+};
+
+static const float3 animatedBoundsMax[7] =
+{
+	float3(1e9f, 4.4f, 1e9f), float3(2.35f, 2.33f, 0.35f), float3(2.22f, 2.33667f, 0.22f), float3(1.01f, 0.7f, 0.63f),
+	float3(1.03f, 1.03f, 1.03f), float3(-2.5f, 3.5f, -2.0f), float3(1.33f, 0.83f, -0.67f)
+};
+
+//Where the ray goes into the box, zero from inside it and MAX_DIST when it misses
+float rayBoxEntry(Ray ray, float3 boundsMin, float3 boundsMax)
+{
+	float3 nearPlanes = (boundsMin - ray.o) / ray.d;
+	float3 farPlanes = (boundsMax - ray.o) / ray.d;
+	float3 entries = min(nearPlanes, farPlanes);
+	float3 exits = max(nearPlanes, farPlanes);
+
+	float entry = max(max(entries.x, entries.y), max(entries.z, 0.0f));
+	float exit = min(min(exits.x, exits.y), exits.z);
+
+	return entry <= exit ? entry : MAX_DIST;
+}
+
+//The nearest reprojected hit in the pixel and its eight neighbours, which fill the gaps between the hits, less the
+//margin and short of the animated objects. Zero where nothing landed nearby. Loads off the edge read zero, so the
+//pixels around the border always march from the start
+float temporalStart(Ray ray, int2 pixel)
+{
+	float nearest = MAX_DIST;
+
+	[unroll]
+	for (int y = -1; y <= 1; y++)
+	{
+		[unroll]
+		for (int x = -1; x <= 1; x++)
+		{
+			nearest = min(nearest, reprojectedDepths.Load(int3(pixel + int2(x, y), 0)));
+		}
+	}
+
+	if (nearest >= MAX_DIST)
+	{
+		return 0.0f;
+	}
+
+	float start = nearest * (1.0f - TEMPORAL_MARGIN);
+
+	[unroll]
+	for (int i = 0; i < 7; i++)
+	{
+		start = min(start, rayBoxEntry(ray, animatedBoundsMin[i], animatedBoundsMax[i]));
+	}
+
+	return start;
+}
+
+//Distance to the nearest animated object, so a hit within a couple of epsilons of one isn't kept
+float animatedSDF(float3 samplePoint)
+{
+	float closest = min(morphingShapesSDF(samplePoint).x, alienShipSDF(samplePoint).x);
+	closest = min(closest, min(alienShipBeamSDF(samplePoint).x, alienSDF(samplePoint).x));
+	closest = min(closest, min(waterDripSDF(samplePoint).x, mandelBulbSDF(samplePoint).x));
+
+	return min(closest, wobblySphereSDF(samplePoint).x);
+}
+#endif
+
+//1 to march half the pixels each frame, in a checkerboard whose colours take turns, into textures half the screen's
+//width that ImplicitCheckerboardResolvePS.hlsl fills in the other half from. UseCheckerboard in ImplicitRayModels has to
+//match
+#define CHECKERBOARD 0
+
+#if CHECKERBOARD && !defined(CONE_PASS)
+#if TEMPORAL_CACHE
+#error CHECKERBOARD and TEMPORAL_CACHE both write the second render target
+#endif
+
+#include "ImplicitCheckerboard.hlsli"
+
+//Index of the object sceneSDF takes the colour from at samplePoint, FindClosestObject in ImplicitRayMarcher.cpp, so the
+//resolve can tell the objects apart
+float closestObject(float3 samplePoint)
+{
+	float distances[24] =
+	{
+		morphingShapesSDF(samplePoint).x, alienShipSDF(samplePoint).x, alienShipBeamSDF(samplePoint).x, alienSDF(samplePoint).x,
+		waterDripSDF(samplePoint).x, mandelBulbSDF(samplePoint).x, sierpinskiTetrahedronSDF(samplePoint).x, wobblySphereSDF(samplePoint).x,
+		galleryRoundConeSDF(samplePoint).x, galleryConeSDF(samplePoint).x, galleryCappedConeSDF(samplePoint).x, galleryTwistedTorusSDF(samplePoint).x,
+		galleryTorusSDF(samplePoint).x, galleryTorus82SDF(samplePoint).x, galleryBoxSDF(samplePoint).x, galleryRoundBoxSDF(samplePoint).x,
+		galleryEllipsoidSDF(samplePoint).x, galleryTriPrismSDF(samplePoint).x, galleryLineCylinderSDF(samplePoint).x, galleryCylinderSDF(samplePoint).x,
+		galleryCylinder6SDF(samplePoint).x, galleryOctahedronSDF(samplePoint).x, galleryHexPrismSDF(samplePoint).x, galleryUprightRoundConeSDF(samplePoint).x
+	};
+
+	float closest = 0.0f;
+	float closestDistance = distances[0];
+
+	[unroll]
+	for (int i = 1; i < 24; i++)
+	{
+		if (distances[i] < closestDistance)
+		{
+			closest = i;
+			closestDistance = distances[i];
+		}
+	}
+
+	return closest;
+}
+#endif
+
+//1 to draw into textures at a scale of the screen's size that ImplicitUpsamplePS.hlsl scales up to it, the scale
+//picked from the frame times. UseDynamicResolution in ImplicitRayModels has to match
+#define DYNAMIC_RESOLUTION 0
+
+#if DYNAMIC_RESOLUTION && !defined(CONE_PASS)
+#if TEMPORAL_CACHE || CHECKERBOARD
+#error DYNAMIC_RESOLUTION draws to its own targets, and TEMPORAL_CACHE and CHECKERBOARD want the screen's pixels
+#endif
+
+#include "ImplicitDynamicResolution.hlsli"
+#endif
+
+//1 to stop each ray where the rasterized scene is in front of it, at the distance ImplicitDepthLimitsPS.hlsl leaves in
+//depthLimits, and each cone at the furthest of those under it from ImplicitDepthPyramidPS.hlsl. Anything further would
+//fail the depth test. UseDepthLimits in ImplicitRayModels has to match
+#define DEPTH_LIMITS 0
+
+#if DEPTH_LIMITS && !defined(CONE_PASS)
+Texture2D<float> depthLimits : register(t3);
+#endif
+
+//1 to colour each pixel by how many steps its ray took rather than shading it, blue through green to red and magenta
+//where it ran out of steps, the same as ImplicitRayMarcherTrace::WriteHeatmap
+#define MARCH_INSTRUMENTATION 0
+
+//Steps are the distance times this, going back to where a plain step would have gone whenever one overshoots.
+//overRelaxation in ImplicitRayMarcherSettings, 1.0 is plain sphere tracing
+#define OVER_RELAXATION 1.0
+
+//What the last rayMarching did, for MARCH_INSTRUMENTATION
+static int marchSteps = 0;
+static bool marchOutOfSteps = false;
+
+float3 marchHeatmapColour()
+{
+	if (marchOutOfSteps)
+	{
+		return float3(1.0f, 0.0f, 1.0f);
+	}
+
+	//Square root so the few dozen steps most rays take aren't all the same blue
+	float t = sqrt((float)marchSteps / MAX_MARCHING_STEPS);
+
+	return float3(saturate(2.0f * t - 1.0f), 1.0f - abs(2.0f * t - 1.0f), saturate(1.0f - 2.0f * t));
+}
+
+//1 to take the normal from four samples around a tetrahedron instead of six. The CPU marcher can get the exact gradient
+//in one pass with Sdf::Dual, which HLSL has no operator overloading for. normals in ImplicitRayMarcherSettings
+#define NORMAL_TETRAHEDRON 0
+
 //Calculate surface normals using the gradiant around a point by sampling through SDF
 float3 estimateGradiantNormal(float3 p)
 {
-	return normalize(float3(sceneSDF(float3(p.x + EPSILON, p.y, p.z)).x - sceneSDF(float3(p.x - EPSILON, p.y, p.z)).x,
-		sceneSDF(float3(p.x, p.y + EPSILON, p.z)).x - sceneSDF(float3(p.x, p.y - EPSILON, p.z)).x,
-		sceneSDF(float3(p.x, p.y, p.z + EPSILON)).x - sceneSDF(float3(p.x, p.y, p.z - EPSILON)).x));
+#if NORMAL_TETRAHEDRON
+	float2 k = float2(1.0f, -1.0f);
+
+	return normalize(k.xyy * SCENE_SDF(p + k.xyy * EPSILON).x + k.yyx * SCENE_SDF(p + k.yyx * EPSILON).x +
+		k.yxy * SCENE_SDF(p + k.yxy * EPSILON).x + k.xxx * SCENE_SDF(p + k.xxx * EPSILON).x);
+#else
+	return normalize(float3(SCENE_SDF(float3(p.x + EPSILON, p.y, p.z)).x - SCENE_SDF(float3(p.x - EPSILON, p.y, p.z)).x,
+		SCENE_SDF(float3(p.x, p.y + EPSILON, p.z)).x - SCENE_SDF(float3(p.x, p.y - EPSILON, p.z)).x,
+		SCENE_SDF(float3(p.x, p.y, p.z + EPSILON)).x - SCENE_SDF(float3(p.x, p.y, p.z - EPSILON)).x));
+#endif
 }
 
 float4 PhongIllumination(float surfacePoint, float3 normal, float shininess, float3 rayDirection, float4 diffuseColour)
@@ -599,19 +909,39 @@ float4 PhongIllumination(float surfacePoint, float3 normal, float shininess, flo
 float4 rayMarching(Ray ray, float start, float end)
 {
 	float depth = start;
+	float previousDistance = 0.0f;
+	float stepLength = 0.0f;
+
+	marchOutOfSteps = false;
 
 	for (int i = 0; i < MAX_MARCHING_STEPS; i++)
 	{
-		float4 distanceAndColour = sceneSDF(ray.o + depth * ray.d);
+		float4 distanceAndColour = SCENE_SDF(ray.o + depth * ray.d);
+		marchSteps = i + 1;
 
-		if (distanceAndColour.x < EPSILON)
+		//Over-relaxed, the sphere here not reaching back to the last one means the step could have passed a surface
+		float radius = abs(distanceAndColour.x);
+		bool overshot = OVER_RELAXATION > 1.0 && radius + previousDistance < stepLength;
+
+		if (!overshot && distanceAndColour.x < EPSILON)
 		{
 			//Hit the surface
 			return float4(depth, distanceAndColour.yzw);
 		}
 
 		//Move along the ray
-		depth += distanceAndColour.x;
+		if (overshot)
+		{
+			depth += previousDistance - stepLength;
+			previousDistance = 0.0f;
+			stepLength = 0.0f;
+		}
+		else
+		{
+			stepLength = distanceAndColour.x * OVER_RELAXATION;
+			previousDistance = radius;
+			depth += stepLength;
+		}
 
 		if (depth >= end)
 		{
@@ -620,12 +950,30 @@ float4 rayMarching(Ray ray, float start, float end)
 		}
 	}
 
+	marchOutOfSteps = true;
+
 	return float4(end, 0.0f, 0.0f, 0.0f);
 }
 
+//ImplicitRayConesPS.hlsl includes everything above for the scene and has its own main
+#ifndef CONE_PASS
 struct outputPS
 {
 	float4 colour : SV_TARGET;
+#if TEMPORAL_CACHE
+	//The hit for next frame's cache, w is 1 on a static object and 0 on an animated one. Misses are discarded and keep
+	//the cleared zero
+	float4 temporalHit : SV_TARGET1;
+#endif
+#if CHECKERBOARD
+	//How far along the ray the hit was and closestObject's index. Misses are discarded and keep the cleared MAX_DIST
+	//and NO_OBJECT
+	float2 hit : SV_TARGET1;
+#endif
+#if DYNAMIC_RESOLUTION
+	//How far along the ray the hit was. Misses are discarded and keep the cleared MAX_DIST
+	float distance : SV_TARGET1;
+#endif
 	float depth : SV_DEPTH;
 };
 
@@ -634,7 +982,27 @@ outputPS main(PixelShaderInput input)
 {
 	outputPS output;
 
-	float3 PixelPos = float3(input.canvasXY, -MIN_DIST);
+	int2 pixel = int2(input.position.xy);
+	float2 canvasXY = input.canvasXY;
+
+#if CHECKERBOARD
+	//The viewport is half the screen's width, and each texel marches the pixel in its column that's marched this frame
+	pixel = marchedPixel(pixel);
+
+	if (pixel.x >= screenSize.x)
+	{
+		discard;
+	}
+
+	canvasXY = pixelCanvas(pixel, projection._m00 / projection._m11);
+#endif
+
+#if DYNAMIC_RESOLUTION
+	//The viewport is scaled down, and the screen's pixel under this one's centre has its depth limit and square
+	pixel = int2(input.position.xy * screenSize / renderSize);
+#endif
+
+	float3 PixelPos = float3(canvasXY, -MIN_DIST);
 
 	//float3 cameraPositionTwo = float3(-cameraPosition.x, -cameraPosition.y, -cameraPosition.z);
 
@@ -642,14 +1010,60 @@ outputPS main(PixelShaderInput input)
 	eyeray.o = mul(float4(float3(0.0f, 0.0f, 0.0f), 1.0f), inverseView);
 	eyeray.d = normalize(mul(float4(PixelPos, 0.0f), inverseView));
 
-	float4 distanceAndColour = rayMarching(eyeray, EPSILON, MAX_DIST);
+	float start = EPSILON;
+	float end = MAX_DIST;
+
+#if DEPTH_LIMITS
+	end = min(depthLimits.Load(int3(pixel, 0)), MAX_DIST);
+#endif
+
+#if CONE_SEEDS
+	//Nothing's closer than this along any ray through the pixel's square
+	start = max(coneSeeds.Load(int3(pixel / CONE_SEED_SIZE, 0)), EPSILON);
+#endif
 
-	if (distanceAndColour.x > MAX_DIST - EPSILON)
+#if DEPTH_LIMITS && !MARCH_INSTRUMENTATION
+	//The cone got past what was drawn over the pixel, so there's nothing left to find in front of it
+	if (start >= end)
+	{
+		discard;
+	}
+#endif
+
+#if TILE_BINNING
+	uint2 tile = uint2(pixel) / TILE_BIN_SIZE;
+	tileObjects = tileBins[tile.y * tileColumns + tile.x];
+
+#if !MARCH_INSTRUMENTATION
+	//No object's box covers any of the square, so every ray through it misses
+	if (tileObjects == 0)
+	{
+		discard;
+	}
+#endif
+#endif
+
+#if TEMPORAL_CACHE
+	//Starting inside a surface means something the cache didn't know about is in front of last frame's hit, and the
+	//ray starts where it would have without it
+	float temporalDepth = temporalStart(eyeray, pixel);
+
+	if (temporalDepth > start && SCENE_SDF(eyeray.o + temporalDepth * eyeray.d).x >= 0.0f)
+	{
+		start = temporalDepth;
+	}
+#endif
+
+	float4 distanceAndColour = rayMarching(eyeray, start, end);
+
+#if !MARCH_INSTRUMENTATION
+	if (distanceAndColour.x > end - EPSILON)
 	{
 		discard;
 		//output.colour = float4(0.0f, 0.0f, 0.0f, 0.0f);
 		//return float4(0.0f, 0.0f, 0.0f, 0.0f);
 	}
+#endif
 
 	float3 surfacePoint = cameraPosition + distanceAndColour.x * eyeray.d;
 
@@ -657,9 +1071,29 @@ outputPS main(PixelShaderInput input)
 	pv = mul(pv, projection);
 	output.depth = pv.z / pv.w;
 
+#if TEMPORAL_CACHE
+	bool staticHit = distanceAndColour.x <= end - EPSILON && animatedSDF(surfacePoint) > 2.0f * EPSILON;
+	output.temporalHit = float4(surfacePoint, staticHit ? 1.0f : 0.0f);
+#endif
+
+#if DYNAMIC_RESOLUTION
+	output.distance = distanceAndColour.x <= end - EPSILON ? distanceAndColour.x : MAX_DIST;
+#endif
+
+#if CHECKERBOARD
+	output.hit = distanceAndColour.x <= end - EPSILON ? float2(distanceAndColour.x, closestObject(surfacePoint)) : float2(MAX_DIST, NO_OBJECT);
+#endif
+
+#if MARCH_INSTRUMENTATION
+	//Misses aren't discarded, they stay at the far distance so every pixel shows its steps
+	output.colour = float4(marchHeatmapColour(), 1.0f);
+	return output;
+#endif
+
 	output.colour = PhongIllumination(surfacePoint, estimateGradiantNormal(surfacePoint), 40.0f, eyeray.d, float4(distanceAndColour.yzw, 1.0));
 
 	output.colour = float4(lerp(output.colour.xyz, float3(1.0f, 0.97255f, 0.86275f), 1.0 - exp(-0.0005*distanceAndColour.x*distanceAndColour.x*distanceAndColour.x)), 1.0f);
 
 	return output;
 }
+#endif
@@ -0,0 +1,12 @@
+//Reprojection pass for ImplicitRayModels. Each point is one of last frame's hits from ImplicitRayReprojectVS.hlsl, and
+//the render target's blend keeps the smallest distance that lands in each pixel
+struct ReprojectPixelShaderInput
+{
+	float4 position : SV_POSITION;
+	float depth : TEXCOORD0;
+};
+
+float main(ReprojectPixelShaderInput input) : SV_TARGET
+{
+	return input.depth;
+}
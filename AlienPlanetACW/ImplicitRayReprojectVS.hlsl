@@ -0,0 +1,52 @@
+//Reprojection pass for ImplicitRayModels, the first half of ReprojectCache in ImplicitRayMarcher.cpp on the GPU. Each
+//point is one pixel of last frame's hits, drawn where the hit is on the screen now so ImplicitRayReprojectPS.hlsl can
+//keep the nearest one in each pixel
+cbuffer ModelViewProjectionConstantBuffer : register(b0)
+{
+	matrix model;
+	matrix view;
+	matrix projection;
+};
+
+cbuffer InverseViewConstantBuffer : register(b1)
+{
+	matrix inverseView;
+}
+
+//Last frame's hits in world space, w is 1 on a static object and 0 on an animated one or a miss
+Texture2D<float4> previousHits : register(t0);
+
+struct ReprojectPixelShaderInput
+{
+	float4 position : SV_POSITION;
+	float depth : TEXCOORD0;
+};
+
+ReprojectPixelShaderInput main(uint vertexID : SV_VertexID)
+{
+	ReprojectPixelShaderInput output;
+
+	uint width, height;
+	previousHits.GetDimensions(width, height);
+
+	float4 hit = previousHits.Load(int3(vertexID % width, vertexID / width, 0));
+
+	//The rays go through a canvas one unit in front of the camera rather than through the projection, so the hit goes
+	//onto the canvas the same way and into clip space with the quad's aspect ratio
+	float3 viewPosition = mul(float4(hit.xyz, 1.0f), view).xyz;
+	float2 canvasXY = viewPosition.xy / -viewPosition.z;
+	float aspectRatio = projection._m00 / projection._m11;
+
+	float3 eye = mul(float4(0.0f, 0.0f, 0.0f, 1.0f), inverseView).xyz;
+
+	output.position = float4(canvasXY.x, canvasXY.y / aspectRatio, 0.5f, 1.0f);
+	output.depth = length(hit.xyz - eye);
+
+	//Anything that isn't kept, and hits now behind the camera, go outside clip space and are dropped
+	if (hit.w < 0.5f || viewPosition.z > -0.0001f)
+	{
+		output.position = float4(2.0f, 2.0f, 2.0f, 1.0f);
+	}
+
+	return output;
+}
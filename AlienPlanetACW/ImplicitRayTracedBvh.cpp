@@ -0,0 +1,994 @@
+#include "pch.h"
+#include "ImplicitRayTracedBvh.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <ppl.h>
+
+using namespace AlienPlanetACW;
+using namespace AlienPlanetACW::Sdf;
+using namespace DirectX;
+
+namespace
+{
+	const unsigned int BinCount = 16;
+	//Subtrees with fewer primitives than this are built on the thread that split them off
+	const unsigned int ParallelPrimitives = 4096;
+	//A node test's cost by the surface area heuristic, as a fraction of a primitive test's
+	const float TraversalCost = 1.0f;
+
+	//A box as it's built up, four wide so growing it is two instructions. Only ever on the stack, where vectors are
+	//aligned on every platform
+	struct Bounds
+	{
+		Bounds() : minimum(XMVectorReplicate(FLT_MAX)), maximum(XMVectorReplicate(-FLT_MAX)) {}
+
+		XMVECTOR minimum;
+		XMVECTOR maximum;
+
+		void Grow(FXMVECTOR point)
+		{
+			minimum = XMVectorMin(minimum, point);
+			maximum = XMVectorMax(maximum, point);
+		}
+
+		void Grow(const Bounds& other)
+		{
+			minimum = XMVectorMin(minimum, other.minimum);
+			maximum = XMVectorMax(maximum, other.maximum);
+		}
+
+		//0 while empty
+		float GetSurfaceArea() const
+		{
+			XMFLOAT3 size;
+			XMStoreFloat3(&size, XMVectorSubtract(maximum, minimum));
+
+			return size.x < 0.0f ? 0.0f : 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+		}
+	};
+
+	//A primitive's box, moved around by the build rather than looked up, so each pass over a node's primitives reads
+	//memory in order
+	struct Reference
+	{
+		XMFLOAT3 minimum;
+		unsigned int primitive;
+		XMFLOAT3 maximum;
+	};
+
+	//A leaf when it has no children, with its primitives at first in the builder's order
+	struct BuildNode
+	{
+		XMFLOAT3 minimum;
+		XMFLOAT3 maximum;
+		std::unique_ptr<BuildNode> children[2];
+		unsigned int first;
+		unsigned int count;
+
+		bool IsLeaf() const { return children[0] == nullptr; }
+		float GetSurfaceArea() const
+		{
+			const auto x = maximum.x - minimum.x;
+			const auto y = maximum.y - minimum.y;
+			const auto z = maximum.z - minimum.z;
+
+			return 2.0f * (x * y + y * z + z * x);
+		}
+	};
+
+	class Builder
+	{
+	public:
+		Builder(std::vector<Reference>& references, const bool parallel) : m_references(references), m_parallel(parallel) {}
+
+		std::unique_ptr<BuildNode> Build(const unsigned int first, const unsigned int count, const unsigned int depth) const
+		{
+			std::unique_ptr<BuildNode> node(new BuildNode());
+			node->first = first;
+			node->count = count;
+
+			const auto begin = m_references.begin() + first;
+			const auto end = begin + count;
+
+			//Centroids are left at twice their position throughout, which bins them the same
+			Bounds bounds;
+			Bounds centroidBounds;
+
+			for (auto reference = begin; reference != end; ++reference)
+			{
+				const auto minimum = XMLoadFloat3(&reference->minimum);
+				const auto maximum = XMLoadFloat3(&reference->maximum);
+
+				bounds.Grow(minimum);
+				bounds.Grow(maximum);
+				centroidBounds.Grow(XMVectorAdd(minimum, maximum));
+			}
+
+			XMStoreFloat3(&node->minimum, bounds.minimum);
+			XMStoreFloat3(&node->maximum, bounds.maximum);
+
+			if (count <= 1 || depth + 1 >= ImplicitRayTracedBvh::MaxBuildDepth)
+			{
+				return node;
+			}
+
+			//All three axes' bins in one pass, over the centroids' extent on each. Small nodes have a bin per primitive,
+			//which is most of the build's nodes
+			const auto bins = std::min(count, BinCount);
+
+			XMFLOAT3 extent;
+			XMStoreFloat3(&extent, XMVectorSubtract(centroidBounds.maximum, centroidBounds.minimum));
+
+			const auto axisScale = [bins](const float axisExtent) { return axisExtent > 0.0f ? bins / axisExtent : 0.0f; };
+			const auto scale = XMVectorSet(axisScale(extent.x), axisScale(extent.y), axisScale(extent.z), 0.0f);
+			const auto lastBin = static_cast<float>(bins - 1);
+
+			const auto getBins = [&](const Reference& reference, XMFLOAT3& referenceBins)
+			{
+				const auto centroid = XMVectorAdd(XMLoadFloat3(&reference.minimum), XMLoadFloat3(&reference.maximum));
+				XMStoreFloat3(&referenceBins, XMVectorMin(XMVectorMultiply(XMVectorSubtract(centroid, centroidBounds.minimum), scale), XMVectorReplicate(lastBin)));
+			};
+
+			Bounds binBounds[3][BinCount];
+			unsigned int binCounts[3][BinCount] = {};
+
+			for (auto reference = begin; reference != end; ++reference)
+			{
+				XMFLOAT3 referenceBins;
+				getBins(*reference, referenceBins);
+
+				Bounds referenceBounds;
+				referenceBounds.minimum = XMLoadFloat3(&reference->minimum);
+				referenceBounds.maximum = XMLoadFloat3(&reference->maximum);
+
+				const unsigned int axisBins[3] = { static_cast<unsigned int>(referenceBins.x), static_cast<unsigned int>(referenceBins.y), static_cast<unsigned int>(referenceBins.z) };
+
+				for (auto axis = 0u; axis < 3; axis++)
+				{
+					binBounds[axis][axisBins[axis]].Grow(referenceBounds);
+					binCounts[axis][axisBins[axis]]++;
+				}
+			}
+
+			//The cheapest split over each axis's bins, as the bin the right side starts at
+			auto bestCost = FLT_MAX;
+			auto bestAxis = 0u;
+			auto bestSplit = 0u;
+
+			for (auto axis = 0u; axis < 3; axis++)
+			{
+				if ((axis == 0 ? extent.x : axis == 1 ? extent.y : extent.z) <= 0.0f)
+				{
+					continue;
+				}
+
+				//Sweep from the right for each split's right side, then from the left
+				float rightAreas[BinCount];
+				unsigned int rightCounts[BinCount];
+				Bounds right;
+				auto rightCount = 0u;
+
+				for (auto bin = bins - 1; bin > 0; bin--)
+				{
+					right.Grow(binBounds[axis][bin]);
+					rightCount += binCounts[axis][bin];
+					rightAreas[bin] = right.GetSurfaceArea();
+					rightCounts[bin] = rightCount;
+				}
+
+				Bounds left;
+				auto leftCount = 0u;
+
+				for (auto split = 1u; split < bins; split++)
+				{
+					left.Grow(binBounds[axis][split - 1]);
+					leftCount += binCounts[axis][split - 1];
+
+					if (leftCount == 0 || rightCounts[split] == 0)
+					{
+						continue;
+					}
+
+					const auto cost = left.GetSurfaceArea() * leftCount + rightAreas[split] * rightCounts[split];
+
+					if (cost < bestCost)
+					{
+						bestCost = cost;
+						bestAxis = axis;
+						bestSplit = split;
+					}
+				}
+			}
+
+			auto leftCount = 0u;
+
+			if (bestSplit > 0)
+			{
+				//Relative to testing every primitive in a leaf here
+				const auto splitCost = TraversalCost + bestCost / node->GetSurfaceArea();
+
+				if (splitCost >= count && count <= ImplicitRayTracedBvh::MaxLeafSize)
+				{
+					return node;
+				}
+
+				const auto middle = std::partition(begin, end, [&](const Reference& reference)
+				{
+					XMFLOAT3 referenceBins;
+					getBins(reference, referenceBins);
+
+					return static_cast<unsigned int>(bestAxis == 0 ? referenceBins.x : bestAxis == 1 ? referenceBins.y : referenceBins.z) < bestSplit;
+				});
+
+				leftCount = static_cast<unsigned int>(middle - begin);
+			}
+			else if (count <= ImplicitRayTracedBvh::MaxLeafSize)
+			{
+				return node;
+			}
+
+			//Every centroid in the same place, so they're split in half as they are
+			if (leftCount == 0 || leftCount == count)
+			{
+				leftCount = count / 2;
+			}
+
+			const auto buildLeft = [&]() { node->children[0] = Build(first, leftCount, depth + 1); };
+			const auto buildRight = [&]() { node->children[1] = Build(first + leftCount, count - leftCount, depth + 1); };
+
+			if (m_parallel && count >= ParallelPrimitives)
+			{
+				concurrency::parallel_invoke(buildLeft, buildRight);
+			}
+			else
+			{
+				buildLeft();
+				buildRight();
+			}
+
+			return node;
+		}
+
+	private:
+		std::vector<Reference>& m_references;
+		bool m_parallel;
+	};
+
+	//Collapses the binary tree under node into four wide nodes appended to nodes, and returns the deepest it went
+	unsigned int Flatten(const BuildNode& node, std::vector<ImplicitRayTracedBvhNode>& nodes, unsigned int& leafCount)
+	{
+		//Opens the inner child with the most area until there are four, or only leaves. A leaf at the root is a node with
+		//one child
+		const BuildNode* slots[4] = { &node, nullptr, nullptr, nullptr };
+		auto slotCount = 1u;
+
+		if (!node.IsLeaf())
+		{
+			slots[0] = node.children[0].get();
+			slots[1] = node.children[1].get();
+			slotCount = 2;
+		}
+
+		while (slotCount < 4)
+		{
+			auto widest = -1;
+			auto widestArea = -1.0f;
+
+			for (auto slot = 0u; slot < slotCount; slot++)
+			{
+				if (!slots[slot]->IsLeaf() && slots[slot]->GetSurfaceArea() > widestArea)
+				{
+					widest = static_cast<int>(slot);
+					widestArea = slots[slot]->GetSurfaceArea();
+				}
+			}
+
+			if (widest < 0)
+			{
+				break;
+			}
+
+			const auto* const opened = slots[widest];
+			slots[widest] = opened->children[0].get();
+			slots[slotCount++] = opened->children[1].get();
+		}
+
+		const auto index = nodes.size();
+		nodes.emplace_back();
+
+		auto depth = 1u;
+
+		for (auto slot = 0u; slot < 4; slot++)
+		{
+			//Out of everything's way, see IntersectChildren
+			auto minimum = XMFLOAT3(FLT_MAX, FLT_MAX, FLT_MAX);
+			auto maximum = minimum;
+			auto child = ImplicitRayTracedBvh::EmptyChild;
+			auto count = 0u;
+
+			if (slot < slotCount)
+			{
+				minimum = slots[slot]->minimum;
+				maximum = slots[slot]->maximum;
+
+				if (slots[slot]->IsLeaf())
+				{
+					child = slots[slot]->first;
+					count = slots[slot]->count;
+					leafCount++;
+				}
+				else
+				{
+					child = static_cast<unsigned int>(nodes.size());
+					depth = std::max(depth, Flatten(*slots[slot], nodes, leafCount) + 1);
+				}
+			}
+
+			auto& flattened = nodes[index];
+			flattened.minimumX[slot] = minimum.x;
+			flattened.minimumY[slot] = minimum.y;
+			flattened.minimumZ[slot] = minimum.z;
+			flattened.maximumX[slot] = maximum.x;
+			flattened.maximumY[slot] = maximum.y;
+			flattened.maximumZ[slot] = maximum.z;
+			flattened.children[slot] = child;
+			flattened.counts[slot] = count;
+		}
+
+		return depth;
+	}
+
+	//The ray's origin and direction splatted across the four lanes, as the slab test wants them
+	struct RayLanes
+	{
+		XMVECTOR inverseX;
+		XMVECTOR inverseY;
+		XMVECTOR inverseZ;
+		//-origin / direction, so each slab is one multiply add
+		XMVECTOR offsetX;
+		XMVECTOR offsetY;
+		XMVECTOR offsetZ;
+	};
+
+	//Nudged off zero, so a ray along an axis never multiplies zero by infinity in a slab test
+	Vec3<float> GetInverse(const Vec3<float>& direction)
+	{
+		const auto inverse = [](const float d) { return 1.0f / (std::abs(d) > 1e-8f ? d : (d < 0.0f ? -1e-8f : 1e-8f)); };
+
+		return Vec3<float>(inverse(direction.x), inverse(direction.y), inverse(direction.z));
+	}
+
+	RayLanes GetRayLanes(const Vec3<float>& origin, const Vec3<float>& direction)
+	{
+		const auto inverse = GetInverse(direction);
+		const auto x = inverse.x;
+		const auto y = inverse.y;
+		const auto z = inverse.z;
+
+		RayLanes lanes;
+		lanes.inverseX = XMVectorReplicate(x);
+		lanes.inverseY = XMVectorReplicate(y);
+		lanes.inverseZ = XMVectorReplicate(z);
+		lanes.offsetX = XMVectorReplicate(-origin.x * x);
+		lanes.offsetY = XMVectorReplicate(-origin.y * y);
+		lanes.offsetZ = XMVectorReplicate(-origin.z * z);
+
+		return lanes;
+	}
+
+	//Bit n set when the ray is in child n's box somewhere between tMin and tMax, with where it goes in in entries. An
+	//empty child's box is a point at FLT_MAX, which every slab puts beyond tMax
+	unsigned int IntersectChildren(const ImplicitRayTracedBvhNode& node, const RayLanes& ray, const XMVECTOR& tMin, const XMVECTOR& tMax, float* const entries)
+	{
+		const auto load = [](const float* const values) { return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(values)); };
+
+		const auto x0 = XMVectorMultiplyAdd(load(node.minimumX), ray.inverseX, ray.offsetX);
+		const auto x1 = XMVectorMultiplyAdd(load(node.maximumX), ray.inverseX, ray.offsetX);
+		const auto y0 = XMVectorMultiplyAdd(load(node.minimumY), ray.inverseY, ray.offsetY);
+		const auto y1 = XMVectorMultiplyAdd(load(node.maximumY), ray.inverseY, ray.offsetY);
+		const auto z0 = XMVectorMultiplyAdd(load(node.minimumZ), ray.inverseZ, ray.offsetZ);
+		const auto z1 = XMVectorMultiplyAdd(load(node.maximumZ), ray.inverseZ, ray.offsetZ);
+
+		const auto entry = XMVectorMax(XMVectorMax(XMVectorMin(x0, x1), XMVectorMin(y0, y1)), XMVectorMax(XMVectorMin(z0, z1), tMin));
+		const auto exit = XMVectorMin(XMVectorMin(XMVectorMax(x0, x1), XMVectorMax(y0, y1)), XMVectorMin(XMVectorMax(z0, z1), tMax));
+
+		XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(entries), entry);
+
+		XMUINT4 hits;
+		XMStoreUInt4(&hits, XMVectorLessOrEqual(entry, exit));
+
+		return (hits.x & 1) | (hits.y & 2) | (hits.z & 4) | (hits.w & 8);
+	}
+
+	//Which bit is the lowest set in a mask that isn't 0, a child slot or a packet's ray. The lowest bit on its own times
+	//a de Bruijn sequence has a different top five bits for each
+	unsigned int GetLowestBit(const unsigned int mask)
+	{
+		static const unsigned int bits[32] = { 0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8, 31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9 };
+
+		return bits[((mask & (0u - mask)) * 0x077CB531u) >> 27];
+	}
+}
+
+ImplicitRayTracedBvh::ImplicitRayTracedBvh(const std::vector<ImplicitRayTracedPrimitive>& primitives, const bool parallel) : m_depth(0), m_leafCount(0)
+{
+	const auto start = std::chrono::high_resolution_clock::now();
+
+	const auto count = static_cast<unsigned int>(primitives.size());
+
+	std::vector<Reference> references(count);
+
+	const auto prepare = [&](const size_t primitive)
+	{
+		Vec3<float> minimum, maximum;
+		GetBounds(primitives[primitive], minimum, maximum);
+
+		auto& reference = references[primitive];
+		reference.minimum = XMFLOAT3(minimum.x, minimum.y, minimum.z);
+		reference.primitive = static_cast<unsigned int>(primitive);
+		reference.maximum = XMFLOAT3(maximum.x, maximum.y, maximum.z);
+	};
+
+	if (parallel)
+	{
+		concurrency::parallel_for(static_cast<size_t>(0), static_cast<size_t>(count), prepare);
+	}
+	else
+	{
+		for (auto primitive = 0u; primitive < count; primitive++)
+		{
+			prepare(primitive);
+		}
+	}
+
+	if (count > 0)
+	{
+		const Builder builder(references, parallel);
+		const auto root = builder.Build(0, count, 0);
+
+		m_depth = Flatten(*root, m_nodes, m_leafCount);
+	}
+
+	m_primitives.resize(count);
+
+	for (auto i = 0u; i < count; i++)
+	{
+		m_primitives[i] = primitives[references[i].primitive];
+	}
+
+	m_milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+double ImplicitRayTracedBvh::GetSahCost() const
+{
+	if (m_nodes.empty())
+	{
+		return 0.0;
+	}
+
+	const auto area = [](const ImplicitRayTracedBvhNode& node, const unsigned int slot)
+	{
+		const auto x = static_cast<double>(node.maximumX[slot]) - node.minimumX[slot];
+		const auto y = static_cast<double>(node.maximumY[slot]) - node.minimumY[slot];
+		const auto z = static_cast<double>(node.maximumZ[slot]) - node.minimumZ[slot];
+
+		return 2.0 * (x * y + y * z + z * x);
+	};
+
+	Bounds root;
+
+	for (auto slot = 0u; slot < 4; slot++)
+	{
+		if (m_nodes[0].children[slot] != EmptyChild)
+		{
+			root.Grow(XMVectorSet(m_nodes[0].minimumX[slot], m_nodes[0].minimumY[slot], m_nodes[0].minimumZ[slot], 0.0f));
+			root.Grow(XMVectorSet(m_nodes[0].maximumX[slot], m_nodes[0].maximumY[slot], m_nodes[0].maximumZ[slot], 0.0f));
+		}
+	}
+
+	const auto rootArea = static_cast<double>(root.GetSurfaceArea());
+
+	if (rootArea <= 0.0)
+	{
+		return TraversalCost;
+	}
+
+	//The root is always tested, then each child node in proportion to its area, and each leaf's primitives likewise
+	auto cost = static_cast<double>(TraversalCost);
+
+	for (const auto& node : m_nodes)
+	{
+		for (auto slot = 0u; slot < 4; slot++)
+		{
+			if (node.children[slot] == EmptyChild)
+			{
+				continue;
+			}
+
+			cost += area(node, slot) / rootArea * (node.counts[slot] > 0 ? node.counts[slot] : TraversalCost);
+		}
+	}
+
+	return cost;
+}
+
+template <bool AnyHitOnly>
+bool ImplicitRayTracedBvh::Traverse(const Vec3<float>& origin, const Vec3<float>& direction, const float tMin, const float tMax, ImplicitRayTracedHit& hit, ImplicitRayTracedBvhCount* const count) const
+{
+	if (m_nodes.empty())
+	{
+		return false;
+	}
+
+	struct Entry
+	{
+		unsigned int node;
+		float distance;
+	};
+
+	Entry stack[StackSize];
+	auto top = 0u;
+	stack[top++] = { 0, tMin };
+
+	const auto lanes = GetRayLanes(origin, direction);
+	const auto minimum = XMVectorReplicate(tMin);
+
+	auto closest = tMax;
+	auto found = false;
+	auto nodeTests = 0ull;
+	auto primitiveTests = 0ull;
+
+	while (top > 0)
+	{
+		const auto entry = stack[--top];
+
+		//Something nearer was hit after it went on the stack
+		if (entry.distance > closest)
+		{
+			continue;
+		}
+
+		const auto& node = m_nodes[entry.node];
+
+		float entries[4];
+		auto hits = IntersectChildren(node, lanes, minimum, XMVectorReplicate(closest), entries);
+		nodeTests++;
+
+		unsigned int inner[4];
+		auto innerCount = 0u;
+
+		while (hits != 0)
+		{
+			const auto slot = hits & 1 ? 0u : hits & 2 ? 1u : hits & 4 ? 2u : 3u;
+			hits &= hits - 1;
+
+			if (node.children[slot] == EmptyChild)
+			{
+				continue;
+			}
+
+			if (node.counts[slot] == 0)
+			{
+				inner[innerCount++] = slot;
+				continue;
+			}
+
+			const auto first = node.children[slot];
+
+			for (auto primitive = first; primitive < first + node.counts[slot]; primitive++)
+			{
+				float distance;
+				primitiveTests++;
+
+				if (Intersect(m_primitives[primitive], origin, direction, tMin, closest, distance))
+				{
+					found = true;
+
+					if (AnyHitOnly)
+					{
+						if (count != nullptr)
+						{
+							count->nodes += nodeTests;
+							count->primitives += primitiveTests;
+						}
+
+						return true;
+					}
+
+					closest = distance;
+					hit.distance = distance;
+					hit.primitive = primitive;
+				}
+			}
+		}
+
+		//Furthest first, so the nearest comes off the stack next
+		for (auto i = 1u; i < innerCount; i++)
+		{
+			for (auto j = i; j > 0 && entries[inner[j]] > entries[inner[j - 1]]; j--)
+			{
+				std::swap(inner[j], inner[j - 1]);
+			}
+		}
+
+		for (auto i = 0u; i < innerCount; i++)
+		{
+			stack[top++] = { node.children[inner[i]], entries[inner[i]] };
+		}
+	}
+
+	if (count != nullptr)
+	{
+		count->nodes += nodeTests;
+		count->primitives += primitiveTests;
+	}
+
+	return found;
+}
+
+template <bool AnyHitOnly>
+unsigned int ImplicitRayTracedBvh::TraversePacket(const Vec3<float>* const origins, const Vec3<float>* const directions, const unsigned int rayCount, const float tMin, const float* const tMax, ImplicitRayTracedHit* const hits, ImplicitRayTracedBvhCount* const count) const
+{
+	if (m_nodes.empty() || rayCount == 0)
+	{
+		return 0;
+	}
+
+	//The rays that entered the node's box, and the nearest of where they went in
+	struct Entry
+	{
+		unsigned int node;
+		unsigned int rays;
+		float distance;
+	};
+
+	Entry stack[StackSize];
+	auto top = 0u;
+
+	RayLanes lanes[PacketSize];
+	float closest[PacketSize];
+
+	for (auto ray = 0u; ray < rayCount; ray++)
+	{
+		lanes[ray] = GetRayLanes(origins[ray], directions[ray]);
+		closest[ray] = tMax[ray];
+	}
+
+	const auto minimum = XMVectorReplicate(tMin);
+
+	//Rays still looking, which any hit drops as soon as they find something
+	auto active = (1u << rayCount) - 1;
+	auto found = 0u;
+	auto nodeTests = 0ull;
+	auto primitiveTests = 0ull;
+
+	stack[top++] = { 0, active, tMin };
+
+	while (top > 0 && active != 0)
+	{
+		const auto entry = stack[--top];
+		auto rays = entry.rays & active;
+
+		//Each ray's own closest is checked by its box tests, this only skips the node when every one is nearer
+		auto furthest = 0.0f;
+
+		for (auto remaining = rays; remaining != 0; remaining &= remaining - 1)
+		{
+			furthest = std::max(furthest, closest[GetLowestBit(remaining)]);
+		}
+
+		if (rays == 0 || entry.distance > furthest)
+		{
+			continue;
+		}
+
+		const auto& node = m_nodes[entry.node];
+
+		unsigned int childRays[4] = {};
+		float childEntries[4] = { FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX };
+
+		for (; rays != 0; rays &= rays - 1)
+		{
+			const auto ray = GetLowestBit(rays);
+
+			float entries[4];
+			auto slots = IntersectChildren(node, lanes[ray], minimum, XMVectorReplicate(closest[ray]), entries);
+			nodeTests++;
+
+			for (; slots != 0; slots &= slots - 1)
+			{
+				const auto slot = GetLowestBit(slots);
+
+				childRays[slot] |= 1u << ray;
+				childEntries[slot] = std::min(childEntries[slot], entries[slot]);
+			}
+		}
+
+		unsigned int inner[4];
+		auto innerCount = 0u;
+
+		for (auto slot = 0u; slot < 4; slot++)
+		{
+			if (childRays[slot] == 0 || node.children[slot] == EmptyChild)
+			{
+				continue;
+			}
+
+			if (node.counts[slot] == 0)
+			{
+				inner[innerCount++] = slot;
+				continue;
+			}
+
+			const auto first = node.children[slot];
+
+			for (auto primitive = first; primitive < first + node.counts[slot]; primitive++)
+			{
+				for (auto leafRays = childRays[slot] & active; leafRays != 0; leafRays &= leafRays - 1)
+				{
+					const auto ray = GetLowestBit(leafRays);
+
+					float distance;
+					primitiveTests++;
+
+					if (!Intersect(m_primitives[primitive], origins[ray], directions[ray], tMin, closest[ray], distance))
+					{
+						continue;
+					}
+
+					found |= 1u << ray;
+
+					if (AnyHitOnly)
+					{
+						active &= ~(1u << ray);
+						continue;
+					}
+
+					closest[ray] = distance;
+					hits[ray].distance = distance;
+					hits[ray].primitive = primitive;
+				}
+			}
+		}
+
+		//Furthest first, so the nearest comes off the stack next
+		for (auto i = 1u; i < innerCount; i++)
+		{
+			for (auto j = i; j > 0 && childEntries[inner[j]] > childEntries[inner[j - 1]]; j--)
+			{
+				std::swap(inner[j], inner[j - 1]);
+			}
+		}
+
+		for (auto i = 0u; i < innerCount; i++)
+		{
+			stack[top++] = { node.children[inner[i]], childRays[inner[i]], childEntries[inner[i]] };
+		}
+	}
+
+	if (count != nullptr)
+	{
+		count->nodes += nodeTests;
+		count->primitives += primitiveTests;
+	}
+
+	return found;
+}
+
+bool ImplicitRayTracedBvh::NearestHit(const Vec3<float>& origin, const Vec3<float>& direction, const float tMin, const float tMax, ImplicitRayTracedHit& hit, ImplicitRayTracedBvhCount* const count) const
+{
+	return Traverse<false>(origin, direction, tMin, tMax, hit, count);
+}
+
+bool ImplicitRayTracedBvh::AnyHit(const Vec3<float>& origin, const Vec3<float>& direction, const float tMin, const float tMax, ImplicitRayTracedBvhCount* const count) const
+{
+	ImplicitRayTracedHit hit;
+	return Traverse<true>(origin, direction, tMin, tMax, hit, count);
+}
+
+unsigned int ImplicitRayTracedBvh::NearestHitPacket(const Vec3<float>* const origins, const Vec3<float>* const directions, const unsigned int rayCount, const float tMin, const float* const tMax, ImplicitRayTracedHit* const hits, ImplicitRayTracedBvhCount* const count) const
+{
+	return TraversePacket<false>(origins, directions, rayCount, tMin, tMax, hits, count);
+}
+
+unsigned int ImplicitRayTracedBvh::AnyHitPacket(const Vec3<float>* const origins, const Vec3<float>* const directions, const unsigned int rayCount, const float tMin, const float* const tMax, ImplicitRayTracedBvhCount* const count) const
+{
+	return TraversePacket<true>(origins, directions, rayCount, tMin, tMax, nullptr, count);
+}
+
+bool ImplicitRayTracedBvh::NearestHitLinear(const Vec3<float>& origin, const Vec3<float>& direction, const float tMin, const float tMax, ImplicitRayTracedHit& hit, ImplicitRayTracedBvhCount* const count) const
+{
+	auto closest = tMax;
+	auto found = false;
+
+	for (auto primitive = 0u; primitive < m_primitives.size(); primitive++)
+	{
+		float distance;
+
+		if (Intersect(m_primitives[primitive], origin, direction, tMin, closest, distance))
+		{
+			closest = distance;
+			hit.distance = distance;
+			hit.primitive = primitive;
+			found = true;
+		}
+	}
+
+	if (count != nullptr)
+	{
+		count->primitives += m_primitives.size();
+	}
+
+	return found;
+}
+
+bool ImplicitRayTracedBvh::AnyHitLinear(const Vec3<float>& origin, const Vec3<float>& direction, const float tMin, const float tMax, ImplicitRayTracedBvhCount* const count) const
+{
+	for (auto primitive = 0u; primitive < m_primitives.size(); primitive++)
+	{
+		float distance;
+
+		if (Intersect(m_primitives[primitive], origin, direction, tMin, tMax, distance))
+		{
+			if (count != nullptr)
+			{
+				count->primitives += primitive + 1;
+			}
+
+			return true;
+		}
+	}
+
+	if (count != nullptr)
+	{
+		count->primitives += m_primitives.size();
+	}
+
+	return false;
+}
+
+bool ImplicitRayTracedBvh::Intersect(const ImplicitRayTracedPrimitive& primitive, const Vec3<float>& origin, const Vec3<float>& direction, const float tMin, const float tMax, float& distance)
+{
+	const auto centre = Vec3<float>(primitive.centre.x, primitive.centre.y, primitive.centre.z);
+	const auto offset = origin - centre;
+
+	switch (static_cast<ImplicitRayTracedPrimitiveType>(primitive.type))
+	{
+	case ImplicitRayTracedPrimitiveType::Sphere:
+	{
+		//The near root only, as the shader's SphereIntersect
+		const auto b = Dot(offset, direction);
+		const auto c = Dot(offset, offset) - primitive.size.x * primitive.size.x;
+		const auto discriminant = b * b - c;
+
+		if (discriminant < 0.0f)
+		{
+			return false;
+		}
+
+		distance = -b - std::sqrt(discriminant);
+		break;
+	}
+	case ImplicitRayTracedPrimitiveType::Tetrahedron:
+	{
+		//The four faces' planes, each opposite a vertex and facing away from it
+		static const float n = 0.57735027f;
+		static const Vec3<float> normals[4] = { Vec3<float>(-n, -n, -n), Vec3<float>(-n, n, n), Vec3<float>(n, -n, n), Vec3<float>(n, n, -n) };
+
+		const auto height = primitive.size.x * n;
+		auto entry = -FLT_MAX;
+		auto exit = FLT_MAX;
+
+		for (const auto& normal : normals)
+		{
+			const auto along = Dot(normal, direction);
+			const auto outside = Dot(normal, offset) - height;
+
+			if (along == 0.0f)
+			{
+				if (outside > 0.0f)
+				{
+					return false;
+				}
+
+				continue;
+			}
+
+			const auto t = -outside / along;
+
+			if (along < 0.0f)
+			{
+				entry = std::max(entry, t);
+			}
+			else
+			{
+				exit = std::min(exit, t);
+			}
+		}
+
+		if (entry > exit)
+		{
+			return false;
+		}
+
+		distance = entry;
+		break;
+	}
+	default:
+	{
+		const auto inverse = GetInverse(direction);
+		const auto t0 = (-offset - Vec3<float>(primitive.size.x, primitive.size.y, primitive.size.z)) * inverse;
+		const auto t1 = (-offset + Vec3<float>(primitive.size.x, primitive.size.y, primitive.size.z)) * inverse;
+
+		const auto entry = std::max(std::max(std::min(t0.x, t1.x), std::min(t0.y, t1.y)), std::min(t0.z, t1.z));
+		const auto exit = std::min(std::min(std::max(t0.x, t1.x), std::max(t0.y, t1.y)), std::max(t0.z, t1.z));
+
+		if (entry > exit)
+		{
+			return false;
+		}
+
+		distance = entry;
+		break;
+	}
+	}
+
+	return distance >= tMin && distance <= tMax;
+}
+
+Vec3<float> ImplicitRayTracedBvh::GetNormal(const ImplicitRayTracedPrimitive& primitive, const Vec3<float>& surfacePoint)
+{
+	const auto offset = surfacePoint - Vec3<float>(primitive.centre.x, primitive.centre.y, primitive.centre.z);
+
+	switch (static_cast<ImplicitRayTracedPrimitiveType>(primitive.type))
+	{
+	case ImplicitRayTracedPrimitiveType::Sphere:
+		return Normalize(offset);
+	case ImplicitRayTracedPrimitiveType::Tetrahedron:
+	{
+		//The face the point is furthest out of
+		const auto x = offset.x;
+		const auto y = offset.y;
+		const auto z = offset.z;
+		const float distances[4] = { -x - y - z, -x + y + z, x - y + z, x + y - z };
+		const auto face = std::max_element(distances, distances + 4) - distances;
+		const auto n = 0.57735027f;
+
+		return face == 0 ? Vec3<float>(-n, -n, -n) : face == 1 ? Vec3<float>(-n, n, n) : face == 2 ? Vec3<float>(n, -n, n) : Vec3<float>(n, n, -n);
+	}
+	default:
+	{
+		//The axis the point is furthest along relative to the box's size
+		const auto x = offset.x / primitive.size.x;
+		const auto y = offset.y / primitive.size.y;
+		const auto z = offset.z / primitive.size.z;
+
+		if (std::abs(x) >= std::abs(y) && std::abs(x) >= std::abs(z))
+		{
+			return Vec3<float>(x < 0.0f ? -1.0f : 1.0f, 0.0f, 0.0f);
+		}
+
+		if (std::abs(y) >= std::abs(z))
+		{
+			return Vec3<float>(0.0f, y < 0.0f ? -1.0f : 1.0f, 0.0f);
+		}
+
+		return Vec3<float>(0.0f, 0.0f, z < 0.0f ? -1.0f : 1.0f);
+	}
+	}
+}
+
+void ImplicitRayTracedBvh::GetBounds(const ImplicitRayTracedPrimitive& primitive, Vec3<float>& minimum, Vec3<float>& maximum)
+{
+	const auto centre = Vec3<float>(primitive.centre.x, primitive.centre.y, primitive.centre.z);
+
+	//A tetrahedron's vertices are at its size along every axis, the same as a cube's corners
+	const auto size = static_cast<ImplicitRayTracedPrimitiveType>(primitive.type) == ImplicitRayTracedPrimitiveType::Box ? Vec3<float>(primitive.size.x, primitive.size.y, primitive.size.z) : Vec3<float>(primitive.size.x, primitive.size.x, primitive.size.x);
+
+	minimum = centre - size;
+	maximum = centre + size;
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "SdfMath.h"
+
+#include <DirectXMath.h>
+#include <vector>
+
+namespace AlienPlanetACW
+{
+	enum class ImplicitRayTracedPrimitiveType : unsigned int
+	{
+		Sphere,
+		//Regular, with its vertices at the centre plus size.x times (1, 1, 1), (1, -1, -1), (-1, 1, -1) and (-1, -1, 1)
+		Tetrahedron,
+		Box
+	};
+
+	//64 bytes, laid out like RayTracedPrimitive in ImplicitRayTracedModelsPS.hlsl so a list uploads as a structured buffer
+	struct ImplicitRayTracedPrimitive
+	{
+		DirectX::XMFLOAT3 centre;
+		//An ImplicitRayTracedPrimitiveType
+		unsigned int type;
+		//A sphere's radius or a tetrahedron's size in x, a box's half sizes
+		DirectX::XMFLOAT3 size;
+		float shininess;
+		DirectX::XMFLOAT4 colour;
+		float Kd;
+		float Ks;
+		float Kr;
+		float padding;
+	};
+
+	//128 bytes, laid out like RayTracedBvhNode in the shader. Four children's boxes side by side, so one ray is tested
+	//against all four at once
+	struct ImplicitRayTracedBvhNode
+	{
+		float minimumX[4];
+		float minimumY[4];
+		float minimumZ[4];
+		float maximumX[4];
+		float maximumY[4];
+		float maximumZ[4];
+		//Another node for an inner child, the first of a leaf child's primitives, or EmptyChild
+		unsigned int children[4];
+		//How many primitives a leaf child has, 0 for an inner child or an empty one
+		unsigned int counts[4];
+	};
+
+	struct ImplicitRayTracedHit
+	{
+		float distance;
+		//In GetPrimitives, which is in the BVH's order rather than the one it was built from
+		unsigned int primitive;
+	};
+
+	//What a query did, added to by each one
+	struct ImplicitRayTracedBvhCount
+	{
+		ImplicitRayTracedBvhCount() : nodes(0), primitives(0) {}
+
+		unsigned long long nodes;
+		unsigned long long primitives;
+
+		void Add(const ImplicitRayTracedBvhCount& other) { nodes += other.nodes; primitives += other.primitives; }
+	};
+
+	//A bounding volume hierarchy over spheres, tetrahedra and boxes for ImplicitRayTracer and ImplicitRayTracedModelsPS.hlsl.
+	//The build is top down, each node split where the surface area heuristic is lowest over 16 bins of the centroids on
+	//each axis, with big subtrees built as tasks on the thread pool. The binary tree is then collapsed into nodes of four
+	//children, opening whichever child has the most area until there are four, and flattened depth first into one array.
+	//Traversal keeps a stack of nodes, tests all four of a node's children at once with DirectXMath's vectors, goes
+	//through the leaves it hits and pushes the rest furthest first, so the nearest is visited next
+	class ImplicitRayTracedBvh
+	{
+	public:
+		static const unsigned int EmptyChild = 0xFFFFFFFF;
+		//Most primitives a leaf can have, unless the tree gets to MaxBuildDepth
+		static const unsigned int MaxLeafSize = 8;
+		static const unsigned int MaxBuildDepth = 64;
+		//Entries a traversal's stack can hold. Each node takes one off and puts at most four on, and the collapsed tree is
+		//no deeper than MaxBuildDepth, so this never runs out
+		static const unsigned int StackSize = 3 * (MaxBuildDepth - 1) + 1;
+		//Most rays a packet query takes at once, one bit each in its result
+		static const unsigned int PacketSize = 8;
+
+		ImplicitRayTracedBvh() : m_depth(0), m_leafCount(0), m_milliseconds(0.0) {}
+		//parallel builds the subtrees with more than a few thousand primitives as tasks
+		explicit ImplicitRayTracedBvh(const std::vector<ImplicitRayTracedPrimitive>& primitives, bool parallel = true);
+
+		//The root is node 0, when there are any primitives
+		const std::vector<ImplicitRayTracedBvhNode>& GetNodes() const { return m_nodes; }
+		//The primitives built from, each leaf's next to each other
+		const std::vector<ImplicitRayTracedPrimitive>& GetPrimitives() const { return m_primitives; }
+
+		//Nodes from the root to the deepest leaf's
+		unsigned int GetDepth() const { return m_depth; }
+		unsigned int GetLeafCount() const { return m_leafCount; }
+		//The stack a traversal can need at most, which the shader's has to be as big as
+		unsigned int GetStackSize() const { return m_depth > 0 ? 3 * (m_depth - 1) + 1 : 0; }
+		//The expected cost of a ray by the surface area heuristic, in primitive tests with a node test costing the same
+		double GetSahCost() const;
+		double GetMilliseconds() const { return m_milliseconds; }
+
+		//The nearest primitive the ray enters between tMin and tMax. direction must be normalised
+		bool NearestHit(const Sdf::Vec3<float>& origin, const Sdf::Vec3<float>& direction, float tMin, float tMax, ImplicitRayTracedHit& hit, ImplicitRayTracedBvhCount* count = nullptr) const;
+		//Whether the ray enters any primitive between tMin and tMax, stopping at the first it finds
+		bool AnyHit(const Sdf::Vec3<float>& origin, const Sdf::Vec3<float>& direction, float tMin, float tMax, ImplicitRayTracedBvhCount* count = nullptr) const;
+
+		//The same for up to PacketSize rays at once, each with its own tMax, which go down the tree together. A node is
+		//fetched and put on the stack once for all the rays that entered its parent's box for it rather than once for each,
+		//which is what rays that start near each other going the same way save. Bit n is set in the result when ray n hit,
+		//with the nearest hit in hits[n]. count has each ray's node tests, as though it had been traced alone
+		unsigned int NearestHitPacket(const Sdf::Vec3<float>* origins, const Sdf::Vec3<float>* directions, unsigned int rayCount, float tMin, const float* tMax, ImplicitRayTracedHit* hits, ImplicitRayTracedBvhCount* count = nullptr) const;
+		unsigned int AnyHitPacket(const Sdf::Vec3<float>* origins, const Sdf::Vec3<float>* directions, unsigned int rayCount, float tMin, const float* tMax, ImplicitRayTracedBvhCount* count = nullptr) const;
+
+		//The same over every primitive in turn without the tree, the way the shader used to
+		bool NearestHitLinear(const Sdf::Vec3<float>& origin, const Sdf::Vec3<float>& direction, float tMin, float tMax, ImplicitRayTracedHit& hit, ImplicitRayTracedBvhCount* count = nullptr) const;
+		bool AnyHitLinear(const Sdf::Vec3<float>& origin, const Sdf::Vec3<float>& direction, float tMin, float tMax, ImplicitRayTracedBvhCount* count = nullptr) const;
+
+		//Where the ray enters the primitive, only when it's between tMin and tMax. A ray starting inside doesn't hit it
+		static bool Intersect(const ImplicitRayTracedPrimitive& primitive, const Sdf::Vec3<float>& origin, const Sdf::Vec3<float>& direction, float tMin, float tMax, float& distance);
+		//The outward normal at a point on the primitive's surface
+		static Sdf::Vec3<float> GetNormal(const ImplicitRayTracedPrimitive& primitive, const Sdf::Vec3<float>& surfacePoint);
+		static void GetBounds(const ImplicitRayTracedPrimitive& primitive, Sdf::Vec3<float>& minimum, Sdf::Vec3<float>& maximum);
+
+	private:
+		template <bool AnyHitOnly>
+		bool Traverse(const Sdf::Vec3<float>& origin, const Sdf::Vec3<float>& direction, float tMin, float tMax, ImplicitRayTracedHit& hit, ImplicitRayTracedBvhCount* count) const;
+		template <bool AnyHitOnly>
+		unsigned int TraversePacket(const Sdf::Vec3<float>* origins, const Sdf::Vec3<float>* directions, unsigned int rayCount, float tMin, const float* tMax, ImplicitRayTracedHit* hits, ImplicitRayTracedBvhCount* count) const;
+
+		std::vector<ImplicitRayTracedBvhNode> m_nodes;
+		std::vector<ImplicitRayTracedPrimitive> m_primitives;
+		unsigned int m_depth;
+		unsigned int m_leafCount;
+		double m_milliseconds;
+	};
+}
@@ -1,10 +1,15 @@
 #include "pch.h"
 #include "ImplicitRayTracedModels.h"
+#include "ImplicitRayMarcher.h"
+#include "ImplicitRayTracer.h"
 
 using namespace AlienPlanetACW;
 
-ImplicitRayTracedModels::ImplicitRayTracedModels(const std::shared_ptr<DX::DeviceResources>& deviceResources) : m_deviceResources(deviceResources), m_loadingComplete(false), m_indexCount(0)
+ImplicitRayTracedModels::ImplicitRayTracedModels(const std::shared_ptr<DX::DeviceResources>& deviceResources) : m_deviceResources(deviceResources), m_loadingComplete(false), m_indexCount(0), m_bvh(ImplicitRayTracer::GetScenePrimitives()), m_rasterDepthWidth(0), m_rasterDepthHeight(0), m_checkerboardWidth(0), m_checkerboardHeight(0), m_checkerboardHistory(0)
 {
+	m_checkerboardBufferData.checkerboardFrame = 0;
+	m_checkerboardBufferData.historyValid = 0;
+
 	CreateDeviceDependentResources();
 }
 
@@ -67,10 +72,24 @@ void ImplicitRayTracedModels::CreateDeviceDependentResources()
 		CD3D11_BUFFER_DESC timeBufferDescription(sizeof(TotalTimeConstantBuffer), D3D11_BIND_CONSTANT_BUFFER);
 
 		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateBuffer(&timeBufferDescription, nullptr, &m_timeBuffer));
+
+		UploadBvh();
 	});
 
+	auto createCheckerboardTask = UseCheckerboard
+		? (DX::ReadDataAsync(L"ImplicitCheckerboardResolvePS.cso").then([this](const std::vector<byte>& fileData) {
+			DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreatePixelShader(&fileData[0], fileData.size(), nullptr, &m_checkerboardResolvePixelShader));
+
+			CD3D11_BUFFER_DESC checkerboardBufferDescription(sizeof(ImplicitCheckerboardConstantBuffer), D3D11_BIND_CONSTANT_BUFFER);
+
+			DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateBuffer(&checkerboardBufferDescription, nullptr, &m_checkerboardBuffer));
+		}) && DX::ReadDataAsync(L"ImplicitCheckerboardCompositePS.cso").then([this](const std::vector<byte>& fileData) {
+			DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreatePixelShader(&fileData[0], fileData.size(), nullptr, &m_checkerboardCompositePixelShader));
+		}))
+		: concurrency::create_task([]() {});
+
 	// Once both shaders are loaded, create the mesh.
-	auto createGrassPoints = (createPSTask && createVSTask).then([this]() {
+	auto createGrassPoints = (createPSTask && createVSTask && createCheckerboardTask).then([this]() {
 
 		// Load mesh vertices. Each vertex has a position and a color.
 		static const VertexPosition quadVertices[] =
@@ -150,6 +169,233 @@ void ImplicitRayTracedModels::ReleaseDeviceDependentResources()
 	m_cameraBuffer.Reset();
 	m_vertexBuffer.Reset();
 	m_indexBuffer.Reset();
+	m_primitiveView.Reset();
+	m_primitiveBuffer.Reset();
+	m_nodeView.Reset();
+	m_nodeBuffer.Reset();
+	m_rasterDepthView.Reset();
+	m_rasterDepth.Reset();
+	m_rasterDepthWidth = 0;
+	m_rasterDepthHeight = 0;
+	m_checkerboardResolvePixelShader.Reset();
+	m_checkerboardCompositePixelShader.Reset();
+	m_checkerboardBuffer.Reset();
+	m_checkerboardColoursView.Reset();
+	m_checkerboardColoursTarget.Reset();
+	m_checkerboardColours.Reset();
+	m_checkerboardHitsView.Reset();
+	m_checkerboardHitsTarget.Reset();
+	m_checkerboardHits.Reset();
+
+	for (auto frame = 0u; frame < 2; frame++)
+	{
+		m_checkerboardHistoryColourViews[frame].Reset();
+		m_checkerboardHistoryColourTargets[frame].Reset();
+		m_checkerboardHistoryColours[frame].Reset();
+		m_checkerboardHistoryHitViews[frame].Reset();
+		m_checkerboardHistoryHitTargets[frame].Reset();
+		m_checkerboardHistoryHits[frame].Reset();
+	}
+
+	m_checkerboardWidth = 0;
+	m_checkerboardHeight = 0;
+	m_checkerboardBufferData.historyValid = 0;
+}
+
+void ImplicitRayTracedModels::SetPrimitives(const std::vector<ImplicitRayTracedPrimitive>& primitives)
+{
+	ImplicitRayTracedBvh bvh(primitives);
+	ThrowIfTooDeep(bvh);
+
+	m_bvh = std::move(bvh);
+
+	if (m_loadingComplete)
+	{
+		UploadBvh();
+	}
+}
+
+void ImplicitRayTracedModels::UploadBvh()
+{
+	ThrowIfTooDeep(m_bvh);
+
+	m_primitiveView.Reset();
+	m_primitiveBuffer.Reset();
+	m_nodeView.Reset();
+	m_nodeBuffer.Reset();
+
+	//Nothing to draw, and a buffer can't be empty
+	if (m_bvh.GetNodes().empty())
+	{
+		return;
+	}
+
+	const auto& primitives = m_bvh.GetPrimitives();
+	const auto& nodes = m_bvh.GetNodes();
+
+	D3D11_SUBRESOURCE_DATA primitiveData = { 0 };
+	primitiveData.pSysMem = primitives.data();
+
+	CD3D11_BUFFER_DESC primitiveBufferDescription(static_cast<UINT>(primitives.size() * sizeof(ImplicitRayTracedPrimitive)), D3D11_BIND_SHADER_RESOURCE, D3D11_USAGE_IMMUTABLE, 0, D3D11_RESOURCE_MISC_BUFFER_STRUCTURED, sizeof(ImplicitRayTracedPrimitive));
+
+	DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateBuffer(&primitiveBufferDescription, &primitiveData, &m_primitiveBuffer));
+
+	CD3D11_SHADER_RESOURCE_VIEW_DESC primitiveViewDescription(m_primitiveBuffer.Get(), DXGI_FORMAT_UNKNOWN, 0, static_cast<UINT>(primitives.size()));
+
+	DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateShaderResourceView(m_primitiveBuffer.Get(), &primitiveViewDescription, &m_primitiveView));
+
+	D3D11_SUBRESOURCE_DATA nodeData = { 0 };
+	nodeData.pSysMem = nodes.data();
+
+	CD3D11_BUFFER_DESC nodeBufferDescription(static_cast<UINT>(nodes.size() * sizeof(ImplicitRayTracedBvhNode)), D3D11_BIND_SHADER_RESOURCE, D3D11_USAGE_IMMUTABLE, 0, D3D11_RESOURCE_MISC_BUFFER_STRUCTURED, sizeof(ImplicitRayTracedBvhNode));
+
+	DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateBuffer(&nodeBufferDescription, &nodeData, &m_nodeBuffer));
+
+	CD3D11_SHADER_RESOURCE_VIEW_DESC nodeViewDescription(m_nodeBuffer.Get(), DXGI_FORMAT_UNKNOWN, 0, static_cast<UINT>(nodes.size()));
+
+	DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateShaderResourceView(m_nodeBuffer.Get(), &nodeViewDescription, &m_nodeView));
+}
+
+void ImplicitRayTracedModels::ThrowIfTooDeep(const ImplicitRayTracedBvh& bvh)
+{
+	if (bvh.GetStackSize() > ShaderStackSize)
+	{
+		throw ref new Platform::InvalidArgumentException(L"The BVH is too deep for ImplicitRayTracedModelsPS.hlsl's traversal stack");
+	}
+}
+
+void ImplicitRayTracedModels::CopyRasterDepth()
+{
+	auto context = m_deviceResources->GetD3DDeviceContext();
+
+	Microsoft::WRL::ComPtr<ID3D11RenderTargetView> renderTarget;
+	Microsoft::WRL::ComPtr<ID3D11DepthStencilView> depthStencil;
+	context->OMGetRenderTargets(1, &renderTarget, &depthStencil);
+
+	Microsoft::WRL::ComPtr<ID3D11Resource> depthBuffer;
+	depthStencil->GetResource(&depthBuffer);
+
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> depthTexture;
+	DX::ThrowIfFailed(depthBuffer.As(&depthTexture));
+
+	D3D11_TEXTURE2D_DESC depthBufferDescription;
+	depthTexture->GetDesc(&depthBufferDescription);
+
+	if (depthBufferDescription.Width != m_rasterDepthWidth || depthBufferDescription.Height != m_rasterDepthHeight)
+	{
+		//The same as the depth buffer so it can be copied, but typeless so the depth can be read as well
+		CD3D11_TEXTURE2D_DESC rasterDepthDescription(DXGI_FORMAT_R24G8_TYPELESS, depthBufferDescription.Width, depthBufferDescription.Height, 1, 1, D3D11_BIND_SHADER_RESOURCE);
+		CD3D11_SHADER_RESOURCE_VIEW_DESC rasterDepthViewDescription(D3D11_SRV_DIMENSION_TEXTURE2D, DXGI_FORMAT_R24_UNORM_X8_TYPELESS);
+
+		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateTexture2D(&rasterDepthDescription, nullptr, &m_rasterDepth));
+		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateShaderResourceView(m_rasterDepth.Get(), &rasterDepthViewDescription, &m_rasterDepthView));
+
+		m_rasterDepthWidth = depthBufferDescription.Width;
+		m_rasterDepthHeight = depthBufferDescription.Height;
+	}
+
+	//Everything drawn before the rays, the marched models included, copied because the depth buffer can't be read while
+	//it's bound
+	context->CopyResource(m_rasterDepth.Get(), depthTexture.Get());
+}
+
+void ImplicitRayTracedModels::CreateCheckerboard(const unsigned int width, const unsigned int height)
+{
+	//A column of texels per two pixels, the odd one at the edge included
+	CD3D11_TEXTURE2D_DESC coloursDescription(DXGI_FORMAT_R16G16B16A16_FLOAT, (width + 1) / 2, height, 1, 1, D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE);
+	CD3D11_TEXTURE2D_DESC hitsDescription(DXGI_FORMAT_R32G32_FLOAT, (width + 1) / 2, height, 1, 1, D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE);
+
+	DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateTexture2D(&coloursDescription, nullptr, &m_checkerboardColours));
+	DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateRenderTargetView(m_checkerboardColours.Get(), nullptr, &m_checkerboardColoursTarget));
+	DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateShaderResourceView(m_checkerboardColours.Get(), nullptr, &m_checkerboardColoursView));
+	DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateTexture2D(&hitsDescription, nullptr, &m_checkerboardHits));
+	DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateRenderTargetView(m_checkerboardHits.Get(), nullptr, &m_checkerboardHitsTarget));
+	DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateShaderResourceView(m_checkerboardHits.Get(), nullptr, &m_checkerboardHitsView));
+
+	coloursDescription.Width = width;
+	hitsDescription.Width = width;
+
+	for (auto frame = 0u; frame < 2; frame++)
+	{
+		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateTexture2D(&coloursDescription, nullptr, &m_checkerboardHistoryColours[frame]));
+		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateRenderTargetView(m_checkerboardHistoryColours[frame].Get(), nullptr, &m_checkerboardHistoryColourTargets[frame]));
+		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateShaderResourceView(m_checkerboardHistoryColours[frame].Get(), nullptr, &m_checkerboardHistoryColourViews[frame]));
+		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateTexture2D(&hitsDescription, nullptr, &m_checkerboardHistoryHits[frame]));
+		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateRenderTargetView(m_checkerboardHistoryHits[frame].Get(), nullptr, &m_checkerboardHistoryHitTargets[frame]));
+		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateShaderResourceView(m_checkerboardHistoryHits[frame].Get(), nullptr, &m_checkerboardHistoryHitViews[frame]));
+	}
+
+	m_checkerboardWidth = width;
+	m_checkerboardHeight = height;
+	m_checkerboardHistory = 0;
+	m_checkerboardBufferData.historyValid = 0;
+}
+
+void ImplicitRayTracedModels::BeginCheckerboard(const D3D11_VIEWPORT& viewport)
+{
+	auto context = m_deviceResources->GetD3DDeviceContext();
+
+	const auto width = static_cast<unsigned int>(viewport.Width);
+	const auto height = static_cast<unsigned int>(viewport.Height);
+
+	if (width != m_checkerboardWidth || height != m_checkerboardHeight)
+	{
+		CreateCheckerboard(width, height);
+	}
+
+	m_checkerboardBufferData.previousView = m_previousView;
+	m_checkerboardBufferData.screenSize = DirectX::XMFLOAT2(viewport.Width, viewport.Height);
+
+	context->UpdateSubresource1(m_checkerboardBuffer.Get(), 0, NULL, &m_checkerboardBufferData, 0, 0, 0);
+	context->PSSetConstantBuffers1(4, 1, m_checkerboardBuffer.GetAddressOf(), nullptr, nullptr);
+
+	//Misses are discarded, so they keep no hit
+	const float noColour[] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	const float noHit[] = { ImplicitSceneSdf::MaxDistance, static_cast<float>(ImplicitRayMarcherCache::NoObject), 0.0f, 0.0f };
+
+	context->ClearRenderTargetView(m_checkerboardColoursTarget.Get(), noColour);
+	context->ClearRenderTargetView(m_checkerboardHitsTarget.Get(), noHit);
+
+	//Nothing is depth tested until the composite, as the depth buffer is a different size
+	const auto tracedViewport = CD3D11_VIEWPORT(viewport.TopLeftX, viewport.TopLeftY, static_cast<float>((width + 1) / 2), viewport.Height);
+	ID3D11RenderTargetView* const targets[] = { m_checkerboardColoursTarget.Get(), m_checkerboardHitsTarget.Get() };
+
+	context->RSSetViewports(1, &tracedViewport);
+	context->OMSetRenderTargets(2, targets, nullptr);
+}
+
+void ImplicitRayTracedModels::ResolveCheckerboard(const D3D11_VIEWPORT& viewport, ID3D11RenderTargetView* const renderTarget, ID3D11DepthStencilView* const depthStencil)
+{
+	auto context = m_deviceResources->GetD3DDeviceContext();
+
+	ID3D11ShaderResourceView* const noTextures[] = { nullptr, nullptr, nullptr, nullptr, nullptr };
+	ID3D11RenderTargetView* const historyTargets[] = { m_checkerboardHistoryColourTargets[m_checkerboardHistory].Get(), m_checkerboardHistoryHitTargets[m_checkerboardHistory].Get() };
+	ID3D11ShaderResourceView* const resolveTextures[] = { m_checkerboardColoursView.Get(), m_checkerboardHitsView.Get(), m_checkerboardHistoryColourViews[1 - m_checkerboardHistory].Get(), m_checkerboardHistoryHitViews[1 - m_checkerboardHistory].Get(), nullptr };
+
+	//Unbound as targets before they're read
+	context->OMSetRenderTargets(2, historyTargets, nullptr);
+	context->RSSetViewports(1, &viewport);
+	context->PSSetShader(m_checkerboardResolvePixelShader.Get(), nullptr, 0);
+	context->PSSetShaderResources(0, 5, resolveTextures);
+
+	context->DrawIndexed(m_indexCount, 0, 0);
+
+	ID3D11ShaderResourceView* const compositeTextures[] = { m_checkerboardHistoryColourViews[m_checkerboardHistory].Get(), m_checkerboardHistoryHitViews[m_checkerboardHistory].Get() };
+
+	context->PSSetShaderResources(0, 5, noTextures);
+	context->OMSetRenderTargets(1, &renderTarget, depthStencil);
+	context->PSSetShader(m_checkerboardCompositePixelShader.Get(), nullptr, 0);
+	context->PSSetShaderResources(0, 2, compositeTextures);
+
+	context->DrawIndexed(m_indexCount, 0, 0);
+
+	//This frame's image is read by the next frame's resolve
+	context->PSSetShaderResources(0, 2, noTextures);
+
+	m_previousView = m_MVPBufferData.view;
+	m_checkerboardHistory = 1 - m_checkerboardHistory;
+	m_checkerboardBufferData.checkerboardFrame++;
+	m_checkerboardBufferData.historyValid = 1;
 }
 
 void ImplicitRayTracedModels::Update(DX::StepTimer const& timer)
@@ -162,7 +408,7 @@ void ImplicitRayTracedModels::Update(DX::StepTimer const& timer)
 void ImplicitRayTracedModels::Render()
 {
 	// Loading is asynchronous. Only draw geometry after it's loaded.
-	if (!m_loadingComplete)
+	if (!m_loadingComplete || m_nodeView == nullptr)
 	{
 		return;
 	}
@@ -301,6 +547,33 @@ void ImplicitRayTracedModels::Render()
 		nullptr
 	);
 
+	ID3D11ShaderResourceView* const bvhViews[] = { m_primitiveView.Get(), m_nodeView.Get() };
+	context->PSSetShaderResources(0, 2, bvhViews);
+
+	if (UseDepthLimits)
+	{
+		CopyRasterDepth();
+
+		context->PSSetShaderResources(2, 1, m_rasterDepthView.GetAddressOf());
+	}
+
+	Microsoft::WRL::ComPtr<ID3D11RenderTargetView> renderTarget;
+	Microsoft::WRL::ComPtr<ID3D11DepthStencilView> depthStencil;
+
+	//The full screen's, which checkerboard swaps for one half its width for the traced pass
+	D3D11_VIEWPORT screenViewport = {};
+
+	if (UseCheckerboard)
+	{
+		auto viewportCount = 1u;
+		context->RSGetViewports(&viewportCount, &screenViewport);
+
+		//Put back once the finished image is drawn over the scene
+		context->OMGetRenderTargets(1, &renderTarget, &depthStencil);
+
+		BeginCheckerboard(screenViewport);
+	}
+
 	// Attach our pixel shader.
 	context->PSSetShader(
 		m_pixelShader.Get(),
@@ -314,4 +587,17 @@ void ImplicitRayTracedModels::Render()
 		0,
 		0
 	);
+
+	if (UseCheckerboard)
+	{
+		ResolveCheckerboard(screenViewport, renderTarget.Get(), depthStencil.Get());
+	}
+
+	if (UseDepthLimits)
+	{
+		//Copied into again by the next frame
+		ID3D11ShaderResourceView* const noDepth[] = { nullptr };
+
+		context->PSSetShaderResources(2, 1, noDepth);
+	}
 }
\ No newline at end of file
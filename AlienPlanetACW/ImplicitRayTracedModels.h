@@ -4,6 +4,7 @@
 #include "..\Common\DirectXHelper.h"
 #include "..\Content\ShaderStructures.h"
 #include "..\Common\StepTimer.h"
+#include "ImplicitRayTracedBvh.h"
 
 #include <DirectXMath.h>
 
@@ -13,6 +14,9 @@ namespace AlienPlanetACW
 	class ImplicitRayTracedModels
 	{
 	public:
+		//STACK_SIZE in ImplicitRayTracedModelsPS.hlsl, which a BVH's GetStackSize has to be within to be uploaded
+		static const unsigned int ShaderStackSize = 64;
+
 		ImplicitRayTracedModels(const std::shared_ptr<DX::DeviceResources>& deviceResources);
 		void CreateDeviceDependentResources();
 		void SetViewProjectionMatrixConstantBuffer(DirectX::XMMATRIX& view, DirectX::XMMATRIX& projection);
@@ -20,10 +24,37 @@ namespace AlienPlanetACW
 		void SetCameraPositionConstantBuffer(DirectX::XMFLOAT3& cameraPosition);
 		void ReleaseDeviceDependentResources();
 
+		//Rebuilds the BVH the shader traverses over these instead of ImplicitRayTracer::GetScenePrimitives. Throws, keeping
+		//the BVH it had, when the new one is too deep for the shader's stack
+		void SetPrimitives(const std::vector<ImplicitRayTracedPrimitive>& primitives);
+
 		void Update(DX::StepTimer const& timer);
 		void Render();
 
 	private:
+		//Has to match DEPTH_LIMITS in ImplicitRayTracedModelsPS.hlsl. The depth buffer is copied before the pass, and each
+		//primary ray stops where it would be behind what's been drawn there, so the image is the same either way. Off
+		//for the same reason as ImplicitRayModels::UseDepthLimits
+		static const bool UseDepthLimits = false;
+
+		//Has to match CHECKERBOARD in ImplicitRayTracedModelsPS.hlsl. The pass traces half the pixels, bounces and all,
+		//into textures half the screen's width, and ImplicitRayModels' resolve and composite shaders fill in the rest and
+		//draw it to the screen. Not with ImplicitRayModels::UseDepthLimits, as the resolve would read limits this pass
+		//doesn't have
+		static const bool UseCheckerboard = false;
+
+		//Copies the bound depth buffer into m_rasterDepth, which is remade when the buffer's size changes
+		void CopyRasterDepth();
+
+		void CreateCheckerboard(unsigned int width, unsigned int height);
+		void BeginCheckerboard(const D3D11_VIEWPORT& viewport);
+		void ResolveCheckerboard(const D3D11_VIEWPORT& viewport, ID3D11RenderTargetView* renderTarget, ID3D11DepthStencilView* depthStencil);
+
+		//The BVH's nodes and primitives as the shader's structured buffers
+		void UploadBvh();
+		//Throws when a traversal of the BVH could need more than ShaderStackSize entries, as the shader would drop nodes
+		static void ThrowIfTooDeep(const ImplicitRayTracedBvh& bvh);
+
 		std::shared_ptr<DX::DeviceResources> m_deviceResources;
 
 		Microsoft::WRL::ComPtr<ID3D11InputLayout>	m_inputLayout;
@@ -32,6 +63,8 @@ namespace AlienPlanetACW
 
 		Microsoft::WRL::ComPtr<ID3D11VertexShader>	m_vertexShader;
 		Microsoft::WRL::ComPtr<ID3D11PixelShader>	m_pixelShader;
+		Microsoft::WRL::ComPtr<ID3D11PixelShader>	m_checkerboardResolvePixelShader;
+		Microsoft::WRL::ComPtr<ID3D11PixelShader>	m_checkerboardCompositePixelShader;
 
 		Microsoft::WRL::ComPtr<ID3D11RasterizerState> m_rasterizerState;
 
@@ -39,11 +72,45 @@ namespace AlienPlanetACW
 		Microsoft::WRL::ComPtr<ID3D11Buffer>		m_cameraBuffer;
 		Microsoft::WRL::ComPtr<ID3D11Buffer>		m_timeBuffer;
 		Microsoft::WRL::ComPtr<ID3D11Buffer>		m_inverseViewBuffer;
+		Microsoft::WRL::ComPtr<ID3D11Buffer>		m_checkerboardBuffer;
+
+		Microsoft::WRL::ComPtr<ID3D11Buffer>				m_primitiveBuffer;
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>	m_primitiveView;
+		Microsoft::WRL::ComPtr<ID3D11Buffer>				m_nodeBuffer;
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>	m_nodeView;
+
+		Microsoft::WRL::ComPtr<ID3D11Texture2D>				m_rasterDepth;
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>	m_rasterDepthView;
+		unsigned int										m_rasterDepthWidth;
+		unsigned int										m_rasterDepthHeight;
+
+		//The same as ImplicitRayModels' checkerboard textures, with the traced colours and hits
+		Microsoft::WRL::ComPtr<ID3D11Texture2D>				m_checkerboardColours;
+		Microsoft::WRL::ComPtr<ID3D11RenderTargetView>		m_checkerboardColoursTarget;
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>	m_checkerboardColoursView;
+		Microsoft::WRL::ComPtr<ID3D11Texture2D>				m_checkerboardHits;
+		Microsoft::WRL::ComPtr<ID3D11RenderTargetView>		m_checkerboardHitsTarget;
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>	m_checkerboardHitsView;
+		Microsoft::WRL::ComPtr<ID3D11Texture2D>				m_checkerboardHistoryColours[2];
+		Microsoft::WRL::ComPtr<ID3D11RenderTargetView>		m_checkerboardHistoryColourTargets[2];
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>	m_checkerboardHistoryColourViews[2];
+		Microsoft::WRL::ComPtr<ID3D11Texture2D>				m_checkerboardHistoryHits[2];
+		Microsoft::WRL::ComPtr<ID3D11RenderTargetView>		m_checkerboardHistoryHitTargets[2];
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>	m_checkerboardHistoryHitViews[2];
+		unsigned int										m_checkerboardWidth;
+		unsigned int										m_checkerboardHeight;
+		//Which of m_checkerboardHistoryColours and Hits this frame writes
+		unsigned int										m_checkerboardHistory;
+		//The view the last finished image was drawn from, transposed like m_MVPBufferData's
+		DirectX::XMFLOAT4X4									m_previousView;
 
 		ModelViewProjectionConstantBuffer			m_MVPBufferData;
 		CameraPositionConstantBuffer				m_cameraBufferData;
 		TotalTimeConstantBuffer						m_timeBufferData;
 		InverseViewConstantBuffer					m_inverseViewBufferData;
+		ImplicitCheckerboardConstantBuffer			m_checkerboardBufferData;
+
+		ImplicitRayTracedBvh						m_bvh;
 
 		uint32	m_indexCount;
 
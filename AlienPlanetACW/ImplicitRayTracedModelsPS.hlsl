@@ -36,33 +36,73 @@ static float EPSILON = 0.0001;
 static float4 lightColour = float4(1.0f, 1.0f, 1.0f, 1.0f);
 static float3 lightPosition = float3(0.0f, 3.0f, 0.0f);
 
-struct RayTraceSphere
+//A ray to the light from each hit, which is shadowed when it hits anything, ImplicitRayTracerSettings::shadows
+#define SHADOWS 1
+//Mirror bounces after the primary hit
+#define REFLECTIONS 3
+
+#define PRIMITIVE_SPHERE 0
+#define PRIMITIVE_TETRAHEDRON 1
+#define PRIMITIVE_BOX 2
+
+//1 to stop each primary ray where the rasterized scene is in front of it, from a copy of the depth buffer taken before
+//the pass. Anything further would fail the depth test. UseDepthLimits in ImplicitRayTracedModels has to match
+#define DEPTH_LIMITS 0
+
+#if DEPTH_LIMITS
+#include "ImplicitDepthLimits.hlsli"
+
+Texture2D<float> rasterDepth : register(t2);
+#endif
+
+//1 to trace the pixels where x + y + frame is even into textures half the screen's width, which
+//ImplicitCheckerboardResolvePS.hlsl fills in the other half from, the same as ImplicitRayModelsPS.hlsl's CHECKERBOARD.
+//UseCheckerboard in ImplicitRayTracedModels has to match
+#define CHECKERBOARD 0
+
+#if CHECKERBOARD
+#include "ImplicitCheckerboard.hlsli"
+#endif
+
+#define EMPTY_CHILD 0xFFFFFFFF
+//Nodes a traversal's stack can hold, ImplicitRayTracedModels::ShaderStackSize, which won't upload a BVH whose
+//GetStackSize is over it. A push past it would drop the node rather than write off the end
+#define STACK_SIZE 64
+
+//ImplicitRayTracedPrimitive, a sphere's radius or a tetrahedron's size in size.x and a box's half sizes
+struct RayTracedPrimitive
 {
 	float3 centre;
-	float radius;
+	uint type;
+	float3 size;
+	float shininess;
 	float4 colour;
-	float Kd, Ks, Kr, shininess;
-};
-
-static RayTraceSphere objects[3] = {
-	//Sphere1
-	{-1.5, 1.5f, 0.9, 0.0075, 1.0, 0.0, 0.0, 1.0, 0.3, 0.5, 0.7, 40.0f},
-	//Sphere2
-	{-1.8, 1.3f, 1.0, 0.004, 0.0, 1.0, 0.0, 1.0, 0.5, 0.7, 0.4, 40.0f},
-	//Sphere3
-	{-1.6, 1.4f, 1.3, 0.01, 1.0, 0.0, 1.0, 1.0, 0.5, 5.0, 0.3, 40.0f}
+	float Kd, Ks, Kr, padding3;
 };
 
-struct RayTraceTetra
+//ImplicitRayTracedBvhNode, four children's boxes side by side. children is another node for an inner child and the
+//first of its primitives for a leaf, which has a count
+struct RayTracedBvhNode
 {
-	float3 centre;
-	float size;
-	float4 colour;
-	float Kd, Ks, Kr, shininess;
+	float4 minimumX;
+	float4 minimumY;
+	float4 minimumZ;
+	float4 maximumX;
+	float4 maximumY;
+	float4 maximumZ;
+	uint4 children;
+	uint4 counts;
 };
 
-static RayTraceTetra objectss[1] = {
-	{-1.2, 1.5f, 1.3, 0.05, 1.0, 0.0, 0.0, 1.0, 0.6, 0.2, 0.3, 40.0f}
+StructuredBuffer<RayTracedPrimitive> primitives : register(t0);
+StructuredBuffer<RayTracedBvhNode> nodes : register(t1);
+
+//The faces of a tetrahedron, each opposite a vertex and facing away from it
+static float3 tetrahedronNormals[4] = {
+	float3(-0.57735027, -0.57735027, -0.57735027),
+	float3(-0.57735027, 0.57735027, 0.57735027),
+	float3(0.57735027, -0.57735027, 0.57735027),
+	float3(0.57735027, 0.57735027, -0.57735027)
 };
 
 struct Ray {
@@ -71,140 +111,227 @@ struct Ray {
 
 };
 
-float  plane(float3 p, float3 origin, float3 normal) {
-	return dot(p - origin, normal);
+//Nudged off zero, so a ray along an axis never multiplies zero by infinity in a slab test
+float3 InverseDirection(float3 d)
+{
+	return 1.0 / (abs(d) > 1e-8 ? d : (d < 0.0 ? -1e-8 : 1e-8));
 }
 
-float TetrahedranIntersect(RayTraceTetra t, Ray ray, out bool hit)
+//Where the ray enters the primitive, a hit only between tMin and tMax. A ray starting inside doesn't hit it
+bool Intersect(RayTracedPrimitive p, Ray ray, float tMin, float tMax, out float t)
 {
-	float dn = 1.0 / sqrt(3.0);
+	float3 offset = ray.o - p.centre;
 
-	//float3 v = s.centre - ray.o;
-	//float A = dot(v, ray.d);
+	if (p.type == PRIMITIVE_SPHERE)
+	{
+		float b = dot(offset, ray.d);
+		float c = dot(offset, offset) - p.size.x * p.size.x;
+		float disc = b * b - c;
 
-	float p = t.centre;
-	float d = t.size;
+		t = disc < 0.0 ? MAX_DIST * 2.0 : -b - sqrt(disc);
+	}
+	else if (p.type == PRIMITIVE_TETRAHEDRON)
+	{
+		//The intersection of four planes
+		float height = p.size.x * 0.57735027;
+		float entry = -MAX_DIST * 2.0;
+		float exit = MAX_DIST * 2.0;
 
-	//The tetrahedran is the intersection of four planes:
-	float sd1 = plane(p, float3(d, d, d), float3(-dn, dn, dn));
-	float sd2 = plane(p, float3(d, -d, -d), float3(dn, -dn, dn));
-	float sd3 = plane(p, float3(-d, d, -d), float3(dn, dn, -dn));
-	float sd4 = plane(p, float3(-d, -d, d), float3(-dn, -dn, -dn));
+		[unroll]
+		for (int i = 0; i < 4; i++)
+		{
+			float along = dot(tetrahedronNormals[i], ray.d);
+			float outside = dot(tetrahedronNormals[i], offset) - height;
 
-	float mint = max(max(sd1, sd2), max(sd3, sd4));
+			if (along == 0.0)
+			{
+				exit = outside > 0.0 ? -MAX_DIST * 2.0 : exit;
+			}
+			else if (along < 0.0)
+			{
+				entry = max(entry, -outside / along);
+			}
+			else
+			{
+				exit = min(exit, -outside / along);
+			}
+		}
 
-	if (mint < 0.002)
-	{
-		hit = true;
+		t = entry > exit ? MAX_DIST * 2.0 : entry;
 	}
 	else
 	{
-		hit = false;
+		float3 inverse = InverseDirection(ray.d);
+		float3 t0 = (-offset - p.size) * inverse;
+		float3 t1 = (-offset + p.size) * inverse;
+		float3 near = min(t0, t1);
+		float3 far = max(t0, t1);
+		float entry = max(max(near.x, near.y), near.z);
+		float exit = min(min(far.x, far.y), far.z);
+
+		t = entry > exit ? MAX_DIST * 2.0 : entry;
 	}
 
-	//max intersects shapes
-	return mint;
+	return t >= tMin && t <= tMax;
 }
 
-float SphereIntersect(RayTraceSphere s, Ray ray, out bool hit)
+float3 Normal(RayTracedPrimitive p, float3 pos)
 {
-	float t;
-	float3 v = s.centre - ray.o;
-	float A = dot(v, ray.d);
-	float B = dot(v, v) - A * A;
+	float3 offset = pos - p.centre;
 
-	float R = sqrt(s.radius);
-
-	if (B > R*R)
+	if (p.type == PRIMITIVE_SPHERE)
 	{
-		hit = false;
-		t = MAX_DIST;
+		return normalize(offset);
 	}
-	else
+
+	if (p.type == PRIMITIVE_TETRAHEDRON)
 	{
-		float disc = sqrt(R*R - B);
-		t = A - disc;
-		if (t < 0.0)
-		{
-			hit = false;
-		}
-		else
+		//The face the point is furthest out of
+		float3 n = tetrahedronNormals[0];
+		float furthest = dot(n, offset);
+
+		[unroll]
+		for (int i = 1; i < 4; i++)
 		{
-			hit = true;
+			float distance = dot(tetrahedronNormals[i], offset);
+
+			if (distance > furthest)
+			{
+				furthest = distance;
+				n = tetrahedronNormals[i];
+			}
 		}
+
+		return n;
 	}
 
-	return t;
-}
+	//The axis the point is furthest along relative to the box's size
+	float3 q = offset / p.size;
+	float3 a = abs(q);
 
-float3 SphereNormal(RayTraceSphere s, float3 pos)
-{
-	return normalize(pos - s.centre);
-}
+	if (a.x >= a.y && a.x >= a.z)
+	{
+		return float3(sign(q.x), 0.0, 0.0);
+	}
 
-float3 TetraNormal(RayTraceTetra t, float3 pos)
-{
-	return normalize(pos - t.centre);
+	return a.y >= a.z ? float3(0.0, sign(q.y), 0.0) : float3(0.0, 0.0, sign(q.z));
 }
 
-bool AnyHit(Ray ray)
+//Down ImplicitRayTracedBvh's tree from the root, testing each node's four children at once, going through the leaves
+//hit and pushing the other children furthest first so the nearest comes off next. anyHitOnly stops at the first hit
+bool Traverse(Ray ray, float tMin, float tMax, bool anyHitOnly, out int hitobj, out float mint)
 {
-	bool hit;
-	float t;
+	hitobj = -1;
+	mint = tMax;
+
+	uint nodeCount, stride;
+	nodes.GetDimensions(nodeCount, stride);
 
-	bool anyhit = false;
-	for (int i = 0; i < 3; i++)
+	if (nodeCount == 0)
 	{
-		t = SphereIntersect(objects[i], ray, hit);
-		if (hit)
-		{
-			anyhit = true;
-		}
+		return false;
 	}
 
-	//t = TetrahedranIntersect(objectss[0], ray, hit);
+	float3 inverse = InverseDirection(ray.d);
+	float3 offset = -ray.o * inverse;
 
-	//if (hit)
-	//{
-	//	anyhit = true;
-	//}
+	uint stack[STACK_SIZE];
+	uint top = 0;
+	stack[top++] = 0;
 
-	return anyhit;
-}
+	[loop]
+	while (top > 0)
+	{
+		RayTracedBvhNode node = nodes[stack[--top]];
 
-float3 NearestHit(Ray ray, out int hitobj, out bool anyhit, out float mint)
-{
-	bool hit = false;
-	mint = MAX_DIST;
-	hitobj = -1;
-	anyhit = false;
-	float t;
+		float4 x0 = node.minimumX * inverse.x + offset.x;
+		float4 x1 = node.maximumX * inverse.x + offset.x;
+		float4 y0 = node.minimumY * inverse.y + offset.y;
+		float4 y1 = node.maximumY * inverse.y + offset.y;
+		float4 z0 = node.minimumZ * inverse.z + offset.z;
+		float4 z1 = node.maximumZ * inverse.z + offset.z;
 
-	for (int i = 0; i < 3; i++)
-	{
-		t = SphereIntersect(objects[i], ray, hit);
-		if (hit)
+		float4 entry = max(max(min(x0, x1), min(y0, y1)), max(min(z0, z1), tMin));
+		float4 exit = min(min(max(x0, x1), max(y0, y1)), min(max(z0, z1), mint));
+
+		uint inner[4];
+		float innerEntries[4];
+		uint innerCount = 0;
+
+		[unroll]
+		for (uint slot = 0; slot < 4; slot++)
+		{
+			if (entry[slot] > exit[slot] || node.children[slot] == EMPTY_CHILD)
+			{
+				continue;
+			}
+
+			if (node.counts[slot] == 0)
+			{
+				inner[innerCount] = node.children[slot];
+				innerEntries[innerCount] = entry[slot];
+				innerCount++;
+				continue;
+			}
+
+			[loop]
+			for (uint primitive = node.children[slot]; primitive < node.children[slot] + node.counts[slot]; primitive++)
+			{
+				float t;
+
+				if (Intersect(primitives[primitive], ray, tMin, mint, t))
+				{
+					hitobj = (int)primitive;
+					mint = t;
+
+					if (anyHitOnly)
+					{
+						return true;
+					}
+				}
+			}
+		}
+
+		//Furthest first
+		[unroll]
+		for (uint i = 1; i < 4; i++)
 		{
-			if (t < mint)
+			[unroll]
+			for (uint j = i; j > 0; j--)
 			{
-				hitobj = i;
-				mint = t;
-				anyhit = true;
+				if (j < innerCount && innerEntries[j] > innerEntries[j - 1])
+				{
+					float entrySwap = innerEntries[j];
+					innerEntries[j] = innerEntries[j - 1];
+					innerEntries[j - 1] = entrySwap;
+
+					uint innerSwap = inner[j];
+					inner[j] = inner[j - 1];
+					inner[j - 1] = innerSwap;
+				}
 			}
 		}
+
+		for (uint k = 0; k < innerCount && top < STACK_SIZE; k++)
+		{
+			stack[top++] = inner[k];
+		}
 	}
 
-	//t = TetrahedranIntersect(objectss[0], ray, hit);
+	return hitobj >= 0;
+}
 
-	//if (hit)
-	//{
-	//	if (t < mint)
-	//	{
-	//		hitobj = 3;
-	//		mint = t;
-	//		anyhit = true;
-	//	}
-	//}
+bool AnyHit(Ray ray, float tMax)
+{
+	int hitobj;
+	float mint;
+
+	return Traverse(ray, EPSILON, tMax, true, hitobj, mint);
+}
+
+float3 NearestHit(Ray ray, float tMin, float tMax, out int hitobj, out bool anyhit, out float mint)
+{
+	anyhit = Traverse(ray, tMin, tMax, false, hitobj, mint);
 
 	return ray.o + ray.d*mint;
 }
@@ -222,37 +349,32 @@ float4 Phong(float3 n, float3 l, float3 v, float shininess, float4 diffuseColor,
 
 float4 Shade(float3 hitPos, float3 normal, Ray ray, int hitobj, float lightIntensity)
 {
-	float3 lightDir = normalize(lightPosition - hitPos);
-
-	float4 diff = (float4)0.0f;
-	float4 spec = (float4)0.0f;
-	float shininess = 0.0f;
-
-	//if (hitobj == 3)
-	//{
-	//	diff = objectss[0].colour * objectss[0].Kd;
-	//	spec = objectss[0].colour * objectss[0].Ks;
-	//	shininess = objectss[0].shininess;
-	//}
-	//else
-	{
-		diff = objects[hitobj].colour * objects[hitobj].Kd;
-		spec = objects[hitobj].colour * objects[hitobj].Ks;
-		shininess = objects[hitobj].shininess;
-	}
+	float3 toLight = lightPosition - hitPos;
+	float lightDistance = length(toLight);
+	float3 lightDir = toLight / lightDistance;
 
-	if (AnyHit(ray))
-	{
-		return lightColour * lightIntensity * Phong(normal, lightDir, ray.d, shininess, diff, spec);
-	}
-	else
+	RayTracedPrimitive p = primitives[hitobj];
+
+	float4 diff = p.colour * p.Kd;
+	float4 spec = p.colour * p.Ks;
+
+#if SHADOWS
+	Ray shadowRay;
+	shadowRay.o = hitPos;
+	shadowRay.d = lightDir;
+
+	if (AnyHit(shadowRay, lightDistance))
 	{
-		return (float4)1.0f;
+		return (float4)0.0f;
 	}
+#endif
 
+	return lightColour * lightIntensity * Phong(normal, lightDir, ray.d, p.shininess, diff, spec);
 }
 
-float4 RayTracing(Ray ray)
+//tMax is how far the primary ray can go, the reflections go up to MAX_DIST. primaryObject is the primitive the primary
+//ray hit, -1 for a miss
+float4 RayTracing(Ray ray, float tMax, out int primaryObject)
 {
 	int hitobj;
 	bool hit = false;
@@ -263,34 +385,33 @@ float4 RayTracing(Ray ray)
 	float mint = 0.0f;
 
 	//Calculate nearest hit
-	float3 i = NearestHit(ray, hitobj, hit, mint);
+	float3 i = NearestHit(ray, 0.0f, tMax, hitobj, hit, mint);
+
+	primaryObject = hit ? hitobj : -1;
 
-	for (int depth = 1; depth < 5; depth++)
+	if (!hit)
 	{
-		if (hit)
-		{
-			//if (hitobj == 3)
-			//{
-			//	n = TetraNormal(objectss[0], i);
-			//}
-			//else
-			{
-				n = SphereNormal(objects[hitobj], i);
-			}
+		return float4(MAX_DIST, c.xyz);
+	}
+
+	[loop]
+	for (int depth = 0; depth <= REFLECTIONS && hit; depth++)
+	{
+		n = Normal(primitives[hitobj], i);
 
-			c += Shade(i, n, ray, hitobj, lightIntensity);
+		c += Shade(i, n, ray, hitobj, lightIntensity);
 
-			//Shoot reflect ray
-			lightIntensity *= objects[hitobj].Kr;
-			ray.o = i;
-			ray.d = reflect(ray.d, n);
-			float mint2 = 0.0f;
-			i = NearestHit(ray, hitobj, hit, mint2);
+		if (depth == REFLECTIONS)
+		{
+			break;
 		}
-		//else
-		//{
-		//	c += backgroundColor / depth / depth;
-		//}
+
+		//Shoot reflect ray
+		lightIntensity *= primitives[hitobj].Kr;
+		ray.o = i;
+		ray.d = reflect(ray.d, n);
+		float mint2 = 0.0f;
+		i = NearestHit(ray, EPSILON, MAX_DIST, hitobj, hit, mint2);
 	}
 
 	return float4(mint, c.xyz);
@@ -298,7 +419,12 @@ float4 RayTracing(Ray ray)
 
 struct outputPS
 {
-	float4 colour : SV_TARGET;
+	float4 colour : SV_TARGET0;
+#if CHECKERBOARD
+	//How far along the ray the hit was and ImplicitRayTracer::GetCheckerboardObject of its primitive. Misses are
+	//discarded and keep the cleared NO_OBJECT
+	float2 hit : SV_TARGET1;
+#endif
 	float depth : SV_DEPTH;
 };
 
@@ -307,13 +433,35 @@ outputPS main(PixelShaderInput input)
 {
 	outputPS output;
 
-	float3 PixelPos = float3(input.canvasXY, -MIN_DIST);
+	int2 pixel = int2(input.position.xy);
+	float2 canvasXY = input.canvasXY;
+
+#if CHECKERBOARD
+	//The viewport is half the screen's width, and each texel traces the pixel in its column that's traced this frame
+	pixel = marchedPixel(pixel);
+
+	if (pixel.x >= screenSize.x)
+	{
+		discard;
+	}
+
+	canvasXY = pixelCanvas(pixel, projection._m00 / projection._m11);
+#endif
+
+	float3 PixelPos = float3(canvasXY, -MIN_DIST);
 
 	Ray eyeray;
 	eyeray.o = mul(float4(float3(0.0f, 0.0f, 0.0f), 1.0f), inverseView);
 	eyeray.d = normalize(mul(float4(PixelPos, 0.0f), inverseView));
 
-	float4 distanceAndColour = RayTracing(eyeray);
+	float tMax = MAX_DIST;
+
+#if DEPTH_LIMITS
+	tMax = depthLimit(rasterDepth.Load(int3(pixel, 0)), canvasXY, MAX_DIST);
+#endif
+
+	int primaryObject;
+	float4 distanceAndColour = RayTracing(eyeray, tMax, primaryObject);
 
 	if (distanceAndColour.x > MAX_DIST - EPSILON)
 	{
@@ -332,5 +480,9 @@ outputPS main(PixelShaderInput input)
 
 	output.colour = float4(lerp(output.colour.xyz, float3(1.0f, 0.97255f, 0.86275f), 1.0 - exp(-0.0005*distanceAndColour.x*distanceAndColour.x*distanceAndColour.x)), 1.0f);
 
+#if CHECKERBOARD
+	output.hit = float2(distanceAndColour.x, (float)((uint)primaryObject % (uint)NO_OBJECT));
+#endif
+
 	return output;
 }
\ No newline at end of file
@@ -0,0 +1,477 @@
+#include "pch.h"
+#include "ImplicitRayTracer.h"
+#include "ImplicitRayMarcher.h"
+
+#include <chrono>
+#include <cmath>
+#include <ppl.h>
+
+using namespace AlienPlanetACW;
+using namespace AlienPlanetACW::Sdf;
+using namespace DirectX;
+
+namespace
+{
+	//The bilinear blend of a block's corners at fx and fy across it, top left, top right, bottom left, bottom right
+	float Bilinear(const float* const corners, const float fx, const float fy)
+	{
+		const auto upper = corners[0] + (corners[1] - corners[0]) * fx;
+		const auto lower = corners[2] + (corners[3] - corners[2]) * fx;
+
+		return upper + (lower - upper) * fy;
+	}
+}
+
+const float ImplicitRayTracer::MaxDistance = 100.0f;
+const float ImplicitRayTracer::Epsilon = 0.0001f;
+const Vec3<float> ImplicitRayTracer::LightPosition(0.0f, 3.0f, 0.0f);
+
+ImplicitRayTracer::ImplicitRayTracer(const ImplicitRayTracedBvh& bvh, const ImplicitRayTracerSettings& settings) : m_bvh(bvh), m_settings(settings)
+{
+}
+
+Vec3<float> ImplicitRayTracer::Phong(const ImplicitRayTracedPrimitive& primitive, const Vec3<float>& n, const Vec3<float>& l, const Vec3<float>& v)
+{
+	const auto colour = Vec3<float>(primitive.colour.x, primitive.colour.y, primitive.colour.z);
+	const auto NdotL = Dot(n, l);
+	const auto diffuse = Saturate(NdotL);
+	const auto specular = NdotL > 0.0f ? Pow(Saturate(Dot(v, Reflect(l, n))), primitive.shininess) : 0.0f;
+
+	return colour * (diffuse * primitive.Kd + specular * primitive.Ks);
+}
+
+XMFLOAT3 ImplicitRayTracer::Fog(const Vec3<float>& colour, const Vec3<float>& background, const float distance)
+{
+	const auto fog = 1.0f - std::exp(-0.0005f * distance * distance * distance);
+	const auto fogged = Lerp(colour, background, fog);
+
+	return XMFLOAT3(fogged.x, fogged.y, fogged.z);
+}
+
+unsigned char ImplicitRayTracer::GetCheckerboardObject(const unsigned int primitive)
+{
+	return static_cast<unsigned char>(primitive % ImplicitRayMarcherCache::NoObject);
+}
+
+ImplicitRayTracerStats ImplicitRayTracer::Render(const XMMATRIX& view, HeadlessImage& image, std::vector<float>* const depths, ImplicitCheckerboardHistory* const history) const
+{
+	const auto start = std::chrono::high_resolution_clock::now();
+
+	XMFLOAT4X4 inverseView;
+	XMStoreFloat4x4(&inverseView, XMMatrixInverse(nullptr, view));
+
+	const auto right = Vec3<float>(inverseView._11, inverseView._12, inverseView._13);
+	const auto up = Vec3<float>(inverseView._21, inverseView._22, inverseView._23);
+	const auto back = Vec3<float>(inverseView._31, inverseView._32, inverseView._33);
+	const auto eye = Vec3<float>(inverseView._41, inverseView._42, inverseView._43);
+	const auto background = Vec3<float>(m_settings.background.x, m_settings.background.y, m_settings.background.z);
+
+	const auto width = image.GetWidth();
+	const auto height = image.GetHeight();
+	const auto aspectRatio = static_cast<float>(height) / width;
+
+	const auto& primitives = m_bvh.GetPrimitives();
+
+	const auto adaptive = m_settings.adaptiveBlockSize > 0;
+	const auto checkerboard = m_settings.checkerboard && !adaptive;
+	const auto checkerboardFrame = history != nullptr ? history->frame : 0;
+
+	//Checkerboard reconstructs from every traced pixel's hit, whether or not they were asked for
+	std::vector<float> checkerboardDepths;
+	std::vector<unsigned char> objects(checkerboard ? width * height : 0, ImplicitRayMarcherCache::NoObject);
+	const auto hitDepths = depths == nullptr && checkerboard ? &checkerboardDepths : depths;
+
+	if (hitDepths != nullptr)
+	{
+		hitDepths->assign(width * height, MaxDistance);
+	}
+
+	//Rows, or with adaptiveBlockSize tiles, as tasks, each adding up its own so they don't share anything as they go
+	const auto tileColumns = (width + AdaptiveTileSize - 1) / AdaptiveTileSize;
+	const auto tileRows = (height + AdaptiveTileSize - 1) / AdaptiveTileSize;
+	const auto tasks = adaptive ? tileColumns * tileRows : height;
+
+	std::vector<ImplicitRayTracerStats> taskStats(tasks, ImplicitRayTracerStats());
+
+	const auto tracePixel = [&](const unsigned int x, const unsigned int y, ImplicitRayTracerStats& stats)
+	{
+		const auto nearestHit = [&](const Vec3<float>& origin, const Vec3<float>& direction, const float tMin, ImplicitRayTracedHit& hit)
+		{
+			return m_settings.useBvh ? m_bvh.NearestHit(origin, direction, tMin, MaxDistance, hit, &stats.tests) : m_bvh.NearestHitLinear(origin, direction, tMin, MaxDistance, hit, &stats.tests);
+		};
+
+		const auto anyHit = [&](const Vec3<float>& origin, const Vec3<float>& direction, const float tMax)
+		{
+			return m_settings.useBvh ? m_bvh.AnyHit(origin, direction, Epsilon, tMax, &stats.tests) : m_bvh.AnyHitLinear(origin, direction, Epsilon, tMax, &stats.tests);
+		};
+
+		//The same rays as the ray marcher, through the pixel centres of a canvas from -1 to 1 in x
+		const auto canvasX = (x + 0.5f) / width * 2.0f - 1.0f;
+		const auto canvasY = (1.0f - (y + 0.5f) / height * 2.0f) * aspectRatio;
+
+		auto origin = eye;
+		auto direction = Normalize(right * canvasX + up * canvasY - back);
+		auto tMin = 0.0f;
+		auto colour = Vec3<float>(0.0f, 0.0f, 0.0f);
+		auto intensity = 1.0f;
+
+		TracedPixel result = { false, MaxDistance, ImplicitRayMarcherCache::NoObject, 0u, m_settings.background };
+
+		for (auto bounce = 0u; bounce <= m_settings.reflections; bounce++)
+		{
+			if (bounce == 0)
+			{
+				stats.primaryRays++;
+			}
+			else
+			{
+				stats.reflectionRays++;
+			}
+
+			ImplicitRayTracedHit hit;
+
+			if (!nearestHit(origin, direction, tMin, hit))
+			{
+				break;
+			}
+
+			if (bounce == 0)
+			{
+				result.hit = true;
+				result.depth = hit.distance;
+				result.object = GetCheckerboardObject(hit.primitive);
+				stats.hits++;
+			}
+
+			const auto& primitive = primitives[hit.primitive];
+			const auto surfacePoint = origin + direction * hit.distance;
+			const auto normal = ImplicitRayTracedBvh::GetNormal(primitive, surfacePoint);
+
+			const auto toLight = LightPosition - surfacePoint;
+			const auto lightDistance = Length(toLight);
+			const auto lightDirection = toLight * (1.0f / lightDistance);
+
+			auto lit = true;
+
+			if (m_settings.shadows)
+			{
+				stats.shadowRays++;
+				lit = !anyHit(surfacePoint, lightDirection, lightDistance);
+			}
+
+			if (lit)
+			{
+				colour = colour + Phong(primitive, normal, lightDirection, direction) * intensity;
+			}
+
+			//FNV-1a over the primitives hit and whether each was lit
+			result.path = (result.path ^ (hit.primitive * 2 + (lit ? 1 : 0))) * 16777619u;
+
+			intensity *= primitive.Kr;
+			origin = surfacePoint;
+			direction = Reflect(direction, normal);
+			tMin = Epsilon;
+		}
+
+		if (result.depth > MaxDistance - Epsilon)
+		{
+			result.hit = false;
+			result.depth = MaxDistance;
+			result.object = ImplicitRayMarcherCache::NoObject;
+			return result;
+		}
+
+		result.colour = Fog(colour, background, result.depth);
+
+		return result;
+	};
+
+	const auto writePixel = [&](const unsigned int x, const unsigned int y, const TracedPixel& result)
+	{
+		image.SetPixel(x, y, result.colour);
+
+		if (hitDepths != nullptr)
+		{
+			(*hitDepths)[y * width + x] = result.depth;
+		}
+
+		if (checkerboard)
+		{
+			objects[y * width + x] = result.object;
+		}
+	};
+
+	const auto traceRow = [&](const size_t row)
+	{
+		const auto y = static_cast<unsigned int>(row);
+
+		for (auto x = 0u; x < width; x++)
+		{
+			if (checkerboard && !ImplicitCheckerboard::IsMarched(x, y, checkerboardFrame))
+			{
+				continue;
+			}
+
+			writePixel(x, y, tracePixel(x, y, taskStats[y]));
+		}
+	};
+
+	//adaptiveBlockSize's subdivision of a tile, the same as the ray marcher's. Each block's corner pixels are traced, and
+	//a block whose corners all took the same path, or all missed, with the furthest primary hit no more than
+	//adaptiveDepthRatio further than the nearest, has the pixels inside interpolated from them. The others are split
+	//into quarters, which share the corners they have in common, down to blocks with no pixels inside
+	const auto traceTile = [&](const size_t tile)
+	{
+		const auto left = static_cast<unsigned int>(tile % tileColumns) * AdaptiveTileSize;
+		const auto top = static_cast<unsigned int>(tile / tileColumns) * AdaptiveTileSize;
+		const auto tileRight = std::min(left + AdaptiveTileSize, width);
+		const auto tileBottom = std::min(top + AdaptiveTileSize, height);
+		const auto tileWidth = tileRight - left;
+		auto& stats = taskStats[tile];
+
+		//Inclusive, so a block's last row and column are the first of the blocks after it and their corners are shared
+		struct Block
+		{
+			unsigned int left;
+			unsigned int top;
+			unsigned int right;
+			unsigned int bottom;
+		};
+
+		enum PixelState : unsigned char { Unknown, Interpolated, Traced };
+
+		std::vector<PixelState> states(tileWidth * (tileBottom - top), Unknown);
+		std::vector<TracedPixel> results(tileWidth * (tileBottom - top));
+		std::vector<Block> blocks;
+		std::vector<Block> splits;
+
+		for (auto y = top; ; y += m_settings.adaptiveBlockSize)
+		{
+			const auto blockBottom = std::min(y + m_settings.adaptiveBlockSize, tileBottom - 1);
+
+			for (auto x = left; ; x += m_settings.adaptiveBlockSize)
+			{
+				const auto blockRight = std::min(x + m_settings.adaptiveBlockSize, tileRight - 1);
+
+				blocks.push_back({ x, y, blockRight, blockBottom });
+
+				if (blockRight == tileRight - 1)
+				{
+					break;
+				}
+			}
+
+			if (blockBottom == tileBottom - 1)
+			{
+				break;
+			}
+		}
+
+		while (!blocks.empty())
+		{
+			splits.clear();
+
+			for (const auto& block : blocks)
+			{
+				const XMUINT2 cornerPixels[] = { XMUINT2(block.left, block.top), XMUINT2(block.right, block.top), XMUINT2(block.left, block.bottom), XMUINT2(block.right, block.bottom) };
+
+				//Including the ones a smooth block next to this one interpolated
+				for (const auto& corner : cornerPixels)
+				{
+					const auto index = (corner.y - top) * tileWidth + corner.x - left;
+
+					if (states[index] != Traced)
+					{
+						states[index] = Traced;
+						results[index] = tracePixel(corner.x, corner.y, stats);
+					}
+				}
+
+				//Nothing inside to interpolate or split
+				if (block.right - block.left <= 1 && block.bottom - block.top <= 1)
+				{
+					continue;
+				}
+
+				const TracedPixel* const corners[] =
+				{
+					&results[(block.top - top) * tileWidth + block.left - left],
+					&results[(block.top - top) * tileWidth + block.right - left],
+					&results[(block.bottom - top) * tileWidth + block.left - left],
+					&results[(block.bottom - top) * tileWidth + block.right - left]
+				};
+
+				auto smooth = true;
+				auto nearest = MaxDistance;
+				auto furthest = 0.0f;
+
+				for (const auto corner : corners)
+				{
+					smooth = smooth && corner->hit == corners[0]->hit && corner->path == corners[0]->path;
+					nearest = std::min(nearest, corner->depth);
+					furthest = std::max(furthest, corner->depth);
+				}
+
+				if (smooth && corners[0]->hit)
+				{
+					smooth = furthest <= nearest * (1.0f + m_settings.adaptiveDepthRatio);
+				}
+
+				if (smooth)
+				{
+					const float cornerDepths[] = { corners[0]->depth, corners[1]->depth, corners[2]->depth, corners[3]->depth };
+					const float reds[] = { corners[0]->colour.x, corners[1]->colour.x, corners[2]->colour.x, corners[3]->colour.x };
+					const float greens[] = { corners[0]->colour.y, corners[1]->colour.y, corners[2]->colour.y, corners[3]->colour.y };
+					const float blues[] = { corners[0]->colour.z, corners[1]->colour.z, corners[2]->colour.z, corners[3]->colour.z };
+
+					for (auto y = block.top; y <= block.bottom; y++)
+					{
+						for (auto x = block.left; x <= block.right; x++)
+						{
+							const auto index = (y - top) * tileWidth + x - left;
+
+							if (states[index] == Traced)
+							{
+								continue;
+							}
+
+							const auto fx = block.right > block.left ? static_cast<float>(x - block.left) / (block.right - block.left) : 0.0f;
+							const auto fy = block.bottom > block.top ? static_cast<float>(y - block.top) / (block.bottom - block.top) : 0.0f;
+
+							states[index] = Interpolated;
+							results[index] = { corners[0]->hit, Bilinear(cornerDepths, fx, fy), corners[0]->object, corners[0]->path, XMFLOAT3(Bilinear(reds, fx, fy), Bilinear(greens, fx, fy), Bilinear(blues, fx, fy)) };
+						}
+					}
+
+					continue;
+				}
+
+				//Halved where there's anything in between, so a block one pixel wide is only split the other way
+				const auto middleX = (block.left + block.right) / 2;
+				const auto middleY = (block.top + block.bottom) / 2;
+				const auto splitX = block.right - block.left > 1;
+				const auto splitY = block.bottom - block.top > 1;
+
+				splits.push_back({ block.left, block.top, splitX ? middleX : block.right, splitY ? middleY : block.bottom });
+
+				if (splitX)
+				{
+					splits.push_back({ middleX, block.top, block.right, splitY ? middleY : block.bottom });
+				}
+
+				if (splitY)
+				{
+					splits.push_back({ block.left, middleY, splitX ? middleX : block.right, block.bottom });
+				}
+
+				if (splitX && splitY)
+				{
+					splits.push_back({ middleX, middleY, block.right, block.bottom });
+				}
+			}
+
+			blocks.swap(splits);
+		}
+
+		//Every pixel of the tile is one or the other by now, as the smallest blocks have none inside
+		for (auto y = top; y < tileBottom; y++)
+		{
+			for (auto x = left; x < tileRight; x++)
+			{
+				const auto index = (y - top) * tileWidth + x - left;
+
+				writePixel(x, y, results[index]);
+
+				if (states[index] == Interpolated)
+				{
+					stats.interpolatedPixels++;
+				}
+			}
+		}
+	};
+
+	const auto traceTask = [&](const size_t task)
+	{
+		if (adaptive)
+		{
+			traceTile(task);
+		}
+		else
+		{
+			traceRow(task);
+		}
+	};
+
+	if (m_settings.parallel)
+	{
+		concurrency::parallel_for(static_cast<size_t>(0), static_cast<size_t>(tasks), traceTask);
+	}
+	else
+	{
+		for (auto task = 0u; task < tasks; task++)
+		{
+			traceTask(task);
+		}
+	}
+
+	ImplicitRayTracerStats stats = {};
+
+	for (const auto& task : taskStats)
+	{
+		stats.primaryRays += task.primaryRays;
+		stats.reflectionRays += task.reflectionRays;
+		stats.shadowRays += task.shadowRays;
+		stats.hits += task.hits;
+		stats.interpolatedPixels += task.interpolatedPixels;
+		stats.tests.Add(task.tests);
+	}
+
+	if (checkerboard)
+	{
+		stats.checkerboard = ImplicitCheckerboard::Reconstruct(view, checkerboardFrame, image, *hitDepths, objects, history, nullptr, m_settings.background, m_settings.parallel);
+
+		//Reconstructed misses are at the ray marcher's far distance
+		for (auto pixel = 0u; pixel < width * height; pixel++)
+		{
+			if (objects[pixel] == ImplicitRayMarcherCache::NoObject)
+			{
+				(*hitDepths)[pixel] = MaxDistance;
+			}
+		}
+
+		if (history != nullptr)
+		{
+			ImplicitCheckerboard::StoreHistory(view, image, *hitDepths, objects, *history);
+		}
+	}
+
+	stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	return stats;
+}
+
+std::vector<ImplicitRayTracedPrimitive> ImplicitRayTracer::GetScenePrimitives()
+{
+	const auto sphere = [](const XMFLOAT3& centre, const float radius, const XMFLOAT4& colour, const float Kd, const float Ks, const float Kr)
+	{
+		ImplicitRayTracedPrimitive primitive = {};
+		primitive.centre = centre;
+		primitive.type = static_cast<unsigned int>(ImplicitRayTracedPrimitiveType::Sphere);
+		primitive.size = XMFLOAT3(radius, radius, radius);
+		primitive.shininess = 40.0f;
+		primitive.colour = colour;
+		primitive.Kd = Kd;
+		primitive.Ks = Ks;
+		primitive.Kr = Kr;
+
+		return primitive;
+	};
+
+	//The shader's radii were squared
+	return
+	{
+		sphere(XMFLOAT3(-1.5f, 1.5f, 0.9f), std::sqrt(0.0075f), XMFLOAT4(1.0f, 0.0f, 0.0f, 1.0f), 0.3f, 0.5f, 0.7f),
+		sphere(XMFLOAT3(-1.8f, 1.3f, 1.0f), std::sqrt(0.004f), XMFLOAT4(0.0f, 1.0f, 0.0f, 1.0f), 0.5f, 0.7f, 0.4f),
+		sphere(XMFLOAT3(-1.6f, 1.4f, 1.3f), std::sqrt(0.01f), XMFLOAT4(1.0f, 0.0f, 1.0f, 1.0f), 0.5f, 5.0f, 0.3f)
+	};
+}
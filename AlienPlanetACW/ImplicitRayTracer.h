@@ -0,0 +1,109 @@
+#pragma once
+
+#include "HeadlessImage.h"
+#include "ImplicitCheckerboard.h"
+#include "ImplicitRayTracedBvh.h"
+
+#include <DirectXMath.h>
+#include <vector>
+
+namespace AlienPlanetACW
+{
+	struct ImplicitRayTracerSettings
+	{
+		ImplicitRayTracerSettings() : useBvh(true), parallel(true), shadows(true), reflections(3), adaptiveBlockSize(0), adaptiveDepthRatio(0.05f), checkerboard(false), background(1.0f, 0.97255f, 0.86275f) {}
+
+		//Every primitive in turn for every ray otherwise, the way the shader used to
+		bool useBvh;
+		//Rows, or AdaptiveTileSize tiles with adaptiveBlockSize, as tasks for the thread pool
+		bool parallel;
+		//A ray to the light from each hit, which is shadowed when it hits anything
+		bool shadows;
+		//Mirror bounces after the primary hit, the shader's four shaded hits in all
+		unsigned int reflections;
+		//Each tile is cut into blocks this many pixels across and only their corners are traced at first. The blocks
+		//whose corners hit, shadowed or reflected off different primitives, or hit depths more than adaptiveDepthRatio of
+		//the nearest apart, are split into quarters and their new corners traced, and the pixels inside the rest are
+		//interpolated from their corners. 0 traces every pixel
+		unsigned int adaptiveBlockSize;
+		float adaptiveDepthRatio;
+		//Only the pixels of one colour of a checkerboard are traced, bounces and all, the two colours taking turns from
+		//frame to frame, and ImplicitCheckerboard reconstructs the rest from them and last frame's image. Not with
+		//adaptiveBlockSize
+		bool checkerboard;
+		//Where the shader discards, the fog colour by default
+		DirectX::XMFLOAT3 background;
+	};
+
+	struct ImplicitRayTracerStats
+	{
+		unsigned long long primaryRays;
+		unsigned long long reflectionRays;
+		unsigned long long shadowRays;
+		unsigned long long hits;
+		//BVH nodes and primitives tested by all the rays
+		ImplicitRayTracedBvhCount tests;
+		//The pixels checkerboard filled in, which the rays don't count
+		ImplicitCheckerboardStats checkerboard;
+		//Pixels adaptiveBlockSize filled in from the corners around them rather than tracing, which the rays don't count
+		unsigned long long interpolatedPixels;
+		double milliseconds;
+
+		unsigned long long GetRays() const { return primaryRays + reflectionRays + shadowRays; }
+		double GetMegaRaysPerSecond() const { return milliseconds > 0.0 ? GetRays() / (milliseconds * 1000.0) : 0.0; }
+		double GetNodesPerRay() const { return GetRays() > 0 ? static_cast<double>(tests.nodes) / GetRays() : 0.0; }
+		double GetPrimitivesPerRay() const { return GetRays() > 0 ? static_cast<double>(tests.primitives) / GetRays() : 0.0; }
+	};
+
+	//A Whitted ray tracer on the CPU over ImplicitRayTracedBvh's primitives, which draws what ImplicitRayTracedModelsPS.hlsl
+	//does. Each hit is lit by the point light with Phong unless its shadow ray is blocked, then the ray is reflected and
+	//the next hit adds its light scaled by Kr so far, and the primary hit's distance fogs the lot
+	class ImplicitRayTracer
+	{
+	public:
+		static const float MaxDistance;
+		//How far along the shadow and reflection rays start, so they don't hit the surface they leave
+		static const float Epsilon;
+		//lightPosition in the shader, white
+		static const Sdf::Vec3<float> LightPosition;
+		//Pixels across the tiles adaptiveBlockSize cuts into blocks, the ray marcher's default
+		static const unsigned int AdaptiveTileSize = 16;
+
+		ImplicitRayTracer(const ImplicitRayTracedBvh& bvh, const ImplicitRayTracerSettings& settings = ImplicitRayTracerSettings());
+
+		const ImplicitRayTracerSettings& GetSettings() const { return m_settings; }
+		void SetSettings(const ImplicitRayTracerSettings& settings) { m_settings = settings; }
+
+		//view is the matrix the renderer gives the shader. depths, when given, gets how far along each pixel's primary ray
+		//the hit was, MaxDistance for a miss, row by row. history, when there is one, is last frame's image for
+		//checkerboard to reconstruct from, and gets this frame's
+		ImplicitRayTracerStats Render(const DirectX::XMMATRIX& view, HeadlessImage& image, std::vector<float>* depths = nullptr, ImplicitCheckerboardHistory* history = nullptr) const;
+
+		//Phong in the shader, where v is the ray's direction and l is towards the light
+		static Sdf::Vec3<float> Phong(const ImplicitRayTracedPrimitive& primitive, const Sdf::Vec3<float>& n, const Sdf::Vec3<float>& l, const Sdf::Vec3<float>& v);
+		//The shaded colour of a pixel whose primary ray hit at distance, faded into the background the way the shader does
+		static DirectX::XMFLOAT3 Fog(const Sdf::Vec3<float>& colour, const Sdf::Vec3<float>& background, float distance);
+
+		//The spheres the shader had hardcoded, which ImplicitRayTracedModels draws
+		static std::vector<ImplicitRayTracedPrimitive> GetScenePrimitives();
+
+		//The object a primary hit on the primitive is for checkerboard's reconstruction. Past ImplicitRayMarcherCache's
+		//NoObject the primitives share them, which only lets more of last frame's image through
+		static unsigned char GetCheckerboardObject(unsigned int primitive);
+
+	private:
+		//What tracing a pixel gave, which adaptiveBlockSize keeps for the corners of its blocks
+		struct TracedPixel
+		{
+			bool hit;
+			float depth;
+			unsigned char object;
+			//A hash of the primitives each bounce hit and whether they were lit, the same for corners that went the same way
+			unsigned int path;
+			DirectX::XMFLOAT3 colour;
+		};
+
+		const ImplicitRayTracedBvh& m_bvh;
+		ImplicitRayTracerSettings m_settings;
+	};
+}
@@ -0,0 +1,80 @@
+#include "pch.h"
+#include "ImplicitResolutionController.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace AlienPlanetACW;
+
+ImplicitResolutionController::ImplicitResolutionController(const ImplicitResolutionSettings& settings) : m_settings(settings)
+{
+	Reset();
+}
+
+void ImplicitResolutionController::Reset()
+{
+	m_scale = m_settings.maximumScale;
+	m_area = m_scale * m_scale;
+	m_smoothedMilliseconds = 0.0f;
+	m_recentMilliseconds[0] = 0.0f;
+	m_recentMilliseconds[1] = 0.0f;
+	m_recentMilliseconds[2] = 0.0f;
+	m_previousErrors[0] = 0.0f;
+	m_previousErrors[1] = 0.0f;
+	m_frames = 0;
+	m_framesSinceChange = 0;
+}
+
+float ImplicitResolutionController::Update(const float frameMilliseconds)
+{
+	if (m_frames == 0)
+	{
+		m_recentMilliseconds[1] = frameMilliseconds;
+		m_recentMilliseconds[2] = frameMilliseconds;
+	}
+
+	m_recentMilliseconds[m_frames % 3] = frameMilliseconds;
+
+	const auto& recent = m_recentMilliseconds;
+	const auto median = std::max(std::min(recent[0], recent[1]), std::min(std::max(recent[0], recent[1]), recent[2]));
+
+	m_smoothedMilliseconds = m_frames == 0 || median > m_smoothedMilliseconds ? median : m_smoothedMilliseconds + m_settings.smoothing * (median - m_smoothedMilliseconds);
+	m_frames++;
+	m_framesSinceChange++;
+
+	//Positive with time to spare, negative over budget
+	auto error = (m_settings.targetMilliseconds - m_smoothedMilliseconds) / m_settings.targetMilliseconds;
+
+	if (std::abs(error) < m_settings.deadband)
+	{
+		error = 0.0f;
+	}
+
+	//The PID in its incremental form, which changes the area rather than setting it. Clamping the area is then all it
+	//takes to stop the integral winding up while the scale is pinned at either end
+	const auto proportional = error - m_previousErrors[0];
+	const auto derivative = error - 2.0f * m_previousErrors[0] + m_previousErrors[1];
+	const auto change = m_settings.proportionalGain * proportional + m_settings.integralGain * error + m_settings.derivativeGain * derivative;
+
+	m_previousErrors[1] = m_previousErrors[0];
+	m_previousErrors[0] = error;
+
+	//Relative to the area, as the frame time goes up and down with it
+	const auto minimumArea = m_settings.minimumScale * m_settings.minimumScale;
+	const auto maximumArea = m_settings.maximumScale * m_settings.maximumScale;
+	m_area = std::min(std::max(m_area * (1.0f + change), minimumArea), maximumArea);
+
+	const auto desiredScale = std::sqrt(m_area);
+
+	//A step either side of the scale is left alone, and going up waits for the scale to have settled
+	if (std::abs(desiredScale - m_scale) >= m_settings.scaleStep && (desiredScale < m_scale || m_framesSinceChange >= m_settings.holdFrames))
+	{
+		const auto steps = m_settings.scaleStep > 0.0f ? std::floor((desiredScale - m_settings.minimumScale) / m_settings.scaleStep + 0.5f) : 0.0f;
+		const auto scale = m_settings.scaleStep > 0.0f ? m_settings.minimumScale + steps * m_settings.scaleStep : desiredScale;
+
+		m_scale = std::min(std::max(scale, m_settings.minimumScale), m_settings.maximumScale);
+		m_framesSinceChange = 0;
+	}
+
+	return m_scale;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+namespace AlienPlanetACW
+{
+	struct ImplicitResolutionSettings
+	{
+		ImplicitResolutionSettings() : targetMilliseconds(15.0f), minimumScale(0.5f), maximumScale(1.0f), proportionalGain(0.2f), integralGain(0.3f), derivativeGain(0.05f), smoothing(0.5f), deadband(0.05f), scaleStep(0.05f), holdFrames(30) {}
+
+		//The time the scale is steered towards, a little under a 60Hz frame so the deadband and the noise around it stay
+		//inside one. ImplicitRayModels feeds it the main pass's GPU time, since with vsync the frame time never drops
+		//under the refresh interval
+		float targetMilliseconds;
+		//Of the screen's width and height, so the pixels marched go from a quarter of the screen's up to all of them
+		float minimumScale;
+		float maximumScale;
+		//The PID's gains, on how far the frame time is from the target as a fraction of it. Their output is a change in
+		//the fraction of the screen's pixels marched, which is what the frame time goes with
+		float proportionalGain;
+		float integralGain;
+		float derivativeGain;
+		//The controller works from the median of the last three frame times, so a single hitch is ignored, smoothed by
+		//this much of each new one when frames are getting quicker. Slower ones are taken at once
+		float smoothing;
+		//Frame times within this fraction of the target count as on it, so a frame near it doesn't move the scale at all
+		float deadband;
+		//The scale only changes in steps this big, when the one the controller wants is at least a step away
+		float scaleStep;
+		//Frames after a change before the scale can go up again. It can always go down, a blown budget is put right at once
+		unsigned int holdFrames;
+	};
+
+	//Picks the render scale of the implicit passes from the frame times, a PID controller with hysteresis. The scale
+	//starts at the maximum and is fed each frame's time in turn, which gives the scale for the next frame
+	class ImplicitResolutionController
+	{
+	public:
+		explicit ImplicitResolutionController(const ImplicitResolutionSettings& settings = ImplicitResolutionSettings());
+
+		const ImplicitResolutionSettings& GetSettings() const { return m_settings; }
+		void SetSettings(const ImplicitResolutionSettings& settings) { m_settings = settings; Reset(); }
+
+		//Back to the maximum scale with nothing remembered
+		void Reset();
+
+		//Takes the frame's time and returns the scale for the next one
+		float Update(float frameMilliseconds);
+
+		float GetScale() const { return m_scale; }
+		//The unquantized fraction of the screen's pixels the controller wants, which the scale follows in steps
+		float GetDesiredArea() const { return m_area; }
+
+	private:
+		ImplicitResolutionSettings m_settings;
+
+		float m_scale;
+		float m_area;
+		float m_smoothedMilliseconds;
+		float m_recentMilliseconds[3];
+		//Last frame's error and the one before, for the PID's proportional and derivative terms
+		float m_previousErrors[2];
+		unsigned int m_frames;
+		unsigned int m_framesSinceChange;
+	};
+}
@@ -0,0 +1,336 @@
+#include "pch.h"
+#include "ImplicitSceneBricks.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <ppl.h>
+
+using namespace AlienPlanetACW;
+using namespace AlienPlanetACW::Sdf;
+
+namespace
+{
+	template <typename Function>
+	void ForEach(const size_t count, const bool parallel, const Function& function)
+	{
+		if (parallel)
+		{
+			concurrency::parallel_for(static_cast<size_t>(0), count, function);
+		}
+		else
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				function(i);
+			}
+		}
+	}
+}
+
+ImplicitSceneBricks::ImplicitSceneBricks(const float voxelSize, const float bandWidth, const bool parallel) : m_voxelSize(voxelSize), m_bandWidth(bandWidth), m_parameters(ImplicitSceneParameters::FromTime(0.0f)), m_bakeMilliseconds(0.0)
+{
+	const auto start = std::chrono::high_resolution_clock::now();
+
+	const auto bounds = ImplicitSceneHierarchy::GetObjectBoundsForAllTime();
+
+	for (auto object = 0u; object < ImplicitSceneSdf::ObjectCount; object++)
+	{
+		if (ImplicitSceneSdf::IsStaticObject(object))
+		{
+			Bake(object, bounds[object], parallel);
+		}
+	}
+
+	m_bakeMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void ImplicitSceneBricks::Bake(const unsigned int object, const ImplicitSceneBounds& bounds, const bool parallel)
+{
+	auto& bricks = m_objects[object];
+
+	const auto span = m_voxelSize * (BrickSize - 1);
+	const auto margin = Vec3<float>(m_bandWidth, m_bandWidth, m_bandWidth);
+	const auto extent = bounds.maximum - bounds.minimum + margin * 2.0f;
+
+	bricks.origin = bounds.minimum - margin;
+	bricks.size[0] = static_cast<unsigned int>(std::ceil(extent.x / span));
+	bricks.size[1] = static_cast<unsigned int>(std::ceil(extent.y / span));
+	bricks.size[2] = static_cast<unsigned int>(std::ceil(extent.z / span));
+	bricks.lipschitz = 1.0f / bounds.distanceScale;
+
+	const auto brickCount = bricks.size[0] * bricks.size[1] * bricks.size[2];
+
+	bricks.centreDistance.resize(brickCount);
+	bricks.brickIndex.assign(brickCount, -1);
+
+	const auto brickAt = [&bricks](const size_t brick, unsigned int& x, unsigned int& y, unsigned int& z)
+	{
+		x = static_cast<unsigned int>(brick % bricks.size[0]);
+		y = static_cast<unsigned int>(brick / bricks.size[0] % bricks.size[1]);
+		z = static_cast<unsigned int>(brick / (bricks.size[0] * bricks.size[1]));
+	};
+
+	ForEach(brickCount, parallel, [&](const size_t brick)
+	{
+		unsigned int x, y, z;
+		brickAt(brick, x, y, z);
+
+		bricks.centreDistance[brick] = ImplicitSceneSdf::EvaluateObject(m_parameters, object, GetBrickCentre(bricks, x, y, z)).distance;
+	});
+
+	//Nothing in a brick can be closer than its centre's distance less the furthest corner, so only the ones that could
+	//reach into the band keep their samples
+	const auto halfDiagonal = span * std::sqrt(3.0f) * 0.5f;
+	const auto keepDistance = bricks.lipschitz * halfDiagonal + m_bandWidth;
+
+	std::vector<unsigned int> kept;
+
+	for (auto brick = 0u; brick < brickCount; brick++)
+	{
+		if (std::abs(bricks.centreDistance[brick]) <= keepDistance)
+		{
+			bricks.brickIndex[brick] = static_cast<std::int32_t>(kept.size());
+			kept.push_back(brick);
+		}
+	}
+
+	//One spare so the 8-wide lookup can read four bytes at the last sample
+	bricks.distances.resize(kept.size() * SamplesPerBrick + 1);
+
+	//The samples are no further from the centre than the corners, which bounds their distances
+	const auto range = keepDistance + bricks.lipschitz * halfDiagonal;
+	bricks.quantisation = range / std::numeric_limits<std::int16_t>::max();
+
+	const auto quantise = [&bricks, range](const float distance)
+	{
+		return static_cast<std::int16_t>(std::round(std::min(std::max(distance, -range), range) / bricks.quantisation));
+	};
+
+	const auto usePackets = IsFloat8Supported();
+
+	ForEach(kept.size(), parallel, [&](const size_t i)
+	{
+		unsigned int x, y, z;
+		brickAt(kept[i], x, y, z);
+
+		const auto corner = bricks.origin + Vec3<float>(static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)) * span;
+		auto* const samples = &bricks.distances[i * SamplesPerBrick];
+
+		float rowX[BrickSize];
+
+		for (auto sample = 0u; sample < BrickSize; sample++)
+		{
+			rowX[sample] = corner.x + sample * m_voxelSize;
+		}
+
+		//A row of the brick is one Float8
+		for (auto row = 0u; row < BrickSize * BrickSize; row++)
+		{
+			const auto rowY = corner.y + (row % BrickSize) * m_voxelSize;
+			const auto rowZ = corner.z + (row / BrickSize) * m_voxelSize;
+			float distances[BrickSize];
+
+			if (usePackets)
+			{
+				const auto p = Vec3<Float8>(Float8::Load(rowX), Float8(rowY), Float8(rowZ));
+
+				ImplicitSceneSdf::EvaluateObject(m_parameters, object, p).distance.Store(distances);
+			}
+			else
+			{
+				for (auto sample = 0u; sample < BrickSize; sample++)
+				{
+					distances[sample] = ImplicitSceneSdf::EvaluateObject(m_parameters, object, Vec3<float>(rowX[sample], rowY, rowZ)).distance;
+				}
+			}
+
+			for (auto sample = 0u; sample < BrickSize; sample++)
+			{
+				samples[row * BrickSize + sample] = quantise(distances[sample]);
+			}
+		}
+	});
+
+	//Each sample is within the diagonal of a cell of the point being looked up, and rounding adds half a step
+	bricks.slack = bricks.lipschitz * m_voxelSize * std::sqrt(3.0f) + bricks.quantisation;
+	bricks.refineDistance = bricks.slack + m_voxelSize;
+}
+
+Vec3<float> ImplicitSceneBricks::GetBrickCentre(const ObjectBricks& bricks, const unsigned int x, const unsigned int y, const unsigned int z) const
+{
+	const auto span = m_voxelSize * (BrickSize - 1);
+
+	return bricks.origin + Vec3<float>(x + 0.5f, y + 0.5f, z + 0.5f) * span;
+}
+
+float ImplicitSceneBricks::Lookup(const unsigned int object, const Vec3<float>& samplePoint) const
+{
+	const auto& bricks = m_objects[object];
+
+	const auto span = m_voxelSize * (BrickSize - 1);
+	const auto local = (samplePoint - bricks.origin) * (1.0f / span);
+
+	if (!(local.x >= 0.0f && local.y >= 0.0f && local.z >= 0.0f && local.x < bricks.size[0] && local.y < bricks.size[1] && local.z < bricks.size[2]))
+	{
+		return -1e10f;
+	}
+
+	const auto x = static_cast<unsigned int>(local.x);
+	const auto y = static_cast<unsigned int>(local.y);
+	const auto z = static_cast<unsigned int>(local.z);
+	const auto brick = (z * bricks.size[1] + y) * bricks.size[0] + x;
+	const auto index = bricks.brickIndex[brick];
+
+	if (index < 0)
+	{
+		return bricks.centreDistance[brick] - Length(samplePoint - GetBrickCentre(bricks, x, y, z)) * bricks.lipschitz;
+	}
+
+	//Cell within the brick and where the point is in it
+	const auto cellX = (local.x - x) * (BrickSize - 1);
+	const auto cellY = (local.y - y) * (BrickSize - 1);
+	const auto cellZ = (local.z - z) * (BrickSize - 1);
+	const auto i = std::min(static_cast<unsigned int>(cellX), BrickSize - 2);
+	const auto j = std::min(static_cast<unsigned int>(cellY), BrickSize - 2);
+	const auto k = std::min(static_cast<unsigned int>(cellZ), BrickSize - 2);
+	const auto tx = cellX - i;
+	const auto ty = cellY - j;
+	const auto tz = cellZ - k;
+
+	const auto* const samples = &bricks.distances[index * SamplesPerBrick + (k * BrickSize + j) * BrickSize + i];
+	const auto at = [samples](const unsigned int dx, const unsigned int dy, const unsigned int dz) { return static_cast<float>(samples[(dz * BrickSize + dy) * BrickSize + dx]); };
+	const auto lerp = [](const float a, const float b, const float t) { return a + (b - a) * t; };
+
+	const auto front = lerp(lerp(at(0, 0, 0), at(1, 0, 0), tx), lerp(at(0, 1, 0), at(1, 1, 0), tx), ty);
+	const auto back = lerp(lerp(at(0, 0, 1), at(1, 0, 1), tx), lerp(at(0, 1, 1), at(1, 1, 1), tx), ty);
+
+	return lerp(front, back, tz) * bricks.quantisation - bricks.slack;
+}
+
+Float8 ImplicitSceneBricks::Lookup(const unsigned int object, const Vec3<Float8>& samplePoint) const
+{
+#if defined(SDF_MATH_AVX2)
+	const auto& bricks = m_objects[object];
+
+	const auto span = m_voxelSize * (BrickSize - 1);
+	const auto local = (samplePoint - Vec3<Float8>(bricks.origin)) * Float8(1.0f / span);
+
+	const auto sizeX = Float8(static_cast<float>(bricks.size[0]));
+	const auto sizeY = Float8(static_cast<float>(bricks.size[1]));
+	const auto sizeZ = Float8(static_cast<float>(bricks.size[2]));
+	const auto zero = Float8(0.0f);
+
+	const auto inside = And(And(And(local.x >= zero, local.y >= zero), And(local.z >= zero, local.x < sizeX)), And(local.y < sizeY, local.z < sizeZ));
+
+	if (!Any(inside))
+	{
+		return Float8(-1e10f);
+	}
+
+	//Lanes outside the grid look up the first sample and are replaced at the end
+	const auto insideX = Select(inside, local.x, zero);
+	const auto insideY = Select(inside, local.y, zero);
+	const auto insideZ = Select(inside, local.z, zero);
+	const auto brickX = Floor(insideX);
+	const auto brickY = Floor(insideY);
+	const auto brickZ = Floor(insideZ);
+
+	const auto brick = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_add_epi32(_mm256_mullo_epi32(_mm256_cvttps_epi32(brickZ.v), _mm256_set1_epi32(static_cast<int>(bricks.size[1]))),
+		_mm256_cvttps_epi32(brickY.v)), _mm256_set1_epi32(static_cast<int>(bricks.size[0]))), _mm256_cvttps_epi32(brickX.v));
+
+	const auto index = _mm256_i32gather_epi32(bricks.brickIndex.data(), brick, 4);
+	const auto kept = Mask8{ _mm256_castsi256_ps(_mm256_cmpgt_epi32(index, _mm256_set1_epi32(-1))) };
+
+	const auto centre = Vec3<Float8>(bricks.origin) + Vec3<Float8>(brickX + Float8(0.5f), brickY + Float8(0.5f), brickZ + Float8(0.5f)) * Float8(span);
+	const auto centreDistance = Float8(_mm256_i32gather_ps(bricks.centreDistance.data(), brick, 4));
+	auto distance = centreDistance - Length(samplePoint - centre) * Float8(bricks.lipschitz);
+
+	if (Any(And(inside, kept)))
+	{
+		const auto cells = Float8(static_cast<float>(BrickSize - 1));
+		const auto lastCell = Float8(static_cast<float>(BrickSize - 2));
+		const auto cellX = (insideX - brickX) * cells;
+		const auto cellY = (insideY - brickY) * cells;
+		const auto cellZ = (insideZ - brickZ) * cells;
+		const auto i = Min(Floor(cellX), lastCell);
+		const auto j = Min(Floor(cellY), lastCell);
+		const auto k = Min(Floor(cellZ), lastCell);
+		const auto tx = cellX - i;
+		const auto ty = cellY - j;
+		const auto tz = cellZ - k;
+
+		const auto cell = _mm256_cvttps_epi32((((k * Float8(static_cast<float>(BrickSize))) + j) * Float8(static_cast<float>(BrickSize)) + i).v);
+		const auto first = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_max_epi32(index, _mm256_setzero_si256()), _mm256_set1_epi32(static_cast<int>(SamplesPerBrick))), cell);
+
+		//Four bytes from each 16 bit sample, the low half being the sample, which is why distances has one spare on the end
+		const auto* const samples = reinterpret_cast<const int*>(bricks.distances.data());
+		const auto at = [samples, &first](const unsigned int offset)
+		{
+			const auto words = _mm256_i32gather_epi32(samples, _mm256_add_epi32(first, _mm256_set1_epi32(static_cast<int>(offset))), 2);
+			return Float8(_mm256_cvtepi32_ps(_mm256_srai_epi32(_mm256_slli_epi32(words, 16), 16)));
+		};
+		const auto lerp = [](const Float8& a, const Float8& b, const Float8& t) { return a + (b - a) * t; };
+
+		const auto row = BrickSize;
+		const auto slice = BrickSize * BrickSize;
+
+		const auto front = lerp(lerp(at(0), at(1), tx), lerp(at(row), at(row + 1), tx), ty);
+		const auto back = lerp(lerp(at(slice), at(slice + 1), tx), lerp(at(slice + row), at(slice + row + 1), tx), ty);
+
+		distance = Select(kept, lerp(front, back, tz) * Float8(bricks.quantisation) - Float8(bricks.slack), distance);
+	}
+
+	return Select(inside, distance, Float8(-1e10f));
+#else
+	float x[8], y[8], z[8], distances[8];
+
+	samplePoint.x.Store(x);
+	samplePoint.y.Store(y);
+	samplePoint.z.Store(z);
+
+	//No gathers, so a lane at a time
+	for (auto lane = 0; lane < 8; lane++)
+	{
+		distances[lane] = Lookup(object, Vec3<float>(x[lane], y[lane], z[lane]));
+	}
+
+	return Float8::Load(distances);
+#endif
+}
+
+unsigned int ImplicitSceneBricks::GetBrickCount() const
+{
+	auto count = 0u;
+
+	for (const auto& bricks : m_objects)
+	{
+		count += static_cast<unsigned int>(bricks.distances.size() / SamplesPerBrick);
+	}
+
+	return count;
+}
+
+unsigned int ImplicitSceneBricks::GetGridBrickCount() const
+{
+	auto count = 0u;
+
+	for (const auto& bricks : m_objects)
+	{
+		count += static_cast<unsigned int>(bricks.brickIndex.size());
+	}
+
+	return count;
+}
+
+size_t ImplicitSceneBricks::GetMemoryBytes() const
+{
+	size_t bytes = 0;
+
+	for (const auto& bricks : m_objects)
+	{
+		bytes += bricks.brickIndex.size() * sizeof(std::int32_t) + bricks.centreDistance.size() * sizeof(float) + bricks.distances.size() * sizeof(std::int16_t);
+	}
+
+	return bytes;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "ImplicitSceneSdf.h"
+#include "ImplicitSceneHierarchy.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace AlienPlanetACW
+{
+	//Distances to the objects that never move, baked once into a sparse grid of 8x8x8 sample bricks per object. Only the
+	//bricks in a narrow band around the surface keep their samples, as 16 bit distances. The others keep the distance at
+	//their centre, which is enough to step across them. The bricks are a little under the object's own distance, so close
+	//to the surface the object's SDF takes over and the hits are exact
+	class ImplicitSceneBricks
+	{
+	public:
+		static const unsigned int BrickSize = 8;
+
+		//voxelSize is the spacing of the samples and bandWidth how far from the surface bricks keep theirs
+		explicit ImplicitSceneBricks(float voxelSize = 1.0f / 256.0f, float bandWidth = 4.0f / 256.0f, bool parallel = true);
+
+		bool IsBaked(unsigned int object) const { return object < ImplicitSceneSdf::ObjectCount && !m_objects[object].brickIndex.empty(); }
+
+		//ImplicitSceneSdf::EvaluateObject for a baked object. Away from the surface the distance comes from the bricks and
+		//has no colour, within the refine distance of it the object is evaluated
+		template <typename T>
+		Sdf::Sample<T> EvaluateObject(unsigned int object, const Sdf::Vec3<T>& samplePoint) const;
+
+		//Trilinear distance from the bricks less the most interpolating can be out by, so a safe step. -1e10 outside the
+		//object's grid, which sends it to the object's SDF. Further out the hierarchy rarely opens the object, and when it
+		//does the box's distance is too far under the object's to march with
+		float Lookup(unsigned int object, const Sdf::Vec3<float>& samplePoint) const;
+		Sdf::Float8 Lookup(unsigned int object, const Sdf::Vec3<Sdf::Float8>& samplePoint) const;
+
+		//Bricks with samples, out of all the bricks in the grids
+		unsigned int GetBrickCount() const;
+		unsigned int GetGridBrickCount() const;
+		size_t GetMemoryBytes() const;
+		double GetBakeMilliseconds() const { return m_bakeMilliseconds; }
+
+	private:
+		static const unsigned int SamplesPerBrick = BrickSize * BrickSize * BrickSize;
+
+		struct ObjectBricks
+		{
+			Sdf::Vec3<float> origin;
+			unsigned int size[3];
+			//How much faster than the distance to it the object's SDF can change, one over ImplicitSceneBounds::distanceScale
+			float lipschitz;
+			//Distance per step of the 16 bit samples
+			float quantisation;
+			//What the trilinear distance can be over by
+			float slack;
+			float refineDistance;
+			//Into distances in bricks, -1 for a brick away from the surface
+			std::vector<std::int32_t> brickIndex;
+			std::vector<float> centreDistance;
+			std::vector<std::int16_t> distances;
+		};
+
+		void Bake(unsigned int object, const ImplicitSceneBounds& bounds, bool parallel);
+		Sdf::Vec3<float> GetBrickCentre(const ObjectBricks& bricks, unsigned int x, unsigned int y, unsigned int z) const;
+
+		float m_voxelSize;
+		float m_bandWidth;
+		//The baked objects don't depend on them, but EvaluateObject takes them
+		ImplicitSceneParameters m_parameters;
+		ObjectBricks m_objects[ImplicitSceneSdf::ObjectCount];
+		double m_bakeMilliseconds;
+	};
+
+	template <typename T>
+	Sdf::Sample<T> ImplicitSceneBricks::EvaluateObject(const unsigned int object, const Sdf::Vec3<T>& samplePoint) const
+	{
+		using namespace Sdf;
+
+		const auto distance = Lookup(object, samplePoint);
+		const auto exact = distance < T(m_objects[object].refineDistance);
+
+		if (!Any(exact))
+		{
+			return Sample<T>(distance, Vec3<T>(T(0.0f), T(0.0f), T(0.0f)));
+		}
+
+		const auto sample = ImplicitSceneSdf::EvaluateObject(m_parameters, object, samplePoint);
+
+		return Sample<T>(Select(exact, sample.distance, distance), sample.colour);
+	}
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "ImplicitSceneSdf.h"
+#include "SdfExpression.h"
+
+namespace AlienPlanetACW
+{
+	//sceneSDF written with the expression templates in SdfExpression.h, the same objects in the same order as
+	//ImplicitSceneSdf::EvaluateObject
+	class ImplicitSceneExpression
+	{
+	public:
+		//Once per frame, like ImplicitSceneParameters. Calling the result with a float or Float8 point gives the scene's
+		//Sample, through one function the compiler can inline end to end since the type is the whole scene
+		static auto Create(const ImplicitSceneParameters& parameters)
+		{
+			//Not all of Sdf, its SmoothUnion and the like would be picked over the expression builders
+			using namespace Sdf::Expressions;
+			using Sdf::Vec2;
+			using Sdf::Vec3;
+
+			const auto p = SamplePoint();
+
+			const auto infinPos = MirrorRepeatXZ(Translate(p, Vec3<float>(0.0f, 4.0f, 0.0f)), 2.0f);
+			const auto morphingShapes = Colour(Lerp(Lerp(Torus(infinPos, Vec2<float>(0.3f, 0.1f)), Box(infinPos, Vec3<float>(0.4f, 0.4f, 0.4f)), parameters.morph), Sphere(infinPos, 0.2f), parameters.morph), Vec3<float>(0.4f, 0.8f, 0.8f));
+
+			const auto& ship = parameters.shipPosition;
+			const auto shipColour = Vec3<float>(0.29f, 0.5649f, 0.107f);
+			const auto shipPoint = Translate(p, ship);
+
+			//Each stud is a sphere above and one below the rim, so stud i is the (i / 2)th angle
+			const auto shipStud = [&](const unsigned int i)
+			{
+				const auto x = parameters.shipStuds[i / 2][0];
+				const auto z = parameters.shipStuds[i / 2][1];
+
+				return Sphere(Translate(p, Vec3<float>(ship.x - x * 0.21f, ship.y + (i % 2 == 0 ? 0.05f : -0.05f), ship.z - z * 0.21f)), 0.02f);
+			};
+
+			const auto hull = SmoothUnion(Ellipsoid(shipPoint, Vec3<float>(0.3f, 0.07f, 0.3f)), Ellipsoid(Translate(p, Vec3<float>(ship.x, ship.y + 0.08f, ship.z)), Vec3<float>(0.15f, 0.05f, 0.15f)), 0.05f);
+			const auto alienShip = Colour(SmoothUnionEach<16>(SmoothSubtraction(Torus(shipPoint, Vec2<float>(0.3f, 0.05f)), hull, 0.01f), shipStud, 0.02f), shipColour);
+
+			const auto beamLength = parameters.beamLength;
+			const auto beamRing = [&](const unsigned int i)
+			{
+				const auto torusPos = (beamLength * 2.0f / 10.0f) * i;
+
+				return Torus(Translate(p, Vec3<float>(ship.x, ship.y - torusPos, ship.z)), Vec2<float>(0.05f + 0.015f * i, 0.004f * beamLength));
+			};
+
+			const auto beam = SmoothSubtraction(Sphere(Translate(p, Vec3<float>(ship.x, ship.y + 0.5f, ship.z)), 0.5f), CappedCone(Translate(p, parameters.beamPosition), beamLength, 0.2f, 0.05f), 0.05f);
+			const auto alienShipBeam = Colour(SmoothSubtractionEach<10>(beamRing, beam, 0.05f), shipColour);
+
+			const auto alien = Vec3<float>(0.9f, 0.6f, 0.5f);
+			const auto eyeHeight = parameters.alienEyeHeight;
+			const auto mouth = parameters.alienMouth;
+			const auto arm = parameters.alienArm;
+			const auto atAlien = [&](const float x, const float y, const float z) { return Translate(p, Vec3<float>(alien.x + x, alien.y + y, alien.z + z)); };
+
+			const auto alienHead = SmoothUnion(HexPrism(atAlien(0.0f, 0.01f, 0.0f), Vec2<float>(0.01f, 0.05f)), Sphere(atAlien(-0.007f, 0.01f, 0.0f), 0.035f), 0.01f);
+			const auto alienEyes = SmoothUnion(SmoothUnion(alienHead, Sphere(Translate(p, Vec3<float>(alien.x - 0.02f, alien.y + eyeHeight, alien.z - 0.015f)), 0.01f), 0.005f), Sphere(Translate(p, Vec3<float>(alien.x - 0.02f, alien.y + eyeHeight, alien.z + 0.015f)), 0.01f), 0.005f);
+			const auto alienBody = SmoothUnion(SmoothUnion(SmoothSubtraction(Ellipsoid(atAlien(-0.025f, -0.006f, 0.0f), Vec3<float>(mouth, mouth, 0.05f)), alienEyes, 0.01f), RoundCone(atAlien(0.04f, -0.035f, 0.0f), 0.025f, 0.015f, 0.04f), 0.01f), Torus(atAlien(0.04f, -0.04f, 0.0f), Vec2<float>(0.03f, 0.005f)), 0.01f);
+			const auto alienLegs = SmoothUnion(SmoothUnion(alienBody, Cylinder(atAlien(0.04f, -0.08f, -0.018f), Vec3<float>(0.0f, 0.04f, 0.0f), Vec3<float>(0.0f, -0.04f, 0.0f), 0.008f), 0.01f), Cylinder(atAlien(0.04f, -0.08f, 0.018f), Vec3<float>(0.0f, 0.04f, 0.0f), Vec3<float>(0.0f, -0.04f, 0.0f), 0.008f), 0.01f);
+			const auto alienArms = SmoothUnion(SmoothUnion(alienLegs, Cylinder(atAlien(0.04f, -0.005f, -0.05f), Vec3<float>(0.0f, 0.0f, 0.03f), Vec3<float>(0.0f, arm, -0.025f), 0.008f), 0.025f), Cylinder(atAlien(0.04f, -0.005f, 0.05f), Vec3<float>(0.0f, 0.0f, -0.03f), Vec3<float>(0.0f, arm, 0.025f), 0.008f), 0.025f);
+			const auto alienObject = Colour(alienArms, Vec3<float>(0.987f, 0.28f, 0.45f));
+
+			const auto drip = Vec3<float>(0.9f, 0.6f, 0.9f);
+			const auto* const heights = parameters.dripHeights;
+			const auto dropAt = [&](const float x, const float y) { return Translate(p, Vec3<float>(drip.x + x, y, drip.z)); };
+
+			const auto tap = SmoothUnion(RoundBox(dropAt(0.0f, drip.y - 0.2f), Vec3<float>(0.06f, 0.06f, 0.06f), 0.032f), CappedCone(dropAt(0.0f, drip.y + 0.3f), 0.1f, 0.06f, 0.08f), 0.01f);
+			const auto fallingDrops = SmoothUnion(SmoothUnion(SmoothUnion(tap, Sphere(dropAt(-0.015f, (drip.y - 0.3f) - heights[0]), 0.02f), 0.02f), Sphere(dropAt(0.0f, (drip.y - 0.3f) - heights[1]), 0.02f), 0.05f), Sphere(dropAt(0.015f, (drip.y - 0.3f) - heights[2]), 0.02f), 0.02f);
+			const auto risingDrops = SmoothUnion(SmoothUnion(SmoothUnion(fallingDrops, Sphere(dropAt(-0.015f, (drip.y - 0.3f) + heights[0]), 0.02f), 0.02f), Sphere(dropAt(0.0f, (drip.y - 0.3f) + heights[1]), 0.02f), 0.05f), Sphere(dropAt(0.015f, (drip.y - 0.3f) + heights[2]), 0.02f), 0.02f);
+			const auto waterDrip = Colour(risingDrops, Vec3<float>(0.456f, 0.15f, 0.5564f));
+
+			const auto mandelbulb = Mandelbulb(Translate(p, Vec3<float>(-4.0f, 2.0f, -4.0f)), parameters.mandelbulbPower, parameters.mandelbulbRotation, parameters.mandelbulbColour);
+			const auto sierpinskiTetrahedron = SierpinskiTetrahedron(Scale(Translate(p, Vec3<float>(2.0f, 2.0f, 2.0f)), 2.0f));
+			const auto wobblySphere = Colour(Wobble(Sphere(Translate(p, Vec3<float>(1.0f, 0.5f, -1.0f)), 0.2f), p, parameters.wobble), Vec3<float>(0.75f, 0.37f, 1.0f));
+
+			const auto at = [&](const float x, const float y, const float z) { return Translate(p, Vec3<float>(x, y, z)); };
+
+			return Union(morphingShapes, alienShip, alienShipBeam, alienObject, waterDrip, mandelbulb, sierpinskiTetrahedron, wobblySphere,
+				Colour(RoundCone(at(0.3f, 0.5f, 0.3f), Vec3<float>(0.02f, 0.0f, 0.0f), Vec3<float>(-0.02f, 0.06f, 0.02f), 0.03f, 0.01f), Vec3<float>(0.18f, 0.22f, 1.0f)),
+				Colour(Cone(at(0.0f, 0.53f, 0.0f), Vec3<float>(0.16f, 0.12f, 0.06f)), Vec3<float>(0.55f, 0.23f, 0.38f)),
+				Colour(CappedCone(at(0.3f, 0.5f, 0.0f), 0.03f, 0.04f, 0.02f), Vec3<float>(0.80f, 0.78f, 0.45f)),
+				Colour(ScaleDistance(Torus(Twist(at(0.0f, 0.5f, 0.3f), 60.0f), Vec2<float>(0.04f, 0.01f)), 0.6f), Vec3<float>(0.28f, 0.51f, 0.08f)),
+				Colour(Torus(at(-0.3f, 0.5f, -0.3f), Vec2<float>(0.04f, 0.01f)), Vec3<float>(0.41f, 0.27f, 0.54f)),
+				Colour(Torus82(at(0.0f, 0.5f, -0.3f), Vec2<float>(0.04f, 0.01f)), Vec3<float>(0.52f, 0.75f, 0.42f)),
+				Colour(Box(at(-0.3f, 0.5f, 0.0f), Vec3<float>(0.05f, 0.05f, 0.05f)), Vec3<float>(0.31f, 0.47f, 0.63f)),
+				Colour(RoundBox(at(-0.3f, 0.5f, 0.3f), Vec3<float>(0.04f, 0.04f, 0.04f), 0.016f), Vec3<float>(1.0f, 0.27f, 0.0f)),
+				Colour(Ellipsoid(at(0.3f, 0.5f, -0.3f), Vec3<float>(0.05f, 0.05f, 0.02f)), Vec3<float>(0.8f, 0.41f, 0.79f)),
+				Colour(TriPrism(at(-0.6f, 0.5f, -0.3f), Vec2<float>(0.05f, 0.02f)), Vec3<float>(0.92f, 0.68f, 0.92f)),
+				Colour(Cylinder(at(-0.6f, 0.5f, 0.0f), Vec3<float>(0.002f, -0.002f, 0.0f), Vec3<float>(-0.02f, 0.06f, 0.02f), 0.016f), Vec3<float>(0.78f, 0.38f, 0.08f)),
+				Colour(Cylinder(at(-0.6f, 0.5f, 0.3f), Vec2<float>(0.02f, 0.04f)), Vec3<float>(0.98f, 0.63f, 0.42f)),
+				Colour(Cylinder6(at(0.3f, 0.5f, 0.6f), Vec2<float>(0.02f, 0.04f)), Vec3<float>(0.29f, 0.46f, 0.43f)),
+				Colour(Octahedron(at(0.0f, 0.5f, 0.6f), 0.07f), Vec3<float>(0.46f, 0.61f, 0.52f)),
+				Colour(HexPrism(at(-0.3f, 0.5f, 0.6f), Vec2<float>(0.05f, 0.01f)), Vec3<float>(0.59f, 1.0f, 1.0f)),
+				Colour(RoundCone(at(-0.6f, 0.5f, 0.6f), 0.04f, 0.02f, 0.06f), Vec3<float>(1.0f, 0.2f, 0.0f)));
+		}
+	};
+}
@@ -0,0 +1,351 @@
+#include "pch.h"
+#include "ImplicitSceneHierarchy.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+using namespace AlienPlanetACW;
+using namespace AlienPlanetACW::Sdf;
+
+namespace
+{
+	//Anything bigger than this goes straight under the root rather than into the tree
+	const float UnboundedExtent = 1e6f;
+
+	ImplicitSceneBounds Box(const Vec3<float>& centre, const Vec3<float>& minimum, const Vec3<float>& maximum, const float padding, const float distanceScale = 1.0f)
+	{
+		const auto pad = Vec3<float>(padding, padding, padding);
+
+		return { centre + minimum - pad, centre + maximum + pad, distanceScale };
+	}
+
+	ImplicitSceneBounds Box(const Vec3<float>& centre, const Vec3<float>& halfSize, const float padding, const float distanceScale = 1.0f)
+	{
+		return Box(centre, -halfSize, halfSize, padding, distanceScale);
+	}
+
+	//The gallery doesn't move, so its boxes are the same at any time
+	void AddGalleryBounds(std::vector<ImplicitSceneBounds>& bounds)
+	{
+		const auto padding = 0.01f;
+
+		bounds.push_back(Box(Vec3<float>(0.3f, 0.5f, 0.3f), Vec3<float>(-0.03f, -0.03f, -0.03f), Vec3<float>(0.05f, 0.07f, 0.03f), padding));
+		//The cone's slope isn't normalised, which shrinks its distances to about a fifth
+		bounds.push_back(Box(Vec3<float>(0.0f, 0.53f, 0.0f), Vec3<float>(-0.045f, -0.06f, -0.045f), Vec3<float>(0.045f, 0.0f, 0.045f), padding, 0.15f));
+		bounds.push_back(Box(Vec3<float>(0.3f, 0.5f, 0.0f), Vec3<float>(0.04f, 0.03f, 0.04f), padding));
+		//The shader scales the twisted torus by 0.6 to make up for the twist stretching it
+		bounds.push_back(Box(Vec3<float>(0.0f, 0.5f, 0.3f), Vec3<float>(0.052f, 0.05f, 0.052f), padding, 0.55f));
+		bounds.push_back(Box(Vec3<float>(-0.3f, 0.5f, -0.3f), Vec3<float>(0.05f, 0.01f, 0.05f), padding));
+		bounds.push_back(Box(Vec3<float>(0.0f, 0.5f, -0.3f), Vec3<float>(0.05f, 0.01f, 0.05f), padding, 0.75f));
+		bounds.push_back(Box(Vec3<float>(-0.3f, 0.5f, 0.0f), Vec3<float>(0.05f, 0.05f, 0.05f), padding));
+		bounds.push_back(Box(Vec3<float>(-0.3f, 0.5f, 0.3f), Vec3<float>(0.056f, 0.056f, 0.056f), padding));
+		bounds.push_back(Box(Vec3<float>(0.3f, 0.5f, -0.3f), Vec3<float>(0.05f, 0.05f, 0.02f), padding, 0.65f));
+		bounds.push_back(Box(Vec3<float>(-0.6f, 0.5f, -0.3f), Vec3<float>(-0.0434f, -0.025f, -0.02f), Vec3<float>(0.0434f, 0.05f, 0.02f), padding));
+		bounds.push_back(Box(Vec3<float>(-0.6f, 0.5f, 0.0f), Vec3<float>(-0.036f, -0.018f, -0.016f), Vec3<float>(0.018f, 0.076f, 0.036f), padding));
+		bounds.push_back(Box(Vec3<float>(-0.6f, 0.5f, 0.3f), Vec3<float>(0.02f, 0.04f, 0.02f), padding));
+		bounds.push_back(Box(Vec3<float>(0.3f, 0.5f, 0.6f), Vec3<float>(0.02f, 0.04f, 0.02f), padding, 0.6f));
+		bounds.push_back(Box(Vec3<float>(0.0f, 0.5f, 0.6f), Vec3<float>(0.07f, 0.07f, 0.07f), padding));
+		bounds.push_back(Box(Vec3<float>(-0.3f, 0.5f, 0.6f), Vec3<float>(0.058f, 0.058f, 0.01f), padding));
+		bounds.push_back(Box(Vec3<float>(-0.6f, 0.5f, 0.6f), Vec3<float>(-0.04f, -0.04f, -0.04f), Vec3<float>(0.04f, 0.08f, 0.04f), padding));
+	}
+
+	//Objects 3, 5, 6 and 7, which stay where they are
+	ImplicitSceneBounds AlienBounds()
+	{
+		return Box(Vec3<float>(0.9f, 0.6f, 0.5f), Vec3<float>(-0.06f, -0.13f, -0.1f), Vec3<float>(0.08f, 0.07f, 0.1f), 0.03f, 0.8f);
+	}
+
+	ImplicitSceneBounds MandelbulbBounds()
+	{
+		//The bulb's estimate is 0.5 r log r with r from (-4, 2, -3.5) once r is past 1.5, which never beats the box
+		return Box(Vec3<float>(-4.0f, 2.0f, -3.5f), Vec3<float>(1.5f, 1.5f, 1.5f), 0.0f);
+	}
+
+	ImplicitSceneBounds SierpinskiTetrahedronBounds()
+	{
+		return Box(Vec3<float>(2.0f, 2.0f, 2.0f), Vec3<float>(-0.5f, -0.5f, -0.289f), Vec3<float>(0.5f, 0.289f, 0.577f), 0.02f);
+	}
+
+	//sin(time) takes the wobble's lerp past both ends, so it can be three times as deep
+	ImplicitSceneBounds WobblySphereBounds()
+	{
+		return Box(Vec3<float>(1.0f, 0.5f, -1.0f), Vec3<float>(0.32f, 0.32f, 0.32f), 0.01f);
+	}
+
+	//The infinite shapes only have a height, repeating forever across xz
+	ImplicitSceneBounds MorphingShapesBounds()
+	{
+		return { Vec3<float>(-UnboundedExtent * 1e3f, 3.6f, -UnboundedExtent * 1e3f), Vec3<float>(UnboundedExtent * 1e3f, 4.4f, UnboundedExtent * 1e3f), 1.0f };
+	}
+
+	ImplicitSceneBounds Merge(const ImplicitSceneBounds& a, const ImplicitSceneBounds& b)
+	{
+		return {
+			Vec3<float>(std::min(a.minimum.x, b.minimum.x), std::min(a.minimum.y, b.minimum.y), std::min(a.minimum.z, b.minimum.z)),
+			Vec3<float>(std::max(a.maximum.x, b.maximum.x), std::max(a.maximum.y, b.maximum.y), std::max(a.maximum.z, b.maximum.z)),
+			std::min(a.distanceScale, b.distanceScale)
+		};
+	}
+
+	float Extent(const ImplicitSceneBounds& bounds, const unsigned int axis)
+	{
+		return axis == 0 ? bounds.maximum.x - bounds.minimum.x : (axis == 1 ? bounds.maximum.y - bounds.minimum.y : bounds.maximum.z - bounds.minimum.z);
+	}
+
+	float Centre(const ImplicitSceneBounds& bounds, const unsigned int axis)
+	{
+		return axis == 0 ? bounds.minimum.x + bounds.maximum.x : (axis == 1 ? bounds.minimum.y + bounds.maximum.y : bounds.minimum.z + bounds.maximum.z);
+	}
+
+	std::string HlslFloat(const float value)
+	{
+		std::ostringstream text;
+		text << std::fixed << std::setprecision(4) << value << "f";
+		return text.str();
+	}
+
+	std::string HlslFloat3(const Vec3<float>& value)
+	{
+		return "float3(" + HlslFloat(value.x) + ", " + HlslFloat(value.y) + ", " + HlslFloat(value.z) + ")";
+	}
+
+	std::string HlslMask(const unsigned int value)
+	{
+		std::ostringstream text;
+		text << "0x" << std::hex << std::uppercase << std::setw(8) << std::setfill('0') << value << "u";
+		return text.str();
+	}
+}
+
+std::vector<ImplicitSceneBounds> ImplicitSceneHierarchy::GetObjectBounds(const ImplicitSceneParameters& parameters)
+{
+	std::vector<ImplicitSceneBounds> bounds;
+	bounds.reserve(ImplicitSceneSdf::ObjectCount);
+
+	const auto& ship = parameters.shipPosition;
+	const auto& beam = parameters.beamPosition;
+	const auto beamLength = parameters.beamLength;
+
+	const auto drip = parameters.dripHeights;
+	const auto dripHeight = std::max(drip[0], std::max(drip[1], drip[2]));
+
+	bounds.push_back(MorphingShapesBounds());
+	//The flat ellipsoid's estimate drops to under half the distance off its rim
+	bounds.push_back(Box(ship, Vec3<float>(-0.3f, -0.07f, -0.3f), Vec3<float>(0.3f, 0.13f, 0.3f), 0.05f, 0.4f));
+	bounds.push_back(Box(Vec3<float>(ship.x, beam.y, ship.z), Vec3<float>(-0.2f, -beamLength, -0.2f), Vec3<float>(0.2f, beamLength, 0.2f), 0.02f));
+	bounds.push_back(AlienBounds());
+	bounds.push_back(Box(Vec3<float>(0.9f, 0.6f, 0.9f), Vec3<float>(-0.1f, std::min(-0.292f, -0.32f - dripHeight), -0.1f), Vec3<float>(0.1f, 0.4f, 0.1f), 0.03f));
+	bounds.push_back(MandelbulbBounds());
+	bounds.push_back(SierpinskiTetrahedronBounds());
+	bounds.push_back(WobblySphereBounds());
+
+	AddGalleryBounds(bounds);
+
+	return bounds;
+}
+
+std::vector<ImplicitSceneBounds> ImplicitSceneHierarchy::GetObjectBoundsForAllTime()
+{
+	std::vector<ImplicitSceneBounds> bounds;
+	bounds.reserve(ImplicitSceneSdf::ObjectCount);
+
+	//sin(time / 2) goes below zero, so the ship swings from -6 to 2 in x. It bobs between 2 and 2.15 and the beam reaches
+	//11/6 of its length below it
+	bounds.push_back(MorphingShapesBounds());
+	bounds.push_back(Box(Vec3<float>(0.0f, 0.0f, 0.0f), Vec3<float>(-6.3f, 1.93f, -0.3f), Vec3<float>(2.3f, 2.28f, 0.3f), 0.05f, 0.4f));
+	bounds.push_back(Box(Vec3<float>(0.0f, 0.0f, 0.0f), Vec3<float>(-6.2f, 2.0f - 11.0f / 6.0f, -0.2f), Vec3<float>(2.2f, 2.15f + 1.0f / 6.0f, 0.2f), 0.02f));
+	bounds.push_back(AlienBounds());
+	bounds.push_back(Box(Vec3<float>(0.9f, 0.6f, 0.9f), Vec3<float>(-0.1f, -0.92f, -0.1f), Vec3<float>(0.1f, 0.4f, 0.1f), 0.03f));
+	bounds.push_back(MandelbulbBounds());
+	bounds.push_back(SierpinskiTetrahedronBounds());
+	bounds.push_back(WobblySphereBounds());
+
+	AddGalleryBounds(bounds);
+
+	return bounds;
+}
+
+ImplicitSceneHierarchy::ImplicitSceneHierarchy(const std::vector<ImplicitSceneBounds>& objectBounds) : m_root(0), m_depth(0)
+{
+	m_nodes.reserve(objectBounds.size() * 2);
+
+	std::vector<unsigned int> bounded;
+	std::vector<unsigned int> unbounded;
+
+	for (auto object = 0u; object < objectBounds.size(); object++)
+	{
+		const auto& bounds = objectBounds[object];
+		const auto unboundedObject = Extent(bounds, 0) > UnboundedExtent || Extent(bounds, 1) > UnboundedExtent || Extent(bounds, 2) > UnboundedExtent;
+
+		(unboundedObject ? unbounded : bounded).push_back(object);
+	}
+
+	if (!bounded.empty())
+	{
+		m_root = Build(objectBounds, bounded, 0, static_cast<unsigned int>(bounded.size()), 1);
+	}
+
+	//Objects with no useful box sit next to the tree under the root, tested but never culled
+	for (auto i = 0u; i < unbounded.size(); i++)
+	{
+		const auto object = unbounded[i];
+		const auto& bounds = objectBounds[object];
+
+		m_nodes.push_back({ bounds.minimum, bounds.maximum, bounds.distanceScale, static_cast<int>(object), 0, 0, 1u << object });
+
+		const auto leaf = static_cast<unsigned int>(m_nodes.size() - 1);
+
+		m_root = (bounded.empty() && i == 0) ? leaf : AddInternalNode(leaf, m_root);
+		m_depth++;
+	}
+}
+
+unsigned int ImplicitSceneHierarchy::Build(const std::vector<ImplicitSceneBounds>& objectBounds, std::vector<unsigned int>& objects, const unsigned int begin, const unsigned int end, const unsigned int depth)
+{
+	m_depth = std::max(m_depth, depth);
+
+	if (end - begin == 1)
+	{
+		const auto& bounds = objectBounds[objects[begin]];
+
+		m_nodes.push_back({ bounds.minimum, bounds.maximum, bounds.distanceScale, static_cast<int>(objects[begin]), 0, 0, 1u << objects[begin] });
+
+		return static_cast<unsigned int>(m_nodes.size() - 1);
+	}
+
+	//Median split along the axis the objects' centres are most spread out on
+	auto minimum = Vec3<float>(1e30f, 1e30f, 1e30f);
+	auto maximum = Vec3<float>(-1e30f, -1e30f, -1e30f);
+
+	for (auto i = begin; i < end; i++)
+	{
+		const auto& bounds = objectBounds[objects[i]];
+		const auto centre = (bounds.minimum + bounds.maximum) * 0.5f;
+
+		minimum = Vec3<float>(std::min(minimum.x, centre.x), std::min(minimum.y, centre.y), std::min(minimum.z, centre.z));
+		maximum = Vec3<float>(std::max(maximum.x, centre.x), std::max(maximum.y, centre.y), std::max(maximum.z, centre.z));
+	}
+
+	const auto spread = maximum - minimum;
+	const auto axis = (spread.x >= spread.y && spread.x >= spread.z) ? 0u : (spread.y >= spread.z ? 1u : 2u);
+
+	std::sort(objects.begin() + begin, objects.begin() + end, [&](const unsigned int a, const unsigned int b)
+	{
+		return Centre(objectBounds[a], axis) < Centre(objectBounds[b], axis);
+	});
+
+	const auto middle = begin + (end - begin) / 2;
+
+	const auto left = Build(objectBounds, objects, begin, middle, depth + 1);
+	const auto right = Build(objectBounds, objects, middle, end, depth + 1);
+
+	return AddInternalNode(left, right);
+}
+
+unsigned int ImplicitSceneHierarchy::AddInternalNode(const unsigned int left, const unsigned int right)
+{
+	const auto& a = m_nodes[left];
+	const auto& b = m_nodes[right];
+
+	const auto merged = Merge({ a.minimum, a.maximum, a.distanceScale }, { b.minimum, b.maximum, b.distanceScale });
+	const auto objects = a.objects | b.objects;
+
+	m_nodes.push_back({ merged.minimum, merged.maximum, merged.distanceScale, -1, left, right, objects });
+
+	return static_cast<unsigned int>(m_nodes.size() - 1);
+}
+
+std::string ImplicitSceneHierarchy::EmitHlsl() const
+{
+	std::string hlsl;
+
+	hlsl += "//Generated by ImplicitSceneHierarchy::EmitHlsl from ImplicitSceneHierarchy::GetObjectBoundsForAllTime, regenerate it\n";
+	hlsl += "//after changing the objects in sceneSDF or their bounds\n";
+	hlsl += "\n";
+	hlsl += "//Distance from outside an axis aligned box, zero inside it\n";
+	hlsl += "float boundsDistance(float3 samplePoint, float3 boundsMin, float3 boundsMax)\n";
+	hlsl += "{\n";
+	hlsl += "\treturn length(max(max(boundsMin - samplePoint, samplePoint - boundsMax), 0.0f));\n";
+	hlsl += "}\n";
+	hlsl += "\n";
+	hlsl += "//sceneSDF, skipping the objects whose boxes are further away than the closest surface so far and those that\n";
+	hlsl += "//aren't in tileObjects\n";
+	hlsl += "float4 sceneSDFHierarchy(float3 samplePoint)\n";
+	hlsl += "{\n";
+	hlsl += "\t//Contains hit distance (x) and colour (yzw)\n";
+	hlsl += "\tfloat4 closestHit = float4(1e10, 0.0f, 0.0f, 0.0f);\n";
+	hlsl += "\n";
+
+	if (!m_nodes.empty())
+	{
+		EmitNode(m_root, 1, false, hlsl);
+		hlsl += "\n";
+	}
+
+	hlsl += "\treturn closestHit;\n";
+	hlsl += "}\n";
+
+	return hlsl;
+}
+
+void ImplicitSceneHierarchy::WriteHlsl(const std::wstring& fileName) const
+{
+	const auto hlsl = EmitHlsl();
+
+	auto localFolder = Windows::Storage::ApplicationData::Current->LocalFolder->Path;
+
+	std::ofstream file(std::wstring(localFolder->Data()) + L"\\" + fileName, std::ios::binary);
+
+	if (!file.fail())
+	{
+		file << hlsl;
+	}
+}
+
+void ImplicitSceneHierarchy::EmitNode(const unsigned int nodeIndex, const unsigned int indent, const bool test, std::string& hlsl) const
+{
+	const auto& node = m_nodes[nodeIndex];
+	const auto tabs = std::string(indent, '\t');
+
+	const auto bounds = ImplicitSceneBounds{ node.minimum, node.maximum, node.distanceScale };
+	const auto unbounded = Extent(bounds, 0) > UnboundedExtent || Extent(bounds, 1) > UnboundedExtent || Extent(bounds, 2) > UnboundedExtent;
+	//Every node under the root is also skipped when none of its objects are in the pixel's tile, see ImplicitSceneTileBins
+	const auto emitTest = test;
+
+	if (emitTest)
+	{
+		auto condition = "(tileObjects & " + HlslMask(node.objects) + ") != 0";
+
+		if (!unbounded)
+		{
+			const auto scale = node.distanceScale < 1.0f ? " * " + HlslFloat(node.distanceScale) : std::string();
+
+			condition += " && boundsDistance(samplePoint, " + HlslFloat3(node.minimum) + ", " + HlslFloat3(node.maximum) + ")" + scale + " <= max(closestHit.x, 0.0f)";
+		}
+
+		hlsl += tabs + "if (" + condition + ")\n";
+	}
+
+	const auto innerTabs = emitTest ? tabs + "\t" : tabs;
+
+	if (node.object >= 0)
+	{
+		hlsl += innerTabs + "closestHit = unionSDF(closestHit, " + ImplicitSceneSdf::GetObjectName(static_cast<unsigned int>(node.object)) + "(samplePoint));\n";
+		return;
+	}
+
+	if (emitTest)
+	{
+		hlsl += tabs + "{\n";
+	}
+
+	EmitNode(node.left, emitTest ? indent + 1 : indent, true, hlsl);
+	EmitNode(node.right, emitTest ? indent + 1 : indent, true, hlsl);
+
+	if (emitTest)
+	{
+		hlsl += tabs + "}\n";
+	}
+}
@@ -0,0 +1,282 @@
+#pragma once
+
+#include "ImplicitSceneSdf.h"
+
+#include <algorithm>
+#include <bitset>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace AlienPlanetACW
+{
+	//Work done evaluating the scene, per ray rather than per packet
+	struct SdfEvaluationCount
+	{
+		SdfEvaluationCount() : objects(0), primitives(0), boundTests(0)
+		{
+			std::fill(std::begin(objectEvaluations), std::end(objectEvaluations), 0ull);
+		}
+
+		unsigned long long objects;
+		//Objects weighted by ImplicitSceneSdf::GetObjectCost
+		unsigned long long primitives;
+		unsigned long long boundTests;
+		//objects split by which object was evaluated
+		unsigned long long objectEvaluations[ImplicitSceneSdf::ObjectCount];
+
+		SdfEvaluationCount& operator+=(const SdfEvaluationCount& other)
+		{
+			objects += other.objects;
+			primitives += other.primitives;
+			boundTests += other.boundTests;
+
+			for (auto object = 0u; object < ImplicitSceneSdf::ObjectCount; object++)
+			{
+				objectEvaluations[object] += other.objectEvaluations[object];
+			}
+
+			return *this;
+		}
+	};
+
+	//Axis aligned box around one of the scene's objects. The object's distance is at least distanceScale times the
+	//distance to the box, which is below one for the objects whose SDFs overestimate
+	struct ImplicitSceneBounds
+	{
+		Sdf::Vec3<float> minimum;
+		Sdf::Vec3<float> maximum;
+		float distanceScale;
+	};
+
+	//Bounding volume hierarchy over ImplicitSceneSdf's objects. A sample only evaluates the objects whose boxes are
+	//closer than the nearest surface found so far, nearest box first, so most of sceneSDF is skipped away from the gallery
+	class ImplicitSceneHierarchy
+	{
+	public:
+		explicit ImplicitSceneHierarchy(const std::vector<ImplicitSceneBounds>& objectBounds);
+
+		//Boxes for the objects as they are at one point in time, which the animated ones move with
+		static std::vector<ImplicitSceneBounds> GetObjectBounds(const ImplicitSceneParameters& parameters);
+		//Boxes that hold at any time, for the shader where the tree is fixed when it's compiled
+		static std::vector<ImplicitSceneBounds> GetObjectBoundsForAllTime();
+
+		//countBits are the lanes that count towards count, the ones still marching. Nodes further away than
+		//standInDistance aren't opened and their box distance is used instead, which is a safe step but not the
+		//scene's distance, so it changes the marching slightly
+		template <typename T>
+		Sdf::Sample<T> Evaluate(const ImplicitSceneParameters& parameters, const Sdf::Vec3<T>& samplePoint, unsigned int countBits, SdfEvaluationCount& count, float standInDistance = 1e10f) const;
+		//Evaluate with the leaves going to evaluateObject(object, samplePoint) rather than ImplicitSceneSdf::EvaluateObject,
+		//for when some objects come from somewhere else such as ImplicitSceneBricks. objectMask has bit n set for object
+		//n, and the subtrees without any of its objects are left out without testing their boxes
+		template <typename T, typename ObjectEvaluator>
+		Sdf::Sample<T> EvaluateWith(const ObjectEvaluator& evaluateObject, const Sdf::Vec3<T>& samplePoint, unsigned int countBits, SdfEvaluationCount& count, float standInDistance = 1e10f, unsigned int objectMask = ~0u) const;
+
+		//ImplicitSceneSdf::Evaluate with the same counting, for comparison
+		template <typename T>
+		static Sdf::Sample<T> EvaluateFlat(const ImplicitSceneParameters& parameters, const Sdf::Vec3<T>& samplePoint, unsigned int countBits, SdfEvaluationCount& count);
+		//objectMask has bit n set for object n, and the objects without theirs are left out, see ImplicitSceneIntervals
+		template <typename T, typename ObjectEvaluator>
+		static Sdf::Sample<T> EvaluateFlatWith(const ObjectEvaluator& evaluateObject, const Sdf::Vec3<T>& samplePoint, unsigned int countBits, SdfEvaluationCount& count, unsigned int objectMask = ~0u);
+
+		//sceneSDFHierarchy for ImplicitRayModelsPS.hlsl, the tree unrolled into nested ifs using the object functions
+		std::string EmitHlsl() const;
+		//Writes EmitHlsl to the app's local folder, to be copied over ImplicitSceneHierarchy.hlsli
+		void WriteHlsl(const std::wstring& fileName) const;
+
+		unsigned int GetNodeCount() const { return static_cast<unsigned int>(m_nodes.size()); }
+		unsigned int GetDepth() const { return m_depth; }
+
+	private:
+		struct Node
+		{
+			Sdf::Vec3<float> minimum;
+			Sdf::Vec3<float> maximum;
+			//Smallest of the objects' scales below this node
+			float distanceScale;
+			//-1 for an internal node
+			int object;
+			unsigned int left;
+			unsigned int right;
+			//Bit n set for each object n under the node
+			unsigned int objects;
+		};
+
+		static const unsigned int MaxDepth = 32;
+
+		unsigned int Build(const std::vector<ImplicitSceneBounds>& objectBounds, std::vector<unsigned int>& objects, unsigned int begin, unsigned int end, unsigned int depth);
+		unsigned int AddInternalNode(unsigned int left, unsigned int right);
+		void EmitNode(unsigned int node, unsigned int indent, bool test, std::string& hlsl) const;
+
+		template <typename T>
+		static T NodeDistance(const Node& node, const Sdf::Vec3<T>& p);
+
+		std::vector<Node> m_nodes;
+		unsigned int m_root;
+		unsigned int m_depth;
+	};
+
+	template <typename T>
+	T ImplicitSceneHierarchy::NodeDistance(const Node& node, const Sdf::Vec3<T>& p)
+	{
+		using namespace Sdf;
+
+		const auto outside = Vec3<T>(
+			Max(Max(T(node.minimum.x) - p.x, p.x - node.maximum.x), T(0.0f)),
+			Max(Max(T(node.minimum.y) - p.y, p.y - node.maximum.y), T(0.0f)),
+			Max(Max(T(node.minimum.z) - p.z, p.z - node.maximum.z), T(0.0f)));
+
+		return Length(outside) * node.distanceScale;
+	}
+
+	template <typename T>
+	Sdf::Sample<T> ImplicitSceneHierarchy::Evaluate(const ImplicitSceneParameters& parameters, const Sdf::Vec3<T>& samplePoint, const unsigned int countBits, SdfEvaluationCount& count, const float standInDistance) const
+	{
+		const auto evaluateObject = [&parameters](const unsigned int object, const Sdf::Vec3<T>& p) { return ImplicitSceneSdf::EvaluateObject(parameters, object, p); };
+
+		return EvaluateWith(evaluateObject, samplePoint, countBits, count, standInDistance);
+	}
+
+	template <typename T, typename ObjectEvaluator>
+	Sdf::Sample<T> ImplicitSceneHierarchy::EvaluateWith(const ObjectEvaluator& evaluateObject, const Sdf::Vec3<T>& samplePoint, const unsigned int countBits, SdfEvaluationCount& count, const float standInDistance, const unsigned int objectMask) const
+	{
+		using namespace Sdf;
+
+		struct Entry
+		{
+			unsigned int node;
+			T distance;
+		};
+
+		const auto countedLanes = std::bitset<8>(countBits).count();
+
+		auto closestHit = Sample<T>(T(1e10f), Vec3<T>(T(0.0f), T(0.0f), T(0.0f)));
+
+		Entry stack[MaxDepth + 1];
+		auto size = 0u;
+
+		if ((m_nodes[m_root].objects & objectMask) == 0)
+		{
+			return closestHit;
+		}
+
+		stack[size++] = { m_root, NodeDistance(m_nodes[m_root], samplePoint) };
+		count.boundTests += countedLanes;
+
+		while (size > 0)
+		{
+			const auto entry = stack[--size];
+
+			//Inside a box the distance is zero, so the node is opened even when the closest hit is inside another object
+			const auto open = entry.distance <= Max(closestHit.distance, T(0.0f));
+			const auto standIn = And(open, entry.distance > T(standInDistance));
+			const auto lanes = AndNot(open, standIn);
+
+			closestHit.distance = Select(standIn, entry.distance, closestHit.distance);
+
+			if (!Any(lanes))
+			{
+				continue;
+			}
+
+			const auto laneCount = std::bitset<8>(Bits(lanes) & countBits).count();
+			const auto& node = m_nodes[entry.node];
+
+			if (node.object >= 0)
+			{
+				const auto object = static_cast<unsigned int>(node.object);
+				const auto sample = evaluateObject(object, samplePoint);
+
+				//unionSDF, so ties go to the object
+				const auto closer = AndNot(lanes, closestHit.distance < sample.distance);
+
+				closestHit = Sample<T>(Select(closer, sample.distance, closestHit.distance), Select(closer, sample.colour, closestHit.colour));
+
+				count.objects += laneCount;
+				count.primitives += laneCount * ImplicitSceneSdf::GetObjectCost(object);
+				count.objectEvaluations[object] += laneCount;
+			}
+			else
+			{
+				//A child with none of objectMask's objects under it isn't tested
+				const auto leftKept = (m_nodes[node.left].objects & objectMask) != 0;
+				const auto rightKept = (m_nodes[node.right].objects & objectMask) != 0;
+
+				if (!leftKept || !rightKept)
+				{
+					if (leftKept || rightKept)
+					{
+						const auto child = leftKept ? node.left : node.right;
+
+						stack[size++] = { child, Select(lanes, NodeDistance(m_nodes[child], samplePoint), T(1e30f)) };
+						count.boundTests += laneCount;
+					}
+
+					continue;
+				}
+
+				//Lanes that didn't open this node can't open its children
+				const auto left = Select(lanes, NodeDistance(m_nodes[node.left], samplePoint), T(1e30f));
+				const auto right = Select(lanes, NodeDistance(m_nodes[node.right], samplePoint), T(1e30f));
+
+				count.boundTests += 2 * laneCount;
+
+				//The child nearer for most of the lanes goes on top, so its surface can cull the other
+				const auto leftNearer = std::bitset<8>(Bits(And(lanes, left <= right))).count() * 2 >= std::bitset<8>(Bits(lanes)).count();
+
+				if (leftNearer)
+				{
+					stack[size++] = { node.right, right };
+					stack[size++] = { node.left, left };
+				}
+				else
+				{
+					stack[size++] = { node.left, left };
+					stack[size++] = { node.right, right };
+				}
+			}
+		}
+
+		return closestHit;
+	}
+
+	template <typename T>
+	Sdf::Sample<T> ImplicitSceneHierarchy::EvaluateFlat(const ImplicitSceneParameters& parameters, const Sdf::Vec3<T>& samplePoint, const unsigned int countBits, SdfEvaluationCount& count)
+	{
+		const auto countedLanes = std::bitset<8>(countBits).count();
+
+		count.objects += countedLanes * ImplicitSceneSdf::ObjectCount;
+
+		for (auto object = 0u; object < ImplicitSceneSdf::ObjectCount; object++)
+		{
+			count.primitives += countedLanes * ImplicitSceneSdf::GetObjectCost(object);
+			count.objectEvaluations[object] += countedLanes;
+		}
+
+		return ImplicitSceneSdf::Evaluate(parameters, samplePoint);
+	}
+
+	template <typename T, typename ObjectEvaluator>
+	Sdf::Sample<T> ImplicitSceneHierarchy::EvaluateFlatWith(const ObjectEvaluator& evaluateObject, const Sdf::Vec3<T>& samplePoint, const unsigned int countBits, SdfEvaluationCount& count, const unsigned int objectMask)
+	{
+		const auto countedLanes = std::bitset<8>(countBits).count();
+
+		auto closestHit = Sdf::Sample<T>(T(1e10f), Sdf::Vec3<T>(T(0.0f), T(0.0f), T(0.0f)));
+
+		for (auto object = 0u; object < ImplicitSceneSdf::ObjectCount; object++)
+		{
+			if ((objectMask & (1u << object)) == 0)
+			{
+				continue;
+			}
+
+			closestHit = Sdf::Union(closestHit, evaluateObject(object, samplePoint));
+
+			count.objects += countedLanes;
+			count.primitives += countedLanes * ImplicitSceneSdf::GetObjectCost(object);
+			count.objectEvaluations[object] += countedLanes;
+		}
+
+		return closestHit;
+	}
+}
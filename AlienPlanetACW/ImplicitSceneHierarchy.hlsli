@@ -0,0 +1,133 @@
+//Generated by ImplicitSceneHierarchy::EmitHlsl from ImplicitSceneHierarchy::GetObjectBoundsForAllTime, regenerate it
+//after changing the objects in sceneSDF or their bounds
+
+//Distance from outside an axis aligned box, zero inside it
+float boundsDistance(float3 samplePoint, float3 boundsMin, float3 boundsMax)
+{
+	return length(max(max(boundsMin - samplePoint, samplePoint - boundsMax), 0.0f));
+}
+
+//sceneSDF, skipping the objects whose boxes are further away than the closest surface so far and those that
+//aren't in tileObjects
+float4 sceneSDFHierarchy(float3 samplePoint)
+{
+	//Contains hit distance (x) and colour (yzw)
+	float4 closestHit = float4(1e10, 0.0f, 0.0f, 0.0f);
+
+	if ((tileObjects & 0x00000001u) != 0)
+		closestHit = unionSDF(closestHit, morphingShapesSDF(samplePoint));
+	if ((tileObjects & 0x00FFFFFEu) != 0 && boundsDistance(samplePoint, float3(-6.3500f, -0.3500f, -5.0000f), float3(2.5200f, 3.5000f, 2.5970f)) * 0.1500f <= max(closestHit.x, 0.0f))
+	{
+		if ((tileObjects & 0x00CED026u) != 0 && boundsDistance(samplePoint, float3(-6.3500f, 0.1467f, -5.0000f), float3(2.3500f, 3.5000f, 0.6500f)) * 0.4000f <= max(closestHit.x, 0.0f))
+		{
+			if ((tileObjects & 0x00021026u) != 0 && boundsDistance(samplePoint, float3(-6.3500f, 0.1467f, -5.0000f), float3(2.3500f, 3.5000f, 0.3500f)) * 0.4000f <= max(closestHit.x, 0.0f))
+			{
+				if ((tileObjects & 0x00000022u) != 0 && boundsDistance(samplePoint, float3(-6.3500f, 0.5000f, -5.0000f), float3(2.3500f, 3.5000f, 0.3500f)) * 0.4000f <= max(closestHit.x, 0.0f))
+				{
+					if ((tileObjects & 0x00000020u) != 0 && boundsDistance(samplePoint, float3(-5.5000f, 0.5000f, -5.0000f), float3(-2.5000f, 3.5000f, -2.0000f)) <= max(closestHit.x, 0.0f))
+						closestHit = unionSDF(closestHit, mandelBulbSDF(samplePoint));
+					if ((tileObjects & 0x00000002u) != 0 && boundsDistance(samplePoint, float3(-6.3500f, 1.8800f, -0.3500f), float3(2.3500f, 2.3300f, 0.3500f)) * 0.4000f <= max(closestHit.x, 0.0f))
+						closestHit = unionSDF(closestHit, alienShipSDF(samplePoint));
+				}
+				if ((tileObjects & 0x00021004u) != 0 && boundsDistance(samplePoint, float3(-6.2200f, 0.1467f, -0.3600f), float3(2.2200f, 2.3367f, 0.2200f)) <= max(closestHit.x, 0.0f))
+				{
+					if ((tileObjects & 0x00000004u) != 0 && boundsDistance(samplePoint, float3(-6.2200f, 0.1467f, -0.2200f), float3(2.2200f, 2.3367f, 0.2200f)) <= max(closestHit.x, 0.0f))
+						closestHit = unionSDF(closestHit, alienShipBeamSDF(samplePoint));
+					if ((tileObjects & 0x00021000u) != 0 && boundsDistance(samplePoint, float3(-0.6534f, 0.4650f, -0.3600f), float3(-0.2400f, 0.5600f, -0.2400f)) <= max(closestHit.x, 0.0f))
+					{
+						if ((tileObjects & 0x00020000u) != 0 && boundsDistance(samplePoint, float3(-0.6534f, 0.4650f, -0.3300f), float3(-0.5466f, 0.5600f, -0.2700f)) <= max(closestHit.x, 0.0f))
+							closestHit = unionSDF(closestHit, galleryTriPrismSDF(samplePoint));
+						if ((tileObjects & 0x00001000u) != 0 && boundsDistance(samplePoint, float3(-0.3600f, 0.4800f, -0.3600f), float3(-0.2400f, 0.5200f, -0.2400f)) <= max(closestHit.x, 0.0f))
+							closestHit = unionSDF(closestHit, galleryTorusSDF(samplePoint));
+					}
+				}
+			}
+			if ((tileObjects & 0x00CCC000u) != 0 && boundsDistance(samplePoint, float3(-0.6500f, 0.4320f, -0.0600f), float3(-0.2320f, 0.5900f, 0.6500f)) <= max(closestHit.x, 0.0f))
+			{
+				if ((tileObjects & 0x000C4000u) != 0 && boundsDistance(samplePoint, float3(-0.6460f, 0.4400f, -0.0600f), float3(-0.2400f, 0.5860f, 0.3300f)) <= max(closestHit.x, 0.0f))
+				{
+					if ((tileObjects & 0x00040000u) != 0 && boundsDistance(samplePoint, float3(-0.6460f, 0.4720f, -0.0260f), float3(-0.5720f, 0.5860f, 0.0460f)) <= max(closestHit.x, 0.0f))
+						closestHit = unionSDF(closestHit, galleryLineCylinderSDF(samplePoint));
+					if ((tileObjects & 0x00084000u) != 0 && boundsDistance(samplePoint, float3(-0.6300f, 0.4400f, -0.0600f), float3(-0.2400f, 0.5600f, 0.3300f)) <= max(closestHit.x, 0.0f))
+					{
+						if ((tileObjects & 0x00080000u) != 0 && boundsDistance(samplePoint, float3(-0.6300f, 0.4500f, 0.2700f), float3(-0.5700f, 0.5500f, 0.3300f)) <= max(closestHit.x, 0.0f))
+							closestHit = unionSDF(closestHit, galleryCylinderSDF(samplePoint));
+						if ((tileObjects & 0x00004000u) != 0 && boundsDistance(samplePoint, float3(-0.3600f, 0.4400f, -0.0600f), float3(-0.2400f, 0.5600f, 0.0600f)) <= max(closestHit.x, 0.0f))
+							closestHit = unionSDF(closestHit, galleryBoxSDF(samplePoint));
+					}
+				}
+				if ((tileObjects & 0x00C08000u) != 0 && boundsDistance(samplePoint, float3(-0.6500f, 0.4320f, 0.2340f), float3(-0.2320f, 0.5900f, 0.6500f)) <= max(closestHit.x, 0.0f))
+				{
+					if ((tileObjects & 0x00800000u) != 0 && boundsDistance(samplePoint, float3(-0.6500f, 0.4500f, 0.5500f), float3(-0.5500f, 0.5900f, 0.6500f)) <= max(closestHit.x, 0.0f))
+						closestHit = unionSDF(closestHit, galleryUprightRoundConeSDF(samplePoint));
+					if ((tileObjects & 0x00408000u) != 0 && boundsDistance(samplePoint, float3(-0.3680f, 0.4320f, 0.2340f), float3(-0.2320f, 0.5680f, 0.6200f)) <= max(closestHit.x, 0.0f))
+					{
+						if ((tileObjects & 0x00008000u) != 0 && boundsDistance(samplePoint, float3(-0.3660f, 0.4340f, 0.2340f), float3(-0.2340f, 0.5660f, 0.3660f)) <= max(closestHit.x, 0.0f))
+							closestHit = unionSDF(closestHit, galleryRoundBoxSDF(samplePoint));
+						if ((tileObjects & 0x00400000u) != 0 && boundsDistance(samplePoint, float3(-0.3680f, 0.4320f, 0.5800f), float3(-0.2320f, 0.5680f, 0.6200f)) <= max(closestHit.x, 0.0f))
+							closestHit = unionSDF(closestHit, galleryHexPrismSDF(samplePoint));
+					}
+				}
+			}
+		}
+		if ((tileObjects & 0x00312FD8u) != 0 && boundsDistance(samplePoint, float3(-0.0800f, -0.3500f, -1.3300f), float3(2.5200f, 2.3090f, 2.5970f)) * 0.1500f <= max(closestHit.x, 0.0f))
+		{
+			if ((tileObjects & 0x00012E80u) != 0 && boundsDistance(samplePoint, float3(-0.0620f, 0.1700f, -1.3300f), float3(1.3300f, 0.8300f, 0.3620f)) * 0.1500f <= max(closestHit.x, 0.0f))
+			{
+				if ((tileObjects & 0x00012080u) != 0 && boundsDistance(samplePoint, float3(-0.0600f, 0.1700f, -1.3300f), float3(1.3300f, 0.8300f, -0.2400f)) * 0.6500f <= max(closestHit.x, 0.0f))
+				{
+					if ((tileObjects & 0x00002000u) != 0 && boundsDistance(samplePoint, float3(-0.0600f, 0.4800f, -0.3600f), float3(0.0600f, 0.5200f, -0.2400f)) * 0.7500f <= max(closestHit.x, 0.0f))
+						closestHit = unionSDF(closestHit, galleryTorus82SDF(samplePoint));
+					if ((tileObjects & 0x00010080u) != 0 && boundsDistance(samplePoint, float3(0.2400f, 0.1700f, -1.3300f), float3(1.3300f, 0.8300f, -0.2700f)) * 0.6500f <= max(closestHit.x, 0.0f))
+					{
+						if ((tileObjects & 0x00010000u) != 0 && boundsDistance(samplePoint, float3(0.2400f, 0.4400f, -0.3300f), float3(0.3600f, 0.5600f, -0.2700f)) * 0.6500f <= max(closestHit.x, 0.0f))
+							closestHit = unionSDF(closestHit, galleryEllipsoidSDF(samplePoint));
+						if ((tileObjects & 0x00000080u) != 0 && boundsDistance(samplePoint, float3(0.6700f, 0.1700f, -1.3300f), float3(1.3300f, 0.8300f, -0.6700f)) <= max(closestHit.x, 0.0f))
+							closestHit = unionSDF(closestHit, wobblySphereSDF(samplePoint));
+					}
+				}
+				if ((tileObjects & 0x00000E00u) != 0 && boundsDistance(samplePoint, float3(-0.0620f, 0.4400f, -0.0550f), float3(0.3500f, 0.5600f, 0.3620f)) * 0.1500f <= max(closestHit.x, 0.0f))
+				{
+					if ((tileObjects & 0x00000200u) != 0 && boundsDistance(samplePoint, float3(-0.0550f, 0.4600f, -0.0550f), float3(0.0550f, 0.5400f, 0.0550f)) * 0.1500f <= max(closestHit.x, 0.0f))
+						closestHit = unionSDF(closestHit, galleryConeSDF(samplePoint));
+					if ((tileObjects & 0x00000C00u) != 0 && boundsDistance(samplePoint, float3(-0.0620f, 0.4400f, -0.0500f), float3(0.3500f, 0.5600f, 0.3620f)) * 0.5500f <= max(closestHit.x, 0.0f))
+					{
+						if ((tileObjects & 0x00000800u) != 0 && boundsDistance(samplePoint, float3(-0.0620f, 0.4400f, 0.2380f), float3(0.0620f, 0.5600f, 0.3620f)) * 0.5500f <= max(closestHit.x, 0.0f))
+							closestHit = unionSDF(closestHit, galleryTwistedTorusSDF(samplePoint));
+						if ((tileObjects & 0x00000400u) != 0 && boundsDistance(samplePoint, float3(0.2500f, 0.4600f, -0.0500f), float3(0.3500f, 0.5400f, 0.0500f)) <= max(closestHit.x, 0.0f))
+							closestHit = unionSDF(closestHit, galleryCappedConeSDF(samplePoint));
+					}
+				}
+			}
+			if ((tileObjects & 0x00300158u) != 0 && boundsDistance(samplePoint, float3(-0.0800f, -0.3500f, 0.2600f), float3(2.5200f, 2.3090f, 2.5970f)) * 0.6000f <= max(closestHit.x, 0.0f))
+			{
+				if ((tileObjects & 0x00300100u) != 0 && boundsDistance(samplePoint, float3(-0.0800f, 0.4200f, 0.2600f), float3(0.3600f, 0.5800f, 0.6800f)) * 0.6000f <= max(closestHit.x, 0.0f))
+				{
+					if ((tileObjects & 0x00200000u) != 0 && boundsDistance(samplePoint, float3(-0.0800f, 0.4200f, 0.5200f), float3(0.0800f, 0.5800f, 0.6800f)) <= max(closestHit.x, 0.0f))
+						closestHit = unionSDF(closestHit, galleryOctahedronSDF(samplePoint));
+					if ((tileObjects & 0x00100100u) != 0 && boundsDistance(samplePoint, float3(0.2600f, 0.4500f, 0.2600f), float3(0.3600f, 0.5800f, 0.6300f)) * 0.6000f <= max(closestHit.x, 0.0f))
+					{
+						if ((tileObjects & 0x00000100u) != 0 && boundsDistance(samplePoint, float3(0.2600f, 0.4600f, 0.2600f), float3(0.3600f, 0.5800f, 0.3400f)) <= max(closestHit.x, 0.0f))
+							closestHit = unionSDF(closestHit, galleryRoundConeSDF(samplePoint));
+						if ((tileObjects & 0x00100000u) != 0 && boundsDistance(samplePoint, float3(0.2700f, 0.4500f, 0.5700f), float3(0.3300f, 0.5500f, 0.6300f)) * 0.6000f <= max(closestHit.x, 0.0f))
+							closestHit = unionSDF(closestHit, galleryCylinder6SDF(samplePoint));
+					}
+				}
+				if ((tileObjects & 0x00000058u) != 0 && boundsDistance(samplePoint, float3(0.7700f, -0.3500f, 0.3700f), float3(2.5200f, 2.3090f, 2.5970f)) * 0.8000f <= max(closestHit.x, 0.0f))
+				{
+					if ((tileObjects & 0x00000008u) != 0 && boundsDistance(samplePoint, float3(0.8100f, 0.4400f, 0.3700f), float3(1.0100f, 0.7000f, 0.6300f)) * 0.8000f <= max(closestHit.x, 0.0f))
+						closestHit = unionSDF(closestHit, alienSDF(samplePoint));
+					if ((tileObjects & 0x00000050u) != 0 && boundsDistance(samplePoint, float3(0.7700f, -0.3500f, 0.7700f), float3(2.5200f, 2.3090f, 2.5970f)) <= max(closestHit.x, 0.0f))
+					{
+						if ((tileObjects & 0x00000010u) != 0 && boundsDistance(samplePoint, float3(0.7700f, -0.3500f, 0.7700f), float3(1.0300f, 1.0300f, 1.0300f)) <= max(closestHit.x, 0.0f))
+							closestHit = unionSDF(closestHit, waterDripSDF(samplePoint));
+						if ((tileObjects & 0x00000040u) != 0 && boundsDistance(samplePoint, float3(1.4800f, 1.4800f, 1.6910f), float3(2.5200f, 2.3090f, 2.5970f)) <= max(closestHit.x, 0.0f))
+							closestHit = unionSDF(closestHit, sierpinskiTetrahedronSDF(samplePoint));
+					}
+				}
+			}
+		}
+	}
+
+	return closestHit;
+}
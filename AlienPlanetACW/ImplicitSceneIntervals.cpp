@@ -0,0 +1,142 @@
+#include "pch.h"
+#include "ImplicitSceneIntervals.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+
+using namespace AlienPlanetACW;
+using namespace AlienPlanetACW::Sdf;
+
+//A 16 pixel tile is about a fiftieth of its depth across at 1280 wide, so slabs a tenth deeper than the last aren't much
+//longer than they are wide. 50 of them reach past MaxDistance
+const unsigned int ImplicitSceneIntervals::SlabCount = 50;
+const float ImplicitSceneIntervals::SlabNear = 0.5f;
+const float ImplicitSceneIntervals::SlabRatio = 1.1f;
+
+const unsigned int ImplicitSceneIntervals::AllObjects;
+
+unsigned int ImplicitSceneIntervals::GetSlab(const float depth)
+{
+	if (depth < SlabNear)
+	{
+		return 0;
+	}
+
+	const auto slab = 1 + static_cast<unsigned int>(std::log(depth / SlabNear) / std::log(SlabRatio));
+
+	return std::min(slab, SlabCount - 1);
+}
+
+float ImplicitSceneIntervals::GetSlabStart(const unsigned int slab)
+{
+	return slab == 0 ? 0.0f : SlabNear * std::pow(SlabRatio, static_cast<float>(slab - 1));
+}
+
+float ImplicitSceneIntervals::GetSlabEnd(const unsigned int slab)
+{
+	return SlabNear * std::pow(SlabRatio, static_cast<float>(slab));
+}
+
+ImplicitSceneIntervals::ImplicitSceneIntervals(const ImplicitSceneParameters& parameters, const std::vector<ImplicitSceneBounds>& objectBounds, const float (&objectScales)[ImplicitSceneSdf::ObjectCount])
+	: m_parameters(parameters), m_objectBounds(objectBounds)
+{
+	for (auto object = 0u; object < ImplicitSceneSdf::ObjectCount; object++)
+	{
+		m_objectScales[object] = objectScales[object];
+		m_objectLipschitz[object] = ImplicitSceneSdf::GetObjectLipschitz(parameters, object) * objectScales[object];
+	}
+}
+
+Interval ImplicitSceneIntervals::BoundObject(const unsigned int object, const Vec3<float>& centre, const float radius, const float centreDistance) const
+{
+	const auto spread = m_objectLipschitz[object] * radius;
+
+	return Intersect(Interval(centreDistance - spread, centreDistance + spread), Interval(BoundObjectBox(object, centre, radius), 1e30f));
+}
+
+//NodeDistance from ImplicitSceneHierarchy over intervals, the box's distance from every point of the region at once
+float ImplicitSceneIntervals::BoundObjectBox(const unsigned int object, const Vec3<float>& centre, const float radius) const
+{
+	const auto& bounds = m_objectBounds[object];
+	const auto region = IntervalBox(centre, radius);
+	const auto zero = Interval(0.0f);
+
+	const auto outside = Vec3<Interval>(
+		Max(Max(bounds.minimum.x - region.x, region.x - bounds.maximum.x), zero),
+		Max(Max(bounds.minimum.y - region.y, region.y - bounds.maximum.y), zero),
+		Max(Max(bounds.minimum.z - region.z, region.z - bounds.maximum.z), zero));
+
+	return Length(outside).lower * bounds.distanceScale * m_objectScales[object];
+}
+
+unsigned int ImplicitSceneIntervals::Prune(const Vec3<float>& centre, const float radius, const unsigned int candidates, SdfPruningCount& count) const
+{
+	struct Candidate
+	{
+		unsigned int object;
+		float boxDistance;
+	};
+
+	Candidate order[ImplicitSceneSdf::ObjectCount];
+	auto candidateCount = 0u;
+
+	for (auto object = 0u; object < ImplicitSceneSdf::ObjectCount; object++)
+	{
+		if ((candidates & (1u << object)) != 0)
+		{
+			order[candidateCount++] = { object, BoundObjectBox(object, centre, radius) };
+		}
+	}
+
+	std::sort(order, order + candidateCount, [](const Candidate& a, const Candidate& b) { return a.boxDistance < b.boxDistance; });
+
+	Interval distances[ImplicitSceneSdf::ObjectCount];
+	auto nearestUpper = 1e30f;
+	auto bounded = 0u;
+
+	for (; bounded < candidateCount && order[bounded].boxDistance <= nearestUpper; bounded++)
+	{
+		const auto object = order[bounded].object;
+
+		//An estimate that jumps can be anywhere above its box's distance
+		if (!ImplicitSceneSdf::IsObjectLipschitz(object))
+		{
+			distances[bounded] = Interval(order[bounded].boxDistance, 1e30f);
+			continue;
+		}
+
+		const auto centreDistance = ImplicitSceneSdf::EvaluateObject(m_parameters, object, centre).distance * m_objectScales[object];
+
+		distances[bounded] = BoundObject(object, centre, radius, centreDistance);
+		nearestUpper = std::min(nearestUpper, distances[bounded].upper);
+		count.objectEvaluations++;
+	}
+
+	//The union's interval is the Min of the objects', and only the ones reaching below its top can be its minimum
+	auto mask = 0u;
+
+	for (auto i = 0u; i < bounded; i++)
+	{
+		if (distances[i].lower <= nearestUpper)
+		{
+			mask |= 1u << order[i].object;
+		}
+	}
+
+	const auto kept = static_cast<unsigned int>(std::bitset<32>(mask).count());
+
+	count.regions++;
+	count.keptObjects += kept;
+	count.maxKeptObjects = std::max(count.maxKeptObjects, kept);
+
+	for (auto object = 0u; object < ImplicitSceneSdf::ObjectCount; object++)
+	{
+		if ((mask & (1u << object)) != 0)
+		{
+			count.keptPrimitives += ImplicitSceneSdf::GetObjectCost(object);
+		}
+	}
+
+	return mask;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "ImplicitSceneHierarchy.h"
+#include "SdfInterval.h"
+
+#include <vector>
+
+namespace AlienPlanetACW
+{
+	//Work done pruning, summed over the regions
+	struct SdfPruningCount
+	{
+		SdfPruningCount() : regions(0), keptObjects(0), keptPrimitives(0), maxKeptObjects(0), objectEvaluations(0), milliseconds(0.0) {}
+
+		unsigned long long regions;
+		//Objects left in the regions' masks, and those weighted by ImplicitSceneSdf::GetObjectCost
+		unsigned long long keptObjects;
+		unsigned long long keptPrimitives;
+		unsigned int maxKeptObjects;
+		//Objects evaluated at regions' centres to bound them, the rest were pruned on their boxes alone
+		unsigned long long objectEvaluations;
+		//Summed over the threads, so CPU time rather than time off the frame
+		double milliseconds;
+
+		double GetObjectsPerRegion() const { return regions > 0 ? static_cast<double>(keptObjects) / regions : 0.0; }
+		double GetPrimitivesPerRegion() const { return regions > 0 ? static_cast<double>(keptPrimitives) / regions : 0.0; }
+		double GetEvaluationsPerRegion() const { return regions > 0 ? static_cast<double>(objectEvaluations) / regions : 0.0; }
+
+		SdfPruningCount& operator+=(const SdfPruningCount& other)
+		{
+			regions += other.regions;
+			keptObjects += other.keptObjects;
+			keptPrimitives += other.keptPrimitives;
+			maxKeptObjects = std::max(maxKeptObjects, other.maxKeptObjects);
+			objectEvaluations += other.objectEvaluations;
+			milliseconds += other.milliseconds;
+
+			return *this;
+		}
+	};
+
+	//Keeter's interval pruning of sceneSDF's union, after "Massively Parallel Rendering of Complex Closed-Form Implicit
+	//Surfaces". Over a region every object's distance is bounded by an interval, and the objects whose lowest distance is
+	//above the nearest highest one can't be the nearest surface anywhere in it. The rest, as a mask with bit n for
+	//object n, is the region's simplified scene, which gives the same distance as the whole scene at every point inside.
+	//The objects branch per lane and the fractals iterate, so rather than carrying intervals through every primitive an
+	//object is bounded by its distance at the region's centre give or take its Lipschitz bound times the radius, the
+	//mean value form, tightened by the interval distance to its box. The objects that aren't
+	//ImplicitSceneSdf::IsObjectLipschitz are only bounded below, by their boxes
+	class ImplicitSceneIntervals
+	{
+	public:
+		static const unsigned int AllObjects = (1u << ImplicitSceneSdf::ObjectCount) - 1;
+
+		//Depth slabs along the rays, so a screen tile's frustum is cut into regions that grow with their distance like
+		//the tile does. Slab 0 runs up to SlabNear and each one after is SlabRatio times deeper than the last
+		static const unsigned int SlabCount;
+		static const float SlabNear;
+		static const float SlabRatio;
+
+		static unsigned int GetSlab(float depth);
+		static float GetSlabStart(unsigned int slab);
+		static float GetSlabEnd(unsigned int slab);
+
+		//objectBounds are the boxes for this time. objectScales multiply each object's distance, one over
+		//ImplicitSceneSdf::GetObjectLipschitz for Lipschitz scaled marching and otherwise one
+		ImplicitSceneIntervals(const ImplicitSceneParameters& parameters, const std::vector<ImplicitSceneBounds>& objectBounds, const float (&objectScales)[ImplicitSceneSdf::ObjectCount]);
+
+		//Bounds on the object's scaled distance over the ball of radius around centre. centreDistance is its scaled
+		//distance at centre
+		Sdf::Interval BoundObject(unsigned int object, const Sdf::Vec3<float>& centre, float radius, float centreDistance) const;
+		//Lowest the object's scaled distance can be over the ball, from its box alone
+		float BoundObjectBox(unsigned int object, const Sdf::Vec3<float>& centre, float radius) const;
+
+		//The objects of candidates that can be the nearest somewhere within radius of centre. Objects are bounded nearest
+		//box first, and once a box is further than the nearest surface can be the rest are pruned without evaluating them
+		unsigned int Prune(const Sdf::Vec3<float>& centre, float radius, unsigned int candidates, SdfPruningCount& count) const;
+
+	private:
+		const ImplicitSceneParameters& m_parameters;
+		const std::vector<ImplicitSceneBounds>& m_objectBounds;
+		float m_objectScales[ImplicitSceneSdf::ObjectCount];
+		float m_objectLipschitz[ImplicitSceneSdf::ObjectCount];
+	};
+}
@@ -0,0 +1,552 @@
+#include "pch.h"
+#include "ImplicitSceneMesher.h"
+
+#include <chrono>
+#include <cmath>
+#include <ppl.h>
+
+using namespace AlienPlanetACW;
+using namespace AlienPlanetACW::Sdf;
+
+const int ImplicitSceneMesher::RayMarched;
+
+namespace
+{
+	template <typename Function>
+	void ForEach(const size_t count, const bool parallel, const Function& function)
+	{
+		if (parallel)
+		{
+			concurrency::parallel_for(static_cast<size_t>(0), count, function);
+		}
+		else
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				function(i);
+			}
+		}
+	}
+
+	//Corners of a cell by bit, x in bit 0, y in bit 1 and z in bit 2, and the twelve edges between them
+	const unsigned int cellEdges[12][2] =
+	{
+		{ 0, 1 }, { 2, 3 }, { 4, 5 }, { 6, 7 },
+		{ 0, 2 }, { 1, 3 }, { 4, 6 }, { 5, 7 },
+		{ 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 }
+	};
+
+	//How far the vertex is pulled towards the crossings' mass point, which keeps it put along the directions the planes
+	//don't pin down, such as along a flat face or an edge
+	const float massPointWeight = 0.05f;
+
+	//Cells out from the estimate's zero the surfaces of the objects that aren't Lipschitz are taken at, see MakeGrid
+	const float dustLevel = 0.125f;
+
+	//Triangles to the error measurement at a time
+	const size_t errorChunkSize = 4096;
+
+	DirectX::XMFLOAT3 ToFloat3(const Vec3<float>& v)
+	{
+		return DirectX::XMFLOAT3(v.x, v.y, v.z);
+	}
+
+	Vec3<float> FromFloat3(const DirectX::XMFLOAT3& v)
+	{
+		return Vec3<float>(v.x, v.y, v.z);
+	}
+}
+
+ImplicitSceneMesher::ImplicitSceneMesher(const ImplicitSceneParameters& parameters, const unsigned int object, const bool parallel)
+	: m_parameters(parameters), m_object(object), m_bounds(ImplicitSceneHierarchy::GetObjectBounds(parameters)[object]), m_lipschitz(1.0f / m_bounds.distanceScale), m_parallel(parallel)
+{
+}
+
+ImplicitMeshLod ImplicitSceneMesher::Generate(const unsigned int resolution) const
+{
+	const auto start = std::chrono::high_resolution_clock::now();
+
+	const auto grid = MakeGrid(resolution);
+
+	ImplicitMeshLod lod;
+	lod.resolution = resolution;
+	lod.cellSize = grid.cellSize;
+
+	std::vector<float> corners;
+	SampleCorners(grid, corners);
+
+	std::vector<std::int32_t> cellVertices;
+	AddCellVertices(grid, corners, cellVertices, lod);
+	AddQuads(grid, corners, cellVertices, lod);
+
+	lod.generationMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	//Not part of generating it
+	MeasureError(grid, lod);
+
+	return lod;
+}
+
+std::vector<ImplicitMeshLod> ImplicitSceneMesher::GenerateLods(const std::vector<unsigned int>& resolutions) const
+{
+	std::vector<ImplicitMeshLod> lods;
+	lods.reserve(resolutions.size());
+
+	for (const auto resolution : resolutions)
+	{
+		lods.push_back(Generate(resolution));
+	}
+
+	return lods;
+}
+
+int ImplicitSceneMesher::SelectLod(const std::vector<ImplicitMeshLod>& lods, const float distance, const float pixelAngle, const float tolerance)
+{
+	//How wide a pixel is that far away
+	const auto pixelSize = std::max(distance, 0.0f) * pixelAngle;
+
+	for (auto lod = static_cast<int>(lods.size()) - 1; lod >= 0; lod--)
+	{
+		if (lods[lod].GetGeometricError() <= tolerance * pixelSize)
+		{
+			return lod;
+		}
+	}
+
+	return RayMarched;
+}
+
+//A cell of margin on every side of the box, so the surface closes inside the grid
+ImplicitSceneMesher::Grid ImplicitSceneMesher::MakeGrid(const unsigned int resolution) const
+{
+	const auto extent = m_bounds.maximum - m_bounds.minimum;
+	const auto longest = std::max(extent.x, std::max(extent.y, extent.z));
+
+	Grid grid;
+	grid.cellSize = longest / std::max(resolution, 1u);
+	grid.origin = m_bounds.minimum - Vec3<float>(grid.cellSize, grid.cellSize, grid.cellSize);
+	grid.cells[0] = static_cast<unsigned int>(std::ceil(extent.x / grid.cellSize)) + 2;
+	grid.cells[1] = static_cast<unsigned int>(std::ceil(extent.y / grid.cellSize)) + 2;
+	grid.cells[2] = static_cast<unsigned int>(std::ceil(extent.z / grid.cellSize)) + 2;
+
+	//The Mandelbulb's estimate only reaches zero in specks, the dust the marching still stops on where it's below
+	//Epsilon, which no corner lands on. Its surface is taken at a fraction of a cell instead, what the marching sees of
+	//it from where the cells are about a pixel across
+	grid.level = ImplicitSceneSdf::IsObjectLipschitz(m_object) ? 0.0f : dustLevel * grid.cellSize;
+
+	return grid;
+}
+
+void ImplicitSceneMesher::SampleCorners(const Grid& grid, std::vector<float>& corners) const
+{
+	const unsigned int size[3] = { grid.cells[0] + 1, grid.cells[1] + 1, grid.cells[2] + 1 };
+	const unsigned int blocks[3] = { (size[0] + BlockSize - 1) / BlockSize, (size[1] + BlockSize - 1) / BlockSize, (size[2] + BlockSize - 1) / BlockSize };
+
+	corners.resize(static_cast<size_t>(size[0]) * size[1] * size[2]);
+
+	const auto usePackets = IsFloat8Supported();
+
+	//Each block samples its own corners, and the cells along its far sides share them with the next block
+	ForEach(static_cast<size_t>(blocks[0]) * blocks[1] * blocks[2], m_parallel, [&](const size_t block)
+	{
+		const auto blockX = static_cast<unsigned int>(block % blocks[0]);
+		const auto blockY = static_cast<unsigned int>(block / blocks[0] % blocks[1]);
+		const auto blockZ = static_cast<unsigned int>(block / (static_cast<size_t>(blocks[0]) * blocks[1]));
+
+		const unsigned int begin[3] = { blockX * BlockSize, blockY * BlockSize, blockZ * BlockSize };
+		const unsigned int end[3] = { std::min(begin[0] + BlockSize, size[0]), std::min(begin[1] + BlockSize, size[1]), std::min(begin[2] + BlockSize, size[2]) };
+
+		//The surface can't reach within a cell of the block's corners when the distance at its centre is more than the
+		//object's distance can change from there, so none of the cells touching them can have a crossing
+		const auto lowCorner = grid.GetCorner(begin[0], begin[1], begin[2]);
+		const auto highCorner = grid.GetCorner(end[0] - 1, end[1] - 1, end[2] - 1);
+		const auto centre = (lowCorner + highCorner) * 0.5f;
+		const auto margin = Vec3<float>(grid.cellSize, grid.cellSize, grid.cellSize);
+		const auto halfDiagonal = Length((highCorner - lowCorner) * 0.5f + margin);
+		const auto centreDistance = ImplicitSceneSdf::EvaluateObject(m_parameters, m_object, centre).distance - grid.level;
+
+		if (std::abs(centreDistance) > m_lipschitz * halfDiagonal)
+		{
+			for (auto z = begin[2]; z < end[2]; z++)
+			{
+				for (auto y = begin[1]; y < end[1]; y++)
+				{
+					std::fill(corners.begin() + grid.GetCornerIndex(begin[0], y, z), corners.begin() + grid.GetCornerIndex(end[0], y, z), centreDistance);
+				}
+			}
+
+			return;
+		}
+
+		//A row of the block is one Float8, the last block along x repeats its last corner
+		float rowX[BlockSize];
+
+		for (auto i = 0u; i < BlockSize; i++)
+		{
+			rowX[i] = grid.GetCorner(std::min(begin[0] + i, end[0] - 1), 0, 0).x;
+		}
+
+		const auto rowLength = end[0] - begin[0];
+
+		for (auto z = begin[2]; z < end[2]; z++)
+		{
+			for (auto y = begin[1]; y < end[1]; y++)
+			{
+				const auto corner = grid.GetCorner(0, y, z);
+				float distances[BlockSize];
+
+				if (usePackets)
+				{
+					const auto p = Vec3<Float8>(Float8::Load(rowX), Float8(corner.y), Float8(corner.z));
+
+					(ImplicitSceneSdf::EvaluateObject(m_parameters, m_object, p).distance - Float8(grid.level)).Store(distances);
+				}
+				else
+				{
+					for (auto i = 0u; i < rowLength; i++)
+					{
+						distances[i] = ImplicitSceneSdf::EvaluateObject(m_parameters, m_object, Vec3<float>(rowX[i], corner.y, corner.z)).distance - grid.level;
+					}
+				}
+
+				std::copy(distances, distances + rowLength, corners.begin() + grid.GetCornerIndex(begin[0], y, z));
+			}
+		}
+	});
+}
+
+void ImplicitSceneMesher::AddCellVertices(const Grid& grid, const std::vector<float>& corners, std::vector<std::int32_t>& cellVertices, ImplicitMeshLod& lod) const
+{
+	cellVertices.assign(static_cast<size_t>(grid.cells[0]) * grid.cells[1] * grid.cells[2], -1);
+
+	//Each slice of cells finds its vertices on its own, numbered from zero, and they're joined up afterwards
+	std::vector<std::vector<VertexPositionTexcoordNormalTangentBinormal>> slices(grid.cells[2]);
+
+	ForEach(grid.cells[2], m_parallel, [&](const size_t slice)
+	{
+		const auto z = static_cast<unsigned int>(slice);
+		auto& vertices = slices[slice];
+
+		for (auto y = 0u; y < grid.cells[1]; y++)
+		{
+			for (auto x = 0u; x < grid.cells[0]; x++)
+			{
+				auto inside = 0u;
+
+				for (auto corner = 0u; corner < 8; corner++)
+				{
+					inside += corners[grid.GetCornerIndex(x + (corner & 1), y + ((corner >> 1) & 1), z + (corner >> 2))] < 0.0f ? 1 : 0;
+				}
+
+				if (inside == 0 || inside == 8)
+				{
+					continue;
+				}
+
+				cellVertices[grid.GetCellIndex(x, y, z)] = static_cast<std::int32_t>(vertices.size());
+				vertices.push_back(MakeCellVertex(grid, corners, x, y, z));
+			}
+		}
+	});
+
+	std::vector<std::int32_t> offsets(grid.cells[2]);
+	auto vertexCount = 0u;
+
+	for (auto slice = 0u; slice < grid.cells[2]; slice++)
+	{
+		offsets[slice] = static_cast<std::int32_t>(vertexCount);
+		vertexCount += static_cast<unsigned int>(slices[slice].size());
+	}
+
+	const auto sliceCells = static_cast<size_t>(grid.cells[0]) * grid.cells[1];
+
+	ForEach(grid.cells[2], m_parallel, [&](const size_t slice)
+	{
+		for (auto cell = slice * sliceCells; cell < (slice + 1) * sliceCells; cell++)
+		{
+			if (cellVertices[cell] >= 0)
+			{
+				cellVertices[cell] += offsets[slice];
+			}
+		}
+	});
+
+	lod.vertices.reserve(vertexCount);
+
+	for (const auto& vertices : slices)
+	{
+		lod.vertices.insert(lod.vertices.end(), vertices.begin(), vertices.end());
+	}
+}
+
+void ImplicitSceneMesher::AddQuads(const Grid& grid, const std::vector<float>& corners, const std::vector<std::int32_t>& cellVertices, ImplicitMeshLod& lod) const
+{
+	std::vector<std::vector<unsigned long>> slices(grid.cells[2] + 1);
+
+	ForEach(grid.cells[2] + 1, m_parallel, [&](const size_t slice)
+	{
+		const auto z = static_cast<unsigned int>(slice);
+		auto& indices = slices[slice];
+
+		//The cells around the edge, anticlockwise seen from where the axis points
+		const auto addQuad = [&](const std::int32_t (&cells)[4], const bool flip)
+		{
+			const auto* const vertices = lod.vertices.data();
+			const auto first = FromFloat3(vertices[cells[0]].position) - FromFloat3(vertices[cells[2]].position);
+			const auto second = FromFloat3(vertices[cells[1]].position) - FromFloat3(vertices[cells[3]].position);
+
+			//Split along the shorter diagonal
+			const unsigned int splits[2][6] = { { 0, 1, 2, 0, 2, 3 }, { 0, 1, 3, 1, 2, 3 } };
+			const auto& split = splits[Dot(first, first) <= Dot(second, second) ? 0 : 1];
+
+			for (auto triangle = 0u; triangle < 2; triangle++)
+			{
+				const auto* const order = split + triangle * 3;
+
+				indices.push_back(static_cast<unsigned long>(cells[order[0]]));
+				indices.push_back(static_cast<unsigned long>(cells[flip ? order[2] : order[1]]));
+				indices.push_back(static_cast<unsigned long>(cells[flip ? order[1] : order[2]]));
+			}
+		};
+
+		for (auto y = 0u; y <= grid.cells[1]; y++)
+		{
+			for (auto x = 0u; x <= grid.cells[0]; x++)
+			{
+				const auto inside = corners[grid.GetCornerIndex(x, y, z)] < 0.0f;
+
+				//Inside at the low end means the surface faces along the axis
+				if (x < grid.cells[0] && y > 0 && y < grid.cells[1] && z > 0 && z < grid.cells[2] && inside != (corners[grid.GetCornerIndex(x + 1, y, z)] < 0.0f))
+				{
+					const std::int32_t cells[4] = { cellVertices[grid.GetCellIndex(x, y - 1, z - 1)], cellVertices[grid.GetCellIndex(x, y, z - 1)], cellVertices[grid.GetCellIndex(x, y, z)], cellVertices[grid.GetCellIndex(x, y - 1, z)] };
+					addQuad(cells, !inside);
+				}
+
+				if (y < grid.cells[1] && x > 0 && x < grid.cells[0] && z > 0 && z < grid.cells[2] && inside != (corners[grid.GetCornerIndex(x, y + 1, z)] < 0.0f))
+				{
+					const std::int32_t cells[4] = { cellVertices[grid.GetCellIndex(x - 1, y, z - 1)], cellVertices[grid.GetCellIndex(x - 1, y, z)], cellVertices[grid.GetCellIndex(x, y, z)], cellVertices[grid.GetCellIndex(x, y, z - 1)] };
+					addQuad(cells, !inside);
+				}
+
+				if (z < grid.cells[2] && x > 0 && x < grid.cells[0] && y > 0 && y < grid.cells[1] && inside != (corners[grid.GetCornerIndex(x, y, z + 1)] < 0.0f))
+				{
+					const std::int32_t cells[4] = { cellVertices[grid.GetCellIndex(x - 1, y - 1, z)], cellVertices[grid.GetCellIndex(x, y - 1, z)], cellVertices[grid.GetCellIndex(x, y, z)], cellVertices[grid.GetCellIndex(x - 1, y, z)] };
+					addQuad(cells, !inside);
+				}
+			}
+		}
+	});
+
+	auto indexCount = size_t(0);
+
+	for (const auto& indices : slices)
+	{
+		indexCount += indices.size();
+	}
+
+	lod.indices.reserve(indexCount);
+
+	for (const auto& indices : slices)
+	{
+		lod.indices.insert(lod.indices.end(), indices.begin(), indices.end());
+	}
+}
+
+void ImplicitSceneMesher::MeasureError(const Grid& grid, ImplicitMeshLod& lod) const
+{
+	const auto triangleCount = lod.indices.size() / 3;
+	const auto chunkCount = (triangleCount + errorChunkSize - 1) / errorChunkSize;
+
+	//The estimates that aren't Lipschitz say little about how deep a point is inside, the Mandelbulb's grows with how the
+	//orbit goes rather than the depth, so for them only the points outside count
+	const auto insideCounts = ImplicitSceneSdf::IsObjectLipschitz(m_object);
+	const auto pointError = [this, &grid, insideCounts](const Vec3<float>& p)
+	{
+		const auto distance = ImplicitSceneSdf::EvaluateObject(m_parameters, m_object, p).distance - grid.level;
+		return insideCounts ? std::abs(distance) : std::max(distance, 0.0f);
+	};
+
+	std::vector<float> chunkErrors(chunkCount, 0.0f);
+
+	ForEach(chunkCount, m_parallel, [&](const size_t chunk)
+	{
+		auto error = 0.0f;
+
+		for (auto triangle = chunk * errorChunkSize; triangle < std::min((chunk + 1) * errorChunkSize, triangleCount); triangle++)
+		{
+			const auto a = FromFloat3(lod.vertices[lod.indices[triangle * 3]].position);
+			const auto b = FromFloat3(lod.vertices[lod.indices[triangle * 3 + 1]].position);
+			const auto c = FromFloat3(lod.vertices[lod.indices[triangle * 3 + 2]].position);
+
+			//The first corner here, the others come up in their own triangles
+			error = std::max(error, pointError(a));
+			error = std::max(error, pointError((a + b + c) * (1.0f / 3.0f)));
+		}
+
+		chunkErrors[chunk] = error;
+	});
+
+	lod.maxError = chunkErrors.empty() ? 0.0f : *std::max_element(chunkErrors.begin(), chunkErrors.end());
+}
+
+//Regula falsi, the crossing between the distances as if they were linear, then twice more between that and whichever
+//end it has the other sign to. The fractals' distances are far from linear across a cell
+Vec3<float> ImplicitSceneMesher::FindCrossing(const Grid& grid, const Vec3<float>& a, const Vec3<float>& b, const float distanceA, const float distanceB) const
+{
+	auto low = a;
+	auto high = b;
+	auto lowDistance = distanceA;
+	auto highDistance = distanceB;
+
+	for (auto i = 0; i < 2; i++)
+	{
+		const auto crossing = Lerp(low, high, lowDistance / (lowDistance - highDistance));
+		const auto distance = ImplicitSceneSdf::EvaluateObject(m_parameters, m_object, crossing).distance - grid.level;
+
+		if ((distance < 0.0f) == (lowDistance < 0.0f))
+		{
+			low = crossing;
+			lowDistance = distance;
+		}
+		else
+		{
+			high = crossing;
+			highDistance = distance;
+		}
+	}
+
+	return Lerp(low, high, lowDistance / (lowDistance - highDistance));
+}
+
+//The Dual gradient, unless the point is exactly on a surface made with Min and Max, like the box's, where every term
+//the gradient could come from is zero and so is it. Central differences step off the surface and find it
+Vec3<float> ImplicitSceneMesher::FindGradient(const Vec3<float>& p) const
+{
+	const auto gradient = ImplicitSceneSdf::EvaluateObject(m_parameters, m_object, DualPoint(p)).distance.gradient;
+
+	if (Dot(gradient, gradient) > 0.0f)
+	{
+		return gradient;
+	}
+
+	const auto evaluate = [this](const Vec3<float>& samplePoint) { return ImplicitSceneSdf::EvaluateObject(m_parameters, m_object, samplePoint); };
+
+	return ImplicitSceneSdf::EstimateNormal(evaluate, p);
+}
+
+VertexPositionTexcoordNormalTangentBinormal ImplicitSceneMesher::MakeCellVertex(const Grid& grid, const std::vector<float>& corners, const unsigned int x, const unsigned int y, const unsigned int z) const
+{
+	Vec3<float> points[12];
+	Vec3<float> normals[12];
+	auto crossings = 0u;
+	auto crossingCount = 0u;
+
+	auto massPoint = Vec3<float>(0.0f, 0.0f, 0.0f);
+	auto averageNormal = Vec3<float>(0.0f, 0.0f, 0.0f);
+
+	for (const auto& edge : cellEdges)
+	{
+		const unsigned int ends[2][3] =
+		{
+			{ x + (edge[0] & 1), y + ((edge[0] >> 1) & 1), z + (edge[0] >> 2) },
+			{ x + (edge[1] & 1), y + ((edge[1] >> 1) & 1), z + (edge[1] >> 2) }
+		};
+
+		const auto distanceA = corners[grid.GetCornerIndex(ends[0][0], ends[0][1], ends[0][2])];
+		const auto distanceB = corners[grid.GetCornerIndex(ends[1][0], ends[1][1], ends[1][2])];
+
+		if ((distanceA < 0.0f) == (distanceB < 0.0f))
+		{
+			continue;
+		}
+
+		const auto point = FindCrossing(grid, grid.GetCorner(ends[0][0], ends[0][1], ends[0][2]), grid.GetCorner(ends[1][0], ends[1][1], ends[1][2]), distanceA, distanceB);
+		const auto gradient = FindGradient(point);
+		const auto gradientLength = Length(gradient);
+
+		massPoint = massPoint + point;
+		crossingCount++;
+
+		if (gradientLength > 0.0f)
+		{
+			points[crossings] = point;
+			normals[crossings] = gradient * (1.0f / gradientLength);
+			averageNormal = averageNormal + normals[crossings];
+			crossings++;
+		}
+	}
+
+	//The cell has a sign change, so it has at least one crossing
+	massPoint = massPoint * (1.0f / crossingCount);
+
+	//Minimise the sum of (n.(v - p))^2 plus massPointWeight |v - massPoint|^2, solved for v - massPoint as the 3x3
+	//normal equations (A^T A + w I) d = A^T b
+	float ata[3][3] = { { massPointWeight, 0.0f, 0.0f }, { 0.0f, massPointWeight, 0.0f }, { 0.0f, 0.0f, massPointWeight } };
+	float atb[3] = { 0.0f, 0.0f, 0.0f };
+
+	for (auto i = 0u; i < crossings; i++)
+	{
+		const float n[3] = { normals[i].x, normals[i].y, normals[i].z };
+		const auto offset = Dot(normals[i], points[i] - massPoint);
+
+		for (auto row = 0; row < 3; row++)
+		{
+			for (auto column = 0; column < 3; column++)
+			{
+				ata[row][column] += n[row] * n[column];
+			}
+
+			atb[row] += n[row] * offset;
+		}
+	}
+
+	const auto cofactor00 = ata[1][1] * ata[2][2] - ata[1][2] * ata[2][1];
+	const auto cofactor01 = ata[1][2] * ata[2][0] - ata[1][0] * ata[2][2];
+	const auto cofactor02 = ata[1][0] * ata[2][1] - ata[1][1] * ata[2][0];
+	const auto determinant = ata[0][0] * cofactor00 + ata[0][1] * cofactor01 + ata[0][2] * cofactor02;
+
+	auto position = massPoint;
+
+	if (std::abs(determinant) > 1e-12f)
+	{
+		const auto inverse = 1.0f / determinant;
+
+		//The adjugate, over the determinant below
+		const float inverseMatrix[3][3] =
+		{
+			{ cofactor00, ata[0][2] * ata[2][1] - ata[0][1] * ata[2][2], ata[0][1] * ata[1][2] - ata[0][2] * ata[1][1] },
+			{ cofactor01, ata[0][0] * ata[2][2] - ata[0][2] * ata[2][0], ata[0][2] * ata[1][0] - ata[0][0] * ata[1][2] },
+			{ cofactor02, ata[0][1] * ata[2][0] - ata[0][0] * ata[2][1], ata[0][0] * ata[1][1] - ata[0][1] * ata[1][0] }
+		};
+
+		const auto solution = Vec3<float>(
+			(inverseMatrix[0][0] * atb[0] + inverseMatrix[0][1] * atb[1] + inverseMatrix[0][2] * atb[2]) * inverse,
+			(inverseMatrix[1][0] * atb[0] + inverseMatrix[1][1] * atb[1] + inverseMatrix[1][2] * atb[2]) * inverse,
+			(inverseMatrix[2][0] * atb[0] + inverseMatrix[2][1] * atb[1] + inverseMatrix[2][2] * atb[2]) * inverse);
+
+		position = massPoint + solution;
+	}
+
+	//Planes that nearly line up can put the vertex far off, which folds the mesh, so it stays within half a cell of its own
+	const auto low = grid.GetCorner(x, y, z) - Vec3<float>(grid.cellSize, grid.cellSize, grid.cellSize) * 0.5f;
+	const auto high = grid.GetCorner(x + 1, y + 1, z + 1) + Vec3<float>(grid.cellSize, grid.cellSize, grid.cellSize) * 0.5f;
+
+	if (!(position.x >= low.x && position.y >= low.y && position.z >= low.z && position.x <= high.x && position.y <= high.y && position.z <= high.z))
+	{
+		position = massPoint;
+	}
+
+	//The normal and colour at the vertex itself, falling back on the crossings' normals
+	const auto colour = ImplicitSceneSdf::EvaluateObject(m_parameters, m_object, position).colour;
+	const auto gradient = FindGradient(position);
+	const auto normal = Length(gradient) > 0.0f ? Normalize(gradient) : (Length(averageNormal) > 0.0f ? Normalize(averageNormal) : Vec3<float>(0.0f, 1.0f, 0.0f));
+
+	VertexPositionTexcoordNormalTangentBinormal vertex;
+	vertex.position = ToFloat3(position);
+	vertex.texcoord = DirectX::XMFLOAT2(0.0f, 0.0f);
+	vertex.normal = ToFloat3(normal);
+	vertex.tangent = ToFloat3(colour);
+	vertex.binormal = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);
+
+	return vertex;
+}
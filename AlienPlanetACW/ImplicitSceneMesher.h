@@ -0,0 +1,93 @@
+#pragma once
+
+#include "ImplicitSceneHierarchy.h"
+#include "..\Content\ShaderStructures.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace AlienPlanetACW
+{
+	//One resolution of an object's mesh. The vertices' tangents hold the object's colour at them, the meshes aren't normal
+	//mapped so they have no use for a tangent frame, and ImplicitMeshVS.hlsl passes it on as the colour
+	struct ImplicitMeshLod
+	{
+		//Cells along the longest side of the object's box
+		unsigned int resolution;
+		float cellSize;
+		std::vector<VertexPositionTexcoordNormalTangentBinormal> vertices;
+		std::vector<unsigned long> indices;
+		//Furthest the object's distance puts a vertex or the centre of a triangle from the surface
+		float maxError;
+		double generationMilliseconds;
+
+		unsigned int GetTriangleCount() const { return static_cast<unsigned int>(indices.size() / 3); }
+		//What the mesh can be out by, the error measured on it or the detail a cell can lose between its corners
+		float GetGeometricError() const { return std::max(maxError, cellSize); }
+	};
+
+	//Dual contouring of one of ImplicitSceneSdf's objects, after Ju et al.'s "Dual Contouring of Hermite Data". The
+	//object's distance is sampled at the corners of a grid over its box, each cell the surface crosses gets one vertex
+	//where the planes through its edges' crossings best meet, which keeps the fractals' and the gallery's sharp edges that
+	//marching cubes would round off, and each edge the surface crosses joins the four cells around it with a quad. Blocks
+	//of the grid the distance shows are away from the surface aren't sampled. Only worth it for the objects with finite
+	//boxes, and only the static ones can be meshed once and kept
+	class ImplicitSceneMesher
+	{
+	public:
+		//From SelectLod when the object is too close for any of its meshes
+		static const int RayMarched = -1;
+
+		ImplicitSceneMesher(const ImplicitSceneParameters& parameters, unsigned int object, bool parallel = true);
+
+		ImplicitMeshLod Generate(unsigned int resolution) const;
+		//Finest first, like the resolutions should be
+		std::vector<ImplicitMeshLod> GenerateLods(const std::vector<unsigned int>& resolutions) const;
+
+		//The coarsest of lods whose geometric error is at most tolerance pixels across from distance away, where a pixel
+		//is pixelAngle radians across, or RayMarched when even the finest is out by more. distance is to the nearest
+		//point of the object's box, so the error is never further away than it
+		static int SelectLod(const std::vector<ImplicitMeshLod>& lods, float distance, float pixelAngle, float tolerance);
+
+		const ImplicitSceneBounds& GetBounds() const { return m_bounds; }
+
+	private:
+		//Cells along each side of a block, which is sampled or skipped as a whole
+		static const unsigned int BlockSize = 8;
+
+		struct Grid
+		{
+			Sdf::Vec3<float> origin;
+			float cellSize;
+			//Cells along each axis, with a corner more
+			unsigned int cells[3];
+			//The distance the surface is taken at, which the corners have taken off
+			float level;
+
+			size_t GetCornerIndex(unsigned int x, unsigned int y, unsigned int z) const { return (static_cast<size_t>(z) * (cells[1] + 1) + y) * (cells[0] + 1) + x; }
+			size_t GetCellIndex(unsigned int x, unsigned int y, unsigned int z) const { return (static_cast<size_t>(z) * cells[1] + y) * cells[0] + x; }
+			Sdf::Vec3<float> GetCorner(unsigned int x, unsigned int y, unsigned int z) const { return origin + Sdf::Vec3<float>(static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)) * cellSize; }
+		};
+
+		Grid MakeGrid(unsigned int resolution) const;
+		void SampleCorners(const Grid& grid, std::vector<float>& corners) const;
+		void AddCellVertices(const Grid& grid, const std::vector<float>& corners, std::vector<std::int32_t>& cellVertices, ImplicitMeshLod& lod) const;
+		void AddQuads(const Grid& grid, const std::vector<float>& corners, const std::vector<std::int32_t>& cellVertices, ImplicitMeshLod& lod) const;
+		void MeasureError(const Grid& grid, ImplicitMeshLod& lod) const;
+
+		//Where the object's surface crosses the edge from a to b, whose distances less grid's level have different signs
+		Sdf::Vec3<float> FindCrossing(const Grid& grid, const Sdf::Vec3<float>& a, const Sdf::Vec3<float>& b, float distanceA, float distanceB) const;
+		//Not normalised, and zero where the object has no gradient
+		Sdf::Vec3<float> FindGradient(const Sdf::Vec3<float>& p) const;
+		//The vertex for a cell the surface crosses, minimising the squared distances to the crossings' tangent planes
+		VertexPositionTexcoordNormalTangentBinormal MakeCellVertex(const Grid& grid, const std::vector<float>& corners, unsigned int x, unsigned int y, unsigned int z) const;
+
+		ImplicitSceneParameters m_parameters;
+		unsigned int m_object;
+		ImplicitSceneBounds m_bounds;
+		//How much faster than one unit per unit the object's distance can change, one over ImplicitSceneBounds::distanceScale
+		float m_lipschitz;
+		bool m_parallel;
+	};
+}
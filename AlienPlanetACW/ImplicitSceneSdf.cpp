@@ -0,0 +1,257 @@
+#include "pch.h"
+#include "ImplicitSceneSdf.h"
+#include "SdfSceneGraph.h"
+
+using namespace AlienPlanetACW;
+using namespace AlienPlanetACW::Sdf;
+
+const float ImplicitSceneSdf::MaxDistance = 50.0f;
+const float ImplicitSceneSdf::Epsilon = 0.0001f;
+
+namespace
+{
+	struct SceneObjectInfo
+	{
+		const char* name;
+		unsigned int cost;
+		//How much faster than one unit per unit the object's distance can change, where that's known to be over one
+		float lipschitz;
+		//False for the estimates whose distance jumps, see IsObjectLipschitz
+		bool lipschitzBounded;
+	};
+
+	const SceneObjectInfo sceneObjects[ImplicitSceneSdf::ObjectCount] =
+	{
+		{ "morphingShapesSDF", 3, 1.0f, true },
+		//The flattened ellipsoid's estimate
+		{ "alienShipSDF", 19, 1.0f, false },
+		{ "alienShipBeamSDF", 12, 1.0f, true },
+		{ "alienSDF", 11, 1.0f, true },
+		{ "waterDripSDF", 8, 1.0f, true },
+		//The fractals' estimates, from the iterations and the escape
+		{ "mandelBulbSDF", 8, 1.0f, false },
+		{ "sierpinskiTetrahedronSDF", 8, 1.0f, false },
+		//Changes with the wobble, see GetObjectLipschitz
+		{ "wobblySphereSDF", 1, 1.0f, true },
+		{ "galleryRoundConeSDF", 1, 1.0f, true },
+		{ "galleryConeSDF", 1, 1.0f, true },
+		{ "galleryCappedConeSDF", 1, 1.0f, true },
+		//Twisting by 60 stretches the torus's outer edge, 0.05 out, by sqrt(1 + 3^2), which the 0.6 only partly makes up for
+		{ "galleryTwistedTorusSDF", 1, 1.9f, true },
+		{ "galleryTorusSDF", 1, 1.0f, true },
+		{ "galleryTorus82SDF", 1, 1.0f, true },
+		{ "galleryBoxSDF", 1, 1.0f, true },
+		{ "galleryRoundBoxSDF", 1, 1.0f, true },
+		//The ellipsoid's estimate
+		{ "galleryEllipsoidSDF", 1, 1.0f, false },
+		{ "galleryTriPrismSDF", 1, 1.0f, true },
+		{ "galleryLineCylinderSDF", 1, 1.0f, true },
+		{ "galleryCylinderSDF", 1, 1.0f, true },
+		{ "galleryCylinder6SDF", 1, 1.0f, true },
+		{ "galleryOctahedronSDF", 1, 1.0f, true },
+		{ "galleryHexPrismSDF", 1, 1.0f, true },
+		{ "galleryUprightRoundConeSDF", 1, 1.0f, true }
+	};
+}
+
+const char* ImplicitSceneSdf::GetObjectName(const unsigned int object)
+{
+	return sceneObjects[object].name;
+}
+
+unsigned int ImplicitSceneSdf::GetObjectCost(const unsigned int object)
+{
+	return sceneObjects[object].cost;
+}
+
+float ImplicitSceneSdf::GetObjectLipschitz(const ImplicitSceneParameters& parameters, const unsigned int object)
+{
+	//The wobbles' gradients are at most 0.04 * 30 and 0.04 * 60, and sin(time) can weight the first one by up to two
+	if (object == 7)
+	{
+		return 1.0f + 1.2f * std::abs(1.0f - parameters.wobble) + 2.4f * std::abs(parameters.wobble);
+	}
+
+	return sceneObjects[object].lipschitz;
+}
+
+bool ImplicitSceneSdf::IsObjectLipschitz(const unsigned int object)
+{
+	return sceneObjects[object].lipschitzBounded;
+}
+
+bool ImplicitSceneSdf::IsObjectOverstepping(const unsigned int object)
+{
+	//The wobbly sphere's bound is at least 1.2 whatever the wobble
+	return object == 7 || sceneObjects[object].lipschitz > 1.0f;
+}
+
+bool ImplicitSceneSdf::IsStaticObject(const unsigned int object)
+{
+	return object == 6 || (object >= 8 && object < ObjectCount);
+}
+
+ImplicitSceneParameters ImplicitSceneParameters::FromTime(const float time)
+{
+	ImplicitSceneParameters parameters;
+
+	parameters.time = time;
+	parameters.morph = std::abs(std::sin(time * 0.7f));
+
+	const auto absSinTime = std::abs(std::sin(time));
+
+	parameters.shipPosition = Sdf::Vec3<float>(Sdf::Lerp(-2.0f, 2.0f, std::sin(time / 2)), Sdf::Lerp(2.0f, 2.15f, absSinTime), 0.0f);
+
+	const auto tPI = 2 * 3.141592f;
+
+	for (auto i = 0; i < 8; i++)
+	{
+		parameters.shipStuds[i][0] = std::sin((tPI / 8) * i);
+		parameters.shipStuds[i][1] = std::cos((tPI / 8) * i);
+	}
+
+	parameters.beamLength = Sdf::Lerp(0.0f, 1.0f, absSinTime);
+	parameters.beamPosition = Sdf::Vec3<float>(parameters.shipPosition.x, parameters.shipPosition.y - (parameters.beamLength / 3) - (parameters.beamLength / 2), parameters.shipPosition.z);
+
+	parameters.alienEyeHeight = Sdf::Lerp(0.02f, 0.045f, absSinTime);
+	parameters.alienMouth = Sdf::Lerp(0.005f, 0.02f, absSinTime);
+	parameters.alienArm = Sdf::Lerp(-0.05f, 0.05f, std::abs(std::cos(time)));
+
+	parameters.dripHeights[0] = Sdf::Lerp(0.0f, 0.6f, std::abs(std::cos(time / 2)));
+	parameters.dripHeights[1] = Sdf::Lerp(0.0f, 0.6f, std::abs(std::cos(time / 4)));
+	parameters.dripHeights[2] = Sdf::Lerp(0.0f, 0.6f, std::abs(std::cos(time / 3)));
+
+	parameters.mandelbulbPower = 3.0f + 4.0f * (std::sin(time / 30.0f) + 1.0f);
+
+	Sdf::MandelbulbRotation(time * 0.2f, parameters.mandelbulbRotation);
+
+	parameters.mandelbulbColour = Sdf::Saturate(Sdf::Vec3<float>(Sdf::Lerp(0.0f, 1.0f, std::sin(time)), Sdf::Lerp(0.0f, 1.0f, -std::sin(time)), Sdf::Lerp(0.0f, 1.0f, std::cos(time))));
+	parameters.mandelbulbIterations = 8;
+	parameters.sierpinskiIterations = 8;
+
+	parameters.wobble = std::sin(time);
+
+	return parameters;
+}
+
+SdfShape ImplicitSceneSdf::BuildSceneGraph(const ImplicitSceneParameters& parameters, SdfSceneGraph& graph)
+{
+	const auto p = graph.GetSamplePoint();
+
+	//Every object in EvaluateObject's order, each one built the way its function is written
+	std::vector<SdfShape> objects;
+	objects.reserve(ObjectCount);
+
+	{
+		const auto infinPos = graph.MirrorRepeatXZ(graph.Translate(p, Vec3<float>(0.0f, 4.0f, 0.0f)), 2.0f);
+		const auto morph = parameters.morph;
+		const auto shape = graph.Lerp(graph.Lerp(graph.Torus(infinPos, Vec2<float>(0.3f, 0.1f)), graph.Box(infinPos, Vec3<float>(0.4f, 0.4f, 0.4f)), morph), graph.Sphere(infinPos, 0.2f), morph);
+
+		objects.push_back(graph.Colour(shape, Vec3<float>(0.4f, 0.8f, 0.8f)));
+	}
+
+	const auto& ship = parameters.shipPosition;
+	const auto shipColour = Vec3<float>(0.29f, 0.5649f, 0.107f);
+
+	{
+		const auto shipPoint = graph.Translate(p, ship);
+
+		auto result = graph.SmoothUnion(graph.Ellipsoid(shipPoint, Vec3<float>(0.3f, 0.07f, 0.3f)), graph.Ellipsoid(graph.Translate(p, Vec3<float>(ship.x, ship.y + 0.08f, ship.z)), Vec3<float>(0.15f, 0.05f, 0.15f)), 0.05f);
+		result = graph.SmoothSubtraction(graph.Torus(shipPoint, Vec2<float>(0.3f, 0.05f)), result, 0.01f);
+
+		for (auto i = 0; i < 8; i++)
+		{
+			const auto x = parameters.shipStuds[i][0];
+			const auto z = parameters.shipStuds[i][1];
+
+			result = graph.SmoothUnion(result, graph.Sphere(graph.Translate(p, Vec3<float>(ship.x - x * 0.21f, ship.y + 0.05f, ship.z - z * 0.21f)), 0.02f), 0.02f);
+			result = graph.SmoothUnion(result, graph.Sphere(graph.Translate(p, Vec3<float>(ship.x - x * 0.21f, ship.y + -0.05f, ship.z - z * 0.21f)), 0.02f), 0.02f);
+		}
+
+		objects.push_back(graph.Colour(result, shipColour));
+	}
+
+	{
+		const auto beamLength = parameters.beamLength;
+
+		auto beamResult = graph.SmoothSubtraction(graph.Sphere(graph.Translate(p, Vec3<float>(ship.x, ship.y + 0.5f, ship.z)), 0.5f), graph.CappedCone(graph.Translate(p, parameters.beamPosition), beamLength, 0.2f, 0.05f), 0.05f);
+
+		for (auto i = 0; i < 10; i++)
+		{
+			const auto torusPos = (beamLength * 2.0f / 10.0f) * i;
+
+			beamResult = graph.SmoothSubtraction(graph.Torus(graph.Translate(p, Vec3<float>(ship.x, ship.y - torusPos, ship.z)), Vec2<float>(0.05f + 0.015f * i, 0.004f * beamLength)), beamResult, 0.05f);
+		}
+
+		objects.push_back(graph.Colour(beamResult, shipColour));
+	}
+
+	{
+		const auto alien = Vec3<float>(0.9f, 0.6f, 0.5f);
+		const auto eyeHeight = parameters.alienEyeHeight;
+		const auto mouth = parameters.alienMouth;
+		const auto arm = parameters.alienArm;
+		const auto at = [&](const float x, const float y, const float z) { return graph.Translate(p, Vec3<float>(alien.x + x, alien.y + y, alien.z + z)); };
+
+		auto resultAlien = graph.SmoothUnion(graph.HexPrism(at(0.0f, 0.01f, 0.0f), Vec2<float>(0.01f, 0.05f)), graph.Sphere(at(-0.007f, 0.01f, 0.0f), 0.035f), 0.01f);
+		resultAlien = graph.SmoothUnion(resultAlien, graph.Sphere(graph.Translate(p, Vec3<float>(alien.x - 0.02f, alien.y + eyeHeight, alien.z - 0.015f)), 0.01f), 0.005f);
+		resultAlien = graph.SmoothUnion(resultAlien, graph.Sphere(graph.Translate(p, Vec3<float>(alien.x - 0.02f, alien.y + eyeHeight, alien.z + 0.015f)), 0.01f), 0.005f);
+		resultAlien = graph.SmoothSubtraction(graph.Ellipsoid(at(-0.025f, -0.006f, 0.0f), Vec3<float>(mouth, mouth, 0.05f)), resultAlien, 0.01f);
+		resultAlien = graph.SmoothUnion(resultAlien, graph.RoundCone(at(0.04f, -0.035f, 0.0f), 0.025f, 0.015f, 0.04f), 0.01f);
+		resultAlien = graph.SmoothUnion(resultAlien, graph.Torus(at(0.04f, -0.04f, 0.0f), Vec2<float>(0.03f, 0.005f)), 0.01f);
+		resultAlien = graph.SmoothUnion(resultAlien, graph.Cylinder(at(0.04f, -0.08f, -0.018f), Vec3<float>(0.0f, 0.04f, 0.0f), Vec3<float>(0.0f, -0.04f, 0.0f), 0.008f), 0.01f);
+		resultAlien = graph.SmoothUnion(resultAlien, graph.Cylinder(at(0.04f, -0.08f, 0.018f), Vec3<float>(0.0f, 0.04f, 0.0f), Vec3<float>(0.0f, -0.04f, 0.0f), 0.008f), 0.01f);
+		resultAlien = graph.SmoothUnion(resultAlien, graph.Cylinder(at(0.04f, -0.005f, -0.05f), Vec3<float>(0.0f, 0.0f, 0.03f), Vec3<float>(0.0f, arm, -0.025f), 0.008f), 0.025f);
+		resultAlien = graph.SmoothUnion(resultAlien, graph.Cylinder(at(0.04f, -0.005f, 0.05f), Vec3<float>(0.0f, 0.0f, -0.03f), Vec3<float>(0.0f, arm, 0.025f), 0.008f), 0.025f);
+
+		objects.push_back(graph.Colour(resultAlien, Vec3<float>(0.987f, 0.28f, 0.45f)));
+	}
+
+	{
+		const auto drip = Vec3<float>(0.9f, 0.6f, 0.9f);
+		const auto* const heights = parameters.dripHeights;
+		const auto dropAt = [&](const float x, const float y) { return graph.Translate(p, Vec3<float>(drip.x + x, y, drip.z)); };
+
+		auto resultDrip = graph.SmoothUnion(graph.RoundBox(dropAt(0.0f, drip.y - 0.2f), Vec3<float>(0.06f, 0.06f, 0.06f), 0.032f), graph.CappedCone(dropAt(0.0f, drip.y + 0.3f), 0.1f, 0.06f, 0.08f), 0.01f);
+		resultDrip = graph.SmoothUnion(resultDrip, graph.Sphere(dropAt(-0.015f, (drip.y - 0.3f) - heights[0]), 0.02f), 0.02f);
+		resultDrip = graph.SmoothUnion(resultDrip, graph.Sphere(dropAt(0.0f, (drip.y - 0.3f) - heights[1]), 0.02f), 0.05f);
+		resultDrip = graph.SmoothUnion(resultDrip, graph.Sphere(dropAt(0.015f, (drip.y - 0.3f) - heights[2]), 0.02f), 0.02f);
+		resultDrip = graph.SmoothUnion(resultDrip, graph.Sphere(dropAt(-0.015f, (drip.y - 0.3f) + heights[0]), 0.02f), 0.02f);
+		resultDrip = graph.SmoothUnion(resultDrip, graph.Sphere(dropAt(0.0f, (drip.y - 0.3f) + heights[1]), 0.02f), 0.05f);
+		resultDrip = graph.SmoothUnion(resultDrip, graph.Sphere(dropAt(0.015f, (drip.y - 0.3f) + heights[2]), 0.02f), 0.02f);
+
+		objects.push_back(graph.Colour(resultDrip, Vec3<float>(0.456f, 0.15f, 0.5564f)));
+	}
+
+	objects.push_back(graph.Mandelbulb(graph.Translate(p, Vec3<float>(-4.0f, 2.0f, -4.0f)), parameters.mandelbulbPower, parameters.time * 0.2f, parameters.mandelbulbColour));
+	objects.push_back(graph.SierpinskiTetrahedron(graph.Scale(graph.Translate(p, Vec3<float>(2.0f, 2.0f, 2.0f)), 2.0f)));
+	objects.push_back(graph.Wobble(graph.Colour(graph.Sphere(graph.Translate(p, Vec3<float>(1.0f, 0.5f, -1.0f)), 0.2f), Vec3<float>(0.75f, 0.37f, 1.0f)), p, parameters.wobble));
+
+	const auto at = [&](const float x, const float y, const float z) { return graph.Translate(p, Vec3<float>(x, y, z)); };
+
+	objects.push_back(graph.Colour(graph.RoundCone(at(0.3f, 0.5f, 0.3f), Vec3<float>(0.02f, 0.0f, 0.0f), Vec3<float>(-0.02f, 0.06f, 0.02f), 0.03f, 0.01f), Vec3<float>(0.18f, 0.22f, 1.0f)));
+	objects.push_back(graph.Colour(graph.Cone(at(0.0f, 0.53f, 0.0f), Vec3<float>(0.16f, 0.12f, 0.06f)), Vec3<float>(0.55f, 0.23f, 0.38f)));
+	objects.push_back(graph.Colour(graph.CappedCone(at(0.3f, 0.5f, 0.0f), 0.03f, 0.04f, 0.02f), Vec3<float>(0.80f, 0.78f, 0.45f)));
+	objects.push_back(graph.Colour(graph.ScaleDistance(graph.Torus(graph.Twist(at(0.0f, 0.5f, 0.3f), 60.0f), Vec2<float>(0.04f, 0.01f)), 0.6f), Vec3<float>(0.28f, 0.51f, 0.08f)));
+	objects.push_back(graph.Colour(graph.Torus(at(-0.3f, 0.5f, -0.3f), Vec2<float>(0.04f, 0.01f)), Vec3<float>(0.41f, 0.27f, 0.54f)));
+	objects.push_back(graph.Colour(graph.Torus82(at(0.0f, 0.5f, -0.3f), Vec2<float>(0.04f, 0.01f)), Vec3<float>(0.52f, 0.75f, 0.42f)));
+	objects.push_back(graph.Colour(graph.Box(at(-0.3f, 0.5f, 0.0f), Vec3<float>(0.05f, 0.05f, 0.05f)), Vec3<float>(0.31f, 0.47f, 0.63f)));
+	objects.push_back(graph.Colour(graph.RoundBox(at(-0.3f, 0.5f, 0.3f), Vec3<float>(0.04f, 0.04f, 0.04f), 0.016f), Vec3<float>(1.0f, 0.27f, 0.0f)));
+	objects.push_back(graph.Colour(graph.Ellipsoid(at(0.3f, 0.5f, -0.3f), Vec3<float>(0.05f, 0.05f, 0.02f)), Vec3<float>(0.8f, 0.41f, 0.79f)));
+	objects.push_back(graph.Colour(graph.TriPrism(at(-0.6f, 0.5f, -0.3f), Vec2<float>(0.05f, 0.02f)), Vec3<float>(0.92f, 0.68f, 0.92f)));
+	objects.push_back(graph.Colour(graph.Cylinder(at(-0.6f, 0.5f, 0.0f), Vec3<float>(0.002f, -0.002f, 0.0f), Vec3<float>(-0.02f, 0.06f, 0.02f), 0.016f), Vec3<float>(0.78f, 0.38f, 0.08f)));
+	objects.push_back(graph.Colour(graph.Cylinder(at(-0.6f, 0.5f, 0.3f), Vec2<float>(0.02f, 0.04f)), Vec3<float>(0.98f, 0.63f, 0.42f)));
+	objects.push_back(graph.Colour(graph.Cylinder6(at(0.3f, 0.5f, 0.6f), Vec2<float>(0.02f, 0.04f)), Vec3<float>(0.29f, 0.46f, 0.43f)));
+	objects.push_back(graph.Colour(graph.Octahedron(at(0.0f, 0.5f, 0.6f), 0.07f), Vec3<float>(0.46f, 0.61f, 0.52f)));
+	objects.push_back(graph.Colour(graph.HexPrism(at(-0.3f, 0.5f, 0.6f), Vec2<float>(0.05f, 0.01f)), Vec3<float>(0.59f, 1.0f, 1.0f)));
+	objects.push_back(graph.Colour(graph.RoundCone(at(-0.6f, 0.5f, 0.6f), 0.04f, 0.02f, 0.06f), Vec3<float>(1.0f, 0.2f, 0.0f)));
+
+	auto scene = objects[0];
+
+	for (auto object = 1u; object < objects.size(); object++)
+	{
+		scene = graph.Union(scene, objects[object]);
+	}
+
+	return scene;
+}
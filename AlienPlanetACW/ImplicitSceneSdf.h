@@ -0,0 +1,384 @@
+#pragma once
+
+#include "SdfDual.h"
+#include "SdfPrimitives.h"
+
+namespace AlienPlanetACW
+{
+	class SdfSceneGraph;
+	struct SdfShape;
+
+	//Everything in sceneSDF that only depends on time, worked out once per frame instead of once per sample. ImplicitRayModels
+	//uploads it as ImplicitRayModelsPS.hlsl's timeConstantBuffer
+	struct ImplicitSceneParameters
+	{
+		float time;
+
+		//Infinite shapes, abs(sin(time * 0.7))
+		float morph;
+
+		Sdf::Vec3<float> shipPosition;
+		//sin and cos of the angle of each of the eight studs around the ship
+		float shipStuds[8][2];
+		//beamScale.x, the rest of the beam's scale is constant
+		float beamLength;
+		Sdf::Vec3<float> beamPosition;
+
+		float alienEyeHeight;
+		float alienMouth;
+		float alienArm;
+
+		float dripHeights[3];
+
+		float mandelbulbPower;
+		//The three rotations multiplied together, rows like the HLSL float3x3
+		float mandelbulbRotation[3][3];
+		Sdf::Vec3<float> mandelbulbColour;
+
+		//Iterations of the fractals, 8 in the shader. Fewer make them blobbier and cheaper
+		unsigned int mandelbulbIterations;
+		unsigned int sierpinskiIterations;
+
+		//Blend between the two wobbles, sin(time)
+		float wobble;
+
+		static ImplicitSceneParameters FromTime(float time);
+	};
+
+	//CPU port of sceneSDF, PhongIllumination and the fog from ImplicitRayModelsPS.hlsl, for float or Float8 samples.
+	//sceneSDF is split into the objects it unions, in the same order, so they can also be evaluated one at a time
+	class ImplicitSceneSdf
+	{
+	public:
+		static const int MaxMarchingSteps = 255;
+		static const float MaxDistance;
+		static const float Epsilon;
+
+		static const unsigned int ObjectCount = 24;
+
+		//The object's function in ImplicitRayModelsPS.hlsl
+		static const char* GetObjectName(unsigned int object);
+		//Primitive SDFs, or fractal iterations, one evaluation of the object costs
+		static unsigned int GetObjectCost(unsigned int object);
+		//Bound on how fast the object's distance changes, over one for the deformations that stretch space like the
+		//twisted torus and the wobbly sphere. Dividing by it gives a distance that's safe to step
+		static float GetObjectLipschitz(const ImplicitSceneParameters& parameters, unsigned int object);
+		//False for the distance estimates that can change many times faster than GetObjectLipschitz between two nearby
+		//points, the ship's flattened ellipsoid, the gallery's ellipsoid and the fractals. They still never overshoot a
+		//surface, which is all marching needs, but their distance at one point says little about the points around it
+		static bool IsObjectLipschitz(unsigned int object);
+		//True for the objects GetObjectLipschitz is over one for at any time, whose distances can step past a surface
+		static bool IsObjectOverstepping(unsigned int object);
+		//The Sierpinski tetrahedron and the gallery. The ship's hull swings around with the ship, and everything else
+		//animates
+		static bool IsStaticObject(unsigned int object);
+
+		template <typename T>
+		static Sdf::Sample<T> Evaluate(const ImplicitSceneParameters& parameters, const Sdf::Vec3<T>& samplePoint);
+
+		//The same scene as data, with this frame's parameters baked into the constants, for SdfSceneGraph::Compile
+		static SdfShape BuildSceneGraph(const ImplicitSceneParameters& parameters, SdfSceneGraph& graph);
+
+		//coneWidth is how wide the sample's pixel is where it is. The fractals stop iterating and the wobbly sphere's wobbles
+		//fade out where their detail would be narrower, and 0 keeps all of it like the shader
+		template <typename T>
+		static Sdf::Sample<T> EvaluateObject(const ImplicitSceneParameters& parameters, unsigned int object, const Sdf::Vec3<T>& samplePoint, const T& coneWidth = T(0.0f));
+
+		//evaluate(p) gives the scene's Sample at p, so the normal can come from the flat scene or the hierarchy
+		template <typename T, typename Evaluator>
+		static Sdf::Vec3<T> EstimateNormal(const Evaluator& evaluate, const Sdf::Vec3<T>& p);
+		//Four samples at the corners of a tetrahedron around p instead of six, for scenes that can't be evaluated with
+		//Sdf::Dual
+		template <typename T, typename Evaluator>
+		static Sdf::Vec3<T> EstimateNormalTetrahedron(const Evaluator& evaluate, const Sdf::Vec3<T>& p);
+		//The exact gradient in one evaluation, evaluate has to take Sdf::Dual points as well
+		template <typename T, typename Evaluator>
+		static Sdf::Vec3<T> GradientNormal(const Evaluator& evaluate, const Sdf::Vec3<T>& p);
+
+		template <typename T>
+		static Sdf::Vec3<T> Shade(const Sdf::Vec3<T>& surfacePoint, const Sdf::Vec3<T>& normal, const Sdf::Vec3<T>& rayDirection, const Sdf::Vec3<T>& colour, const T& depth);
+
+	private:
+		template <typename T>
+		static Sdf::Sample<T> MorphingShapes(const ImplicitSceneParameters& parameters, const Sdf::Vec3<T>& p);
+
+		template <typename T>
+		static Sdf::Sample<T> AlienShip(const ImplicitSceneParameters& parameters, const Sdf::Vec3<T>& p);
+
+		template <typename T>
+		static Sdf::Sample<T> AlienShipBeam(const ImplicitSceneParameters& parameters, const Sdf::Vec3<T>& p);
+
+		template <typename T>
+		static Sdf::Sample<T> Alien(const ImplicitSceneParameters& parameters, const Sdf::Vec3<T>& p);
+
+		template <typename T>
+		static Sdf::Sample<T> WaterDrip(const ImplicitSceneParameters& parameters, const Sdf::Vec3<T>& p);
+
+		template <typename T>
+		static Sdf::Sample<T> WobblySphere(const ImplicitSceneParameters& parameters, const Sdf::Vec3<T>& p, const T& coneWidth);
+
+		template <typename T>
+		static Sdf::Sample<T> GalleryPrimitive(unsigned int primitive, const Sdf::Vec3<T>& p);
+	};
+
+	//Sphere to cube to torus, repeated across xz
+	template <typename T>
+	Sdf::Sample<T> ImplicitSceneSdf::MorphingShapes(const ImplicitSceneParameters& parameters, const Sdf::Vec3<T>& p)
+	{
+		using namespace Sdf;
+
+		auto infinPos = Vec3<T>(Abs(p.x), p.y - 4.0f, Abs(p.z));
+		infinPos.x = Fmod(infinPos.x * 0.5f + 0.5f, 1.0f) - 0.5f;
+		infinPos.z = Fmod(infinPos.z * 0.5f + 0.5f, 1.0f) - 0.5f;
+
+		const auto morph = parameters.morph;
+		const auto distance = Lerp(Lerp(TorusSdf(infinPos, Vec2<float>(0.3f, 0.1f)), BoxSdf(infinPos, Vec3<float>(0.4f, 0.4f, 0.4f)), morph), SphereSdf(infinPos, 0.2f), morph);
+
+		return Sample<T>(distance, Vec3<T>(Vec3<float>(0.4f, 0.8f, 0.8f)));
+	}
+
+	template <typename T>
+	Sdf::Sample<T> ImplicitSceneSdf::AlienShip(const ImplicitSceneParameters& parameters, const Sdf::Vec3<T>& p)
+	{
+		using namespace Sdf;
+
+		const auto& ship = parameters.shipPosition;
+		const auto shipPoint = Translate(p, ship.x, ship.y, ship.z);
+
+		auto result = SmoothUnion(EllipsoidSdf(shipPoint, Vec3<float>(0.3f, 0.07f, 0.3f)), EllipsoidSdf(Translate(p, ship.x, ship.y + 0.08f, ship.z), Vec3<float>(0.15f, 0.05f, 0.15f)), 0.05f);
+		result = SmoothSubtraction(TorusSdf(shipPoint, Vec2<float>(0.3f, 0.05f)), result, 0.01f);
+
+		for (auto i = 0; i < 8; i++)
+		{
+			const auto x = parameters.shipStuds[i][0];
+			const auto z = parameters.shipStuds[i][1];
+
+			result = SmoothUnion(result, SphereSdf(Translate(p, ship.x - x * 0.21f, ship.y + 0.05f, ship.z - z * 0.21f), 0.02f), 0.02f);
+			result = SmoothUnion(result, SphereSdf(Translate(p, ship.x - x * 0.21f, ship.y + -0.05f, ship.z - z * 0.21f), 0.02f), 0.02f);
+		}
+
+		return Sample<T>(result, Vec3<T>(Vec3<float>(0.29f, 0.5649f, 0.107f)));
+	}
+
+	//The shader unions the beam into the ship before adding the colour, so as its own object it has the same colour
+	template <typename T>
+	Sdf::Sample<T> ImplicitSceneSdf::AlienShipBeam(const ImplicitSceneParameters& parameters, const Sdf::Vec3<T>& p)
+	{
+		using namespace Sdf;
+
+		const auto& ship = parameters.shipPosition;
+		const auto beamLength = parameters.beamLength;
+		const auto& beam = parameters.beamPosition;
+
+		auto beamResult = SmoothSubtraction(SphereSdf(Translate(p, ship.x, ship.y + 0.5f, ship.z), 0.5f), CappedConeSdf(Translate(p, beam.x, beam.y, beam.z), beamLength, 0.2f, 0.05f), 0.05f);
+
+		for (auto i = 0; i < 10; i++)
+		{
+			const auto torusPos = (beamLength * 2.0f / 10.0f) * i;
+
+			beamResult = SmoothSubtraction(TorusSdf(Translate(p, ship.x, ship.y - torusPos, ship.z), Vec2<float>(0.05f + 0.015f * i, 0.004f * beamLength)), beamResult, 0.05f);
+		}
+
+		return Sample<T>(beamResult, Vec3<T>(Vec3<float>(0.29f, 0.5649f, 0.107f)));
+	}
+
+	template <typename T>
+	Sdf::Sample<T> ImplicitSceneSdf::Alien(const ImplicitSceneParameters& parameters, const Sdf::Vec3<T>& p)
+	{
+		using namespace Sdf;
+
+		const auto alien = Vec3<float>(0.9f, 0.6f, 0.5f);
+		const auto eyeHeight = parameters.alienEyeHeight;
+		const auto mouth = parameters.alienMouth;
+		const auto arm = parameters.alienArm;
+
+		auto resultAlien = SmoothUnion(HexPrismSdf(Translate(p, alien.x, alien.y + 0.01f, alien.z), Vec2<float>(0.01f, 0.05f)), SphereSdf(Translate(p, alien.x - 0.007f, alien.y + 0.01f, alien.z), 0.035f), 0.01f);
+		resultAlien = SmoothUnion(resultAlien, SphereSdf(Translate(p, alien.x - 0.02f, alien.y + eyeHeight, alien.z - 0.015f), 0.01f), 0.005f);
+		resultAlien = SmoothUnion(resultAlien, SphereSdf(Translate(p, alien.x - 0.02f, alien.y + eyeHeight, alien.z + 0.015f), 0.01f), 0.005f);
+		resultAlien = SmoothSubtraction(EllipsoidSdf(Translate(p, alien.x - 0.025f, alien.y - 0.006f, alien.z), Vec3<float>(mouth, mouth, 0.05f)), resultAlien, 0.01f);
+		resultAlien = SmoothUnion(resultAlien, RoundConeSdf(Translate(p, alien.x + 0.04f, alien.y - 0.035f, alien.z), 0.025f, 0.015f, 0.04f), 0.01f);
+		resultAlien = SmoothUnion(resultAlien, TorusSdf(Translate(p, alien.x + 0.04f, alien.y - 0.04f, alien.z), Vec2<float>(0.03f, 0.005f)), 0.01f);
+		resultAlien = SmoothUnion(resultAlien, CylinderSdf(Translate(p, alien.x + 0.04f, alien.y - 0.08f, alien.z - 0.018f), Vec3<float>(0.0f, 0.04f, 0.0f), Vec3<float>(0.0f, -0.04f, 0.0f), 0.008f), 0.01f);
+		resultAlien = SmoothUnion(resultAlien, CylinderSdf(Translate(p, alien.x + 0.04f, alien.y - 0.08f, alien.z + 0.018f), Vec3<float>(0.0f, 0.04f, 0.0f), Vec3<float>(0.0f, -0.04f, 0.0f), 0.008f), 0.01f);
+		resultAlien = SmoothUnion(resultAlien, CylinderSdf(Translate(p, alien.x + 0.04f, alien.y - 0.005f, alien.z - 0.05f), Vec3<float>(0.0f, 0.0f, 0.03f), Vec3<float>(0.0f, arm, -0.025f), 0.008f), 0.025f);
+		resultAlien = SmoothUnion(resultAlien, CylinderSdf(Translate(p, alien.x + 0.04f, alien.y - 0.005f, alien.z + 0.05f), Vec3<float>(0.0f, 0.0f, -0.03f), Vec3<float>(0.0f, arm, 0.025f), 0.008f), 0.025f);
+
+		return Sample<T>(resultAlien, Vec3<T>(Vec3<float>(0.987f, 0.28f, 0.45f)));
+	}
+
+	template <typename T>
+	Sdf::Sample<T> ImplicitSceneSdf::WaterDrip(const ImplicitSceneParameters& parameters, const Sdf::Vec3<T>& p)
+	{
+		using namespace Sdf;
+
+		const auto drip = Vec3<float>(0.9f, 0.6f, 0.9f);
+		const auto* const heights = parameters.dripHeights;
+
+		auto resultDrip = SmoothUnion(RoundBoxSdf(Translate(p, drip.x, drip.y - 0.2f, drip.z), Vec3<float>(0.06f, 0.06f, 0.06f), 0.032f), CappedConeSdf(Translate(p, drip.x, drip.y + 0.3f, drip.z), 0.1f, 0.06f, 0.08f), 0.01f);
+		resultDrip = SmoothUnion(resultDrip, SphereSdf(Translate(p, drip.x - 0.015f, (drip.y - 0.3f) - heights[0], drip.z), 0.02f), 0.02f);
+		resultDrip = SmoothUnion(resultDrip, SphereSdf(Translate(p, drip.x, (drip.y - 0.3f) - heights[1], drip.z), 0.02f), 0.05f);
+		resultDrip = SmoothUnion(resultDrip, SphereSdf(Translate(p, drip.x + 0.015f, (drip.y - 0.3f) - heights[2], drip.z), 0.02f), 0.02f);
+		resultDrip = SmoothUnion(resultDrip, SphereSdf(Translate(p, drip.x - 0.015f, (drip.y - 0.3f) + heights[0], drip.z), 0.02f), 0.02f);
+		resultDrip = SmoothUnion(resultDrip, SphereSdf(Translate(p, drip.x, (drip.y - 0.3f) + heights[1], drip.z), 0.02f), 0.05f);
+		resultDrip = SmoothUnion(resultDrip, SphereSdf(Translate(p, drip.x + 0.015f, (drip.y - 0.3f) + heights[2], drip.z), 0.02f), 0.02f);
+
+		return Sample<T>(resultDrip, Vec3<T>(Vec3<float>(0.456f, 0.15f, 0.5564f)));
+	}
+
+	template <typename T>
+	Sdf::Sample<T> ImplicitSceneSdf::WobblySphere(const ImplicitSceneParameters& parameters, const Sdf::Vec3<T>& p, const T& coneWidth)
+	{
+		using namespace Sdf;
+
+		//Wavelengths of 2 pi / 30 and 2 pi / 60
+		const auto wobble30 = T(0.04f) * DetailFade(coneWidth, 0.20944f) * Sin(p.x * 30.0f) * Sin(p.y * 30.0f) * Sin(p.z * 30.0f);
+		const auto wobble60 = T(0.04f) * DetailFade(coneWidth, 0.10472f) * Sin(p.x * 60.0f) * Sin(p.y * 60.0f) * Sin(p.z * 60.0f);
+
+		return Sample<T>(SphereSdf(Translate(p, 1.0f, 0.5f, -1.0f), 0.2f) + Lerp(wobble30, wobble60, parameters.wobble), Vec3<T>(Vec3<float>(0.75f, 0.37f, 1.0f)));
+	}
+
+	template <typename T>
+	Sdf::Sample<T> ImplicitSceneSdf::GalleryPrimitive(const unsigned int primitive, const Sdf::Vec3<T>& p)
+	{
+		using namespace Sdf;
+
+		switch (primitive)
+		{
+		case 0:
+			return Sample<T>(RoundConeSdf(Translate(p, 0.3f, 0.5f, 0.3f), Vec3<float>(0.02f, 0.0f, 0.0f), Vec3<float>(-0.02f, 0.06f, 0.02f), 0.03f, 0.01f), Vec3<T>(Vec3<float>(0.18f, 0.22f, 1.0f)));
+		case 1:
+			return Sample<T>(ConeSdf(Translate(p, 0.0f, 0.53f, 0.0f), Vec3<float>(0.16f, 0.12f, 0.06f)), Vec3<T>(Vec3<float>(0.55f, 0.23f, 0.38f)));
+		case 2:
+			return Sample<T>(CappedConeSdf(Translate(p, 0.3f, 0.5f, 0.0f), 0.03f, 0.04f, 0.02f), Vec3<T>(Vec3<float>(0.80f, 0.78f, 0.45f)));
+		case 3:
+			return Sample<T>(T(0.6f) * TorusSdf(TwistSdf(Translate(p, 0.0f, 0.5f, 0.3f), 60.0f), Vec2<float>(0.04f, 0.01f)), Vec3<T>(Vec3<float>(0.28f, 0.51f, 0.08f)));
+		case 4:
+			return Sample<T>(TorusSdf(Translate(p, -0.3f, 0.5f, -0.3f), Vec2<float>(0.04f, 0.01f)), Vec3<T>(Vec3<float>(0.41f, 0.27f, 0.54f)));
+		case 5:
+			return Sample<T>(Torus82Sdf(Translate(p, 0.0f, 0.5f, -0.3f), Vec2<float>(0.04f, 0.01f)), Vec3<T>(Vec3<float>(0.52f, 0.75f, 0.42f)));
+		case 6:
+			return Sample<T>(BoxSdf(Translate(p, -0.3f, 0.5f, 0.0f), Vec3<float>(0.05f, 0.05f, 0.05f)), Vec3<T>(Vec3<float>(0.31f, 0.47f, 0.63f)));
+		case 7:
+			return Sample<T>(RoundBoxSdf(Translate(p, -0.3f, 0.5f, 0.3f), Vec3<float>(0.04f, 0.04f, 0.04f), 0.016f), Vec3<T>(Vec3<float>(1.0f, 0.27f, 0.0f)));
+		case 8:
+			return Sample<T>(EllipsoidSdf(Translate(p, 0.3f, 0.5f, -0.3f), Vec3<float>(0.05f, 0.05f, 0.02f)), Vec3<T>(Vec3<float>(0.8f, 0.41f, 0.79f)));
+		case 9:
+			return Sample<T>(TriPrismSdf(Translate(p, -0.6f, 0.5f, -0.3f), Vec2<float>(0.05f, 0.02f)), Vec3<T>(Vec3<float>(0.92f, 0.68f, 0.92f)));
+		case 10:
+			return Sample<T>(CylinderSdf(Translate(p, -0.6f, 0.5f, 0.0f), Vec3<float>(0.002f, -0.002f, 0.0f), Vec3<float>(-0.02f, 0.06f, 0.02f), 0.016f), Vec3<T>(Vec3<float>(0.78f, 0.38f, 0.08f)));
+		case 11:
+			return Sample<T>(CylinderSdf(Translate(p, -0.6f, 0.5f, 0.3f), Vec2<float>(0.02f, 0.04f)), Vec3<T>(Vec3<float>(0.98f, 0.63f, 0.42f)));
+		case 12:
+			return Sample<T>(Cylinder6Sdf(Translate(p, 0.3f, 0.5f, 0.6f), Vec2<float>(0.02f, 0.04f)), Vec3<T>(Vec3<float>(0.29f, 0.46f, 0.43f)));
+		case 13:
+			return Sample<T>(OctahedronSdf(Translate(p, 0.0f, 0.5f, 0.6f), 0.07f), Vec3<T>(Vec3<float>(0.46f, 0.61f, 0.52f)));
+		case 14:
+			return Sample<T>(HexPrismSdf(Translate(p, -0.3f, 0.5f, 0.6f), Vec2<float>(0.05f, 0.01f)), Vec3<T>(Vec3<float>(0.59f, 1.0f, 1.0f)));
+		default:
+			return Sample<T>(RoundConeSdf(Translate(p, -0.6f, 0.5f, 0.6f), 0.04f, 0.02f, 0.06f), Vec3<T>(Vec3<float>(1.0f, 0.2f, 0.0f)));
+		}
+	}
+
+	template <typename T>
+	Sdf::Sample<T> ImplicitSceneSdf::EvaluateObject(const ImplicitSceneParameters& parameters, const unsigned int object, const Sdf::Vec3<T>& samplePoint, const T& coneWidth)
+	{
+		switch (object)
+		{
+		case 0:
+			return MorphingShapes(parameters, samplePoint);
+		case 1:
+			return AlienShip(parameters, samplePoint);
+		case 2:
+			return AlienShipBeam(parameters, samplePoint);
+		case 3:
+			return Alien(parameters, samplePoint);
+		case 4:
+			return WaterDrip(parameters, samplePoint);
+		case 5:
+			return Sdf::MandelbulbSdf(Sdf::Translate(samplePoint, -4.0f, 2.0f, -4.0f), parameters.mandelbulbPower, parameters.mandelbulbRotation, parameters.mandelbulbColour, parameters.mandelbulbIterations, coneWidth);
+		case 6:
+			//Twice the size in the tetrahedron's space, and so is the cone
+			return Sdf::SierpinskiTetrahedronSdf(Sdf::Translate(samplePoint, 2.0f, 2.0f, 2.0f) * 2.0f, parameters.sierpinskiIterations, Sdf::SierpinskiNoBailout, coneWidth * 2.0f);
+		case 7:
+			return WobblySphere(parameters, samplePoint, coneWidth);
+		default:
+			return GalleryPrimitive(object - 8, samplePoint);
+		}
+	}
+
+	template <typename T>
+	Sdf::Sample<T> ImplicitSceneSdf::Evaluate(const ImplicitSceneParameters& parameters, const Sdf::Vec3<T>& samplePoint)
+	{
+		using namespace Sdf;
+
+		auto closestHit = Sample<T>(T(1e10f), Vec3<T>(T(0.0f), T(0.0f), T(0.0f)));
+
+		for (auto object = 0u; object < ObjectCount; object++)
+		{
+			closestHit = Union(closestHit, EvaluateObject(parameters, object, samplePoint));
+		}
+
+		return closestHit;
+	}
+
+	//estimateGradiantNormal, central differences
+	template <typename T, typename Evaluator>
+	Sdf::Vec3<T> ImplicitSceneSdf::EstimateNormal(const Evaluator& evaluate, const Sdf::Vec3<T>& p)
+	{
+		using namespace Sdf;
+
+		const auto e = Epsilon;
+
+		return Normalize(Vec3<T>(
+			evaluate(Vec3<T>(p.x + e, p.y, p.z)).distance - evaluate(Vec3<T>(p.x - e, p.y, p.z)).distance,
+			evaluate(Vec3<T>(p.x, p.y + e, p.z)).distance - evaluate(Vec3<T>(p.x, p.y - e, p.z)).distance,
+			evaluate(Vec3<T>(p.x, p.y, p.z + e)).distance - evaluate(Vec3<T>(p.x, p.y, p.z - e)).distance));
+	}
+
+	template <typename T, typename Evaluator>
+	Sdf::Vec3<T> ImplicitSceneSdf::EstimateNormalTetrahedron(const Evaluator& evaluate, const Sdf::Vec3<T>& p)
+	{
+		using namespace Sdf;
+
+		const auto e = Epsilon;
+
+		//Corners (1, -1, -1), (-1, -1, 1), (-1, 1, -1) and (1, 1, 1), each weighted by its distance
+		const auto a = evaluate(Vec3<T>(p.x + e, p.y - e, p.z - e)).distance;
+		const auto b = evaluate(Vec3<T>(p.x - e, p.y - e, p.z + e)).distance;
+		const auto c = evaluate(Vec3<T>(p.x - e, p.y + e, p.z - e)).distance;
+		const auto d = evaluate(Vec3<T>(p.x + e, p.y + e, p.z + e)).distance;
+
+		return Normalize(Vec3<T>(a - b - c + d, -a - b + c + d, -a + b - c + d));
+	}
+
+	template <typename T, typename Evaluator>
+	Sdf::Vec3<T> ImplicitSceneSdf::GradientNormal(const Evaluator& evaluate, const Sdf::Vec3<T>& p)
+	{
+		return Sdf::Normalize(evaluate(Sdf::DualPoint(p)).distance.gradient);
+	}
+
+	//PhongIllumination with the one light and shininess 40, then the distance fog
+	template <typename T>
+	Sdf::Vec3<T> ImplicitSceneSdf::Shade(const Sdf::Vec3<T>& surfacePoint, const Sdf::Vec3<T>& normal, const Sdf::Vec3<T>& rayDirection, const Sdf::Vec3<T>& colour, const T& depth)
+	{
+		using namespace Sdf;
+
+		//The shader's PhongIllumination takes the surface point as a float, so only its x reaches the light direction
+		const auto lightDirection = Normalize(Vec3<T>(-surfacePoint.x, T(3.0f) - surfacePoint.x, -surfacePoint.x));
+		const auto nDotL = Dot(normal, lightDirection);
+		const auto reflection = Normalize(Reflect(-lightDirection, normal));
+		const auto rDotV = Max(T(0.0f), Dot(reflection, -rayDirection));
+
+		const auto diffuse = nDotL * 0.4f;
+		const auto specular = Select(nDotL > T(0.0f), T(0.4f) * Pow(Pow(rDotV, 20.0f), 40.0f), T(0.0f));
+
+		const auto lit = Vec3<T>(
+			colour.x * 0.2f + Saturate(diffuse * colour.x) + specular,
+			colour.y * 0.2f + Saturate(diffuse * colour.y) + specular,
+			colour.z * 0.2f + Saturate(diffuse * colour.z) + specular);
+
+		const auto fog = T(1.0f) - Exp(depth * depth * depth * -0.0005f);
+
+		return Lerp(lit, Vec3<T>(Vec3<float>(1.0f, 0.97255f, 0.86275f)), fog);
+	}
+}
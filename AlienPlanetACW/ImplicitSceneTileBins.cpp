@@ -0,0 +1,186 @@
+#include "pch.h"
+#include "ImplicitSceneTileBins.h"
+#include "ImplicitSceneIntervals.h"
+
+#include <algorithm>
+#include <bitset>
+#include <chrono>
+#include <cmath>
+
+using namespace AlienPlanetACW;
+using namespace AlienPlanetACW::Sdf;
+using namespace DirectX;
+
+const float ImplicitSceneTileBins::Margin = 4.0f * ImplicitSceneSdf::Epsilon;
+const double ImplicitSceneTileBins::NearPlane = 0.5 * ImplicitSceneSdf::Epsilon;
+
+ImplicitSceneTileBins::ImplicitSceneTileBins(const std::vector<ImplicitSceneBounds>& objectBounds, const XMMATRIX& view, const unsigned int width, const unsigned int height, const unsigned int tileSize)
+	: m_tileSize(std::max(tileSize, 1u)), m_columns(0), m_rows(0), m_milliseconds(0.0)
+{
+	const auto start = std::chrono::high_resolution_clock::now();
+
+	m_columns = (width + m_tileSize - 1) / m_tileSize;
+	m_rows = (height + m_tileSize - 1) / m_tileSize;
+	m_tileObjects.assign(m_columns * m_rows, 0);
+
+	XMFLOAT4X4 inverseView;
+	XMStoreFloat4x4(&inverseView, XMMatrixInverse(nullptr, view));
+
+	//Doubles as the unbounded objects' boxes reach a billion units out
+	const double right[3] = { inverseView._11, inverseView._12, inverseView._13 };
+	const double up[3] = { inverseView._21, inverseView._22, inverseView._23 };
+	const double back[3] = { inverseView._31, inverseView._32, inverseView._33 };
+	const double eye[3] = { inverseView._41, inverseView._42, inverseView._43 };
+	const auto aspectRatio = static_cast<double>(height) / width;
+
+	//The objects whose distances overstep or jump, where a ray lands on them depends on the steps before it
+	auto steppedObjects = 0u;
+
+	for (auto object = 0u; object < objectBounds.size() && object < ImplicitSceneSdf::ObjectCount; object++)
+	{
+		//The overestimating objects stop a ray where their distance is under Epsilon, which can be Epsilon over their
+		//distanceScale from the surface, so their margin is scaled up by as much
+		const auto margin = static_cast<double>(Margin) / std::min(std::max(objectBounds[object].distanceScale, 1e-3f), 1.0f);
+		const double minimum[3] = { objectBounds[object].minimum.x - margin, objectBounds[object].minimum.y - margin, objectBounds[object].minimum.z - margin };
+		const double maximum[3] = { objectBounds[object].maximum.x + margin, objectBounds[object].maximum.y + margin, objectBounds[object].maximum.z + margin };
+
+		if (objectBounds[object].distanceScale < 1.0f || !ImplicitSceneSdf::IsObjectLipschitz(object) || ImplicitSceneSdf::IsObjectOverstepping(object))
+		{
+			steppedObjects |= 1u << object;
+		}
+
+		double offsets[8][3];
+		double forwards[8];
+
+		for (auto corner = 0; corner < 8; corner++)
+		{
+			for (auto axis = 0; axis < 3; axis++)
+			{
+				offsets[corner][axis] = ((corner & (1 << axis)) != 0 ? maximum[axis] : minimum[axis]) - eye[axis];
+			}
+
+			forwards[corner] = -(offsets[corner][0] * back[0] + offsets[corner][1] * back[1] + offsets[corner][2] * back[2]);
+		}
+
+		auto canvasMinimumX = 1e30;
+		auto canvasMinimumY = 1e30;
+		auto canvasMaximumX = -1e30;
+		auto canvasMaximumY = -1e30;
+		auto projected = 0;
+
+		//Onto the canvas one unit in front of the camera, the way ImplicitRayMarcher's ReprojectCache does
+		const auto project = [&](const double* offset, const double forward)
+		{
+			const auto x = (offset[0] * right[0] + offset[1] * right[1] + offset[2] * right[2]) / forward;
+			const auto y = (offset[0] * up[0] + offset[1] * up[1] + offset[2] * up[2]) / forward;
+
+			canvasMinimumX = std::min(canvasMinimumX, x);
+			canvasMaximumX = std::max(canvasMaximumX, x);
+			canvasMinimumY = std::min(canvasMinimumY, y);
+			canvasMaximumY = std::max(canvasMaximumY, y);
+			projected++;
+		};
+
+		//The part of the box in front of the near plane is its corners there and where its edges cross the plane
+		for (auto corner = 0; corner < 8; corner++)
+		{
+			if (forwards[corner] >= NearPlane)
+			{
+				project(offsets[corner], forwards[corner]);
+			}
+
+			for (auto axis = 0; axis < 3; axis++)
+			{
+				const auto other = corner | (1 << axis);
+
+				if (other != corner && (forwards[corner] < NearPlane) != (forwards[other] < NearPlane))
+				{
+					const auto t = (NearPlane - forwards[corner]) / (forwards[other] - forwards[corner]);
+					double crossing[3];
+
+					for (auto component = 0; component < 3; component++)
+					{
+						crossing[component] = offsets[corner][component] + (offsets[other][component] - offsets[corner][component]) * t;
+					}
+
+					project(crossing, NearPlane);
+				}
+			}
+		}
+
+		//Wholly behind the near plane, where no ray samples
+		if (projected == 0)
+		{
+			continue;
+		}
+
+		const auto left = (canvasMinimumX + 1.0) * 0.5 * width;
+		const auto rightEdge = (canvasMaximumX + 1.0) * 0.5 * width;
+		const auto top = (1.0 - canvasMaximumY / aspectRatio) * 0.5 * height;
+		const auto bottom = (1.0 - canvasMinimumY / aspectRatio) * 0.5 * height;
+
+		if (rightEdge < 0.0 || bottom < 0.0 || left > width || top > height)
+		{
+			continue;
+		}
+
+		const auto firstColumn = static_cast<unsigned int>(std::max(left, 0.0)) / m_tileSize;
+		const auto lastColumn = static_cast<unsigned int>(std::min(rightEdge, static_cast<double>(width - 1))) / m_tileSize;
+		const auto firstRow = static_cast<unsigned int>(std::max(top, 0.0)) / m_tileSize;
+		const auto lastRow = static_cast<unsigned int>(std::min(bottom, static_cast<double>(height - 1))) / m_tileSize;
+
+		for (auto row = firstRow; row <= lastRow; row++)
+		{
+			for (auto column = firstColumn; column <= lastColumn; column++)
+			{
+				m_tileObjects[row * m_columns + column] |= 1u << object;
+			}
+		}
+	}
+
+	//A ray onto a stepped object hits where it does because of how far every other object let it step, so its tile
+	//evaluates all of them, the same as without the bins
+	for (auto& tile : m_tileObjects)
+	{
+		if ((tile & steppedObjects) != 0)
+		{
+			tile = ImplicitSceneIntervals::AllObjects;
+		}
+	}
+
+	m_milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+unsigned int ImplicitSceneTileBins::GetEmptyTileCount() const
+{
+	return static_cast<unsigned int>(std::count(m_tileObjects.begin(), m_tileObjects.end(), 0u));
+}
+
+double ImplicitSceneTileBins::GetAverageObjectsPerTile() const
+{
+	auto objects = 0ull;
+
+	for (const auto tile : m_tileObjects)
+	{
+		objects += std::bitset<32>(tile).count();
+	}
+
+	return m_tileObjects.empty() ? 0.0 : static_cast<double>(objects) / m_tileObjects.size();
+}
+
+unsigned int ImplicitSceneTileBins::GetMaxObjectsPerTile() const
+{
+	auto maxObjects = 0u;
+
+	for (const auto tile : m_tileObjects)
+	{
+		maxObjects = std::max(maxObjects, static_cast<unsigned int>(std::bitset<32>(tile).count()));
+	}
+
+	return maxObjects;
+}
+
+unsigned int ImplicitSceneTileBins::GetObjectTileCount(const unsigned int object) const
+{
+	return static_cast<unsigned int>(std::count_if(m_tileObjects.begin(), m_tileObjects.end(), [object](const unsigned int tile) { return (tile & (1u << object)) != 0; }));
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "ImplicitSceneHierarchy.h"
+
+#include <DirectXMath.h>
+#include <vector>
+
+namespace AlienPlanetACW
+{
+	//ImplicitSceneSdf's objects binned into square tiles of the screen, the way tiled light culling bins lights. Each
+	//object's box is projected onto the ray marcher's canvas, and a tile's list, a mask with bit n for object n, has every
+	//object whose box covers any of it. No ray through a tile can reach an object that isn't on its list, so a tile with
+	//an empty list has nothing to march and the others only evaluate their objects. Where a ray lands on the objects
+	//whose distances overstep or jump depends on how far the others let it step, so a tile with one of those on its
+	//list evaluates every object. GetTileObjects is the structured buffer ImplicitRayModelsPS.hlsl reads as tileObjects
+	class ImplicitSceneTileBins
+	{
+	public:
+		//objectBounds are the boxes for this time and view is the matrix the renderer gives the shader. width and height
+		//are the image's in pixels
+		ImplicitSceneTileBins(const std::vector<ImplicitSceneBounds>& objectBounds, const DirectX::XMMATRIX& view, unsigned int width, unsigned int height, unsigned int tileSize = 16);
+
+		unsigned int GetTileSize() const { return m_tileSize; }
+		unsigned int GetColumns() const { return m_columns; }
+		unsigned int GetRows() const { return m_rows; }
+
+		unsigned int GetObjects(unsigned int tileX, unsigned int tileY) const { return m_tileObjects[tileY * m_columns + tileX]; }
+		//Every tile's list row by row, one uint each
+		const std::vector<unsigned int>& GetTileObjects() const { return m_tileObjects; }
+
+		unsigned int GetEmptyTileCount() const;
+		double GetAverageObjectsPerTile() const;
+		unsigned int GetMaxObjectsPerTile() const;
+		//How many tiles have the object on their list
+		unsigned int GetObjectTileCount(unsigned int object) const;
+		double GetMilliseconds() const { return m_milliseconds; }
+
+	private:
+		//How far outside its box a ray can stop on an object, or the normal can sample it, over the box's distanceScale
+		static const float Margin;
+		//Rays start Epsilon along, and through the canvas's corners that is at least half of it in front of the camera
+		//for any image up to twice as tall as it is wide, so nothing nearer than this is ever sampled
+		static const double NearPlane;
+
+		unsigned int m_tileSize;
+		unsigned int m_columns;
+		unsigned int m_rows;
+		std::vector<unsigned int> m_tileObjects;
+		double m_milliseconds;
+	};
+}
@@ -0,0 +1,128 @@
+//Upsampling pass for dynamic resolution in ImplicitRayModels, ImplicitBilateralUpsampler's bilateral filter on the CPU.
+//Scales what ImplicitRayModelsPS.hlsl drew at a scale of the screen up to it, with each hit's depth written the same as
+//the main pass would have
+cbuffer ModelViewProjectionConstantBuffer : register(b0)
+{
+	matrix model;
+	matrix view;
+	matrix projection;
+};
+
+cbuffer InverseViewConstantBuffer : register(b1)
+{
+	matrix inverseView;
+}
+
+#include "ImplicitDynamicResolution.hlsli"
+
+struct PixelShaderInput
+{
+	float4 position : SV_POSITION;
+	float2 canvasXY : TEXCOORD0;
+};
+
+struct outputPS
+{
+	float4 colour : SV_TARGET;
+	float depth : SV_DEPTH;
+};
+
+//1 when ImplicitRayModelsPS.hlsl's DEPTH_LIMITS is, so hits behind the rasterized scene at this pixel don't count
+#define DEPTH_LIMITS 0
+
+static float MAX_DIST = 50.0;
+static float EPSILON = 0.0001;
+//How far a hit's depth can be from the reference one before its weight falls to e^-1, as a fraction of it
+static float DEPTH_SIGMA = 0.05;
+
+Texture2D<float4> scaledColours : register(t0);
+Texture2D<float> scaledDistances : register(t1);
+
+#if DEPTH_LIMITS
+Texture2D<float> depthLimits : register(t2);
+#endif
+
+outputPS main(PixelShaderInput input)
+{
+	outputPS output;
+
+	//Pixel centres line up, the same as the scaled down viewport over the same canvas
+	float2 sourcePosition = input.position.xy * renderSize / screenSize - 0.5f;
+	int2 topLeft = int2(floor(sourcePosition));
+	float2 fraction = sourcePosition - topLeft;
+
+	float limit = MAX_DIST;
+
+#if DEPTH_LIMITS
+	limit = depthLimits.Load(int3(input.position.xy, 0)) - EPSILON;
+#endif
+
+	float4 colours[4];
+	float distances[4];
+	float weights[4];
+	bool hits[4];
+
+	float hitWeight = 0.0f;
+	int reference = 0;
+
+	[unroll]
+	for (int tap = 0; tap < 4; tap++)
+	{
+		int2 offset = int2(tap & 1, tap >> 1);
+		int3 texel = int3(clamp(topLeft + offset, int2(0, 0), int2(renderSize) - 1), 0);
+
+		colours[tap] = scaledColours.Load(texel);
+		distances[tap] = scaledDistances.Load(texel);
+		weights[tap] = (offset.x != 0 ? fraction.x : 1.0f - fraction.x) * (offset.y != 0 ? fraction.y : 1.0f - fraction.y);
+		//Hidden behind the rasterized scene at this pixel, as the marched ray would have been
+		hits[tap] = distances[tap] < MAX_DIST && distances[tap] <= limit;
+
+		if (hits[tap])
+		{
+			hitWeight += weights[tap];
+
+			if (!hits[reference] || weights[tap] > weights[reference])
+			{
+				reference = tap;
+			}
+		}
+	}
+
+	//Mostly misses, so the edge of whatever was hit is further over
+	if (hitWeight < 0.5f)
+	{
+		discard;
+	}
+
+	float4 colour = float4(0.0f, 0.0f, 0.0f, 0.0f);
+	float distance = 0.0f;
+	float total = 0.0f;
+
+	[unroll]
+	for (int i = 0; i < 4; i++)
+	{
+		if (hits[i])
+		{
+			float difference = (distances[i] - distances[reference]) / (DEPTH_SIGMA * distances[reference]);
+			float weight = weights[i] * exp(-difference * difference);
+
+			colour += weight * colours[i];
+			distance += weight * distances[i];
+			total += weight;
+		}
+	}
+
+	colour /= total;
+	distance /= total;
+
+	float3 eye = mul(float4(0.0f, 0.0f, 0.0f, 1.0f), inverseView).xyz;
+	float3 direction = normalize(mul(float4(input.canvasXY, -1.0f, 0.0f), inverseView).xyz);
+
+	float4 pv = mul(float4(eye + distance * direction, 1.0f), view);
+	pv = mul(pv, projection);
+	output.depth = pv.z / pv.w;
+
+	output.colour = colour;
+
+	return output;
+}
@@ -0,0 +1,568 @@
+#include "pch.h"
+#include "ImplicitWavefrontRayTracer.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <ppl.h>
+
+using namespace AlienPlanetACW;
+using namespace AlienPlanetACW::Sdf;
+using namespace DirectX;
+
+namespace
+{
+	//Spreads the low ten bits of value out to every third bit
+	unsigned int SpreadBits(unsigned int value)
+	{
+		value &= 0x000003FF;
+		value = (value | (value << 16)) & 0x030000FF;
+		value = (value | (value << 8)) & 0x0300F00F;
+		value = (value | (value << 4)) & 0x030C30C3;
+		value = (value | (value << 2)) & 0x09249249;
+		return value;
+	}
+
+	//Chunks of a batch as tasks, or one after another
+	template <typename Work>
+	void ForEachChunk(const unsigned int count, const unsigned int chunkSize, const bool parallel, const Work& work)
+	{
+		const auto chunkCount = (count + chunkSize - 1) / chunkSize;
+
+		const auto runChunk = [&](const size_t chunk)
+		{
+			const auto first = static_cast<unsigned int>(chunk) * chunkSize;
+			work(static_cast<unsigned int>(chunk), first, std::min(first + chunkSize, count));
+		};
+
+		if (parallel)
+		{
+			concurrency::parallel_for(static_cast<size_t>(0), static_cast<size_t>(chunkCount), runChunk);
+		}
+		else
+		{
+			for (auto chunk = 0u; chunk < chunkCount; chunk++)
+			{
+				runChunk(chunk);
+			}
+		}
+	}
+
+	//Least significant byte first, so rays with equal keys stay in the order they were spawned in. Each pass counts the
+	//digits in every chunk as a task, then every chunk scatters its keys as a task to after all the smaller digits and
+	//the same digit in the chunks before it. keys and values end up sorted, with the scratch ones the same size
+	void SortByKey(std::vector<unsigned int>& keys, std::vector<unsigned int>& values, std::vector<unsigned int>& scratchKeys, std::vector<unsigned int>& scratchValues, const unsigned int keyBits, const bool parallel)
+	{
+		const auto count = static_cast<unsigned int>(keys.size());
+		const auto chunkCount = (count + ImplicitWavefrontRayTracer::SortChunkSize - 1) / ImplicitWavefrontRayTracer::SortChunkSize;
+
+		//256 for each chunk, its count of each digit and then where the next key with that digit goes
+		std::vector<unsigned int> offsets(chunkCount * 256);
+
+		for (auto shift = 0u; shift < keyBits; shift += 8)
+		{
+			ForEachChunk(count, ImplicitWavefrontRayTracer::SortChunkSize, parallel, [&](const unsigned int chunk, const unsigned int first, const unsigned int last)
+			{
+				const auto chunkOffsets = &offsets[chunk * 256];
+				std::fill(chunkOffsets, chunkOffsets + 256, 0u);
+
+				for (auto i = first; i < last; i++)
+				{
+					chunkOffsets[(keys[i] >> shift) & 0xFF]++;
+				}
+			});
+
+			auto total = 0u;
+
+			for (auto digit = 0u; digit < 256; digit++)
+			{
+				for (auto chunk = 0u; chunk < chunkCount; chunk++)
+				{
+					const auto digitCount = offsets[chunk * 256 + digit];
+					offsets[chunk * 256 + digit] = total;
+					total += digitCount;
+				}
+			}
+
+			ForEachChunk(count, ImplicitWavefrontRayTracer::SortChunkSize, parallel, [&](const unsigned int chunk, const unsigned int first, const unsigned int last)
+			{
+				const auto chunkOffsets = &offsets[chunk * 256];
+
+				for (auto i = first; i < last; i++)
+				{
+					const auto destination = chunkOffsets[(keys[i] >> shift) & 0xFF]++;
+					scratchKeys[destination] = keys[i];
+					scratchValues[destination] = values[i];
+				}
+			});
+
+			keys.swap(scratchKeys);
+			values.swap(scratchValues);
+		}
+	}
+}
+
+void ImplicitWavefrontRayQueue::Resize(const unsigned int size)
+{
+	originX.resize(size);
+	originY.resize(size);
+	originZ.resize(size);
+	directionX.resize(size);
+	directionY.resize(size);
+	directionZ.resize(size);
+	pixel.resize(size);
+	intensity.resize(size);
+}
+
+ImplicitWavefrontRayTracer::ImplicitWavefrontRayTracer(const ImplicitRayTracedBvh& bvh, const ImplicitRayTracerSettings& settings, const bool sortRays, const bool usePackets) : m_bvh(bvh), m_settings(settings), m_sortRays(sortRays), m_usePackets(usePackets)
+{
+}
+
+unsigned int ImplicitWavefrontRayTracer::GetSortKey(const Vec3<float>& origin, const Vec3<float>& direction, const Vec3<float>& minimum, const Vec3<float>& maximum)
+{
+	const auto cells = static_cast<float>(1u << MortonBits);
+
+	const auto quantise = [cells](const float value, const float low, const float high)
+	{
+		const auto cell = (value - low) / std::max(high - low, FLT_MIN) * cells;
+		return static_cast<unsigned int>(std::min(std::max(cell, 0.0f), cells - 1.0f));
+	};
+
+	const auto octant = (direction.x < 0.0f ? 1u : 0u) | (direction.y < 0.0f ? 2u : 0u) | (direction.z < 0.0f ? 4u : 0u);
+	const auto morton = SpreadBits(quantise(origin.x, minimum.x, maximum.x)) | (SpreadBits(quantise(origin.y, minimum.y, maximum.y)) << 1) | (SpreadBits(quantise(origin.z, minimum.z, maximum.z)) << 2);
+
+	return (octant << (3 * MortonBits)) | morton;
+}
+
+ImplicitWavefrontStats ImplicitWavefrontRayTracer::Render(const XMMATRIX& view, HeadlessImage& image, std::vector<float>* const depths) const
+{
+	const auto start = std::chrono::high_resolution_clock::now();
+
+	XMFLOAT4X4 inverseView;
+	XMStoreFloat4x4(&inverseView, XMMatrixInverse(nullptr, view));
+
+	const auto right = Vec3<float>(inverseView._11, inverseView._12, inverseView._13);
+	const auto up = Vec3<float>(inverseView._21, inverseView._22, inverseView._23);
+	const auto back = Vec3<float>(inverseView._31, inverseView._32, inverseView._33);
+	const auto eye = Vec3<float>(inverseView._41, inverseView._42, inverseView._43);
+	const auto background = Vec3<float>(m_settings.background.x, m_settings.background.y, m_settings.background.z);
+
+	const auto width = image.GetWidth();
+	const auto height = image.GetHeight();
+	const auto aspectRatio = static_cast<float>(height) / width;
+	const auto pixelCount = width * height;
+
+	const auto& primitives = m_bvh.GetPrimitives();
+
+	const auto forEachChunk = [this](const unsigned int count, const auto& work)
+	{
+		ForEachChunk(count, ChunkSize, m_settings.parallel, work);
+	};
+
+	//A packet's rays through the tree together, or each in turn. Bit n of the result is set when ray n hit
+	const auto traceNearest = [this](const Vec3<float>* const origins, const Vec3<float>* const directions, const unsigned int rayCount, const float tMin, const float* const tMax, ImplicitRayTracedHit* const packetHits, ImplicitRayTracedBvhCount& tests)
+	{
+		if (m_usePackets)
+		{
+			return m_bvh.NearestHitPacket(origins, directions, rayCount, tMin, tMax, packetHits, &tests);
+		}
+
+		auto hitLanes = 0u;
+
+		for (auto lane = 0u; lane < rayCount; lane++)
+		{
+			if (m_bvh.NearestHit(origins[lane], directions[lane], tMin, tMax[lane], packetHits[lane], &tests))
+			{
+				hitLanes |= 1u << lane;
+			}
+		}
+
+		return hitLanes;
+	};
+
+	const auto traceAny = [this](const Vec3<float>* const origins, const Vec3<float>* const directions, const unsigned int rayCount, const float tMin, const float* const tMax, ImplicitRayTracedBvhCount& tests)
+	{
+		if (m_usePackets)
+		{
+			return m_bvh.AnyHitPacket(origins, directions, rayCount, tMin, tMax, &tests);
+		}
+
+		auto hitLanes = 0u;
+
+		for (auto lane = 0u; lane < rayCount; lane++)
+		{
+			if (m_bvh.AnyHit(origins[lane], directions[lane], tMin, tMax[lane], &tests))
+			{
+				hitLanes |= 1u << lane;
+			}
+		}
+
+		return hitLanes;
+	};
+
+	ImplicitWavefrontStats stats = {};
+
+	//A batch never has more rays than pixels, so each chunk adds up its own across every batch
+	std::vector<ImplicitRayTracerStats> chunkStats((pixelCount + ChunkSize - 1) / ChunkSize, ImplicitRayTracerStats());
+
+	std::vector<Vec3<float>> colours(pixelCount, Vec3<float>(0.0f, 0.0f, 0.0f));
+	std::vector<float> primaryDistances(pixelCount, ImplicitRayTracer::MaxDistance);
+
+	//The batch being traced, and the reflections its hits spawn at the same index
+	ImplicitWavefrontRayQueue queue;
+	ImplicitWavefrontRayQueue spawned;
+	std::vector<ImplicitRayTracedHit> hits(pixelCount);
+	std::vector<unsigned char> spawnedFlags(pixelCount);
+
+	std::vector<unsigned int> sortChunkOffsets;
+	std::vector<Vec3<float>> sortChunkMinimums;
+	std::vector<Vec3<float>> sortChunkMaximums;
+	std::vector<unsigned int> keys;
+	std::vector<unsigned int> order;
+	std::vector<unsigned int> scratchKeys;
+	std::vector<unsigned int> scratchOrder;
+
+	queue.Resize(pixelCount);
+	spawned.Resize(pixelCount);
+
+	//The same rays as ImplicitRayTracer, in the order of the pixels
+	forEachChunk(pixelCount, [&](const unsigned int, const unsigned int first, const unsigned int last)
+	{
+		for (auto i = first; i < last; i++)
+		{
+			const auto x = i % width;
+			const auto y = i / width;
+			const auto canvasX = (x + 0.5f) / width * 2.0f - 1.0f;
+			const auto canvasY = (1.0f - (y + 0.5f) / height * 2.0f) * aspectRatio;
+			const auto direction = Normalize(right * canvasX + up * canvasY - back);
+
+			queue.originX[i] = eye.x;
+			queue.originY[i] = eye.y;
+			queue.originZ[i] = eye.z;
+			queue.directionX[i] = direction.x;
+			queue.directionY[i] = direction.y;
+			queue.directionZ[i] = direction.z;
+			queue.pixel[i] = i;
+			queue.intensity[i] = 1.0f;
+		}
+	});
+
+	for (auto bounce = 0u; bounce <= m_settings.reflections; bounce++)
+	{
+		const auto rayCount = queue.GetSize();
+
+		if (rayCount == 0)
+		{
+			break;
+		}
+
+		stats.batches++;
+
+		const auto tMin = bounce == 0 ? 0.0f : ImplicitRayTracer::Epsilon;
+		const auto spawnReflections = bounce < m_settings.reflections;
+
+		//Trace the batch, nothing but the tree for a packet of rays at a time
+		forEachChunk(rayCount, [&](const unsigned int chunk, const unsigned int first, const unsigned int last)
+		{
+			auto& chunkStat = chunkStats[chunk];
+
+			if (bounce == 0)
+			{
+				chunkStat.primaryRays += last - first;
+			}
+			else
+			{
+				chunkStat.reflectionRays += last - first;
+			}
+
+			for (auto packetFirst = first; packetFirst < last; packetFirst += PacketSize)
+			{
+				const auto packetCount = std::min(packetFirst + PacketSize, last) - packetFirst;
+
+				Vec3<float> origins[PacketSize];
+				Vec3<float> directions[PacketSize];
+				float tMax[PacketSize];
+
+				for (auto lane = 0u; lane < packetCount; lane++)
+				{
+					const auto i = packetFirst + lane;
+
+					origins[lane] = Vec3<float>(queue.originX[i], queue.originY[i], queue.originZ[i]);
+					directions[lane] = Vec3<float>(queue.directionX[i], queue.directionY[i], queue.directionZ[i]);
+					tMax[lane] = ImplicitRayTracer::MaxDistance;
+				}
+
+				const auto hitLanes = traceNearest(origins, directions, packetCount, tMin, tMax, &hits[packetFirst], chunkStat.tests);
+
+				for (auto lane = 0u; lane < packetCount; lane++)
+				{
+					if ((hitLanes & (1u << lane)) == 0)
+					{
+						hits[packetFirst + lane].primitive = ImplicitRayTracedBvh::EmptyChild;
+					}
+				}
+			}
+		});
+
+		//Shade its hits, a packet's shadow rays traced together, and spawn their reflections
+		forEachChunk(rayCount, [&](const unsigned int chunk, const unsigned int first, const unsigned int last)
+		{
+			auto& chunkStat = chunkStats[chunk];
+
+			for (auto packetFirst = first; packetFirst < last; packetFirst += PacketSize)
+			{
+				const auto packetCount = std::min(packetFirst + PacketSize, last) - packetFirst;
+
+				Vec3<float> surfacePoints[PacketSize];
+				Vec3<float> normals[PacketSize];
+				Vec3<float> lightDirections[PacketSize];
+				float lightDistances[PacketSize];
+				auto hitLanes = 0u;
+
+				//Only the lanes that hit have shadow rays, packed to the front
+				unsigned int shadowLanes[PacketSize];
+				auto shadowCount = 0u;
+
+				for (auto lane = 0u; lane < packetCount; lane++)
+				{
+					const auto i = packetFirst + lane;
+					const auto& hit = hits[i];
+
+					spawnedFlags[i] = 0;
+
+					if (hit.primitive == ImplicitRayTracedBvh::EmptyChild)
+					{
+						continue;
+					}
+
+					hitLanes |= 1u << lane;
+
+					const auto origin = Vec3<float>(queue.originX[i], queue.originY[i], queue.originZ[i]);
+					const auto direction = Vec3<float>(queue.directionX[i], queue.directionY[i], queue.directionZ[i]);
+
+					if (bounce == 0)
+					{
+						primaryDistances[queue.pixel[i]] = hit.distance;
+						chunkStat.hits++;
+					}
+
+					surfacePoints[lane] = origin + direction * hit.distance;
+					normals[lane] = ImplicitRayTracedBvh::GetNormal(primitives[hit.primitive], surfacePoints[lane]);
+
+					const auto toLight = ImplicitRayTracer::LightPosition - surfacePoints[lane];
+					lightDistances[lane] = Length(toLight);
+					lightDirections[lane] = toLight * (1.0f / lightDistances[lane]);
+
+					if (m_settings.shadows)
+					{
+						shadowLanes[shadowCount++] = lane;
+					}
+				}
+
+				auto shadowedLanes = 0u;
+
+				if (shadowCount > 0)
+				{
+					Vec3<float> shadowOrigins[PacketSize];
+					Vec3<float> shadowDirections[PacketSize];
+					float shadowDistances[PacketSize];
+
+					for (auto shadow = 0u; shadow < shadowCount; shadow++)
+					{
+						shadowOrigins[shadow] = surfacePoints[shadowLanes[shadow]];
+						shadowDirections[shadow] = lightDirections[shadowLanes[shadow]];
+						shadowDistances[shadow] = lightDistances[shadowLanes[shadow]];
+					}
+
+					chunkStat.shadowRays += shadowCount;
+
+					const auto blocked = traceAny(shadowOrigins, shadowDirections, shadowCount, ImplicitRayTracer::Epsilon, shadowDistances, chunkStat.tests);
+
+					for (auto shadow = 0u; shadow < shadowCount; shadow++)
+					{
+						if ((blocked & (1u << shadow)) != 0)
+						{
+							shadowedLanes |= 1u << shadowLanes[shadow];
+						}
+					}
+				}
+
+				for (auto lane = 0u; lane < packetCount; lane++)
+				{
+					if ((hitLanes & (1u << lane)) == 0)
+					{
+						continue;
+					}
+
+					const auto i = packetFirst + lane;
+					const auto pixel = queue.pixel[i];
+					const auto intensity = queue.intensity[i];
+					const auto direction = Vec3<float>(queue.directionX[i], queue.directionY[i], queue.directionZ[i]);
+					const auto& primitive = primitives[hits[i].primitive];
+
+					if ((shadowedLanes & (1u << lane)) == 0)
+					{
+						colours[pixel] = colours[pixel] + ImplicitRayTracer::Phong(primitive, normals[lane], lightDirections[lane], direction) * intensity;
+					}
+
+					if (spawnReflections)
+					{
+						const auto reflected = Reflect(direction, normals[lane]);
+
+						spawned.originX[i] = surfacePoints[lane].x;
+						spawned.originY[i] = surfacePoints[lane].y;
+						spawned.originZ[i] = surfacePoints[lane].z;
+						spawned.directionX[i] = reflected.x;
+						spawned.directionY[i] = reflected.y;
+						spawned.directionZ[i] = reflected.z;
+						spawned.pixel[i] = pixel;
+						spawned.intensity[i] = intensity * primitive.Kr;
+						spawnedFlags[i] = 1;
+					}
+				}
+			}
+		});
+
+		if (!spawnReflections)
+		{
+			break;
+		}
+
+		//Compact the reflections into the next queue, sorted when asked. Each sort chunk counts its reflections and
+		//the bounds of their origins as a task, then writes their indices after the chunks before it
+		const auto sortStart = std::chrono::high_resolution_clock::now();
+
+		const auto sortChunkCount = (rayCount + SortChunkSize - 1) / SortChunkSize;
+
+		sortChunkOffsets.assign(sortChunkCount + 1, 0);
+		sortChunkMinimums.resize(sortChunkCount);
+		sortChunkMaximums.resize(sortChunkCount);
+
+		ForEachChunk(rayCount, SortChunkSize, m_settings.parallel, [&](const unsigned int chunk, const unsigned int first, const unsigned int last)
+		{
+			auto minimum = Vec3<float>(FLT_MAX, FLT_MAX, FLT_MAX);
+			auto maximum = Vec3<float>(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+			auto spawnedCount = 0u;
+
+			for (auto i = first; i < last; i++)
+			{
+				if (spawnedFlags[i] == 0)
+				{
+					continue;
+				}
+
+				spawnedCount++;
+				minimum = Vec3<float>(std::min(minimum.x, spawned.originX[i]), std::min(minimum.y, spawned.originY[i]), std::min(minimum.z, spawned.originZ[i]));
+				maximum = Vec3<float>(std::max(maximum.x, spawned.originX[i]), std::max(maximum.y, spawned.originY[i]), std::max(maximum.z, spawned.originZ[i]));
+			}
+
+			sortChunkOffsets[chunk + 1] = spawnedCount;
+			sortChunkMinimums[chunk] = minimum;
+			sortChunkMaximums[chunk] = maximum;
+		});
+
+		auto minimum = Vec3<float>(FLT_MAX, FLT_MAX, FLT_MAX);
+		auto maximum = Vec3<float>(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+		for (auto chunk = 0u; chunk < sortChunkCount; chunk++)
+		{
+			sortChunkOffsets[chunk + 1] += sortChunkOffsets[chunk];
+			minimum = Vec3<float>(std::min(minimum.x, sortChunkMinimums[chunk].x), std::min(minimum.y, sortChunkMinimums[chunk].y), std::min(minimum.z, sortChunkMinimums[chunk].z));
+			maximum = Vec3<float>(std::max(maximum.x, sortChunkMaximums[chunk].x), std::max(maximum.y, sortChunkMaximums[chunk].y), std::max(maximum.z, sortChunkMaximums[chunk].z));
+		}
+
+		const auto nextCount = sortChunkOffsets[sortChunkCount];
+		const auto sort = m_sortRays && nextCount > 1;
+
+		order.resize(nextCount);
+		keys.resize(sort ? nextCount : 0);
+
+		//Keyed as they're written, with the bounds all the chunks found
+		ForEachChunk(rayCount, SortChunkSize, m_settings.parallel, [&](const unsigned int chunk, const unsigned int first, const unsigned int last)
+		{
+			auto j = sortChunkOffsets[chunk];
+
+			for (auto i = first; i < last; i++)
+			{
+				if (spawnedFlags[i] == 0)
+				{
+					continue;
+				}
+
+				if (sort)
+				{
+					keys[j] = GetSortKey(Vec3<float>(spawned.originX[i], spawned.originY[i], spawned.originZ[i]), Vec3<float>(spawned.directionX[i], spawned.directionY[i], spawned.directionZ[i]), minimum, maximum);
+				}
+
+				order[j++] = i;
+			}
+		});
+
+		if (sort)
+		{
+			scratchKeys.resize(nextCount);
+			scratchOrder.resize(nextCount);
+
+			SortByKey(keys, order, scratchKeys, scratchOrder, 3 * MortonBits + 3, m_settings.parallel);
+		}
+
+		queue.Resize(nextCount);
+
+		forEachChunk(nextCount, [&](const unsigned int, const unsigned int first, const unsigned int last)
+		{
+			for (auto j = first; j < last; j++)
+			{
+				const auto i = order[j];
+
+				queue.originX[j] = spawned.originX[i];
+				queue.originY[j] = spawned.originY[i];
+				queue.originZ[j] = spawned.originZ[i];
+				queue.directionX[j] = spawned.directionX[i];
+				queue.directionY[j] = spawned.directionY[i];
+				queue.directionZ[j] = spawned.directionZ[i];
+				queue.pixel[j] = spawned.pixel[i];
+				queue.intensity[j] = spawned.intensity[i];
+			}
+		});
+
+		stats.sortMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - sortStart).count();
+	}
+
+	if (depths != nullptr)
+	{
+		depths->assign(pixelCount, ImplicitRayTracer::MaxDistance);
+	}
+
+	for (auto i = 0u; i < pixelCount; i++)
+	{
+		const auto x = i % width;
+		const auto y = i / width;
+
+		if (primaryDistances[i] > ImplicitRayTracer::MaxDistance - ImplicitRayTracer::Epsilon)
+		{
+			image.SetPixel(x, y, m_settings.background);
+		}
+		else
+		{
+			image.SetPixel(x, y, ImplicitRayTracer::Fog(colours[i], background, primaryDistances[i]));
+
+			if (depths != nullptr)
+			{
+				(*depths)[i] = primaryDistances[i];
+			}
+		}
+	}
+
+	for (const auto& chunk : chunkStats)
+	{
+		stats.rays.primaryRays += chunk.primaryRays;
+		stats.rays.reflectionRays += chunk.reflectionRays;
+		stats.rays.shadowRays += chunk.shadowRays;
+		stats.rays.hits += chunk.hits;
+		stats.rays.tests.Add(chunk.tests);
+	}
+
+	stats.rays.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	return stats;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "HeadlessImage.h"
+#include "ImplicitRayTracer.h"
+
+#include <DirectXMath.h>
+#include <vector>
+
+namespace AlienPlanetACW
+{
+	//Rays waiting to be traced, 32 bytes each over eight arrays so a batch reads only what each stage needs
+	struct ImplicitWavefrontRayQueue
+	{
+		std::vector<float> originX;
+		std::vector<float> originY;
+		std::vector<float> originZ;
+		std::vector<float> directionX;
+		std::vector<float> directionY;
+		std::vector<float> directionZ;
+		//Where the ray's light goes, y * width + x
+		std::vector<unsigned int> pixel;
+		//What the light from its hit is scaled by, the product of the Kr of the hits before
+		std::vector<float> intensity;
+
+		unsigned int GetSize() const { return static_cast<unsigned int>(pixel.size()); }
+		void Resize(unsigned int size);
+	};
+
+	struct ImplicitWavefrontStats
+	{
+		//The same counts as the depth first tracer's, with its time being the whole render
+		ImplicitRayTracerStats rays;
+		//Of that, how long went on compacting, keying and sorting the reflection rays and gathering them into the next queue
+		double sortMilliseconds;
+		//Batches traced, the primary one and one for each bounce that had rays left
+		unsigned int batches;
+	};
+
+	//ImplicitRayTracer's Whitted tracing one bounce at a time rather than one pixel at a time. Every primary ray is traced
+	//as one batch, then its hits are shaded as another, with a shadow ray each, and the reflections they spawn go into
+	//the next queue. Before each bounce is traced the queue is sorted by the octant of the rays' directions and then
+	//the Morton code of their origins, so rays that are traced together start near each other going the same way and
+	//go down the same parts of the BVH. Batches are split into chunks for the thread pool, and each chunk's rays, and
+	//the shadow rays of its hits, go through the tree in packets of ImplicitRayTracedBvh::PacketSize in queue order, so
+	//the rays the sort put together share the nodes they visit. The compaction, keys and radix sort are done in chunks
+	//as tasks too. Each pixel is only written by its own ray, so the image matches the depth first one. On the CPU it
+	//doesn't beat ImplicitRayTracer, which stays the tracer everything else uses. The BVH's nodes are tested four
+	//children to a ray at a time either way, so a packet saves fetches and stack work but no slab tests, and at best
+	//this about breaks even in RunImplicitRayWavefront
+	class ImplicitWavefrontRayTracer
+	{
+	public:
+		//Rays a task traces or shades at a time
+		static const unsigned int ChunkSize = 256;
+		//Rays a task compacts, keys or scatters at a time in the sort, bigger than ChunkSize so each of its 256 counts
+		//for a digit covers enough keys
+		static const unsigned int SortChunkSize = 4096;
+		//Bits of each origin axis in the sort key, under the three of the octant
+		static const unsigned int MortonBits = 9;
+		static const unsigned int PacketSize = ImplicitRayTracedBvh::PacketSize;
+
+		//settings.useBvh, checkerboard and adaptiveBlockSize are ignored, the queue only goes through the tree and traces
+		//every pixel
+		ImplicitWavefrontRayTracer(const ImplicitRayTracedBvh& bvh, const ImplicitRayTracerSettings& settings = ImplicitRayTracerSettings(), bool sortRays = true, bool usePackets = true);
+
+		const ImplicitRayTracerSettings& GetSettings() const { return m_settings; }
+		void SetSettings(const ImplicitRayTracerSettings& settings) { m_settings = settings; }
+		bool GetSortRays() const { return m_sortRays; }
+		//Off, each bounce's rays are traced in the order of the pixels that spawned them
+		void SetSortRays(bool sortRays) { m_sortRays = sortRays; }
+		bool GetUsePackets() const { return m_usePackets; }
+		//Off, each ray goes through the tree on its own
+		void SetUsePackets(bool usePackets) { m_usePackets = usePackets; }
+
+		//The same as ImplicitRayTracer::Render
+		ImplicitWavefrontStats Render(const DirectX::XMMATRIX& view, HeadlessImage& image, std::vector<float>* depths = nullptr) const;
+
+		//Octant in the top three bits and the Morton code of the origin within minimum to maximum below, lower for the
+		//queue to trace sooner
+		static unsigned int GetSortKey(const Sdf::Vec3<float>& origin, const Sdf::Vec3<float>& direction, const Sdf::Vec3<float>& minimum, const Sdf::Vec3<float>& maximum);
+
+	private:
+		const ImplicitRayTracedBvh& m_bvh;
+		ImplicitRayTracerSettings m_settings;
+		bool m_sortRays;
+		bool m_usePackets;
+	};
+}
@@ -0,0 +1,333 @@
+#pragma once
+
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <ppl.h>
+#include <DirectXMath.h>
+
+#include "..\Content\ShaderStructures.h"
+
+namespace AlienPlanetACW
+{
+	//Four surface samples in structure of arrays form, position plus the analytic partial derivatives
+	struct SurfaceSamples
+	{
+		DirectX::XMVECTOR x, y, z;
+		DirectX::XMVECTOR dux, duy, duz;
+		DirectX::XMVECTOR dvx, dvy, dvz;
+	};
+
+	//Same surface as ParametricTorusDS.hlsl, R = 1 and r = 0.5
+	struct TorusSurface
+	{
+		float majorRadius = 1.0f;
+		float minorRadius = 0.5f;
+
+		void operator()(DirectX::FXMVECTOR u, DirectX::FXMVECTOR v, SurfaceSamples& samples) const
+		{
+			using namespace DirectX;
+
+			const auto twoPi = XMVectorReplicate(XM_2PI);
+			const auto half = XMVectorReplicate(0.5f);
+
+			XMVECTOR sinU, cosU, sinV, cosV;
+			XMVectorSinCos(&sinU, &cosU, XMVectorMultiply(XMVectorAdd(u, half), twoPi));
+			XMVectorSinCos(&sinV, &cosV, XMVectorMultiply(XMVectorAdd(v, half), twoPi));
+
+			const auto minor = XMVectorReplicate(minorRadius);
+			const auto ring = XMVectorMultiplyAdd(minor, cosV, XMVectorReplicate(majorRadius));
+
+			samples.x = XMVectorMultiply(ring, cosU);
+			samples.y = XMVectorMultiply(ring, sinU);
+			samples.z = XMVectorMultiply(minor, sinV);
+
+			const auto ringScaled = XMVectorMultiply(ring, twoPi);
+			samples.dux = XMVectorNegate(XMVectorMultiply(ringScaled, sinU));
+			samples.duy = XMVectorMultiply(ringScaled, cosU);
+			samples.duz = XMVectorZero();
+
+			const auto minorScaled = XMVectorMultiply(minor, twoPi);
+			const auto minorSinV = XMVectorMultiply(minorScaled, sinV);
+			samples.dvx = XMVectorNegate(XMVectorMultiply(minorSinV, cosU));
+			samples.dvy = XMVectorNegate(XMVectorMultiply(minorSinV, sinU));
+			samples.dvz = XMVectorMultiply(minorScaled, cosV);
+		}
+	};
+
+	//Same surface as ParametricEllipsoidDS.hlsl, the domain shader sweeps v over a full turn and covers the
+	//surface twice, here v covers pole to pole once (-z to +z so du x dv faces outwards) so a baked mesh doesn't
+	//store every triangle twice
+	struct EllipsoidSurface
+	{
+		DirectX::XMFLOAT3 radii = DirectX::XMFLOAT3(1.0f, 1.0f, 0.5f);
+
+		void operator()(DirectX::FXMVECTOR u, DirectX::FXMVECTOR v, SurfaceSamples& samples) const
+		{
+			using namespace DirectX;
+
+			const auto twoPi = XMVectorReplicate(XM_2PI);
+			const auto pi = XMVectorReplicate(XM_PI);
+
+			XMVECTOR sinU, cosU, sinV, cosV;
+			XMVectorSinCos(&sinU, &cosU, XMVectorMultiply(XMVectorAdd(u, XMVectorReplicate(0.5f)), twoPi));
+			XMVectorSinCos(&sinV, &cosV, XMVectorMultiply(v, pi));
+
+			const auto radiusX = XMVectorReplicate(radii.x);
+			const auto radiusY = XMVectorReplicate(radii.y);
+			const auto radiusZ = XMVectorReplicate(radii.z);
+
+			samples.x = XMVectorMultiply(radiusX, XMVectorMultiply(cosU, sinV));
+			samples.y = XMVectorMultiply(radiusY, XMVectorMultiply(sinU, sinV));
+			samples.z = XMVectorNegate(XMVectorMultiply(radiusZ, cosV));
+
+			samples.dux = XMVectorNegate(XMVectorMultiply(XMVectorMultiply(radiusX, twoPi), XMVectorMultiply(sinU, sinV)));
+			samples.duy = XMVectorMultiply(XMVectorMultiply(radiusY, twoPi), XMVectorMultiply(cosU, sinV));
+			samples.duz = XMVectorZero();
+
+			samples.dvx = XMVectorMultiply(XMVectorMultiply(radiusX, pi), XMVectorMultiply(cosU, cosV));
+			samples.dvy = XMVectorMultiply(XMVectorMultiply(radiusY, pi), XMVectorMultiply(sinU, cosV));
+			samples.dvz = XMVectorMultiply(XMVectorMultiply(radiusZ, pi), sinV);
+		}
+	};
+
+	struct ParametricMeshLod
+	{
+		unsigned int resolutionU;
+		unsigned int resolutionV;
+
+		std::vector<VertexPositionTexcoordNormalTangentBinormal> vertices;
+		std::vector<unsigned long> indices;
+
+		//Largest distance between the surface and the triangles, sampled at quad centres and edge midpoints
+		float maxError;
+		double generationMilliseconds;
+	};
+
+	//Bakes a parametric surface into indexed triangle meshes, the surface is any function object taking
+	//four u and four v values and filling a SurfaceSamples with positions and analytic partial derivatives
+	template <typename Surface>
+	class ParametricSurfaceEvaluator
+	{
+	public:
+		explicit ParametricSurfaceEvaluator(const Surface& surface = Surface()) : m_surface(surface)
+		{
+		}
+
+		ParametricMeshLod Generate(const unsigned int resolutionU, const unsigned int resolutionV, const bool parallel = true) const
+		{
+			const auto start = std::chrono::high_resolution_clock::now();
+
+			ParametricMeshLod lod;
+			lod.resolutionU = resolutionU;
+			lod.resolutionV = resolutionV;
+
+			const auto rowLength = resolutionU + 1;
+			const auto rowCount = resolutionV + 1;
+
+			lod.vertices.resize(rowLength * rowCount);
+			lod.indices.resize(resolutionU * resolutionV * 6);
+
+			std::vector<float> rowErrors(rowCount, 0.0f);
+
+			const auto generateRow = [&](const unsigned int row)
+			{
+				EvaluateRow(row, resolutionU, resolutionV, &lod.vertices[row * rowLength]);
+
+				if (row < resolutionV)
+				{
+					auto* index = &lod.indices[row * resolutionU * 6];
+
+					for (auto column = 0u; column < resolutionU; column++)
+					{
+						const auto topLeft = row * rowLength + column;
+						const auto bottomLeft = topLeft + rowLength;
+
+						*index++ = topLeft;
+						*index++ = bottomLeft;
+						*index++ = topLeft + 1;
+						*index++ = topLeft + 1;
+						*index++ = bottomLeft;
+						*index++ = bottomLeft + 1;
+					}
+				}
+			};
+
+			if (parallel)
+			{
+				concurrency::parallel_for(0u, rowCount, generateRow);
+				concurrency::parallel_for(0u, resolutionV, [&](const unsigned int row) { rowErrors[row] = MeasureRowError(lod, row); });
+			}
+			else
+			{
+				for (auto row = 0u; row < rowCount; row++)
+				{
+					generateRow(row);
+				}
+
+				for (auto row = 0u; row < resolutionV; row++)
+				{
+					rowErrors[row] = MeasureRowError(lod, row);
+				}
+			}
+
+			lod.maxError = 0.0f;
+
+			for (const auto error : rowErrors)
+			{
+				lod.maxError = error > lod.maxError ? error : lod.maxError;
+			}
+
+			lod.generationMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+			return lod;
+		}
+
+		//Each entry in resolutions is (u, v) quad counts, finest first
+		std::vector<ParametricMeshLod> GenerateLods(const std::vector<DirectX::XMUINT2>& resolutions, const bool parallel = true) const
+		{
+			std::vector<ParametricMeshLod> lods;
+
+			for (const auto& resolution : resolutions)
+			{
+				lods.emplace_back(Generate(resolution.x, resolution.y, parallel));
+			}
+
+			return lods;
+		}
+
+	private:
+		void EvaluateRow(const unsigned int row, const unsigned int resolutionU, const unsigned int resolutionV, VertexPositionTexcoordNormalTangentBinormal* vertices) const
+		{
+			using namespace DirectX;
+
+			const auto v = static_cast<float>(row) / static_cast<float>(resolutionV);
+			const auto stepU = 1.0f / static_cast<float>(resolutionU);
+
+			alignas(16) float us[4];
+			alignas(16) float px[4], py[4], pz[4], nx[4], ny[4], nz[4], tx[4], ty[4], tz[4], bx[4], by[4], bz[4];
+
+			SurfaceSamples samples;
+
+			//Four columns per batch, the tail batch recomputes its last column rather than branching per lane
+			for (auto column = 0u; column <= resolutionU; column += 4)
+			{
+				for (auto lane = 0u; lane < 4; lane++)
+				{
+					const auto laneColumn = column + lane <= resolutionU ? column + lane : resolutionU;
+					us[lane] = static_cast<float>(laneColumn) * stepU;
+				}
+
+				m_surface(XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(us)), XMVectorReplicate(v), samples);
+
+				//Normal from the cross product of the partials, tangent and binormal are the partials themselves
+				auto normalX = XMVectorSubtract(XMVectorMultiply(samples.duy, samples.dvz), XMVectorMultiply(samples.duz, samples.dvy));
+				auto normalY = XMVectorSubtract(XMVectorMultiply(samples.duz, samples.dvx), XMVectorMultiply(samples.dux, samples.dvz));
+				auto normalZ = XMVectorSubtract(XMVectorMultiply(samples.dux, samples.dvy), XMVectorMultiply(samples.duy, samples.dvx));
+
+				const auto normalLengthSq = XMVectorMultiplyAdd(normalX, normalX, XMVectorMultiplyAdd(normalY, normalY, XMVectorMultiply(normalZ, normalZ)));
+
+				//At a pole one partial vanishes, fall back to the direction away from the axis of the surface
+				const auto degenerate = XMVectorLess(normalLengthSq, XMVectorReplicate(1e-12f));
+				const auto positionLengthSq = XMVectorMultiplyAdd(samples.x, samples.x, XMVectorMultiplyAdd(samples.y, samples.y, XMVectorMultiply(samples.z, samples.z)));
+
+				normalX = XMVectorSelect(normalX, samples.x, degenerate);
+				normalY = XMVectorSelect(normalY, samples.y, degenerate);
+				normalZ = XMVectorSelect(normalZ, samples.z, degenerate);
+
+				const auto normalScale = XMVectorReciprocalSqrt(XMVectorSelect(normalLengthSq, positionLengthSq, degenerate));
+
+				const auto tangentLengthSq = XMVectorMultiplyAdd(samples.dux, samples.dux, XMVectorMultiplyAdd(samples.duy, samples.duy, XMVectorMultiply(samples.duz, samples.duz)));
+				const auto binormalLengthSq = XMVectorMultiplyAdd(samples.dvx, samples.dvx, XMVectorMultiplyAdd(samples.dvy, samples.dvy, XMVectorMultiply(samples.dvz, samples.dvz)));
+				const auto tangentScale = XMVectorReciprocalSqrt(XMVectorMax(tangentLengthSq, XMVectorReplicate(1e-12f)));
+				const auto binormalScale = XMVectorReciprocalSqrt(XMVectorMax(binormalLengthSq, XMVectorReplicate(1e-12f)));
+
+				XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(px), samples.x);
+				XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(py), samples.y);
+				XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(pz), samples.z);
+				XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(nx), XMVectorMultiply(normalX, normalScale));
+				XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(ny), XMVectorMultiply(normalY, normalScale));
+				XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(nz), XMVectorMultiply(normalZ, normalScale));
+				XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(tx), XMVectorMultiply(samples.dux, tangentScale));
+				XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(ty), XMVectorMultiply(samples.duy, tangentScale));
+				XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(tz), XMVectorMultiply(samples.duz, tangentScale));
+				XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(bx), XMVectorMultiply(samples.dvx, binormalScale));
+				XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(by), XMVectorMultiply(samples.dvy, binormalScale));
+				XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(bz), XMVectorMultiply(samples.dvz, binormalScale));
+
+				for (auto lane = 0u; lane < 4 && column + lane <= resolutionU; lane++)
+				{
+					auto& vertex = vertices[column + lane];
+
+					vertex.position = XMFLOAT3(px[lane], py[lane], pz[lane]);
+					vertex.texcoord = XMFLOAT2(us[lane], v);
+					vertex.normal = XMFLOAT3(nx[lane], ny[lane], nz[lane]);
+					vertex.tangent = XMFLOAT3(tx[lane], ty[lane], tz[lane]);
+					vertex.binormal = XMFLOAT3(bx[lane], by[lane], bz[lane]);
+				}
+			}
+		}
+
+		float MeasureRowError(const ParametricMeshLod& lod, const unsigned int row) const
+		{
+			using namespace DirectX;
+
+			const auto rowLength = lod.resolutionU + 1;
+			const auto stepU = 1.0f / static_cast<float>(lod.resolutionU);
+			const auto stepV = 1.0f / static_cast<float>(lod.resolutionV);
+
+			auto maxError = 0.0f;
+
+			alignas(16) float us[4];
+			alignas(16) float vs[4];
+			alignas(16) float sx[4], sy[4], sz[4];
+
+			SurfaceSamples samples;
+
+			//Per quad: the centre, which lies on the shared diagonal, and the midpoints of the top, left and bottom edges
+			for (auto column = 0u; column < lod.resolutionU; column++)
+			{
+				const auto& topLeft = lod.vertices[row * rowLength + column].position;
+				const auto& topRight = lod.vertices[row * rowLength + column + 1].position;
+				const auto& bottomLeft = lod.vertices[(row + 1) * rowLength + column].position;
+				const auto& bottomRight = lod.vertices[(row + 1) * rowLength + column + 1].position;
+
+				const auto u = static_cast<float>(column) * stepU;
+				const auto v = static_cast<float>(row) * stepV;
+
+				us[0] = u + 0.5f * stepU; vs[0] = v + 0.5f * stepV;
+				us[1] = u + 0.5f * stepU; vs[1] = v;
+				us[2] = u;                vs[2] = v + 0.5f * stepV;
+				us[3] = u + 0.5f * stepU; vs[3] = v + stepV;
+
+				m_surface(XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(us)), XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(vs)), samples);
+
+				XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(sx), samples.x);
+				XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(sy), samples.y);
+				XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(sz), samples.z);
+
+				const XMFLOAT3 linear[4] =
+				{
+					XMFLOAT3((topRight.x + bottomLeft.x) * 0.5f, (topRight.y + bottomLeft.y) * 0.5f, (topRight.z + bottomLeft.z) * 0.5f),
+					XMFLOAT3((topLeft.x + topRight.x) * 0.5f, (topLeft.y + topRight.y) * 0.5f, (topLeft.z + topRight.z) * 0.5f),
+					XMFLOAT3((topLeft.x + bottomLeft.x) * 0.5f, (topLeft.y + bottomLeft.y) * 0.5f, (topLeft.z + bottomLeft.z) * 0.5f),
+					XMFLOAT3((bottomLeft.x + bottomRight.x) * 0.5f, (bottomLeft.y + bottomRight.y) * 0.5f, (bottomLeft.z + bottomRight.z) * 0.5f)
+				};
+
+				for (auto i = 0; i < 4; i++)
+				{
+					const auto dx = sx[i] - linear[i].x;
+					const auto dy = sy[i] - linear[i].y;
+					const auto dz = sz[i] - linear[i].z;
+					const auto error = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+					maxError = error > maxError ? error : maxError;
+				}
+			}
+
+			return maxError;
+		}
+
+		Surface m_surface;
+	};
+}
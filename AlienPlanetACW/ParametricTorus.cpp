@@ -4,7 +4,7 @@
 using namespace AlienPlanetACW;
 
 ParametricTorus::ParametricTorus(const std::shared_ptr<DX::DeviceResources>& deviceResources, const std::shared_ptr<ResourceManager>& resourceManager)
-	: m_deviceResources(deviceResources), m_resourceManager(resourceManager), m_position(0.0f, 1.5f, -1.5f), m_rotation(0.0f, 0.0f, 0.0f), m_scale(0.3f, 0.3f, 0.3f), m_loadingComplete(false), m_indexCount(0)
+	: m_deviceResources(deviceResources), m_resourceManager(resourceManager), m_position(0.0f, 1.5f, -1.5f), m_rotation(0.0f, 0.0f, 0.0f), m_scale(0.3f, 0.3f, 0.3f), m_loadingComplete(false), m_indexCount(0), m_currentLod(0), m_useBakedMesh(true)
 {
 	CreateDeviceDependentResources();
 }
@@ -16,6 +16,7 @@ void ParametricTorus::CreateDeviceDependentResources()
 	auto loadHSTask = DX::ReadDataAsync(L"ParametricTorusHS.cso");
 	auto loadDSTask = DX::ReadDataAsync(L"ParametricTorusDS.cso");
 	auto loadPSTask = DX::ReadDataAsync(L"ParametricTorusPS.cso");
+	auto loadMeshVSTask = DX::ReadDataAsync(L"ParametricMeshVS.cso");
 
 	auto createVSTask = loadVSTask.then([this](const std::vector<byte>& fileData) {
 		DX::ThrowIfFailed(
@@ -57,6 +58,11 @@ void ParametricTorus::CreateDeviceDependentResources()
 		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateDomainShader(&fileData[0], fileData.size(), nullptr, &m_domainShader));
 	});
 
+	auto createMeshVSTask = loadMeshVSTask.then([this](const std::vector<byte>& fileData)
+	{
+		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateVertexShader(&fileData[0], fileData.size(), nullptr, &m_meshVertexShader));
+	});
+
 	auto createPSTask = loadPSTask.then([this](const std::vector<byte>& fileData) {
 		DX::ThrowIfFailed(
 			m_deviceResources->GetD3DDevice()->CreatePixelShader(
@@ -94,13 +100,25 @@ void ParametricTorus::CreateDeviceDependentResources()
 		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateBuffer(&cameraBufferDescription, nullptr, &m_cameraBuffer));
 	});
 
-	auto createPlaneTask = (createPSTask && createDSTask && createHSTask && createVSTask).then([this]() {
+	auto createPlaneTask = (createPSTask && createDSTask && createHSTask && createVSTask && createMeshVSTask).then([this]() {
 
 		m_resourceManager->GetTexture(m_deviceResources->GetD3DDevice(), L"TorusDiffuse.dds", m_diffuseTexture);
 		m_resourceManager->GetTexture(m_deviceResources->GetD3DDevice(), L"TorusNormal.dds", m_normalTexture);
 
 		m_resourceManager->GetModel(m_deviceResources->GetD3DDevice(), "plane2.obj", m_vertexBuffer, m_indexBuffer);
 		m_indexCount = m_resourceManager->GetIndexCount("plane2.obj");
+
+		//The surface is static, bake it once at every LOD rather than re-evaluating it in the domain shader each frame
+		static const char* const lodNames[LodCount] = { "ParametricTorusLOD0", "ParametricTorusLOD1", "ParametricTorusLOD2", "ParametricTorusLOD3" };
+
+		const auto lods = ParametricSurfaceEvaluator<TorusSurface>().GenerateLods(GetLodResolutions());
+
+		for (auto i = 0; i < LodCount; i++)
+		{
+			m_resourceManager->CreateModel(m_deviceResources->GetD3DDevice(), lodNames[i], lods[i].vertices, lods[i].indices);
+			m_resourceManager->GetModel(m_deviceResources->GetD3DDevice(), lodNames[i], m_lodVertexBuffers[i], m_lodIndexBuffers[i]);
+			m_lodIndexCounts[i] = m_resourceManager->GetIndexCount(lodNames[i]);
+		}
 	});
 
 	createPlaneTask.then([this]() {
@@ -119,6 +137,31 @@ void ParametricTorus::SetViewProjectionMatrixConstantBuffer(DirectX::XMMATRIX& v
 void ParametricTorus::SetCameraPositionConstantBuffer(DirectX::XMFLOAT3& cameraPosition)
 {
 	m_cameraBufferData.position = cameraPosition;
+
+	//Pick the baked LOD from the distance to the camera, each step halves the quad count in both directions
+	static const float lodDistances[LodCount - 1] = { 2.0f, 4.0f, 8.0f };
+
+	const auto dx = cameraPosition.x - m_position.x;
+	const auto dy = cameraPosition.y - m_position.y;
+	const auto dz = cameraPosition.z - m_position.z;
+	const auto distance = sqrt(dx * dx + dy * dy + dz * dz);
+
+	m_currentLod = 0;
+
+	while (m_currentLod < LodCount - 1 && distance > lodDistances[m_currentLod])
+	{
+		m_currentLod++;
+	}
+}
+
+void ParametricTorus::SetUseBakedMesh(bool useBakedMesh)
+{
+	m_useBakedMesh = useBakedMesh;
+}
+
+std::vector<DirectX::XMUINT2> ParametricTorus::GetLodResolutions()
+{
+	return { DirectX::XMUINT2(128, 64), DirectX::XMUINT2(64, 32), DirectX::XMUINT2(32, 16), DirectX::XMUINT2(16, 8) };
 }
 
 void ParametricTorus::Update(DX::StepTimer const& timer)
@@ -169,23 +212,40 @@ void ParametricTorus::Render()
 	// Each vertex is one instance of the VertexPositionColor struct.
 	UINT stride = sizeof(AlienPlanetACW::VertexPositionTexcoordNormalTangentBinormal);
 	UINT offset = 0;
-	context->IASetVertexBuffers(
-		0,
-		1,
-		m_vertexBuffer.GetAddressOf(),
-		&stride,
-		&offset
-	);
+	if (m_useBakedMesh)
+	{
+		context->IASetVertexBuffers(
+			0,
+			1,
+			m_lodVertexBuffers[m_currentLod].GetAddressOf(),
+			&stride,
+			&offset
+		);
+
+		context->IASetIndexBuffer(m_lodIndexBuffers[m_currentLod].Get(), DXGI_FORMAT_R32_UINT, 0);
+
+		context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	}
+	else
+	{
+		context->IASetVertexBuffers(
+			0,
+			1,
+			m_vertexBuffer.GetAddressOf(),
+			&stride,
+			&offset
+		);
 
-	context->IASetIndexBuffer(m_indexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
+		context->IASetIndexBuffer(m_indexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
 
-	context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_4_CONTROL_POINT_PATCHLIST);
+		context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_4_CONTROL_POINT_PATCHLIST);
+	}
 
 	context->IASetInputLayout(m_inputLayout.Get());
 
 	// Attach our vertex shader.
 	context->VSSetShader(
-		m_vertexShader.Get(),
+		m_useBakedMesh ? m_meshVertexShader.Get() : m_vertexShader.Get(),
 		nullptr,
 		0
 	);
@@ -199,14 +259,22 @@ void ParametricTorus::Render()
 		nullptr
 	);
 
+	context->VSSetConstantBuffers1(
+		1,
+		1,
+		m_cameraBuffer.GetAddressOf(),
+		nullptr,
+		nullptr
+	);
+
 	context->HSSetShader(
-		m_hullShader.Get(),
+		m_useBakedMesh ? nullptr : m_hullShader.Get(),
 		nullptr,
 		0
 	);
 
 	context->DSSetShader(
-		m_domainShader.Get(),
+		m_useBakedMesh ? nullptr : m_domainShader.Get(),
 		nullptr,
 		0
 	);
@@ -262,7 +330,7 @@ void ParametricTorus::Render()
 
 	// Draw the objects.
 	context->DrawIndexed(
-		m_indexCount,
+		m_useBakedMesh ? m_lodIndexCounts[m_currentLod] : m_indexCount,
 		0,
 		0
 	);
@@ -280,4 +348,11 @@ void ParametricTorus::ReleaseDeviceDependentResources()
 	m_cameraBuffer.Reset();
 	m_vertexBuffer.Reset();
 	m_indexBuffer.Reset();
+	m_meshVertexShader.Reset();
+
+	for (auto i = 0; i < LodCount; i++)
+	{
+		m_lodVertexBuffers[i].Reset();
+		m_lodIndexBuffers[i].Reset();
+	}
 }
\ No newline at end of file
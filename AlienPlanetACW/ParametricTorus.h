@@ -6,6 +6,7 @@
 #include "..\Common\StepTimer.h"
 
 #include "ResourceManager.h"
+#include "ParametricSurface.h"
 #include <DirectXMath.h>
 
 namespace AlienPlanetACW
@@ -17,12 +18,18 @@ namespace AlienPlanetACW
 		void CreateDeviceDependentResources();
 		void SetViewProjectionMatrixConstantBuffer(DirectX::XMMATRIX& view, DirectX::XMMATRIX& projection);
 		void SetCameraPositionConstantBuffer(DirectX::XMFLOAT3& cameraPosition);
+		void SetUseBakedMesh(bool useBakedMesh);
 		void ReleaseDeviceDependentResources();
 
 		void Update(DX::StepTimer const& timer);
 		void Render();
 
+		//Quad counts of the baked meshes, finest first
+		static std::vector<DirectX::XMUINT2> GetLodResolutions();
+
 	private:
+		static const int LodCount = 4;
+
 		std::shared_ptr<DX::DeviceResources> m_deviceResources;
 		std::shared_ptr<ResourceManager> m_resourceManager;
 
@@ -38,6 +45,11 @@ namespace AlienPlanetACW
 		Microsoft::WRL::ComPtr<ID3D11HullShader>	m_hullShader;
 		Microsoft::WRL::ComPtr<ID3D11DomainShader>	m_domainShader;
 		Microsoft::WRL::ComPtr<ID3D11PixelShader>	m_pixelShader;
+		Microsoft::WRL::ComPtr<ID3D11VertexShader>	m_meshVertexShader;
+
+		Microsoft::WRL::ComPtr<ID3D11Buffer>		m_lodVertexBuffers[LodCount];
+		Microsoft::WRL::ComPtr<ID3D11Buffer>		m_lodIndexBuffers[LodCount];
+		uint32										m_lodIndexCounts[LodCount];
 
 		Microsoft::WRL::ComPtr<ID3D11RasterizerState> m_rasterizerState;
 
@@ -53,6 +65,8 @@ namespace AlienPlanetACW
 
 		uint32	m_indexCount;
 
+		int		m_currentLod;
+		bool	m_useBakedMesh;
 		bool	m_loadingComplete;
 	};
 }
@@ -0,0 +1,129 @@
+#include "pch.h"
+#include "PerformanceReport.h"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+using namespace AlienPlanetACW;
+
+PerformanceReport::PerformanceReport(const std::string& title)
+{
+	m_lines.emplace_back(title);
+	m_lines.emplace_back(std::string(title.size(), '='));
+}
+
+void PerformanceReport::AddSection(const std::string& name)
+{
+	m_lines.emplace_back("");
+	m_lines.emplace_back(name);
+	m_lines.emplace_back(std::string(name.size(), '-'));
+}
+
+void PerformanceReport::AddLine(const std::string& line)
+{
+	m_lines.emplace_back(line);
+}
+
+void PerformanceReport::AddFailure(const std::string& check)
+{
+	m_lines.emplace_back("FAIL: " + check);
+	m_failures.push_back(check);
+}
+
+void PerformanceReport::AddFailureSummary()
+{
+	AddSection("Checks");
+
+	if (m_failures.empty())
+	{
+		m_lines.emplace_back("All passed");
+		return;
+	}
+
+	m_lines.emplace_back("FAIL: " + std::to_string(m_failures.size()) + (m_failures.size() == 1 ? " check failed" : " checks failed"));
+
+	for (const auto& failure : m_failures)
+	{
+		m_lines.emplace_back("FAIL: " + failure);
+	}
+}
+
+void PerformanceReport::AddTable(const std::vector<std::string>& headings, const std::vector<std::vector<std::string>>& rows)
+{
+	std::vector<size_t> widths(headings.size(), 0);
+
+	for (auto i = 0u; i < headings.size(); i++)
+	{
+		widths[i] = headings[i].size();
+	}
+
+	for (const auto& row : rows)
+	{
+		for (auto i = 0u; i < row.size() && i < widths.size(); i++)
+		{
+			widths[i] = row[i].size() > widths[i] ? row[i].size() : widths[i];
+		}
+	}
+
+	const auto formatRow = [&widths](const std::vector<std::string>& cells)
+	{
+		std::ostringstream line;
+
+		for (auto i = 0u; i < widths.size(); i++)
+		{
+			line << "| " << std::setw(static_cast<int>(widths[i])) << (i < cells.size() ? cells[i] : "") << " ";
+		}
+
+		line << "|";
+
+		return line.str();
+	};
+
+	m_lines.emplace_back(formatRow(headings));
+
+	std::string separator = "|";
+
+	for (const auto width : widths)
+	{
+		separator += std::string(width + 2, '-') + "|";
+	}
+
+	m_lines.emplace_back(separator);
+
+	for (const auto& row : rows)
+	{
+		m_lines.emplace_back(formatRow(row));
+	}
+}
+
+std::string PerformanceReport::ToString() const
+{
+	std::string text;
+
+	for (const auto& line : m_lines)
+	{
+		text += line + "\n";
+	}
+
+	return text;
+}
+
+void PerformanceReport::Write(const std::wstring& fileName) const
+{
+	auto localFolder = Windows::Storage::ApplicationData::Current->LocalFolder->Path;
+
+	std::ofstream file(std::wstring(localFolder->Data()) + L"\\" + fileName);
+
+	if (!file.fail())
+	{
+		file << ToString();
+	}
+}
+
+std::string PerformanceReport::Format(const double value, const int precision)
+{
+	std::ostringstream text;
+	text << std::fixed << std::setprecision(precision) << value;
+	return text.str();
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace AlienPlanetACW
+{
+	//Plain text benchmark results, written to a file in the app's local folder
+	class PerformanceReport
+	{
+	public:
+		explicit PerformanceReport(const std::string& title);
+
+		void AddSection(const std::string& name);
+		void AddLine(const std::string& line);
+		void AddTable(const std::vector<std::string>& headings, const std::vector<std::vector<std::string>>& rows);
+		//A FAIL line where it happened, counted and listed again at the end by AddFailureSummary
+		void AddFailure(const std::string& check);
+		void AddFailureSummary();
+
+		unsigned int GetFailureCount() const { return static_cast<unsigned int>(m_failures.size()); }
+
+		std::string ToString() const;
+		void Write(const std::wstring& fileName) const;
+
+		static std::string Format(double value, int precision = 2);
+
+	private:
+		std::vector<std::string> m_lines;
+		std::vector<std::string> m_failures;
+	};
+}
@@ -89,6 +89,72 @@ bool ResourceManager::GetTexture(ID3D11Device* const device, const WCHAR* const
 	return true;
 }
 
+bool ResourceManager::CreateModel(ID3D11Device* const device, const char* const modelName, const std::vector<VertexPositionTexcoordNormalTangentBinormal>& vertices, const std::vector<unsigned long>& indices)
+{
+	if (0 != m_vertexBuffers.count(modelName))
+	{
+		return true;
+	}
+
+	if (vertices.empty() || indices.empty())
+	{
+		return false;
+	}
+
+	ID3D11Buffer* vertexBuffer;
+	ID3D11Buffer* indexBuffer;
+
+	D3D11_BUFFER_DESC vertexBufferDescription;
+	D3D11_SUBRESOURCE_DATA vertexData;
+
+	vertexBufferDescription.Usage = D3D11_USAGE_DEFAULT;
+	vertexBufferDescription.ByteWidth = sizeof(VertexPositionTexcoordNormalTangentBinormal) * vertices.size();
+	vertexBufferDescription.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	vertexBufferDescription.CPUAccessFlags = 0;
+	vertexBufferDescription.MiscFlags = 0;
+	vertexBufferDescription.StructureByteStride = 0;
+
+	vertexData.pSysMem = vertices.data();
+	vertexData.SysMemPitch = 0;
+	vertexData.SysMemSlicePitch = 0;
+
+	auto result = device->CreateBuffer(&vertexBufferDescription, &vertexData, &vertexBuffer);
+
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	D3D11_BUFFER_DESC indexBufferDescription;
+	D3D11_SUBRESOURCE_DATA indexData;
+
+	indexBufferDescription.Usage = D3D11_USAGE_DEFAULT;
+	indexBufferDescription.ByteWidth = sizeof(unsigned long) * indices.size();
+	indexBufferDescription.BindFlags = D3D11_BIND_INDEX_BUFFER;
+	indexBufferDescription.CPUAccessFlags = 0;
+	indexBufferDescription.MiscFlags = 0;
+	indexBufferDescription.StructureByteStride = 0;
+
+	indexData.pSysMem = indices.data();
+	indexData.SysMemPitch = 0;
+	indexData.SysMemSlicePitch = 0;
+
+	result = device->CreateBuffer(&indexBufferDescription, &indexData, &indexBuffer);
+
+	if (FAILED(result))
+	{
+		vertexBuffer->Release();
+		return false;
+	}
+
+	m_indexCount.insert(std::pair<const char*, int>(modelName, static_cast<int>(indices.size())));
+
+	m_vertexBuffers.insert(std::pair<const char*, ID3D11Buffer*>(modelName, vertexBuffer));
+	m_indexBuffers.insert(std::pair<const char*, ID3D11Buffer*>(modelName, indexBuffer));
+
+	return true;
+}
+
 int ResourceManager::GetSizeOfVertexType() const {
 	return sizeof(AlienPlanetACW::VertexPositionTexcoordNormalTangentBinormal);
 }
@@ -28,6 +28,9 @@ namespace AlienPlanetACW
 
 		bool GetTexture(ID3D11Device* const device, const WCHAR* const textureFileName, ID3D11ShaderResourceView* &texture);
 
+		//Uploads a mesh generated at runtime, afterwards it is fetched through GetModel like a loaded obj
+		bool CreateModel(ID3D11Device* const device, const char* const modelName, const std::vector<VertexPositionTexcoordNormalTangentBinormal>& vertices, const std::vector<unsigned long>& indices);
+
 		int GetSizeOfVertexType() const;
 		int GetIndexCount(const char* modelFileName) const;
 
@@ -0,0 +1,63 @@
+#include "pch.h"
+#include "SdfBytecode.h"
+
+#include <iomanip>
+#include <sstream>
+
+using namespace AlienPlanetACW;
+
+namespace
+{
+	const char* const opcodeNames[static_cast<unsigned int>(SdfOpcode::Count)] =
+	{
+		"translate", "scale", "twist", "mirrorRepeatXZ",
+		"sphere", "box", "roundBox", "torus", "torus82", "hexPrism", "cylinder", "cylinder6", "cylinderSegment", "cone",
+		"cappedCone", "roundCone", "roundConeSegment", "ellipsoid", "triPrism", "octahedron", "mandelbulb", "sierpinskiTetrahedron",
+		"union", "smoothUnion", "smoothSubtraction", "smoothIntersection", "lerp",
+		"scaleDistance", "colour", "wobble",
+		"return"
+	};
+}
+
+SdfProgram::SdfProgram(const std::vector<SdfInstruction>& instructions, const unsigned int pointRegisters, const unsigned int shapeRegisters) :
+	m_instructions(instructions), m_pointRegisters(pointRegisters), m_shapeRegisters(shapeRegisters)
+{
+}
+
+const char* SdfProgram::GetOpcodeName(const SdfOpcode opcode)
+{
+	return opcode < SdfOpcode::Count ? opcodeNames[static_cast<unsigned int>(opcode)] : "unknown";
+}
+
+std::string SdfProgram::Disassemble() const
+{
+	std::ostringstream text;
+
+	for (auto i = 0u; i < m_instructions.size(); i++)
+	{
+		const auto& instruction = m_instructions[i];
+		const auto opcode = static_cast<SdfOpcode>(instruction.opcode);
+
+		text << std::setw(4) << i << "  " << std::left << std::setw(22) << GetOpcodeName(opcode) << std::right;
+
+		if (opcode == SdfOpcode::Return)
+		{
+			text << "s" << instruction.a << "\n";
+			continue;
+		}
+
+		//Points are p registers, shapes are s registers
+		text << (opcode <= SdfOpcode::MirrorRepeatXZ ? "p" : "s") << instruction.destination << ", ";
+		text << (opcode <= SdfOpcode::SierpinskiTetrahedron ? "p" : "s") << instruction.a;
+
+		if ((opcode >= SdfOpcode::Union && opcode <= SdfOpcode::Lerp) || opcode == SdfOpcode::Wobble)
+		{
+			text << ", " << (opcode == SdfOpcode::Wobble ? "p" : "s") << instruction.b;
+		}
+
+		text << "  (" << instruction.c0[0] << ", " << instruction.c0[1] << ", " << instruction.c0[2] << ", " << instruction.c0[3] << ")";
+		text << " (" << instruction.c1[0] << ", " << instruction.c1[1] << ", " << instruction.c1[2] << ", " << instruction.c1[3] << ")\n";
+	}
+
+	return text.str();
+}
@@ -0,0 +1,255 @@
+#pragma once
+
+#include "SdfPrimitives.h"
+
+#include <string>
+#include <vector>
+
+namespace AlienPlanetACW
+{
+	//Operations of a compiled SdfSceneGraph. The numbers are also the SDF_OP_ defines in SdfBytecodeInterpreter.hlsli, so
+	//only ever add to the end
+	enum class SdfOpcode : unsigned int
+	{
+		//Point registers: destination = a changed by the constants
+		Translate,
+		Scale,
+		Twist,
+		//abs(x) and abs(z) folded into cells c0.x wide, the infinite shapes' domain repetition
+		MirrorRepeatXZ,
+
+		//Shape registers: destination = primitive at point a
+		Sphere,
+		Box,
+		RoundBox,
+		Torus,
+		Torus82,
+		HexPrism,
+		Cylinder,
+		Cylinder6,
+		CylinderSegment,
+		Cone,
+		CappedCone,
+		RoundCone,
+		RoundConeSegment,
+		Ellipsoid,
+		TriPrism,
+		Octahedron,
+		//The fractals come with their own colour
+		Mandelbulb,
+		SierpinskiTetrahedron,
+
+		//Shape registers: destination = a and b combined. Only Union looks at colours, the others keep b's
+		Union,
+		SmoothUnion,
+		SmoothSubtraction,
+		SmoothIntersection,
+		Lerp,
+
+		//Shape registers: destination = a changed
+		ScaleDistance,
+		Colour,
+		//The wobbly sphere's ripples at point b
+		Wobble,
+
+		//Shape register a is the scene's sample
+		Return,
+
+		Count
+	};
+
+	//48 bytes, laid out like SdfInstruction in SdfBytecodeInterpreter.hlsli so a program uploads as a structured buffer
+	struct SdfInstruction
+	{
+		unsigned int opcode;
+		unsigned int destination;
+		unsigned int a;
+		unsigned int b;
+		float c0[4];
+		float c1[4];
+	};
+
+	//A flat list of instructions over two register files, points and shapes. Point register 0 holds the sample point
+	class SdfProgram
+	{
+	public:
+		static const unsigned int MaxRegisters = 16;
+
+		SdfProgram() : m_pointRegisters(1), m_shapeRegisters(0) {}
+		SdfProgram(const std::vector<SdfInstruction>& instructions, unsigned int pointRegisters, unsigned int shapeRegisters);
+
+		template <typename T>
+		Sdf::Sample<T> Execute(const Sdf::Vec3<T>& samplePoint) const;
+
+		const std::vector<SdfInstruction>& GetInstructions() const { return m_instructions; }
+		unsigned int GetPointRegisters() const { return m_pointRegisters; }
+		unsigned int GetShapeRegisters() const { return m_shapeRegisters; }
+
+		//One line per instruction, for checking what the compiler made of a graph
+		std::string Disassemble() const;
+
+		static const char* GetOpcodeName(SdfOpcode opcode);
+
+	private:
+		std::vector<SdfInstruction> m_instructions;
+		unsigned int m_pointRegisters;
+		unsigned int m_shapeRegisters;
+	};
+
+	//The interpreter, the same switch as sceneSDFBytecode runs on the GPU. For Float8 every instruction covers eight samples
+	template <typename T>
+	Sdf::Sample<T> SdfProgram::Execute(const Sdf::Vec3<T>& samplePoint) const
+	{
+		using namespace Sdf;
+
+		Vec3<T> points[MaxRegisters];
+		T distances[MaxRegisters];
+		Vec3<T> colours[MaxRegisters];
+
+		points[0] = samplePoint;
+
+		for (const auto& instruction : m_instructions)
+		{
+			const auto* const c0 = instruction.c0;
+			const auto* const c1 = instruction.c1;
+			const auto& p = points[instruction.a];
+			auto& d = distances[instruction.destination];
+
+			switch (static_cast<SdfOpcode>(instruction.opcode))
+			{
+			case SdfOpcode::Translate:
+				points[instruction.destination] = Translate(p, c0[0], c0[1], c0[2]);
+				break;
+			case SdfOpcode::Scale:
+				points[instruction.destination] = p * c0[0];
+				break;
+			case SdfOpcode::Twist:
+				points[instruction.destination] = TwistSdf(p, c0[0]);
+				break;
+			case SdfOpcode::MirrorRepeatXZ:
+				points[instruction.destination] = Vec3<T>(Fmod(Abs(p.x) * (1.0f / c0[0]) + 0.5f, 1.0f) - 0.5f, p.y, Fmod(Abs(p.z) * (1.0f / c0[0]) + 0.5f, 1.0f) - 0.5f);
+				break;
+
+			case SdfOpcode::Sphere:
+				d = SphereSdf(p, c0[0]);
+				break;
+			case SdfOpcode::Box:
+				d = BoxSdf(p, Vec3<float>(c0[0], c0[1], c0[2]));
+				break;
+			case SdfOpcode::RoundBox:
+				d = RoundBoxSdf(p, Vec3<float>(c0[0], c0[1], c0[2]), c0[3]);
+				break;
+			case SdfOpcode::Torus:
+				d = TorusSdf(p, Vec2<float>(c0[0], c0[1]));
+				break;
+			case SdfOpcode::Torus82:
+				d = Torus82Sdf(p, Vec2<float>(c0[0], c0[1]));
+				break;
+			case SdfOpcode::HexPrism:
+				d = HexPrismSdf(p, Vec2<float>(c0[0], c0[1]));
+				break;
+			case SdfOpcode::Cylinder:
+				d = CylinderSdf(p, Vec2<float>(c0[0], c0[1]));
+				break;
+			case SdfOpcode::Cylinder6:
+				d = Cylinder6Sdf(p, Vec2<float>(c0[0], c0[1]));
+				break;
+			case SdfOpcode::CylinderSegment:
+				d = CylinderSdf(p, Vec3<float>(c0[0], c0[1], c0[2]), Vec3<float>(c1[0], c1[1], c1[2]), c0[3]);
+				break;
+			case SdfOpcode::Cone:
+				d = ConeSdf(p, Vec3<float>(c0[0], c0[1], c0[2]));
+				break;
+			case SdfOpcode::CappedCone:
+				d = CappedConeSdf(p, c0[0], c0[1], c0[2]);
+				break;
+			case SdfOpcode::RoundCone:
+				d = RoundConeSdf(p, c0[0], c0[1], c0[2]);
+				break;
+			case SdfOpcode::RoundConeSegment:
+				d = RoundConeSdf(p, Vec3<float>(c0[0], c0[1], c0[2]), Vec3<float>(c1[0], c1[1], c1[2]), c0[3], c1[3]);
+				break;
+			case SdfOpcode::Ellipsoid:
+				d = EllipsoidSdf(p, Vec3<float>(c0[0], c0[1], c0[2]));
+				break;
+			case SdfOpcode::TriPrism:
+				d = TriPrismSdf(p, Vec2<float>(c0[0], c0[1]));
+				break;
+			case SdfOpcode::Octahedron:
+				d = OctahedronSdf(p, c0[0]);
+				break;
+			case SdfOpcode::Mandelbulb:
+			{
+				float rotation[3][3];
+				MandelbulbRotation(c0[1], rotation);
+
+				const auto sample = MandelbulbSdf(p, c0[0], rotation, Vec3<float>(c1[0], c1[1], c1[2]));
+
+				d = sample.distance;
+				colours[instruction.destination] = sample.colour;
+				break;
+			}
+			case SdfOpcode::SierpinskiTetrahedron:
+			{
+				const auto sample = SierpinskiTetrahedronSdf(p);
+
+				d = sample.distance;
+				colours[instruction.destination] = sample.colour;
+				break;
+			}
+
+			case SdfOpcode::Union:
+			{
+				const auto first = distances[instruction.a] < distances[instruction.b];
+
+				d = Select(first, distances[instruction.a], distances[instruction.b]);
+				colours[instruction.destination] = Select(first, colours[instruction.a], colours[instruction.b]);
+				break;
+			}
+			case SdfOpcode::SmoothUnion:
+				d = SmoothUnion(distances[instruction.a], distances[instruction.b], c0[0]);
+				colours[instruction.destination] = colours[instruction.b];
+				break;
+			case SdfOpcode::SmoothSubtraction:
+				d = SmoothSubtraction(distances[instruction.a], distances[instruction.b], c0[0]);
+				colours[instruction.destination] = colours[instruction.b];
+				break;
+			case SdfOpcode::SmoothIntersection:
+				d = SmoothIntersection(distances[instruction.a], distances[instruction.b], c0[0]);
+				colours[instruction.destination] = colours[instruction.b];
+				break;
+			case SdfOpcode::Lerp:
+				d = Lerp(distances[instruction.a], distances[instruction.b], c0[0]);
+				colours[instruction.destination] = colours[instruction.b];
+				break;
+
+			case SdfOpcode::ScaleDistance:
+				d = distances[instruction.a] * c0[0];
+				colours[instruction.destination] = colours[instruction.a];
+				break;
+			case SdfOpcode::Colour:
+				d = distances[instruction.a];
+				colours[instruction.destination] = Vec3<T>(Vec3<float>(c0[0], c0[1], c0[2]));
+				break;
+			case SdfOpcode::Wobble:
+			{
+				const auto& q = points[instruction.b];
+				const auto wobble30 = T(0.04f) * Sin(q.x * 30.0f) * Sin(q.y * 30.0f) * Sin(q.z * 30.0f);
+				const auto wobble60 = T(0.04f) * Sin(q.x * 60.0f) * Sin(q.y * 60.0f) * Sin(q.z * 60.0f);
+
+				d = distances[instruction.a] + Lerp(wobble30, wobble60, c0[0]);
+				colours[instruction.destination] = colours[instruction.a];
+				break;
+			}
+
+			case SdfOpcode::Return:
+				return Sample<T>(distances[instruction.a], colours[instruction.a]);
+
+			default:
+				break;
+			}
+		}
+
+		return Sample<T>(T(1e10f), Vec3<T>(T(0.0f), T(0.0f), T(0.0f)));
+	}
+}
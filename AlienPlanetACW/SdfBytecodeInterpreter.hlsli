@@ -0,0 +1,162 @@
+//Interpreter for the bytecode SdfSceneGraph::Compile makes of the scene, uploaded by ImplicitRayModels each frame.
+//The opcodes and the instruction layout have to match SdfOpcode and SdfInstruction in SdfBytecode.h
+
+#define SDF_OP_TRANSLATE 0
+#define SDF_OP_SCALE 1
+#define SDF_OP_TWIST 2
+#define SDF_OP_MIRROR_REPEAT_XZ 3
+#define SDF_OP_SPHERE 4
+#define SDF_OP_BOX 5
+#define SDF_OP_ROUND_BOX 6
+#define SDF_OP_TORUS 7
+#define SDF_OP_TORUS82 8
+#define SDF_OP_HEX_PRISM 9
+#define SDF_OP_CYLINDER 10
+#define SDF_OP_CYLINDER6 11
+#define SDF_OP_CYLINDER_SEGMENT 12
+#define SDF_OP_CONE 13
+#define SDF_OP_CAPPED_CONE 14
+#define SDF_OP_ROUND_CONE 15
+#define SDF_OP_ROUND_CONE_SEGMENT 16
+#define SDF_OP_ELLIPSOID 17
+#define SDF_OP_TRI_PRISM 18
+#define SDF_OP_OCTAHEDRON 19
+#define SDF_OP_MANDELBULB 20
+#define SDF_OP_SIERPINSKI_TETRAHEDRON 21
+#define SDF_OP_UNION 22
+#define SDF_OP_SMOOTH_UNION 23
+#define SDF_OP_SMOOTH_SUBTRACTION 24
+#define SDF_OP_SMOOTH_INTERSECTION 25
+#define SDF_OP_LERP 26
+#define SDF_OP_SCALE_DISTANCE 27
+#define SDF_OP_COLOUR 28
+#define SDF_OP_WOBBLE 29
+#define SDF_OP_RETURN 30
+
+#define SDF_MAX_REGISTERS 16
+
+struct SdfInstruction
+{
+	uint opcode;
+	uint destination;
+	uint a;
+	uint b;
+	float4 c0;
+	float4 c1;
+};
+
+StructuredBuffer<SdfInstruction> sceneBytecode : register(t0);
+
+//mandelBulb with the power and rotation angle from the instruction rather than time
+float4 mandelBulbBytecode(float3 pos, float power, float angle, float3 colour)
+{
+	float c = cos(angle);
+	float s = sin(angle);
+
+	float3x3 rotMatrix = float3x3(float3(c, -s, 0.0), float3(s, c, 0.0), float3(0.0, 0.0, 1.0));
+	float3x3 rotMatrix2 = float3x3(float3(c, 0.0, -s), float3(0.0, 1.0, 0.0), float3(s, 0.0, c));
+	float3x3 rotMatrix3 = float3x3(float3(1.0, 0.0, 0.0), float3(0.0, c, -s), float3(0.0, s, c));
+
+	float3 z = mul(rotMatrix, mul(rotMatrix2, mul(rotMatrix3, pos + float3(0.0f, 0.0f, -0.5f))));
+
+	float dr = 1.0;
+	float r = 0.0;
+	for (int i = 0; i < 8; i++) {
+		r = length(z);
+		if (r > 1.5f) break;
+
+		float theta = acos(z.z / r) * power;
+		float phi = atan2(z.x, z.y) * power;
+
+		dr = pow(r, power - 1.0)*power*dr + 1.0;
+
+		z = pow(r, power) * float3(sin(theta)*cos(phi), sin(phi)*sin(theta), cos(theta));
+		z += pos;
+	}
+
+	return float4(0.5*log(r)*r / dr, colour);
+}
+
+//sceneSDF run from sceneBytecode, points and shapes (distance in x, colour in yzw) kept in separate registers
+float4 sceneSDFBytecode(float3 samplePoint)
+{
+	float3 points[SDF_MAX_REGISTERS] = (float3[SDF_MAX_REGISTERS])0;
+	float4 shapes[SDF_MAX_REGISTERS] = (float4[SDF_MAX_REGISTERS])0;
+
+	points[0] = samplePoint;
+
+	uint instructionCount;
+	uint stride;
+	sceneBytecode.GetDimensions(instructionCount, stride);
+
+	[loop]
+	for (uint i = 0; i < instructionCount; i++)
+	{
+		SdfInstruction instruction = sceneBytecode[i];
+		float3 p = points[instruction.a];
+		float4 shapeA = shapes[instruction.a];
+		float4 shapeB = shapes[instruction.b];
+		float4 c0 = instruction.c0;
+		float4 c1 = instruction.c1;
+
+		float3 movedPoint = p;
+		float4 shape = shapeA;
+
+		[branch]
+		switch (instruction.opcode)
+		{
+		case SDF_OP_TRANSLATE: movedPoint = p - c0.xyz; break;
+		case SDF_OP_SCALE: movedPoint = p * c0.x; break;
+		case SDF_OP_TWIST: movedPoint = twistSDF(p, c0.x); break;
+		case SDF_OP_MIRROR_REPEAT_XZ: movedPoint = float3(abs(p.x), p.y, abs(p.z)); movedPoint.xz = fmod(movedPoint.xz / c0.x + 0.5f, 1.0f) - 0.5f; break;
+
+		case SDF_OP_SPHERE: shape.x = sphereSDF(p, c0.x); break;
+		case SDF_OP_BOX: shape.x = boxSDF(p, c0.xyz); break;
+		case SDF_OP_ROUND_BOX: shape.x = roundBoxSDF(p, c0.xyz, c0.w); break;
+		case SDF_OP_TORUS: shape.x = torusSDF(p, c0.xy); break;
+		case SDF_OP_TORUS82: shape.x = torus82SDF(p, c0.xy); break;
+		case SDF_OP_HEX_PRISM: shape.x = hexPrismSDF(p, c0.xy); break;
+		case SDF_OP_CYLINDER: shape.x = cylinderSDF(p, c0.xy); break;
+		case SDF_OP_CYLINDER6: shape.x = cylinder6SDF(p, c0.xy); break;
+		case SDF_OP_CYLINDER_SEGMENT: shape.x = cylinderSDF(p, c0.xyz, c1.xyz, c0.w); break;
+		case SDF_OP_CONE: shape.x = coneSDF(p, c0.xyz); break;
+		case SDF_OP_CAPPED_CONE: shape.x = cappedConeSDF(p, c0.x, c0.y, c0.z); break;
+		case SDF_OP_ROUND_CONE: shape.x = roundConeSDF(p, c0.x, c0.y, c0.z); break;
+		case SDF_OP_ROUND_CONE_SEGMENT: shape.x = roundConeSDF(p, c0.xyz, c1.xyz, c0.w, c1.w); break;
+		case SDF_OP_ELLIPSOID: shape.x = ellipsoidSDF(p, c0.xyz); break;
+		case SDF_OP_TRI_PRISM: shape.x = triPrismSDF(p, c0.xy); break;
+		case SDF_OP_OCTAHEDRON: shape.x = octahedronSDF(p, c0.x); break;
+		case SDF_OP_MANDELBULB: shape = mandelBulbBytecode(p, c0.x, c0.y, c1.xyz); break;
+		case SDF_OP_SIERPINSKI_TETRAHEDRON: shape = SierpinskiTetrahedron(p); break;
+
+		case SDF_OP_UNION: shape = unionSDF(shapeA, shapeB); break;
+		case SDF_OP_SMOOTH_UNION: shape = float4(smoothUnion(shapeA.x, shapeB.x, c0.x), shapeB.yzw); break;
+		case SDF_OP_SMOOTH_SUBTRACTION: shape = float4(smoothSubtraction(shapeA.x, shapeB.x, c0.x), shapeB.yzw); break;
+		case SDF_OP_SMOOTH_INTERSECTION: shape = float4(smoothIntersection(shapeA.x, shapeB.x, c0.x), shapeB.yzw); break;
+		case SDF_OP_LERP: shape = float4(lerp(shapeA.x, shapeB.x, c0.x), shapeB.yzw); break;
+
+		case SDF_OP_SCALE_DISTANCE: shape.x = shapeA.x * c0.x; break;
+		case SDF_OP_COLOUR: shape.yzw = c0.xyz; break;
+		case SDF_OP_WOBBLE:
+		{
+			float3 q = points[instruction.b];
+			shape.x = shapeA.x + lerp((0.04*sin(30.0*q.x)*sin(30.0*q.y)*sin(30.0*q.z)), (0.04*sin(60.0*q.x)*sin(60.0*q.y)*sin(60.0*q.z)), c0.x);
+			break;
+		}
+
+		case SDF_OP_RETURN: return shapeA;
+		default: break;
+		}
+
+		if (instruction.opcode <= SDF_OP_MIRROR_REPEAT_XZ)
+		{
+			points[instruction.destination] = movedPoint;
+		}
+		else
+		{
+			shapes[instruction.destination] = shape;
+		}
+	}
+
+	return float4(1e10, 0.0f, 0.0f, 0.0f);
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "SdfMath.h"
+
+#include <utility>
+
+//Forward mode automatic differentiation for the SDF templates. A Dual is a value with its gradient with respect to the
+//sample point, so an SDF evaluated at a point from DualPoint gives the distance and the direction of the normal in one
+//pass rather than six. T is float or Float8, and everything SdfMath has for them has an overload here applying the
+//chain rule. The overloads are friends so constants convert to Duals the way they convert to Float8
+namespace AlienPlanetACW
+{
+	namespace Sdf
+	{
+		template <typename T>
+		struct Dual
+		{
+			typedef decltype(std::declval<T>() < std::declval<T>()) Mask;
+
+			T value;
+			Vec3<T> gradient;
+
+			Dual() = default;
+			Dual(const T& valueIn, const Vec3<T>& gradientIn) : value(valueIn), gradient(gradientIn) {}
+
+			//Constants, which don't change with the sample point
+			template <typename U, typename = typename std::enable_if<std::is_convertible<U, T>::value>::type>
+			Dual(const U& constant) : value(constant), gradient(T(0.0f), T(0.0f), T(0.0f)) {}
+
+			friend Dual operator+(const Dual& a, const Dual& b) { return Dual(a.value + b.value, a.gradient + b.gradient); }
+			friend Dual operator-(const Dual& a, const Dual& b) { return Dual(a.value - b.value, a.gradient - b.gradient); }
+			friend Dual operator-(const Dual& a) { return Dual(-a.value, -a.gradient); }
+
+			friend Dual operator*(const Dual& a, const Dual& b)
+			{
+				return Dual(a.value * b.value, Vec3<T>(
+					MultiplyAdd(a.gradient.x, b.value, a.value * b.gradient.x),
+					MultiplyAdd(a.gradient.y, b.value, a.value * b.gradient.y),
+					MultiplyAdd(a.gradient.z, b.value, a.value * b.gradient.z)));
+			}
+
+			friend Dual operator/(const Dual& a, const Dual& b)
+			{
+				const auto inverse = T(1.0f) / b.value;
+				const auto value = a.value * inverse;
+
+				return Dual(value, (a.gradient - b.gradient * value) * inverse);
+			}
+
+			friend Mask operator<(const Dual& a, const Dual& b) { return a.value < b.value; }
+			friend Mask operator>(const Dual& a, const Dual& b) { return a.value > b.value; }
+			friend Mask operator<=(const Dual& a, const Dual& b) { return a.value <= b.value; }
+			friend Mask operator>=(const Dual& a, const Dual& b) { return a.value >= b.value; }
+
+			friend Dual Select(const Mask& mask, const Dual& a, const Dual& b) { return Dual(Select(mask, a.value, b.value), Select(mask, a.gradient, b.gradient)); }
+
+			friend Dual MultiplyAdd(const Dual& a, const Dual& b, const Dual& c) { return a * b + c; }
+			friend Dual Min(const Dual& a, const Dual& b) { return Select(a.value < b.value, a, b); }
+			friend Dual Max(const Dual& a, const Dual& b) { return Select(a.value > b.value, a, b); }
+			friend Dual Abs(const Dual& a) { return Select(a.value < T(0.0f), -a, a); }
+
+			//The derivative is infinite at zero, where Length(Max(d, 0)) and the like take it. Their gradient is zero
+			//there, so it's kept zero rather than turned into NaN
+			friend Dual Sqrt(const Dual& a)
+			{
+				const auto value = Sqrt(a.value);
+				return Dual(value, a.gradient * Select(value > T(0.0f), T(0.5f) / value, T(0.0f)));
+			}
+
+			friend Dual Floor(const Dual& a) { return Dual(Floor(a.value)); }
+			friend Dual Trunc(const Dual& a) { return Dual(Trunc(a.value)); }
+			friend Dual Sin(const Dual& a) { return Dual(Sin(a.value), a.gradient * Cos(a.value)); }
+			friend Dual Cos(const Dual& a) { return Dual(Cos(a.value), a.gradient * -Sin(a.value)); }
+			friend Dual Log(const Dual& a) { return Dual(Log(a.value), a.gradient * (T(1.0f) / a.value)); }
+
+			friend Dual Exp(const Dual& a)
+			{
+				const auto value = Exp(a.value);
+				return Dual(value, a.gradient * value);
+			}
+
+			//Zero at the origin, where the angle has no gradient
+			friend Dual Atan2(const Dual& y, const Dual& x)
+			{
+				const auto lengthSquared = MultiplyAdd(x.value, x.value, y.value * y.value);
+				const auto inverse = Select(lengthSquared > T(0.0f), T(1.0f) / lengthSquared, T(0.0f));
+
+				return Dual(Atan2(y.value, x.value), (y.gradient * x.value - x.gradient * y.value) * inverse);
+			}
+		};
+
+		//p with the gradients of its coordinates, the axes, to evaluate the SDF at
+		template <typename T> inline Vec3<Dual<T>> DualPoint(const Vec3<T>& p)
+		{
+			const auto zero = T(0.0f);
+			const auto one = T(1.0f);
+
+			return Vec3<Dual<T>>(
+				Dual<T>(p.x, Vec3<T>(one, zero, zero)),
+				Dual<T>(p.y, Vec3<T>(zero, one, zero)),
+				Dual<T>(p.z, Vec3<T>(zero, zero, one)));
+		}
+	}
+}
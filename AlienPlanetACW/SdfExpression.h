@@ -0,0 +1,324 @@
+#pragma once
+
+#include "SdfPrimitives.h"
+
+#include <array>
+#include <utility>
+
+//Expression templates over the signed distance functions in SdfPrimitives.h. A scene written with these is a nest of
+//small structs whose type is the whole scene, so evaluating it compiles down to one inlined distance function for
+//float or Float8, the way SdfSceneGraph does at run time but with nothing left to interpret
+namespace AlienPlanetACW
+{
+	namespace Sdf
+	{
+		namespace Expressions
+		{
+			//Points, called with the sample point to give the point a primitive is evaluated at
+
+			struct SamplePoint
+			{
+				template <typename T>
+				Vec3<T> operator()(const Vec3<T>& samplePoint) const { return samplePoint; }
+			};
+
+			template <typename P>
+			struct Translated
+			{
+				P point;
+				Vec3<float> offset;
+
+				template <typename T>
+				Vec3<T> operator()(const Vec3<T>& samplePoint) const { return Sdf::Translate(point(samplePoint), offset.x, offset.y, offset.z); }
+			};
+
+			template <typename P>
+			struct Scaled
+			{
+				P point;
+				float scale;
+
+				template <typename T>
+				Vec3<T> operator()(const Vec3<T>& samplePoint) const { return point(samplePoint) * scale; }
+			};
+
+			template <typename P>
+			struct Twisted
+			{
+				P point;
+				float rep;
+
+				template <typename T>
+				Vec3<T> operator()(const Vec3<T>& samplePoint) const { return TwistSdf(point(samplePoint), rep); }
+			};
+
+			//abs(x) and abs(z) folded into cells period wide, morphingShapesSDF's repetition
+			template <typename P>
+			struct MirrorRepeatedXZ
+			{
+				P point;
+				float period;
+
+				template <typename T>
+				Vec3<T> operator()(const Vec3<T>& samplePoint) const
+				{
+					const auto p = point(samplePoint);
+					const auto scale = 1.0f / period;
+
+					return Vec3<T>(Fmod(Abs(p.x) * scale + 0.5f, 1.0f) - 0.5f, p.y, Fmod(Abs(p.z) * scale + 0.5f, 1.0f) - 0.5f);
+				}
+			};
+
+			//Distances, called with the sample point to give a distance
+
+			template <typename P, typename Shape>
+			struct Primitive
+			{
+				P point;
+				Shape shape;
+
+				template <typename T>
+				T operator()(const Vec3<T>& samplePoint) const { return shape(point(samplePoint)); }
+			};
+
+			struct SphereShape { float radius; template <typename T> T operator()(const Vec3<T>& p) const { return SphereSdf(p, radius); } };
+			struct BoxShape { Vec3<float> halfSize; template <typename T> T operator()(const Vec3<T>& p) const { return BoxSdf(p, halfSize); } };
+			struct RoundBoxShape { Vec3<float> halfSize; float radius; template <typename T> T operator()(const Vec3<T>& p) const { return RoundBoxSdf(p, halfSize, radius); } };
+			struct TorusShape { Vec2<float> radii; template <typename T> T operator()(const Vec3<T>& p) const { return TorusSdf(p, radii); } };
+			struct Torus82Shape { Vec2<float> radii; template <typename T> T operator()(const Vec3<T>& p) const { return Torus82Sdf(p, radii); } };
+			struct HexPrismShape { Vec2<float> size; template <typename T> T operator()(const Vec3<T>& p) const { return HexPrismSdf(p, size); } };
+			struct CylinderShape { Vec2<float> size; template <typename T> T operator()(const Vec3<T>& p) const { return CylinderSdf(p, size); } };
+			struct Cylinder6Shape { Vec2<float> size; template <typename T> T operator()(const Vec3<T>& p) const { return Cylinder6Sdf(p, size); } };
+			struct CylinderSegmentShape { Vec3<float> a; Vec3<float> b; float radius; template <typename T> T operator()(const Vec3<T>& p) const { return CylinderSdf(p, a, b, radius); } };
+			struct ConeShape { Vec3<float> c; template <typename T> T operator()(const Vec3<T>& p) const { return ConeSdf(p, c); } };
+			struct CappedConeShape { float height; float bottomRadius; float topRadius; template <typename T> T operator()(const Vec3<T>& p) const { return CappedConeSdf(p, height, bottomRadius, topRadius); } };
+			struct RoundConeShape { float bottomRadius; float topRadius; float height; template <typename T> T operator()(const Vec3<T>& p) const { return RoundConeSdf(p, bottomRadius, topRadius, height); } };
+			struct RoundConeSegmentShape { Vec3<float> a; Vec3<float> b; float radiusA; float radiusB; template <typename T> T operator()(const Vec3<T>& p) const { return RoundConeSdf(p, a, b, radiusA, radiusB); } };
+			struct EllipsoidShape { Vec3<float> radii; template <typename T> T operator()(const Vec3<T>& p) const { return EllipsoidSdf(p, radii); } };
+			struct TriPrismShape { Vec2<float> size; template <typename T> T operator()(const Vec3<T>& p) const { return TriPrismSdf(p, size); } };
+			struct OctahedronShape { float size; template <typename T> T operator()(const Vec3<T>& p) const { return OctahedronSdf(p, size); } };
+
+			struct SmoothUnionOperator { template <typename T> T operator()(const T& a, const T& b, const float k) const { return Sdf::SmoothUnion(a, b, k); } };
+			struct SmoothSubtractionOperator { template <typename T> T operator()(const T& a, const T& b, const float k) const { return Sdf::SmoothSubtraction(a, b, k); } };
+			struct SmoothIntersectionOperator { template <typename T> T operator()(const T& a, const T& b, const float k) const { return Sdf::SmoothIntersection(a, b, k); } };
+			struct LerpOperator { template <typename T> T operator()(const T& a, const T& b, const float t) const { return Sdf::Lerp(a, b, t); } };
+
+			template <typename A, typename B, typename Operator>
+			struct Combined
+			{
+				A a;
+				B b;
+				float k;
+
+				template <typename T>
+				T operator()(const Vec3<T>& samplePoint) const { return Operator()(a(samplePoint), b(samplePoint), k); }
+			};
+
+			//a smooth unioned with each of shapes in turn, for shapes made in a loop
+			template <typename A, typename S, std::size_t N>
+			struct SmoothUnionArray
+			{
+				A a;
+				std::array<S, N> shapes;
+				float k;
+
+				template <typename T>
+				T operator()(const Vec3<T>& samplePoint) const
+				{
+					auto distance = a(samplePoint);
+
+					for (const auto& shape : shapes)
+					{
+						distance = Sdf::SmoothUnion(distance, shape(samplePoint), k);
+					}
+
+					return distance;
+				}
+			};
+
+			//Each of cutters cut out of shape in turn
+			template <typename C, typename S, std::size_t N>
+			struct SmoothSubtractionArray
+			{
+				std::array<C, N> cutters;
+				S shape;
+				float k;
+
+				template <typename T>
+				T operator()(const Vec3<T>& samplePoint) const
+				{
+					auto distance = shape(samplePoint);
+
+					for (const auto& cutter : cutters)
+					{
+						distance = Sdf::SmoothSubtraction(cutter(samplePoint), distance, k);
+					}
+
+					return distance;
+				}
+			};
+
+			template <typename A>
+			struct ScaledDistance
+			{
+				A a;
+				float scale;
+
+				template <typename T>
+				T operator()(const Vec3<T>& samplePoint) const { return T(scale) * a(samplePoint); }
+			};
+
+			//wobblySphereSDF's ripples, blend between the 30 and 60 wobbles
+			template <typename A, typename P>
+			struct Wobbled
+			{
+				A a;
+				P point;
+				float blend;
+
+				template <typename T>
+				T operator()(const Vec3<T>& samplePoint) const
+				{
+					const auto q = point(samplePoint);
+					const auto wobble30 = T(0.04f) * Sin(q.x * 30.0f) * Sin(q.y * 30.0f) * Sin(q.z * 30.0f);
+					const auto wobble60 = T(0.04f) * Sin(q.x * 60.0f) * Sin(q.y * 60.0f) * Sin(q.z * 60.0f);
+
+					return a(samplePoint) + Sdf::Lerp(wobble30, wobble60, blend);
+				}
+			};
+
+			//Samples, called with the sample point to give a distance and colour
+
+			template <typename A>
+			struct Coloured
+			{
+				A a;
+				Vec3<float> colour;
+
+				template <typename T>
+				Sample<T> operator()(const Vec3<T>& samplePoint) const { return Sample<T>(a(samplePoint), Vec3<T>(colour)); }
+			};
+
+			template <typename P>
+			struct MandelbulbSample
+			{
+				P point;
+				float power;
+				float rotation[3][3];
+				Vec3<float> colour;
+
+				template <typename T>
+				Sample<T> operator()(const Vec3<T>& samplePoint) const { return MandelbulbSdf(point(samplePoint), power, rotation, colour); }
+			};
+
+			template <typename P>
+			struct SierpinskiTetrahedronSample
+			{
+				P point;
+
+				template <typename T>
+				Sample<T> operator()(const Vec3<T>& samplePoint) const { return SierpinskiTetrahedronSdf(point(samplePoint)); }
+			};
+
+			template <typename A, typename B>
+			struct UnionSample
+			{
+				A a;
+				B b;
+
+				template <typename T>
+				Sample<T> operator()(const Vec3<T>& samplePoint) const { return Sdf::Union(a(samplePoint), b(samplePoint)); }
+			};
+
+			//Builders, named after the SdfPrimitives.h functions they wrap
+
+			template <typename P> inline Translated<P> Translate(const P& point, const Vec3<float>& offset) { return { point, offset }; }
+			template <typename P> inline Scaled<P> Scale(const P& point, const float scale) { return { point, scale }; }
+			template <typename P> inline Twisted<P> Twist(const P& point, const float rep) { return { point, rep }; }
+			template <typename P> inline MirrorRepeatedXZ<P> MirrorRepeatXZ(const P& point, const float period) { return { point, period }; }
+
+			template <typename P> inline Primitive<P, SphereShape> Sphere(const P& point, const float radius) { return { point, { radius } }; }
+			template <typename P> inline Primitive<P, BoxShape> Box(const P& point, const Vec3<float>& halfSize) { return { point, { halfSize } }; }
+			template <typename P> inline Primitive<P, RoundBoxShape> RoundBox(const P& point, const Vec3<float>& halfSize, const float radius) { return { point, { halfSize, radius } }; }
+			template <typename P> inline Primitive<P, TorusShape> Torus(const P& point, const Vec2<float>& radii) { return { point, { radii } }; }
+			template <typename P> inline Primitive<P, Torus82Shape> Torus82(const P& point, const Vec2<float>& radii) { return { point, { radii } }; }
+			template <typename P> inline Primitive<P, HexPrismShape> HexPrism(const P& point, const Vec2<float>& size) { return { point, { size } }; }
+			template <typename P> inline Primitive<P, CylinderShape> Cylinder(const P& point, const Vec2<float>& size) { return { point, { size } }; }
+			template <typename P> inline Primitive<P, Cylinder6Shape> Cylinder6(const P& point, const Vec2<float>& size) { return { point, { size } }; }
+			template <typename P> inline Primitive<P, CylinderSegmentShape> Cylinder(const P& point, const Vec3<float>& a, const Vec3<float>& b, const float radius) { return { point, { a, b, radius } }; }
+			template <typename P> inline Primitive<P, ConeShape> Cone(const P& point, const Vec3<float>& c) { return { point, { c } }; }
+			template <typename P> inline Primitive<P, CappedConeShape> CappedCone(const P& point, const float height, const float bottomRadius, const float topRadius) { return { point, { height, bottomRadius, topRadius } }; }
+			template <typename P> inline Primitive<P, RoundConeShape> RoundCone(const P& point, const float bottomRadius, const float topRadius, const float height) { return { point, { bottomRadius, topRadius, height } }; }
+			template <typename P> inline Primitive<P, RoundConeSegmentShape> RoundCone(const P& point, const Vec3<float>& a, const Vec3<float>& b, const float radiusA, const float radiusB) { return { point, { a, b, radiusA, radiusB } }; }
+			template <typename P> inline Primitive<P, EllipsoidShape> Ellipsoid(const P& point, const Vec3<float>& radii) { return { point, { radii } }; }
+			template <typename P> inline Primitive<P, TriPrismShape> TriPrism(const P& point, const Vec2<float>& size) { return { point, { size } }; }
+			template <typename P> inline Primitive<P, OctahedronShape> Octahedron(const P& point, const float size) { return { point, { size } }; }
+
+			template <typename A, typename B> inline Combined<A, B, SmoothUnionOperator> SmoothUnion(const A& a, const B& b, const float k) { return { a, b, k }; }
+			//Cuts cutter out of shape
+			template <typename C, typename S> inline Combined<C, S, SmoothSubtractionOperator> SmoothSubtraction(const C& cutter, const S& shape, const float k) { return { cutter, shape, k }; }
+			template <typename A, typename B> inline Combined<A, B, SmoothIntersectionOperator> SmoothIntersection(const A& a, const B& b, const float k) { return { a, b, k }; }
+			template <typename A, typename B> inline Combined<A, B, LerpOperator> Lerp(const A& a, const B& b, const float t) { return { a, b, t }; }
+
+			//shape(i) for i from 0 to N - 1 unioned onto a, in order
+			template <std::size_t N, typename A, typename Generator>
+			inline SmoothUnionArray<A, decltype(std::declval<Generator>()(0u)), N> SmoothUnionEach(const A& a, const Generator& shape, const float k)
+			{
+				SmoothUnionArray<A, decltype(shape(0u)), N> result = { a, {}, k };
+
+				for (auto i = 0u; i < N; i++)
+				{
+					result.shapes[i] = shape(i);
+				}
+
+				return result;
+			}
+
+			//cutter(i) for i from 0 to N - 1 cut out of shape, in order
+			template <std::size_t N, typename Generator, typename S>
+			inline SmoothSubtractionArray<decltype(std::declval<Generator>()(0u)), S, N> SmoothSubtractionEach(const Generator& cutter, const S& shape, const float k)
+			{
+				SmoothSubtractionArray<decltype(cutter(0u)), S, N> result = { {}, shape, k };
+
+				for (auto i = 0u; i < N; i++)
+				{
+					result.cutters[i] = cutter(i);
+				}
+
+				return result;
+			}
+
+			template <typename A> inline ScaledDistance<A> ScaleDistance(const A& a, const float scale) { return { a, scale }; }
+			template <typename A, typename P> inline Wobbled<A, P> Wobble(const A& a, const P& point, const float blend) { return { a, point, blend }; }
+
+			template <typename A> inline Coloured<A> Colour(const A& a, const Vec3<float>& colour) { return { a, colour }; }
+
+			template <typename P>
+			inline MandelbulbSample<P> Mandelbulb(const P& point, const float power, const float (&rotation)[3][3], const Vec3<float>& colour)
+			{
+				MandelbulbSample<P> result = { point, power, {}, colour };
+
+				for (auto row = 0; row < 3; row++)
+				{
+					for (auto column = 0; column < 3; column++)
+					{
+						result.rotation[row][column] = rotation[row][column];
+					}
+				}
+
+				return result;
+			}
+
+			template <typename P> inline SierpinskiTetrahedronSample<P> SierpinskiTetrahedron(const P& point) { return { point }; }
+
+			//unionSDF, the nearer sample and its colour
+			template <typename A, typename B> inline UnionSample<A, B> Union(const A& a, const B& b) { return { a, b }; }
+
+			template <typename A, typename B, typename... Rest>
+			inline auto Union(const A& a, const B& b, const Rest&... rest)
+			{
+				return Union(UnionSample<A, B>{ a, b }, rest...);
+			}
+		}
+	}
+}
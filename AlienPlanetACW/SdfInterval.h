@@ -0,0 +1,87 @@
+#pragma once
+
+#include "SdfMath.h"
+
+#include <algorithm>
+#include <cmath>
+
+//Interval arithmetic for bounding an SDF over a region rather than sampling it at a point. Every operation gives a range
+//holding every value it could give for values in its operands' ranges, so a union branch whose lowest distance is above
+//another's highest can't be the nearest anywhere in the region, which is what ImplicitSceneIntervals prunes on
+namespace AlienPlanetACW
+{
+	namespace Sdf
+	{
+		struct Interval
+		{
+			float lower;
+			float upper;
+
+			Interval() = default;
+			Interval(const float lowerIn, const float upperIn) : lower(lowerIn), upper(upperIn) {}
+			//A constant, which can only be one value
+			explicit Interval(const float value) : lower(value), upper(value) {}
+
+			float GetWidth() const { return upper - lower; }
+
+			friend Interval operator+(const Interval& a, const Interval& b) { return Interval(a.lower + b.lower, a.upper + b.upper); }
+			friend Interval operator-(const Interval& a, const Interval& b) { return Interval(a.lower - b.upper, a.upper - b.lower); }
+			friend Interval operator-(const Interval& a) { return Interval(-a.upper, -a.lower); }
+
+			friend Interval operator+(const Interval& a, const float b) { return Interval(a.lower + b, a.upper + b); }
+			friend Interval operator-(const Interval& a, const float b) { return Interval(a.lower - b, a.upper - b); }
+			friend Interval operator-(const float a, const Interval& b) { return Interval(a - b.upper, a - b.lower); }
+
+			//A negative scale swaps the ends over
+			friend Interval operator*(const Interval& a, const float b) { return b >= 0.0f ? Interval(a.lower * b, a.upper * b) : Interval(a.upper * b, a.lower * b); }
+
+			friend Interval operator*(const Interval& a, const Interval& b)
+			{
+				const auto ll = a.lower * b.lower;
+				const auto lu = a.lower * b.upper;
+				const auto ul = a.upper * b.lower;
+				const auto uu = a.upper * b.upper;
+
+				return Interval(std::min(std::min(ll, lu), std::min(ul, uu)), std::max(std::max(ll, lu), std::max(ul, uu)));
+			}
+		};
+
+		inline Interval Min(const Interval& a, const Interval& b) { return Interval(std::min(a.lower, b.lower), std::min(a.upper, b.upper)); }
+		inline Interval Max(const Interval& a, const Interval& b) { return Interval(std::max(a.lower, b.lower), std::max(a.upper, b.upper)); }
+
+		inline Interval Abs(const Interval& a)
+		{
+			if (a.lower >= 0.0f)
+			{
+				return a;
+			}
+
+			if (a.upper <= 0.0f)
+			{
+				return -a;
+			}
+
+			return Interval(0.0f, std::max(-a.lower, a.upper));
+		}
+
+		//Tighter than a * a, which doesn't know both sides are the same value
+		inline Interval Square(const Interval& a)
+		{
+			const auto magnitude = Abs(a);
+			return Interval(magnitude.lower * magnitude.lower, magnitude.upper * magnitude.upper);
+		}
+
+		inline Interval Sqrt(const Interval& a) { return Interval(std::sqrt(std::max(a.lower, 0.0f)), std::sqrt(std::max(a.upper, 0.0f))); }
+
+		//Both bounds hold, so the answer is in the overlap
+		inline Interval Intersect(const Interval& a, const Interval& b) { return Interval(std::max(a.lower, b.lower), std::min(a.upper, b.upper)); }
+
+		inline Interval Length(const Vec3<Interval>& v) { return Sqrt(Square(v.x) + Square(v.y) + Square(v.z)); }
+
+		//Every point within radius of centre, as a box
+		inline Vec3<Interval> IntervalBox(const Vec3<float>& centre, const float radius)
+		{
+			return Vec3<Interval>(Interval(centre.x - radius, centre.x + radius), Interval(centre.y - radius, centre.y + radius), Interval(centre.z - radius, centre.z + radius));
+		}
+	}
+}
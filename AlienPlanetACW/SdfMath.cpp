@@ -0,0 +1,236 @@
+#include "pch.h"
+#include "SdfMath.h"
+
+#if defined(SDF_MATH_AVX2)
+#include <intrin.h>
+#endif
+
+using namespace AlienPlanetACW;
+
+#if defined(SDF_MATH_AVX2)
+namespace
+{
+	//AVX2 and FMA in the CPU, and the OS saving the upper halves of the registers across context switches
+	bool DetectAvx2()
+	{
+		int info[4];
+
+		__cpuid(info, 0);
+
+		if (info[0] < 7)
+		{
+			return false;
+		}
+
+		__cpuid(info, 1);
+
+		const auto fma = (info[2] & (1 << 12)) != 0;
+		const auto osxsave = (info[2] & (1 << 27)) != 0;
+		const auto avx = (info[2] & (1 << 28)) != 0;
+
+		if (!fma || !osxsave || !avx || (_xgetbv(0) & 6) != 6)
+		{
+			return false;
+		}
+
+		__cpuidex(info, 7, 0);
+
+		return (info[1] & (1 << 5)) != 0;
+	}
+
+	inline __m256 Splat(const float value)
+	{
+		return _mm256_set1_ps(value);
+	}
+
+	inline __m256i SplatInt(const int value)
+	{
+		return _mm256_set1_epi32(value);
+	}
+
+	//Sine and cosine share the reduction by pi / 4 and pick between the two polynomials per octant
+	void SinCosPolynomials(const __m256 x, __m256& sine, __m256& cosine)
+	{
+		const auto z = _mm256_mul_ps(x, x);
+
+		auto c = Splat(2.443315711809948e-5f);
+		c = _mm256_fmadd_ps(c, z, Splat(-1.388731625493765e-3f));
+		c = _mm256_fmadd_ps(c, z, Splat(4.166664568298827e-2f));
+		c = _mm256_mul_ps(_mm256_mul_ps(c, z), z);
+		c = _mm256_fnmadd_ps(Splat(0.5f), z, c);
+		cosine = _mm256_add_ps(c, Splat(1.0f));
+
+		auto s = Splat(-1.9515295891e-4f);
+		s = _mm256_fmadd_ps(s, z, Splat(8.3321608736e-3f));
+		s = _mm256_fmadd_ps(s, z, Splat(-1.6666654611e-1f));
+		sine = _mm256_fmadd_ps(_mm256_mul_ps(s, z), x, x);
+	}
+
+	//|x| reduced to [-pi / 4, pi / 4] with the octant j, pi / 4 split in three so large arguments stay accurate
+	__m256 ReduceQuarterPi(const __m256 absX, __m256i& j)
+	{
+		j = _mm256_cvttps_epi32(_mm256_mul_ps(absX, Splat(1.27323954473516f)));
+		j = _mm256_and_si256(_mm256_add_epi32(j, SplatInt(1)), SplatInt(~1));
+
+		const auto y = _mm256_cvtepi32_ps(j);
+
+		auto x = _mm256_fnmadd_ps(y, Splat(0.78515625f), absX);
+		x = _mm256_fnmadd_ps(y, Splat(2.4187564849853515625e-4f), x);
+		x = _mm256_fnmadd_ps(y, Splat(3.77489497744594108e-8f), x);
+
+		return x;
+	}
+
+	__m256 Atan(const __m256 value)
+	{
+		const auto signBit = _mm256_and_ps(value, Splat(-0.0f));
+		auto x = _mm256_andnot_ps(Splat(-0.0f), value);
+
+		//Above tan(3 pi / 8) use pi / 2 - atan(1 / x), above tan(pi / 8) use pi / 4 + atan((x - 1) / (x + 1))
+		const auto large = _mm256_cmp_ps(x, Splat(2.414213562373095f), _CMP_GT_OQ);
+		const auto medium = _mm256_andnot_ps(large, _mm256_cmp_ps(x, Splat(0.4142135623730950f), _CMP_GT_OQ));
+
+		auto offset = _mm256_blendv_ps(_mm256_setzero_ps(), Splat(0.785398163397448f), medium);
+		offset = _mm256_blendv_ps(offset, Splat(1.570796326794897f), large);
+
+		x = _mm256_blendv_ps(x, _mm256_div_ps(_mm256_sub_ps(x, Splat(1.0f)), _mm256_add_ps(x, Splat(1.0f))), medium);
+		x = _mm256_blendv_ps(x, _mm256_div_ps(Splat(-1.0f), x), large);
+
+		const auto z = _mm256_mul_ps(x, x);
+
+		auto y = Splat(8.05374449538e-2f);
+		y = _mm256_fmadd_ps(y, z, Splat(-1.38776856032e-1f));
+		y = _mm256_fmadd_ps(y, z, Splat(1.99777106478e-1f));
+		y = _mm256_fmadd_ps(y, z, Splat(-3.33329491539e-1f));
+		y = _mm256_fmadd_ps(_mm256_mul_ps(y, z), x, x);
+
+		return _mm256_xor_ps(_mm256_add_ps(offset, y), signBit);
+	}
+}
+
+bool Sdf::IsFloat8Supported()
+{
+	static const auto supported = DetectAvx2();
+
+	return supported;
+}
+
+Sdf::Float8 Sdf::Sin(const Float8& a)
+{
+	auto signBit = _mm256_and_ps(a.v, Splat(-0.0f));
+
+	__m256i j;
+	const auto x = ReduceQuarterPi(_mm256_andnot_ps(Splat(-0.0f), a.v), j);
+
+	//Octants 4 to 7 flip the sign, and 2, 3, 6 and 7 use the cosine polynomial
+	signBit = _mm256_xor_ps(signBit, _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(j, SplatInt(4)), 29)));
+	const auto useSine = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(j, SplatInt(2)), _mm256_setzero_si256()));
+
+	__m256 sine, cosine;
+	SinCosPolynomials(x, sine, cosine);
+
+	return Float8(_mm256_xor_ps(_mm256_blendv_ps(cosine, sine, useSine), signBit));
+}
+
+Sdf::Float8 Sdf::Cos(const Float8& a)
+{
+	__m256i j;
+	const auto x = ReduceQuarterPi(_mm256_andnot_ps(Splat(-0.0f), a.v), j);
+
+	//Cosine is the sine two octants on
+	j = _mm256_sub_epi32(j, SplatInt(2));
+
+	const auto signBit = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_andnot_si256(j, SplatInt(4)), 29));
+	const auto useSine = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(j, SplatInt(2)), _mm256_setzero_si256()));
+
+	__m256 sine, cosine;
+	SinCosPolynomials(x, sine, cosine);
+
+	return Float8(_mm256_xor_ps(_mm256_blendv_ps(cosine, sine, useSine), signBit));
+}
+
+Sdf::Float8 Sdf::Atan2(const Float8& y, const Float8& x)
+{
+	auto result = Atan(_mm256_div_ps(y.v, x.v));
+
+	//Left half plane adds or takes pi depending on the side of the x axis
+	const auto negativeX = _mm256_cmp_ps(x.v, _mm256_setzero_ps(), _CMP_LT_OQ);
+	const auto quadrant = _mm256_blendv_ps(Splat(-3.141592653589793f), Splat(3.141592653589793f), _mm256_cmp_ps(y.v, _mm256_setzero_ps(), _CMP_GE_OQ));
+
+	result = _mm256_blendv_ps(result, _mm256_add_ps(result, quadrant), negativeX);
+
+	//atan2(0, 0) is 0 rather than the NaN from 0 / 0
+	const auto origin = _mm256_and_ps(_mm256_cmp_ps(x.v, _mm256_setzero_ps(), _CMP_EQ_OQ), _mm256_cmp_ps(y.v, _mm256_setzero_ps(), _CMP_EQ_OQ));
+
+	return Float8(_mm256_blendv_ps(result, _mm256_setzero_ps(), origin));
+}
+
+Sdf::Float8 Sdf::Log(const Float8& a)
+{
+	const auto bits = _mm256_castps_si256(a.v);
+
+	//a = m * 2^e with m in [0.5, 1), then m is moved to [sqrt(0.5), sqrt(2)) so the polynomial works around 1
+	auto e = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), SplatInt(126)));
+	auto m = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, SplatInt(0x807FFFFF)), SplatInt(0x3F000000)));
+
+	const auto small = _mm256_cmp_ps(m, Splat(0.707106781186547524f), _CMP_LT_OQ);
+
+	e = _mm256_sub_ps(e, _mm256_and_ps(Splat(1.0f), small));
+	m = _mm256_sub_ps(_mm256_add_ps(m, _mm256_and_ps(m, small)), Splat(1.0f));
+
+	const auto z = _mm256_mul_ps(m, m);
+
+	auto y = Splat(7.0376836292e-2f);
+	y = _mm256_fmadd_ps(y, m, Splat(-1.1514610310e-1f));
+	y = _mm256_fmadd_ps(y, m, Splat(1.1676998740e-1f));
+	y = _mm256_fmadd_ps(y, m, Splat(-1.2420140846e-1f));
+	y = _mm256_fmadd_ps(y, m, Splat(1.4249322787e-1f));
+	y = _mm256_fmadd_ps(y, m, Splat(-1.6668057665e-1f));
+	y = _mm256_fmadd_ps(y, m, Splat(2.0000714765e-1f));
+	y = _mm256_fmadd_ps(y, m, Splat(-2.4999993993e-1f));
+	y = _mm256_fmadd_ps(y, m, Splat(3.3333331174e-1f));
+	y = _mm256_mul_ps(_mm256_mul_ps(y, m), z);
+
+	y = _mm256_fmadd_ps(e, Splat(-2.12194440e-4f), y);
+	y = _mm256_fnmadd_ps(Splat(0.5f), z, y);
+
+	auto result = _mm256_add_ps(m, y);
+	result = _mm256_fmadd_ps(e, Splat(0.693359375f), result);
+
+	//Zero gives -infinity and negatives NaN, like the scalar log
+	result = _mm256_blendv_ps(result, Splat(-INFINITY), _mm256_cmp_ps(a.v, _mm256_setzero_ps(), _CMP_EQ_OQ));
+	result = _mm256_blendv_ps(result, Splat(NAN), _mm256_cmp_ps(a.v, _mm256_setzero_ps(), _CMP_LT_OQ));
+
+	return Float8(result);
+}
+
+Sdf::Float8 Sdf::Exp(const Float8& a)
+{
+	auto x = _mm256_min_ps(_mm256_max_ps(a.v, Splat(-87.3365447505531f)), Splat(88.3762626647949f));
+
+	//e^x = 2^n * e^r with n = round(x / ln 2), ln 2 split in two so r stays exact
+	const auto n = _mm256_floor_ps(_mm256_fmadd_ps(x, Splat(1.44269504088896341f), Splat(0.5f)));
+
+	x = _mm256_fnmadd_ps(n, Splat(0.693359375f), x);
+	x = _mm256_fnmadd_ps(n, Splat(-2.12194440e-4f), x);
+
+	const auto z = _mm256_mul_ps(x, x);
+
+	auto y = Splat(1.9875691500e-4f);
+	y = _mm256_fmadd_ps(y, x, Splat(1.3981999507e-3f));
+	y = _mm256_fmadd_ps(y, x, Splat(8.3334519073e-3f));
+	y = _mm256_fmadd_ps(y, x, Splat(4.1665795894e-2f));
+	y = _mm256_fmadd_ps(y, x, Splat(1.6666665459e-1f));
+	y = _mm256_fmadd_ps(y, x, Splat(5.0000001201e-1f));
+	y = _mm256_fmadd_ps(y, z, _mm256_add_ps(x, Splat(1.0f)));
+
+	const auto scale = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), SplatInt(127)), 23));
+
+	return Float8(_mm256_mul_ps(y, scale));
+}
+#else
+bool Sdf::IsFloat8Supported()
+{
+	return true;
+}
+#endif
@@ -0,0 +1,247 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(_M_IX86) || defined(_M_X64)
+#define SDF_MATH_AVX2
+#include <immintrin.h>
+#endif
+
+//Math for evaluating signed distance functions either one sample at a time with float, or eight at a time with Float8.
+//Everything the SDF code uses has an overload for both, so the scene is written once as a template. On x86 and x64
+//Float8 is one AVX register and needs AVX2 and FMA, which IsFloat8Supported checks. Elsewhere it's eight floats in a
+//loop and always supported. Float8 and Mask8 go by reference since x86 can't pass 32 byte aligned arguments by value
+namespace AlienPlanetACW
+{
+	namespace Sdf
+	{
+		bool IsFloat8Supported();
+
+#if defined(SDF_MATH_AVX2)
+		struct Mask8
+		{
+			__m256 v;
+		};
+
+		struct Float8
+		{
+			__m256 v;
+
+			Float8() = default;
+			Float8(const float value) : v(_mm256_set1_ps(value)) {}
+			explicit Float8(const __m256& value) : v(value) {}
+
+			static Float8 Load(const float* const values) { return Float8(_mm256_loadu_ps(values)); }
+			void Store(float* const values) const { _mm256_storeu_ps(values, v); }
+		};
+
+		inline Float8 operator+(const Float8& a, const Float8& b) { return Float8(_mm256_add_ps(a.v, b.v)); }
+		inline Float8 operator-(const Float8& a, const Float8& b) { return Float8(_mm256_sub_ps(a.v, b.v)); }
+		inline Float8 operator*(const Float8& a, const Float8& b) { return Float8(_mm256_mul_ps(a.v, b.v)); }
+		inline Float8 operator/(const Float8& a, const Float8& b) { return Float8(_mm256_div_ps(a.v, b.v)); }
+		inline Float8 operator-(const Float8& a) { return Float8(_mm256_xor_ps(a.v, _mm256_set1_ps(-0.0f))); }
+
+		inline Mask8 operator<(const Float8& a, const Float8& b) { return Mask8{ _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ) }; }
+		inline Mask8 operator>(const Float8& a, const Float8& b) { return Mask8{ _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ) }; }
+		inline Mask8 operator<=(const Float8& a, const Float8& b) { return Mask8{ _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ) }; }
+		inline Mask8 operator>=(const Float8& a, const Float8& b) { return Mask8{ _mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ) }; }
+
+		inline Mask8 And(const Mask8& a, const Mask8& b) { return Mask8{ _mm256_and_ps(a.v, b.v) }; }
+		inline Mask8 Or(const Mask8& a, const Mask8& b) { return Mask8{ _mm256_or_ps(a.v, b.v) }; }
+		inline Mask8 AndNot(const Mask8& a, const Mask8& b) { return Mask8{ _mm256_andnot_ps(b.v, a.v) }; }
+		inline Mask8 Not(const Mask8& a) { return Mask8{ _mm256_xor_ps(a.v, _mm256_castsi256_ps(_mm256_set1_epi32(-1))) }; }
+		inline bool Any(const Mask8& a) { return _mm256_movemask_ps(a.v) != 0; }
+		inline bool All(const Mask8& a) { return _mm256_movemask_ps(a.v) == 0xFF; }
+		inline unsigned int Bits(const Mask8& a) { return static_cast<unsigned int>(_mm256_movemask_ps(a.v)); }
+
+		inline Mask8 MaskFromBits(const unsigned int bits)
+		{
+			const auto lanes = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+			return Mask8{ _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(static_cast<int>(bits)), lanes), lanes)) };
+		}
+
+		//Lanes where mask is set come from a, the rest from b
+		inline Float8 Select(const Mask8& mask, const Float8& a, const Float8& b) { return Float8(_mm256_blendv_ps(b.v, a.v, mask.v)); }
+
+		inline Float8 MultiplyAdd(const Float8& a, const Float8& b, const Float8& c) { return Float8(_mm256_fmadd_ps(a.v, b.v, c.v)); }
+		inline Float8 Min(const Float8& a, const Float8& b) { return Float8(_mm256_min_ps(a.v, b.v)); }
+		inline Float8 Max(const Float8& a, const Float8& b) { return Float8(_mm256_max_ps(a.v, b.v)); }
+		inline Float8 Abs(const Float8& a) { return Float8(_mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v)); }
+		inline Float8 Sqrt(const Float8& a) { return Float8(_mm256_sqrt_ps(a.v)); }
+		inline Float8 Floor(const Float8& a) { return Float8(_mm256_floor_ps(a.v)); }
+		inline Float8 Trunc(const Float8& a) { return Float8(_mm256_round_ps(a.v, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC)); }
+
+		//Polynomial approximations after Cephes, accurate to a few ulp over the ranges the scene uses
+		Float8 Sin(const Float8& a);
+		Float8 Cos(const Float8& a);
+		Float8 Atan2(const Float8& y, const Float8& x);
+		Float8 Log(const Float8& a);
+		Float8 Exp(const Float8& a);
+#else
+		struct Mask8
+		{
+			bool v[8];
+		};
+
+		struct Float8
+		{
+			float v[8];
+
+			Float8() = default;
+			Float8(const float value) { for (auto i = 0; i < 8; i++) v[i] = value; }
+
+			static Float8 Load(const float* const values) { Float8 result; for (auto i = 0; i < 8; i++) result.v[i] = values[i]; return result; }
+			void Store(float* const values) const { for (auto i = 0; i < 8; i++) values[i] = v[i]; }
+		};
+
+		template <typename Function>
+		inline Float8 PerLane(const Float8 a, const Float8 b, Function function) { Float8 result; for (auto i = 0; i < 8; i++) result.v[i] = function(a.v[i], b.v[i]); return result; }
+
+		template <typename Function>
+		inline Mask8 CompareLanes(const Float8 a, const Float8 b, Function function) { Mask8 result; for (auto i = 0; i < 8; i++) result.v[i] = function(a.v[i], b.v[i]); return result; }
+
+		inline Float8 operator+(const Float8 a, const Float8 b) { return PerLane(a, b, [](float x, float y) { return x + y; }); }
+		inline Float8 operator-(const Float8 a, const Float8 b) { return PerLane(a, b, [](float x, float y) { return x - y; }); }
+		inline Float8 operator*(const Float8 a, const Float8 b) { return PerLane(a, b, [](float x, float y) { return x * y; }); }
+		inline Float8 operator/(const Float8 a, const Float8 b) { return PerLane(a, b, [](float x, float y) { return x / y; }); }
+		inline Float8 operator-(const Float8 a) { return PerLane(a, a, [](float x, float) { return -x; }); }
+
+		inline Mask8 operator<(const Float8 a, const Float8 b) { return CompareLanes(a, b, [](float x, float y) { return x < y; }); }
+		inline Mask8 operator>(const Float8 a, const Float8 b) { return CompareLanes(a, b, [](float x, float y) { return x > y; }); }
+		inline Mask8 operator<=(const Float8 a, const Float8 b) { return CompareLanes(a, b, [](float x, float y) { return x <= y; }); }
+		inline Mask8 operator>=(const Float8 a, const Float8 b) { return CompareLanes(a, b, [](float x, float y) { return x >= y; }); }
+
+		inline Mask8 And(const Mask8 a, const Mask8 b) { Mask8 result; for (auto i = 0; i < 8; i++) result.v[i] = a.v[i] && b.v[i]; return result; }
+		inline Mask8 Or(const Mask8 a, const Mask8 b) { Mask8 result; for (auto i = 0; i < 8; i++) result.v[i] = a.v[i] || b.v[i]; return result; }
+		inline Mask8 AndNot(const Mask8 a, const Mask8 b) { Mask8 result; for (auto i = 0; i < 8; i++) result.v[i] = a.v[i] && !b.v[i]; return result; }
+		inline Mask8 Not(const Mask8 a) { Mask8 result; for (auto i = 0; i < 8; i++) result.v[i] = !a.v[i]; return result; }
+		inline unsigned int Bits(const Mask8 a) { auto bits = 0u; for (auto i = 0; i < 8; i++) bits |= a.v[i] ? 1u << i : 0u; return bits; }
+		inline bool Any(const Mask8 a) { return Bits(a) != 0; }
+		inline bool All(const Mask8 a) { return Bits(a) == 0xFF; }
+		inline Mask8 MaskFromBits(const unsigned int bits) { Mask8 result; for (auto i = 0; i < 8; i++) result.v[i] = (bits & (1u << i)) != 0; return result; }
+
+		inline Float8 Select(const Mask8 mask, const Float8 a, const Float8 b) { Float8 result; for (auto i = 0; i < 8; i++) result.v[i] = mask.v[i] ? a.v[i] : b.v[i]; return result; }
+
+		inline Float8 MultiplyAdd(const Float8 a, const Float8 b, const Float8 c) { return a * b + c; }
+		inline Float8 Min(const Float8 a, const Float8 b) { return PerLane(a, b, [](float x, float y) { return x < y ? x : y; }); }
+		inline Float8 Max(const Float8 a, const Float8 b) { return PerLane(a, b, [](float x, float y) { return x > y ? x : y; }); }
+		inline Float8 Abs(const Float8 a) { return PerLane(a, a, [](float x, float) { return std::abs(x); }); }
+		inline Float8 Sqrt(const Float8 a) { return PerLane(a, a, [](float x, float) { return std::sqrt(x); }); }
+		inline Float8 Floor(const Float8 a) { return PerLane(a, a, [](float x, float) { return std::floor(x); }); }
+		inline Float8 Trunc(const Float8 a) { return PerLane(a, a, [](float x, float) { return std::trunc(x); }); }
+		inline Float8 Sin(const Float8 a) { return PerLane(a, a, [](float x, float) { return std::sin(x); }); }
+		inline Float8 Cos(const Float8 a) { return PerLane(a, a, [](float x, float) { return std::cos(x); }); }
+		inline Float8 Atan2(const Float8 y, const Float8 x) { return PerLane(y, x, [](float a, float b) { return std::atan2(a, b); }); }
+		inline Float8 Log(const Float8 a) { return PerLane(a, a, [](float x, float) { return std::log(x); }); }
+		inline Float8 Exp(const Float8 a) { return PerLane(a, a, [](float x, float) { return std::exp(x); }); }
+#endif
+
+		inline float Lane(const Float8& a, const unsigned int lane)
+		{
+			float values[8];
+			a.Store(values);
+			return values[lane];
+		}
+
+		//Scalar overloads, so the same template code runs one sample at a time
+		inline bool And(const bool a, const bool b) { return a && b; }
+		inline bool Or(const bool a, const bool b) { return a || b; }
+		inline bool AndNot(const bool a, const bool b) { return a && !b; }
+		inline bool Not(const bool a) { return !a; }
+		inline bool Any(const bool a) { return a; }
+		inline bool All(const bool a) { return a; }
+		inline unsigned int Bits(const bool a) { return a ? 1u : 0u; }
+
+		inline float Select(const bool mask, const float a, const float b) { return mask ? a : b; }
+		inline float MultiplyAdd(const float a, const float b, const float c) { return a * b + c; }
+		inline float Min(const float a, const float b) { return a < b ? a : b; }
+		inline float Max(const float a, const float b) { return a > b ? a : b; }
+		inline float Abs(const float a) { return std::abs(a); }
+		inline float Sqrt(const float a) { return std::sqrt(a); }
+		inline float Floor(const float a) { return std::floor(a); }
+		inline float Trunc(const float a) { return std::trunc(a); }
+		inline float Sin(const float a) { return std::sin(a); }
+		inline float Cos(const float a) { return std::cos(a); }
+		inline float Atan2(const float y, const float x) { return std::atan2(y, x); }
+		inline float Log(const float a) { return std::log(a); }
+		inline float Exp(const float a) { return std::exp(a); }
+
+		//Only the first argument picks the type, so constants and per-frame floats mix freely with Float8
+		template <typename T> struct Identity { typedef T Type; };
+
+		//HLSL intrinsics built from the above
+		template <typename T> inline T Clamp(const T& a, const typename Identity<T>::Type& low, const typename Identity<T>::Type& high) { return Min(Max(a, low), high); }
+		template <typename T> inline T Saturate(const T& a) { return Clamp(a, T(0.0f), T(1.0f)); }
+		template <typename T> inline T Lerp(const T& a, const typename Identity<T>::Type& b, const typename Identity<T>::Type& t) { return MultiplyAdd(b - a, t, a); }
+		template <typename T> inline T Sign(const T& a) { return Select(a > T(0.0f), T(1.0f), Select(a < T(0.0f), T(-1.0f), T(0.0f))); }
+
+		//Truncating like HLSL fmod, so the result takes the sign of a
+		template <typename T> inline T Fmod(const T& a, const typename Identity<T>::Type& b) { return a - b * Trunc(a / b); }
+
+		//HLSL pow is only defined for a >= 0, zero stays zero
+		template <typename T> inline T Pow(const T& a, const typename Identity<T>::Type& b) { return Select(a > T(0.0f), Exp(b * Log(Max(a, T(1e-30f)))), T(0.0f)); }
+
+		//Clamped so rounding just past one doesn't turn into NaN
+		template <typename T> inline T Acos(const T& a)
+		{
+			const auto x = Clamp(a, T(-1.0f), T(1.0f));
+			return Atan2(Sqrt((T(1.0f) - x) * (T(1.0f) + x)), x);
+		}
+
+		template <typename T>
+		struct Vec2
+		{
+			T x, y;
+
+			Vec2() = default;
+			Vec2(const T& xValue, const T& yValue) : x(xValue), y(yValue) {}
+		};
+
+		template <typename T>
+		struct Vec3
+		{
+			T x, y, z;
+
+			Vec3() = default;
+			Vec3(const T& xValue, const T& yValue, const T& zValue) : x(xValue), y(yValue), z(zValue) {}
+
+			//Broadcasts a constant vector into every lane
+			template <typename U, typename = typename std::enable_if<!std::is_same<U, T>::value>::type>
+			Vec3(const Vec3<U>& other) : x(other.x), y(other.y), z(other.z) {}
+		};
+
+		template <typename T> inline Vec2<T> operator+(const Vec2<T>& a, const Vec2<T>& b) { return Vec2<T>(a.x + b.x, a.y + b.y); }
+		template <typename T> inline Vec2<T> operator-(const Vec2<T>& a, const Vec2<T>& b) { return Vec2<T>(a.x - b.x, a.y - b.y); }
+		template <typename T> inline Vec2<T> operator*(const Vec2<T>& a, const Vec2<T>& b) { return Vec2<T>(a.x * b.x, a.y * b.y); }
+		template <typename T> inline Vec2<T> operator*(const Vec2<T>& a, const typename Identity<T>::Type& b) { return Vec2<T>(a.x * b, a.y * b); }
+		template <typename T> inline Vec2<T> operator/(const Vec2<T>& a, const typename Identity<T>::Type& b) { return Vec2<T>(a.x / b, a.y / b); }
+		template <typename T> inline T Dot(const Vec2<T>& a, const Vec2<T>& b) { return MultiplyAdd(a.x, b.x, a.y * b.y); }
+		template <typename T> inline T Length(const Vec2<T>& a) { return Sqrt(Dot(a, a)); }
+		template <typename T> inline Vec2<T> Abs(const Vec2<T>& a) { return Vec2<T>(Abs(a.x), Abs(a.y)); }
+		template <typename T> inline Vec2<T> Max(const Vec2<T>& a, const typename Identity<T>::Type& b) { return Vec2<T>(Max(a.x, b), Max(a.y, b)); }
+
+		template <typename T> inline Vec3<T> operator+(const Vec3<T>& a, const Vec3<T>& b) { return Vec3<T>(a.x + b.x, a.y + b.y, a.z + b.z); }
+		template <typename T> inline Vec3<T> operator-(const Vec3<T>& a, const Vec3<T>& b) { return Vec3<T>(a.x - b.x, a.y - b.y, a.z - b.z); }
+		template <typename T> inline Vec3<T> operator-(const Vec3<T>& a) { return Vec3<T>(-a.x, -a.y, -a.z); }
+		template <typename T> inline Vec3<T> operator*(const Vec3<T>& a, const Vec3<T>& b) { return Vec3<T>(a.x * b.x, a.y * b.y, a.z * b.z); }
+		template <typename T> inline Vec3<T> operator*(const Vec3<T>& a, const typename Identity<T>::Type& b) { return Vec3<T>(a.x * b, a.y * b, a.z * b); }
+		template <typename T> inline Vec3<T> operator*(const typename Identity<T>::Type& a, const Vec3<T>& b) { return Vec3<T>(a * b.x, a * b.y, a * b.z); }
+		template <typename T> inline Vec3<T> operator/(const Vec3<T>& a, const Vec3<T>& b) { return Vec3<T>(a.x / b.x, a.y / b.y, a.z / b.z); }
+		template <typename T> inline T Dot(const Vec3<T>& a, const Vec3<T>& b) { return MultiplyAdd(a.x, b.x, MultiplyAdd(a.y, b.y, a.z * b.z)); }
+		template <typename T> inline T Length(const Vec3<T>& a) { return Sqrt(Dot(a, a)); }
+		template <typename T> inline Vec3<T> Normalize(const Vec3<T>& a) { const auto invLength = T(1.0f) / Length(a); return a * invLength; }
+		template <typename T> inline Vec3<T> Abs(const Vec3<T>& a) { return Vec3<T>(Abs(a.x), Abs(a.y), Abs(a.z)); }
+		template <typename T> inline Vec3<T> Max(const Vec3<T>& a, const typename Identity<T>::Type& b) { return Vec3<T>(Max(a.x, b), Max(a.y, b), Max(a.z, b)); }
+		template <typename T> inline Vec3<T> Saturate(const Vec3<T>& a) { return Vec3<T>(Saturate(a.x), Saturate(a.y), Saturate(a.z)); }
+		template <typename T> inline Vec3<T> Lerp(const Vec3<T>& a, const Vec3<T>& b, const typename Identity<T>::Type& t) { return Vec3<T>(Lerp(a.x, b.x, t), Lerp(a.y, b.y, t), Lerp(a.z, b.z, t)); }
+
+		template <typename M, typename T> inline Vec3<T> Select(const M& mask, const Vec3<T>& a, const Vec3<T>& b) { return Vec3<T>(Select(mask, a.x, b.x), Select(mask, a.y, b.y), Select(mask, a.z, b.z)); }
+		template <typename M, typename T> inline Vec2<T> Select(const M& mask, const Vec2<T>& a, const Vec2<T>& b) { return Vec2<T>(Select(mask, a.x, b.x), Select(mask, a.y, b.y)); }
+
+		//reflect(i, n) from HLSL
+		template <typename T> inline Vec3<T> Reflect(const Vec3<T>& i, const Vec3<T>& n) { return i - n * (T(2.0f) * Dot(n, i)); }
+	}
+}
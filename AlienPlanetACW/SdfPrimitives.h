@@ -0,0 +1,522 @@
+#pragma once
+
+#include "SdfMath.h"
+
+//The signed distance functions from ImplicitRayModelsPS.hlsl, for float or Float8 samples. Shape sizes are the same for
+//every sample so they stay float. Branches in the HLSL are selects here, which is also what the GPU does for most of them
+namespace AlienPlanetACW
+{
+	namespace Sdf
+	{
+		//Distance with the colour of the closest surface, the float4 the shader passes around
+		template <typename T>
+		struct Sample
+		{
+			T distance;
+			Vec3<T> colour;
+
+			Sample() = default;
+			Sample(const T& distanceValue, const Vec3<T>& colourValue) : distance(distanceValue), colour(colourValue) {}
+		};
+
+		template <typename T> inline Vec2<T> XZ(const Vec3<T>& p) { return Vec2<T>(p.x, p.z); }
+
+		//samplePoint - float3(x, y, z)
+		template <typename T> inline Vec3<T> Translate(const Vec3<T>& p, const float x, const float y, const float z) { return Vec3<T>(p.x - x, p.y - y, p.z - z); }
+
+		template <typename T> inline T Length6(const Vec2<T>& p)
+		{
+			auto q = p * p * p;
+			q = q * q;
+			return Pow(q.x + q.y, 1.0f / 6.0f);
+		}
+
+		template <typename T> inline T Length8(const Vec2<T>& p)
+		{
+			auto q = p * p;
+			q = q * q;
+			q = q * q;
+			return Pow(q.x + q.y, 1.0f / 8.0f);
+		}
+
+		template <typename T> inline T SphereSdf(const Vec3<T>& p, const float radius)
+		{
+			return Length(p) - radius;
+		}
+
+		//cubeSDF and boxSDF in the shader are the same function
+		template <typename T> inline T BoxSdf(const Vec3<T>& p, const Vec3<float>& b)
+		{
+			const auto d = Vec3<T>(Abs(p.x) - b.x, Abs(p.y) - b.y, Abs(p.z) - b.z);
+			return Min(Max(d.x, Max(d.y, d.z)), 0.0f) + Length(Max(d, 0.0f));
+		}
+
+		template <typename T> inline T RoundBoxSdf(const Vec3<T>& p, const Vec3<float>& b, const float r)
+		{
+			return BoxSdf(p, b) - r;
+		}
+
+		template <typename T> inline T TorusSdf(const Vec3<T>& p, const Vec2<float>& t)
+		{
+			return Length(Vec2<T>(Length(XZ(p)) - t.x, p.y)) - t.y;
+		}
+
+		template <typename T> inline T Torus82Sdf(const Vec3<T>& p, const Vec2<float>& t)
+		{
+			return Length8(Vec2<T>(Length(XZ(p)) - t.x, p.y)) - t.y;
+		}
+
+		template <typename T> inline T HexPrismSdf(const Vec3<T>& position, const Vec2<float>& h)
+		{
+			const auto kx = -0.8660254f;
+			const auto ky = 0.5f;
+			const auto kz = 0.57735f;
+
+			auto p = Abs(position);
+
+			const auto fold = T(2.0f) * Min(MultiplyAdd(p.x, T(kx), p.y * ky), 0.0f);
+			p.x = p.x - fold * kx;
+			p.y = p.y - fold * ky;
+
+			const auto dx = Length(Vec2<T>(p.x - Clamp(p.x, -kz * h.x, kz * h.x), p.y - h.x)) * Sign(p.y - h.x);
+			const auto dy = p.z - h.y;
+
+			return Min(Max(dx, dy), 0.0f) + Length(Vec2<T>(Max(dx, 0.0f), Max(dy, 0.0f)));
+		}
+
+		template <typename T> inline T CylinderSdf(const Vec3<T>& p, const Vec2<float>& h)
+		{
+			const auto dx = Abs(Length(XZ(p))) - h.x;
+			const auto dy = Abs(p.y) - h.y;
+
+			return Min(Max(dx, dy), 0.0f) + Length(Vec2<T>(Max(dx, 0.0f), Max(dy, 0.0f)));
+		}
+
+		template <typename T> inline T Cylinder6Sdf(const Vec3<T>& p, const Vec2<float>& h)
+		{
+			return Max(Length6(XZ(p)) - h.x, Abs(p.y) - h.y);
+		}
+
+		//Capped cylinder between two points
+		template <typename T> inline T CylinderSdf(const Vec3<T>& p, const Vec3<float>& a, const Vec3<float>& b, const float r)
+		{
+			const auto pa = Vec3<T>(p.x - a.x, p.y - a.y, p.z - a.z);
+			const auto ba = Vec3<float>(b.x - a.x, b.y - a.y, b.z - a.z);
+			const auto baba = Dot(ba, ba);
+			const auto paba = Dot(pa, Vec3<T>(ba));
+
+			const auto x = Length(Vec3<T>(pa.x * baba - paba * ba.x, pa.y * baba - paba * ba.y, pa.z * baba - paba * ba.z)) - r * baba;
+			const auto y = Abs(paba - baba * 0.5f) - baba * 0.5f;
+			const auto x2 = x * x;
+			const auto y2 = y * y * baba;
+
+			const auto outside = Select(x > T(0.0f), x2, T(0.0f)) + Select(y > T(0.0f), y2, T(0.0f));
+			const auto d = Select(Max(x, y) < T(0.0f), -Min(x2, y2), outside);
+
+			return Sign(d) * Sqrt(Abs(d)) / baba;
+		}
+
+		template <typename T> inline T ConeSdf(const Vec3<T>& p, const Vec3<float>& c)
+		{
+			const auto qx = Length(XZ(p));
+			const auto qy = p.y;
+			const auto d1 = -qy - c.z;
+			const auto d2 = Max(MultiplyAdd(qx, T(c.x), qy * c.y), qy);
+
+			return Length(Vec2<T>(Max(d1, 0.0f), Max(d2, 0.0f))) + Min(Max(d1, d2), 0.0f);
+		}
+
+		template <typename T> inline T CappedConeSdf(const Vec3<T>& p, const float h, const float r1, const float r2)
+		{
+			const auto q = Vec2<T>(Length(XZ(p)), p.y);
+
+			const auto k1 = Vec2<float>(r2, h);
+			const auto k2 = Vec2<float>(r2 - r1, 2.0f * h);
+
+			const auto ca = Vec2<T>(q.x - Min(q.x, Select(q.y < T(0.0f), T(r1), T(r2))), Abs(q.y) - h);
+			const auto t = Clamp((MultiplyAdd(k1.x - q.x, T(k2.x), (k1.y - q.y) * k2.y)) / (k2.x * k2.x + k2.y * k2.y), 0.0f, 1.0f);
+			const auto cb = Vec2<T>(q.x - k1.x + t * k2.x, q.y - k1.y + t * k2.y);
+
+			const auto s = Select(And(cb.x < T(0.0f), ca.y < T(0.0f)), T(-1.0f), T(1.0f));
+
+			return s * Sqrt(Min(Dot(ca, ca), Dot(cb, cb)));
+		}
+
+		//Round cone standing on the origin
+		template <typename T> inline T RoundConeSdf(const Vec3<T>& p, const float r1, const float r2, const float h)
+		{
+			const auto q = Vec2<T>(Length(XZ(p)), p.y);
+
+			const auto b = (r1 - r2) / h;
+			const auto a = std::sqrt(1.0f - b * b);
+			const auto k = MultiplyAdd(q.x, T(-b), q.y * a);
+
+			const auto bottom = Length(q) - r1;
+			const auto top = Length(Vec2<T>(q.x, q.y - h)) - r2;
+			const auto side = MultiplyAdd(q.x, T(a), q.y * b) - r1;
+
+			return Select(k < T(0.0f), bottom, Select(k > T(a * h), top, side));
+		}
+
+		//Round cone between two points
+		template <typename T> inline T RoundConeSdf(const Vec3<T>& p, const Vec3<float>& a, const Vec3<float>& b, const float r1, const float r2)
+		{
+			const auto ba = Vec3<float>(b.x - a.x, b.y - a.y, b.z - a.z);
+			const auto l2 = Dot(ba, ba);
+			const auto rr = r1 - r2;
+			const auto a2 = l2 - rr * rr;
+			const auto il2 = 1.0f / l2;
+
+			const auto pa = Vec3<T>(p.x - a.x, p.y - a.y, p.z - a.z);
+			const auto y = Dot(pa, Vec3<T>(ba));
+			const auto z = y - l2;
+			const auto offAxis = Vec3<T>(pa.x * l2 - y * ba.x, pa.y * l2 - y * ba.y, pa.z * l2 - y * ba.z);
+			const auto x2 = Dot(offAxis, offAxis);
+			const auto y2 = y * y * l2;
+			const auto z2 = z * z * l2;
+
+			const auto k = (rr > 0.0f ? 1.0f : (rr < 0.0f ? -1.0f : 0.0f)) * rr * rr * x2;
+
+			const auto top = Sqrt(x2 + z2) * il2 - r2;
+			const auto bottom = Sqrt(x2 + y2) * il2 - r1;
+			const auto side = (Sqrt(x2 * a2 * il2) + y * rr) * il2 - r1;
+
+			return Select(Sign(z) * a2 * z2 > k, top, Select(Sign(y) * a2 * y2 < k, bottom, side));
+		}
+
+		template <typename T> inline T EllipsoidSdf(const Vec3<T>& p, const Vec3<float>& r)
+		{
+			const auto k0 = Length(Vec3<T>(p.x / r.x, p.y / r.y, p.z / r.z));
+			const auto k1 = Length(Vec3<T>(p.x / (r.x * r.x), p.y / (r.y * r.y), p.z / (r.z * r.z)));
+
+			return k0 * (k0 - 1.0f) / k1;
+		}
+
+		template <typename T> inline T EquilateralTriangleSdf(const Vec2<T>& position)
+		{
+			const auto k = 1.73205f;
+
+			auto px = Abs(position.x) - 1.0f;
+			auto py = position.y + 1.0f / k;
+
+			const auto fold = MultiplyAdd(py, T(k), px) > T(0.0f);
+			const auto foldedX = (px - k * py) * 0.5f;
+			const auto foldedY = (-k * px - py) * 0.5f;
+
+			px = Select(fold, foldedX, px);
+			py = Select(fold, foldedY, py);
+
+			px = px + (2.0f - 2.0f * Clamp((px + 2.0f) * 0.5f, 0.0f, 1.0f));
+
+			return -Length(Vec2<T>(px, py)) * Sign(py);
+		}
+
+		template <typename T> inline T TriPrismSdf(const Vec3<T>& p, const Vec2<float>& h)
+		{
+			const auto d1 = Abs(p.z) - h.y;
+			const auto hx = h.x * 0.866025f;
+			const auto d2 = EquilateralTriangleSdf(Vec2<T>(p.x / hx, p.y / hx)) * hx;
+
+			return Length(Vec2<T>(Max(d1, 0.0f), Max(d2, 0.0f))) + Min(Max(d1, d2), 0.0f);
+		}
+
+		template <typename T> inline T OctahedronSdf(const Vec3<T>& position, const float s)
+		{
+			const auto p = Abs(position);
+			const auto m = p.x + p.y + p.z - s;
+
+			const auto useX = T(3.0f) * p.x < m;
+			const auto useY = AndNot(T(3.0f) * p.y < m, useX);
+			const auto useZ = AndNot(AndNot(T(3.0f) * p.z < m, useX), useY);
+
+			const auto q = Select(useX, p, Select(useY, Vec3<T>(p.y, p.z, p.x), Vec3<T>(p.z, p.x, p.y)));
+			const auto k = Clamp((q.z - q.y + s) * 0.5f, 0.0f, s);
+
+			const auto inside = Length(Vec3<T>(q.x, q.y - s + k, q.z - k));
+
+			return Select(Or(Or(useX, useY), useZ), inside, m * 0.57735027f);
+		}
+
+		//Twists around y, and like the shader returns the rotated x and z followed by y
+		template <typename T> inline Vec3<T> TwistSdf(const Vec3<T>& p, const float rep)
+		{
+			const auto angle = MultiplyAdd(p.y, T(rep), T(rep));
+			const auto c = Cos(angle);
+			const auto s = Sin(angle);
+
+			return Vec3<T>(MultiplyAdd(p.x, c, p.z * s), MultiplyAdd(p.z, c, -(p.x * s)), p.y);
+		}
+
+		//mandelBulb's three rotations by angle multiplied together, rows like the HLSL float3x3
+		inline void MandelbulbRotation(const float angle, float (&rotation)[3][3])
+		{
+			const auto c = std::cos(angle);
+			const auto s = std::sin(angle);
+
+			const float rotations[3][3][3] =
+			{
+				{ { c, -s, 0.0f }, { s, c, 0.0f }, { 0.0f, 0.0f, 1.0f } },
+				{ { c, 0.0f, -s }, { 0.0f, 1.0f, 0.0f }, { s, 0.0f, c } },
+				{ { 1.0f, 0.0f, 0.0f }, { 0.0f, c, -s }, { 0.0f, s, c } }
+			};
+
+			float product[3][3];
+
+			for (auto row = 0; row < 3; row++)
+			{
+				for (auto column = 0; column < 3; column++)
+				{
+					product[row][column] = 0.0f;
+
+					for (auto k = 0; k < 3; k++)
+					{
+						product[row][column] += rotations[0][row][k] * rotations[1][k][column];
+					}
+				}
+			}
+
+			for (auto row = 0; row < 3; row++)
+			{
+				for (auto column = 0; column < 3; column++)
+				{
+					rotation[row][column] = 0.0f;
+
+					for (auto k = 0; k < 3; k++)
+					{
+						rotation[row][column] += product[row][k] * rotations[2][k][column];
+					}
+				}
+			}
+		}
+
+		//(c + is)^n, which for the cos and sin of an angle is the cos and sin of n times it with no trig
+		template <typename T>
+		inline void ComplexPower(T& c, T& s, unsigned int n)
+		{
+			auto powerC = T(1.0f);
+			auto powerS = T(0.0f);
+			auto first = true;
+
+			while (n > 0)
+			{
+				if ((n & 1) != 0)
+				{
+					if (first)
+					{
+						powerC = c;
+						powerS = s;
+						first = false;
+					}
+					else
+					{
+						const auto nextC = MultiplyAdd(powerC, c, -(powerS * s));
+						powerS = MultiplyAdd(powerC, s, powerS * c);
+						powerC = nextC;
+					}
+				}
+
+				n >>= 1;
+
+				if (n > 0)
+				{
+					const auto squareC = MultiplyAdd(c, c, -(s * s));
+					s = T(2.0f) * c * s;
+					c = squareC;
+				}
+			}
+
+			c = powerC;
+			s = powerS;
+		}
+
+		template <typename T>
+		inline T IntegerPower(const T& a, unsigned int n)
+		{
+			auto power = T(1.0f);
+			auto square = a;
+
+			for (; n > 0; n >>= 1)
+			{
+				if ((n & 1) != 0)
+				{
+					power = power * square;
+				}
+
+				square = square * square;
+			}
+
+			return power;
+		}
+
+		//How much of a detail one wavelength across to keep for a sample whose cone is coneWidth wide, all of it up to a
+		//quarter of a wavelength and none from half of one, where it could only alias
+		template <typename T> inline T DetailFade(const T& coneWidth, const float wavelength) { return Saturate(T(2.0f) - coneWidth * (4.0f / wavelength)); }
+
+		//mandelBulb, with the power, rotation and colour the shader works out from time passed in. A whole number power,
+		//like the classic 8, turns the point with complex powers of its angles' cos and sin instead of acos, atan2, two
+		//pows, two sins and two coss, and any other power takes one pow. Lanes stop iterating where the shader would break,
+		//or once the detail the next iteration adds, about 1 / dr across, is narrower than their cone, and the loop ends
+		//once they all have
+		template <typename T>
+		inline Sample<T> MandelbulbSdf(const Vec3<T>& pos, const float power, const float (&m)[3][3], const Vec3<float>& colour, const unsigned int iterations = 8, const T& coneWidth = T(0.0f))
+		{
+			const auto shifted = Translate(pos, 0.0f, 0.0f, 0.5f);
+			auto z = Vec3<T>(
+				MultiplyAdd(shifted.x, T(m[0][0]), MultiplyAdd(shifted.y, T(m[0][1]), shifted.z * m[0][2])),
+				MultiplyAdd(shifted.x, T(m[1][0]), MultiplyAdd(shifted.y, T(m[1][1]), shifted.z * m[1][2])),
+				MultiplyAdd(shifted.x, T(m[2][0]), MultiplyAdd(shifted.y, T(m[2][1]), shifted.z * m[2][2])));
+
+			const auto integerPower = power >= 1.0f && power <= 32.0f && power == std::floor(power);
+			const auto n = static_cast<unsigned int>(power);
+
+			auto dr = T(1.0f);
+			auto r = T(0.0f);
+			auto active = T(0.0f) <= T(0.0f);
+
+			for (auto i = 0u; i < iterations; i++)
+			{
+				r = Select(active, Length(z), r);
+				active = AndNot(active, Or(r > T(1.5f), coneWidth * dr > T(1.0f)));
+
+				if (!Any(active))
+				{
+					break;
+				}
+
+				Vec3<T> next;
+				T rPowerLessOne;
+
+				if (integerPower)
+				{
+					//theta = acos(z.z / r) and phi = atan2(z.x, z.y) as their cos and sin. On the axis atan2 gives zero
+					const auto rho = Sqrt(MultiplyAdd(z.x, z.x, z.y * z.y));
+					const auto offOrigin = r > T(0.0f);
+					const auto offAxis = rho > T(0.0f);
+
+					auto cosTheta = Select(offOrigin, z.z / r, T(1.0f));
+					auto sinTheta = Select(offOrigin, rho / r, T(0.0f));
+					auto cosPhi = Select(offAxis, z.y / rho, T(1.0f));
+					auto sinPhi = Select(offAxis, z.x / rho, T(0.0f));
+
+					ComplexPower(cosTheta, sinTheta, n);
+					ComplexPower(cosPhi, sinPhi, n);
+
+					rPowerLessOne = IntegerPower(r, n - 1);
+
+					const auto zr = rPowerLessOne * r;
+
+					next = Vec3<T>(zr * sinTheta * cosPhi, zr * sinPhi * sinTheta, zr * cosTheta) + pos;
+				}
+				else
+				{
+					const auto theta = Acos(z.z / r) * power;
+					const auto phi = Atan2(z.x, z.y) * power;
+
+					const auto zr = Pow(r, power);
+					rPowerLessOne = Select(r > T(0.0f), zr / r, T(0.0f));
+
+					const auto sinTheta = Sin(theta);
+					next = Vec3<T>(zr * sinTheta * Cos(phi), zr * Sin(phi) * sinTheta, zr * Cos(theta)) + pos;
+				}
+
+				dr = Select(active, MultiplyAdd(rPowerLessOne * power, dr, T(1.0f)), dr);
+				z = Select(active, next, z);
+			}
+
+			return Sample<T>(T(0.5f) * Log(r) * r / dr, Vec3<T>(colour));
+		}
+
+		//How far from its closest vertex a point can get before SierpinskiTetrahedronSdf stops folding it, for callers that
+		//can take a slightly short distance. The scene and the shader fold every time, with SierpinskiNoBailout
+		const float SierpinskiBailout = 8.0f;
+		const float SierpinskiNoBailout = 1e10f;
+
+		//SierpinskiTetrahedron. The closest vertex is the one with the smallest |v|^2 - 2 pos.v, as |pos|^2 is the same for
+		//all four. A lane further than bailout from its closest vertex stops folding, since from there each fold doubles
+		//its distance and the scale together give or take the tetrahedron's size. The distance it stops at comes out short
+		//of the full one by about 1 / bailout of it, never over. A lane also stops once its cone is four times 1 / scale, as
+		//the shape it stops at is about 2 / scale fatter than the full one, and the loop ends once every lane has stopped
+		template <typename T>
+		inline Sample<T> SierpinskiTetrahedronSdf(Vec3<T> pos, const unsigned int iterations = 8, const float bailout = SierpinskiNoBailout, const T& coneWidth = T(0.0f))
+		{
+			const Vec3<float> vertices[4] =
+			{
+				Vec3<float>(0.0f, 0.57735f, 0.0f),
+				Vec3<float>(0.0f, -1.0f, 1.15470f),
+				Vec3<float>(1.0f, -1.0f, -0.57735f),
+				Vec3<float>(-1.0f, -1.0f, -0.57735f)
+			};
+
+			float lengthsSquared[4];
+
+			for (auto j = 0; j < 4; j++)
+			{
+				lengthsSquared[j] = Dot(vertices[j], vertices[j]);
+			}
+
+			auto scale = T(1.0f);
+			auto dm = T(0.0f);
+			auto active = T(0.0f) <= T(0.0f);
+
+			for (auto i = 0u; i < iterations; i++)
+			{
+				auto v = Vec3<T>(vertices[0]);
+				auto closest = MultiplyAdd(T(-2.0f), Dot(pos, v), T(lengthsSquared[0]));
+
+				for (auto j = 1; j < 4; j++)
+				{
+					const auto vertex = Vec3<T>(vertices[j]);
+					const auto d = MultiplyAdd(T(-2.0f), Dot(pos, vertex), T(lengthsSquared[j]));
+					const auto closer = d < closest;
+
+					v = Select(closer, vertex, v);
+					closest = Select(closer, d, closest);
+				}
+
+				const auto distanceSquared = Dot(pos, pos) + closest;
+
+				dm = Select(active, distanceSquared, dm);
+				pos = Select(active, pos * 2.0f - v, pos);
+				scale = Select(active, scale * 2.0f, scale);
+				active = AndNot(active, Or(distanceSquared > T(bailout * bailout), coneWidth * scale > T(4.0f)));
+
+				if (!Any(active))
+				{
+					break;
+				}
+			}
+
+			return Sample<T>((Sqrt(Max(dm, T(0.0f))) - 1.0f) / scale, Saturate(pos));
+		}
+
+		//unionSDF, ties go to the second argument as in the shader
+		template <typename T> inline Sample<T> Union(const Sample<T>& a, const Sample<T>& b)
+		{
+			const auto first = a.distance < b.distance;
+			return Sample<T>(Select(first, a.distance, b.distance), Select(first, a.colour, b.colour));
+		}
+
+		template <typename T> inline T Union(const T& a, const T& b)
+		{
+			return Select(a < b, a, b);
+		}
+
+		template <typename T> inline T SmoothUnion(const T& d1, const T& d2, const float k)
+		{
+			const auto h = Clamp(0.5f + 0.5f * (d2 - d1) / k, 0.0f, 1.0f);
+			return Lerp(d2, d1, h) - k * h * (1.0f - h);
+		}
+
+		template <typename T> inline T SmoothSubtraction(const T& d1, const T& d2, const float k)
+		{
+			const auto h = Clamp(0.5f - 0.5f * (d2 + d1) / k, 0.0f, 1.0f);
+			return Lerp(d2, -d1, h) + k * h * (1.0f - h);
+		}
+
+		template <typename T> inline T SmoothIntersection(const T& d1, const T& d2, const float k)
+		{
+			const auto h = Clamp(0.5f - 0.5f * (d2 - d1) / k, 0.0f, 1.0f);
+			return Lerp(d2, d1, h) + k * h * (1.0f - h);
+		}
+	}
+}
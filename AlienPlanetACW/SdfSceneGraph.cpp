@@ -0,0 +1,324 @@
+#include "pch.h"
+#include "SdfSceneGraph.h"
+
+#include <algorithm>
+#include <functional>
+
+using namespace AlienPlanetACW;
+using namespace AlienPlanetACW::Sdf;
+
+SdfSceneGraph::SdfSceneGraph()
+{
+	//Node 0 is the sample point, already in point register 0 when a program starts
+	m_nodes.push_back({ SdfOpcode::Count, 0, 0, 0, { 0.0f, 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f, 0.0f } });
+}
+
+unsigned int SdfSceneGraph::Add(const SdfOpcode opcode, const unsigned int operandCount, const unsigned int a, const unsigned int b, const float (&c0)[4], const float (&c1)[4])
+{
+	Node node = { opcode, a, b, operandCount, { c0[0], c0[1], c0[2], c0[3] }, { c1[0], c1[1], c1[2], c1[3] } };
+
+	m_nodes.push_back(node);
+
+	return static_cast<unsigned int>(m_nodes.size() - 1);
+}
+
+SdfPoint SdfSceneGraph::AddPoint(const SdfOpcode opcode, const SdfPoint point, const float (&c0)[4])
+{
+	return SdfPoint{ Add(opcode, 1, point.node, 0, c0) };
+}
+
+SdfShape SdfSceneGraph::AddPrimitive(const SdfOpcode opcode, const SdfPoint point, const float (&c0)[4], const float (&c1)[4])
+{
+	return SdfShape{ Add(opcode, 1, point.node, 0, c0, c1) };
+}
+
+SdfShape SdfSceneGraph::AddOperator(const SdfOpcode opcode, const SdfShape a, const SdfShape b, const float k)
+{
+	return SdfShape{ Add(opcode, 2, a.node, b.node, { k, 0.0f, 0.0f, 0.0f }) };
+}
+
+bool SdfSceneGraph::IsPoint(const SdfOpcode opcode)
+{
+	return opcode == SdfOpcode::Translate || opcode == SdfOpcode::Scale || opcode == SdfOpcode::Twist || opcode == SdfOpcode::MirrorRepeatXZ || opcode == SdfOpcode::Count;
+}
+
+SdfPoint SdfSceneGraph::Translate(const SdfPoint point, const Vec3<float>& offset)
+{
+	if (offset.x == 0.0f && offset.y == 0.0f && offset.z == 0.0f)
+	{
+		return point;
+	}
+
+	return AddPoint(SdfOpcode::Translate, point, { offset.x, offset.y, offset.z, 0.0f });
+}
+
+SdfPoint SdfSceneGraph::Scale(const SdfPoint point, const float scale)
+{
+	return AddPoint(SdfOpcode::Scale, point, { scale, 0.0f, 0.0f, 0.0f });
+}
+
+SdfPoint SdfSceneGraph::Twist(const SdfPoint point, const float rep)
+{
+	return AddPoint(SdfOpcode::Twist, point, { rep, 0.0f, 0.0f, 0.0f });
+}
+
+SdfPoint SdfSceneGraph::MirrorRepeatXZ(const SdfPoint point, const float period)
+{
+	return AddPoint(SdfOpcode::MirrorRepeatXZ, point, { period, 0.0f, 0.0f, 0.0f });
+}
+
+SdfShape SdfSceneGraph::Sphere(const SdfPoint point, const float radius)
+{
+	return AddPrimitive(SdfOpcode::Sphere, point, { radius, 0.0f, 0.0f, 0.0f });
+}
+
+SdfShape SdfSceneGraph::Box(const SdfPoint point, const Vec3<float>& halfSize)
+{
+	return AddPrimitive(SdfOpcode::Box, point, { halfSize.x, halfSize.y, halfSize.z, 0.0f });
+}
+
+SdfShape SdfSceneGraph::RoundBox(const SdfPoint point, const Vec3<float>& halfSize, const float radius)
+{
+	return AddPrimitive(SdfOpcode::RoundBox, point, { halfSize.x, halfSize.y, halfSize.z, radius });
+}
+
+SdfShape SdfSceneGraph::Torus(const SdfPoint point, const Vec2<float>& radii)
+{
+	return AddPrimitive(SdfOpcode::Torus, point, { radii.x, radii.y, 0.0f, 0.0f });
+}
+
+SdfShape SdfSceneGraph::Torus82(const SdfPoint point, const Vec2<float>& radii)
+{
+	return AddPrimitive(SdfOpcode::Torus82, point, { radii.x, radii.y, 0.0f, 0.0f });
+}
+
+SdfShape SdfSceneGraph::HexPrism(const SdfPoint point, const Vec2<float>& size)
+{
+	return AddPrimitive(SdfOpcode::HexPrism, point, { size.x, size.y, 0.0f, 0.0f });
+}
+
+SdfShape SdfSceneGraph::Cylinder(const SdfPoint point, const Vec2<float>& size)
+{
+	return AddPrimitive(SdfOpcode::Cylinder, point, { size.x, size.y, 0.0f, 0.0f });
+}
+
+SdfShape SdfSceneGraph::Cylinder6(const SdfPoint point, const Vec2<float>& size)
+{
+	return AddPrimitive(SdfOpcode::Cylinder6, point, { size.x, size.y, 0.0f, 0.0f });
+}
+
+SdfShape SdfSceneGraph::Cylinder(const SdfPoint point, const Vec3<float>& a, const Vec3<float>& b, const float radius)
+{
+	return AddPrimitive(SdfOpcode::CylinderSegment, point, { a.x, a.y, a.z, radius }, { b.x, b.y, b.z, 0.0f });
+}
+
+SdfShape SdfSceneGraph::Cone(const SdfPoint point, const Vec3<float>& c)
+{
+	return AddPrimitive(SdfOpcode::Cone, point, { c.x, c.y, c.z, 0.0f });
+}
+
+SdfShape SdfSceneGraph::CappedCone(const SdfPoint point, const float height, const float bottomRadius, const float topRadius)
+{
+	return AddPrimitive(SdfOpcode::CappedCone, point, { height, bottomRadius, topRadius, 0.0f });
+}
+
+SdfShape SdfSceneGraph::RoundCone(const SdfPoint point, const float bottomRadius, const float topRadius, const float height)
+{
+	return AddPrimitive(SdfOpcode::RoundCone, point, { bottomRadius, topRadius, height, 0.0f });
+}
+
+SdfShape SdfSceneGraph::RoundCone(const SdfPoint point, const Vec3<float>& a, const Vec3<float>& b, const float radiusA, const float radiusB)
+{
+	return AddPrimitive(SdfOpcode::RoundConeSegment, point, { a.x, a.y, a.z, radiusA }, { b.x, b.y, b.z, radiusB });
+}
+
+SdfShape SdfSceneGraph::Ellipsoid(const SdfPoint point, const Vec3<float>& radii)
+{
+	return AddPrimitive(SdfOpcode::Ellipsoid, point, { radii.x, radii.y, radii.z, 0.0f });
+}
+
+SdfShape SdfSceneGraph::TriPrism(const SdfPoint point, const Vec2<float>& size)
+{
+	return AddPrimitive(SdfOpcode::TriPrism, point, { size.x, size.y, 0.0f, 0.0f });
+}
+
+SdfShape SdfSceneGraph::Octahedron(const SdfPoint point, const float size)
+{
+	return AddPrimitive(SdfOpcode::Octahedron, point, { size, 0.0f, 0.0f, 0.0f });
+}
+
+SdfShape SdfSceneGraph::Mandelbulb(const SdfPoint point, const float power, const float rotationAngle, const Vec3<float>& colour)
+{
+	return AddPrimitive(SdfOpcode::Mandelbulb, point, { power, rotationAngle, 0.0f, 0.0f }, { colour.x, colour.y, colour.z, 0.0f });
+}
+
+SdfShape SdfSceneGraph::SierpinskiTetrahedron(const SdfPoint point)
+{
+	return AddPrimitive(SdfOpcode::SierpinskiTetrahedron, point, { 0.0f, 0.0f, 0.0f, 0.0f });
+}
+
+SdfShape SdfSceneGraph::Union(const SdfShape a, const SdfShape b)
+{
+	return AddOperator(SdfOpcode::Union, a, b, 0.0f);
+}
+
+SdfShape SdfSceneGraph::SmoothUnion(const SdfShape a, const SdfShape b, const float k)
+{
+	return AddOperator(SdfOpcode::SmoothUnion, a, b, k);
+}
+
+SdfShape SdfSceneGraph::SmoothSubtraction(const SdfShape cutter, const SdfShape shape, const float k)
+{
+	return AddOperator(SdfOpcode::SmoothSubtraction, cutter, shape, k);
+}
+
+SdfShape SdfSceneGraph::SmoothIntersection(const SdfShape a, const SdfShape b, const float k)
+{
+	return AddOperator(SdfOpcode::SmoothIntersection, a, b, k);
+}
+
+SdfShape SdfSceneGraph::Lerp(const SdfShape a, const SdfShape b, const float t)
+{
+	return AddOperator(SdfOpcode::Lerp, a, b, t);
+}
+
+SdfShape SdfSceneGraph::ScaleDistance(const SdfShape shape, const float scale)
+{
+	return SdfShape{ Add(SdfOpcode::ScaleDistance, 1, shape.node, 0, { scale, 0.0f, 0.0f, 0.0f }) };
+}
+
+SdfShape SdfSceneGraph::Colour(const SdfShape shape, const Vec3<float>& colour)
+{
+	return SdfShape{ Add(SdfOpcode::Colour, 1, shape.node, 0, { colour.x, colour.y, colour.z, 0.0f }) };
+}
+
+SdfShape SdfSceneGraph::Wobble(const SdfShape shape, const SdfPoint point, const float blend)
+{
+	return SdfShape{ Add(SdfOpcode::Wobble, 2, shape.node, point.node, { blend, 0.0f, 0.0f, 0.0f }) };
+}
+
+bool SdfSceneGraph::Compile(const SdfShape root, SdfProgram& program) const
+{
+	const auto nodeCount = m_nodes.size();
+
+	//Registers each node needs to be worked out, Sethi-Ullman style, so the hungrier operand goes first
+	std::vector<unsigned int> need(nodeCount, 0);
+
+	for (auto i = 0u; i < nodeCount; i++)
+	{
+		const auto& node = m_nodes[i];
+
+		if (node.operandCount == 2)
+		{
+			const auto a = need[node.a];
+			const auto b = need[node.b];
+
+			need[i] = a == b ? a + 1 : std::max(a, b);
+		}
+		else
+		{
+			need[i] = node.operandCount == 1 ? std::max(need[node.a], 1u) : 1u;
+		}
+	}
+
+	//Post order from the root, each node once however many shapes share it
+	std::vector<unsigned int> order;
+	std::vector<bool> visited(nodeCount, false);
+	std::vector<unsigned int> uses(nodeCount, 0);
+
+	std::function<void(unsigned int)> visit = [&](const unsigned int index)
+	{
+		if (visited[index])
+		{
+			return;
+		}
+
+		visited[index] = true;
+
+		const auto& node = m_nodes[index];
+
+		if (node.operandCount == 2 && need[node.b] > need[node.a])
+		{
+			visit(node.b);
+			visit(node.a);
+		}
+		else
+		{
+			for (auto operand = 0u; operand < node.operandCount; operand++)
+			{
+				visit(operand == 0 ? node.a : node.b);
+			}
+		}
+
+		for (auto operand = 0u; operand < node.operandCount; operand++)
+		{
+			uses[operand == 0 ? node.a : node.b]++;
+		}
+
+		order.push_back(index);
+	};
+
+	visit(root.node);
+	uses[root.node]++;
+
+	//Linear scan, an operand's register is free again after its last use so the result can go straight back into it
+	std::vector<unsigned int> registers(nodeCount, 0);
+	bool pointBusy[SdfProgram::MaxRegisters] = { true };
+	bool shapeBusy[SdfProgram::MaxRegisters] = { false };
+	auto pointRegisters = 1u;
+	auto shapeRegisters = 0u;
+
+	std::vector<SdfInstruction> instructions;
+	instructions.reserve(order.size() + 1);
+
+	for (const auto index : order)
+	{
+		const auto& node = m_nodes[index];
+
+		if (index == 0)
+		{
+			continue;
+		}
+
+		SdfInstruction instruction = { static_cast<unsigned int>(node.opcode), 0, registers[node.a], node.operandCount == 2 ? registers[node.b] : 0,
+			{ node.c0[0], node.c0[1], node.c0[2], node.c0[3] }, { node.c1[0], node.c1[1], node.c1[2], node.c1[3] } };
+
+		for (auto operand = 0u; operand < node.operandCount; operand++)
+		{
+			const auto operandIndex = operand == 0 ? node.a : node.b;
+
+			if (--uses[operandIndex] == 0 && operandIndex != 0)
+			{
+				(IsPoint(m_nodes[operandIndex].opcode) ? pointBusy : shapeBusy)[registers[operandIndex]] = false;
+			}
+		}
+
+		auto* const busy = IsPoint(node.opcode) ? pointBusy : shapeBusy;
+		auto destination = 0u;
+
+		while (destination < SdfProgram::MaxRegisters && busy[destination])
+		{
+			destination++;
+		}
+
+		if (destination == SdfProgram::MaxRegisters)
+		{
+			return false;
+		}
+
+		busy[destination] = true;
+		registers[index] = destination;
+		instruction.destination = destination;
+
+		auto& used = IsPoint(node.opcode) ? pointRegisters : shapeRegisters;
+		used = std::max(used, destination + 1);
+
+		instructions.push_back(instruction);
+	}
+
+	instructions.push_back({ static_cast<unsigned int>(SdfOpcode::Return), 0, registers[root.node], 0, { 0.0f, 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f, 0.0f } });
+
+	program = SdfProgram(instructions, pointRegisters, shapeRegisters);
+
+	return true;
+}
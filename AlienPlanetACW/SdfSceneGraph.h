@@ -0,0 +1,93 @@
+#pragma once
+
+#include "SdfBytecode.h"
+
+#include <vector>
+
+namespace AlienPlanetACW
+{
+	//Handles to nodes of an SdfSceneGraph, a point in space or a shape with a colour, so the two can't be mixed up
+	struct SdfPoint
+	{
+		unsigned int node;
+	};
+
+	struct SdfShape
+	{
+		unsigned int node;
+	};
+
+	//An implicit scene as data: primitives placed at points, points moved by domain operators and shapes combined by
+	//operators, instead of a hand written sceneSDF. Compile flattens it into an SdfProgram for the CPU interpreter and
+	//for sceneSDFBytecode in the shader
+	class SdfSceneGraph
+	{
+	public:
+		SdfSceneGraph();
+
+		//The point the scene is being sampled at, everything else is built from this
+		SdfPoint GetSamplePoint() const { return SdfPoint{ 0 }; }
+
+		SdfPoint Translate(SdfPoint point, const Sdf::Vec3<float>& offset);
+		//Doesn't scale distances back, wrap the shape in ScaleDistance for that
+		SdfPoint Scale(SdfPoint point, float scale);
+		SdfPoint Twist(SdfPoint point, float rep);
+		SdfPoint MirrorRepeatXZ(SdfPoint point, float period);
+
+		SdfShape Sphere(SdfPoint point, float radius);
+		SdfShape Box(SdfPoint point, const Sdf::Vec3<float>& halfSize);
+		SdfShape RoundBox(SdfPoint point, const Sdf::Vec3<float>& halfSize, float radius);
+		SdfShape Torus(SdfPoint point, const Sdf::Vec2<float>& radii);
+		SdfShape Torus82(SdfPoint point, const Sdf::Vec2<float>& radii);
+		SdfShape HexPrism(SdfPoint point, const Sdf::Vec2<float>& size);
+		SdfShape Cylinder(SdfPoint point, const Sdf::Vec2<float>& size);
+		SdfShape Cylinder6(SdfPoint point, const Sdf::Vec2<float>& size);
+		SdfShape Cylinder(SdfPoint point, const Sdf::Vec3<float>& a, const Sdf::Vec3<float>& b, float radius);
+		SdfShape Cone(SdfPoint point, const Sdf::Vec3<float>& c);
+		SdfShape CappedCone(SdfPoint point, float height, float bottomRadius, float topRadius);
+		SdfShape RoundCone(SdfPoint point, float bottomRadius, float topRadius, float height);
+		SdfShape RoundCone(SdfPoint point, const Sdf::Vec3<float>& a, const Sdf::Vec3<float>& b, float radiusA, float radiusB);
+		SdfShape Ellipsoid(SdfPoint point, const Sdf::Vec3<float>& radii);
+		SdfShape TriPrism(SdfPoint point, const Sdf::Vec2<float>& size);
+		SdfShape Octahedron(SdfPoint point, float size);
+		SdfShape Mandelbulb(SdfPoint point, float power, float rotationAngle, const Sdf::Vec3<float>& colour);
+		SdfShape SierpinskiTetrahedron(SdfPoint point);
+
+		//unionSDF, the nearer shape and its colour
+		SdfShape Union(SdfShape a, SdfShape b);
+		SdfShape SmoothUnion(SdfShape a, SdfShape b, float k);
+		//Cuts cutter out of shape
+		SdfShape SmoothSubtraction(SdfShape cutter, SdfShape shape, float k);
+		SdfShape SmoothIntersection(SdfShape a, SdfShape b, float k);
+		SdfShape Lerp(SdfShape a, SdfShape b, float t);
+		SdfShape ScaleDistance(SdfShape shape, float scale);
+		SdfShape Colour(SdfShape shape, const Sdf::Vec3<float>& colour);
+		SdfShape Wobble(SdfShape shape, SdfPoint point, float blend);
+
+		//False if the graph needs more than SdfProgram::MaxRegisters of either kind
+		bool Compile(SdfShape root, SdfProgram& program) const;
+
+		unsigned int GetNodeCount() const { return static_cast<unsigned int>(m_nodes.size()); }
+
+	private:
+		struct Node
+		{
+			SdfOpcode opcode;
+			unsigned int a;
+			unsigned int b;
+			unsigned int operandCount;
+			float c0[4];
+			float c1[4];
+		};
+
+		unsigned int Add(SdfOpcode opcode, unsigned int operandCount, unsigned int a, unsigned int b, const float (&c0)[4], const float (&c1)[4] = { 0.0f, 0.0f, 0.0f, 0.0f });
+
+		SdfPoint AddPoint(SdfOpcode opcode, SdfPoint point, const float (&c0)[4]);
+		SdfShape AddPrimitive(SdfOpcode opcode, SdfPoint point, const float (&c0)[4], const float (&c1)[4] = { 0.0f, 0.0f, 0.0f, 0.0f });
+		SdfShape AddOperator(SdfOpcode opcode, SdfShape a, SdfShape b, float k);
+
+		static bool IsPoint(SdfOpcode opcode);
+
+		std::vector<Node> m_nodes;
+	};
+}
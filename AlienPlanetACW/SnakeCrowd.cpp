@@ -0,0 +1,309 @@
+#include "pch.h"
+#include "SnakeCrowd.h"
+
+using namespace AlienPlanetACW;
+
+SnakeCrowd::SnakeCrowd(const std::shared_ptr<DX::DeviceResources>& deviceResources, const std::shared_ptr<ResourceManager>& resourceManager, const unsigned int pointsPerSnake, const float bounds) :
+	m_deviceResources(deviceResources), m_resourceManager(resourceManager), m_simulation(pointsPerSnake, bounds), m_instanceCapacity(0), m_cameraPosition(0.0f, 0.0f, 0.0f), m_loadingComplete(false)
+{
+	//Segments are built in world space, so the model matrix stays the identity
+	DirectX::XMStoreFloat4x4(&m_MVPBufferData.model, DirectX::XMMatrixIdentity());
+
+	m_resourceManager->GetTexture(m_deviceResources->GetD3DDevice(), L"snake.dds", m_snakeSkin);
+
+	CreateDeviceDependentResources();
+}
+
+void SnakeCrowd::AddSnake(const DirectX::XMFLOAT3 position, const DirectX::XMFLOAT2 direction, const float radius, const float length, const float speed)
+{
+	m_simulation.AddSnake(position, direction, radius, length, speed);
+}
+
+void SnakeCrowd::CreateDeviceDependentResources()
+{
+	// Load shaders asynchronously.
+	auto loadVSTask = DX::ReadDataAsync(L"SnakeTubeVS.cso");
+	auto loadPSTask = DX::ReadDataAsync(L"SnakePS.cso");
+
+	// After the vertex shader file is loaded, create the shader and input layout.
+	auto createVSTask = loadVSTask.then([this](const std::vector<byte>& fileData) {
+		DX::ThrowIfFailed(
+			m_deviceResources->GetD3DDevice()->CreateVertexShader(
+				&fileData[0],
+				fileData.size(),
+				nullptr,
+				&m_vertexShader
+			)
+		);
+
+		//Slot 0 is the ring mesh, slot 1 steps once per segment
+		static const D3D11_INPUT_ELEMENT_DESC vertexDesc[] =
+		{
+			{"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0},
+			{"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
+			{"SEGMENT", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 0, D3D11_INPUT_PER_INSTANCE_DATA, 1},
+			{"SEGMENT", 1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1},
+			{"SEGMENT", 2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1},
+		};
+
+		DX::ThrowIfFailed(
+			m_deviceResources->GetD3DDevice()->CreateInputLayout(
+				vertexDesc,
+				ARRAYSIZE(vertexDesc),
+				&fileData[0],
+				fileData.size(),
+				&m_inputLayout
+			)
+		);
+	});
+
+	// After the pixel shader file is loaded, create the shader, sampler, states and constant buffer.
+	auto createPSTask = loadPSTask.then([this](const std::vector<byte>& fileData) {
+		DX::ThrowIfFailed(
+			m_deviceResources->GetD3DDevice()->CreatePixelShader(
+				&fileData[0],
+				fileData.size(),
+				nullptr,
+				&m_pixelShader
+			)
+		);
+
+		D3D11_SAMPLER_DESC samplerWrapDescription;
+
+		samplerWrapDescription.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+		samplerWrapDescription.AddressU = D3D11_TEXTURE_ADDRESS_WRAP;
+		samplerWrapDescription.AddressV = D3D11_TEXTURE_ADDRESS_WRAP;
+		samplerWrapDescription.AddressW = D3D11_TEXTURE_ADDRESS_WRAP;
+		samplerWrapDescription.MipLODBias = 0.0f;
+		samplerWrapDescription.MaxAnisotropy = 1;
+		samplerWrapDescription.ComparisonFunc = D3D11_COMPARISON_ALWAYS;
+		samplerWrapDescription.BorderColor[0] = 0.0f;
+		samplerWrapDescription.BorderColor[1] = 0.0f;
+		samplerWrapDescription.BorderColor[2] = 0.0f;
+		samplerWrapDescription.BorderColor[3] = 0.0f;
+		samplerWrapDescription.MinLOD = 0.0f;
+		samplerWrapDescription.MaxLOD = D3D11_FLOAT32_MAX;
+
+		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateSamplerState(&samplerWrapDescription, &m_sampleStateWrap));
+
+		//Created once for the whole crowd rather than every frame
+		D3D11_RASTERIZER_DESC rasterizerDesc = CD3D11_RASTERIZER_DESC(D3D11_DEFAULT);
+
+		rasterizerDesc.CullMode = D3D11_CULL_NONE;
+
+		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateRasterizerState(&rasterizerDesc, &m_rasterizerState));
+
+		CD3D11_BUFFER_DESC MVPBufferDescription(sizeof(ModelViewProjectionConstantBuffer), D3D11_BIND_CONSTANT_BUFFER);
+
+		DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateBuffer(&MVPBufferDescription, nullptr, &m_MVPBuffer));
+	});
+
+	// Once both shaders are loaded, create the meshes.
+	auto createMeshTask = (createPSTask && createVSTask).then([this]() {
+
+		static const char* const lodNames[TubeInstanceBuilder::LodCount] = { "SnakeTubeLOD0", "SnakeTubeLOD1", "SnakeTubeLOD2", "SnakeTubeLOD3" };
+
+		std::vector<VertexPositionTexcoordNormalTangentBinormal> ringVertices;
+		std::vector<unsigned long> ringIndices;
+
+		for (auto i = 0u; i < TubeInstanceBuilder::LodCount; i++)
+		{
+			TubeInstanceBuilder::BuildRingMesh(TubeInstanceBuilder::GetRingSides(i), ringVertices, ringIndices);
+
+			m_resourceManager->CreateModel(m_deviceResources->GetD3DDevice(), lodNames[i], ringVertices, ringIndices);
+			m_resourceManager->GetModel(m_deviceResources->GetD3DDevice(), lodNames[i], m_ringVertexBuffers[i], m_ringIndexBuffers[i]);
+			m_ringIndexCounts[i] = m_resourceManager->GetIndexCount(lodNames[i]);
+		}
+
+		CreateInstanceBuffer();
+	});
+
+	createMeshTask.then([this]() {
+		m_loadingComplete = true;
+	});
+}
+
+void SnakeCrowd::CreateInstanceBuffer()
+{
+	m_instanceBuffer.Reset();
+	m_instanceCapacity = m_simulation.GetSegmentCount();
+
+	if (m_instanceCapacity == 0)
+	{
+		return;
+	}
+
+	CD3D11_BUFFER_DESC instanceBufferDescription(static_cast<UINT>(m_instanceCapacity * sizeof(TubeSegmentInstance)), D3D11_BIND_VERTEX_BUFFER, D3D11_USAGE_DYNAMIC, D3D11_CPU_ACCESS_WRITE);
+
+	DX::ThrowIfFailed(m_deviceResources->GetD3DDevice()->CreateBuffer(&instanceBufferDescription, nullptr, &m_instanceBuffer));
+}
+
+void SnakeCrowd::SetViewProjectionMatrixConstantBuffer(DirectX::XMMATRIX& view, DirectX::XMMATRIX& projection)
+{
+	DirectX::XMStoreFloat4x4(&m_MVPBufferData.view, DirectX::XMMatrixTranspose(view));
+
+	DirectX::XMStoreFloat4x4(&m_MVPBufferData.projection, DirectX::XMMatrixTranspose(projection));
+}
+
+void SnakeCrowd::SetCameraPositionConstantBuffer(DirectX::XMFLOAT3& cameraPosition)
+{
+	//Only used to pick each snake's ring LOD, the snake shaders don't read the camera
+	m_cameraPosition = cameraPosition;
+}
+
+void SnakeCrowd::Update(DX::StepTimer const& timer)
+{
+	m_simulation.Update(static_cast<float>(timer.GetElapsedSeconds()), static_cast<float>(timer.GetTotalSeconds()));
+}
+
+void SnakeCrowd::Render()
+{
+	// Loading is asynchronous. Only draw geometry after it's loaded.
+	if (!m_loadingComplete)
+	{
+		return;
+	}
+
+	//Snakes added after loading need a bigger instance buffer
+	if (m_simulation.GetSegmentCount() > m_instanceCapacity)
+	{
+		CreateInstanceBuffer();
+	}
+
+	if (m_simulation.GetSegmentCount() == 0)
+	{
+		return;
+	}
+
+	auto context = m_deviceResources->GetD3DDeviceContext();
+
+	// Prepare constant buffers to send it to the graphics device.
+	context->UpdateSubresource1(
+		m_MVPBuffer.Get(),
+		0,
+		NULL,
+		&m_MVPBufferData,
+		0,
+		0,
+		0
+	);
+
+	unsigned int lodInstanceCounts[TubeInstanceBuilder::LodCount];
+
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+
+	DX::ThrowIfFailed(context->Map(m_instanceBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource));
+	m_simulation.WriteInstancesByLod(m_cameraPosition, static_cast<TubeSegmentInstance*>(mappedResource.pData), lodInstanceCounts);
+	context->Unmap(m_instanceBuffer.Get(), 0);
+
+	context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+	context->IASetInputLayout(m_inputLayout.Get());
+
+	// Attach our vertex shader.
+	context->VSSetShader(
+		m_vertexShader.Get(),
+		nullptr,
+		0
+	);
+
+	// Send the constant buffer to the graphics device.
+	context->VSSetConstantBuffers1(
+		0,
+		1,
+		m_MVPBuffer.GetAddressOf(),
+		nullptr,
+		nullptr
+	);
+
+	context->HSSetShader(
+		nullptr,
+		nullptr,
+		0
+	);
+
+	context->DSSetShader(
+		nullptr,
+		nullptr,
+		0
+	);
+
+	context->GSSetShader(
+		nullptr,
+		nullptr,
+		0
+	);
+
+	context->RSSetState(m_rasterizerState.Get());
+
+	// Attach our pixel shader.
+	context->PSSetShader(
+		m_pixelShader.Get(),
+		nullptr,
+		0
+	);
+
+	context->PSSetConstantBuffers1(
+		0,
+		1,
+		m_MVPBuffer.GetAddressOf(),
+		nullptr,
+		nullptr
+	);
+
+	context->PSSetShaderResources(0, 1, &m_snakeSkin);
+	context->PSSetSamplers(0, 1, m_sampleStateWrap.GetAddressOf());
+
+	// One draw per ring LOD, the instances are already grouped nearest LOD first.
+	auto startInstance = 0u;
+
+	for (auto lod = 0u; lod < TubeInstanceBuilder::LodCount; lod++)
+	{
+		if (lodInstanceCounts[lod] == 0)
+		{
+			continue;
+		}
+
+		ID3D11Buffer* const vertexBuffers[2] = { m_ringVertexBuffers[lod].Get(), m_instanceBuffer.Get() };
+		const UINT strides[2] = { sizeof(AlienPlanetACW::VertexPositionTexcoordNormalTangentBinormal), sizeof(TubeSegmentInstance) };
+		const UINT offsets[2] = { 0, 0 };
+		context->IASetVertexBuffers(
+			0,
+			2,
+			vertexBuffers,
+			strides,
+			offsets
+		);
+
+		context->IASetIndexBuffer(m_ringIndexBuffers[lod].Get(), DXGI_FORMAT_R32_UINT, 0);
+
+		context->DrawIndexedInstanced(
+			m_ringIndexCounts[lod],
+			lodInstanceCounts[lod],
+			0,
+			0,
+			startInstance
+		);
+
+		startInstance += lodInstanceCounts[lod];
+	}
+}
+
+void SnakeCrowd::ReleaseDeviceDependentResources()
+{
+	m_loadingComplete = false;
+	m_vertexShader.Reset();
+	m_inputLayout.Reset();
+	m_pixelShader.Reset();
+	m_rasterizerState.Reset();
+	m_sampleStateWrap.Reset();
+	m_MVPBuffer.Reset();
+	m_instanceBuffer.Reset();
+	m_instanceCapacity = 0;
+
+	for (auto i = 0u; i < TubeInstanceBuilder::LodCount; i++)
+	{
+		m_ringVertexBuffers[i].Reset();
+		m_ringIndexBuffers[i].Reset();
+	}
+}
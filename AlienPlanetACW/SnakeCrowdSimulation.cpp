@@ -0,0 +1,271 @@
+#include "pch.h"
+#include "SnakeCrowdSimulation.h"
+
+#include <cmath>
+#include <cstring>
+#include <ppl.h>
+
+using namespace AlienPlanetACW;
+using namespace DirectX;
+
+namespace
+{
+	//Batches of four snakes handed to each parallel_for iteration when the thread count is left to the scheduler
+	const unsigned int BatchesPerChunk = 16;
+
+	unsigned int PaddedCount(const unsigned int count)
+	{
+		return (count + 3) & ~3u;
+	}
+
+	XMVECTOR Load(const std::vector<float>& values, const size_t index)
+	{
+		return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&values[index]));
+	}
+
+	void Store(std::vector<float>& values, const size_t index, FXMVECTOR value)
+	{
+		XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&values[index]), value);
+	}
+
+	//Wraps each lane back inside -bounds to bounds, snakes only ever move a little each frame so one step is enough
+	XMVECTOR Wrap(FXMVECTOR value, FXMVECTOR bounds)
+	{
+		const auto span = XMVectorAdd(bounds, bounds);
+
+		auto wrapped = XMVectorSelect(value, XMVectorSubtract(value, span), XMVectorGreater(value, bounds));
+		wrapped = XMVectorSelect(wrapped, XMVectorAdd(wrapped, span), XMVectorLess(wrapped, XMVectorNegate(bounds)));
+
+		return wrapped;
+	}
+}
+
+SnakeCrowdSimulation::SnakeCrowdSimulation(const unsigned int pointsPerSnake, const float bounds) :
+	m_pointsPerSnake(pointsPerSnake < 2 ? 2 : pointsPerSnake), m_bounds(bounds), m_snakeCount(0)
+{
+}
+
+unsigned int SnakeCrowdSimulation::AddSnake(const XMFLOAT3& position, const XMFLOAT2& direction, const float radius, const float length, const float speed)
+{
+	const auto snake = m_snakeCount++;
+	const auto padded = PaddedCount(m_snakeCount);
+
+	//Padding lanes are left as zero length snakes at the origin, they're built but never written out
+	for (auto* values : { &m_positionX, &m_positionY, &m_positionZ, &m_directionX, &m_directionZ, &m_radius, &m_length, &m_speed })
+	{
+		values->resize(padded, 0.0f);
+	}
+
+	const auto directionLength = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+	const auto invDirectionLength = directionLength > 1e-6f ? 1.0f / directionLength : 0.0f;
+
+	m_positionX[snake] = position.x;
+	m_positionY[snake] = position.y;
+	m_positionZ[snake] = position.z;
+	m_directionX[snake] = direction.x * invDirectionLength;
+	m_directionZ[snake] = direction.y * invDirectionLength;
+	m_radius[snake] = radius;
+	m_length[snake] = length;
+	m_speed[snake] = speed;
+
+	m_instances.resize(GetSegmentCount());
+
+	return snake;
+}
+
+void SnakeCrowdSimulation::Reserve(const unsigned int snakeCount)
+{
+	const auto padded = PaddedCount(snakeCount);
+
+	for (auto* values : { &m_positionX, &m_positionY, &m_positionZ, &m_directionX, &m_directionZ, &m_radius, &m_length, &m_speed })
+	{
+		values->reserve(padded);
+	}
+
+	m_instances.reserve(snakeCount * (m_pointsPerSnake - 1));
+}
+
+void SnakeCrowdSimulation::Clear()
+{
+	m_snakeCount = 0;
+
+	for (auto* values : { &m_positionX, &m_positionY, &m_positionZ, &m_directionX, &m_directionZ, &m_radius, &m_length, &m_speed, &m_spineX, &m_spineY, &m_spineZ })
+	{
+		values->clear();
+	}
+
+	m_instances.clear();
+	m_lods.clear();
+}
+
+void SnakeCrowdSimulation::Update(const float elapsedSeconds, const float totalSeconds, const unsigned int threadCount)
+{
+	const auto padded = PaddedCount(m_snakeCount);
+	const auto batchCount = padded / 4;
+
+	m_spineX.resize(static_cast<size_t>(padded) * m_pointsPerSnake);
+	m_spineY.resize(static_cast<size_t>(padded) * m_pointsPerSnake);
+	m_spineZ.resize(static_cast<size_t>(padded) * m_pointsPerSnake);
+
+	if (threadCount == 1 || batchCount <= 1)
+	{
+		UpdateBatches(0, batchCount, elapsedSeconds, totalSeconds);
+		return;
+	}
+
+	//Batches never share a snake, a spine row vector or an instance, so chunks need no synchronisation
+	const auto chunkSize = threadCount == 0 ? BatchesPerChunk : (batchCount + threadCount - 1) / threadCount;
+	const auto chunkCount = (batchCount + chunkSize - 1) / chunkSize;
+
+	concurrency::parallel_for(0u, chunkCount, [&](const unsigned int chunk)
+	{
+		const auto firstBatch = chunk * chunkSize;
+		const auto lastBatch = firstBatch + chunkSize < batchCount ? firstBatch + chunkSize : batchCount;
+
+		UpdateBatches(firstBatch, lastBatch, elapsedSeconds, totalSeconds);
+	});
+}
+
+void SnakeCrowdSimulation::UpdateBatches(const unsigned int firstBatch, const unsigned int lastBatch, const float elapsedSeconds, const float totalSeconds)
+{
+	const auto stride = static_cast<size_t>(PaddedCount(m_snakeCount));
+	const auto segmentCount = m_pointsPerSnake - 1;
+
+	const auto zero = XMVectorZero();
+	const auto bounds = XMVectorReplicate(m_bounds);
+	const auto elapsed = XMVectorReplicate(elapsedSeconds);
+	const auto wobbleSpeed = XMVectorReplicate(totalSeconds * 5.0f);
+	const auto wobbleSize = XMVectorReplicate(0.01f);
+	const auto invPointCount = XMVectorReplicate(1.0f / static_cast<float>(m_pointsPerSnake));
+
+	for (auto batch = firstBatch; batch < lastBatch; batch++)
+	{
+		const auto first = static_cast<size_t>(batch) * 4;
+		const auto laneCount = m_snakeCount - first < 4 ? static_cast<unsigned int>(m_snakeCount - first) : 4u;
+
+		const auto directionX = Load(m_directionX, first);
+		const auto directionZ = Load(m_directionZ, first);
+		const auto speed = XMVectorMultiply(Load(m_speed, first), elapsed);
+
+		const auto positionX = Wrap(XMVectorMultiplyAdd(directionX, speed, Load(m_positionX, first)), bounds);
+		const auto positionY = Load(m_positionY, first);
+		const auto positionZ = Wrap(XMVectorMultiplyAdd(directionZ, speed, Load(m_positionZ, first)), bounds);
+
+		Store(m_positionX, first, positionX);
+		Store(m_positionZ, first, positionZ);
+
+		const auto radius = Load(m_radius, first);
+		const auto spacing = XMVectorMultiply(Load(m_length, first), invPointCount);
+
+		auto* const instances = &m_instances[first * segmentCount];
+
+		XMVECTOR previousX = zero;
+		XMVECTOR previousY = zero;
+		XMVECTOR previousZ = zero;
+
+		//Same spine as TubeInstanceBuilder::BuildSpine for every lane, the wobble is across the direction of travel
+		for (auto point = 0u; point < m_pointsPerSnake; point++)
+		{
+			const auto offset = XMVectorMultiply(spacing, XMVectorReplicate(static_cast<float>(point + 1)));
+
+			const auto px = XMVectorMultiplyAdd(directionX, offset, positionX);
+			const auto pz = XMVectorMultiplyAdd(directionZ, offset, positionZ);
+			const auto py = XMVectorAdd(TubeInstanceBuilder::Noise(px, positionY, pz), radius);
+
+			const auto wobbleNoise = TubeInstanceBuilder::Noise(px, py, pz);
+			const auto wobble = XMVectorMultiply(XMVectorSin(XMVectorMultiply(wobbleSpeed, TubeInstanceBuilder::Noise(wobbleNoise, wobbleNoise, wobbleNoise))), wobbleSize);
+
+			const auto x = XMVectorMultiplyAdd(directionZ, wobble, px);
+			const auto z = XMVectorNegativeMultiplySubtract(directionX, wobble, pz);
+
+			const auto row = point * stride + first;
+
+			Store(m_spineX, row, x);
+			Store(m_spineY, row, py);
+			Store(m_spineZ, row, z);
+
+			if (point > 0)
+			{
+				const auto segment = point - 1;
+
+				//Only the head and tail taper
+				const auto startRadius = segment == 0 ? zero : radius;
+				const auto endRadius = segment + 1 == segmentCount ? zero : radius;
+
+				TubeSegmentInstance* batchInstances[4] = {};
+
+				for (auto lane = 0u; lane < laneCount; lane++)
+				{
+					batchInstances[lane] = instances + lane * segmentCount + segment;
+				}
+
+				TubeInstanceBuilder::BuildSegmentBatch(previousX, previousY, previousZ, x, py, z, startRadius, endRadius, batchInstances, laneCount);
+			}
+
+			previousX = x;
+			previousY = py;
+			previousZ = z;
+		}
+	}
+}
+
+void SnakeCrowdSimulation::WriteInstancesByLod(const XMFLOAT3& cameraPosition, TubeSegmentInstance* const destination, unsigned int (&lodInstanceCounts)[TubeInstanceBuilder::LodCount]) const
+{
+	const auto stride = static_cast<size_t>(PaddedCount(m_snakeCount));
+	const auto segmentCount = m_pointsPerSnake - 1;
+	const auto middleRow = (m_pointsPerSnake / 2) * stride;
+
+	const auto cameraX = XMVectorReplicate(cameraPosition.x);
+	const auto cameraY = XMVectorReplicate(cameraPosition.y);
+	const auto cameraZ = XMVectorReplicate(cameraPosition.z);
+
+	unsigned int snakesPerLod[TubeInstanceBuilder::LodCount] = {};
+
+	m_lods.resize(stride);
+
+	//Distance from the camera to the middle of each snake, four at a time
+	for (size_t first = 0; first < m_snakeCount; first += 4)
+	{
+		const auto dx = XMVectorSubtract(Load(m_spineX, middleRow + first), cameraX);
+		const auto dy = XMVectorSubtract(Load(m_spineY, middleRow + first), cameraY);
+		const auto dz = XMVectorSubtract(Load(m_spineZ, middleRow + first), cameraZ);
+
+		XMFLOAT4 distances;
+		XMStoreFloat4(&distances, XMVectorSqrt(XMVectorMultiplyAdd(dx, dx, XMVectorMultiplyAdd(dy, dy, XMVectorMultiply(dz, dz)))));
+
+		const float lanes[4] = { distances.x, distances.y, distances.z, distances.w };
+
+		for (auto lane = 0u; lane < 4 && first + lane < m_snakeCount; lane++)
+		{
+			const auto lod = TubeInstanceBuilder::SelectLod(lanes[lane]);
+
+			m_lods[first + lane] = static_cast<unsigned char>(lod);
+			snakesPerLod[lod]++;
+		}
+	}
+
+	unsigned int lodStarts[TubeInstanceBuilder::LodCount];
+	auto start = 0u;
+
+	for (auto lod = 0u; lod < TubeInstanceBuilder::LodCount; lod++)
+	{
+		lodStarts[lod] = start;
+		lodInstanceCounts[lod] = snakesPerLod[lod] * segmentCount;
+		start += lodInstanceCounts[lod];
+	}
+
+	for (auto snake = 0u; snake < m_snakeCount; snake++)
+	{
+		auto& lodStart = lodStarts[m_lods[snake]];
+
+		memcpy(destination + lodStart, &m_instances[static_cast<size_t>(snake) * segmentCount], segmentCount * sizeof(TubeSegmentInstance));
+		lodStart += segmentCount;
+	}
+}
+
+XMFLOAT3 SnakeCrowdSimulation::GetSpinePoint(const unsigned int snake, const unsigned int point) const
+{
+	const auto index = static_cast<size_t>(point) * PaddedCount(m_snakeCount) + snake;
+
+	return XMFLOAT3(m_spineX[index], m_spineY[index], m_spineZ[index]);
+}
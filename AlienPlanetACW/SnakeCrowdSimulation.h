@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+#include <DirectXMath.h>
+
+#include "TubeInstanceBuilder.h"
+
+namespace AlienPlanetACW
+{
+	//Every snake in the crowd as structure of arrays, moved and rebuilt four snakes at a time. Nothing here touches the
+	//device, SnakeCrowd owns one of these and uploads its instances
+	class SnakeCrowdSimulation
+	{
+	public:
+		//Every snake has the same number of spine points, and wraps around inside -bounds to bounds on x and z
+		SnakeCrowdSimulation(const unsigned int pointsPerSnake, const float bounds);
+
+		//Direction is on the ground plane, x and z, and is normalised here
+		unsigned int AddSnake(const DirectX::XMFLOAT3& position, const DirectX::XMFLOAT2& direction, const float radius, const float length, const float speed);
+		void Reserve(const unsigned int snakeCount);
+		void Clear();
+
+		//Moves every snake, then rebuilds its spine and segment instances. A thread count of 0 lets parallel_for split the
+		//crowd into small chunks, 1 runs on the calling thread and anything else splits it into that many equal chunks
+		void Update(const float elapsedSeconds, const float totalSeconds, const unsigned int threadCount = 0);
+
+		//Copies every snake's segments grouped by ring LOD, nearest LOD first, so each LOD is one instanced draw
+		void WriteInstancesByLod(const DirectX::XMFLOAT3& cameraPosition, TubeSegmentInstance* const destination, unsigned int (&lodInstanceCounts)[TubeInstanceBuilder::LodCount]) const;
+
+		unsigned int GetSnakeCount() const { return m_snakeCount; }
+		unsigned int GetPointsPerSnake() const { return m_pointsPerSnake; }
+		unsigned int GetSegmentCount() const { return m_snakeCount * (m_pointsPerSnake - 1); }
+
+		DirectX::XMFLOAT3 GetSpinePoint(const unsigned int snake, const unsigned int point) const;
+
+		//Snake major, pointsPerSnake - 1 segments each, valid after Update
+		const std::vector<TubeSegmentInstance>& GetInstances() const { return m_instances; }
+
+	private:
+		void UpdateBatches(const unsigned int firstBatch, const unsigned int lastBatch, const float elapsedSeconds, const float totalSeconds);
+
+		unsigned int m_pointsPerSnake;
+		float m_bounds;
+
+		unsigned int m_snakeCount;
+
+		//Per snake, padded to a multiple of four so every batch can load whole vectors
+		std::vector<float> m_positionX;
+		std::vector<float> m_positionY;
+		std::vector<float> m_positionZ;
+		std::vector<float> m_directionX;
+		std::vector<float> m_directionZ;
+		std::vector<float> m_radius;
+		std::vector<float> m_length;
+		std::vector<float> m_speed;
+
+		//Point major, point i of every snake is one padded row, so a batch reads and writes whole vectors
+		std::vector<float> m_spineX;
+		std::vector<float> m_spineY;
+		std::vector<float> m_spineZ;
+
+		std::vector<TubeSegmentInstance> m_instances;
+		mutable std::vector<unsigned char> m_lods;
+	};
+}
@@ -0,0 +1,47 @@
+// A constant buffer that stores the three basic column-major matrices for composing geometry.
+cbuffer ModelViewProjectionConstantBuffer : register(b0)
+{
+	matrix model;
+	matrix view;
+	matrix projection;
+};
+
+// Ring mesh vertex plus the segment it is instanced for, built on the CPU by TubeInstanceBuilder.
+struct VertexShaderInput
+{
+	float3 position : POSITION;
+	float2 texcoord : TEXCOORD0;
+	float4 startLength : SEGMENT0;
+	float4 tangentStartRadius : SEGMENT1;
+	float4 normalEndRadius : SEGMENT2;
+};
+
+// Per-pixel color data passed through the pixel shader.
+struct PixelShaderInput
+{
+	float4 positionH : SV_POSITION;
+	float3 positionW : POSITION;
+	float2 texcoord : TEXCOORD0;
+};
+
+//The ring's x and y go around the segment's frame and z runs from its start to its end, segments are already in world space
+PixelShaderInput main(VertexShaderInput input)
+{
+	PixelShaderInput output;
+
+	float3 tangent = input.tangentStartRadius.xyz;
+	float3 normal = input.normalEndRadius.xyz;
+	float3 binormal = cross(tangent, normal);
+
+	float radius = lerp(input.tangentStartRadius.w, input.normalEndRadius.w, input.position.z);
+
+	output.positionW = input.startLength.xyz + tangent * (input.startLength.w * input.position.z);
+	output.positionW += radius * (input.position.x * normal + input.position.y * binormal);
+
+	output.positionH = mul(float4(output.positionW, 1.0f), view);
+	output.positionH = mul(output.positionH, projection);
+
+	output.texcoord = input.texcoord;
+
+	return output;
+}
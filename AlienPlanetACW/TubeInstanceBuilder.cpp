@@ -0,0 +1,280 @@
+#include "pch.h"
+#include "TubeInstanceBuilder.h"
+
+#include <cmath>
+
+using namespace AlienPlanetACW;
+using namespace DirectX;
+
+namespace
+{
+	const unsigned int RingSides[TubeInstanceBuilder::LodCount] = { 16, 10, 6, 4 };
+	const float LodDistances[TubeInstanceBuilder::LodCount - 1] = { 2.0f, 5.0f, 12.0f };
+
+	float Hash(const float n)
+	{
+		const auto value = std::sin(n) * 43758.5453f;
+
+		return value - std::floor(value);
+	}
+
+	float Lerp(const float a, const float b, const float t)
+	{
+		return a + (b - a) * t;
+	}
+
+	//Scalar version of one segment, used for the tail that doesn't fill a batch of four
+	void BuildSegment(const float* const x, const float* const y, const float* const z, const unsigned int segment, const unsigned int segmentCount, const float radius, TubeSegmentInstance& instance)
+	{
+		const auto dx = x[segment + 1] - x[segment];
+		const auto dy = y[segment + 1] - y[segment];
+		const auto dz = z[segment + 1] - z[segment];
+
+		const auto length = std::sqrt(dx * dx + dy * dy + dz * dz);
+		const auto invLength = length > 1e-6f ? 1.0f / length : 0.0f;
+
+		const auto tangentX = dx * invLength;
+		const auto tangentY = dy * invLength;
+		const auto tangentZ = dz * invLength;
+
+		//Normal is tangent x up, falling back to +x for a vertical segment
+		const auto horizontal = std::sqrt(tangentX * tangentX + tangentZ * tangentZ);
+		const auto vertical = horizontal < 1e-4f;
+
+		instance.start = XMFLOAT3(x[segment], y[segment], z[segment]);
+		instance.length = length;
+		instance.tangent = XMFLOAT3(tangentX, tangentY, tangentZ);
+		instance.startRadius = segment == 0 ? 0.0f : radius;
+		instance.normal = vertical ? XMFLOAT3(1.0f, 0.0f, 0.0f) : XMFLOAT3(-tangentZ / horizontal, 0.0f, tangentX / horizontal);
+		instance.endRadius = segment + 1 == segmentCount ? 0.0f : radius;
+	}
+}
+
+unsigned int TubeInstanceBuilder::GetRingSides(const unsigned int lod)
+{
+	return RingSides[lod < LodCount ? lod : LodCount - 1];
+}
+
+unsigned int TubeInstanceBuilder::SelectLod(const float distance)
+{
+	auto lod = 0u;
+
+	while (lod < LodCount - 1 && distance > LodDistances[lod])
+	{
+		lod++;
+	}
+
+	return lod;
+}
+
+void TubeInstanceBuilder::BuildRingMesh(const unsigned int sides, std::vector<VertexPositionTexcoordNormalTangentBinormal>& vertices, std::vector<unsigned long>& indices)
+{
+	vertices.clear();
+	indices.clear();
+
+	//The seam is duplicated so the texture wraps, each quad covers a tenth of the texture like the old geometry shader
+	for (auto end = 0u; end < 2; end++)
+	{
+		for (auto side = 0u; side <= sides; side++)
+		{
+			const auto angle = XM_2PI * static_cast<float>(side) / static_cast<float>(sides);
+			const auto cosine = std::cos(angle);
+			const auto sine = std::sin(angle);
+
+			VertexPositionTexcoordNormalTangentBinormal vertex;
+			vertex.position = XMFLOAT3(cosine, sine, static_cast<float>(end));
+			vertex.texcoord = XMFLOAT2(0.1f * static_cast<float>(side), 0.1f * static_cast<float>(end));
+			vertex.normal = XMFLOAT3(cosine, sine, 0.0f);
+			vertex.tangent = XMFLOAT3(-sine, cosine, 0.0f);
+			vertex.binormal = XMFLOAT3(0.0f, 0.0f, 1.0f);
+
+			vertices.push_back(vertex);
+		}
+	}
+
+	const auto rowLength = sides + 1;
+
+	for (auto side = 0u; side < sides; side++)
+	{
+		indices.push_back(side);
+		indices.push_back(side + 1);
+		indices.push_back(rowLength + side + 1);
+		indices.push_back(side);
+		indices.push_back(rowLength + side + 1);
+		indices.push_back(rowLength + side);
+	}
+}
+
+void TubeInstanceBuilder::BuildSpine(const XMFLOAT3& origin, const bool directionZ, const float length, const unsigned int pointCount, const float radius, const float time, float* const x, float* const y, float* const z)
+{
+	const auto spacing = length / static_cast<float>(pointCount);
+
+	for (auto i = 0u; i < pointCount; i++)
+	{
+		const auto offset = spacing * static_cast<float>(i + 1);
+
+		auto px = origin.x + (directionZ ? 0.0f : offset);
+		auto py = origin.y;
+		auto pz = origin.z + (directionZ ? offset : 0.0f);
+
+		py = Noise(px, py, pz) + radius;
+
+		const auto wobbleNoise = Noise(px, py, pz);
+		const auto wobble = std::sin(time * 5.0f * Noise(wobbleNoise, wobbleNoise, wobbleNoise)) * 0.01f;
+
+		x[i] = directionZ ? px + wobble : px;
+		y[i] = py;
+		z[i] = directionZ ? pz : pz + wobble;
+	}
+}
+
+void TubeInstanceBuilder::BuildSegments(const float* const x, const float* const y, const float* const z, const unsigned int pointCount, const float radius, TubeSegmentInstance* const instances)
+{
+	if (pointCount < 2)
+	{
+		return;
+	}
+
+	const auto segmentCount = pointCount - 1;
+
+	const auto radiusVector = XMVectorReplicate(radius);
+
+	auto segment = 0u;
+
+	//Point i + 4 is read by the last lane, so batches stop while a full four segments remain
+	for (; segment + 4 <= segmentCount; segment += 4)
+	{
+		const auto startX = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(x + segment));
+		const auto startY = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(y + segment));
+		const auto startZ = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(z + segment));
+
+		const auto endX = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(x + segment + 1));
+		const auto endY = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(y + segment + 1));
+		const auto endZ = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(z + segment + 1));
+
+		//Only the very first and very last segments taper
+		auto startRadius = radiusVector;
+		auto endRadius = radiusVector;
+
+		if (segment == 0)
+		{
+			startRadius = XMVectorSetX(startRadius, 0.0f);
+		}
+
+		if (segment + 4 == segmentCount)
+		{
+			endRadius = XMVectorSetW(endRadius, 0.0f);
+		}
+
+		TubeSegmentInstance* const batch[4] = { &instances[segment], &instances[segment + 1], &instances[segment + 2], &instances[segment + 3] };
+
+		BuildSegmentBatch(startX, startY, startZ, endX, endY, endZ, startRadius, endRadius, batch);
+	}
+
+	for (; segment < segmentCount; segment++)
+	{
+		BuildSegment(x, y, z, segment, segmentCount, radius, instances[segment]);
+	}
+}
+
+void TubeInstanceBuilder::BuildSegmentBatch(FXMVECTOR startX, FXMVECTOR startY, FXMVECTOR startZ, GXMVECTOR endX, HXMVECTOR endY, HXMVECTOR endZ, CXMVECTOR startRadius, CXMVECTOR endRadius, TubeSegmentInstance* const* const instances, const unsigned int laneCount)
+{
+	const auto zero = XMVectorZero();
+	const auto one = XMVectorReplicate(1.0f);
+	const auto lengthEpsilon = XMVectorReplicate(1e-6f);
+	const auto verticalEpsilon = XMVectorReplicate(1e-4f);
+
+	const auto dx = XMVectorSubtract(endX, startX);
+	const auto dy = XMVectorSubtract(endY, startY);
+	const auto dz = XMVectorSubtract(endZ, startZ);
+
+	const auto lengthSq = XMVectorMultiplyAdd(dx, dx, XMVectorMultiplyAdd(dy, dy, XMVectorMultiply(dz, dz)));
+	const auto length = XMVectorSqrt(lengthSq);
+	const auto invLength = XMVectorSelect(XMVectorDivide(one, length), zero, XMVectorLessOrEqual(length, lengthEpsilon));
+
+	const auto tangentX = XMVectorMultiply(dx, invLength);
+	const auto tangentY = XMVectorMultiply(dy, invLength);
+	const auto tangentZ = XMVectorMultiply(dz, invLength);
+
+	//Normal is tangent x up, falling back to +x for a vertical segment
+	const auto horizontal = XMVectorSqrt(XMVectorMultiplyAdd(tangentX, tangentX, XMVectorMultiply(tangentZ, tangentZ)));
+	const auto vertical = XMVectorLess(horizontal, verticalEpsilon);
+	const auto invHorizontal = XMVectorDivide(one, XMVectorMax(horizontal, verticalEpsilon));
+
+	const auto normalX = XMVectorSelect(XMVectorNegate(XMVectorMultiply(tangentZ, invHorizontal)), one, vertical);
+	const auto normalZ = XMVectorSelect(XMVectorMultiply(tangentX, invHorizontal), zero, vertical);
+
+	//Each instance is three float4, so transposing three 4x4 blocks turns the lanes back into instances
+	const auto first = XMMatrixTranspose(XMMATRIX(startX, startY, startZ, length));
+	const auto second = XMMatrixTranspose(XMMATRIX(tangentX, tangentY, tangentZ, startRadius));
+	const auto third = XMMatrixTranspose(XMMATRIX(normalX, zero, normalZ, endRadius));
+
+	for (auto lane = 0u; lane < laneCount; lane++)
+	{
+		auto* const instance = reinterpret_cast<XMFLOAT4*>(instances[lane]);
+
+		XMStoreFloat4(instance, first.r[lane]);
+		XMStoreFloat4(instance + 1, second.r[lane]);
+		XMStoreFloat4(instance + 2, third.r[lane]);
+	}
+}
+
+float TubeInstanceBuilder::Noise(const float x, const float y, const float z)
+{
+	const auto px = std::floor(x);
+	const auto py = std::floor(y);
+	const auto pz = std::floor(z);
+
+	auto fx = x - px;
+	auto fy = y - py;
+	auto fz = z - pz;
+
+	fx = fx * fx * (3.0f - 2.0f * fx);
+	fy = fy * fy * (3.0f - 2.0f * fy);
+	fz = fz * fz * (3.0f - 2.0f * fz);
+
+	const auto n = px + py * 57.0f + 113.0f * pz;
+
+	return Lerp(Lerp(Lerp(Hash(n + 0.0f), Hash(n + 1.0f), fx),
+		Lerp(Hash(n + 57.0f), Hash(n + 58.0f), fx), fy),
+		Lerp(Lerp(Hash(n + 113.0f), Hash(n + 114.0f), fx),
+			Lerp(Hash(n + 170.0f), Hash(n + 171.0f), fx), fy), fz);
+}
+
+XMVECTOR TubeInstanceBuilder::Noise(FXMVECTOR x, FXMVECTOR y, FXMVECTOR z)
+{
+	const auto one = XMVectorReplicate(1.0f);
+	const auto two = XMVectorReplicate(2.0f);
+	const auto three = XMVectorReplicate(3.0f);
+
+	const auto px = XMVectorFloor(x);
+	const auto py = XMVectorFloor(y);
+	const auto pz = XMVectorFloor(z);
+
+	auto fx = XMVectorSubtract(x, px);
+	auto fy = XMVectorSubtract(y, py);
+	auto fz = XMVectorSubtract(z, pz);
+
+	fx = XMVectorMultiply(XMVectorMultiply(fx, fx), XMVectorNegativeMultiplySubtract(two, fx, three));
+	fy = XMVectorMultiply(XMVectorMultiply(fy, fy), XMVectorNegativeMultiplySubtract(two, fy, three));
+	fz = XMVectorMultiply(XMVectorMultiply(fz, fz), XMVectorNegativeMultiplySubtract(two, fz, three));
+
+	const auto n = XMVectorAdd(px, XMVectorMultiplyAdd(py, XMVectorReplicate(57.0f), XMVectorMultiply(pz, XMVectorReplicate(113.0f))));
+
+	const auto hash = [](FXMVECTOR value)
+	{
+		//The hash multiplies the sine by 43758, so the usual single constant reduction by 2 pi loses too much. Splitting 2 pi
+		//into a short head and a tail keeps k * head exact for the whole integer lattice the noise is sampled on
+		const auto k = XMVectorRound(XMVectorMultiply(value, XMVectorReplicate(XM_1DIV2PI)));
+		const auto reduced = XMVectorNegativeMultiplySubtract(k, XMVectorReplicate(0.0019353071795864769f), XMVectorNegativeMultiplySubtract(k, XMVectorReplicate(6.28125f), value));
+
+		const auto scaled = XMVectorMultiply(XMVectorSin(reduced), XMVectorReplicate(43758.5453f));
+
+		return XMVectorSubtract(scaled, XMVectorFloor(scaled));
+	};
+
+	return XMVectorLerpV(XMVectorLerpV(XMVectorLerpV(hash(n), hash(XMVectorAdd(n, one)), fx),
+		XMVectorLerpV(hash(XMVectorAdd(n, XMVectorReplicate(57.0f))), hash(XMVectorAdd(n, XMVectorReplicate(58.0f))), fx), fy),
+		XMVectorLerpV(XMVectorLerpV(hash(XMVectorAdd(n, XMVectorReplicate(113.0f))), hash(XMVectorAdd(n, XMVectorReplicate(114.0f))), fx),
+			XMVectorLerpV(hash(XMVectorAdd(n, XMVectorReplicate(170.0f))), hash(XMVectorAdd(n, XMVectorReplicate(171.0f))), fx), fy), fz);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+#include <DirectXMath.h>
+
+#include "..\Content\ShaderStructures.h"
+
+namespace AlienPlanetACW
+{
+	//One tube segment, read by SnakeTubeVS.hlsl as three float4 per-instance elements
+	struct TubeSegmentInstance
+	{
+		DirectX::XMFLOAT3 start;
+		float length;
+		DirectX::XMFLOAT3 tangent;
+		float startRadius;
+		DirectX::XMFLOAT3 normal;
+		float endRadius;
+	};
+
+	//Builds everything the instanced tube path needs on the CPU, nothing here touches the device
+	class TubeInstanceBuilder
+	{
+	public:
+		static const unsigned int LodCount = 4;
+
+		//Sides around the ring for each LOD, and the LOD for a camera distance
+		static unsigned int GetRingSides(const unsigned int lod);
+		static unsigned int SelectLod(const float distance);
+
+		//Open cylinder of unit radius and length along +z, x and y are the cosine and sine around the ring
+		static void BuildRingMesh(const unsigned int sides, std::vector<VertexPositionTexcoordNormalTangentBinormal>& vertices, std::vector<unsigned long>& indices);
+
+		//Spine the geometry shader used to build: points spaced along x or z, lifted by noise and wobbling sideways over time
+		static void BuildSpine(const DirectX::XMFLOAT3& origin, const bool directionZ, const float length, const unsigned int pointCount, const float radius, const float time, float* const x, float* const y, float* const z);
+
+		//One instance per pair of neighbouring spine points, so pointCount - 1 are written. Four segments are built at
+		//a time from the structure of arrays spine and the head and tail taper to a point
+		static void BuildSegments(const float* const x, const float* const y, const float* const z, const unsigned int pointCount, const float radius, TubeSegmentInstance* const instances);
+
+		//Four segments from their end points, one per lane, written to the first laneCount of instances
+		static void BuildSegmentBatch(DirectX::FXMVECTOR startX, DirectX::FXMVECTOR startY, DirectX::FXMVECTOR startZ, DirectX::GXMVECTOR endX, DirectX::HXMVECTOR endY, DirectX::HXMVECTOR endZ,
+			DirectX::CXMVECTOR startRadius, DirectX::CXMVECTOR endRadius, TubeSegmentInstance* const* const instances, const unsigned int laneCount = 4);
+
+		//Hash based value noise, the same function SnakeGS.hlsl used
+		static float Noise(const float x, const float y, const float z);
+
+		//Four points at once. Inside the scene's -5 to 5 range lanes agree with the scalar noise to within 1e-2, further out the
+		//odd lattice point hashes differently because the hash amplifies rounding in the sine, as it already did on the GPU
+		static DirectX::XMVECTOR Noise(DirectX::FXMVECTOR x, DirectX::FXMVECTOR y, DirectX::FXMVECTOR z);
+	};
+}